@@ -13,7 +13,7 @@ DISK_IMG="disk.img"
 
 TOOL="bin/tools/yulafs_tool"
 
-USER_APPS=("geditor" "asmc" "dasm" "grep" "cat" "uld" "scc" "explorer" "cp" "mv" "touch" "tree" "ld" "paint" "flux" "axwm" "launcher" "ush" "term" "getty" "ps" "time" "neofetch" "ls" "rm" "mkdir" "kill" "networkd" "ping")
+USER_APPS=("geditor" "asmc" "dasm" "grep" "cat" "uld" "scc" "explorer" "cp" "mv" "touch" "tree" "ld" "paint" "flux" "axwm" "launcher" "ush" "term" "getty" "ps" "time" "neofetch" "ls" "rm" "mkdir" "kill" "networkd" "ping" "swapstress" "tlbbench" "faultbench" "perf" "trace" "dmesg" "lockstat" "kbench" "bench" "slabinfo" "rcustat")
 
 if command -v ccache &> /dev/null; then
     CC="ccache gcc -m32"
@@ -34,7 +34,8 @@ CFLAGS_KERN="$CFLAGS_BASE -std=gnu99 -O2 -Wall -Wextra -I src -mno-mmx -mno-sse
 
 CXXFLAGS_KERN="$CFLAGS_BASE -std=c++23 -O2 -Wall -Wextra -I src -mno-mmx -mno-sse -mno-sse2 -mno-80387 -fomit-frame-pointer -fno-exceptions -fno-rtti -fno-threadsafe-statics -fno-use-cxa-atexit"
 
-CFLAGS_USER="$CFLAGS_BASE -I usr -msse -msse2 -O2 -fomit-frame-pointer"
+# Programs are static executables: every __thread access can use the local-exec model.
+CFLAGS_USER="$CFLAGS_BASE -I usr -msse -msse2 -O2 -fomit-frame-pointer -ftls-model=local-exec"
 
 CXXFLAGS_USER="$CFLAGS_USER -std=c++23 -O2 -fno-exceptions -fno-rtti -fno-threadsafe-statics -fno-use-cxa-atexit"
 
@@ -45,6 +46,50 @@ if [[ "${KERNEL_PROFILE:-0}" == "1" ]]; then
     CXXFLAGS_KERN+=" -finstrument-functions -fno-optimize-sibling-calls -DKERNEL_PROFILE=1"
 fi
 
+# Lock contention statistics behind /dev/lockstat.
+if [[ "${KERNEL_LOCKSTAT:-0}" == "1" ]]; then
+    CFLAGS_KERN+=" -DKERNEL_LOCKSTAT=1"
+    CXXFLAGS_KERN+=" -DKERNEL_LOCKSTAT=1"
+fi
+
+# Three-level PAE page tables: 64-bit PTEs, NX and RAM above 4 GiB.
+if [[ "${KERNEL_PAE:-0}" == "1" ]]; then
+    CFLAGS_KERN+=" -DKERNEL_PAE=1"
+    CXXFLAGS_KERN+=" -DKERNEL_PAE=1"
+fi
+
+# ./build.sh libbench [args]: host benchmark and fuzz run of the src/lib containers.
+# Native 64-bit build against tools/libbench/shim, so no multilib toolchain is needed.
+if [[ "${1:-}" == "libbench" ]]; then
+    shift
+
+    LIBBENCH_OBJ="bin/obj/libbench"
+    LIBBENCH_FLAGS="-O2 -g -mcx16 -pthread -Wall -Wextra -I tools/libbench/shim -I src -I include"
+
+    mkdir -p "$LIBBENCH_OBJ" bin/tools
+
+    LIBBENCH_OBJS=""
+    for FILE in src/lib/rbtree.c src/lib/radixtree.c src/lib/idr.c; do
+        OBJ="$LIBBENCH_OBJ/$(basename "${FILE%.*}").o"
+        gcc -std=gnu99 $LIBBENCH_FLAGS -c "$FILE" -o "$OBJ" &
+        LIBBENCH_OBJS="$LIBBENCH_OBJS $OBJ"
+    done
+
+    for FILE in src/lib/chashmap.cpp src/lib/cpp/maple_tree.cpp tools/libbench/*.cpp; do
+        OBJ="$LIBBENCH_OBJ/$(basename "${FILE%.*}").o"
+        g++ -std=c++23 $LIBBENCH_FLAGS -c "$FILE" -o "$OBJ" &
+        LIBBENCH_OBJS="$LIBBENCH_OBJS $OBJ"
+    done
+
+    for job in $(jobs -p); do
+        wait $job || exit 1
+    done
+
+    g++ -pthread $LIBBENCH_OBJS -o bin/tools/libbench
+
+    exec bin/tools/libbench "$@"
+fi
+
 mkdir -p "${DIRS[@]}"
 
 gcc -O3 tools/yulafs_tool.c -o "$TOOL" &
@@ -104,9 +149,13 @@ $CC $CFLAGS_USER -c usr/lib/stdio.c  -o bin/obj/stdio.o &
 $CC $CFLAGS_USER -c usr/lib/string.c  -o bin/obj/string.o &
 $CC $CFLAGS_USER -c usr/lib/stdlib.c  -o bin/obj/stdlib.o &
 $CC $CFLAGS_USER -c usr/lib/pthread.c  -o bin/obj/pthread.o &
+$CC $CFLAGS_USER -c usr/lib/chan.c  -o bin/obj/chan.o &
+$CC $CFLAGS_USER -c usr/lib/taskpool.c  -o bin/obj/taskpool.o &
+$CC $CFLAGS_USER -c usr/lib/udivdi3.c  -o bin/obj/udivdi3.o &
 
 USER_LIBS="bin/obj/malloc.o bin/obj/stdio.o bin/usr/start.o
-bin/obj/string.o bin/obj/stdlib.o bin/obj/pthread.o"
+bin/obj/string.o bin/obj/stdlib.o bin/obj/pthread.o bin/obj/chan.o bin/obj/taskpool.o
+bin/obj/udivdi3.o"
 
 echo "[user] compiling apps..."
 declare -A USER_APP_OBJS
@@ -143,36 +192,34 @@ done
 echo "[ld] linking kernel..."
 SORTED_K_OBJS=$(echo $KERNEL_OBJ_FILES | tr ' ' '\n' | sort | tr '\n' ' ')
 
-if [[ "${KERNEL_PROFILE:-0}" == "1" ]]; then
-    $LD -T src/linker.ld -o bin/kernel.elf $SORTED_K_OBJS
-
-    nm -n bin/kernel.elf \
-        | awk 'tolower($2)=="t" || tolower($2)=="w" { print $1 " " $3 }' \
-        | awk 'BEGIN { \
-                print "#include <kernel/symbols/ksyms.h>"; \
-                print "const ksym_t ksyms_table[] = {"; \
-            } \
-            { \
-                printf "    { 0x%s, \"%s\" },\n", $1, $2; \
-            } \
-            END { \
-                print "};"; \
-                print "const uint32_t ksyms_count = sizeof(ksyms_table) / sizeof(ksyms_table[0]);"; \
-            }' \
-        > bin/obj/ksyms_table.c
-
-    $CC $CFLAGS_KERN -fno-instrument-functions -c bin/obj/ksyms_table.c -o bin/obj/ksyms_table.o
-
-    $LD -T src/linker.ld -o bin/kernel.bin $SORTED_K_OBJS bin/obj/ksyms_table.o &
-else
-    $LD -T src/linker.ld -o bin/kernel.bin $SORTED_K_OBJS &
-fi
+# Two passes: the symbol table is built from a first link, then linked in.
+# It only adds .rodata, which sits after .text, so no function moves.
+$LD -T src/linker.ld -o bin/kernel.elf $SORTED_K_OBJS
+
+nm -n bin/kernel.elf \
+    | awk 'tolower($2)=="t" || tolower($2)=="w" { print $1 " " $3 }' \
+    | awk 'BEGIN { \
+            print "#include <kernel/symbols/ksyms.h>"; \
+            print "const ksym_t ksyms_table[] = {"; \
+        } \
+        { \
+            printf "    { 0x%s, \"%s\" },\n", $1, $2; \
+        } \
+        END { \
+            print "};"; \
+            print "const uint32_t ksyms_count = sizeof(ksyms_table) / sizeof(ksyms_table[0]);"; \
+        }' \
+    > bin/obj/ksyms_table.c
+
+$CC $CFLAGS_KERN -fno-instrument-functions -c bin/obj/ksyms_table.c -o bin/obj/ksyms_table.o
+
+$LD -T src/linker.ld -o bin/kernel.bin $SORTED_K_OBJS bin/obj/ksyms_table.o &
 
 for APP in "${USER_APPS[@]}"; do
     (
         read -r -a OBJS <<< "${USER_APP_OBJS[$APP]}"
         $LD $LDFLAGS_USER -o "bin/usr/$APP.exe" $USER_LIBS "${OBJS[@]}"
-        strip --strip-all "bin/usr/$APP.exe"
+        strip --strip-debug "bin/usr/$APP.exe"
     ) &
 done
 
@@ -195,6 +242,9 @@ done
 "$TOOL" "$DISK_IMG" import bin/obj/stdlib.o /bin/stdlib.o > /dev/null
 "$TOOL" "$DISK_IMG" import bin/obj/stdio.o /bin/stdio.o > /dev/null
 "$TOOL" "$DISK_IMG" import bin/obj/pthread.o /bin/pthread.o > /dev/null
+"$TOOL" "$DISK_IMG" import bin/obj/chan.o /bin/chan.o > /dev/null
+"$TOOL" "$DISK_IMG" import bin/obj/taskpool.o /bin/taskpool.o > /dev/null
+"$TOOL" "$DISK_IMG" import bin/obj/udivdi3.o /bin/udivdi3.o > /dev/null
 
 cp bin/kernel.bin "$ISODIR/boot/kernel.bin"
 
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_CHANNEL_H
+#define YOS_CHANNEL_H
+
+#include <stdint.h>
+
+/*
+ * IPC channel: two single-producer single-consumer byte rings in memory
+ * that both peers map from their channel fd. ring[s] carries what side s
+ * sends; the connecting side is 0, the accepting side 1.
+ *
+ * The kernel never touches the data. It reads the ring positions to answer
+ * poll() and, on YOS_CHAN_NOTIFY, wakes the peer's poll() and futex waits
+ * on the peer's position word. A side only asks for that when the peer has
+ * said it is about to sleep, and the library only checks on the
+ * empty-to-non-empty (and full-to-not-full) transitions.
+ */
+
+#define YOS_CHAN_MAGIC   0x4E414843u
+#define YOS_CHAN_VERSION 1u
+
+#define YOS_CHAN_HDR_SIZE  4096u
+#define YOS_CHAN_RING_SIZE 16384u
+#define YOS_CHAN_MAP_SIZE  (YOS_CHAN_HDR_SIZE + 2u * YOS_CHAN_RING_SIZE)
+
+/* Largest message, so that one always fits next to a wrap marker. */
+#define YOS_CHAN_MSG_MAX (YOS_CHAN_RING_SIZE / 4u)
+
+/* Messages start on this boundary, behind a yos_chan_rec_t. */
+#define YOS_CHAN_REC_ALIGN 8u
+
+/* Record flag: the rest of the ring is padding, the next record is at its start. */
+#define YOS_CHAN_REC_WRAP 1u
+
+typedef struct {
+    uint32_t len;
+    uint32_t flags;
+} yos_chan_rec_t;
+
+typedef struct {
+    /* Producer's side: bytes ever written, and the room it waits for (0 when not waiting). */
+    volatile uint32_t head;
+    volatile uint32_t want_space;
+    uint32_t pad0[14];
+
+    /* Consumer's side: bytes ever read, and non-zero while it waits for data. */
+    volatile uint32_t tail;
+    volatile uint32_t want_data;
+    uint32_t pad1[14];
+} yos_chan_ring_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ring_size;
+    uint32_t data_offset;
+
+    /* Bit s is set by the kernel once side s has closed its end. */
+    volatile uint32_t closed;
+    uint32_t pad[11];
+
+    yos_chan_ring_t ring[2];
+} yos_chan_shared_t;
+
+/* ipc_listen() flag: the endpoint takes channel connections as well as pipe pairs. */
+#define YOS_IPC_LISTEN_CHAN 1u
+
+/* ipc_accept() result for a channel connection: out_fds[0] is the channel, out_fds[1] is -1. */
+#define YOS_IPC_ACCEPTED_CHAN 2
+
+#endif
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_EVENTFD_H
+#define YOS_EVENTFD_H
+
+#include <stdint.h>
+
+/*
+ * Event counters and timers as pollable fds.
+ *
+ * An eventfd holds a 64-bit counter: write() adds an 8-byte value, read()
+ * returns the counter in 8 bytes and resets it, or in semaphore mode returns
+ * 1 and takes 1 off. A timerfd counts its expirations the same way, read()
+ * returning and clearing them; it is armed with YOS_TFD_SETTIME.
+ *
+ * Reads that find nothing, and writes that would overflow, sleep unless the
+ * fd was made non-blocking, in which case they return 0.
+ */
+
+/* eventfd() flags. */
+#define YOS_EFD_SEMAPHORE 0x1u
+#define YOS_EFD_NONBLOCK  0x2u
+
+/* The largest value the counter holds. */
+#define YOS_EFD_MAX 0xFFFFFFFFFFFFFFFEull
+
+/* timerfd_create() flags. */
+#define YOS_TFD_NONBLOCK  0x2u
+
+#endif
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_FUTEX_H
+#define YOS_FUTEX_H
+
+#include <stdint.h>
+
+/* futex_wait_timeout() flag: the timeout is an uptime_ms() deadline, not a duration. */
+#define YOS_FUTEX_ABSTIME 0x1u
+
+/* futex_lock_pi() timeout: wait for as long as it takes. */
+#define YOS_FUTEX_INFINITE 0xFFFFFFFFu
+
+/* futex_requeue() flag: fail with YOS_FUTEX_EAGAIN unless *uaddr == cmpval. */
+#define YOS_FUTEX_REQUEUE_CMP 0x1u
+
+/* Futex syscall results besides 0, -1 (bad argument or fault) and counts. */
+#define YOS_FUTEX_EINTR     (-2)
+#define YOS_FUTEX_ETIMEDOUT (-3)
+#define YOS_FUTEX_EAGAIN    (-4)
+#define YOS_FUTEX_EDEADLK   (-5)
+#define YOS_FUTEX_EPERM     (-6)
+
+/*
+ * Priority-inheritance futex word: the owner's pid, or 0 when free. The
+ * kernel sets YOS_FUTEX_WAITERS while tasks sleep on it, so the owner has to
+ * go through futex_unlock_pi(), and YOS_FUTEX_OWNER_DIED when it hands over
+ * a lock whose owner exited.
+ */
+#define YOS_FUTEX_WAITERS    0x80000000u
+#define YOS_FUTEX_OWNER_DIED 0x40000000u
+#define YOS_FUTEX_TID_MASK   0x3FFFFFFFu
+
+/* futex_wake_op() operations applied to *uaddr2. */
+#define YOS_FUTEX_OP_SET  0u
+#define YOS_FUTEX_OP_ADD  1u
+#define YOS_FUTEX_OP_OR   2u
+#define YOS_FUTEX_OP_ANDN 3u
+#define YOS_FUTEX_OP_XOR  4u
+
+/* futex_wake_op() comparisons of the old *uaddr2 against cmparg. */
+#define YOS_FUTEX_OP_CMP_EQ 0u
+#define YOS_FUTEX_OP_CMP_NE 1u
+#define YOS_FUTEX_OP_CMP_LT 2u
+#define YOS_FUTEX_OP_CMP_LE 3u
+#define YOS_FUTEX_OP_CMP_GT 4u
+#define YOS_FUTEX_OP_CMP_GE 5u
+
+typedef struct {
+    volatile uint32_t* uaddr;
+    volatile uint32_t* uaddr2;
+
+    uint32_t nr_wake;
+    uint32_t nr_requeue;
+
+    uint32_t cmpval;
+    uint32_t flags;
+} yos_futex_requeue_t;
+
+/*
+ * Apply `op` with `oparg` to *uaddr2, wake up to nr_wake waiters on uaddr
+ * and, if the old *uaddr2 compared `cmp` against `cmparg` holds, up to
+ * nr_wake2 waiters on uaddr2.
+ */
+typedef struct {
+    volatile uint32_t* uaddr;
+    volatile uint32_t* uaddr2;
+
+    uint32_t nr_wake;
+    uint32_t nr_wake2;
+
+    uint32_t op;
+    uint32_t oparg;
+
+    uint32_t cmp;
+    uint32_t cmparg;
+} yos_futex_wake_op_t;
+
+#endif
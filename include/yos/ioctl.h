@@ -123,4 +123,58 @@ typedef struct {
 #define YOS_FB_ACQUIRE  _YOS_IO('F', 0x02)
 #define YOS_FB_RELEASE  _YOS_IO('F', 0x03)
 
+/*
+ * Pipe capacity. SET_SIZE rounds up to a power of two within the limits,
+ * fails while more than the new size is buffered and returns the size set.
+ */
+#define YOS_PIPE_MIN_SIZE 4096u
+#define YOS_PIPE_MAX_SIZE (4u << 20)
+
+/*
+ * Gift mode: whole pages of private memory written at page-aligned addresses
+ * move into the pipe instead of being copied, leaving the writer's range as
+ * after MADV_DONTNEED. Pages that do not qualify are copied as usual.
+ */
+#define YOS_PIPE_F_GIFT 1u
+
+/* 'P' belongs to /dev/prof (yos/prof.h). */
+#define YOS_PIPE_GET_SIZE  _YOS_IOR('p', 0x01, uint32_t)
+#define YOS_PIPE_SET_SIZE  _YOS_IOW('p', 0x02, uint32_t)
+#define YOS_PIPE_GET_FLAGS _YOS_IOR('p', 0x03, uint32_t)
+#define YOS_PIPE_SET_FLAGS _YOS_IOW('p', 0x04, uint32_t)
+
+/*
+ * Shared memory size. The pages already there survive SET_SIZE, so mappings
+ * need not be redone; reaching past the end of a mapping takes a new mmap().
+ */
+#define YOS_SHM_GET_SIZE _YOS_IOR('S', 0x01, uint32_t)
+#define YOS_SHM_SET_SIZE _YOS_IOW('S', 0x02, uint32_t)
+
+typedef struct {
+    uint32_t map_size;
+    uint32_t ring_size;
+    uint32_t side;
+} yos_chan_info_t;
+
+/* Channel doorbell: wake the peer's poll() and futex waits for the given POLLIN/POLLOUT. */
+#define YOS_CHAN_GET_INFO _YOS_IOR('C', 0x01, yos_chan_info_t)
+#define YOS_CHAN_NOTIFY   _YOS_IOW('C', 0x02, uint32_t)
+
+/*
+ * Timerfd arming. value_ms is the delay to the first expiration, or with
+ * YOS_TFD_TIMER_ABSTIME an uptime_ms() deadline; 0 disarms. A non-zero
+ * interval_ms re-arms the timer after every expiration. GETTIME returns the
+ * time left to the next expiration (0 when disarmed) and the interval.
+ */
+#define YOS_TFD_TIMER_ABSTIME 0x1u
+
+typedef struct {
+    uint32_t value_ms;
+    uint32_t interval_ms;
+    uint32_t flags;
+} yos_timerspec_t;
+
+#define YOS_TFD_SETTIME _YOS_IOW('E', 0x01, yos_timerspec_t)
+#define YOS_TFD_GETTIME _YOS_IOR('E', 0x02, yos_timerspec_t)
+
 #endif
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_KBENCH_H
+#define YOS_KBENCH_H
+
+#include <yos/ioctl.h>
+
+#include <stdint.h>
+
+/*
+ * Built-in microbenchmarks (/dev/kbench).
+ *
+ * YOS_KBENCH_RUN runs the kernel-side suite in the caller's context; it also
+ * runs once at boot when the kernel command line contains "kbench". Results
+ * go to the kernel log (and so the serial port), one line per benchmark:
+ *
+ *   kbench: name=<bench>[/<variant>] samples=<n> min_ns=<t> median_ns=<t> p99_ns=<t>
+ *
+ * bracketed by "kbench: begin side=kernel ..." and "kbench: end side=kernel".
+ * The userland kbench tool prints its own benchmarks in the same format with
+ * side=user. Times are TSC cycles converted with the calibrated TSC rate.
+ */
+
+typedef struct {
+    uint32_t tsc_khz;
+    uint32_t runs;          /* completed kernel suite runs since boot */
+} __attribute__((packed)) yos_kbench_info_t;
+
+#define YOS_KBENCH_INFO _YOS_IOR('K', 0x01, yos_kbench_info_t)
+#define YOS_KBENCH_RUN  _YOS_IO('K', 0x02)
+
+#endif
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_LOCKSTAT_H
+#define YOS_LOCKSTAT_H
+
+#include <yos/ioctl.h>
+
+#include <stdint.h>
+
+/*
+ * Lock contention statistics (/dev/lockstat).
+ *
+ * Only present in kernels built with KERNEL_LOCKSTAT=1. Every acquisition
+ * that had to wait is charged to a class keyed by its call site. Wait time
+ * runs from the failed fast path to the acquisition; hold time is measured
+ * for exclusive acquisitions that waited, up to the matching release. Both
+ * are in TSC cycles; histogram bucket i counts times in [2^i, 2^(i+1)).
+ *
+ * read() returns whole yos_lockstat_class_t records, one per call site seen
+ * so far, starting at the record the file offset points at.
+ */
+
+#define YOS_LOCKSTAT_BUCKETS 32u
+
+enum {
+    YOS_LOCKSTAT_SPIN         = 0,
+    YOS_LOCKSTAT_MUTEX        = 1,
+    YOS_LOCKSTAT_RWLOCK_READ  = 2,
+    YOS_LOCKSTAT_RWLOCK_WRITE = 3,
+    YOS_LOCKSTAT_RWSPIN_READ  = 4,
+    YOS_LOCKSTAT_RWSPIN_WRITE = 5,
+    YOS_LOCKSTAT_SEM          = 6,
+
+    YOS_LOCKSTAT_TYPE_COUNT
+};
+
+typedef struct {
+    uint32_t site;          /* kernel address the lock was acquired from */
+    uint32_t lock;          /* last lock instance that was contended here */
+    uint32_t type;
+
+    uint32_t contended;     /* acquisitions that had to wait */
+    uint64_t wait_cycles;
+
+    uint32_t held;          /* contended acquisitions whose hold was timed */
+    uint64_t hold_cycles;
+
+    uint32_t wait_hist[YOS_LOCKSTAT_BUCKETS];
+    uint32_t hold_hist[YOS_LOCKSTAT_BUCKETS];
+} __attribute__((packed)) yos_lockstat_class_t;
+
+typedef struct {
+    uint32_t enabled;       /* 0 if the kernel was built without lockstat */
+    uint32_t tsc_khz;
+    uint32_t classes;       /* call sites registered */
+    uint32_t overflow;      /* contentions not recorded because the table was full */
+} __attribute__((packed)) yos_lockstat_info_t;
+
+#define YOS_LOCKSTAT_INFO  _YOS_IOR('L', 0x01, yos_lockstat_info_t)
+#define YOS_LOCKSTAT_RESET _YOS_IO('L', 0x02)
+
+#endif
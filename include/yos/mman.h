@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_MMAN_H
+#define YOS_MMAN_H
+
+/* mmap() flag: fault the whole mapping in before returning. */
+#define YOS_MAP_POPULATE 0x8000u
+
+/* madvise() advice values. */
+#define YOS_MADV_NORMAL     0u
+#define YOS_MADV_RANDOM     1u
+#define YOS_MADV_SEQUENTIAL 2u
+#define YOS_MADV_WILLNEED   3u
+#define YOS_MADV_DONTNEED   4u
+#define YOS_MADV_HUGEPAGE   14u
+
+/* Drop the range's pages and make any later access fault, as for a stack guard. */
+#define YOS_MADV_GUARD_INSTALL 102u
+
+#endif
@@ -8,6 +8,26 @@
 
 #define YOS_PROC_NAME_MAX 32
 
+#define YOS_RUSAGE_SELF     0
+#define YOS_RUSAGE_CHILDREN 1
+
+/*
+ * Resource usage of a task, or of the children it has reaped. Threads are
+ * tasks too: a joined thread is counted in its joiner's SELF totals.
+ */
+typedef struct {
+    uint32_t utime_sec;
+    uint32_t utime_usec;
+    uint32_t stime_sec;
+    uint32_t stime_usec;
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint32_t minflt;
+    uint32_t majflt;
+    uint32_t nvcsw;
+    uint32_t nivcsw;
+} __attribute__((packed)) yos_rusage_t;
+
 typedef struct {
     uint32_t pid;
     uint32_t parent_pid;
@@ -16,6 +36,7 @@ typedef struct {
     uint32_t mem_pages;
     uint32_t term_mode;
     char name[YOS_PROC_NAME_MAX];
+    yos_rusage_t ru;
 } __attribute__((packed)) yos_proc_info_t;
 
 #define YOS_SYS_CLONE 17
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_PROF_H
+#define YOS_PROF_H
+
+#include <yos/ioctl.h>
+
+#include <stdint.h>
+
+/*
+ * Sampling profiler interface (/dev/prof).
+ *
+ * While sampling is on, every CPU records one sample per period from its
+ * timer interrupt. read() drains whole samples from the per-CPU buffers and
+ * returns 0 once they are empty.
+ */
+
+#define YOS_PROF_MAX_DEPTH 12u
+#define YOS_PROF_COMM_MAX  32u
+
+#define YOS_PROF_SAMPLE_USER 0x0001u    /* ip[0] is a user address */
+#define YOS_PROF_SAMPLE_IDLE 0x0002u    /* the CPU was idle */
+
+typedef struct {
+    uint32_t pid;
+    uint16_t cpu;
+    uint16_t flags;
+
+    /* Valid entries in ip[]: ip[0] is the interrupted EIP, callers follow. */
+    uint32_t depth;
+
+    /* Task name; for user programs this is the executable's path. */
+    char comm[YOS_PROF_COMM_MAX];
+
+    uint32_t ip[YOS_PROF_MAX_DEPTH];
+} __attribute__((packed)) yos_prof_sample_t;
+
+typedef struct {
+    uint32_t active;
+    uint32_t hz;
+    uint32_t samples;   /* recorded since the last start */
+    uint32_t dropped;   /* lost to full buffers since the last start */
+} __attribute__((packed)) yos_prof_stats_t;
+
+/* Kernel symbol lookup: fill in `addr`, get the enclosing function back. */
+typedef struct {
+    uint32_t addr;
+    uint32_t sym_addr;
+    char name[64];
+} __attribute__((packed)) yos_prof_sym_t;
+
+#define YOS_PROF_START   _YOS_IOW('P', 0x01, uint32_t)  /* rate in Hz; clears old samples */
+#define YOS_PROF_STOP    _YOS_IO('P', 0x02)
+#define YOS_PROF_STATS   _YOS_IOR('P', 0x03, yos_prof_stats_t)
+#define YOS_PROF_RESOLVE _YOS_IOWR('P', 0x04, yos_prof_sym_t)
+
+#endif
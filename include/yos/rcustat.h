@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_RCUSTAT_H
+#define YOS_RCUSTAT_H
+
+#include <stdint.h>
+
+/*
+ * Per-CPU RCU statistics (/dev/rcustat).
+ *
+ * read() returns whole yos_rcu_cpu_stats_t records, one per CPU, starting
+ * at the record the file offset points at. Counters run since boot and
+ * wrap; next, wait and done are the current lengths of the callback
+ * segments of that CPU.
+ */
+typedef struct {
+    uint32_t cpu;
+
+    uint32_t queued;        /* callbacks queued with call_rcu() */
+    uint32_t invoked;       /* callbacks run */
+
+    uint32_t next;          /* queued, no grace period started for them yet */
+    uint32_t wait;          /* waiting for the current grace period */
+    uint32_t done;          /* grace period over, not run yet */
+
+    uint32_t gps;           /* grace periods completed */
+    uint32_t gps_expedited; /* of those, finished on an expedite request */
+    uint32_t ipis;          /* expedite IPIs received */
+
+    uint32_t offloaded;     /* 1 if callbacks run on an "rcuo" thread */
+} __attribute__((packed)) yos_rcu_cpu_stats_t;
+
+#endif
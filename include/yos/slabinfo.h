@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_SLABINFO_H
+#define YOS_SLABINFO_H
+
+#include <stdint.h>
+
+/*
+ * Kernel heap cache statistics (/dev/slabinfo).
+ *
+ * read() returns whole yos_slabinfo_t records starting at the record the
+ * file offset points at: the kmalloc size classes first, then caches made
+ * with kmem_cache_create(). allocs and frees count since boot and wrap;
+ * rates come from the difference between two reads.
+ */
+
+#define YOS_SLABINFO_DIRECT  0x1u   /* slabs are high-order PMM blocks */
+#define YOS_SLABINFO_DYNAMIC 0x2u   /* made with kmem_cache_create() */
+
+typedef struct {
+    char name[16];
+
+    uint32_t object_size;
+    uint32_t objects_per_slab;
+    uint32_t pages_per_slab;
+    uint32_t flags;
+
+    uint32_t slabs;             /* slabs currently backing the cache */
+    uint32_t active_objects;    /* objects handed out and not yet freed */
+
+    uint32_t allocs;
+    uint32_t frees;
+} __attribute__((packed)) yos_slabinfo_t;
+
+#endif
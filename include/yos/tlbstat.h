@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_TLBSTAT_H
+#define YOS_TLBSTAT_H
+
+#include <stdint.h>
+
+/* Counters read from /dev/tlbstat, summed over all CPUs since boot. */
+typedef struct {
+    uint32_t shootdowns;    /* remote shootdown requests issued */
+    uint32_t ipis;          /* TLB IPIs sent */
+    uint32_t lazy_skips;    /* CPUs left out because they were lazy */
+    uint32_t local_only;    /* flushes no other CPU needed */
+    uint32_t slot_waits;    /* times a sender waited for a free request slot */
+} __attribute__((packed)) yos_tlb_stats_t;
+
+#endif
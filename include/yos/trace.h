@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef YOS_TRACE_H
+#define YOS_TRACE_H
+
+#include <yos/ioctl.h>
+
+#include <stdint.h>
+
+/*
+ * Kernel event trace (/dev/trace).
+ *
+ * Each CPU logs enabled events into its own ring, overwriting the oldest
+ * entries when nobody reads. read() returns whole events, oldest first per
+ * CPU, and 0 once everything logged so far has been consumed. Events are
+ * stamped with the raw TSC of the logging CPU; YOS_TRACE_STATS reports the
+ * TSC rate for conversion.
+ */
+
+enum {
+    YOS_TRACE_SCHED_SWITCH  = 0,    /* prev pid, next pid, prev state */
+    YOS_TRACE_SCHED_WAKEUP  = 1,    /* pid, target cpu */
+    YOS_TRACE_SYSCALL_ENTER = 2,    /* nr, arg0, arg1, arg2 */
+    YOS_TRACE_SYSCALL_EXIT  = 3,    /* nr, return value */
+    YOS_TRACE_PAGE_FAULT    = 4,    /* address, error code, eip */
+    YOS_TRACE_IRQ_ENTER     = 5,    /* vector */
+    YOS_TRACE_IRQ_EXIT      = 6,    /* vector */
+    YOS_TRACE_BCACHE_MISS   = 7,    /* block */
+    YOS_TRACE_BCACHE_FLUSH  = 8,    /* block */
+    YOS_TRACE_AHCI_SUBMIT   = 9,    /* port, slot, lba, sector count | write << 31 */
+    YOS_TRACE_AHCI_COMPLETE = 10,   /* port, slot, ok */
+    YOS_TRACE_FUTEX_WAIT    = 11,   /* key, expected value */
+    YOS_TRACE_FUTEX_WAKE    = 12,   /* key, max wake, woken */
+    YOS_TRACE_FUTEX_REQUEUE = 13,   /* key, target key, woken, requeued */
+
+    YOS_TRACE_EVENT_COUNT
+};
+
+#define YOS_TRACE_BIT(ev) (1u << (ev))
+#define YOS_TRACE_ALL     ((1u << YOS_TRACE_EVENT_COUNT) - 1u)
+
+typedef struct {
+    uint64_t tsc;
+    uint16_t type;
+    uint16_t cpu;
+    uint32_t pid;
+    uint32_t args[4];
+} __attribute__((packed)) yos_trace_event_t;
+
+typedef struct {
+    uint32_t mask;
+    uint32_t tsc_khz;
+    uint32_t events;        /* logged since the last reset */
+    uint32_t overwritten;   /* lost to wrap-around before being read */
+} __attribute__((packed)) yos_trace_stats_t;
+
+#define YOS_TRACE_SET_MASK _YOS_IOW('R', 0x01, uint32_t)   /* allocates the buffers on first use */
+#define YOS_TRACE_GET_MASK _YOS_IOR('R', 0x02, uint32_t)
+#define YOS_TRACE_STATS    _YOS_IOR('R', 0x03, yos_trace_stats_t)
+#define YOS_TRACE_RESET    _YOS_IO('R', 0x04)                /* drop everything not yet read */
+
+#endif
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#pragma once
+
+#include <yula.h>
+
+/* Upper bound on latency samples kept per result line. */
+#define BENCH_MAX_SAMPLES 1024u
+
+/* Serial line: every result is printed and copied here when -s is given. */
+#define BENCH_SERIAL_PATH "/dev/ttyS0"
+
+extern uint32_t g_bench_tsc_khz;
+
+static inline uint64_t bench_clock(void) {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | (uint64_t)lo;
+}
+
+static inline void bench_relax(void) {
+    __asm__ volatile("pause");
+}
+
+static inline int bench_ptr_bad(const void* p) {
+    return !p || p == (const void*)-1;
+}
+
+int bench_init(int serial);
+void bench_fini(void);
+
+uint32_t bench_ns(uint64_t cycles);
+
+void bench_sample(uint64_t cycles);
+
+/* "bench: name=<name> samples= min_ns= median_ns= p99_ns=", then start over. */
+void bench_report(const char* name);
+
+/* "bench: name=<name> ops= total_ns= ops_per_s=" */
+void bench_report_rate(const char* name, uint32_t ops, uint64_t cycles);
+
+/* "bench: name=<name> bytes= total_ns= kib_per_s=" */
+void bench_report_bytes(const char* name, uint32_t bytes, uint64_t cycles);
+
+/* "bench: name=<name> skipped=<why>" */
+void bench_skip(const char* name, const char* why);
+
+void bench_emit(const char* line);
+
+/* The allocator libc had before its size-class rewrite, for side-by-side runs. */
+#define LEGACY_TCACHE_BINS 32u
+
+typedef struct {
+    void* head_;
+    uint32_t count_;
+} legacy_tcache_bin_t;
+
+/* One per thread, zeroed, owned by the caller. */
+typedef struct {
+    legacy_tcache_bin_t bins_[LEGACY_TCACHE_BINS];
+} legacy_tcache_t;
+
+void* legacy_malloc(legacy_tcache_t* tcache, size_t size);
+void  legacy_free(legacy_tcache_t* tcache, void* ptr);
+
+/* Give every cached block back to the arenas. */
+void  legacy_tcache_flush(legacy_tcache_t* tcache);
+
+void bench_proc(void);
+void bench_pipe(void);
+void bench_ipc(void);
+void bench_shm(void);
+void bench_mmap(void);
+void bench_fs(void);
+void bench_io(void);
+void bench_poll(void);
+void bench_malloc(void);
+void bench_futex(void);
+void bench_flux(void);
+void bench_taskpool(void);
+void bench_thread(void);
+
+/* Bodies of the helper processes bench_proc() and bench_shm() spawn. */
+int bench_child_nop(void);
+int bench_child_shm(const char* shm_name);
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <comp.h>
+
+#include "bench.h"
+
+#define FLUX_W       64u
+#define FLUX_H       64u
+#define FLUX_ITERS   64u
+#define FLUX_WAIT    2000u
+#define FLUX_SURFACE 1u
+
+/*
+ * Time from sending a commit to flux acknowledging that the frame holding
+ * it was presented. Includes up to one compositor frame interval of
+ * waiting and the 1 ms polling step of the reply wait.
+ */
+void bench_flux(void) {
+    comp_conn_t conn;
+    comp_conn_reset(&conn);
+
+    if (comp_connect(&conn, "flux") != 0) {
+        bench_skip("flux_commit_present", "noflux");
+        return;
+    }
+
+    uint16_t err = 0;
+
+    if (comp_send_hello_sync(&conn, FLUX_WAIT, &err) != 0) {
+        comp_disconnect(&conn);
+        bench_skip("flux_commit_present", "nohello");
+        return;
+    }
+
+    const uint32_t size_bytes = FLUX_W * FLUX_H * 4u;
+
+    char shm_name[32];
+    int shm_fd = -1;
+
+    for (int i = 0; i < 8 && shm_fd < 0; i++) {
+        snprintf(shm_name, sizeof(shm_name), "bench_flux_%d_%d", getpid(), i);
+        shm_fd = shm_create_named(shm_name, size_bytes);
+    }
+
+    if (shm_fd < 0) {
+        comp_disconnect(&conn);
+        bench_skip("flux_commit_present", "noshm");
+        return;
+    }
+
+    uint32_t* pixels = (uint32_t*)mmap(shm_fd, size_bytes, MAP_SHARED);
+    if (bench_ptr_bad(pixels)) {
+        close(shm_fd);
+        shm_unlink_named(shm_name);
+        comp_disconnect(&conn);
+        bench_skip("flux_commit_present", "nomap");
+        return;
+    }
+
+    if (comp_send_attach_shm_name_sync(&conn, FLUX_SURFACE, shm_name, size_bytes, FLUX_W, FLUX_H, FLUX_W, 0u, FLUX_WAIT, &err) == 0) {
+        for (uint32_t i = 0; i < FLUX_ITERS; i++) {
+            const uint32_t color = (i & 1u) ? 0xFF3060C0u : 0xFFC06030u;
+
+            for (uint32_t p = 0; p < FLUX_W * FLUX_H; p++) {
+                pixels[p] = color;
+            }
+
+            const uint64_t t0 = bench_clock();
+            const int r = comp_send_commit_presented_sync(&conn, FLUX_SURFACE, 0, 0, 0u, FLUX_WAIT, &err);
+            const uint64_t t1 = bench_clock();
+
+            if (r != 0) {
+                break;
+            }
+
+            bench_sample(t1 - t0);
+        }
+
+        bench_report("flux_commit_present");
+
+        (void)comp_send_destroy_surface_sync(&conn, FLUX_SURFACE, 0u, FLUX_WAIT, &err);
+    } else {
+        bench_skip("flux_commit_present", "noattach");
+    }
+
+    (void)munmap(pixels, size_bytes);
+    close(shm_fd);
+    shm_unlink_named(shm_name);
+    comp_disconnect(&conn);
+}
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define FS_DIR    "/home/bench.tmp"
+#define FS_FILES  128u
+
+#define IO_FILE   FS_DIR "/io.dat"
+#define IO_BYTES  (4u * 1024u * 1024u)
+#define IO_CHUNK  4096u
+#define IO_RANDOM 1024u
+
+static void fs_path(char* out, uint32_t cap, uint32_t i) {
+    snprintf(out, cap, FS_DIR "/f%u", i);
+}
+
+/* Scratch directory on the root YulaFS; left in place for the next run. */
+static int fs_prepare(void) {
+    stat_t st;
+
+    if (stat(FS_DIR, &st) == 0) {
+        return 0;
+    }
+
+    return mkdir(FS_DIR) == 0 ? 0 : -1;
+}
+
+void bench_fs(void) {
+    if (fs_prepare() != 0) {
+        bench_skip("fs", "nodir");
+        return;
+    }
+
+    char path[64];
+    uint32_t done = 0;
+
+    uint64_t t0 = bench_clock();
+
+    for (uint32_t i = 0; i < FS_FILES; i++) {
+        fs_path(path, sizeof(path), i);
+
+        const int fd = open(path, VFS_OPEN_WRITE | VFS_OPEN_CREATE | VFS_OPEN_TRUNC);
+        if (fd < 0) {
+            break;
+        }
+
+        close(fd);
+        done++;
+    }
+
+    bench_report_rate("fs_create", done, bench_clock() - t0);
+
+    const uint32_t created = done;
+    stat_t st;
+
+    done = 0;
+    t0 = bench_clock();
+
+    for (uint32_t i = 0; i < created; i++) {
+        fs_path(path, sizeof(path), i);
+
+        if (stat(path, &st) == 0) {
+            done++;
+        }
+    }
+
+    bench_report_rate("fs_stat", done, bench_clock() - t0);
+
+    done = 0;
+    t0 = bench_clock();
+
+    for (uint32_t i = 0; i < created; i++) {
+        fs_path(path, sizeof(path), i);
+
+        if (unlink(path) == 0) {
+            done++;
+        }
+    }
+
+    bench_report_rate("fs_unlink", done, bench_clock() - t0);
+}
+
+static uint32_t g_rand_state = 0x9E3779B9u;
+
+static uint32_t next_rand(void) {
+    g_rand_state = g_rand_state * 1664525u + 1013904223u;
+    return g_rand_state >> 8;
+}
+
+/*
+ * There is no lseek or pread, so random reads go through a private file
+ * mapping with MADV_RANDOM: each touched page is read from the page cache
+ * or disk by its own fault. Random writes have no equivalent and are
+ * reported as skipped.
+ */
+static void io_random_read(void) {
+    const int fd = open(IO_FILE, 0);
+    if (fd < 0) {
+        bench_skip("io_random_read/4096", "nofile");
+        return;
+    }
+
+    volatile uint8_t* p = (volatile uint8_t*)mmap(fd, IO_BYTES, MAP_PRIVATE);
+    if (bench_ptr_bad((const void*)p)) {
+        close(fd);
+        bench_skip("io_random_read/4096", "nomap");
+        return;
+    }
+
+    (void)madvise((void*)p, IO_BYTES, MADV_RANDOM);
+
+    const uint32_t pages = IO_BYTES / IO_CHUNK;
+    uint32_t sum = 0;
+
+    const uint64_t t0 = bench_clock();
+
+    for (uint32_t i = 0; i < IO_RANDOM; i++) {
+        sum += p[(next_rand() % pages) * IO_CHUNK];
+    }
+
+    const uint64_t t1 = bench_clock();
+
+    (void)sum;
+
+    bench_report_bytes("io_random_read/4096", IO_RANDOM * IO_CHUNK, t1 - t0);
+
+    (void)munmap((void*)p, IO_BYTES);
+    close(fd);
+}
+
+void bench_io(void) {
+    if (fs_prepare() != 0) {
+        bench_skip("io", "nodir");
+        return;
+    }
+
+    uint8_t* buf = (uint8_t*)malloc(IO_CHUNK);
+    if (!buf) {
+        bench_skip("io", "nomem");
+        return;
+    }
+
+    for (uint32_t i = 0; i < IO_CHUNK; i++) {
+        buf[i] = (uint8_t)i;
+    }
+
+    int fd = open(IO_FILE, VFS_OPEN_WRITE | VFS_OPEN_CREATE | VFS_OPEN_TRUNC);
+    if (fd < 0) {
+        free(buf);
+        bench_skip("io", "nofile");
+        return;
+    }
+
+    uint32_t moved = 0;
+
+    uint64_t t0 = bench_clock();
+
+    while (moved < IO_BYTES) {
+        const int w = write(fd, buf, IO_CHUNK);
+        if (w <= 0) {
+            break;
+        }
+
+        moved += (uint32_t)w;
+    }
+
+    close(fd);
+
+    bench_report_bytes("io_seq_write/4096", moved, bench_clock() - t0);
+
+    fd = open(IO_FILE, 0);
+    if (fd >= 0) {
+        moved = 0;
+        t0 = bench_clock();
+
+        for (;;) {
+            const int r = read(fd, buf, IO_CHUNK);
+            if (r <= 0) {
+                break;
+            }
+
+            moved += (uint32_t)r;
+        }
+
+        close(fd);
+
+        bench_report_bytes("io_seq_read/4096", moved, bench_clock() - t0);
+    }
+
+    io_random_read();
+
+    bench_skip("io_random_write/4096", "noseek");
+
+    (void)unlink(IO_FILE);
+    free(buf);
+}
@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define HERD_THREADS  8u
+#define HERD_ROUNDS   64u
+#define HERD_WARM     4u
+
+#define TIMEOUT_ITERS 64u
+
+#define CONTEND_THREADS 2u
+#define CONTEND_ITERS   20000u
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /* Condition word of the wake-all variant. */
+    volatile uint32_t seq;
+
+    volatile uint32_t generation;
+    volatile uint32_t arrived;
+    volatile uint32_t done;
+    volatile uint32_t stop;
+
+    uint32_t threads;
+    int requeue;
+} herd_t;
+
+/* What pthread_cond_wait() used to do: every waiter leaves the futex at once and piles onto the mutex. */
+static void herd_wait_wakeall(herd_t* h) {
+    const uint32_t seq = h->seq;
+
+    pthread_mutex_unlock(&h->lock);
+    (void)futex_wait(&h->seq, seq);
+    pthread_mutex_lock(&h->lock);
+}
+
+static void herd_broadcast(herd_t* h) {
+    if (h->requeue) {
+        pthread_cond_broadcast(&h->cond);
+        return;
+    }
+
+    __sync_fetch_and_add(&h->seq, 1u);
+    (void)futex_wake(&h->seq, 0x7FFFFFFFu);
+}
+
+static void herd_wait_count(volatile uint32_t* word, uint32_t want) {
+    uint32_t cur;
+
+    while ((cur = __atomic_load_n(word, __ATOMIC_ACQUIRE)) != want) {
+        (void)futex_wait(word, cur);
+    }
+}
+
+static void herd_count(volatile uint32_t* word, uint32_t threads) {
+    if (__sync_add_and_fetch(word, 1u) == threads) {
+        (void)futex_wake(word, 1u);
+    }
+}
+
+static void* herd_worker(void* arg) {
+    herd_t* h = (herd_t*)arg;
+
+    pthread_mutex_lock(&h->lock);
+
+    for (;;) {
+        const uint32_t gen = h->generation;
+
+        herd_count(&h->arrived, h->threads);
+
+        while (h->generation == gen) {
+            if (h->requeue) {
+                pthread_cond_wait(&h->cond, &h->lock);
+            } else {
+                herd_wait_wakeall(h);
+            }
+        }
+
+        if (h->stop) {
+            break;
+        }
+
+        /* The critical section every woken waiter has to get through. */
+        herd_count(&h->done, h->threads);
+    }
+
+    pthread_mutex_unlock(&h->lock);
+    return 0;
+}
+
+/*
+ * Broadcast to HERD_THREADS sleepers and time until all of them have been
+ * through the mutex once: the stampede of a plain wake-all against a
+ * requeue that hands the waiters to the mutex one unlock at a time.
+ */
+static void bench_futex_herd(int requeue) {
+    herd_t h;
+    memset(&h, 0, sizeof(h));
+
+    pthread_mutex_init(&h.lock);
+    pthread_cond_init(&h.cond);
+
+    h.threads = HERD_THREADS;
+    h.requeue = requeue;
+
+    char name[48];
+    snprintf(name, sizeof(name), "futex_herd/%s/%ut", requeue ? "requeue" : "wakeall", HERD_THREADS);
+
+    pthread_t tids[HERD_THREADS];
+    uint32_t started = 0;
+
+    for (uint32_t i = 0; i < HERD_THREADS; i++) {
+        if (pthread_create(&tids[i], 0, herd_worker, &h) != 0) {
+            break;
+        }
+
+        started++;
+    }
+
+    if (started != HERD_THREADS) {
+        /* Let whatever did start run down. */
+        h.threads = started;
+
+        pthread_mutex_lock(&h.lock);
+        h.stop = 1u;
+        h.generation++;
+        herd_broadcast(&h);
+        pthread_mutex_unlock(&h.lock);
+
+        for (uint32_t i = 0; i < started; i++) {
+            (void)pthread_join(tids[i], 0);
+        }
+
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    for (uint32_t r = 0; r < HERD_WARM + HERD_ROUNDS; r++) {
+        herd_wait_count(&h.arrived, HERD_THREADS);
+
+        pthread_mutex_lock(&h.lock);
+
+        h.arrived = 0u;
+        h.done = 0u;
+
+        const uint64_t t0 = bench_clock();
+
+        h.generation++;
+        herd_broadcast(&h);
+        pthread_mutex_unlock(&h.lock);
+
+        herd_wait_count(&h.done, HERD_THREADS);
+
+        const uint64_t t1 = bench_clock();
+
+        if (r >= HERD_WARM) {
+            bench_sample(t1 - t0);
+        }
+    }
+
+    herd_wait_count(&h.arrived, HERD_THREADS);
+
+    pthread_mutex_lock(&h.lock);
+    h.stop = 1u;
+    h.generation++;
+    herd_broadcast(&h);
+    pthread_mutex_unlock(&h.lock);
+
+    for (uint32_t i = 0; i < HERD_THREADS; i++) {
+        (void)pthread_join(tids[i], 0);
+    }
+
+    bench_report(name);
+}
+
+/* How long a 1 ms futex timeout really sleeps: tick granularity plus wakeup latency. */
+static void bench_futex_timeout(void) {
+    volatile uint32_t word = 0u;
+
+    for (uint32_t i = 0; i < TIMEOUT_ITERS; i++) {
+        const uint64_t t0 = bench_clock();
+
+        const int r = futex_wait_timeout(&word, 0u, 1u, 0u);
+
+        const uint64_t t1 = bench_clock();
+
+        if (r != YOS_FUTEX_ETIMEDOUT) {
+            bench_skip("futex_timeout/1ms", "notimeout");
+            return;
+        }
+
+        bench_sample(t1 - t0);
+    }
+
+    bench_report("futex_timeout/1ms");
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    volatile uint32_t counter;
+} contend_t;
+
+static void* contend_worker(void* arg) {
+    contend_t* c = (contend_t*)arg;
+
+    for (uint32_t i = 0; i < CONTEND_ITERS; i++) {
+        pthread_mutex_lock(&c->lock);
+        c->counter++;
+        pthread_mutex_unlock(&c->lock);
+    }
+
+    return 0;
+}
+
+/* Threads hammering one mutex: what the PI handover through the kernel costs over the plain futex path. */
+static void bench_futex_contend(int protocol) {
+    contend_t c;
+    memset(&c, 0, sizeof(c));
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, protocol);
+    pthread_mutex_init_attr(&c.lock, &attr);
+
+    char name[48];
+    snprintf(name, sizeof(name), "mutex_contended/%s/%ut",
+             protocol == PTHREAD_PRIO_INHERIT ? "pi" : "plain", CONTEND_THREADS);
+
+    pthread_t tids[CONTEND_THREADS];
+    uint32_t started = 0;
+
+    const uint64_t t0 = bench_clock();
+
+    for (uint32_t i = 0; i < CONTEND_THREADS; i++) {
+        if (pthread_create(&tids[i], 0, contend_worker, &c) != 0) {
+            break;
+        }
+
+        started++;
+    }
+
+    for (uint32_t i = 0; i < started; i++) {
+        (void)pthread_join(tids[i], 0);
+    }
+
+    const uint64_t t1 = bench_clock();
+
+    if (started != CONTEND_THREADS) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    if (c.counter != CONTEND_THREADS * CONTEND_ITERS) {
+        bench_skip(name, "lost_update");
+        return;
+    }
+
+    bench_report_rate(name, c.counter, t1 - t0);
+}
+
+void bench_futex(void) {
+    bench_futex_herd(0);
+    bench_futex_herd(1);
+
+    bench_futex_timeout();
+
+    bench_futex_contend(PTHREAD_PRIO_NONE);
+    bench_futex_contend(PTHREAD_PRIO_INHERIT);
+}
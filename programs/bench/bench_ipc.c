@@ -0,0 +1,512 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define LATENCY_ITERS 512u
+#define STREAM_BYTES  (4u * 1024u * 1024u)
+#define STREAM_MAX    65536u
+
+#define XFER_BYTES    (16u * 1024u * 1024u)
+#define XFER_MAX      (1024u * 1024u)
+#define XFER_PAGE     4096u
+
+#define IPC_ENDPOINT  "bench_ipc"
+#define CHAN_ENDPOINT "bench_chan"
+
+/*
+ * One duplex channel: the timed side writes `tx` and reads `rx`, a helper
+ * thread serves the other ends.
+ */
+typedef struct {
+    int tx;
+    int rx;
+    int peer_rx;
+    int peer_tx;
+
+    uint32_t sink_bytes;
+    uint32_t sink_chunk;
+} channel_t;
+
+static void* echo_thread(void* arg) {
+    const channel_t* ch = (const channel_t*)arg;
+
+    char c;
+
+    while (read(ch->peer_rx, &c, 1u) == 1) {
+        if (c == 0) {
+            break;
+        }
+
+        (void)write(ch->peer_tx, &c, 1u);
+    }
+
+    return 0;
+}
+
+static void* sink_thread(void* arg) {
+    const channel_t* ch = (const channel_t*)arg;
+
+    uint8_t* buf = (uint8_t*)malloc(ch->sink_chunk);
+    if (!buf) {
+        return 0;
+    }
+
+    uint32_t left = ch->sink_bytes;
+
+    while (left > 0u) {
+        const int r = read(ch->peer_rx, buf, left < ch->sink_chunk ? left : ch->sink_chunk);
+        if (r <= 0) {
+            break;
+        }
+
+        left -= (uint32_t)r;
+    }
+
+    free(buf);
+    return 0;
+}
+
+/* One byte there and back; half the round trip is one hop. */
+static void run_latency(channel_t* ch, const char* prefix) {
+    pthread_t tid;
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s_latency/1", prefix);
+
+    if (pthread_create(&tid, 0, echo_thread, ch) != 0) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    for (uint32_t i = 0; i < LATENCY_ITERS; i++) {
+        char c = 1;
+
+        const uint64_t t0 = bench_clock();
+        (void)write(ch->tx, &c, 1u);
+        (void)read(ch->rx, &c, 1u);
+        const uint64_t t1 = bench_clock();
+
+        bench_sample((t1 - t0) / 2u);
+    }
+
+    char stop = 0;
+    (void)write(ch->tx, &stop, 1u);
+
+    (void)pthread_join(tid, 0);
+
+    bench_report(name);
+}
+
+static void run_stream(channel_t* ch, const char* prefix, uint32_t chunk) {
+    static uint8_t src[STREAM_MAX];
+
+    pthread_t tid;
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s_bandwidth/%u", prefix, chunk);
+
+    ch->sink_bytes = STREAM_BYTES;
+    ch->sink_chunk = chunk;
+
+    if (pthread_create(&tid, 0, sink_thread, ch) != 0) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    uint32_t left = STREAM_BYTES;
+
+    const uint64_t t0 = bench_clock();
+
+    while (left > 0u) {
+        const int w = write(ch->tx, src, left < chunk ? left : chunk);
+        if (w <= 0) {
+            break;
+        }
+
+        left -= (uint32_t)w;
+    }
+
+    (void)pthread_join(tid, 0);
+
+    const uint64_t t1 = bench_clock();
+
+    bench_report_bytes(name, STREAM_BYTES - left, t1 - t0);
+}
+
+static void run_channel(channel_t* ch, const char* prefix) {
+    static const uint32_t chunks[] = { 64u, 4096u, STREAM_MAX };
+
+    run_latency(ch, prefix);
+
+    for (uint32_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        run_stream(ch, prefix, chunks[i]);
+    }
+}
+
+/*
+ * Bulk transfers of `chunk` bytes through a pipe sized to hold two of them.
+ * The writer touches every page of its buffer before each write, like a
+ * producer filling it, so that gift mode pays for the pages it gives away.
+ */
+static void run_xfer(uint32_t chunk, int gift) {
+    static uint8_t src[XFER_MAX] __attribute__((aligned(XFER_PAGE)));
+
+    char name[64];
+    snprintf(name, sizeof(name), "pipe_xfer/%s/%u", gift ? "gift" : "copy", chunk);
+
+    int fds[2];
+
+    if (pipe(fds) != 0) {
+        bench_skip(name, "nopipe");
+        return;
+    }
+
+    const uint32_t cap = (chunk * 2u < 32768u) ? 32768u : chunk * 2u;
+
+    if (pipe_set_size(fds[1], cap) < 0 || pipe_set_flags(fds[1], gift ? YOS_PIPE_F_GIFT : 0u) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        bench_skip(name, "noresize");
+        return;
+    }
+
+    channel_t ch;
+    memset(&ch, 0, sizeof(ch));
+
+    ch.peer_rx = fds[0];
+    ch.sink_bytes = XFER_BYTES;
+    ch.sink_chunk = chunk;
+
+    pthread_t tid;
+
+    if (pthread_create(&tid, 0, sink_thread, &ch) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    uint32_t left = XFER_BYTES;
+
+    const uint64_t t0 = bench_clock();
+
+    while (left > 0u) {
+        const uint32_t n = left < chunk ? left : chunk;
+
+        for (uint32_t off = 0; off < n; off += XFER_PAGE) {
+            src[off] = (uint8_t)left;
+        }
+
+        const int w = write(fds[1], src, n);
+        if (w <= 0) {
+            break;
+        }
+
+        left -= (uint32_t)w;
+    }
+
+    (void)pthread_join(tid, 0);
+
+    const uint64_t t1 = bench_clock();
+
+    bench_report_bytes(name, XFER_BYTES - left, t1 - t0);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void bench_pipe(void) {
+    int a[2];
+    int b[2];
+
+    if (pipe(a) != 0) {
+        bench_skip("pipe", "nopipe");
+        return;
+    }
+
+    if (pipe(b) != 0) {
+        close(a[0]);
+        close(a[1]);
+        bench_skip("pipe", "nopipe");
+        return;
+    }
+
+    channel_t ch;
+    memset(&ch, 0, sizeof(ch));
+
+    ch.tx = a[1];
+    ch.peer_rx = a[0];
+    ch.peer_tx = b[1];
+    ch.rx = b[0];
+
+    run_channel(&ch, "pipe");
+
+    close(a[0]);
+    close(a[1]);
+    close(b[0]);
+    close(b[1]);
+
+    static const uint32_t xfers[] = { 4096u, 65536u, XFER_MAX };
+
+    for (uint32_t i = 0; i < sizeof(xfers) / sizeof(xfers[0]); i++) {
+        run_xfer(xfers[i], 0);
+        run_xfer(xfers[i], 1);
+    }
+}
+
+/* Connections are queued by ipc_connect() and picked up here without blocking. */
+static int accept_one(int listen_fd, int out_fds[2]) {
+    for (uint32_t i = 0; i < 1000u; i++) {
+        const int r = ipc_accept(listen_fd, out_fds);
+        if (r == 1) {
+            return 0;
+        }
+
+        if (r < 0) {
+            return -1;
+        }
+
+        usleep(1000u);
+    }
+
+    return -1;
+}
+
+/* Both ends of a channel connection; a helper thread serves `server`. */
+typedef struct {
+    chan_t client;
+    chan_t server;
+
+    uint32_t sink_bytes;
+} chan_pair_t;
+
+static int chan_send_wait(chan_t* ch, const void* buf, uint32_t len) {
+    for (;;) {
+        const int r = chan_try_send(ch, buf, len);
+        if (r != 0) {
+            return r > 0 ? 0 : -1;
+        }
+
+        (void)chan_wait(ch, POLLOUT, -1);
+    }
+}
+
+static int chan_recv_wait(chan_t* ch, const void** msg, uint32_t* len) {
+    for (;;) {
+        const int r = chan_recv_peek(ch, msg, len);
+        if (r != 0) {
+            return r > 0 ? 0 : -1;
+        }
+
+        (void)chan_wait(ch, POLLIN, -1);
+    }
+}
+
+/* Echoes messages back in place until a one-byte 0. */
+static void* chan_echo_thread(void* arg) {
+    chan_t* ch = &((chan_pair_t*)arg)->server;
+
+    const void* msg;
+    uint32_t len;
+
+    while (chan_recv_wait(ch, &msg, &len) == 0) {
+        int stop = (len == 1u && *(const uint8_t*)msg == 0u);
+
+        if (!stop && chan_send_wait(ch, msg, len) != 0) {
+            stop = 1;
+        }
+
+        chan_recv_done(ch);
+
+        if (stop) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static void* chan_sink_thread(void* arg) {
+    chan_pair_t* p = (chan_pair_t*)arg;
+
+    const void* msg;
+    uint32_t len;
+    uint32_t left = p->sink_bytes;
+
+    while (left > 0u && chan_recv_wait(&p->server, &msg, &len) == 0) {
+        left -= len < left ? len : left;
+        chan_recv_done(&p->server);
+    }
+
+    return 0;
+}
+
+static void run_chan_latency(chan_pair_t* p) {
+    const char* name = "chan_latency/1";
+
+    pthread_t tid;
+
+    if (pthread_create(&tid, 0, chan_echo_thread, p) != 0) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    for (uint32_t i = 0; i < LATENCY_ITERS; i++) {
+        char c = 1;
+
+        const void* msg;
+        uint32_t len;
+
+        const uint64_t t0 = bench_clock();
+        (void)chan_send_wait(&p->client, &c, 1u);
+        if (chan_recv_wait(&p->client, &msg, &len) == 0) {
+            chan_recv_done(&p->client);
+        }
+        const uint64_t t1 = bench_clock();
+
+        bench_sample((t1 - t0) / 2u);
+    }
+
+    char stop = 0;
+    (void)chan_send_wait(&p->client, &stop, 1u);
+
+    (void)pthread_join(tid, 0);
+
+    bench_report(name);
+}
+
+/* Messages are built in the ring: the only copy is the receiver's, if it wants one. */
+static void run_chan_stream(chan_pair_t* p, uint32_t chunk) {
+    char name[64];
+    snprintf(name, sizeof(name), "chan_bandwidth/%u", chunk);
+
+    p->sink_bytes = STREAM_BYTES;
+
+    pthread_t tid;
+
+    if (pthread_create(&tid, 0, chan_sink_thread, p) != 0) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    uint32_t left = STREAM_BYTES;
+
+    const uint64_t t0 = bench_clock();
+
+    while (left > 0u) {
+        const uint32_t n = left < chunk ? left : chunk;
+
+        uint8_t* dst = (uint8_t*)chan_send_reserve(&p->client, n);
+        if (!dst) {
+            if (chan_peer_closed(&p->client)) {
+                break;
+            }
+
+            (void)chan_wait(&p->client, POLLOUT, -1);
+            continue;
+        }
+
+        dst[0] = (uint8_t)left;
+        (void)chan_send_commit(&p->client);
+
+        left -= n;
+    }
+
+    (void)pthread_join(tid, 0);
+
+    const uint64_t t1 = bench_clock();
+
+    bench_report_bytes(name, STREAM_BYTES - left, t1 - t0);
+}
+
+static void bench_chan(void) {
+    const int listen_fd = ipc_listen_flags(CHAN_ENDPOINT, YOS_IPC_LISTEN_CHAN);
+    if (listen_fd < 0) {
+        bench_skip("chan", "nolisten");
+        return;
+    }
+
+    chan_pair_t p;
+    memset(&p, 0, sizeof(p));
+
+    if (chan_connect(&p.client, CHAN_ENDPOINT) != 0) {
+        close(listen_fd);
+        bench_skip("chan", "noconnect");
+        return;
+    }
+
+    int fds[2] = { -1, -1 };
+    int r = -1;
+
+    for (uint32_t i = 0; i < 1000u; i++) {
+        r = ipc_accept(listen_fd, fds);
+        if (r != 0) {
+            break;
+        }
+
+        usleep(1000u);
+    }
+
+    if (r != YOS_IPC_ACCEPTED_CHAN || chan_open(&p.server, fds[0]) != 0) {
+        chan_close(&p.client);
+        close(listen_fd);
+        bench_skip("chan", "noaccept");
+        return;
+    }
+
+    static const uint32_t chunks[] = { 64u, YOS_CHAN_MSG_MAX };
+
+    run_chan_latency(&p);
+
+    for (uint32_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        run_chan_stream(&p, chunks[i]);
+    }
+
+    chan_close(&p.client);
+    chan_close(&p.server);
+    close(listen_fd);
+}
+
+void bench_ipc(void) {
+    const int listen_fd = ipc_listen(IPC_ENDPOINT);
+    if (listen_fd < 0) {
+        bench_skip("ipc", "nolisten");
+        return;
+    }
+
+    int client[2];
+    int server[2];
+
+    if (ipc_connect(IPC_ENDPOINT, client) != 0) {
+        close(listen_fd);
+        bench_skip("ipc", "noconnect");
+        return;
+    }
+
+    if (accept_one(listen_fd, server) != 0) {
+        close(client[0]);
+        close(client[1]);
+        close(listen_fd);
+        bench_skip("ipc", "noaccept");
+        return;
+    }
+
+    channel_t ch;
+    memset(&ch, 0, sizeof(ch));
+
+    ch.tx = client[1];
+    ch.rx = client[0];
+    ch.peer_rx = server[0];
+    ch.peer_tx = server[1];
+
+    run_channel(&ch, "ipc");
+
+    close(client[0]);
+    close(client[1]);
+    close(server[0]);
+    close(server[1]);
+    close(listen_fd);
+
+    bench_chan();
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+/*
+ * Userland benchmark suite, one binary for the whole family.
+ *
+ * Each result is a single "bench: name=<bench>/<variant> key=value ..."
+ * line: latencies carry samples/min_ns/median_ns/p99_ns, rates carry
+ * ops/total_ns/ops_per_s and bandwidths bytes/total_ns/kib_per_s. Two runs
+ * can be compared by diffing or joining those lines on name=.
+ *
+ * Usage: bench [-s] [list | all | <bench>...]
+ *   -s  also copy every result line to /dev/ttyS0
+ */
+
+typedef struct {
+    const char* name;
+    const char* what;
+    void (*run)(void);
+} bench_entry_t;
+
+static const bench_entry_t g_benches[] = {
+    { "proc",   "spawn + waitpid round trip",               bench_proc },
+    { "pipe",   "pipe latency, bandwidth and bulk transfers", bench_pipe },
+    { "ipc",    "ipc pipe pairs and channels: latency and bandwidth", bench_ipc },
+    { "shm",    "shm + futex ping-pong across processes",   bench_shm },
+    { "mmap",   "page fault throughput",                    bench_mmap },
+    { "fs",     "create/stat/unlink rates",                 bench_fs },
+    { "io",     "sequential and random file I/O",           bench_io },
+    { "poll",   "poll() cost against the number of fds",    bench_poll },
+    { "malloc", "malloc/free scaling with threads",         bench_malloc },
+    { "futex",  "condvar thundering herd and futex timeouts", bench_futex },
+    { "flux",   "surface commit-to-present latency",        bench_flux },
+    { "taskpool", "parallel_for and task spawn scaling",    bench_taskpool },
+    { "thread", "pthread create/join with cached and fresh stacks", bench_thread },
+};
+
+#define BENCH_COUNT (sizeof(g_benches) / sizeof(g_benches[0]))
+
+static void usage(void) {
+    printf("Usage: bench [-s] [list | all | <bench>...]\n");
+}
+
+static void list(void) {
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        printf("%-8s %s\n", g_benches[i].name, g_benches[i].what);
+    }
+}
+
+static const bench_entry_t* find(const char* name) {
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        if (strcmp(g_benches[i].name, name) == 0) {
+            return &g_benches[i];
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "--child") == 0) {
+        if (strcmp(argv[2], "nop") == 0) {
+            return bench_child_nop();
+        }
+
+        if (argc >= 4 && strcmp(argv[2], "shm") == 0) {
+            return bench_child_shm(argv[3]);
+        }
+
+        return 1;
+    }
+
+    int serial = 0;
+    int first = 1;
+
+    if (first < argc && strcmp(argv[first], "-s") == 0) {
+        serial = 1;
+        first++;
+    }
+
+    if (first < argc && strcmp(argv[first], "list") == 0) {
+        list();
+        return 0;
+    }
+
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], "all") != 0 && !find(argv[i])) {
+            printf("bench: unknown benchmark '%s'\n", argv[i]);
+            usage();
+            return 1;
+        }
+    }
+
+    if (bench_init(serial) != 0) {
+        printf("bench: cannot determine the TSC frequency\n");
+        return 1;
+    }
+
+    char line[96];
+    snprintf(line, sizeof(line), "bench: begin side=user tsc_khz=%u\n", g_bench_tsc_khz);
+    bench_emit(line);
+
+    int run_all = first >= argc;
+
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], "all") == 0) {
+            run_all = 1;
+        }
+    }
+
+    if (run_all) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+            g_benches[i].run();
+        }
+    } else {
+        for (int i = first; i < argc; i++) {
+            find(argv[i])->run();
+        }
+    }
+
+    bench_emit("bench: end side=user\n");
+
+    bench_fini();
+    return 0;
+}
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define MALLOC_MAX_THREADS 4u
+#define MALLOC_BATCH       64u
+#define MALLOC_ROUNDS      256u
+
+#define MALLOC_MIXED_SLOTS 256u
+#define MALLOC_MIXED_OPS   16384u
+
+#define MALLOC_BURST       1024u
+
+typedef struct {
+    int legacy;
+    legacy_tcache_t tcache;
+} malloc_impl_t;
+
+typedef struct {
+    malloc_impl_t impl;
+    uint32_t seed;
+    uint32_t ops;
+} malloc_worker_t;
+
+static inline void* impl_alloc(malloc_impl_t* m, uint32_t size) {
+    return m->legacy ? legacy_malloc(&m->tcache, size) : malloc(size);
+}
+
+static inline void impl_free(malloc_impl_t* m, void* p) {
+    if (m->legacy) {
+        legacy_free(&m->tcache, p);
+    } else {
+        free(p);
+    }
+}
+
+/* Batches of mixed small sizes, freed in reverse, like a short-lived working set. */
+static void* malloc_batch_worker(void* arg) {
+    malloc_worker_t* w = (malloc_worker_t*)arg;
+
+    void* objs[MALLOC_BATCH];
+    uint32_t seed = w->seed;
+    uint32_t ops = 0;
+
+    for (uint32_t r = 0; r < MALLOC_ROUNDS; r++) {
+        for (uint32_t i = 0; i < MALLOC_BATCH; i++) {
+            seed = seed * 1664525u + 1013904223u;
+
+            objs[i] = impl_alloc(&w->impl, 16u + ((seed >> 16) & 511u));
+            if (objs[i]) {
+                *(volatile uint8_t*)objs[i] = (uint8_t)i;
+            }
+        }
+
+        for (uint32_t i = MALLOC_BATCH; i-- > 0u;) {
+            impl_free(&w->impl, objs[i]);
+        }
+
+        ops += MALLOC_BATCH;
+    }
+
+    w->ops = ops;
+    return 0;
+}
+
+/*
+ * A long-lived set of blocks, one replaced at random per step. Sizes are
+ * mostly small with a tail up to 32 KiB, so frees land out of order and
+ * across every size range the small path covers.
+ */
+static void* malloc_mixed_worker(void* arg) {
+    malloc_worker_t* w = (malloc_worker_t*)arg;
+
+    void* slots[MALLOC_MIXED_SLOTS];
+    uint32_t seed = w->seed;
+
+    memset(slots, 0, sizeof(slots));
+
+    for (uint32_t i = 0; i < MALLOC_MIXED_OPS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+
+        const uint32_t slot = (seed >> 8) % MALLOC_MIXED_SLOTS;
+        const uint32_t size = ((seed >> 28) == 0u) ? 1u + ((seed >> 4) & 32767u)
+                                                   : 8u + ((seed >> 4) & 255u);
+
+        impl_free(&w->impl, slots[slot]);
+
+        slots[slot] = impl_alloc(&w->impl, size);
+        if (slots[slot]) {
+            *(volatile uint8_t*)slots[slot] = (uint8_t)i;
+        }
+    }
+
+    for (uint32_t i = 0; i < MALLOC_MIXED_SLOTS; i++) {
+        impl_free(&w->impl, slots[i]);
+    }
+
+    w->ops = MALLOC_MIXED_OPS;
+    return 0;
+}
+
+/* malloc+free pairs per second, all threads together. */
+static void malloc_run(const char* workload, void* (*fn)(void*), int legacy, uint32_t n) {
+    pthread_t tids[MALLOC_MAX_THREADS];
+    malloc_worker_t workers[MALLOC_MAX_THREADS];
+    uint32_t started = 0;
+
+    char name[48];
+    snprintf(name, sizeof(name), "%s/%s/%ut", workload, legacy ? "legacy" : "slab", n);
+
+    memset(workers, 0, sizeof(workers));
+
+    const uint64_t t0 = bench_clock();
+
+    for (uint32_t i = 0; i < n; i++) {
+        workers[i].impl.legacy = legacy;
+        workers[i].seed = 0x12345u + i * 7919u;
+
+        if (pthread_create(&tids[i], 0, fn, &workers[i]) != 0) {
+            break;
+        }
+
+        started++;
+    }
+
+    uint32_t ops = 0;
+
+    for (uint32_t i = 0; i < started; i++) {
+        (void)pthread_join(tids[i], 0);
+        ops += workers[i].ops;
+    }
+
+    const uint64_t t1 = bench_clock();
+
+    for (uint32_t i = 0; i < started; i++) {
+        if (legacy) {
+            legacy_tcache_flush(&workers[i].impl.tcache);
+        }
+    }
+
+    if (started != n) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    bench_report_rate(name, ops, t1 - t0);
+}
+
+/* How much of a freed burst of mid-sized blocks the heap hands back to the kernel. */
+static void malloc_release(void) {
+    static void* burst[MALLOC_BURST];
+
+    for (uint32_t i = 0; i < MALLOC_BURST; i++) {
+        burst[i] = malloc(4096u + (i & 7u) * 1024u);
+        if (burst[i]) {
+            memset(burst[i], 0xA5, 4096u);
+        }
+    }
+
+    for (uint32_t i = 0; i < MALLOC_BURST; i++) {
+        free(burst[i]);
+    }
+
+    malloc_stats_t st;
+    if (malloc_get_stats(&st) != 0) {
+        bench_skip("malloc_release", "nostats");
+        return;
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line),
+             "bench: name=malloc_release heap_kib=%u free_kib=%u released_kib=%u\n",
+             (unsigned)(st.heap_bytes >> 10), (unsigned)(st.heap_free_bytes >> 10),
+             (unsigned)(st.heap_released_bytes >> 10));
+    bench_emit(line);
+}
+
+void bench_malloc(void) {
+    static const uint32_t threads[] = { 1u, 2u, MALLOC_MAX_THREADS };
+
+    for (uint32_t c = 0; c < sizeof(threads) / sizeof(threads[0]); c++) {
+        malloc_run("malloc_free", malloc_batch_worker, 1, threads[c]);
+        malloc_run("malloc_free", malloc_batch_worker, 0, threads[c]);
+    }
+
+    for (uint32_t c = 0; c < sizeof(threads) / sizeof(threads[0]); c++) {
+        malloc_run("malloc_mixed", malloc_mixed_worker, 1, threads[c]);
+        malloc_run("malloc_mixed", malloc_mixed_worker, 0, threads[c]);
+    }
+
+    malloc_release();
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define MMAP_PAGE    4096u
+#define MMAP_PAGES   1024u
+#define MMAP_ROUNDS  4u
+
+/*
+ * Pages faulted in per second over a fresh /dev/zero mapping. With
+ * MADV_RANDOM every touch is its own fault; the default advice lets the
+ * fault-around path map neighbours ahead, and MAP_POPULATE does it all in
+ * mmap() itself. The populate line times mmap plus the touches.
+ */
+static void fault_pass(int zero_fd, const char* name, uint32_t advice, int flags) {
+    const uint32_t bytes = MMAP_PAGES * MMAP_PAGE;
+
+    uint64_t cycles = 0;
+    uint32_t pages = 0;
+
+    for (uint32_t r = 0; r < MMAP_ROUNDS; r++) {
+        const uint64_t t_map = bench_clock();
+
+        volatile uint8_t* p = (volatile uint8_t*)mmap(zero_fd, bytes, MAP_PRIVATE | flags);
+        if (bench_ptr_bad((const void*)p)) {
+            break;
+        }
+
+        if (advice != MADV_NORMAL) {
+            (void)madvise((void*)p, bytes, advice);
+        }
+
+        const uint64_t t0 = (flags & MAP_POPULATE) ? t_map : bench_clock();
+
+        for (uint32_t i = 0; i < MMAP_PAGES; i++) {
+            p[i * MMAP_PAGE] = 1u;
+        }
+
+        const uint64_t t1 = bench_clock();
+
+        cycles += t1 - t0;
+        pages += MMAP_PAGES;
+
+        (void)munmap((void*)p, bytes);
+    }
+
+    if (pages == 0u) {
+        bench_skip(name, "nomap");
+        return;
+    }
+
+    bench_report_rate(name, pages, cycles);
+}
+
+void bench_mmap(void) {
+    const int zero_fd = open("/dev/zero", 0);
+    if (zero_fd < 0) {
+        bench_skip("mmap_fault", "nozero");
+        return;
+    }
+
+    fault_pass(zero_fd, "mmap_fault/random", MADV_RANDOM, 0);
+    fault_pass(zero_fd, "mmap_fault/faultaround", MADV_NORMAL, 0);
+    fault_pass(zero_fd, "mmap_fault/populate", MADV_NORMAL, MAP_POPULATE);
+
+    close(zero_fd);
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define POLL_MAX_FDS 128u
+#define POLL_ITERS   256u
+
+/*
+ * Cost of one poll() call over N pipe read ends with exactly one ready,
+ * the last in the array, so the whole set is scanned every time.
+ */
+void bench_poll(void) {
+    static const uint32_t counts[] = { 1u, 8u, 32u, POLL_MAX_FDS };
+
+    static int fds[POLL_MAX_FDS][2];
+    static pollfd_t pfds[POLL_MAX_FDS];
+
+    uint32_t opened = 0;
+
+    while (opened < POLL_MAX_FDS && pipe(fds[opened]) == 0) {
+        opened++;
+    }
+
+    for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        const uint32_t n = counts[c];
+
+        char name[32];
+        snprintf(name, sizeof(name), "poll_one_ready/%u", n);
+
+        if (n > opened) {
+            bench_skip(name, "nofds");
+            continue;
+        }
+
+        const char byte = 1;
+        (void)write(fds[n - 1u][1], &byte, 1u);
+
+        for (uint32_t i = 0; i < n; i++) {
+            pfds[i].fd = fds[i][0];
+            pfds[i].events = POLLIN;
+        }
+
+        for (uint32_t it = 0; it < POLL_ITERS; it++) {
+            for (uint32_t i = 0; i < n; i++) {
+                pfds[i].revents = 0;
+            }
+
+            const uint64_t t0 = bench_clock();
+            const int r = poll(pfds, n, 0);
+            const uint64_t t1 = bench_clock();
+
+            if (r == 1) {
+                bench_sample(t1 - t0);
+            }
+        }
+
+        char drain;
+        (void)read(fds[n - 1u][0], &drain, 1u);
+
+        bench_report(name);
+    }
+
+    for (uint32_t i = 0; i < opened; i++) {
+        close(fds[i][0]);
+        close(fds[i][1]);
+    }
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define PROC_ITERS 64u
+
+int bench_child_nop(void) {
+    return 0;
+}
+
+/* Full cost of starting a program: exec of this binary, exit and reap. */
+void bench_proc(void) {
+    char* argv[] = { "bench", "--child", "nop", 0 };
+
+    for (uint32_t i = 0; i < PROC_ITERS; i++) {
+        const uint64_t t0 = bench_clock();
+
+        const int pid = spawn_process_resolved("bench", 3, argv);
+        if (pid < 0) {
+            break;
+        }
+
+        int status = 0;
+        (void)waitpid(pid, &status);
+
+        const uint64_t t1 = bench_clock();
+
+        bench_sample(t1 - t0);
+    }
+
+    bench_report("proc_spawn_wait");
+}
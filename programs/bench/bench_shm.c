@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define SHM_ITERS      512u
+#define SHM_WARM       16u
+#define SHM_SIZE       4096u
+#define SHM_READY_MS   2000u
+
+enum {
+    TURN_PARENT = 0,
+    TURN_CHILD,
+    TURN_REPLY,
+};
+
+/* Lives at the start of the shared page; futex keys are physical, so both mappings match. */
+typedef struct {
+    volatile uint32_t turn;
+    volatile uint32_t stop;
+    volatile uint32_t ready;
+} shm_pingpong_t;
+
+static void wait_turn(volatile uint32_t* word, uint32_t want) {
+    uint32_t cur;
+
+    while ((cur = __atomic_load_n(word, __ATOMIC_ACQUIRE)) != want) {
+        (void)futex_wait(word, cur);
+    }
+}
+
+int bench_child_shm(const char* shm_name) {
+    const int fd = shm_open_named(shm_name);
+    if (fd < 0) {
+        return 1;
+    }
+
+    shm_pingpong_t* pp = (shm_pingpong_t*)mmap(fd, SHM_SIZE, MAP_SHARED);
+    if (bench_ptr_bad(pp)) {
+        close(fd);
+        return 1;
+    }
+
+    __atomic_store_n(&pp->ready, 1u, __ATOMIC_RELEASE);
+
+    for (;;) {
+        wait_turn(&pp->turn, TURN_CHILD);
+
+        if (__atomic_load_n(&pp->stop, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        __atomic_store_n(&pp->turn, TURN_REPLY, __ATOMIC_RELEASE);
+        (void)futex_wake(&pp->turn, 1u);
+    }
+
+    (void)munmap(pp, SHM_SIZE);
+    close(fd);
+    return 0;
+}
+
+/*
+ * Round trip through a futex word in named shared memory between this
+ * process and a spawned copy of itself; half of it is one wake-to-run hop
+ * across address spaces.
+ */
+void bench_shm(void) {
+    char shm_name[32];
+    int fd = -1;
+
+    for (int i = 0; i < 8 && fd < 0; i++) {
+        snprintf(shm_name, sizeof(shm_name), "bench_shm_%d_%d", getpid(), i);
+        fd = shm_create_named(shm_name, SHM_SIZE);
+    }
+
+    if (fd < 0) {
+        bench_skip("shm_futex_pingpong", "noshm");
+        return;
+    }
+
+    shm_pingpong_t* pp = (shm_pingpong_t*)mmap(fd, SHM_SIZE, MAP_SHARED);
+    if (bench_ptr_bad(pp)) {
+        close(fd);
+        shm_unlink_named(shm_name);
+        bench_skip("shm_futex_pingpong", "nomap");
+        return;
+    }
+
+    memset(pp, 0, sizeof(*pp));
+
+    char* argv[] = { "bench", "--child", "shm", shm_name, 0 };
+
+    const int pid = spawn_process_resolved("bench", 4, argv);
+    if (pid < 0) {
+        (void)munmap(pp, SHM_SIZE);
+        close(fd);
+        shm_unlink_named(shm_name);
+        bench_skip("shm_futex_pingpong", "nospawn");
+        return;
+    }
+
+    const uint32_t start_ms = uptime_ms();
+
+    while (!__atomic_load_n(&pp->ready, __ATOMIC_ACQUIRE) && uptime_ms() - start_ms < SHM_READY_MS) {
+        usleep(1000u);
+    }
+
+    if (__atomic_load_n(&pp->ready, __ATOMIC_ACQUIRE)) {
+        for (uint32_t i = 0; i < SHM_WARM + SHM_ITERS; i++) {
+            const uint64_t t0 = bench_clock();
+
+            __atomic_store_n(&pp->turn, TURN_CHILD, __ATOMIC_RELEASE);
+            (void)futex_wake(&pp->turn, 1u);
+
+            wait_turn(&pp->turn, TURN_REPLY);
+
+            const uint64_t t1 = bench_clock();
+
+            if (i >= SHM_WARM) {
+                bench_sample((t1 - t0) / 2u);
+            }
+        }
+
+        __atomic_store_n(&pp->stop, 1u, __ATOMIC_RELEASE);
+        __atomic_store_n(&pp->turn, TURN_CHILD, __ATOMIC_RELEASE);
+        (void)futex_wake(&pp->turn, 1u);
+    } else {
+        (void)kill(pid);
+    }
+
+    int status = 0;
+    (void)waitpid(pid, &status);
+
+    bench_report("shm_futex_pingpong");
+
+    (void)munmap(pp, SHM_SIZE);
+    close(fd);
+    shm_unlink_named(shm_name);
+}
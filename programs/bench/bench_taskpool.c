@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define TASKPOOL_PFOR_ITEMS  (64u * 1024u)
+#define TASKPOOL_PFOR_ROUNDS 16u
+#define TASKPOOL_TREE_DEPTH  12u
+
+typedef struct {
+    uint32_t* data;
+    volatile uint32_t sum;
+} pfor_ctx_t;
+
+/* A few dozen cycles of work per item, so that the split and steal cost shows. */
+static void pfor_body(void* arg, uint32_t begin, uint32_t end) {
+    pfor_ctx_t* c = (pfor_ctx_t*)arg;
+    uint32_t acc = 0;
+
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t x = c->data[i];
+        for (uint32_t k = 0; k < 8u; k++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        c->data[i] = x;
+        acc += x;
+    }
+
+    __atomic_add_fetch(&c->sum, acc, __ATOMIC_RELAXED);
+}
+
+typedef struct {
+    taskpool_t* pool;
+    uint32_t depth;
+    volatile uint32_t* count;
+} tree_node_t;
+
+/* A binary tree of tasks that spawn their children and wait for them. */
+static void tree_task(void* arg) {
+    tree_node_t* n = (tree_node_t*)arg;
+
+    __atomic_add_fetch(n->count, 1u, __ATOMIC_RELAXED);
+    if (n->depth == 0u) return;
+
+    tree_node_t left = { n->pool, n->depth - 1u, n->count };
+    tree_node_t right = left;
+
+    task_group_t g;
+    task_group_init(&g);
+    task_group_spawn(n->pool, &g, tree_task, &left);
+    task_group_spawn(n->pool, &g, tree_task, &right);
+    task_group_wait(n->pool, &g);
+}
+
+static void taskpool_run(uint32_t threads, uint32_t* data) {
+    char name[40];
+
+    taskpool_t* pool = taskpool_create(threads, 0u);
+    if (!pool || taskpool_threads(pool) != threads) {
+        snprintf(name, sizeof(name), "taskpool/%ut", threads);
+        bench_skip(name, "nothread");
+        taskpool_destroy(pool);
+        return;
+    }
+
+    pfor_ctx_t ctx;
+    ctx.data = data;
+    ctx.sum = 0u;
+
+    uint64_t t0 = bench_clock();
+    for (uint32_t r = 0; r < TASKPOOL_PFOR_ROUNDS; r++) {
+        parallel_for(pool, 0u, TASKPOOL_PFOR_ITEMS, 0u, pfor_body, &ctx);
+    }
+    uint64_t t1 = bench_clock();
+
+    snprintf(name, sizeof(name), "parallel_for/%ut", threads);
+    bench_report_rate(name, TASKPOOL_PFOR_ITEMS * TASKPOOL_PFOR_ROUNDS, t1 - t0);
+
+    volatile uint32_t count = 0u;
+    tree_node_t root = { pool, TASKPOOL_TREE_DEPTH, &count };
+
+    t0 = bench_clock();
+    tree_task(&root);
+    t1 = bench_clock();
+
+    snprintf(name, sizeof(name), "task_spawn/%ut", threads);
+    bench_report_rate(name, count, t1 - t0);
+
+    taskpool_destroy(pool);
+}
+
+/* Items and tasks per second at one thread, two, and one per CPU. */
+void bench_taskpool(void) {
+    uint32_t* data = (uint32_t*)malloc(TASKPOOL_PFOR_ITEMS * sizeof(uint32_t));
+    if (!data) {
+        bench_skip("taskpool", "nomem");
+        return;
+    }
+
+    for (uint32_t i = 0; i < TASKPOOL_PFOR_ITEMS; i++) {
+        data[i] = i * 2654435761u + 1u;
+    }
+
+    const int nprocs = get_nprocs();
+    const uint32_t all = nprocs > 0 ? (uint32_t)nprocs : 1u;
+
+    taskpool_run(1u, data);
+    if (all != 2u) {
+        taskpool_run(2u, data);
+    }
+    if (all > 1u) {
+        taskpool_run(all > TASKPOOL_MAX_THREADS ? TASKPOOL_MAX_THREADS : all, data);
+    }
+
+    free(data);
+}
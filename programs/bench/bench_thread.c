@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include "bench.h"
+
+#define THREAD_ITERS 256u
+
+/* Past the stack cache's byte budget, so every thread maps and unmaps its own stack. */
+#define THREAD_UNCACHED_STACK (4u * 1024u * 1024u)
+
+static void* thread_nop(void* arg) {
+    return arg;
+}
+
+/* create+join pairs per second, one thread alive at a time. */
+static void thread_run(const char* name, uint32_t stack_size) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (stack_size) {
+        pthread_attr_setstacksize(&attr, stack_size);
+    }
+
+    /* Warm the stack cache and the first fault of the stack top. */
+    pthread_t tid;
+    if (pthread_create(&tid, &attr, thread_nop, 0) != 0) {
+        pthread_attr_destroy(&attr);
+        bench_skip(name, "nothread");
+        return;
+    }
+    (void)pthread_join(tid, 0);
+
+    uint32_t ops = 0;
+
+    const uint64_t t0 = bench_clock();
+
+    for (uint32_t i = 0; i < THREAD_ITERS; i++) {
+        if (pthread_create(&tid, &attr, thread_nop, 0) != 0) {
+            break;
+        }
+
+        (void)pthread_join(tid, 0);
+        ops++;
+    }
+
+    const uint64_t t1 = bench_clock();
+
+    pthread_attr_destroy(&attr);
+
+    if (ops != THREAD_ITERS) {
+        bench_skip(name, "nothread");
+        return;
+    }
+
+    bench_report_rate(name, ops, t1 - t0);
+}
+
+void bench_thread(void) {
+    thread_run("thread_create_join/cached", 0u);
+    thread_run("thread_create_join/uncached", THREAD_UNCACHED_STACK);
+}
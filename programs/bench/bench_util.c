@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yos/kbench.h>
+
+#include "bench.h"
+
+uint32_t g_bench_tsc_khz;
+
+static uint32_t g_samples[BENCH_MAX_SAMPLES];
+static uint32_t g_count;
+
+static int g_serial_fd = -1;
+
+/* Without /dev/kbench, count TSC ticks across a few hundred milliseconds. */
+static uint32_t calibrate_tsc_khz(void) {
+    const uint32_t start = uptime_ms();
+    while (uptime_ms() == start) {
+    }
+
+    const uint32_t t0_ms = uptime_ms();
+    const uint64_t t0 = bench_clock();
+
+    while (uptime_ms() - t0_ms < 250u) {
+    }
+
+    const uint32_t ms = uptime_ms() - t0_ms;
+    const uint64_t cycles = bench_clock() - t0;
+
+    return ms ? (uint32_t)(cycles / ms) : 0u;
+}
+
+int bench_init(int serial) {
+    int fd = open("/dev/kbench", 0);
+    if (fd >= 0) {
+        yos_kbench_info_t info;
+        memset(&info, 0, sizeof(info));
+
+        if (ioctl(fd, YOS_KBENCH_INFO, &info) == 0) {
+            g_bench_tsc_khz = info.tsc_khz;
+        }
+
+        close(fd);
+    }
+
+    if (g_bench_tsc_khz == 0u) {
+        g_bench_tsc_khz = calibrate_tsc_khz();
+    }
+
+    if (serial) {
+        g_serial_fd = open(BENCH_SERIAL_PATH, VFS_OPEN_WRITE);
+    }
+
+    return g_bench_tsc_khz ? 0 : -1;
+}
+
+void bench_fini(void) {
+    if (g_serial_fd >= 0) {
+        close(g_serial_fd);
+        g_serial_fd = -1;
+    }
+}
+
+uint32_t bench_ns(uint64_t cycles) {
+    if (g_bench_tsc_khz == 0u) {
+        return 0;
+    }
+
+    const uint64_t ns = (cycles * 1000000ull) / g_bench_tsc_khz;
+
+    return ns > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)ns;
+}
+
+void bench_sample(uint64_t cycles) {
+    if (g_count < BENCH_MAX_SAMPLES) {
+        g_samples[g_count++] = cycles > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)cycles;
+    }
+}
+
+void bench_emit(const char* line) {
+    printf("%s", line);
+
+    if (g_serial_fd >= 0) {
+        (void)write(g_serial_fd, line, (uint32_t)strlen(line));
+    }
+}
+
+static int u32_cmp(const void* a, const void* b) {
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    if (x != y) return x < y ? -1 : 1;
+    return 0;
+}
+
+void bench_report(const char* name) {
+    char line[160];
+
+    const uint32_t n = g_count;
+    g_count = 0;
+
+    if (n == 0u) {
+        bench_skip(name, "nosamples");
+        return;
+    }
+
+    qsort(g_samples, n, sizeof(uint32_t), u32_cmp);
+
+    uint32_t p99 = (n * 99u) / 100u;
+    if (p99 >= n) {
+        p99 = n - 1u;
+    }
+
+    snprintf(
+        line, sizeof(line),
+        "bench: name=%s samples=%u min_ns=%u median_ns=%u p99_ns=%u\n",
+        name, n, bench_ns(g_samples[0]), bench_ns(g_samples[n / 2u]), bench_ns(g_samples[p99])
+    );
+    bench_emit(line);
+}
+
+void bench_report_rate(const char* name, uint32_t ops, uint64_t cycles) {
+    char line[160];
+
+    const uint32_t ns = bench_ns(cycles);
+
+    snprintf(
+        line, sizeof(line),
+        "bench: name=%s ops=%u total_ns=%u ops_per_s=%u\n",
+        name, ops, ns, ns ? (uint32_t)(((uint64_t)ops * 1000000000ull) / ns) : 0u
+    );
+    bench_emit(line);
+}
+
+void bench_report_bytes(const char* name, uint32_t bytes, uint64_t cycles) {
+    char line[160];
+
+    const uint32_t ns = bench_ns(cycles);
+
+    snprintf(
+        line, sizeof(line),
+        "bench: name=%s bytes=%u total_ns=%u kib_per_s=%u\n",
+        name, bytes, ns, ns ? (uint32_t)(((uint64_t)bytes * 1000000000ull / 1024u) / ns) : 0u
+    );
+    bench_emit(line);
+}
+
+void bench_skip(const char* name, const char* why) {
+    char line[160];
+
+    snprintf(line, sizeof(line), "bench: name=%s skipped=%s\n", name, why);
+    bench_emit(line);
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+
+/*
+ * Print the kernel log from /dev/kmsg.
+ *
+ * Usage: dmesg [-w]
+ *   -w  keep running and print new messages as they are logged
+ */
+
+#define DMESG_POLL_MS 100
+
+static int dump(int fd) {
+    char buf[4096];
+    int total = 0;
+
+    for (;;) {
+        int n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            return total;
+        }
+
+        (void)write(1, buf, (uint32_t)n);
+        total += n;
+    }
+}
+
+int main(int argc, char** argv) {
+    int follow = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-w") == 0) {
+            follow = 1;
+        } else {
+            printf("Usage: dmesg [-w]\n");
+            return 1;
+        }
+    }
+
+    int fd = open("/dev/kmsg", 0);
+    if (fd < 0) {
+        printf("dmesg: cannot open /dev/kmsg\n");
+        return 1;
+    }
+
+    (void)dump(fd);
+
+    while (follow) {
+        if (dump(fd) == 0) {
+            sleep(DMESG_POLL_MS);
+        }
+    }
+
+    close(fd);
+    return 0;
+}
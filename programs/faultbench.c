@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+
+/*
+ * Page fault scaling benchmark.
+ *
+ * Every thread touches one byte per page of its own private mapping, so the
+ * only thing shared between them is the address space. The mappings are set
+ * up before the clock starts and torn down after it stops: only faults are
+ * timed. Chunks stay below the large page size and are marked MADV_RANDOM,
+ * so every touched page costs exactly one fault.
+ *
+ * The run is repeated for 1, 2, 4, ... threads up to the requested maximum;
+ * with per-region fault locking the fault rate should grow with the thread
+ * count until the CPUs run out.
+ *
+ * Usage: faultbench [max_threads] [pages_per_thread] [rounds]
+ */
+
+#define PAGE_SIZE_BYTES 4096u
+#define CHUNK_PAGES     256u
+#define MAX_THREADS     32u
+#define MAX_CHUNKS      64u
+
+typedef struct {
+    uint8_t* chunks[MAX_CHUNKS];
+    uint32_t chunk_count;
+    uint32_t pages;
+} worker_t;
+
+static worker_t g_workers[MAX_THREADS];
+
+static volatile uint32_t g_start;
+static volatile uint32_t g_done;
+
+static void* worker_main(void* arg) {
+    worker_t* w = (worker_t*)arg;
+
+    while (__atomic_load_n(&g_start, __ATOMIC_ACQUIRE) == 0u) {
+        __asm__ volatile("pause");
+    }
+
+    uint32_t left = w->pages;
+
+    for (uint32_t c = 0; c < w->chunk_count; c++) {
+        const uint32_t n = left < CHUNK_PAGES ? left : CHUNK_PAGES;
+        volatile uint8_t* p = w->chunks[c];
+
+        for (uint32_t i = 0; i < n; i++) {
+            p[i * PAGE_SIZE_BYTES] = (uint8_t)i;
+        }
+
+        left -= n;
+    }
+
+    __atomic_fetch_add(&g_done, 1u, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+static void unmap_workers(uint32_t threads) {
+    for (uint32_t t = 0; t < threads; t++) {
+        worker_t* w = &g_workers[t];
+
+        for (uint32_t c = 0; c < w->chunk_count; c++) {
+            (void)munmap(w->chunks[c], CHUNK_PAGES * PAGE_SIZE_BYTES);
+        }
+
+        w->chunk_count = 0;
+    }
+}
+
+static int map_workers(int zero_fd, uint32_t threads, uint32_t pages) {
+    const uint32_t bytes = CHUNK_PAGES * PAGE_SIZE_BYTES;
+    const uint32_t chunks = (pages + CHUNK_PAGES - 1u) / CHUNK_PAGES;
+
+    for (uint32_t t = 0; t < threads; t++) {
+        worker_t* w = &g_workers[t];
+
+        w->pages = pages;
+        w->chunk_count = 0;
+
+        for (uint32_t c = 0; c < chunks; c++) {
+            uint8_t* p = (uint8_t*)mmap(zero_fd, bytes, MAP_PRIVATE);
+            if (!p || p == (uint8_t*)-1) {
+                unmap_workers(t + 1u);
+                return -1;
+            }
+
+            (void)madvise(p, bytes, MADV_RANDOM);
+
+            w->chunks[w->chunk_count++] = p;
+        }
+    }
+
+    return 0;
+}
+
+/* Returns the elapsed time in ms, or -1 on failure. */
+static int run_once(int zero_fd, uint32_t threads, uint32_t pages) {
+    if (map_workers(zero_fd, threads, pages) != 0) {
+        printf("faultbench: mmap failed\n");
+        return -1;
+    }
+
+    pthread_t tids[MAX_THREADS];
+    uint32_t started = 0;
+
+    __atomic_store_n(&g_start, 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_done, 0u, __ATOMIC_RELAXED);
+
+    for (uint32_t t = 0; t < threads; t++) {
+        if (pthread_create(&tids[t], 0, worker_main, &g_workers[t]) != 0) {
+            break;
+        }
+
+        started++;
+    }
+
+    const uint32_t start = uptime_ms();
+
+    __atomic_store_n(&g_start, 1u, __ATOMIC_RELEASE);
+
+    while (__atomic_load_n(&g_done, __ATOMIC_ACQUIRE) < started) {
+        __asm__ volatile("pause");
+    }
+
+    const uint32_t elapsed = uptime_ms() - start;
+
+    for (uint32_t t = 0; t < started; t++) {
+        (void)pthread_join(tids[t], 0);
+    }
+
+    unmap_workers(threads);
+
+    if (started != threads) {
+        printf("faultbench: pthread_create failed\n");
+        return -1;
+    }
+
+    return (int)elapsed;
+}
+
+int main(int argc, char** argv) {
+    uint32_t max_threads = 4u;
+    uint32_t pages = 2048u;
+    uint32_t rounds = 3u;
+
+    if (argc >= 2) max_threads = (uint32_t)atoi(argv[1]);
+    if (argc >= 3) pages = (uint32_t)atoi(argv[2]);
+    if (argc >= 4) rounds = (uint32_t)atoi(argv[3]);
+
+    if (max_threads == 0u) max_threads = 1u;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+    if (pages == 0u) pages = 1u;
+    if (pages > MAX_CHUNKS * CHUNK_PAGES) pages = MAX_CHUNKS * CHUNK_PAGES;
+    if (rounds == 0u) rounds = 1u;
+
+    int zero_fd = open("/dev/zero", 0);
+    if (zero_fd < 0) {
+        printf("faultbench: cannot open /dev/zero\n");
+        return 1;
+    }
+
+    printf("faultbench: %u pages per thread, best of %u rounds\n", pages, rounds);
+
+    uint32_t base_rate = 0;
+
+    uint32_t threads = 1u;
+
+    for (;;) {
+        int best = -1;
+
+        for (uint32_t r = 0; r < rounds; r++) {
+            int ms = run_once(zero_fd, threads, pages);
+            if (ms < 0) {
+                close(zero_fd);
+                return 1;
+            }
+
+            if (best < 0 || ms < best) {
+                best = ms;
+            }
+        }
+
+        const uint32_t faults = threads * pages;
+        const uint32_t ms = best > 0 ? (uint32_t)best : 1u;
+        const uint32_t rate = (uint32_t)(((uint64_t)faults * 1000u) / ms);
+
+        if (threads == 1u) {
+            base_rate = rate ? rate : 1u;
+        }
+
+        const uint32_t scale = (uint32_t)(((uint64_t)rate * 100u) / base_rate);
+
+        printf(
+            "%2u threads: %7u faults %6u ms | %8u faults/s %8u per thread | x%u.%02u\n",
+            threads, faults, ms, rate, rate / threads, scale / 100u, scale % 100u
+        );
+
+        if (threads == max_threads) {
+            break;
+        }
+
+        threads = (threads * 2u > max_threads) ? max_threads : threads * 2u;
+    }
+
+    close(zero_fd);
+
+    return 0;
+}
@@ -19,6 +19,7 @@ void comp_buffer_destroy(comp_buffer_t* b) {
 void comp_client_disconnect(comp_client_t* c) {
     if (!c) return;
     c->connected = 0;
+    chan_close(&c->ch);
     if (c->fd_c2s >= 0) {
         close(c->fd_c2s);
         c->fd_c2s = -1;
@@ -57,10 +58,11 @@ void comp_client_disconnect(comp_client_t* c) {
     for (int i = 0; i < COMP_MAX_SURFACES; i++) {
         comp_surface_t* s = &c->surfaces[i];
         for (int bi = 0; bi < COMP_SURFACE_SHADOW_BUFS; bi++) {
-            if (s->shadow_pixels[bi] && s->shadow_size_bytes) {
-                munmap((void*)s->shadow_pixels[bi], s->shadow_size_bytes);
+            if (s->shadow_pixels[bi] && s->shadow_map_bytes[bi]) {
+                munmap((void*)s->shadow_pixels[bi], s->shadow_map_bytes[bi]);
             }
             s->shadow_pixels[bi] = 0;
+            s->shadow_map_bytes[bi] = 0;
             if (s->shadow_shm_fd[bi] >= 0) {
                 close(s->shadow_shm_fd[bi]);
             }
@@ -124,6 +126,7 @@ void comp_client_init(comp_client_t* c, int pid, int fd_c2s, int fd_s2c) {
     c->fd_c2s = fd_c2s;
     c->fd_s2c = fd_s2c;
     ipc_rx_reset(&c->rx);
+    chan_reset(&c->ch);
 
     c->input_ring_shm_fd = -1;
     c->input_ring_size_bytes = 0;
@@ -150,6 +153,34 @@ void comp_client_init(comp_client_t* c, int pid, int fd_c2s, int fd_s2c) {
     }
 }
 
+int comp_client_init_chan(comp_client_t* c, int pid, int chan_fd) {
+    if (!c) {
+        if (chan_fd >= 0) close(chan_fd);
+        return -1;
+    }
+
+    comp_client_init(c, pid, -1, -1);
+    if (chan_open(&c->ch, chan_fd) != 0) {
+        c->connected = 0;
+        return -1;
+    }
+    return 0;
+}
+
+int comp_client_can_send(const comp_client_t* c) {
+    if (!c || !c->connected) return 0;
+    return c->ch.shared || c->fd_s2c >= 0;
+}
+
+int comp_client_write_frame(comp_client_t* c, const void* buf, uint32_t size, int essential) {
+    if (!c) return -1;
+    if (c->ch.shared) {
+        (void)essential;
+        return chan_try_send(&c->ch, buf, size);
+    }
+    return pipe_try_write_frame(c->fd_s2c, buf, size, essential);
+}
+
 static int comp_surface_can_receive(const comp_surface_t* s) {
     if (!s || !s->in_use || !s->attached || !s->committed) return 0;
     if (!s->pixels || s->w <= 0 || s->h <= 0 || s->stride <= 0) return 0;
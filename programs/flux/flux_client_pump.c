@@ -1,16 +1,21 @@
 #include "flux_internal.h"
 
+static void comp_shadow_buf_free(comp_surface_t* s, int bi) {
+    if (s->shadow_pixels[bi] && s->shadow_map_bytes[bi]) {
+        munmap((void*)s->shadow_pixels[bi], s->shadow_map_bytes[bi]);
+    }
+    s->shadow_pixels[bi] = 0;
+    s->shadow_map_bytes[bi] = 0;
+    if (s->shadow_shm_fd[bi] >= 0) {
+        close(s->shadow_shm_fd[bi]);
+    }
+    s->shadow_shm_fd[bi] = -1;
+}
+
 void comp_surface_shadow_free(comp_surface_t* s) {
     if (!s) return;
     for (int bi = 0; bi < COMP_SURFACE_SHADOW_BUFS; bi++) {
-        if (s->shadow_pixels[bi] && s->shadow_size_bytes) {
-            munmap((void*)s->shadow_pixels[bi], s->shadow_size_bytes);
-        }
-        s->shadow_pixels[bi] = 0;
-        if (s->shadow_shm_fd[bi] >= 0) {
-            close(s->shadow_shm_fd[bi]);
-        }
-        s->shadow_shm_fd[bi] = -1;
+        comp_shadow_buf_free(s, bi);
     }
     s->shadow_size_bytes = 0;
     s->shadow_stride = 0;
@@ -18,6 +23,43 @@ void comp_surface_shadow_free(comp_surface_t* s) {
     s->shadow_valid = 0;
 }
 
+/* Keep the buffers for the next comp_surface_shadow_ensure() to resize, drop what they hold. */
+void comp_surface_shadow_invalidate(comp_surface_t* s) {
+    if (!s) return;
+    s->shadow_active = 0;
+    s->shadow_valid = 0;
+}
+
+/* Resize the object in place; the mapping is only redone when it has to grow. */
+static int comp_shadow_buf_resize(comp_surface_t* s, int bi, uint32_t need) {
+    if (!s->shadow_pixels[bi] || s->shadow_shm_fd[bi] < 0) return -1;
+    if (shm_resize(s->shadow_shm_fd[bi], need) != 0) return -1;
+    if (need <= s->shadow_map_bytes[bi]) return 0;
+
+    uint32_t* px = (uint32_t*)mmap(s->shadow_shm_fd[bi], need, MAP_SHARED);
+    if (!px) return -1;
+
+    munmap((void*)s->shadow_pixels[bi], s->shadow_map_bytes[bi]);
+    s->shadow_pixels[bi] = px;
+    s->shadow_map_bytes[bi] = need;
+    return 0;
+}
+
+static int comp_shadow_buf_create(comp_surface_t* s, int bi, uint32_t need) {
+    int fd = shm_create(need);
+    if (fd < 0) return -1;
+
+    uint32_t* px = (uint32_t*)mmap(fd, need, MAP_SHARED);
+    if (!px) {
+        close(fd);
+        return -1;
+    }
+    s->shadow_shm_fd[bi] = fd;
+    s->shadow_pixels[bi] = px;
+    s->shadow_map_bytes[bi] = need;
+    return 0;
+}
+
 static int comp_surface_shadow_ensure(comp_surface_t* s) {
     if (!s) return -1;
     if (!s->pixels || s->w <= 0 || s->h <= 0 || s->stride <= 0) return -1;
@@ -34,27 +76,19 @@ static int comp_surface_shadow_ensure(comp_surface_t* s) {
         if (ok) return 0;
     }
 
-    comp_surface_shadow_free(s);
-
     s->shadow_size_bytes = need;
     s->shadow_stride = s->stride;
     s->shadow_active = 0;
     s->shadow_valid = 0;
 
     for (int bi = 0; bi < COMP_SURFACE_SHADOW_BUFS; bi++) {
-        int fd = shm_create(need);
-        if (fd < 0) {
-            comp_surface_shadow_free(s);
-            return -1;
-        }
-        uint32_t* px = (uint32_t*)mmap(fd, need, MAP_SHARED);
-        if (!px) {
-            close(fd);
+        if (comp_shadow_buf_resize(s, bi, need) == 0) continue;
+
+        comp_shadow_buf_free(s, bi);
+        if (comp_shadow_buf_create(s, bi, need) != 0) {
             comp_surface_shadow_free(s);
             return -1;
         }
-        s->shadow_shm_fd[bi] = fd;
-        s->shadow_pixels[bi] = px;
     }
     return 0;
 }
@@ -106,8 +140,8 @@ static int comp_surface_shadow_snapshot_try(comp_surface_t* s, uint32_t* dst) {
     return 1;
 }
 
-static int comp_send_reply(int fd, uint16_t type, uint32_t seq, const void* payload, uint32_t payload_len) {
-    if (fd < 0) return -1;
+static int comp_send_reply(comp_client_t* c, uint16_t type, uint32_t seq, const void* payload, uint32_t payload_len) {
+    if (!comp_client_can_send(c)) return -1;
     if (payload_len > COMP_IPC_MAX_PAYLOAD) return -1;
 
     comp_ipc_hdr_t h;
@@ -117,39 +151,50 @@ static int comp_send_reply(int fd, uint16_t type, uint32_t seq, const void* payl
     h.len = payload_len;
     h.seq = seq;
 
+    const uint32_t frame_size = (uint32_t)(sizeof(h) + payload_len);
+
+    if (c->ch.shared) {
+        uint8_t* dst = (uint8_t*)chan_send_reserve(&c->ch, frame_size);
+        if (!dst) return -1;
+
+        memcpy(dst, &h, sizeof(h));
+        if (payload_len) {
+            memcpy(dst + sizeof(h), payload, payload_len);
+        }
+        return chan_send_commit(&c->ch);
+    }
+
     uint8_t frame[sizeof(h) + COMP_IPC_MAX_PAYLOAD];
     memcpy(frame, &h, sizeof(h));
     if (payload_len) {
         memcpy(frame + sizeof(h), payload, payload_len);
     }
 
-    const uint32_t frame_size = (uint32_t)(sizeof(h) + payload_len);
-    
-    int r = pipe_try_write(fd, frame, frame_size);
+    int r = pipe_try_write(c->fd_s2c, frame, frame_size);
     
     return (r == (int)frame_size) ? 0 : -1;
 }
 
-static void comp_send_ack(int fd, uint32_t seq, uint16_t req_type, uint32_t surface_id, uint32_t flags) {
+static void comp_send_ack(comp_client_t* c, uint32_t seq, uint16_t req_type, uint32_t surface_id, uint32_t flags) {
     comp_ipc_ack_t a;
     a.req_type = req_type;
     a.reserved = 0;
     a.surface_id = surface_id;
     a.flags = flags;
-    (void)comp_send_reply(fd, (uint16_t)COMP_IPC_MSG_ACK, seq, &a, (uint32_t)sizeof(a));
+    (void)comp_send_reply(c, (uint16_t)COMP_IPC_MSG_ACK, seq, &a, (uint32_t)sizeof(a));
 }
 
-static void comp_send_error(int fd, uint32_t seq, uint16_t req_type, uint16_t code, uint32_t surface_id, uint32_t detail) {
+static void comp_send_error(comp_client_t* c, uint32_t seq, uint16_t req_type, uint16_t code, uint32_t surface_id, uint32_t detail) {
     comp_ipc_error_t e;
     e.req_type = req_type;
     e.code = code;
     e.surface_id = surface_id;
     e.detail = detail;
-    (void)comp_send_reply(fd, (uint16_t)COMP_IPC_MSG_ERROR, seq, &e, (uint32_t)sizeof(e));
+    (void)comp_send_reply(c, (uint16_t)COMP_IPC_MSG_ERROR, seq, &e, (uint32_t)sizeof(e));
 }
 
 static void comp_client_send_input_ring_name(comp_client_t* c, uint32_t seq) {
-    if (!c || !c->connected || c->fd_s2c < 0) return;
+    if (!comp_client_can_send(c)) return;
     if (c->input_ring || c->input_ring_shm_fd >= 0 || c->input_ring_enabled) return;
     if (c->pid <= 0) return;
 
@@ -197,20 +242,22 @@ static void comp_client_send_input_ring_name(comp_client_t* c, uint32_t seq) {
     msg.cap = COMP_INPUT_RING_CAP;
     memcpy(msg.shm_name, name, sizeof(msg.shm_name));
 
-    (void)comp_send_reply(c->fd_s2c, (uint16_t)COMP_IPC_MSG_INPUT_RING_NAME, seq, &msg, (uint32_t)sizeof(msg));
+    (void)comp_send_reply(c, (uint16_t)COMP_IPC_MSG_INPUT_RING_NAME, seq, &msg, (uint32_t)sizeof(msg));
 }
 
-void comp_client_pump(comp_client_t* c,
-                      const comp_buffer_t* buf,
-                      uint32_t* z_counter,
-                      wm_conn_t* wm,
-                      uint32_t client_id,
-                      comp_input_state_t* input) {
-    if (!c || !c->connected || c->fd_c2s < 0) return;
-    if (!z_counter) return;
+void comp_client_send_present_acks(comp_client_t* c) {
+    if (!comp_client_can_send(c)) return;
 
-    int saw_eof = 0;
+    for (int si = 0; si < COMP_MAX_SURFACES; si++) {
+        comp_surface_t* s = &c->surfaces[si];
+        if (!s->present_ack_pending) continue;
+
+        s->present_ack_pending = 0;
+        comp_send_ack(c, s->present_ack_seq, (uint16_t)COMP_IPC_MSG_COMMIT, s->id, COMP_IPC_ACK_FLAG_PRESENTED);
+    }
+}
 
+static void comp_client_fill_rx(comp_client_t* c, int* saw_eof) {
     for (;;) {
         const uint32_t cap = (uint32_t)sizeof(c->rx.buf);
         uint32_t count = ipc_rx_count(&c->rx);
@@ -224,16 +271,18 @@ void comp_client_pump(comp_client_t* c,
         if (want > (uint32_t)sizeof(tmp)) want = (uint32_t)sizeof(tmp);
         int rn = pipe_try_read(c->fd_c2s, tmp, want);
         if (rn < 0) {
-            saw_eof = 1;
+            *saw_eof = 1;
             break;
         }
         if (rn == 0) break;
         ipc_rx_push(&c->rx, tmp, (uint32_t)rn);
     }
+}
 
+static int comp_client_pipe_next_frame(comp_client_t* c, comp_ipc_hdr_t* hdr, uint8_t* payload) {
     for (;;) {
         uint32_t avail = ipc_rx_count(&c->rx);
-        if (avail < 4) break;
+        if (avail < 4) return 0;
 
         uint32_t magic;
         ipc_rx_peek(&c->rx, 0, &magic, 4);
@@ -242,35 +291,96 @@ void comp_client_pump(comp_client_t* c,
             continue;
         }
 
-        if (avail < (uint32_t)sizeof(comp_ipc_hdr_t)) break;
+        if (avail < (uint32_t)sizeof(*hdr)) return 0;
 
-        comp_ipc_hdr_t hdr;
-        ipc_rx_peek(&c->rx, 0, &hdr, (uint32_t)sizeof(hdr));
+        ipc_rx_peek(&c->rx, 0, hdr, (uint32_t)sizeof(*hdr));
 
-        if (hdr.version != COMP_IPC_VERSION) {
+        if (hdr->version != COMP_IPC_VERSION) {
             ipc_rx_drop(&c->rx, 1);
             continue;
         }
-        if (hdr.len > COMP_IPC_MAX_PAYLOAD) {
+        if (hdr->len > COMP_IPC_MAX_PAYLOAD) {
             ipc_rx_drop(&c->rx, 1);
             continue;
         }
 
-        uint32_t frame_len = (uint32_t)sizeof(hdr) + hdr.len;
-        if (avail < frame_len) break;
+        uint32_t frame_len = (uint32_t)sizeof(*hdr) + hdr->len;
+        if (avail < frame_len) return 0;
 
-        ipc_rx_drop(&c->rx, (uint32_t)sizeof(hdr));
-        uint8_t payload[COMP_IPC_MAX_PAYLOAD];
-        if (hdr.len) {
-            ipc_rx_peek(&c->rx, 0, payload, hdr.len);
-            ipc_rx_drop(&c->rx, hdr.len);
+        ipc_rx_drop(&c->rx, (uint32_t)sizeof(*hdr));
+        if (hdr->len) {
+            ipc_rx_peek(&c->rx, 0, payload, hdr->len);
+            ipc_rx_drop(&c->rx, hdr->len);
         }
+        return 1;
+    }
+}
+
+/* A channel message is exactly one frame; anything else is dropped whole. */
+static int comp_client_chan_next_frame(comp_client_t* c, comp_ipc_hdr_t* hdr, uint8_t* payload, int* saw_eof) {
+    for (;;) {
+        const void* msg = 0;
+        uint32_t len = 0;
+
+        int r = chan_recv_peek(&c->ch, &msg, &len);
+        if (r < 0) {
+            *saw_eof = 1;
+            return 0;
+        }
+        if (r == 0) return 0;
+
+        int ok = 0;
+        if (len >= (uint32_t)sizeof(*hdr)) {
+            memcpy(hdr, msg, sizeof(*hdr));
+            ok = hdr->magic == COMP_IPC_MAGIC
+                && hdr->version == COMP_IPC_VERSION
+                && hdr->len <= COMP_IPC_MAX_PAYLOAD
+                && len == (uint32_t)sizeof(*hdr) + hdr->len;
+        }
+
+        if (ok && hdr->len) {
+            memcpy(payload, (const uint8_t*)msg + sizeof(*hdr), hdr->len);
+        }
+        chan_recv_done(&c->ch);
+
+        if (ok) return 1;
+    }
+}
+
+void comp_client_pump(comp_client_t* c,
+                      const comp_buffer_t* buf,
+                      uint32_t* z_counter,
+                      wm_conn_t* wm,
+                      uint32_t client_id,
+                      comp_input_state_t* input) {
+    if (!c || !c->connected || (c->fd_c2s < 0 && !c->ch.shared)) return;
+    if (!z_counter) return;
+
+    int saw_eof = 0;
+
+    /* The pipe path is bounded by its rx buffer; a channel keeps refilling while we drain it. */
+    uint32_t chan_budget = COMP_CHAN_PUMP_MAX_FRAMES;
+
+    if (!c->ch.shared) {
+        comp_client_fill_rx(c, &saw_eof);
+    }
+
+    for (;;) {
+        comp_ipc_hdr_t hdr;
+        uint8_t payload[COMP_IPC_MAX_PAYLOAD];
+
+        if (c->ch.shared && chan_budget-- == 0u) break;
+
+        const int got = c->ch.shared
+            ? comp_client_chan_next_frame(c, &hdr, payload, &saw_eof)
+            : comp_client_pipe_next_frame(c, &hdr, payload);
+        if (!got) break;
 
         if (hdr.type == COMP_IPC_MSG_HELLO && hdr.len == (uint32_t)sizeof(comp_ipc_hello_t)) {
             comp_ipc_hello_t h;
             memcpy(&h, payload, sizeof(h));
             c->pid = (int)h.client_pid;
-            comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, 0u, 0u);
+            comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, 0u, 0u);
 
             comp_client_send_input_ring_name(c, 0u);
         } else if (hdr.type == COMP_IPC_MSG_INPUT_RING_ACK && hdr.len == 0u) {
@@ -281,19 +391,19 @@ void comp_client_pump(comp_client_t* c,
                     c->input_ring_shm_name[0] = '\0';
                 }
             }
-            comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, 0u, 0u);
+            comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, 0u, 0u);
         } else if (hdr.type == COMP_IPC_MSG_ATTACH_SHM && hdr.len == (uint32_t)sizeof(comp_ipc_attach_shm_t)) {
             comp_ipc_attach_shm_t a;
             memcpy(&a, payload, sizeof(a));
 
             comp_surface_t* s = comp_client_surface_get(c, a.surface_id, 1);
             if (!s) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
 
             if (!(buf && buf->pixels && buf->shm_fd >= 0 && (int)a.shm_fd == buf->shm_fd)) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
 
@@ -305,7 +415,7 @@ void comp_client_pump(comp_client_t* c,
                     s->shm_fd = -1;
                     s->size_bytes = 0;
                 }
-                comp_surface_shadow_free(s);
+                comp_surface_shadow_invalidate(s);
                 s->attached = 1;
                 s->pixels = buf->pixels;
                 s->w = (int)a.width;
@@ -316,38 +426,38 @@ void comp_client_pump(comp_client_t* c,
                 s->damage_committed_count = 0u;
                 s->damage_committed_gen = 0u;
             }
-            comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, a.surface_id, 0);
+            comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, a.surface_id, 0);
         } else if (hdr.type == COMP_IPC_MSG_ATTACH_SHM_NAME && hdr.len == (uint32_t)sizeof(comp_ipc_attach_shm_name_t)) {
             comp_ipc_attach_shm_name_t a;
             memcpy(&a, payload, sizeof(a));
 
             comp_surface_t* s = comp_client_surface_get(c, a.surface_id, 1);
             if (!s) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
 
             if (a.width == 0 || a.height == 0) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
             if (a.stride == 0) a.stride = a.width;
             if (a.stride < a.width) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
 
             uint64_t min_size = (uint64_t)a.height * (uint64_t)a.stride * 4ull;
             if (min_size == 0) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
             if (a.size_bytes < (uint32_t)min_size) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
             if (a.size_bytes > (64u * 1024u * 1024u)) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
 
@@ -355,42 +465,45 @@ void comp_client_pump(comp_client_t* c,
             memcpy(name, a.shm_name, sizeof(name));
             name[sizeof(name) - 1u] = '\0';
             if (name[0] == '\0') {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, a.surface_id, 0);
                 continue;
             }
 
             if (s->owns_buffer && s->pixels && s->shm_fd >= 0 && s->size_bytes >= a.size_bytes && memcmp(s->shm_name, name, sizeof(s->shm_name)) == 0) {
                 s->attached = 1;
                 s->committed = 0;
-                comp_surface_shadow_free(s);
+                comp_surface_shadow_invalidate(s);
                 s->w = (int)a.width;
                 s->h = (int)a.height;
                 s->stride = (int)a.stride;
-                comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, a.surface_id, 0);
+                comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, a.surface_id, 0);
                 continue;
             }
 
-            int shm_fd = shm_open_named(name);
+            /* Same name, larger size: the client grew the object in place, only our mapping is short. */
+            const int grown = s->owns_buffer && s->shm_fd >= 0 && memcmp(s->shm_name, name, sizeof(s->shm_name)) == 0;
+
+            int shm_fd = grown ? s->shm_fd : shm_open_named(name);
             if (shm_fd < 0) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_SHM_OPEN, a.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_SHM_OPEN, a.surface_id, 0);
                 continue;
             }
 
             uint32_t* pixels = (uint32_t*)mmap(shm_fd, a.size_bytes, MAP_SHARED);
             if (!pixels) {
-                close(shm_fd);
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_SHM_MAP, a.surface_id, 0);
+                if (!grown) close(shm_fd);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_SHM_MAP, a.surface_id, 0);
                 continue;
             }
 
             if (s->owns_buffer) {
                 if (s->pixels && s->size_bytes) munmap((void*)s->pixels, s->size_bytes);
-                if (s->shm_fd >= 0) close(s->shm_fd);
+                if (s->shm_fd >= 0 && !grown) close(s->shm_fd);
             }
 
             s->attached = 1;
             s->committed = 0;
-            comp_surface_shadow_free(s);
+            comp_surface_shadow_invalidate(s);
             s->pixels = pixels;
             s->w = (int)a.width;
             s->h = (int)a.height;
@@ -402,10 +515,10 @@ void comp_client_pump(comp_client_t* c,
             s->damage_pending_count = 0u;
             s->damage_committed_count = 0u;
             s->damage_committed_gen = 0u;
-            comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, a.surface_id, 0);
+            comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, a.surface_id, 0);
         } else if (hdr.type == COMP_IPC_MSG_DAMAGE) {
             if (hdr.len < (uint32_t)sizeof(comp_ipc_damage_t)) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, 0u, 0u);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, 0u, 0u);
                 continue;
             }
 
@@ -413,19 +526,19 @@ void comp_client_pump(comp_client_t* c,
             const uint32_t rc = d->rect_count;
 
             if (d->surface_id == 0u || rc > COMP_IPC_DAMAGE_MAX_RECTS) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, d->surface_id, 0u);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, d->surface_id, 0u);
                 continue;
             }
 
             const uint32_t want_len = (uint32_t)sizeof(comp_ipc_damage_t) + rc * (uint32_t)sizeof(comp_ipc_rect_t);
             if (want_len != hdr.len) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, d->surface_id, 0u);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_INVALID, d->surface_id, 0u);
                 continue;
             }
 
             comp_surface_t* s = comp_client_surface_get(c, d->surface_id, 0);
             if (!(s && s->attached)) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_NO_SURFACE, d->surface_id, 0u);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_NO_SURFACE, d->surface_id, 0u);
                 continue;
             }
 
@@ -434,14 +547,14 @@ void comp_client_pump(comp_client_t* c,
                 memcpy(s->damage_pending, d->rects, rc * (uint32_t)sizeof(comp_ipc_rect_t));
             }
 
-            comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, d->surface_id, 0u);
+            comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, d->surface_id, 0u);
         } else if (hdr.type == COMP_IPC_MSG_COMMIT && hdr.len == (uint32_t)sizeof(comp_ipc_commit_t)) {
             comp_ipc_commit_t cm;
             memcpy(&cm, payload, sizeof(cm));
 
             comp_surface_t* s = comp_client_surface_get(c, cm.surface_id, 0);
             if (!(s && s->attached)) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_NO_SURFACE, cm.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_NO_SURFACE, cm.surface_id, 0);
                 continue;
             }
             {
@@ -516,7 +629,11 @@ void comp_client_pump(comp_client_t* c,
                 }
             }
             if (cm.flags & COMP_IPC_COMMIT_FLAG_ACK) {
-                comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, cm.surface_id, 0);
+                comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, cm.surface_id, 0);
+            }
+            if (cm.flags & COMP_IPC_COMMIT_FLAG_PRESENTED) {
+                s->present_ack_pending = 1;
+                s->present_ack_seq = hdr.seq;
             }
         } else if (hdr.type == COMP_IPC_MSG_DESTROY_SURFACE && hdr.len == (uint32_t)sizeof(comp_ipc_destroy_surface_t)) {
             comp_ipc_destroy_surface_t d;
@@ -524,7 +641,7 @@ void comp_client_pump(comp_client_t* c,
 
             comp_surface_t* s = comp_client_surface_get(c, d.surface_id, 0);
             if (!s) {
-                comp_send_error(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_NO_SURFACE, d.surface_id, 0);
+                comp_send_error(c, hdr.seq, (uint16_t)hdr.type, (uint16_t)COMP_IPC_ERR_NO_SURFACE, d.surface_id, 0);
                 continue;
             }
 
@@ -541,7 +658,7 @@ void comp_client_pump(comp_client_t* c,
             for (int bi = 0; bi < COMP_SURFACE_SHADOW_BUFS; bi++) {
                 s->shadow_shm_fd[bi] = -1;
             }
-            comp_send_ack(c->fd_s2c, hdr.seq, (uint16_t)hdr.type, d.surface_id, 0);
+            comp_send_ack(c, hdr.seq, (uint16_t)hdr.type, d.surface_id, 0);
 
             if (wm && wm->connected) {
                 comp_ipc_wm_event_t ev;
@@ -72,7 +72,7 @@ static int comp_client_send_input_ring(comp_client_t* c, const comp_ipc_input_t*
 static int comp_client_send_input_ex(comp_client_t* c, const comp_ipc_input_t* in, int essential, int* out_sent) {
     if (out_sent) *out_sent = 0;
     if (!c || !in) return 0;
-    if (!c->connected || c->fd_s2c < 0) return 0;
+    if (!comp_client_can_send(c)) return 0;
 
     if (comp_client_send_input_ring(c, in, essential, out_sent)) {
         return 0;
@@ -89,7 +89,7 @@ static int comp_client_send_input_ex(comp_client_t* c, const comp_ipc_input_t* i
     memcpy(frame, &hdr, sizeof(hdr));
     memcpy(frame + sizeof(hdr), in, sizeof(*in));
 
-    int wr = pipe_try_write_frame(c->fd_s2c, frame, (uint32_t)sizeof(frame), essential);
+    int wr = comp_client_write_frame(c, frame, (uint32_t)sizeof(frame), essential);
     if (wr < 0) return -1;
     if (out_sent) *out_sent = (wr == 1);
     return 0;
@@ -384,7 +384,7 @@ int comp_send_mouse(comp_client_t* clients, int nclients, comp_input_state_t* st
     }
 
     comp_client_t* c = &clients[ci];
-    if (!c->connected || c->fd_s2c < 0) return 0;
+    if (!comp_client_can_send(c)) return 0;
 
     comp_ipc_input_t in;
     in.surface_id = sid;
@@ -420,7 +420,7 @@ int comp_send_key(comp_client_t* clients, int nclients, comp_input_state_t* st,
     if (st->focus_client < 0 || st->focus_client >= nclients) return 0;
 
     comp_client_t* c = &clients[st->focus_client];
-    if (!c->connected || c->fd_s2c < 0) return 0;
+    if (!comp_client_can_send(c)) return 0;
     if (!comp_client_surface_id_valid(c, st->focus_surface_id)) return 0;
 
     comp_ipc_input_t in;
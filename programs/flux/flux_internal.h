@@ -77,6 +77,8 @@ void ipc_rx_drop(ipc_rx_ring_t* q, uint32_t n);
 #define COMP_MAX_SURFACES 8
 #define COMP_CLIENTS_INIT 8
 
+#define COMP_CHAN_PUMP_MAX_FRAMES 256u
+
 #define COMP_SURFACE_SHADOW_BUFS 2
 
 typedef struct {
@@ -112,6 +114,7 @@ typedef struct {
     uint32_t* shadow_pixels[COMP_SURFACE_SHADOW_BUFS];
     int shadow_stride;
     uint32_t shadow_size_bytes;
+    uint32_t shadow_map_bytes[COMP_SURFACE_SHADOW_BUFS];
     int shadow_shm_fd[COMP_SURFACE_SHADOW_BUFS];
     int shadow_active;
     int shadow_valid;
@@ -127,9 +130,13 @@ typedef struct {
     uint32_t damage_committed_count;
     uint32_t damage_committed_gen;
     comp_ipc_rect_t damage_committed[COMP_IPC_DAMAGE_MAX_RECTS];
+
+    int present_ack_pending;
+    uint32_t present_ack_seq;
 } comp_surface_t;
 
 void comp_surface_shadow_free(comp_surface_t* s);
+void comp_surface_shadow_invalidate(comp_surface_t* s);
 
 typedef struct {
     int connected;
@@ -138,6 +145,9 @@ typedef struct {
     int fd_s2c;
     ipc_rx_ring_t rx;
 
+    /* Set up instead of the pipes for clients that connected with ipc_connect_chan(). */
+    chan_t ch;
+
     int input_ring_shm_fd;
     uint32_t input_ring_size_bytes;
     char input_ring_shm_name[32];
@@ -230,6 +240,9 @@ void comp_buffer_destroy(comp_buffer_t* b);
 void comp_client_disconnect(comp_client_t* c);
 comp_surface_t* comp_client_surface_get(comp_client_t* c, uint32_t id, int create);
 void comp_client_init(comp_client_t* c, int pid, int fd_c2s, int fd_s2c);
+int comp_client_init_chan(comp_client_t* c, int pid, int chan_fd);
+int comp_client_can_send(const comp_client_t* c);
+int comp_client_write_frame(comp_client_t* c, const void* buf, uint32_t size, int essential);
 comp_surface_t* comp_client_surface_find(const comp_client_t* c, uint32_t id);
 int comp_client_surface_id_valid(const comp_client_t* c, uint32_t id);
 int comp_pick_surface_at(comp_client_t* clients, int nclients, int x, int y, int* out_client, uint32_t* out_sid, comp_surface_t** out_s);
@@ -241,6 +254,7 @@ int comp_send_mouse(comp_client_t* clients, int nclients, comp_input_state_t* st
 int comp_send_key(comp_client_t* clients, int nclients, comp_input_state_t* st, uint32_t keycode, uint32_t key_state);
 int comp_client_send_input(comp_client_t* c, const comp_ipc_input_t* in, int essential);
 int comp_client_try_send_input(comp_client_t* c, const comp_ipc_input_t* in);
+void comp_client_send_present_acks(comp_client_t* c);
 
 void comp_client_pump(comp_client_t* c,
                        const comp_buffer_t* buf,
@@ -40,6 +40,82 @@ typedef struct {
     int si;
 } draw_item_t;
 
+/* Damage is composed in bands of this many rows, one task per band. */
+#define COMPOSE_BAND_ROWS 32
+
+typedef struct {
+    uint32_t* out;
+    int stride;
+    int w;
+    int h;
+    uint32_t bg;
+
+    const comp_damage_t* dmg;
+    comp_client_t* clients;
+    const draw_item_t* order;
+    int order_n;
+
+    int redraw;
+    int draw_preview;
+    comp_rect_t preview_rect;
+
+    int focus_client;
+    uint32_t focus_surface_id;
+} compose_ctx_t;
+
+/*
+ * Every damage rect is cut down to the band rows, so bands write disjoint
+ * pixels and can be composed in parallel. Within a band the rects are
+ * drawn in order, as before.
+ */
+static void compose_bands(void* arg, uint32_t band_begin, uint32_t band_end) {
+    const compose_ctx_t* c = (const compose_ctx_t*)arg;
+    const uint32_t preview_col = 0x007ACC;
+
+    comp_rect_t band;
+    band.x1 = 0;
+    band.y1 = (int)(band_begin * COMPOSE_BAND_ROWS);
+    band.x2 = c->w;
+    band.y2 = (int)(band_end * COMPOSE_BAND_ROWS);
+    if (band.y2 > c->h) band.y2 = c->h;
+
+    for (int ri = 0; ri < c->dmg->n; ri++) {
+        const comp_rect_t clip = rect_intersect(c->dmg->rects[ri], band);
+        if (rect_empty(&clip)) continue;
+
+        if (c->redraw) {
+            fill_rect(c->out, c->stride, c->w, c->h, clip.x1, clip.y1, clip.x2 - clip.x1, clip.y2 - clip.y1, c->bg);
+
+            for (int k = 0; k < c->order_n; k++) {
+                comp_surface_t* s = &c->clients[c->order[k].ci].surfaces[c->order[k].si];
+                const uint32_t* src = 0;
+                int src_stride = 0;
+                if (s->shadow_valid && s->shadow_active >= 0 && s->shadow_active < COMP_SURFACE_SHADOW_BUFS) {
+                    src = s->shadow_pixels[s->shadow_active];
+                    src_stride = s->shadow_stride;
+                }
+                if (!src) {
+                    src = s->pixels;
+                    src_stride = s->stride;
+                }
+                if (!src || src_stride <= 0) continue;
+                blit_surface_clipped(c->out, c->stride, c->w, c->h, s->x, s->y, src, src_stride, s->w, s->h, clip);
+
+                uint32_t border_col = 0x808080u;
+                if (c->focus_client == (int)c->order[k].ci && c->focus_surface_id == s->id) {
+                    border_col = 0x007ACCu;
+                }
+                draw_frame_rect_clipped(c->out, c->stride, c->w, c->h, s->x - 1, s->y - 1, s->w + 2, s->h + 2, 1, border_col, clip);
+            }
+        }
+
+        if (c->draw_preview) {
+            const int t = 2;
+            draw_frame_rect_clipped(c->out, c->stride, c->w, c->h, c->preview_rect.x1, c->preview_rect.y1, c->preview_rect.x2 - c->preview_rect.x1, c->preview_rect.y2 - c->preview_rect.y1, t, preview_col, clip);
+        }
+    }
+}
+
 static fb_rect_t fb_rect_make(int32_t x, int32_t y, int32_t w, int32_t h) {
     fb_rect_t r;
     r.x = x;
@@ -110,6 +186,7 @@ static void comp_client_slot_reset(comp_client_t* c) {
     c->fd_c2s = -1;
     c->fd_s2c = -1;
     ipc_rx_reset(&c->rx);
+    chan_reset(&c->ch);
     c->input_ring_shm_fd = -1;
     c->input_ring_size_bytes = 0;
     c->input_ring_shm_name[0] = '\0';
@@ -412,7 +489,7 @@ int main(int argc, char** argv) {
 
     uint32_t z_counter = 1;
 
-    listen_fd = ipc_listen("flux");
+    listen_fd = ipc_listen_flags("flux", YOS_IPC_LISTEN_CHAN);
     if (listen_fd < 0) {
         dbg_write("flux: ipc_listen failed\n");
     }
@@ -452,6 +529,16 @@ int main(int argc, char** argv) {
     memset(&preview, 0, sizeof(preview));
     int preview_dirty = 0;
 
+    /* Frames start on a 16 ms timer, so the time spent composing does not stretch the period. */
+    int frame_timer_fd = timerfd_create(0u);
+    if (frame_timer_fd >= 0 && timerfd_settime(frame_timer_fd, 16u, 16u, 0u) != 0) {
+        close(frame_timer_fd);
+        frame_timer_fd = -1;
+    }
+
+    /* Composes the damage on every CPU; without one it all runs on this thread. */
+    taskpool_t* compose_pool = taskpool_create(0u, 0u);
+
     int first_frame = 1;
     int prev_virgl_active = 0;
     uint32_t shrink_tick = 0u;
@@ -468,7 +555,7 @@ int main(int argc, char** argv) {
         }
 
         if (listen_fd < 0) {
-            listen_fd = ipc_listen("flux");
+            listen_fd = ipc_listen_flags("flux", YOS_IPC_LISTEN_CHAN);
             if (listen_fd >= 0) {
                 dbg_write("flux: ipc_listen flux ok\n");
             }
@@ -530,7 +617,7 @@ int main(int argc, char** argv) {
             for (;;) {
                 int fds[2] = { -1, -1 };
                 int ar = ipc_accept(listen_fd, fds);
-                if (ar != 1) break;
+                if (ar != 1 && ar != YOS_IPC_ACCEPTED_CHAN) break;
 
                 int slot = -1;
                 for (int i = 0; i < clients_cap; i++) {
@@ -556,8 +643,16 @@ int main(int argc, char** argv) {
                 }
 
                 if (slot >= 0 && slot < clients_cap) {
-                    comp_client_init(&clients[slot], -1, fds[0], fds[1]);
-                    dbg_write("flux: accepted client\n");
+                    if (ar == YOS_IPC_ACCEPTED_CHAN) {
+                        if (comp_client_init_chan(&clients[slot], -1, fds[0]) == 0) {
+                            dbg_write("flux: accepted client (channel)\n");
+                        } else {
+                            dbg_write("flux: reject client (channel map failed)\n");
+                        }
+                    } else {
+                        comp_client_init(&clients[slot], -1, fds[0], fds[1]);
+                        dbg_write("flux: accepted client\n");
+                    }
                 } else {
                     dbg_write("flux: reject client (OOM)\n");
                     if (fds[0] >= 0) close(fds[0]);
@@ -856,42 +951,37 @@ int main(int argc, char** argv) {
 
             const uint32_t preview_col = 0x007ACC;
 
+            compose_ctx_t cctx;
+            cctx.out = out;
+            cctx.stride = stride;
+            cctx.w = w;
+            cctx.h = h;
+            cctx.bg = bg;
+            cctx.dmg = &dmg;
+            cctx.clients = clients;
+            cctx.order = order;
+            cctx.order_n = order_n;
+            cctx.redraw = !frame_pixels || first_frame || any_surface_changed || scene_dirty;
+            cctx.draw_preview = !frame_pixels && !rect_empty(&new_preview_rect);
+            cctx.preview_rect = new_preview_rect;
+            cctx.focus_client = input.focus_client;
+            cctx.focus_surface_id = input.focus_surface_id;
+
+            int band_y1 = h;
+            int band_y2 = 0;
             for (int ri = 0; ri < dmg.n; ri++) {
-                const comp_rect_t clip = dmg.rects[ri];
-                if (rect_empty(&clip)) continue;
-
-                if (!frame_pixels || first_frame || any_surface_changed || scene_dirty) {
-                    fill_rect(out, stride, w, h, clip.x1, clip.y1, clip.x2 - clip.x1, clip.y2 - clip.y1, bg);
-
-                    for (int k = 0; k < order_n; k++) {
-                        comp_surface_t* s = &clients[order[k].ci].surfaces[order[k].si];
-                        const uint32_t* src = 0;
-                        int src_stride = 0;
-                        if (s->shadow_valid && s->shadow_active >= 0 && s->shadow_active < COMP_SURFACE_SHADOW_BUFS) {
-                            src = s->shadow_pixels[s->shadow_active];
-                            src_stride = s->shadow_stride;
-                        }
-                        if (!src) {
-                            src = s->pixels;
-                            src_stride = s->stride;
-                        }
-                        if (!src || src_stride <= 0) continue;
-                        blit_surface_clipped(out, stride, w, h, s->x, s->y, src, src_stride, s->w, s->h, clip);
-
-                        uint32_t border_col = 0x808080u;
-                        if (input.focus_client == (int)order[k].ci && input.focus_surface_id == s->id) {
-                            border_col = 0x007ACCu;
-                        }
-                        draw_frame_rect_clipped(out, stride, w, h, s->x - 1, s->y - 1, s->w + 2, s->h + 2, 1, border_col, clip);
-                    }
-                }
-
-                if (!frame_pixels) {
-                    if (!rect_empty(&new_preview_rect)) {
-                        const int t = 2;
-                        draw_frame_rect_clipped(out, stride, w, h, new_preview_rect.x1, new_preview_rect.y1, new_preview_rect.x2 - new_preview_rect.x1, new_preview_rect.y2 - new_preview_rect.y1, t, preview_col, clip);
-                    }
-                }
+                if (rect_empty(&dmg.rects[ri])) continue;
+                if (dmg.rects[ri].y1 < band_y1) band_y1 = dmg.rects[ri].y1;
+                if (dmg.rects[ri].y2 > band_y2) band_y2 = dmg.rects[ri].y2;
+            }
+            if (band_y1 < 0) band_y1 = 0;
+            if (band_y2 > h) band_y2 = h;
+
+            if (band_y1 < band_y2) {
+                parallel_for(compose_pool,
+                             (uint32_t)band_y1 / COMPOSE_BAND_ROWS,
+                             ((uint32_t)band_y2 + COMPOSE_BAND_ROWS - 1u) / COMPOSE_BAND_ROWS,
+                             1u, compose_bands, &cctx);
             }
 
             if (frame_pixels) {
@@ -1146,11 +1236,26 @@ int main(int argc, char** argv) {
             }
         }
 
+        for (int ci = 0; ci < clients_cap; ci++) {
+            comp_client_send_present_acks(&clients[ci]);
+        }
+
         first_frame = 0;
 
-        usleep(16000);
+        if (frame_timer_fd >= 0) {
+            uint64_t expirations = 0u;
+            (void)eventfd_read(frame_timer_fd, &expirations);
+        } else {
+            usleep(16000);
+        }
     }
 
+    if (frame_timer_fd >= 0) {
+        close(frame_timer_fd);
+    }
+
+    taskpool_destroy(compose_pool);
+
     close(fd_mouse);
 
     if (frame_pixels && frame_size_bytes) {
@@ -15,52 +15,112 @@
 #define ANSI_SEP    "\x1b[90m"
 #define ANSI_ERR    "\x1b[91m"
 
+#define GREP_BATCH  64
+
 int opt_recursive = 0;
 int opt_show_filename = 1;
 int opt_line_number = 1;
 
-void print_match_line(const char* filename, int line_num, const char* line, const char* pattern) {
+/*
+ * Output of one file. Files searched in parallel each fill their own and
+ * are printed in the order they were found, so the result reads the same
+ * as a serial run.
+ */
+typedef struct {
+    char* data;
+    uint32_t len;
+    uint32_t cap;
+    int stream;
+} grep_out_t;
+
+typedef struct {
+    char* path;
+    grep_out_t out;
+} grep_job_t;
+
+static taskpool_t* g_pool;
+static grep_job_t g_jobs[GREP_BATCH];
+static uint32_t g_job_count;
+
+static void out_flush(grep_out_t* o) {
+    if (o->len) {
+        fwrite(o->data, 1, o->len, stdout);
+        o->len = 0;
+    }
+}
+
+static void out_write(grep_out_t* o, const char* s, uint32_t n) {
+    if (o->len + n > o->cap) {
+        uint32_t cap = o->cap ? o->cap * 2u : BUF_SIZE;
+        while (cap < o->len + n) cap *= 2u;
+
+        char* data = (char*)realloc(o->data, cap);
+        if (!data) {
+            out_flush(o);
+            fwrite(s, 1, n, stdout);
+            return;
+        }
+        o->data = data;
+        o->cap = cap;
+    }
+
+    memcpy(o->data + o->len, s, n);
+    o->len += n;
+}
+
+static void out_puts(grep_out_t* o, const char* s) {
+    out_write(o, s, (uint32_t)strlen(s));
+}
+
+static void out_free(grep_out_t* o) {
+    if (o->data) free(o->data);
+    memset(o, 0, sizeof(*o));
+}
+
+void print_match_line(grep_out_t* out, const char* filename, int line_num, const char* line, const char* pattern) {
     const char* ptr = line;
     const char* match = strstr(line, pattern);
     
     if (!match) return;
 
     if (opt_show_filename && filename) {
-        puts(ANSI_FILE);
-        puts(filename);
-        puts(ANSI_SEP);
-        puts(":");
+        out_puts(out, ANSI_FILE);
+        out_puts(out, filename);
+        out_puts(out, ANSI_SEP);
+        out_puts(out, ":");
     }
 
     if (opt_line_number) {
-        puts(ANSI_LNUM);
-        print_dec(line_num);
-        puts(ANSI_SEP);
-        puts(":");
+        char num[16];
+        snprintf(num, sizeof(num), "%d", line_num);
+        out_puts(out, ANSI_LNUM);
+        out_puts(out, num);
+        out_puts(out, ANSI_SEP);
+        out_puts(out, ":");
     }
     
-    if ((opt_show_filename && filename) || opt_line_number) puts(" ");
+    if ((opt_show_filename && filename) || opt_line_number) out_puts(out, " ");
 
     int pat_len = strlen(pattern);
     while ((match = strstr(ptr, pattern))) {
-        while (ptr < match) {
-            char tmp[2] = {*ptr++, 0};
-            puts(ANSI_TEXT);
-            puts(tmp);
+        if (ptr < match) {
+            out_puts(out, ANSI_TEXT);
+            out_write(out, ptr, (uint32_t)(match - ptr));
+            ptr = match;
         }
         
-        puts(ANSI_MATCH);
-        puts(pattern);
+        out_puts(out, ANSI_MATCH);
+        out_puts(out, pattern);
         ptr += pat_len;
     }
     
-    puts(ANSI_TEXT);
-    puts(ptr);
-    puts(ANSI_RESET);
-    puts("\n");
+    out_puts(out, ANSI_TEXT);
+    out_puts(out, ptr);
+    out_puts(out, ANSI_RESET);
+    out_puts(out, "\n");
 }
 
-void grep_from_fd(int fd, const char* filename, const char* pattern) {
+void grep_from_fd(int fd, const char* filename, const char* pattern, grep_out_t* out) {
     char chunk[BUF_SIZE];
     char line_buf[MAX_LINE];
     int line_pos = 0;
@@ -73,7 +133,7 @@ void grep_from_fd(int fd, const char* filename, const char* pattern) {
             if (c == '\n') {
                 line_buf[line_pos] = 0;
                 if (strstr(line_buf, pattern)) {
-                    print_match_line(filename, line_num, line_buf, pattern);
+                    print_match_line(out, filename, line_num, line_buf, pattern);
                 }
                 line_pos = 0;
                 line_num++;
@@ -83,25 +143,73 @@ void grep_from_fd(int fd, const char* filename, const char* pattern) {
                 }
             }
         }
+        if (out->stream) out_flush(out);
     }
     if (line_pos > 0) {
         line_buf[line_pos] = 0;
-        if (strstr(line_buf, pattern)) print_match_line(filename, line_num, line_buf, pattern);
+        if (strstr(line_buf, pattern)) print_match_line(out, filename, line_num, line_buf, pattern);
     }
+    if (out->stream) out_flush(out);
 }
 
-void grep_file(const char* path, const char* pattern) {
+void grep_file(const char* path, const char* pattern, grep_out_t* out) {
     int fd = open(path, 0);
     if (fd < 0) {
-        puts(ANSI_ERR);
-        printf("grep: %s: No such file or directory\n", path);
-        puts(ANSI_RESET);
+        char msg[PATH_MAX + 64];
+        snprintf(msg, sizeof(msg), "grep: %s: No such file or directory\n", path);
+        out_puts(out, ANSI_ERR);
+        out_puts(out, msg);
+        out_puts(out, ANSI_RESET);
         return;
     }
-    grep_from_fd(fd, path, pattern);
+    grep_from_fd(fd, path, pattern, out);
     close(fd);
 }
 
+static const char* g_pattern;
+
+static void grep_jobs_range(void* ctx, uint32_t begin, uint32_t end) {
+    (void)ctx;
+
+    for (uint32_t i = begin; i < end; i++) {
+        grep_file(g_jobs[i].path, g_pattern, &g_jobs[i].out);
+    }
+}
+
+/* Search the queued files, one task each, then print what they found in order. */
+static void run_jobs(void) {
+    if (g_job_count == 0) return;
+
+    parallel_for(g_pool, 0, g_job_count, 1, grep_jobs_range, 0);
+
+    for (uint32_t i = 0; i < g_job_count; i++) {
+        out_flush(&g_jobs[i].out);
+        out_free(&g_jobs[i].out);
+        free(g_jobs[i].path);
+    }
+    g_job_count = 0;
+}
+
+static void queue_file(const char* path) {
+    if (g_job_count == GREP_BATCH) run_jobs();
+
+    grep_job_t* job = &g_jobs[g_job_count];
+    memset(job, 0, sizeof(*job));
+
+    job->path = strdup(path);
+    if (!job->path) {
+        run_jobs();
+
+        grep_out_t out;
+        memset(&out, 0, sizeof(out));
+        out.stream = 1;
+        grep_file(path, g_pattern, &out);
+        out_free(&out);
+        return;
+    }
+    g_job_count++;
+}
+
 typedef struct {
     uint32_t inode;
     char name[60];
@@ -110,6 +218,7 @@ typedef struct {
 void process_path(const char* path, const char* pattern) {
     stat_t st;
     if (stat(path, &st) != 0) {
+        run_jobs();
         puts(ANSI_ERR);
         printf("grep: %s: Cannot stat\n", path);
         puts(ANSI_RESET);
@@ -117,9 +226,10 @@ void process_path(const char* path, const char* pattern) {
     }
 
     if (st.type == 1) {
-        grep_file(path, pattern);
+        queue_file(path);
     } else if (st.type == 2) {
         if (!opt_recursive) {
+            run_jobs();
             puts(ANSI_SEP);
             printf("grep: %s: Is a directory\n", path);
             puts(ANSI_RESET);
@@ -164,18 +274,31 @@ int main(int argc, char** argv) {
     }
 
     const char* pattern = argv[arg_idx++];
+    g_pattern = pattern;
+
+    /* Several files are searched in parallel; reading stdin stays on this thread. */
+    if (opt_recursive || argc - arg_idx > 1) {
+        g_pool = taskpool_create(0, 0);
+    }
 
     if (arg_idx >= argc) {
         if (opt_recursive) {
             process_path(".", pattern);
         } else {
-            grep_from_fd(0, 0, pattern);
+            grep_out_t out;
+            memset(&out, 0, sizeof(out));
+            out.stream = 1;
+            grep_from_fd(0, 0, pattern, &out);
+            out_free(&out);
         }
     } else {
         for (; arg_idx < argc; arg_idx++) {
             process_path(argv[arg_idx], pattern);
         }
     }
+    run_jobs();
+
+    taskpool_destroy(g_pool);
 
     puts(ANSI_RESET);
     return 0;
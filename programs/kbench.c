@@ -0,0 +1,448 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+#include <yos/kbench.h>
+
+/*
+ * Microbenchmark driver.
+ *
+ * Runs the paths that start in user mode here: syscall round trip through
+ * sysenter and int 0x80, futex wake-to-run latency, pipe latency and
+ * throughput, and the 4 KiB and 4 MiB page fault paths. Then asks the
+ * kernel to run its own suite (context switch, kmalloc, PMM, bcache), which
+ * logs through dmesg and the serial console.
+ *
+ * Every result is one "kbench: name=... samples=... median_ns=... p99_ns=..."
+ * line, printed and copied to /dev/ttyS0 so QEMU serial logs of two runs
+ * can be diffed.
+ *
+ * Usage: kbench [-u | -k]
+ *   -u  user-side benchmarks only
+ *   -k  kernel suite only
+ */
+
+#define MAX_SAMPLES 1024u
+
+#define SYSCALL_ITERS   1024u
+#define FUTEX_ITERS     128u
+#define PIPE_ITERS      512u
+#define PIPE_BYTES      (4u * 1024u * 1024u)
+#define PIPE_CHUNK      4096u
+#define FAULT_4K_PAGES  256u
+#define FAULT_4K_ROUNDS 4u
+#define FAULT_4M_ROUNDS 16u
+
+#define PAGE_SIZE_BYTES 4096u
+#define HUGE_SIZE_BYTES (4u * 1024u * 1024u)
+
+static uint32_t g_samples[MAX_SAMPLES];
+static uint32_t g_count;
+
+static uint32_t g_tsc_khz;
+static int g_serial_fd = -1;
+
+static inline uint64_t rdtsc(void) {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | (uint64_t)lo;
+}
+
+static void sample(uint64_t cycles) {
+    if (g_count < MAX_SAMPLES) {
+        g_samples[g_count++] = cycles > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)cycles;
+    }
+}
+
+static uint32_t cycles_to_ns(uint64_t cycles) {
+    if (g_tsc_khz == 0u) {
+        return 0;
+    }
+
+    const uint64_t ns = (cycles * 1000000ull) / g_tsc_khz;
+
+    return ns > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)ns;
+}
+
+static void emit(const char* line) {
+    printf("%s", line);
+
+    if (g_serial_fd >= 0) {
+        (void)write(g_serial_fd, line, (uint32_t)strlen(line));
+    }
+}
+
+static int u32_cmp(const void* a, const void* b) {
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    if (x != y) return x < y ? -1 : 1;
+    return 0;
+}
+
+/* Print the samples gathered since the last report and start over. */
+static void report(const char* name) {
+    char line[160];
+
+    const uint32_t n = g_count;
+    g_count = 0;
+
+    if (n == 0u) {
+        snprintf(line, sizeof(line), "kbench: name=%s skipped=nosamples\n", name);
+        emit(line);
+        return;
+    }
+
+    qsort(g_samples, n, sizeof(uint32_t), u32_cmp);
+
+    uint32_t p99 = (n * 99u) / 100u;
+    if (p99 >= n) {
+        p99 = n - 1u;
+    }
+
+    snprintf(
+        line, sizeof(line),
+        "kbench: name=%s samples=%u min_ns=%u median_ns=%u p99_ns=%u\n",
+        name, n, cycles_to_ns(g_samples[0]), cycles_to_ns(g_samples[n / 2u]), cycles_to_ns(g_samples[p99])
+    );
+    emit(line);
+}
+
+static inline int getpid_int80(void) {
+    int ret;
+
+    __asm__ volatile("int $0x80" : "=a"(ret) : "a"(1), "b"(0), "D"(0), "S"(0) : "memory");
+
+    return ret;
+}
+
+static void bench_syscall(void) {
+    for (uint32_t i = 0; i < SYSCALL_ITERS; i++) {
+        const uint64_t t0 = rdtsc();
+        (void)getpid();
+        const uint64_t t1 = rdtsc();
+
+        sample(t1 - t0);
+    }
+
+    report("syscall_getpid/sysenter");
+
+    for (uint32_t i = 0; i < SYSCALL_ITERS; i++) {
+        const uint64_t t0 = rdtsc();
+        (void)getpid_int80();
+        const uint64_t t1 = rdtsc();
+
+        sample(t1 - t0);
+    }
+
+    report("syscall_getpid/int80");
+}
+
+static volatile uint32_t g_futex_word;
+static volatile uint32_t g_futex_sleeping;
+static volatile uint32_t g_futex_stop;
+static volatile uint64_t g_futex_wake_tsc;
+
+static void* futex_waiter(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        __atomic_store_n(&g_futex_sleeping, 1u, __ATOMIC_RELEASE);
+
+        while (__atomic_load_n(&g_futex_word, __ATOMIC_ACQUIRE) == 0u) {
+            (void)futex_wait(&g_futex_word, 0u);
+        }
+
+        const uint64_t now = rdtsc();
+
+        if (__atomic_load_n(&g_futex_stop, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+
+        sample(now - g_futex_wake_tsc);
+
+        __atomic_store_n(&g_futex_word, 0u, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Time from futex_wake() to the woken thread running. The waker sleeps
+ * first so the waiter is really blocked, not still on its way in.
+ */
+static void bench_futex(void) {
+    pthread_t tid;
+
+    g_futex_word = 0u;
+    g_futex_sleeping = 0u;
+    g_futex_stop = 0u;
+
+    if (pthread_create(&tid, 0, futex_waiter, 0) != 0) {
+        emit("kbench: name=futex_wake skipped=nothread\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < FUTEX_ITERS; i++) {
+        while (!__atomic_load_n(&g_futex_sleeping, __ATOMIC_ACQUIRE)) {
+            __asm__ volatile("pause");
+        }
+
+        usleep(500u);
+
+        __atomic_store_n(&g_futex_sleeping, 0u, __ATOMIC_RELAXED);
+
+        g_futex_wake_tsc = rdtsc();
+        __atomic_store_n(&g_futex_word, 1u, __ATOMIC_RELEASE);
+        (void)futex_wake(&g_futex_word, 1u);
+
+        while (__atomic_load_n(&g_futex_word, __ATOMIC_ACQUIRE) != 0u) {
+            __asm__ volatile("pause");
+        }
+    }
+
+    while (!__atomic_load_n(&g_futex_sleeping, __ATOMIC_ACQUIRE)) {
+        __asm__ volatile("pause");
+    }
+
+    __atomic_store_n(&g_futex_stop, 1u, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_futex_word, 1u, __ATOMIC_RELEASE);
+    (void)futex_wake(&g_futex_word, 1u);
+
+    (void)pthread_join(tid, 0);
+
+    report("futex_wake");
+}
+
+static int g_ping[2];
+static int g_pong[2];
+
+static void* pipe_echo(void* arg) {
+    (void)arg;
+
+    char c;
+
+    while (read(g_ping[0], &c, 1u) == 1) {
+        if (c == 0) {
+            break;
+        }
+
+        (void)write(g_pong[1], &c, 1u);
+    }
+
+    return 0;
+}
+
+static void* pipe_sink(void* arg) {
+    static uint8_t buf[PIPE_CHUNK];
+
+    uint32_t left = *(const uint32_t*)arg;
+
+    while (left > 0u) {
+        const int r = read(g_ping[0], buf, left < PIPE_CHUNK ? left : PIPE_CHUNK);
+        if (r <= 0) {
+            break;
+        }
+
+        left -= (uint32_t)r;
+    }
+
+    return 0;
+}
+
+static void bench_pipe(void) {
+    if (pipe(g_ping) != 0 || pipe(g_pong) != 0) {
+        emit("kbench: name=pipe skipped=nopipe\n");
+        return;
+    }
+
+    pthread_t tid;
+
+    /* Latency: one byte there and back; half the round trip is one hop. */
+    if (pthread_create(&tid, 0, pipe_echo, 0) == 0) {
+        for (uint32_t i = 0; i < PIPE_ITERS; i++) {
+            char c = 1;
+
+            const uint64_t t0 = rdtsc();
+            (void)write(g_ping[1], &c, 1u);
+            (void)read(g_pong[0], &c, 1u);
+            const uint64_t t1 = rdtsc();
+
+            sample((t1 - t0) / 2u);
+        }
+
+        char stop = 0;
+        (void)write(g_ping[1], &stop, 1u);
+
+        (void)pthread_join(tid, 0);
+
+        report("pipe_latency/1");
+    }
+
+    /* Throughput: one writer, one reader, PIPE_CHUNK at a time. */
+    static uint8_t chunk[PIPE_CHUNK];
+    uint32_t total = PIPE_BYTES;
+
+    if (pthread_create(&tid, 0, pipe_sink, &total) == 0) {
+        uint32_t left = PIPE_BYTES;
+
+        const uint64_t t0 = rdtsc();
+
+        while (left > 0u) {
+            const int w = write(g_ping[1], chunk, left < PIPE_CHUNK ? left : PIPE_CHUNK);
+            if (w <= 0) {
+                break;
+            }
+
+            left -= (uint32_t)w;
+        }
+
+        (void)pthread_join(tid, 0);
+
+        const uint64_t t1 = rdtsc();
+        const uint32_t ns = cycles_to_ns(t1 - t0);
+        const uint32_t sent = PIPE_BYTES - left;
+
+        char line[160];
+        snprintf(
+            line, sizeof(line),
+            "kbench: name=pipe_throughput/%u bytes=%u total_ns=%u kib_per_s=%u\n",
+            PIPE_CHUNK, sent, ns,
+            ns ? (uint32_t)(((uint64_t)sent * 1000000000ull / 1024u) / ns) : 0u
+        );
+        emit(line);
+    }
+
+    close(g_ping[0]);
+    close(g_ping[1]);
+    close(g_pong[0]);
+    close(g_pong[1]);
+}
+
+/*
+ * Small mappings never get a large page, and MADV_RANDOM turns fault-around
+ * off, so every 4 KiB touch is one fault. Large ones are MADV_HUGEPAGE and
+ * the first touch of an aligned 4 MiB window maps a whole large page.
+ */
+static void bench_pagefault(void) {
+    int zero_fd = open("/dev/zero", 0);
+    if (zero_fd < 0) {
+        emit("kbench: name=pagefault skipped=nozero\n");
+        return;
+    }
+
+    const uint32_t small_bytes = FAULT_4K_PAGES * PAGE_SIZE_BYTES;
+
+    for (uint32_t r = 0; r < FAULT_4K_ROUNDS; r++) {
+        volatile uint8_t* p = (volatile uint8_t*)mmap(zero_fd, small_bytes, MAP_PRIVATE);
+        if (!p || p == (volatile uint8_t*)-1) {
+            break;
+        }
+
+        (void)madvise((void*)p, small_bytes, MADV_RANDOM);
+
+        for (uint32_t i = 0; i < FAULT_4K_PAGES; i++) {
+            const uint64_t t0 = rdtsc();
+            p[i * PAGE_SIZE_BYTES] = 1u;
+            const uint64_t t1 = rdtsc();
+
+            sample(t1 - t0);
+        }
+
+        (void)munmap((void*)p, small_bytes);
+    }
+
+    report("pagefault/4k");
+
+    const uint32_t big_bytes = 2u * HUGE_SIZE_BYTES;
+
+    for (uint32_t r = 0; r < FAULT_4M_ROUNDS; r++) {
+        uint8_t* p = (uint8_t*)mmap(zero_fd, big_bytes, MAP_PRIVATE);
+        if (!p || p == (uint8_t*)-1) {
+            break;
+        }
+
+        (void)madvise(p, big_bytes, MADV_HUGEPAGE);
+
+        const uint32_t huge = ((uint32_t)p + HUGE_SIZE_BYTES - 1u) & ~(HUGE_SIZE_BYTES - 1u);
+        volatile uint8_t* q = (volatile uint8_t*)huge;
+
+        const uint64_t t0 = rdtsc();
+        q[0] = 1u;
+        const uint64_t t1 = rdtsc();
+
+        sample(t1 - t0);
+
+        (void)munmap(p, big_bytes);
+    }
+
+    report("pagefault/4m");
+
+    close(zero_fd);
+}
+
+static void usage(void) {
+    printf("Usage: kbench [-u | -k]\n");
+}
+
+int main(int argc, char** argv) {
+    int run_user = 1;
+    int run_kernel = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-u") == 0) {
+            run_kernel = 0;
+        } else if (strcmp(argv[i], "-k") == 0) {
+            run_user = 0;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    int fd = open("/dev/kbench", 0);
+    if (fd < 0) {
+        printf("kbench: cannot open /dev/kbench\n");
+        return 1;
+    }
+
+    yos_kbench_info_t info;
+    memset(&info, 0, sizeof(info));
+
+    (void)ioctl(fd, YOS_KBENCH_INFO, &info);
+    g_tsc_khz = info.tsc_khz;
+
+    g_serial_fd = open("/dev/ttyS0", VFS_OPEN_WRITE);
+
+    if (run_user) {
+        char line[96];
+        snprintf(line, sizeof(line), "kbench: begin side=user tsc_khz=%u\n", g_tsc_khz);
+        emit(line);
+
+        bench_syscall();
+        bench_futex();
+        bench_pipe();
+        bench_pagefault();
+
+        emit("kbench: end side=user\n");
+    }
+
+    int rc = 0;
+
+    if (run_kernel) {
+        if (ioctl(fd, YOS_KBENCH_RUN, 0) != 0) {
+            printf("kbench: kernel suite already running\n");
+            rc = 1;
+        } else {
+            printf("kbench: kernel results are in dmesg\n");
+        }
+    }
+
+    if (g_serial_fd >= 0) {
+        close(g_serial_fd);
+    }
+
+    close(fd);
+    return rc;
+}
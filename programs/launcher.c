@@ -386,6 +386,22 @@ static int ensure_surface(uint32_t need_w, uint32_t need_h) {
     if (cap64 > 0xFFFFFFFFu) cap64 = (uint64_t)need_bytes;
     const uint32_t cap_bytes = (uint32_t)cap64;
 
+    /* Grow the object flux already has open; it only needs to extend its mapping. */
+    if (canvas && shm_fd >= 0 && shm_name[0] != '\0' && shm_resize(shm_fd, cap_bytes) == 0) {
+        uint32_t* grown = (uint32_t*)mmap(shm_fd, cap_bytes, MAP_SHARED);
+        if (!ptr_is_invalid(grown)) {
+            munmap((void*)canvas, size_bytes);
+            canvas = grown;
+            size_bytes = cap_bytes;
+
+            uint16_t err = 0;
+            if (comp_send_attach_shm_name_sync(&conn, surface_id, shm_name, size_bytes, need_w, need_h, need_w, 0u, 2000u, &err) != 0) {
+                return -1;
+            }
+            return 0;
+        }
+    }
+
     char new_name[32];
     new_name[0] = '\0';
     int new_fd = -1;
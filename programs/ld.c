@@ -8,7 +8,7 @@ int main(int argc, char** argv) {
     const char* external_libs[] = {
         "/bin/start.o", "/bin/malloc.o",
         "/bin/string.o", "/bin/stdlib.o",
-        "/bin/stdio.o"
+        "/bin/stdio.o", "/bin/udivdi3.o"
     };
 
     int libs_count = sizeof(external_libs) / sizeof(external_libs[0]);
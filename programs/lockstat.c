@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+#include <yos/lockstat.h>
+#include <yos/prof.h>
+
+/*
+ * Lock contention viewer for /dev/lockstat.
+ *
+ * Prints the acquisition sites that waited the longest, with their
+ * contention count, average and total wait, and average hold time. Sites
+ * are resolved to kernel functions through /dev/prof when it is available.
+ * Needs a kernel built with KERNEL_LOCKSTAT=1.
+ *
+ * Usage: lockstat [-r] [-d ms] [-n top] [-s wait|count|hold] [-H]
+ *   -r  reset the counters and exit
+ *   -d  reset, wait `ms`, then report only what happened meanwhile
+ *   -n  number of sites to print (default 20)
+ *   -s  sort by total wait (default), contention count or total hold
+ *   -H  also print wait/hold histograms for the listed sites
+ */
+
+#define LOCKSTAT_MAX_CLASSES 512u
+
+enum {
+    SORT_WAIT = 0,
+    SORT_COUNT,
+    SORT_HOLD,
+};
+
+static const char* const g_type_names[YOS_LOCKSTAT_TYPE_COUNT] = {
+    [YOS_LOCKSTAT_SPIN]         = "spin",
+    [YOS_LOCKSTAT_MUTEX]        = "mutex",
+    [YOS_LOCKSTAT_RWLOCK_READ]  = "rw-read",
+    [YOS_LOCKSTAT_RWLOCK_WRITE] = "rw-write",
+    [YOS_LOCKSTAT_RWSPIN_READ]  = "rwspin-read",
+    [YOS_LOCKSTAT_RWSPIN_WRITE] = "rwspin-write",
+    [YOS_LOCKSTAT_SEM]          = "sem",
+};
+
+static yos_lockstat_class_t g_classes[LOCKSTAT_MAX_CLASSES];
+static uint32_t g_count;
+
+static uint32_t g_tsc_khz;
+static int g_sort = SORT_WAIT;
+
+static int g_prof_fd = -1;
+
+static uint32_t load_classes(void) {
+    int fd = open("/dev/lockstat", 0);
+    if (fd < 0) {
+        return 0;
+    }
+
+    uint32_t n = 0;
+
+    while (n < LOCKSTAT_MAX_CLASSES) {
+        int r = read(fd, &g_classes[n], (LOCKSTAT_MAX_CLASSES - n) * (uint32_t)sizeof(yos_lockstat_class_t));
+        if (r <= 0) {
+            break;
+        }
+
+        n += (uint32_t)r / (uint32_t)sizeof(yos_lockstat_class_t);
+    }
+
+    close(fd);
+
+    /* Drop sites that never waited since the last reset. */
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (g_classes[i].site != 0u && g_classes[i].contended != 0u) {
+            g_classes[kept++] = g_classes[i];
+        }
+    }
+
+    return kept;
+}
+
+static uint64_t sort_key(const yos_lockstat_class_t* c) {
+    switch (g_sort) {
+        case SORT_COUNT:
+            return c->contended;
+        case SORT_HOLD:
+            return c->hold_cycles;
+        default:
+            return c->wait_cycles;
+    }
+}
+
+static int class_cmp(const void* a, const void* b) {
+    const uint64_t ka = sort_key((const yos_lockstat_class_t*)a);
+    const uint64_t kb = sort_key((const yos_lockstat_class_t*)b);
+
+    if (ka != kb) return ka < kb ? 1 : -1;
+    return 0;
+}
+
+static uint32_t cycles_to_us(uint64_t cycles) {
+    if (g_tsc_khz == 0u) {
+        return 0;
+    }
+
+    const uint64_t us = (cycles * 1000ull) / g_tsc_khz;
+
+    return us > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)us;
+}
+
+static void format_site(uint32_t site, char* out, uint32_t cap) {
+    if (g_prof_fd >= 0) {
+        yos_prof_sym_t q;
+        memset(&q, 0, sizeof(q));
+        q.addr = site;
+
+        if (ioctl(g_prof_fd, YOS_PROF_RESOLVE, &q) == 0 && q.name[0]) {
+            q.name[sizeof(q.name) - 1u] = '\0';
+            snprintf(out, cap, "%s+0x%x", q.name, site - q.sym_addr);
+            return;
+        }
+    }
+
+    snprintf(out, cap, "0x%08x", site);
+}
+
+static void print_hist(const char* label, const uint32_t* hist) {
+    uint32_t last = 0;
+    int any = 0;
+
+    for (uint32_t b = 0; b < YOS_LOCKSTAT_BUCKETS; b++) {
+        if (hist[b] != 0u) {
+            last = b;
+            any = 1;
+        }
+    }
+
+    if (!any) {
+        return;
+    }
+
+    printf("      %s cycles:", label);
+
+    for (uint32_t b = 0; b <= last; b++) {
+        if (hist[b] != 0u) {
+            printf(" 2^%u:%u", b, hist[b]);
+        }
+    }
+
+    printf("\n");
+}
+
+static void report(uint32_t top, int hist) {
+    g_count = load_classes();
+
+    qsort(g_classes, g_count, sizeof(yos_lockstat_class_t), class_cmp);
+
+    if (top > g_count) {
+        top = g_count;
+    }
+
+    printf("%-12s %9s %10s %12s %10s  %s\n", "type", "contended", "avg-wait", "total-wait", "avg-hold", "site");
+    printf("%-12s %9s %10s %12s %10s\n", "", "", "(us)", "(us)", "(us)");
+
+    for (uint32_t i = 0; i < top; i++) {
+        const yos_lockstat_class_t* c = &g_classes[i];
+
+        char site[96];
+        format_site(c->site, site, sizeof(site));
+
+        const char* type = c->type < YOS_LOCKSTAT_TYPE_COUNT ? g_type_names[c->type] : "?";
+
+        const uint32_t avg_wait = cycles_to_us(c->wait_cycles / c->contended);
+        const uint32_t total_wait = cycles_to_us(c->wait_cycles);
+
+        printf("%-12s %9u %10u %12u ", type, c->contended, avg_wait, total_wait);
+
+        if (c->held != 0u) {
+            printf("%10u", cycles_to_us(c->hold_cycles / c->held));
+        } else {
+            printf("%10s", "-");
+        }
+
+        printf("  %s (lock 0x%08x)\n", site, c->lock);
+
+        if (hist) {
+            uint32_t h[YOS_LOCKSTAT_BUCKETS];
+
+            memcpy(h, (const void*)c->wait_hist, sizeof(h));
+            print_hist("wait", h);
+
+            memcpy(h, (const void*)c->hold_hist, sizeof(h));
+            print_hist("hold", h);
+        }
+    }
+
+    if (g_count == 0u) {
+        printf("(no contention recorded)\n");
+    }
+}
+
+static void usage(void) {
+    printf("Usage: lockstat [-r] [-d ms] [-n top] [-s wait|count|hold] [-H]\n");
+}
+
+int main(int argc, char** argv) {
+    int reset_only = 0;
+    int hist = 0;
+    int duration_ms = -1;
+    uint32_t top = 20u;
+
+    for (int i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+
+        if (strcmp(opt, "-r") == 0) {
+            reset_only = 1;
+        } else if (strcmp(opt, "-H") == 0) {
+            hist = 1;
+        } else if (i + 1 < argc && strcmp(opt, "-d") == 0) {
+            duration_ms = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(opt, "-n") == 0) {
+            top = (uint32_t)atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(opt, "-s") == 0) {
+            const char* key = argv[++i];
+
+            if (strcmp(key, "wait") == 0) {
+                g_sort = SORT_WAIT;
+            } else if (strcmp(key, "count") == 0) {
+                g_sort = SORT_COUNT;
+            } else if (strcmp(key, "hold") == 0) {
+                g_sort = SORT_HOLD;
+            } else {
+                usage();
+                return 1;
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    int fd = open("/dev/lockstat", 0);
+    if (fd < 0) {
+        printf("lockstat: cannot open /dev/lockstat\n");
+        return 1;
+    }
+
+    yos_lockstat_info_t info;
+    memset(&info, 0, sizeof(info));
+
+    if (ioctl(fd, YOS_LOCKSTAT_INFO, &info) != 0 || !info.enabled) {
+        printf("lockstat: kernel built without KERNEL_LOCKSTAT=1\n");
+        close(fd);
+        return 1;
+    }
+
+    g_tsc_khz = info.tsc_khz;
+
+    if (reset_only || duration_ms >= 0) {
+        (void)ioctl(fd, YOS_LOCKSTAT_RESET, 0);
+    }
+
+    if (reset_only) {
+        close(fd);
+        return 0;
+    }
+
+    if (duration_ms > 0) {
+        sleep(duration_ms);
+    }
+
+    g_prof_fd = open("/dev/prof", 0);
+
+    report(top, hist);
+
+    (void)ioctl(fd, YOS_LOCKSTAT_INFO, &info);
+
+    printf("lockstat: %u sites registered", info.classes);
+    if (info.overflow != 0u) {
+        printf(", %u contentions lost to a full table", info.overflow);
+    }
+    printf("\n");
+
+    if (g_prof_fd >= 0) {
+        close(g_prof_fd);
+    }
+
+    close(fd);
+    return 0;
+}
@@ -264,12 +264,12 @@ bool IpcServer::listen() {
     return m_listen_fd >= 0;
 }
 
-int IpcServer::wait(const PipePair& notify, int timeout_ms) {
+int IpcServer::wait(const EventFd& notify, int timeout_ms) {
     if (m_listen_fd < 0) {
         return -1;
     }
 
-    const int notify_fd = notify.read_fd();
+    const int notify_fd = notify.fd();
 
     const uint32_t need = m_clients.size() + 2u;
 
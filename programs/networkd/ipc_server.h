@@ -25,7 +25,7 @@ public:
     bool listen();
     void step(uint32_t now_ms);
 
-    int wait(const PipePair& notify, int timeout_ms);
+    int wait(const EventFd& notify, int timeout_ms);
 
     int listen_fd() const { return m_listen_fd; }
 
@@ -9,7 +9,7 @@ namespace netd {
 template <typename T, uint32_t CapPow2>
 class SpscChannel {
 public:
-    SpscChannel(SpscQueue<T, CapPow2>& q, PipePair& notify) : m_q(q), m_notify(notify) {
+    SpscChannel(SpscQueue<T, CapPow2>& q, EventFd& notify) : m_q(q), m_notify(notify) {
     }
 
     SpscChannel(const SpscChannel&) = delete;
@@ -33,7 +33,7 @@ public:
     }
 
     int notify_fd() const {
-        return m_notify.read_fd();
+        return m_notify.fd();
     }
 
     void drain_notify() const {
@@ -42,7 +42,7 @@ public:
 
 private:
     SpscQueue<T, CapPow2>& m_q;
-    PipePair& m_notify;
+    EventFd& m_notify;
 };
 
 }
@@ -12,41 +12,34 @@ void UniqueFd::reset(int v) {
     fd = v;
 }
 
-PipePair::PipePair() : m_r(), m_w() {
+EventFd::EventFd() : m_fd() {
 }
 
-bool PipePair::create() {
-    int fds[2] = { -1, -1 };
-    if (pipe(fds) != 0) {
+bool EventFd::create() {
+    const int fd = eventfd(0u, YOS_EFD_NONBLOCK);
+    if (fd < 0) {
         return false;
     }
 
-    m_r.reset(fds[0]);
-    m_w.reset(fds[1]);
+    m_fd.reset(fd);
     return true;
 }
 
-void PipePair::signal() const {
-    if (m_w.get() < 0) {
+void EventFd::signal() const {
+    if (m_fd.get() < 0) {
         return;
     }
 
-    const uint8_t b = 1u;
-    (void)pipe_try_write(m_w.get(), &b, 1u);
+    (void)eventfd_write(m_fd.get(), 1u);
 }
 
-void PipePair::drain() const {
-    if (m_r.get() < 0) {
+void EventFd::drain() const {
+    if (m_fd.get() < 0) {
         return;
     }
 
-    uint8_t buf[64];
-    for (;;) {
-        const int got = pipe_try_read(m_r.get(), buf, (uint32_t)sizeof(buf));
-        if (got <= 0) {
-            break;
-        }
-    }
+    uint64_t v = 0u;
+    (void)eventfd_read(m_fd.get(), &v);
 }
 
 }
@@ -213,32 +213,28 @@ struct UniqueFd {
     void reset(int v = -1);
 };
 
-class PipePair {
+/* A non-blocking eventfd used as a wakeup: signal() adds to it, drain() empties it. */
+class EventFd {
 public:
-    PipePair();
+    EventFd();
 
-    PipePair(const PipePair&) = delete;
-    PipePair& operator=(const PipePair&) = delete;
+    EventFd(const EventFd&) = delete;
+    EventFd& operator=(const EventFd&) = delete;
 
-    PipePair(PipePair&&) = default;
-    PipePair& operator=(PipePair&&) = default;
+    EventFd(EventFd&&) = default;
+    EventFd& operator=(EventFd&&) = default;
 
     bool create();
 
-    int read_fd() const {
-        return m_r.get();
-    }
-
-    int write_fd() const {
-        return m_w.get();
+    int fd() const {
+        return m_fd.get();
     }
 
     void signal() const;
     void drain() const;
 
 private:
-    UniqueFd m_r;
-    UniqueFd m_w;
+    UniqueFd m_fd;
 };
 
 }
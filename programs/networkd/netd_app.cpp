@@ -152,7 +152,8 @@ void NetdApp::poll_once(uint32_t now_ms) {
 
     const int timeout_ms = m_sched.compute_poll_timeout_ms(now_ms, next_wakeup_ms);
 
-    pollfd_t fds[2];
+    pollfd_t fds[3];
+    uint32_t nfds = 2u;
 
     fds[0].fd = m_dev.fd();
     fds[0].events = POLLIN;
@@ -162,11 +163,22 @@ void NetdApp::poll_once(uint32_t now_ms) {
     fds[1].events = POLLIN;
     fds[1].revents = 0;
 
-    (void)poll(fds, 2, timeout_ms);
+    if (m_sched.timer_fd() >= 0) {
+        fds[2].fd = m_sched.timer_fd();
+        fds[2].events = POLLIN;
+        fds[2].revents = 0;
+        nfds = 3u;
+    }
+
+    (void)poll(fds, nfds, timeout_ms);
 
     if ((fds[1].revents & POLLIN) != 0) {
         m_bridge->drain_req_notify();
     }
+
+    if (nfds == 3u && (fds[2].revents & POLLIN) != 0) {
+        m_sched.drain_timer();
+    }
 }
 
 void NetdApp::drain_core_requests(uint32_t now_ms) {
@@ -294,12 +306,12 @@ bool NetdApp::init_bridge() {
 
 bool NetdApp::init_ipc() {
     if (!m_core_to_ipc_notify.create()) {
-        printf("networkd: pipe failed\n");
+        printf("networkd: eventfd failed\n");
         return false;
     }
 
     if (!m_ipc_to_core_notify.create()) {
-        printf("networkd: pipe failed\n");
+        printf("networkd: eventfd failed\n");
         return false;
     }
 
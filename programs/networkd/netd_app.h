@@ -85,8 +85,8 @@ private:
     SpscQueue<CoreReqMsg, 256> m_ipc_to_core_q;
     SpscQueue<CoreEvtMsg, 256> m_core_to_ipc_q;
 
-    PipePair m_core_to_ipc_notify;
-    PipePair m_ipc_to_core_notify;
+    EventFd m_core_to_ipc_notify;
+    EventFd m_ipc_to_core_notify;
 
     SpscChannel<CoreReqMsg, 256> m_ipc_to_core_chan;
     SpscChannel<CoreEvtMsg, 256> m_core_to_ipc_chan;
@@ -21,7 +21,7 @@ void* NetdIpcRuntime::thread_main(void* arg) {
     }
 }
 
-bool NetdIpcRuntime::start(IpcServer& ipc, const PipePair& notify) {
+bool NetdIpcRuntime::start(IpcServer& ipc, const EventFd& notify) {
     m_ctx.ipc = &ipc;
     m_ctx.notify = &notify;
 
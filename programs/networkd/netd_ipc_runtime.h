@@ -14,12 +14,12 @@ public:
     NetdIpcRuntime(const NetdIpcRuntime&) = delete;
     NetdIpcRuntime& operator=(const NetdIpcRuntime&) = delete;
 
-    bool start(IpcServer& ipc, const PipePair& notify);
+    bool start(IpcServer& ipc, const EventFd& notify);
 
 private:
     struct ThreadCtx {
         IpcServer* ipc;
-        const PipePair* notify;
+        const EventFd* notify;
     };
 
     static void* thread_main(void* arg);
@@ -1,14 +1,25 @@
 #include "netd_tick_scheduler.h"
 
+#include <yula.h>
+
 namespace netd {
 
 NetdTickScheduler::NetdTickScheduler(Arena& arena, uint32_t poll_cap_ms)
     : m_wheel(arena),
-      m_poll_cap_ms(poll_cap_ms) {
+      m_poll_cap_ms(poll_cap_ms),
+      m_timer_fd(),
+      m_armed_ms(0u) {
 }
 
 bool NetdTickScheduler::init(uint32_t now_ms) {
-    return m_wheel.init(now_ms);
+    if (!m_wheel.init(now_ms)) {
+        return false;
+    }
+
+    /* Optional: without it compute_poll_timeout_ms() falls back to poll() timeouts. */
+    m_timer_fd.reset(timerfd_create(YOS_TFD_NONBLOCK));
+
+    return true;
 }
 
 TimerId NetdTickScheduler::schedule(
@@ -45,27 +56,53 @@ uint32_t NetdTickScheduler::capacity() const {
     return m_wheel.capacity();
 }
 
-int NetdTickScheduler::compute_poll_timeout_ms(uint32_t now_ms, uint32_t next_wakeup_ms) const {
-    int timeout_ms = (int)m_poll_cap_ms;
+void NetdTickScheduler::arm_timer(uint32_t deadline_ms) {
+    if (m_timer_fd.get() < 0 || deadline_ms == m_armed_ms) {
+        return;
+    }
 
-    if (m_wheel.has_pending_timers()) {
-        timeout_ms = 1;
+    /* An ABSTIME value of 0 disarms, which is what deadline_ms == 0 asks for. */
+    if (timerfd_settime(m_timer_fd.get(), deadline_ms, 0u, YOS_TFD_TIMER_ABSTIME) == 0) {
+        m_armed_ms = deadline_ms;
     }
+}
 
-    if (next_wakeup_ms == 0u) {
-        return timeout_ms;
+void NetdTickScheduler::drain_timer() {
+    if (m_timer_fd.get() < 0) {
+        return;
     }
 
-    if (next_wakeup_ms <= now_ms) {
+    uint64_t expirations = 0u;
+    (void)eventfd_read(m_timer_fd.get(), &expirations);
+}
+
+int NetdTickScheduler::compute_poll_timeout_ms(uint32_t now_ms, uint32_t next_wakeup_ms) {
+    uint32_t deadline_ms = 0u;
+    bool have_deadline = m_wheel.next_expiry_ms(deadline_ms);
+
+    if (next_wakeup_ms != 0u && (!have_deadline || next_wakeup_ms < deadline_ms)) {
+        deadline_ms = next_wakeup_ms;
+        have_deadline = true;
+    }
+
+    if (!have_deadline) {
+        arm_timer(0u);
+        return (int)m_poll_cap_ms;
+    }
+
+    if (deadline_ms <= now_ms) {
         return 0;
     }
 
-    const uint32_t dt = next_wakeup_ms - now_ms;
-    if (dt < (uint32_t)timeout_ms) {
-        timeout_ms = (int)dt;
+    if (m_timer_fd.get() >= 0) {
+        arm_timer(deadline_ms);
+        return (int)m_poll_cap_ms;
     }
 
-    return timeout_ms;
+    const uint32_t dt = deadline_ms - now_ms;
+
+    return dt < m_poll_cap_ms ? (int)dt : (int)m_poll_cap_ms;
 }
 
+
 }
@@ -2,6 +2,7 @@
 #define YOS_NETD_TICK_SCHEDULER_H
 
 #include "timing_wheel.h"
+#include "net_core.h"
 #include "arena.h"
 
 #include <stdint.h>
@@ -24,7 +25,20 @@ public:
 
     void tick(uint32_t now_ms);
 
-    int compute_poll_timeout_ms(uint32_t now_ms, uint32_t next_wakeup_ms) const;
+    /*
+     * Arms the timerfd for the earlier of the next wheel expiry and
+     * `next_wakeup_ms` (0: none), and returns the poll() timeout: 0 when
+     * that is already due, the cap otherwise. Without a timerfd the timeout
+     * itself runs to the deadline.
+     */
+    int compute_poll_timeout_ms(uint32_t now_ms, uint32_t next_wakeup_ms);
+
+    /* Polled for POLLIN next to the device, or -1. */
+    int timer_fd() const {
+        return m_timer_fd.get();
+    }
+
+    void drain_timer();
 
     uint32_t timer_count() const;
     uint32_t capacity() const;
@@ -38,8 +52,13 @@ public:
     }
 
 private:
+    void arm_timer(uint32_t deadline_ms);
+
     TimingWheel m_wheel;
     uint32_t m_poll_cap_ms;
+
+    UniqueFd m_timer_fd;
+    uint32_t m_armed_ms;
 };
 
 }
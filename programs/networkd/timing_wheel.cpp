@@ -372,4 +372,24 @@ bool TimingWheel::has_pending_timers() const {
     return m_active_count > 0;
 }
 
+bool TimingWheel::next_expiry_ms(uint32_t& out_ms) const {
+    if (m_active_count == 0) {
+        return false;
+    }
+
+    const Wheel& wheel = m_wheels[0];
+    const uint32_t slot_mask = kSlotsPerWheel - 1u;
+
+    /* tick() processes the slot `k` ahead of the current one once now_ms passes m_current_time_ms + k. */
+    for (uint32_t k = 0; k < kSlotsPerWheel; k++) {
+        if (wheel.slots[(wheel.current_slot + k) & slot_mask].head) {
+            out_ms = m_current_time_ms + k + 1u;
+            return true;
+        }
+    }
+
+    out_ms = m_current_time_ms + (kSlotsPerWheel - wheel.current_slot);
+    return true;
+}
+
 }
\ No newline at end of file
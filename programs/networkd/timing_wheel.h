@@ -80,6 +80,13 @@ public:
     void tick(uint32_t now_ms);
     
     bool has_pending_timers() const;
+
+    /*
+     * The uptime at which tick() next has work: when the earliest timer in
+     * wheel 0 fires, or when wheel 0 wraps and the outer wheels cascade into
+     * it. False when no timer is scheduled.
+     */
+    bool next_expiry_ms(uint32_t& out_ms) const;
     
     uint32_t timer_count() const {
         return m_active_count;
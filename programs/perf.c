@@ -0,0 +1,664 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+#include <yos/prof.h>
+
+/*
+ * Sampling profiler front end for /dev/prof.
+ *
+ * Samples either for the lifetime of a command or for a fixed time, then
+ * prints the hottest functions. Kernel addresses are resolved by the kernel
+ * symbol table through YOS_PROF_RESOLVE; user addresses are resolved from
+ * the .symtab of the sampled executable. "self" counts samples whose
+ * interrupted EIP is in the function, "total" counts samples where the
+ * function appears anywhere in the captured kernel backtrace.
+ *
+ * Usage: perf [-F hz] [-d ms] [-n top] [-a] [command args...]
+ *   -F  sampling rate (default 1000, capped at the timer rate)
+ *   -d  duration when no command is given (default 5000 ms)
+ *   -n  number of functions to print (default 25)
+ *   -a  include idle CPU samples
+ */
+
+#define PERF_READ_BATCH   64u
+#define PERF_POLL_MS      20u
+#define PERF_MAX_SAMPLES  65536u
+#define PERF_MAX_OBJECTS  32u
+#define PERF_IP_BUCKETS   16384u
+#define PERF_SYM_BUCKETS  4096u
+
+#define PERF_OBJ_KERNEL 0u
+
+typedef uint32_t Elf32_Addr;
+typedef uint16_t Elf32_Half;
+typedef uint32_t Elf32_Off;
+typedef uint32_t Elf32_Word;
+
+#define EI_NIDENT  16
+#define SHT_SYMTAB 2
+#define STT_FUNC   2
+#define ELF32_ST_TYPE(i) ((i) & 0xF)
+
+typedef struct {
+    unsigned char e_ident[EI_NIDENT];
+    Elf32_Half    e_type;
+    Elf32_Half    e_machine;
+    Elf32_Word    e_version;
+    Elf32_Addr    e_entry;
+    Elf32_Off     e_phoff;
+    Elf32_Off     e_shoff;
+    Elf32_Word    e_flags;
+    Elf32_Half    e_ehsize;
+    Elf32_Half    e_phentsize;
+    Elf32_Half    e_phnum;
+    Elf32_Half    e_shentsize;
+    Elf32_Half    e_shnum;
+    Elf32_Half    e_shstrndx;
+} __attribute__((packed)) Elf32_Ehdr;
+
+typedef struct {
+    Elf32_Word    sh_name;
+    Elf32_Word    sh_type;
+    Elf32_Word    sh_flags;
+    Elf32_Addr    sh_addr;
+    Elf32_Off     sh_offset;
+    Elf32_Word    sh_size;
+    Elf32_Word    sh_link;
+    Elf32_Word    sh_info;
+    Elf32_Word    sh_addralign;
+    Elf32_Word    sh_entsize;
+} __attribute__((packed)) Elf32_Shdr;
+
+typedef struct {
+    Elf32_Word    st_name;
+    Elf32_Addr    st_value;
+    Elf32_Word    st_size;
+    unsigned char st_info;
+    unsigned char st_other;
+    Elf32_Half    st_shndx;
+} __attribute__((packed)) Elf32_Sym;
+
+/* Compact copy of a sample: which object the addresses belong to, and the chain. */
+typedef struct {
+    uint16_t obj;
+    uint8_t depth;
+    uint8_t flags;
+    uint32_t ip[YOS_PROF_MAX_DEPTH];
+} perf_sample_t;
+
+typedef struct {
+    uint32_t addr;
+    uint32_t size;
+    const char* name;
+} perf_func_t;
+
+/* A sampled executable (index 0 is the kernel). */
+typedef struct {
+    char path[YOS_PROF_COMM_MAX];
+    int loaded;
+
+    uint8_t* image;
+    perf_func_t* funcs;
+    uint32_t func_count;
+} perf_object_t;
+
+typedef struct {
+    uint32_t obj;
+    uint32_t addr;
+    char* name;
+
+    uint32_t self;
+    uint32_t total;
+
+    /* Last sample that counted towards `total`, so recursion counts once. */
+    uint32_t seen;
+} perf_symbol_t;
+
+typedef struct {
+    uint32_t obj;
+    uint32_t ip;
+    int32_t sym;
+} perf_ip_slot_t;
+
+static perf_sample_t* g_samples;
+static uint32_t g_sample_count;
+static uint32_t g_sample_lost;
+
+static uint32_t g_idle;
+static uint32_t g_seen;
+
+static perf_object_t g_objects[PERF_MAX_OBJECTS];
+static uint32_t g_object_count = 1u;
+
+static perf_symbol_t* g_syms;
+static uint32_t g_sym_count;
+static uint32_t g_sym_cap;
+
+static int32_t g_sym_buckets[PERF_SYM_BUCKETS];
+static perf_ip_slot_t g_ip_slots[PERF_IP_BUCKETS];
+
+static int g_prof_fd = -1;
+
+static volatile uint32_t g_child_done;
+
+static uint32_t hash2(uint32_t a, uint32_t b) {
+    uint32_t h = a * 0x9E3779B1u ^ b * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0xC2B2AE3Du;
+    h ^= h >> 13;
+    return h;
+}
+
+static uint32_t object_index(const char* comm) {
+    for (uint32_t i = 1; i < g_object_count; i++) {
+        if (strncmp(g_objects[i].path, comm, YOS_PROF_COMM_MAX) == 0) {
+            return i;
+        }
+    }
+
+    if (g_object_count == PERF_MAX_OBJECTS) {
+        return PERF_MAX_OBJECTS;
+    }
+
+    perf_object_t* o = &g_objects[g_object_count];
+    memcpy(o->path, comm, YOS_PROF_COMM_MAX);
+    o->path[YOS_PROF_COMM_MAX - 1u] = '\0';
+
+    return g_object_count++;
+}
+
+static void record(const yos_prof_sample_t* s, int want_idle) {
+    g_seen++;
+
+    if (s->flags & YOS_PROF_SAMPLE_IDLE) {
+        g_idle++;
+
+        if (!want_idle) {
+            return;
+        }
+    }
+
+    if (g_sample_count == PERF_MAX_SAMPLES) {
+        g_sample_lost++;
+        return;
+    }
+
+    uint32_t obj = PERF_OBJ_KERNEL;
+
+    if (s->flags & YOS_PROF_SAMPLE_USER) {
+        obj = object_index(s->comm);
+        if (obj == PERF_MAX_OBJECTS) {
+            g_sample_lost++;
+            return;
+        }
+    }
+
+    perf_sample_t* d = &g_samples[g_sample_count++];
+
+    uint32_t depth = s->depth;
+    if (depth == 0u) depth = 1u;
+    if (depth > YOS_PROF_MAX_DEPTH) depth = YOS_PROF_MAX_DEPTH;
+
+    d->obj = (uint16_t)obj;
+    d->depth = (uint8_t)depth;
+    d->flags = (uint8_t)s->flags;
+
+    for (uint32_t i = 0; i < depth; i++) {
+        d->ip[i] = s->ip[i];
+    }
+}
+
+static void drain(int want_idle) {
+    yos_prof_sample_t batch[PERF_READ_BATCH];
+
+    for (;;) {
+        int r = read(g_prof_fd, batch, sizeof(batch));
+        if (r <= 0) {
+            return;
+        }
+
+        const uint32_t n = (uint32_t)r / (uint32_t)sizeof(yos_prof_sample_t);
+
+        for (uint32_t i = 0; i < n; i++) {
+            record(&batch[i], want_idle);
+        }
+    }
+}
+
+static int func_cmp(const void* a, const void* b) {
+    const perf_func_t* fa = (const perf_func_t*)a;
+    const perf_func_t* fb = (const perf_func_t*)b;
+
+    if (fa->addr < fb->addr) return -1;
+    if (fa->addr > fb->addr) return 1;
+    return 0;
+}
+
+static uint8_t* read_file(const char* path, uint32_t* out_size) {
+    stat_t st;
+    if (stat(path, &st) != 0 || st.size == 0u) {
+        return 0;
+    }
+
+    int fd = open(path, 0);
+    if (fd < 0) {
+        return 0;
+    }
+
+    uint8_t* buf = (uint8_t*)malloc(st.size);
+    if (!buf) {
+        close(fd);
+        return 0;
+    }
+
+    uint32_t done = 0;
+    while (done < st.size) {
+        int r = read(fd, buf + done, st.size - done);
+        if (r <= 0) {
+            break;
+        }
+        done += (uint32_t)r;
+    }
+
+    close(fd);
+
+    if (done != st.size) {
+        free(buf);
+        return 0;
+    }
+
+    *out_size = done;
+    return buf;
+}
+
+/* Collect the STT_FUNC entries of the executable's .symtab, sorted by address. */
+static void load_object(perf_object_t* o) {
+    o->loaded = 1;
+
+    uint32_t size = 0;
+    uint8_t* img = read_file(o->path, &size);
+    if (!img) {
+        return;
+    }
+
+    const Elf32_Ehdr* eh = (const Elf32_Ehdr*)img;
+
+    if (size < sizeof(*eh) || memcmp(eh->e_ident, "\x7F" "ELF", 4) != 0
+        || eh->e_shentsize != sizeof(Elf32_Shdr)
+        || eh->e_shoff > size || (uint32_t)eh->e_shnum * sizeof(Elf32_Shdr) > size - eh->e_shoff) {
+        free(img);
+        return;
+    }
+
+    const Elf32_Shdr* sh = (const Elf32_Shdr*)(img + eh->e_shoff);
+
+    for (uint32_t i = 0; i < eh->e_shnum; i++) {
+        if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum) {
+            continue;
+        }
+
+        const Elf32_Shdr* strsh = &sh[sh[i].sh_link];
+
+        if (sh[i].sh_offset > size || sh[i].sh_size > size - sh[i].sh_offset
+            || strsh->sh_offset > size || strsh->sh_size > size - strsh->sh_offset) {
+            break;
+        }
+
+        const Elf32_Sym* syms = (const Elf32_Sym*)(img + sh[i].sh_offset);
+        const uint32_t count = sh[i].sh_size / sizeof(Elf32_Sym);
+        const char* strtab = (const char*)(img + strsh->sh_offset);
+
+        perf_func_t* funcs = (perf_func_t*)malloc((count ? count : 1u) * sizeof(perf_func_t));
+        if (!funcs) {
+            break;
+        }
+
+        uint32_t n = 0;
+
+        for (uint32_t k = 0; k < count; k++) {
+            if (ELF32_ST_TYPE(syms[k].st_info) != STT_FUNC || syms[k].st_value == 0u
+                || syms[k].st_name >= strsh->sh_size) {
+                continue;
+            }
+
+            funcs[n].addr = syms[k].st_value;
+            funcs[n].size = syms[k].st_size;
+            funcs[n].name = strtab + syms[k].st_name;
+            n++;
+        }
+
+        qsort(funcs, n, sizeof(perf_func_t), func_cmp);
+
+        o->image = img;
+        o->funcs = funcs;
+        o->func_count = n;
+        return;
+    }
+
+    free(img);
+}
+
+static const perf_func_t* find_func(perf_object_t* o, uint32_t ip) {
+    if (!o->loaded) {
+        load_object(o);
+    }
+
+    uint32_t lo = 0;
+    uint32_t hi = o->func_count;
+
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2u;
+
+        if (o->funcs[mid].addr <= ip) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == 0u) {
+        return 0;
+    }
+
+    const perf_func_t* f = &o->funcs[lo - 1u];
+
+    if (f->size != 0u && ip - f->addr >= f->size) {
+        return 0;
+    }
+
+    return f;
+}
+
+static int32_t symbol_get(uint32_t obj, uint32_t addr, const char* name) {
+    uint32_t b = hash2(obj, addr) & (PERF_SYM_BUCKETS - 1u);
+
+    for (;;) {
+        const int32_t idx = g_sym_buckets[b] - 1;
+
+        if (idx < 0) {
+            break;
+        }
+
+        if (g_syms[idx].obj == obj && g_syms[idx].addr == addr) {
+            return idx;
+        }
+
+        b = (b + 1u) & (PERF_SYM_BUCKETS - 1u);
+    }
+
+    if (g_sym_count == PERF_SYM_BUCKETS - 1u) {
+        return -1;
+    }
+
+    if (g_sym_count == g_sym_cap) {
+        const uint32_t cap = g_sym_cap ? g_sym_cap * 2u : 256u;
+
+        perf_symbol_t* n = (perf_symbol_t*)realloc(g_syms, cap * sizeof(perf_symbol_t));
+        if (!n) {
+            return -1;
+        }
+
+        g_syms = n;
+        g_sym_cap = cap;
+    }
+
+    perf_symbol_t* s = &g_syms[g_sym_count];
+    memset(s, 0, sizeof(*s));
+
+    s->obj = obj;
+    s->addr = addr;
+    s->name = strdup(name);
+    s->seen = 0xFFFFFFFFu;
+
+    g_sym_buckets[b] = (int32_t)g_sym_count + 1;
+
+    return (int32_t)g_sym_count++;
+}
+
+static int32_t resolve_uncached(uint32_t obj, uint32_t ip) {
+    if (obj == PERF_OBJ_KERNEL) {
+        yos_prof_sym_t q;
+        memset(&q, 0, sizeof(q));
+        q.addr = ip;
+
+        if (ioctl(g_prof_fd, YOS_PROF_RESOLVE, &q) == 0 && q.name[0]) {
+            q.name[sizeof(q.name) - 1u] = '\0';
+            return symbol_get(obj, q.sym_addr, q.name);
+        }
+    } else {
+        const perf_func_t* f = find_func(&g_objects[obj], ip);
+        if (f) {
+            return symbol_get(obj, f->addr, f->name);
+        }
+    }
+
+    /* Unresolvable addresses of one object are grouped together. */
+    return symbol_get(obj, 0u, "[unknown]");
+}
+
+static int32_t resolve(uint32_t obj, uint32_t ip) {
+    uint32_t b = hash2(obj, ip) & (PERF_IP_BUCKETS - 1u);
+
+    for (uint32_t probes = 0; probes < PERF_IP_BUCKETS; probes++) {
+        perf_ip_slot_t* slot = &g_ip_slots[b];
+
+        if (slot->sym == 0) {
+            const int32_t sym = resolve_uncached(obj, ip);
+
+            slot->obj = obj;
+            slot->ip = ip;
+            slot->sym = sym + 1;
+
+            return sym;
+        }
+
+        if (slot->obj == obj && slot->ip == ip) {
+            return slot->sym - 1;
+        }
+
+        b = (b + 1u) & (PERF_IP_BUCKETS - 1u);
+    }
+
+    return resolve_uncached(obj, ip);
+}
+
+static void aggregate(void) {
+    for (uint32_t i = 0; i < g_sample_count; i++) {
+        const perf_sample_t* s = &g_samples[i];
+
+        for (uint32_t d = 0; d < s->depth; d++) {
+            const int32_t sym = resolve(s->obj, s->ip[d]);
+            if (sym < 0) {
+                continue;
+            }
+
+            perf_symbol_t* p = &g_syms[sym];
+
+            if (d == 0u) {
+                p->self++;
+            }
+
+            if (p->seen != i) {
+                p->seen = i;
+                p->total++;
+            }
+        }
+    }
+}
+
+static int sym_cmp(const void* a, const void* b) {
+    const perf_symbol_t* sa = (const perf_symbol_t*)a;
+    const perf_symbol_t* sb = (const perf_symbol_t*)b;
+
+    if (sa->self != sb->self) return sa->self < sb->self ? 1 : -1;
+    if (sa->total != sb->total) return sa->total < sb->total ? 1 : -1;
+    return 0;
+}
+
+static const char* object_name(uint32_t obj) {
+    if (obj == PERF_OBJ_KERNEL) {
+        return "[kernel]";
+    }
+
+    const char* p = g_objects[obj].path;
+    const char* slash = strrchr(p, '/');
+
+    return slash ? slash + 1 : p;
+}
+
+/* Prints a percentage of `total` with two decimals. */
+static void print_pct(uint32_t part, uint32_t total) {
+    const uint32_t bp = total ? (uint32_t)(((uint64_t)part * 10000u) / total) : 0u;
+    printf("%3u.%02u", bp / 100u, bp % 100u);
+}
+
+static void report(uint32_t top, uint32_t hz, uint32_t elapsed_ms) {
+    yos_prof_stats_t st;
+    memset(&st, 0, sizeof(st));
+    (void)ioctl(g_prof_fd, YOS_PROF_STATS, &st);
+
+    printf("perf: %u samples at %u Hz over %u ms", g_seen, st.hz ? st.hz : hz, elapsed_ms);
+    if (st.dropped || g_sample_lost) {
+        printf(", %u dropped", st.dropped + g_sample_lost);
+    }
+    printf(", idle ");
+    print_pct(g_idle, g_seen);
+    printf("%%\n\n");
+
+    if (g_sample_count == 0u) {
+        printf("perf: no samples\n");
+        return;
+    }
+
+    aggregate();
+
+    qsort(g_syms, g_sym_count, sizeof(perf_symbol_t), sym_cmp);
+
+    printf("  self%%  total%%  samples  object            symbol\n");
+
+    for (uint32_t i = 0; i < g_sym_count && i < top; i++) {
+        const perf_symbol_t* s = &g_syms[i];
+
+        if (s->self == 0u) {
+            break;
+        }
+
+        printf(" ");
+        print_pct(s->self, g_sample_count);
+        printf(" ");
+        print_pct(s->total, g_sample_count);
+        printf("  %7u  %-16s  %s\n", s->self, object_name(s->obj), s->name);
+    }
+}
+
+static void* wait_child(void* arg) {
+    int st = 0;
+    (void)waitpid((int)(uintptr_t)arg, &st);
+
+    __atomic_store_n(&g_child_done, 1u, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void usage(void) {
+    printf("Usage: perf [-F hz] [-d ms] [-n top] [-a] [command args...]\n");
+}
+
+int main(int argc, char** argv) {
+    uint32_t hz = 1000u;
+    uint32_t duration_ms = 5000u;
+    uint32_t top = 25u;
+    int want_idle = 0;
+
+    int i = 1;
+
+    while (i < argc && argv[i][0] == '-') {
+        const char* opt = argv[i];
+
+        if (strcmp(opt, "-a") == 0) {
+            want_idle = 1;
+            i++;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        if (strcmp(opt, "-F") == 0) {
+            hz = (uint32_t)atoi(argv[i + 1]);
+        } else if (strcmp(opt, "-d") == 0) {
+            duration_ms = (uint32_t)atoi(argv[i + 1]);
+        } else if (strcmp(opt, "-n") == 0) {
+            top = (uint32_t)atoi(argv[i + 1]);
+        } else {
+            usage();
+            return 1;
+        }
+
+        i += 2;
+    }
+
+    if (hz == 0u) hz = 1000u;
+    if (top == 0u) top = 1u;
+
+    g_samples = (perf_sample_t*)malloc(PERF_MAX_SAMPLES * sizeof(perf_sample_t));
+    if (!g_samples) {
+        printf("perf: out of memory\n");
+        return 1;
+    }
+
+    g_prof_fd = open("/dev/prof", 0);
+    if (g_prof_fd < 0) {
+        printf("perf: cannot open /dev/prof\n");
+        return 1;
+    }
+
+    if (ioctl(g_prof_fd, YOS_PROF_START, &hz) != 0) {
+        printf("perf: cannot start sampling\n");
+        close(g_prof_fd);
+        return 1;
+    }
+
+    const uint32_t start = uptime_ms();
+
+    if (i < argc) {
+        int pid = spawn_process_resolved(argv[i], argc - i, &argv[i]);
+        if (pid < 0) {
+            (void)ioctl(g_prof_fd, YOS_PROF_STOP, 0);
+            printf("perf: spawn failed\n");
+            close(g_prof_fd);
+            return 1;
+        }
+
+        pthread_t waiter;
+        if (pthread_create(&waiter, 0, wait_child, (void*)(uintptr_t)pid) != 0) {
+            int st = 0;
+            (void)waitpid(pid, &st);
+            g_child_done = 1u;
+        } else {
+            while (!__atomic_load_n(&g_child_done, __ATOMIC_ACQUIRE)) {
+                drain(want_idle);
+                sleep((int)PERF_POLL_MS);
+            }
+
+            (void)pthread_join(waiter, 0);
+        }
+    } else {
+        while (uptime_ms() - start < duration_ms) {
+            drain(want_idle);
+            sleep((int)PERF_POLL_MS);
+        }
+    }
+
+    const uint32_t elapsed = uptime_ms() - start;
+
+    (void)ioctl(g_prof_fd, YOS_PROF_STOP, 0);
+    drain(want_idle);
+
+    report(top, hz, elapsed);
+
+    close(g_prof_fd);
+    return 0;
+}
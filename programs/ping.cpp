@@ -2,33 +2,6 @@
 
 #include <yos/netd_ipc.h>
 
-extern "C" unsigned long long __udivdi3(unsigned long long n, unsigned long long d) {
-    if (d == 0ull) {
-        return 0ull;
-    }
-
-    if (d == 1ull) {
-        return n;
-    }
-
-    if (n < d) {
-        return 0ull;
-    }
-
-    unsigned long long q = 0ull;
-    unsigned long long r = 0ull;
-
-    for (int i = 63; i >= 0; i--) {
-        r = (r << 1) | ((n >> i) & 1ull);
-        if (r >= d) {
-            r -= d;
-            q |= (1ull << i);
-        }
-    }
-
-    return q;
-}
-
 namespace ping {
 
 static constexpr uint32_t kPayloadBytes = 56u;
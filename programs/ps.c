@@ -15,9 +15,59 @@ static const char* state_name(uint32_t st) {
     }
 }
 
+/* User plus system time in hundredths of a second. */
+static uint32_t cpu_centis(const yos_rusage_t* ru) {
+    return (ru->utime_sec + ru->stime_sec) * 100u + (ru->utime_usec + ru->stime_usec) / 10000u;
+}
+
+static void print_default(const yos_proc_info_t* list, int n) {
+    printf(" PID   PPID   STATE     PRIO  PAGES  TERM      TIME  NAME\n");
+    for (int i = 0; i < n; i++) {
+        const yos_proc_info_t* p = &list[i];
+        const uint32_t cs = cpu_centis(&p->ru);
+        printf("%5u %6u %-9s %5u %6u %5u %6u.%02u  %s\n",
+               p->pid,
+               p->parent_pid,
+               state_name(p->state),
+               p->priority,
+               p->mem_pages,
+               p->term_mode,
+               cs / 100u, cs % 100u,
+               p->name);
+    }
+}
+
+/* ps -r: where each task's time, faults, switches and I/O went. */
+static void print_rusage(const yos_proc_info_t* list, int n) {
+    printf(" PID     USER      SYS  MINFLT MAJFLT   VCSW  IVCSW   READ_KIB  WRITE_KIB  NAME\n");
+    for (int i = 0; i < n; i++) {
+        const yos_proc_info_t* p = &list[i];
+        const yos_rusage_t* ru = &p->ru;
+        printf("%5u %5u.%02u %5u.%02u %7u %6u %6u %6u %10u %10u  %s\n",
+               p->pid,
+               ru->utime_sec, ru->utime_usec / 10000u,
+               ru->stime_sec, ru->stime_usec / 10000u,
+               ru->minflt,
+               ru->majflt,
+               ru->nvcsw,
+               ru->nivcsw,
+               (uint32_t)(ru->read_bytes >> 10),
+               (uint32_t)(ru->write_bytes >> 10),
+               p->name);
+    }
+}
+
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
+    int rusage = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0) {
+            rusage = 1;
+        } else {
+            printf("Usage: ps [-r]\n");
+            return 1;
+        }
+    }
 
     uint32_t cap = 64;
     yos_proc_info_t* list = 0;
@@ -46,17 +96,10 @@ int main(int argc, char** argv) {
         }
 
         if ((uint32_t)n < cap) {
-            printf(" PID   PPID   STATE     PRIO  PAGES  TERM  NAME\n");
-            for (int i = 0; i < n; i++) {
-                const yos_proc_info_t* p = &list[i];
-                printf("%5u %6u %-9s %5u %6u %5u  %s\n",
-                       p->pid,
-                       p->parent_pid,
-                       state_name(p->state),
-                       p->priority,
-                       p->mem_pages,
-                       p->term_mode,
-                       p->name);
+            if (rusage) {
+                print_rusage(list, n);
+            } else {
+                print_default(list, n);
             }
             free(list);
             return 0;
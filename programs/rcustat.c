@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+#include <yos/rcustat.h>
+
+/*
+ * Per-CPU RCU viewer for /dev/rcustat.
+ *
+ * Prints the callback segment lengths of every CPU together with grace
+ * period and callback rates measured over a short interval.
+ *
+ * Usage: rcustat [-d ms]
+ *   -d  sampling interval for the rates (default 1000, 0 skips them)
+ */
+
+#define RCUSTAT_MAX_CPUS 32u
+
+static yos_rcu_cpu_stats_t g_before[RCUSTAT_MAX_CPUS];
+static yos_rcu_cpu_stats_t g_after[RCUSTAT_MAX_CPUS];
+
+static uint32_t load_stats(yos_rcu_cpu_stats_t* out) {
+    int fd = open("/dev/rcustat", 0);
+    if (fd < 0) {
+        return 0;
+    }
+
+    int r = read(fd, out, RCUSTAT_MAX_CPUS * (uint32_t)sizeof(yos_rcu_cpu_stats_t));
+
+    close(fd);
+
+    return r > 0 ? (uint32_t)r / (uint32_t)sizeof(yos_rcu_cpu_stats_t) : 0u;
+}
+
+static uint32_t per_second(uint32_t delta, uint32_t elapsed_ms) {
+    if (elapsed_ms == 0u) {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)delta * 1000ull) / elapsed_ms);
+}
+
+int main(int argc, char** argv) {
+    int interval_ms = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            interval_ms = atoi(argv[++i]);
+        } else {
+            printf("Usage: rcustat [-d ms]\n");
+            return 1;
+        }
+    }
+
+    uint32_t before = 0;
+    uint32_t t0 = 0;
+
+    if (interval_ms > 0) {
+        before = load_stats(g_before);
+        t0 = uptime_ms();
+
+        sleep(interval_ms);
+    }
+
+    const uint32_t count = load_stats(g_after);
+    const uint32_t elapsed = interval_ms > 0 ? uptime_ms() - t0 : 0u;
+
+    if (count == 0u) {
+        printf("rcustat: cannot read /dev/rcustat\n");
+        return 1;
+    }
+
+    printf("%3s %7s %7s %7s %10s %10s %8s %8s %7s\n",
+           "cpu", "next", "wait", "done", "queued", "invoked", "gp/s", "cb/s", "exp%");
+
+    for (uint32_t i = 0; i < count; i++) {
+        const yos_rcu_cpu_stats_t* c = &g_after[i];
+
+        const uint32_t exp = c->gps != 0u ? (uint32_t)(((uint64_t)c->gps_expedited * 100u) / c->gps) : 0u;
+
+        printf("%3u %7u %7u %7u %10u %10u ", c->cpu, c->next, c->wait, c->done, c->queued, c->invoked);
+
+        if (i < before && g_before[i].cpu == c->cpu) {
+            const yos_rcu_cpu_stats_t* b = &g_before[i];
+
+            printf("%8u %8u", per_second(c->gps - b->gps, elapsed), per_second(c->invoked - b->invoked, elapsed));
+        } else {
+            printf("%8s %8s", "-", "-");
+        }
+
+        printf(" %6u%%%s\n", exp, c->offloaded ? "  offloaded" : "");
+    }
+
+    return 0;
+}
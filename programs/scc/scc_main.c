@@ -150,6 +150,63 @@ static void scc_compile_file(const char* in_path, const char* out_path, const Sc
     free(pp_res.text);
 }
 
+typedef struct {
+    const char* in_path;
+    char* out_path;
+    const SccPPConfig* pp_cfg;
+} SccJob;
+
+/* Compilations share nothing but the read-only preprocessor config. */
+static void scc_compile_job(void* arg) {
+    SccJob* job = (SccJob*)arg;
+    scc_compile_file(job->in_path, job->out_path, job->pp_cfg);
+}
+
+/* foo.c -> foo.o, anything else gets .o appended. */
+static char* scc_object_path(const char* in_path) {
+    size_t len = strlen(in_path);
+    size_t stem = len;
+    if (len > 2 && in_path[len - 2] == '.' && in_path[len - 1] == 'c') stem = len - 2;
+
+    char* out = (char*)malloc(stem + 3);
+    if (!out) exit(1);
+    memcpy(out, in_path, stem);
+    memcpy(out + stem, ".o", 3);
+    return out;
+}
+
+/* Worker stacks hold the recursive-descent parser, so they get more than the pool default. */
+#define SCC_WORKER_STACK_SIZE (1024u * 1024u)
+
+static void scc_compile_many(char** inputs, int input_count, const SccPPConfig* pp_cfg) {
+    SccJob* jobs = (SccJob*)calloc((size_t)input_count, sizeof(SccJob));
+    if (!jobs) exit(1);
+
+    for (int i = 0; i < input_count; i++) {
+        jobs[i].in_path = inputs[i];
+        jobs[i].out_path = scc_object_path(inputs[i]);
+        jobs[i].pp_cfg = pp_cfg;
+    }
+
+    taskpool_t* pool = 0;
+    if (input_count > 1) pool = taskpool_create(0u, SCC_WORKER_STACK_SIZE);
+
+    task_group_t group;
+    task_group_init(&group);
+    for (int i = 0; i < input_count; i++) {
+        task_group_spawn(pool, &group, scc_compile_job, &jobs[i]);
+    }
+    task_group_wait(pool, &group);
+
+    taskpool_destroy(pool);
+
+    for (int i = 0; i < input_count; i++) {
+        printf("Success: %s\n", jobs[i].out_path);
+        free(jobs[i].out_path);
+    }
+    free(jobs);
+}
+
 static void scc_opt_push_cstr(const char* s, char*** out, int* out_count, int* out_cap) {
     if (!s) return;
     if (*out_count == *out_cap) {
@@ -198,7 +255,7 @@ static void scc_opt_push_define(const char* s, SccPPDefine** out, int* out_count
 
 int main(int argc, char** argv) {
     if (argc < 3) {
-        printf("SCC v0.2\nUsage: scc [opts] -o out.o input.c\n       scc [opts] input.c out.o\n\nopts:\n  -I <dir>    add include search path\n  -D<name>=<value> define object-like macro\n  -D<name>    define object-like macro as 1\n");
+        printf("SCC v0.2\nUsage: scc [opts] -o out.o input.c\n       scc [opts] input.c out.o\n       scc [opts] -c input.c...\n\nopts:\n  -c          compile each input to its own .o, in parallel\n  -I <dir>    add include search path\n  -D<name>=<value> define object-like macro\n  -D<name>    define object-like macro as 1\n");
         return 1;
     }
 
@@ -213,7 +270,17 @@ int main(int argc, char** argv) {
     int define_count = 0;
     int define_cap = 0;
 
+    int compile_only = 0;
+    char** inputs = 0;
+    int input_count = 0;
+    int input_cap = 0;
+
     for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            compile_only = 1;
+            continue;
+        }
+
         if (strcmp(argv[i], "-o") == 0) {
             if (i + 1 >= argc) {
                 printf("Missing value after -o\n");
@@ -251,15 +318,29 @@ int main(int argc, char** argv) {
             continue;
         }
 
-        if (!in_path) in_path = argv[i];
-        else if (!out_path) out_path = argv[i];
-        else {
-            printf("Unexpected argument: %s\n", argv[i]);
+        scc_opt_push_cstr(argv[i], &inputs, &input_count, &input_cap);
+    }
+
+    if (compile_only) {
+        if (input_count == 0 || (out_path && input_count > 1)) {
+            printf("Invalid arguments\n");
             return 1;
         }
+        if (out_path) {
+            in_path = inputs[0];
+            compile_only = 0;
+        }
+    } else {
+        const int max_inputs = out_path ? 1 : 2;
+        if (input_count > max_inputs) {
+            printf("Unexpected argument: %s\n", inputs[max_inputs]);
+            return 1;
+        }
+        if (input_count > 0) in_path = inputs[0];
+        if (input_count > 1) out_path = inputs[1];
     }
 
-    if (!in_path || !out_path) {
+    if (!compile_only && (!in_path || !out_path)) {
         printf("Invalid arguments\n");
         return 1;
     }
@@ -272,7 +353,11 @@ int main(int argc, char** argv) {
     pp_cfg.define_count = define_count;
     pp_cfg.max_include_depth = 64;
 
-    scc_compile_file(in_path, out_path, &pp_cfg);
+    if (compile_only) {
+        scc_compile_many(inputs, input_count, &pp_cfg);
+    } else {
+        scc_compile_file(in_path, out_path, &pp_cfg);
+    }
 
     if (include_paths) {
         for (int i = 0; i < include_count; i++) {
@@ -288,6 +373,13 @@ int main(int argc, char** argv) {
         free(defines);
     }
 
-    printf("Success: %s\n", out_path);
+    if (out_path) printf("Success: %s\n", out_path);
+
+    if (inputs) {
+        for (int i = 0; i < input_count; i++) {
+            if (inputs[i]) free(inputs[i]);
+        }
+        free(inputs);
+    }
     return 0;
 }
@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+#include <yos/slabinfo.h>
+
+/*
+ * Kernel heap cache viewer for /dev/slabinfo.
+ *
+ * Prints every cache with its object size, live and total objects, slabs,
+ * fragmentation (share of slab memory not holding a live object) and the
+ * alloc/free rates measured over a short interval.
+ *
+ * Usage: slabinfo [-d ms] [-a]
+ *   -d  sampling interval for the rates (default 1000, 0 skips them)
+ *   -a  also list caches that currently own no slabs
+ */
+
+#define SLABINFO_MAX_CACHES 128u
+
+static yos_slabinfo_t g_before[SLABINFO_MAX_CACHES];
+static yos_slabinfo_t g_after[SLABINFO_MAX_CACHES];
+
+static uint32_t load_caches(yos_slabinfo_t* out) {
+    int fd = open("/dev/slabinfo", 0);
+    if (fd < 0) {
+        return 0;
+    }
+
+    uint32_t n = 0;
+
+    while (n < SLABINFO_MAX_CACHES) {
+        int r = read(fd, &out[n], (SLABINFO_MAX_CACHES - n) * (uint32_t)sizeof(yos_slabinfo_t));
+        if (r <= 0) {
+            break;
+        }
+
+        n += (uint32_t)r / (uint32_t)sizeof(yos_slabinfo_t);
+    }
+
+    close(fd);
+    return n;
+}
+
+/* Dynamic caches come and go between samples, so match by identity rather than position. */
+static const yos_slabinfo_t* find_before(const yos_slabinfo_t* c, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const yos_slabinfo_t* b = &g_before[i];
+
+        if (b->object_size == c->object_size && b->flags == c->flags
+            && strncmp(b->name, c->name, sizeof(b->name)) == 0) {
+            return b;
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t per_second(uint32_t delta, uint32_t elapsed_ms) {
+    if (elapsed_ms == 0u) {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)delta * 1000ull) / elapsed_ms);
+}
+
+static void usage(void) {
+    printf("Usage: slabinfo [-d ms] [-a]\n");
+}
+
+int main(int argc, char** argv) {
+    int all = 0;
+    int interval_ms = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+
+        if (strcmp(opt, "-a") == 0) {
+            all = 1;
+        } else if (i + 1 < argc && strcmp(opt, "-d") == 0) {
+            interval_ms = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    uint32_t before = 0;
+    uint32_t t0 = 0;
+
+    if (interval_ms > 0) {
+        before = load_caches(g_before);
+        t0 = uptime_ms();
+
+        sleep(interval_ms);
+    }
+
+    const uint32_t count = load_caches(g_after);
+    const uint32_t elapsed = interval_ms > 0 ? uptime_ms() - t0 : 0u;
+
+    if (count == 0u) {
+        printf("slabinfo: cannot read /dev/slabinfo\n");
+        return 1;
+    }
+
+    printf("%-16s %7s %9s %9s %7s %5s %6s %9s %9s\n",
+           "cache", "objsize", "active", "total", "slabs", "pages", "frag%", "allocs/s", "frees/s");
+
+    uint64_t slab_bytes_sum = 0;
+    uint64_t live_bytes_sum = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const yos_slabinfo_t* c = &g_after[i];
+
+        if (c->slabs == 0u && !all) {
+            continue;
+        }
+
+        char name[sizeof(c->name) + 1u];
+        memcpy(name, c->name, sizeof(c->name));
+        name[sizeof(c->name)] = '\0';
+
+        const uint64_t slab_bytes = (uint64_t)c->slabs * c->pages_per_slab * 4096u;
+        const uint64_t live_bytes = (uint64_t)c->active_objects * c->object_size;
+
+        slab_bytes_sum += slab_bytes;
+        live_bytes_sum += live_bytes;
+
+        const uint32_t frag = slab_bytes != 0u
+            ? (uint32_t)(((slab_bytes - live_bytes) * 100u) / slab_bytes)
+            : 0u;
+
+        printf("%-16s %7u %9u %9u %7u %5u %5u%% ",
+               name, c->object_size, c->active_objects,
+               c->slabs * c->objects_per_slab, c->slabs, c->pages_per_slab, frag);
+
+        const yos_slabinfo_t* b = interval_ms > 0 ? find_before(c, before) : 0;
+
+        if (b) {
+            printf("%9u %9u", per_second(c->allocs - b->allocs, elapsed), per_second(c->frees - b->frees, elapsed));
+        } else {
+            printf("%9s %9s", "-", "-");
+        }
+
+        printf("%s\n", (c->flags & YOS_SLABINFO_DIRECT) != 0u ? "  direct" : "");
+    }
+
+    printf("slabinfo: %u caches, %u KiB in slabs, %u KiB live\n",
+           count, (uint32_t)(slab_bytes_sum / 1024u), (uint32_t)(live_bytes_sum / 1024u));
+
+    return 0;
+}
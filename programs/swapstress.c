@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+
+/*
+ * Oversubscribe physical memory and verify every byte comes back.
+ *
+ * The parent sizes the run from the kernel's memory stats (2x RAM by
+ * default) and spreads it over worker processes, since a single address
+ * space cannot hold that much heap. Each worker fills its pages with a
+ * compressible but page-unique pattern, then sweeps over them several times
+ * verifying the contents, which forces swapped-out pages back in.
+ */
+
+#define PAGE_SIZE_BYTES   4096u
+#define WORKER_MAX_MIB    384u
+#define VERIFY_PASSES     3u
+
+static uint32_t pattern_word(uint32_t seed, uint32_t page, uint32_t word) {
+    return (seed ^ (page * 2654435761u)) + (word & 7u) * 0x01010101u;
+}
+
+static int worker_main(uint32_t mib, uint32_t seed) {
+    const uint32_t pages = (mib * 1024u * 1024u) / PAGE_SIZE_BYTES;
+
+    uint8_t* base = (uint8_t*)sbrk((int)(pages * PAGE_SIZE_BYTES));
+    if (base == (uint8_t*)-1 || !base) {
+        printf("swapstress[%u]: sbrk of %u MiB failed\n", seed, mib);
+        return 2;
+    }
+
+    for (uint32_t p = 0; p < pages; p++) {
+        uint32_t* w = (uint32_t*)(base + p * PAGE_SIZE_BYTES);
+
+        for (uint32_t i = 0; i < PAGE_SIZE_BYTES / 4u; i++) {
+            w[i] = pattern_word(seed, p, i);
+        }
+    }
+
+    for (uint32_t pass = 0; pass < VERIFY_PASSES; pass++) {
+        /* Alternate direction so LRU order never lines up with the sweep. */
+        for (uint32_t n = 0; n < pages; n++) {
+            const uint32_t p = (pass & 1u) ? (pages - 1u - n) : n;
+            const uint32_t* w = (const uint32_t*)(base + p * PAGE_SIZE_BYTES);
+
+            for (uint32_t i = 0; i < PAGE_SIZE_BYTES / 4u; i++) {
+                if (w[i] != pattern_word(seed, p, i)) {
+                    printf(
+                        "swapstress[%u]: corruption at %p (page %u word %u): %x != %x\n",
+                        seed, (void*)&w[i], p, i, w[i], pattern_word(seed, p, i)
+                    );
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "--worker") == 0) {
+        return worker_main((uint32_t)atoi(argv[2]), (uint32_t)atoi(argv[3]));
+    }
+
+    uint32_t used_kib = 0;
+    uint32_t free_kib = 0;
+
+    if (get_mem_stats(&used_kib, &free_kib) != 0) {
+        printf("swapstress: cannot read memory stats\n");
+        return 1;
+    }
+
+    const uint32_t ram_mib = (used_kib + free_kib) / 1024u;
+
+    uint32_t factor = 2u;
+    if (argc >= 2) {
+        factor = (uint32_t)atoi(argv[1]);
+    }
+
+    if (factor == 0u) {
+        factor = 1u;
+    }
+
+    uint32_t total_mib = ram_mib * factor;
+
+    printf("swapstress: RAM %u MiB, touching %u MiB\n", ram_mib, total_mib);
+
+    int pids[64];
+    uint32_t workers = 0;
+
+    uint32_t start = uptime_ms();
+
+    while (total_mib > 0u && workers < 64u) {
+        uint32_t mib = (total_mib > WORKER_MAX_MIB) ? WORKER_MAX_MIB : total_mib;
+
+        char mib_arg[16];
+        char seed_arg[16];
+
+        snprintf(mib_arg, sizeof(mib_arg), "%u", mib);
+        snprintf(seed_arg, sizeof(seed_arg), "%u", workers + 1u);
+
+        char* wargv[4] = { argv[0], "--worker", mib_arg, seed_arg };
+
+        int pid = spawn_process_resolved("swapstress", 4, wargv);
+        if (pid < 0) {
+            printf("swapstress: spawn failed\n");
+            break;
+        }
+
+        pids[workers++] = pid;
+        total_mib -= mib;
+    }
+
+    int failed = 0;
+
+    for (uint32_t i = 0; i < workers; i++) {
+        int st = 0;
+
+        (void)waitpid(pids[i], &st);
+
+        if (st != 0) {
+            failed++;
+        }
+    }
+
+    uint32_t elapsed = uptime_ms() - start;
+
+    printf(
+        "swapstress: %s (%u workers, %d failed, %u.%03u s)\n",
+        failed ? "FAIL" : "PASS", workers, failed,
+        elapsed / 1000u, elapsed % 1000u
+    );
+
+    return failed ? 1 : 0;
+}
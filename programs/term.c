@@ -1388,7 +1388,7 @@ static int term_run(void) {
             }
         }
 
-        const int comp_fd = conn.fd_s2c_r;
+        const int comp_fd = comp_conn_poll_fd(&conn);
         pollfd_t pfds[2];
         uint32_t nfds = 0;
 
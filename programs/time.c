@@ -8,12 +8,25 @@ static int spawn_by_name(const char* name, int argc, char** argv) {
     return spawn_process_resolved(name, argc, argv);
 }
 
+static uint32_t to_ms(uint32_t sec, uint32_t usec) {
+    return sec * 1000u + usec / 1000u;
+}
+
+static void print_secs(const char* label, uint32_t ms) {
+    printf("%s %u.%03u s\n", label, ms / 1000u, ms % 1000u);
+}
+
 int main(int argc, char** argv) {
     if (argc < 2) {
         printf("Usage: time <command> [args...]\n");
         return 1;
     }
 
+    /* Children totals only grow at waitpid, so the difference is this command alone. */
+    yos_rusage_t before;
+    memset(&before, 0, sizeof(before));
+    (void)getrusage(RUSAGE_CHILDREN, &before);
+
     uint32_t start = uptime_ms();
 
     int pid = spawn_by_name(argv[1], argc - 1, &argv[1]);
@@ -26,11 +39,21 @@ int main(int argc, char** argv) {
     (void)waitpid(pid, &st);
 
     uint32_t end = uptime_ms();
-    uint32_t diff = end - start;
 
-    uint32_t sec = diff / 1000u;
-    uint32_t ms = diff % 1000u;
+    print_secs("real", end - start);
+
+    yos_rusage_t after;
+    if (getrusage(RUSAGE_CHILDREN, &after) != 0) {
+        return 0;
+    }
+
+    print_secs("user", to_ms(after.utime_sec, after.utime_usec) - to_ms(before.utime_sec, before.utime_usec));
+    print_secs("sys ", to_ms(after.stime_sec, after.stime_usec) - to_ms(before.stime_sec, before.stime_usec));
 
-    printf("real %u.%03u s\n", sec, ms);
+    printf("faults   %u minor, %u major\n", after.minflt - before.minflt, after.majflt - before.majflt);
+    printf("switches %u voluntary, %u involuntary\n", after.nvcsw - before.nvcsw, after.nivcsw - before.nivcsw);
+    printf("io       %u KiB read, %u KiB written\n",
+           (uint32_t)((after.read_bytes - before.read_bytes) >> 10),
+           (uint32_t)((after.write_bytes - before.write_bytes) >> 10));
     return 0;
 }
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+
+#include <yos/tlbstat.h>
+
+/*
+ * munmap-heavy TLB shootdown benchmark.
+ *
+ * Helper threads share the address space with the main thread, which maps,
+ * touches and unmaps small /dev/zero regions in a loop. Every unmap has to
+ * invalidate the helpers' TLBs, so the IPI count per munmap shows how
+ * shootdowns scale. Two phases are run:
+ *
+ *   busy  helpers spin in user mode, so their CPUs must be interrupted
+ *   idle  helpers sleep, so their CPUs fall back to idle and go lazy
+ *
+ * Usage: tlbbench [iterations] [helpers] [pages]
+ */
+
+#define PAGE_SIZE_BYTES 4096u
+#define MAX_HELPERS     31u
+
+static volatile uint32_t g_mode;    /* 0 = spin, 1 = sleep, 2 = exit */
+
+static void* helper_main(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        const uint32_t mode = __atomic_load_n(&g_mode, __ATOMIC_ACQUIRE);
+
+        if (mode == 2u) {
+            break;
+        }
+
+        if (mode == 1u) {
+            sleep(5);
+        } else {
+            __asm__ volatile("pause");
+        }
+    }
+
+    return 0;
+}
+
+static int read_stats(yos_tlb_stats_t* out) {
+    int fd = open("/dev/tlbstat", 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int n = read(fd, out, sizeof(*out));
+
+    close(fd);
+
+    return n == (int)sizeof(*out) ? 0 : -1;
+}
+
+static int run_phase(const char* name, int zero_fd, uint32_t iters, uint32_t pages) {
+    yos_tlb_stats_t before;
+    yos_tlb_stats_t after;
+
+    if (read_stats(&before) != 0) {
+        printf("tlbbench: cannot read /dev/tlbstat\n");
+        return -1;
+    }
+
+    const uint32_t bytes = pages * PAGE_SIZE_BYTES;
+    const uint32_t start = uptime_ms();
+
+    for (uint32_t i = 0; i < iters; i++) {
+        uint8_t* p = (uint8_t*)mmap(zero_fd, bytes, MAP_PRIVATE | MAP_POPULATE);
+        if (!p || p == (uint8_t*)-1) {
+            printf("tlbbench: mmap failed at iteration %u\n", i);
+            return -1;
+        }
+
+        for (uint32_t off = 0; off < bytes; off += PAGE_SIZE_BYTES) {
+            p[off] = (uint8_t)i;
+        }
+
+        if (munmap(p, bytes) != 0) {
+            printf("tlbbench: munmap failed at iteration %u\n", i);
+            return -1;
+        }
+    }
+
+    const uint32_t elapsed = uptime_ms() - start;
+
+    if (read_stats(&after) != 0) {
+        return -1;
+    }
+
+    const uint32_t ipis = after.ipis - before.ipis;
+    const uint32_t shootdowns = after.shootdowns - before.shootdowns;
+    const uint32_t lazy = after.lazy_skips - before.lazy_skips;
+    const uint32_t local = after.local_only - before.local_only;
+
+    printf(
+        "%-5s %6u ops %6u ms | ipis %7u (%u.%02u/op) shootdowns %6u lazy-skips %6u local-only %6u\n",
+        name, iters, elapsed,
+        ipis, ipis / iters, (ipis % iters) * 100u / iters,
+        shootdowns, lazy, local
+    );
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t iters = 2000u;
+    uint32_t helpers = 3u;
+    uint32_t pages = 16u;
+
+    if (argc >= 2) iters = (uint32_t)atoi(argv[1]);
+    if (argc >= 3) helpers = (uint32_t)atoi(argv[2]);
+    if (argc >= 4) pages = (uint32_t)atoi(argv[3]);
+
+    if (iters == 0u) iters = 1u;
+    if (pages == 0u) pages = 1u;
+    if (helpers > MAX_HELPERS) helpers = MAX_HELPERS;
+
+    int zero_fd = open("/dev/zero", 0);
+    if (zero_fd < 0) {
+        printf("tlbbench: cannot open /dev/zero\n");
+        return 1;
+    }
+
+    pthread_t threads[MAX_HELPERS];
+    uint32_t started = 0;
+
+    for (uint32_t i = 0; i < helpers; i++) {
+        if (pthread_create(&threads[i], 0, helper_main, 0) != 0) {
+            printf("tlbbench: pthread_create failed\n");
+            break;
+        }
+
+        started++;
+    }
+
+    printf("tlbbench: %u helpers, %u pages per mapping\n", started, pages);
+
+    int rc = 0;
+
+    /* Give the helpers a moment to get scheduled on the other CPUs. */
+    sleep(50);
+
+    if (run_phase("busy", zero_fd, iters, pages) != 0) {
+        rc = 1;
+    }
+
+    __atomic_store_n(&g_mode, 1u, __ATOMIC_RELEASE);
+    sleep(50);
+
+    if (rc == 0 && run_phase("idle", zero_fd, iters, pages) != 0) {
+        rc = 1;
+    }
+
+    __atomic_store_n(&g_mode, 2u, __ATOMIC_RELEASE);
+
+    for (uint32_t i = 0; i < started; i++) {
+        (void)pthread_join(threads[i], 0);
+    }
+
+    close(zero_fd);
+
+    return rc;
+}
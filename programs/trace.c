@@ -0,0 +1,322 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+#include <yos/trace.h>
+
+/*
+ * Kernel event tracer for /dev/trace.
+ *
+ * Enables the requested tracepoints, streams and decodes events until the
+ * command exits (or for a fixed time), then turns tracing off again.
+ * Timestamps are microseconds since the first event printed. Events come out
+ * in order per CPU; lines from different CPUs can interleave slightly out of
+ * order. Events logged by the tracer itself are not printed.
+ *
+ * Usage: trace [-l] [-e event,...] [-p pid] [-d ms] [command args...]
+ *   -l  list event names
+ *   -e  events to enable (default: all)
+ *   -p  only print events logged while `pid` was running
+ *   -d  duration when no command is given (default 3000 ms)
+ */
+
+#define TRACE_READ_BATCH 64u
+#define TRACE_POLL_MS    10u
+
+static const char* const g_event_names[YOS_TRACE_EVENT_COUNT] = {
+    [YOS_TRACE_SCHED_SWITCH]  = "sched_switch",
+    [YOS_TRACE_SCHED_WAKEUP]  = "sched_wakeup",
+    [YOS_TRACE_SYSCALL_ENTER] = "sys_enter",
+    [YOS_TRACE_SYSCALL_EXIT]  = "sys_exit",
+    [YOS_TRACE_PAGE_FAULT]    = "page_fault",
+    [YOS_TRACE_IRQ_ENTER]     = "irq_enter",
+    [YOS_TRACE_IRQ_EXIT]      = "irq_exit",
+    [YOS_TRACE_BCACHE_MISS]   = "bcache_miss",
+    [YOS_TRACE_BCACHE_FLUSH]  = "bcache_flush",
+    [YOS_TRACE_AHCI_SUBMIT]   = "ahci_submit",
+    [YOS_TRACE_AHCI_COMPLETE] = "ahci_complete",
+    [YOS_TRACE_FUTEX_WAIT]    = "futex_wait",
+    [YOS_TRACE_FUTEX_WAKE]    = "futex_wake",
+    [YOS_TRACE_FUTEX_REQUEUE] = "futex_requeue",
+};
+
+static int g_trace_fd = -1;
+
+static uint32_t g_tsc_khz;
+static uint64_t g_first_tsc;
+static int g_have_first;
+
+static int g_filter_pid = -1;
+
+/* Our own reads and prints would otherwise feed the stream forever. */
+static uint32_t g_self_pid;
+
+static uint32_t g_printed;
+
+static volatile uint32_t g_child_done;
+
+static int parse_events(const char* list, uint32_t* out_mask) {
+    if (strcmp(list, "all") == 0) {
+        *out_mask = YOS_TRACE_ALL;
+        return 0;
+    }
+
+    uint32_t mask = 0;
+    char name[32];
+
+    const char* p = list;
+
+    while (*p) {
+        uint32_t n = 0;
+
+        while (*p && *p != ',') {
+            if (n + 1u < sizeof(name)) {
+                name[n++] = *p;
+            }
+            p++;
+        }
+
+        name[n] = '\0';
+
+        if (*p == ',') {
+            p++;
+        }
+
+        if (n == 0u) {
+            continue;
+        }
+
+        int found = 0;
+
+        for (uint32_t i = 0; i < YOS_TRACE_EVENT_COUNT; i++) {
+            if (strcmp(name, g_event_names[i]) == 0) {
+                mask |= YOS_TRACE_BIT(i);
+                found = 1;
+                break;
+            }
+        }
+
+        if (!found) {
+            printf("trace: unknown event '%s' (see trace -l)\n", name);
+            return -1;
+        }
+    }
+
+    *out_mask = mask;
+    return 0;
+}
+
+static void print_event(const yos_trace_event_t* e) {
+    if (e->pid == g_self_pid) {
+        return;
+    }
+
+    if (g_filter_pid >= 0 && e->pid != (uint32_t)g_filter_pid) {
+        return;
+    }
+
+    if (!g_have_first) {
+        g_first_tsc = e->tsc;
+        g_have_first = 1;
+    }
+
+    uint64_t us = 0;
+
+    if (g_tsc_khz != 0u && e->tsc >= g_first_tsc) {
+        us = ((e->tsc - g_first_tsc) * 1000ull) / g_tsc_khz;
+    }
+
+    const uint32_t sec = (uint32_t)(us / 1000000ull);
+    const uint32_t frac = (uint32_t)(us % 1000000ull);
+
+    const char* name = e->type < YOS_TRACE_EVENT_COUNT ? g_event_names[e->type] : "?";
+
+    printf("%5u.%06u cpu%u pid %-4u %-13s ", sec, frac, (uint32_t)e->cpu, e->pid, name);
+
+    uint32_t a[4];
+    memcpy(a, (const void*)e->args, sizeof(a));
+
+    switch (e->type) {
+        case YOS_TRACE_SCHED_SWITCH:
+            printf("prev=%u next=%u prev_state=%u\n", a[0], a[1], a[2]);
+            break;
+        case YOS_TRACE_SCHED_WAKEUP:
+            printf("pid=%u cpu=%u\n", a[0], a[1]);
+            break;
+        case YOS_TRACE_SYSCALL_ENTER:
+            printf("nr=%u args=0x%x 0x%x 0x%x\n", a[0], a[1], a[2], a[3]);
+            break;
+        case YOS_TRACE_SYSCALL_EXIT:
+            printf("nr=%u ret=%d\n", a[0], (int)a[1]);
+            break;
+        case YOS_TRACE_PAGE_FAULT:
+            printf("addr=0x%x err=0x%x eip=0x%x\n", a[0], a[1], a[2]);
+            break;
+        case YOS_TRACE_IRQ_ENTER:
+        case YOS_TRACE_IRQ_EXIT:
+            printf("vector=%u\n", a[0]);
+            break;
+        case YOS_TRACE_BCACHE_MISS:
+        case YOS_TRACE_BCACHE_FLUSH:
+            printf("block=%u\n", a[0]);
+            break;
+        case YOS_TRACE_AHCI_SUBMIT:
+            printf("port=%u slot=%u lba=%u sectors=%u %s\n",
+                   a[0], a[1], a[2], a[3] & 0x7FFFFFFFu, (a[3] >> 31) ? "write" : "read");
+            break;
+        case YOS_TRACE_AHCI_COMPLETE:
+            printf("port=%u slot=%u %s\n", a[0], a[1], a[2] ? "ok" : "error");
+            break;
+        case YOS_TRACE_FUTEX_WAIT:
+            printf("key=0x%x val=%u\n", a[0], a[1]);
+            break;
+        case YOS_TRACE_FUTEX_WAKE:
+            printf("key=0x%x max=%u woken=%d\n", a[0], a[1], (int)a[2]);
+            break;
+        case YOS_TRACE_FUTEX_REQUEUE:
+            printf("key=0x%x to=0x%x woken=%u requeued=%u\n", a[0], a[1], a[2], a[3]);
+            break;
+        default:
+            printf("0x%x 0x%x 0x%x 0x%x\n", a[0], a[1], a[2], a[3]);
+            break;
+    }
+
+    g_printed++;
+}
+
+static void drain(void) {
+    yos_trace_event_t batch[TRACE_READ_BATCH];
+
+    for (;;) {
+        int r = read(g_trace_fd, batch, sizeof(batch));
+        if (r <= 0) {
+            return;
+        }
+
+        const uint32_t n = (uint32_t)r / (uint32_t)sizeof(yos_trace_event_t);
+
+        for (uint32_t i = 0; i < n; i++) {
+            print_event(&batch[i]);
+        }
+    }
+}
+
+static void* wait_child(void* arg) {
+    int st = 0;
+    (void)waitpid((int)(uintptr_t)arg, &st);
+
+    __atomic_store_n(&g_child_done, 1u, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void usage(void) {
+    printf("Usage: trace [-l] [-e event,...] [-p pid] [-d ms] [command args...]\n");
+}
+
+int main(int argc, char** argv) {
+    uint32_t mask = YOS_TRACE_ALL;
+    uint32_t duration_ms = 3000u;
+
+    int i = 1;
+
+    while (i < argc && argv[i][0] == '-') {
+        const char* opt = argv[i];
+
+        if (strcmp(opt, "-l") == 0) {
+            for (uint32_t k = 0; k < YOS_TRACE_EVENT_COUNT; k++) {
+                printf("%s\n", g_event_names[k]);
+            }
+            return 0;
+        }
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        if (strcmp(opt, "-e") == 0) {
+            if (parse_events(argv[i + 1], &mask) != 0) {
+                return 1;
+            }
+        } else if (strcmp(opt, "-p") == 0) {
+            g_filter_pid = atoi(argv[i + 1]);
+        } else if (strcmp(opt, "-d") == 0) {
+            duration_ms = (uint32_t)atoi(argv[i + 1]);
+        } else {
+            usage();
+            return 1;
+        }
+
+        i += 2;
+    }
+
+    if (mask == 0u) {
+        printf("trace: no events selected\n");
+        return 1;
+    }
+
+    g_trace_fd = open("/dev/trace", 0);
+    if (g_trace_fd < 0) {
+        printf("trace: cannot open /dev/trace\n");
+        return 1;
+    }
+
+    g_self_pid = (uint32_t)getpid();
+
+    yos_trace_stats_t st;
+    memset(&st, 0, sizeof(st));
+
+    (void)ioctl(g_trace_fd, YOS_TRACE_RESET, 0);
+
+    if (ioctl(g_trace_fd, YOS_TRACE_SET_MASK, &mask) != 0) {
+        printf("trace: cannot enable tracing\n");
+        close(g_trace_fd);
+        return 1;
+    }
+
+    (void)ioctl(g_trace_fd, YOS_TRACE_STATS, &st);
+    g_tsc_khz = st.tsc_khz;
+
+    const uint32_t start = uptime_ms();
+
+    if (i < argc) {
+        int pid = spawn_process_resolved(argv[i], argc - i, &argv[i]);
+        if (pid < 0) {
+            uint32_t off = 0;
+            (void)ioctl(g_trace_fd, YOS_TRACE_SET_MASK, &off);
+            printf("trace: spawn failed\n");
+            close(g_trace_fd);
+            return 1;
+        }
+
+        pthread_t waiter;
+        if (pthread_create(&waiter, 0, wait_child, (void*)(uintptr_t)pid) != 0) {
+            int status = 0;
+            (void)waitpid(pid, &status);
+        } else {
+            while (!__atomic_load_n(&g_child_done, __ATOMIC_ACQUIRE)) {
+                drain();
+                sleep((int)TRACE_POLL_MS);
+            }
+
+            (void)pthread_join(waiter, 0);
+        }
+    } else {
+        while (uptime_ms() - start < duration_ms) {
+            drain();
+            sleep((int)TRACE_POLL_MS);
+        }
+    }
+
+    uint32_t off = 0;
+    (void)ioctl(g_trace_fd, YOS_TRACE_SET_MASK, &off);
+
+    drain();
+
+    (void)ioctl(g_trace_fd, YOS_TRACE_STATS, &st);
+
+    printf("trace: %u events logged, %u printed, %u overwritten\n", st.events, g_printed, st.overwritten);
+
+    close(g_trace_fd);
+    return 0;
+}
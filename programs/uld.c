@@ -27,6 +27,10 @@ typedef uint32_t Elf32_Word;
 #define EM_386  3
 #define R_386_32   1
 #define R_386_PC32 2
+#define R_386_TLS_LE    17
+#define R_386_TLS_LE_32 37
+#define PT_LOAD 1
+#define PT_TLS  7
 #define ELF32_R_SYM(i)    ((i)>>8)
 #define ELF32_R_TYPE(i)   ((unsigned char)(i))
 
@@ -85,6 +89,9 @@ typedef struct {
     Elf32_Word    r_info;
 } __attribute__((packed)) Elf32_Rel;
 
+/* Room for PT_LOAD and PT_TLS is always reserved, so the layout does not depend on TLS use. */
+#define HEADERS_SIZE (sizeof(Elf32_Ehdr) + 2u * sizeof(Elf32_Phdr))
+
 typedef struct {
     char name[64];
     uint8_t* raw_data;
@@ -98,6 +105,8 @@ typedef struct {
     int rodata_count;
     Elf32_Shdr* sh_data;
     Elf32_Shdr* sh_bss;
+    Elf32_Shdr* sh_tdata;
+    Elf32_Shdr* sh_tbss;
     Elf32_Shdr* sh_symtab;
     Elf32_Shdr* sh_strtab;
     Elf32_Shdr* sh_rel_text;
@@ -110,12 +119,15 @@ typedef struct {
     uint32_t rodata_out_offset[MAX_RODATA_SECTIONS];
     uint32_t data_out_offset;
     uint32_t bss_out_offset;
+    uint32_t tdata_out_offset;
+    uint32_t tbss_out_offset;
 } ObjectFile;
 
 typedef struct {
     char name[64];
     uint32_t value;
     int defined;
+    int tls;
 } GlobalSymbol;
 
 typedef struct {
@@ -129,6 +141,17 @@ typedef struct {
     uint32_t total_rodata_size;
     uint32_t total_data_size;
     uint32_t total_bss_size;
+    uint32_t total_tdata_size;
+
+    /*
+     * TLS offsets of .tdata and .tbss are relative to the start of the
+     * thread's block; tls_size is the block size rounded to tls_align,
+     * which is where the thread pointer sits, as GNU ld lays it out.
+     */
+    uint32_t tdata_image_size;
+    uint32_t tls_memsz;
+    uint32_t tls_align;
+    uint32_t tls_size;
     
     uint32_t entry_addr;
     
@@ -194,6 +217,8 @@ ObjectFile* load_object(const char* filename) {
         }
         else if (strcmp(name, ".data") == 0) obj->sh_data = sh;
         else if (strcmp(name, ".bss") == 0) obj->sh_bss = sh;
+        else if (strcmp(name, ".tdata") == 0) obj->sh_tdata = sh;
+        else if (strcmp(name, ".tbss") == 0) obj->sh_tbss = sh;
         else if (strcmp(name, ".symtab") == 0) obj->sh_symtab = sh;
         else if (strcmp(name, ".strtab") == 0) obj->sh_strtab = sh;
         else if (strcmp(name, ".rel.text") == 0) obj->sh_rel_text = sh;
@@ -251,6 +276,58 @@ void calculate_layout(LinkerCtx* ctx) {
         }
     }
     ctx->total_bss_size = (bss_off + (SECT_ALIGN-1)) & ~(SECT_ALIGN-1);
+
+    uint32_t tls_align = 32;
+    for (int i = 0; i < ctx->obj_count; i++) {
+        ObjectFile* obj = ctx->objects[i];
+        if (obj->sh_tdata && obj->sh_tdata->sh_addralign > tls_align) tls_align = obj->sh_tdata->sh_addralign;
+        if (obj->sh_tbss && obj->sh_tbss->sh_addralign > tls_align) tls_align = obj->sh_tbss->sh_addralign;
+    }
+
+    uint32_t tls_off = 0;
+    for (int i = 0; i < ctx->obj_count; i++) {
+        ObjectFile* obj = ctx->objects[i];
+        if (obj->sh_tdata) {
+            uint32_t a = obj->sh_tdata->sh_addralign ? obj->sh_tdata->sh_addralign : 1;
+            tls_off = (tls_off + (a-1)) & ~(a-1);
+            obj->tdata_out_offset = tls_off;
+            tls_off += obj->sh_tdata->sh_size;
+        }
+    }
+    ctx->tdata_image_size = tls_off;
+    ctx->total_tdata_size = (tls_off + (SECT_ALIGN-1)) & ~(SECT_ALIGN-1);
+
+    for (int i = 0; i < ctx->obj_count; i++) {
+        ObjectFile* obj = ctx->objects[i];
+        if (obj->sh_tbss) {
+            uint32_t a = obj->sh_tbss->sh_addralign ? obj->sh_tbss->sh_addralign : 1;
+            tls_off = (tls_off + (a-1)) & ~(a-1);
+            obj->tbss_out_offset = tls_off;
+            tls_off += obj->sh_tbss->sh_size;
+        }
+    }
+    ctx->tls_memsz = tls_off;
+    ctx->tls_align = tls_align;
+    ctx->tls_size = (tls_off + (tls_align-1)) & ~(tls_align-1);
+}
+
+/* Link-time address of a section, or its TLS offset for .tdata and .tbss. */
+uint32_t section_base(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sec, int* tls) {
+    uint32_t base_text = BASE_ADDR + HEADERS_SIZE;
+    uint32_t base_rodata = base_text + ctx->total_text_size;
+    uint32_t base_data = base_rodata + ctx->total_rodata_size;
+    uint32_t base_bss  = base_data + ctx->total_data_size + ctx->total_tdata_size;
+
+    *tls = 0;
+    if (sec == obj->sh_text) return base_text + obj->text_out_offset;
+    if (sec == obj->sh_data) return base_data + obj->data_out_offset;
+    if (sec == obj->sh_bss)  return base_bss  + obj->bss_out_offset;
+    if (sec == obj->sh_tdata) { *tls = 1; return obj->tdata_out_offset; }
+    if (sec == obj->sh_tbss)  { *tls = 1; return obj->tbss_out_offset; }
+    for (int r = 0; r < obj->rodata_count; r++) {
+        if (sec == obj->sh_rodata[r]) return base_rodata + obj->rodata_out_offset[r];
+    }
+    return 0;
 }
 
 GlobalSymbol* find_global(LinkerCtx* ctx, const char* name) {
@@ -260,12 +337,17 @@ GlobalSymbol* find_global(LinkerCtx* ctx, const char* name) {
     return 0;
 }
 
+void define_global(LinkerCtx* ctx, const char* name, uint32_t value) {
+    if (find_global(ctx, name)) return;
+    if (ctx->sym_count >= MAX_SYMBOLS) fatal("Too many symbols");
+
+    GlobalSymbol* gs = &ctx->symbols[ctx->sym_count++];
+    strcpy(gs->name, name);
+    gs->value = value;
+    gs->defined = 1;
+}
+
 void collect_symbols(LinkerCtx* ctx) {
-    uint32_t base_text = BASE_ADDR + sizeof(Elf32_Ehdr) + sizeof(Elf32_Phdr);
-    uint32_t base_rodata = base_text + ctx->total_text_size;
-    uint32_t base_data = base_rodata + ctx->total_rodata_size;
-    uint32_t base_bss  = base_data + ctx->total_data_size;
-    
     for (int i = 0; i < ctx->obj_count; i++) {
         ObjectFile* obj = ctx->objects[i];
         if (!obj->sh_symtab) continue;
@@ -282,30 +364,25 @@ void collect_symbols(LinkerCtx* ctx) {
                 
                 if (find_global(ctx, name)) continue;
                 
+                if (ctx->sym_count >= MAX_SYMBOLS) fatal("Too many symbols");
+
                 GlobalSymbol* gs = &ctx->symbols[ctx->sym_count++];
                 strcpy(gs->name, name);
                 gs->defined = 1;
                 
-                uint32_t section_base = 0;
                 Elf32_Shdr* sec = &obj->shdrs[s->st_shndx];
-                
-                if (sec == obj->sh_text) section_base = base_text + obj->text_out_offset;
-                else if (sec == obj->sh_data) section_base = base_data + obj->data_out_offset;
-                else if (sec == obj->sh_bss)  section_base = base_bss  + obj->bss_out_offset;
-                else {
-                    for (int r = 0; r < obj->rodata_count; r++) {
-                        if (sec == obj->sh_rodata[r]) {
-                            section_base = base_rodata + obj->rodata_out_offset[r];
-                            break;
-                        }
-                    }
-                }
-                
-                gs->value = section_base + s->st_value;
+                gs->value = section_base(ctx, obj, sec, &gs->tls) + s->st_value;
                 if (strcmp(name, "_start") == 0) ctx->entry_addr = gs->value;
             }
         }
     }
+
+    /* The TLS template the runtime copies into each thread's block (see usr/linker.ld). */
+    uint32_t base_tdata = BASE_ADDR + HEADERS_SIZE + ctx->total_text_size + ctx->total_rodata_size + ctx->total_data_size;
+    define_global(ctx, "__tls_image", base_tdata);
+    define_global(ctx, "__tls_image_size", ctx->tdata_image_size);
+    define_global(ctx, "__tls_size", ctx->tls_size);
+    define_global(ctx, "__tls_align", ctx->tls_align);
 }
 
 void apply_relocations(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sh_rel) {
@@ -314,12 +391,7 @@ void apply_relocations(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sh_rel) {
     
     if (sh_rel->sh_info >= (uint32_t)obj->ehdr->e_shnum) return;
 
-    uint32_t base_text = BASE_ADDR + sizeof(Elf32_Ehdr) + sizeof(Elf32_Phdr);
-    uint32_t base_rodata = base_text + ctx->total_text_size;
-    uint32_t base_data = base_rodata + ctx->total_rodata_size;
-    uint32_t base_bss  = base_data + ctx->total_data_size;
-
-    uint32_t headers_sz = sizeof(Elf32_Ehdr) + sizeof(Elf32_Phdr);
+    uint32_t headers_sz = HEADERS_SIZE;
 
     Elf32_Shdr* target = &obj->shdrs[sh_rel->sh_info];
 
@@ -327,18 +399,21 @@ void apply_relocations(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sh_rel) {
     uint8_t* buffer_ptr = 0;
 
     if (target == obj->sh_text) {
-        section_base_addr = base_text + obj->text_out_offset;
+        section_base_addr = BASE_ADDR + headers_sz + obj->text_out_offset;
         buffer_ptr = ctx->out_buffer + headers_sz + obj->text_out_offset;
     } else if (target == obj->sh_data) {
-        section_base_addr = base_data + obj->data_out_offset;
         buffer_ptr = ctx->out_buffer + headers_sz + ctx->total_text_size + ctx->total_rodata_size + obj->data_out_offset;
-    } else if (target == obj->sh_bss) {
+        section_base_addr = BASE_ADDR + (uint32_t)(buffer_ptr - ctx->out_buffer);
+    } else if (target == obj->sh_tdata) {
+        buffer_ptr = ctx->out_buffer + headers_sz + ctx->total_text_size + ctx->total_rodata_size + ctx->total_data_size + obj->tdata_out_offset;
+        section_base_addr = BASE_ADDR + (uint32_t)(buffer_ptr - ctx->out_buffer);
+    } else if (target == obj->sh_bss || target == obj->sh_tbss) {
         return;
     } else {
         for (int r = 0; r < obj->rodata_count; r++) {
             if (target == obj->sh_rodata[r]) {
-                section_base_addr = base_rodata + obj->rodata_out_offset[r];
                 buffer_ptr = ctx->out_buffer + headers_sz + ctx->total_text_size + obj->rodata_out_offset[r];
+                section_base_addr = BASE_ADDR + (uint32_t)(buffer_ptr - ctx->out_buffer);
                 break;
             }
         }
@@ -376,7 +451,7 @@ void apply_relocations(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sh_rel) {
         int sym_idx = ELF32_R_SYM(r->r_info);
 
         if (type == 0) continue;
-        if (type != R_386_32 && type != R_386_PC32) {
+        if (type != R_386_32 && type != R_386_PC32 && type != R_386_TLS_LE && type != R_386_TLS_LE_32) {
             fatal("Unsupported relocation type %d (r_info=0x%08x) in %s (%s)", type, r->r_info, obj->name, rel_name);
         }
         if (sym_idx < 0 || sym_idx >= sym_count) {
@@ -388,27 +463,22 @@ void apply_relocations(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sh_rel) {
         
         Elf32_Sym* s = &syms[sym_idx];
         uint32_t sym_val = 0;
+        int sym_tls = 0;
         
         if (s->st_shndx == SHN_UNDEF) {
             const char* name = get_str(obj, s->st_name);
             GlobalSymbol* gs = find_global(ctx, name);
             if (!gs) fatal("Undefined reference to '%s' in %s", name, obj->name);
             sym_val = gs->value;
+            sym_tls = gs->tls;
         } else {
             Elf32_Shdr* sec = &obj->shdrs[s->st_shndx];
-            uint32_t s_base = 0;
-            if (sec == obj->sh_text) s_base = base_text + obj->text_out_offset;
-            else if (sec == obj->sh_data) s_base = base_data + obj->data_out_offset;
-            else if (sec == obj->sh_bss)  s_base = base_bss  + obj->bss_out_offset;
-            else {
-                for (int r = 0; r < obj->rodata_count; r++) {
-                    if (sec == obj->sh_rodata[r]) {
-                        s_base = base_rodata + obj->rodata_out_offset[r];
-                        break;
-                    }
-                }
-            }
-            sym_val = s_base + s->st_value;
+            sym_val = section_base(ctx, obj, sec, &sym_tls) + s->st_value;
+        }
+
+        int want_tls = (type == R_386_TLS_LE || type == R_386_TLS_LE_32);
+        if (want_tls != sym_tls) {
+            fatal("Relocation type %d mixes TLS and non-TLS symbol '%s' in %s (%s)", type, get_str(obj, s->st_name), obj->name, rel_name);
         }
         
         uint32_t* patch_loc = (uint32_t*)(buffer_ptr + r->r_offset);
@@ -420,13 +490,17 @@ void apply_relocations(LinkerCtx* ctx, ObjectFile* obj, Elf32_Shdr* sh_rel) {
             *patch_loc = S + A;
         } else if (type == R_386_PC32) {
             *patch_loc = S + A - P;
+        } else if (type == R_386_TLS_LE) {
+            *patch_loc = S + A - ctx->tls_size;
+        } else if (type == R_386_TLS_LE_32) {
+            *patch_loc = ctx->tls_size - S - A;
         }
     }
 }
 
 void build_image(LinkerCtx* ctx, const char* outfile) {
-    uint32_t headers_sz = sizeof(Elf32_Ehdr) + sizeof(Elf32_Phdr);
-    uint32_t file_sz = headers_sz + ctx->total_text_size + ctx->total_rodata_size + ctx->total_data_size;
+    uint32_t headers_sz = HEADERS_SIZE;
+    uint32_t file_sz = headers_sz + ctx->total_text_size + ctx->total_rodata_size + ctx->total_data_size + ctx->total_tdata_size;
     
     char shstrtab[128];
     memset(shstrtab, 0, 128);
@@ -445,22 +519,34 @@ void build_image(LinkerCtx* ctx, const char* outfile) {
     eh->e_type = ET_EXEC; eh->e_machine = EM_386; eh->e_version = 1;
     eh->e_entry = ctx->entry_addr;
     eh->e_phoff = sizeof(Elf32_Ehdr); eh->e_ehsize = sizeof(Elf32_Ehdr);
-    eh->e_phentsize = sizeof(Elf32_Phdr); eh->e_phnum = 1;
+    eh->e_phentsize = sizeof(Elf32_Phdr); eh->e_phnum = ctx->tls_memsz ? 2 : 1;
     eh->e_shentsize = sizeof(Elf32_Shdr); eh->e_shnum = 5;
     eh->e_shstrndx = 4;
     eh->e_shoff = file_sz;
     
     Elf32_Phdr* ph = (Elf32_Phdr*)(ctx->out_buffer + sizeof(Elf32_Ehdr));
-    ph->p_type = 1; ph->p_offset = 0;
+    ph->p_type = PT_LOAD; ph->p_offset = 0;
     ph->p_vaddr = BASE_ADDR; ph->p_paddr = BASE_ADDR;
     ph->p_filesz = file_sz; 
     ph->p_memsz = file_sz + ctx->total_bss_size;
     ph->p_flags = 7;
     ph->p_align = PAGE_ALIGN;
+
+    if (ctx->tls_memsz) {
+        Elf32_Phdr* tph = ph + 1;
+        tph->p_type = PT_TLS;
+        tph->p_offset = headers_sz + ctx->total_text_size + ctx->total_rodata_size + ctx->total_data_size;
+        tph->p_vaddr = BASE_ADDR + tph->p_offset; tph->p_paddr = tph->p_vaddr;
+        tph->p_filesz = ctx->tdata_image_size;
+        tph->p_memsz = ctx->tls_memsz;
+        tph->p_flags = 4;
+        tph->p_align = ctx->tls_align;
+    }
     
     uint8_t* ptr_text = ctx->out_buffer + headers_sz;
     uint8_t* ptr_rodata = ptr_text + ctx->total_text_size;
     uint8_t* ptr_data = ptr_rodata + ctx->total_rodata_size;
+    uint8_t* ptr_tdata = ptr_data + ctx->total_data_size;
     
     for (int i = 0; i < ctx->obj_count; i++) {
         ObjectFile* obj = ctx->objects[i];
@@ -470,6 +556,7 @@ void build_image(LinkerCtx* ctx, const char* outfile) {
             memcpy(ptr_rodata + obj->rodata_out_offset[r], obj->raw_data + sh->sh_offset, sh->sh_size);
         }
         if (obj->sh_data) memcpy(ptr_data + obj->data_out_offset, obj->raw_data + obj->sh_data->sh_offset, obj->sh_data->sh_size);
+        if (obj->sh_tdata) memcpy(ptr_tdata + obj->tdata_out_offset, obj->raw_data + obj->sh_tdata->sh_offset, obj->sh_tdata->sh_size);
     }
     
     for (int i = 0; i < ctx->obj_count; i++) {
@@ -484,7 +571,7 @@ void build_image(LinkerCtx* ctx, const char* outfile) {
     sh[1].sh_addr = BASE_ADDR + headers_sz; sh[1].sh_offset = headers_sz; sh[1].sh_size = ctx->total_text_size;
     
     sh[2].sh_name = n_dat; sh[2].sh_type = 1; sh[2].sh_flags = 3;
-    sh[2].sh_addr = BASE_ADDR + headers_sz + ctx->total_text_size; sh[2].sh_offset = headers_sz + ctx->total_text_size; sh[2].sh_size = ctx->total_rodata_size + ctx->total_data_size;
+    sh[2].sh_addr = BASE_ADDR + headers_sz + ctx->total_text_size; sh[2].sh_offset = headers_sz + ctx->total_text_size; sh[2].sh_size = ctx->total_rodata_size + ctx->total_data_size + ctx->total_tdata_size;
     
     sh[3].sh_name = n_bss; sh[3].sh_type = 8; sh[3].sh_flags = 3;
     sh[3].sh_addr = sh[2].sh_addr + sh[2].sh_size; sh[3].sh_offset = sh[2].sh_offset + sh[2].sh_size; sh[3].sh_size = ctx->total_bss_size;
@@ -22,6 +22,11 @@
 #define GDT_CPU_DATA_BASE (5 + MAX_CPUS) 
 #define GDT_USER_TLS_BASE (5 + MAX_CPUS * 2)
 
+/* The interrupt entry stubs find a CPU's data segment from its TSS selector. */
+#if MAX_CPUS != 32
+#error "update MAX_CPUS in interrupts.asm"
+#endif
+
 /*
  * i386 TSS.
  *
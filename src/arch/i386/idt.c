@@ -2,7 +2,11 @@
 /* Copyright (C) 2025 Yula1234 */
 
 #include <lib/string.h>
+
+#include <mm/shrinker.h>
+#include <mm/zswap.h>
 #include <mm/pmm.h>
+#include <mm/shm.h>
 
 #include <drivers/input/mouse.h>
 #include <drivers/input/keyboard.h>
@@ -12,10 +16,14 @@
 #include <kernel/sched.h>
 #include <kernel/proc.h>
 #include <kernel/smp/cpu.h>
+#include <kernel/ipc/eventfd.h>
 #include <kernel/panic.h>
 #include <kernel/rcu.h>
 
 #include <kernel/output/kprintf.h>
+#include <kernel/output/kmsg.h>
+#include <kernel/sampler.h>
+#include <kernel/trace.h>
 
 #include <lib/compiler.h>
 
@@ -159,6 +167,9 @@ __attribute__((noreturn)) void double_fault_report(
         kprintf("task (none)\n");
     }
 
+    /* The flusher thread will not run again; push the report out now. */
+    kmsg_flush_emergency();
+
     for (;;) {
         __asm__ volatile("hlt");
     }
@@ -240,45 +251,112 @@ typedef struct {
     uint32_t file_offset;
     uint32_t file_size;
     uint32_t map_flags;
+    uint32_t fault_pages;
     vfs_node_t* file;
+    vma_region_t* region;
 } mmap_pf_info_t;
 
-static int mmap_pf_lookup(task_t* t, uint32_t vaddr, mmap_pf_info_t* out) {
+/*
+ * Snapshot the region covering `vaddr` and hold its fault lock until
+ * mmap_pf_unlock(), so munmap cannot unmap the range underneath us. The
+ * region's file reference stays valid for as long. Real faults also size the
+ * fault-around window; prefaulting (`populate`) leaves that state alone.
+ */
+static int mmap_pf_lookup(task_t* t, uint32_t vaddr, mmap_pf_info_t* out, int populate) {
     if (!t
         || !t->mem
         || !out) {
         return 0;
     }
 
-    proc_mem_t* mem = t->mem;
+    vma_snapshot_t snap;
 
-    rcu_read_lock();
+    vma_region_t* m = vma_lock_fault(t, t->mem, vaddr, &snap);
+    if (!m) {
+        return 0;
+    }
 
-    mmap_area_t* m = vma_find(t, mem, vaddr);
-    
-    if (m) {
-        out->vaddr_start = m->vaddr_start;
-        out->vaddr_end = m->vaddr_end;
+    out->vaddr_start = snap.vaddr_start;
+    out->vaddr_end = snap.vaddr_end;
 
-        out->file_offset = m->file_offset;
-        out->file_size = m->file_size;
-        
-        out->map_flags = m->map_flags;
-        
-        out->file = m->file;
+    out->file_offset = snap.file_offset;
+    out->file_size = snap.file_size;
 
-        if (out->file) {
-            vfs_node_retain(out->file);
-        }
-        
-        rcu_read_unlock();
+    out->map_flags = snap.map_flags;
 
-        return 1;
+    out->fault_pages = populate ? 0u : vma_fault_around(m, vaddr);
+
+    out->file = snap.file;
+    out->region = m;
+
+    return 1;
+}
+
+static void mmap_pf_unlock(mmap_pf_info_t* info) {
+    vma_unlock_fault(info->region);
+}
+
+static phys_addr_t try_alloc_user_page(int lowmem) {
+    if (lowmem) return (phys_addr_t)(uintptr_t)pmm_alloc_block();
+
+    return pmm_alloc_page_user();
+}
+
+/*
+ * Allocate a frame for a user fault. Anonymous pages may come from HIGHMEM;
+ * pass `lowmem` when the kernel has to write the page through a pointer.
+ * On failure, reclaim synchronously once before giving up: the background
+ * shrinker only wakes up once a second.
+ */
+static phys_addr_t alloc_user_fault_page(int lowmem) {
+    phys_addr_t page = try_alloc_user_page(lowmem);
+    if (page) return page;
+
+    shrinker_reclaim_direct(32u);
+
+    return try_alloc_user_page(lowmem);
+}
+
+/*
+ * Back a whole large page with zeroed memory. Returns 0 if no block is free
+ * or a page table already covers the window; losing the race to another
+ * thread mapping the same large page counts as success. With `reclaim`, a
+ * failed allocation runs the shrinkers once and tries again before the
+ * caller falls back to small pages.
+ */
+static int map_user_huge_page(proc_mem_t* mem, uint32_t vaddr_huge, uint32_t flags, int reclaim) {
+    void* huge_page = pmm_alloc_pages(PAGING_HUGE_ORDER);
+
+    if (!huge_page && reclaim) {
+        shrinker_reclaim_direct(PAGING_HUGE_PAGES);
+
+        huge_page = pmm_alloc_pages(PAGING_HUGE_ORDER);
+    }
+
+    if (!huge_page) return 0;
+
+    for (uint32_t i = 0; i < PAGING_HUGE_PAGES; i++) {
+        paging_zero_phys_page((uint32_t)huge_page + i * 4096u);
+    }
+
+    if (!paging_map_huge_new(mem->page_dir, vaddr_huge, (uint32_t)huge_page, flags)) {
+        pmm_free_pages(huge_page, PAGING_HUGE_ORDER);
+
+        return (paging_peek_pde(mem->page_dir, vaddr_huge) & PTE_SUPER) != 0u;
+    }
+
+    __atomic_fetch_add(&mem->mem_pages, PAGING_HUGE_PAGES, __ATOMIC_RELAXED);
+
+    return 1;
+}
+
+/* Map a fresh page at a faulting address unless another thread beat us to it. */
+static void map_user_fault_page(proc_mem_t* mem, uint32_t vaddr, phys_addr_t page, uint32_t flags) {
+    if (paging_map_new(mem->page_dir, vaddr, page, flags)) {
+        __atomic_fetch_add(&mem->mem_pages, 1u, __ATOMIC_RELAXED);
+    } else {
+        pmm_free_phys(page);
     }
-    
-    rcu_read_unlock();
-    
-    return 0;
 }
 
 static int ensure_user_stack_writable(task_t* curr, uint32_t addr) {
@@ -286,13 +364,21 @@ static int ensure_user_stack_writable(task_t* curr, uint32_t addr) {
     if (addr < curr->stack_bottom || addr >= curr->stack_top) return 0;
 
     uint32_t vaddr = addr & ~0xFFFu;
+
+    for (;;) {
+        pte_t pte = paging_peek_pte(curr->mem->page_dir, vaddr);
+        if (!pte_is_swap(pte)) break;
+
+        if (zswap_fault_in(curr->mem, vaddr) < 0) return 0;
+        if (pte_swap_index(pte) == 0u) sched_yield();
+    }
+
     if (paging_is_user_accessible(curr->mem->page_dir, vaddr)) return 1;
 
-    void* new_page = pmm_alloc_block();
+    phys_addr_t new_page = alloc_user_fault_page(0);
     if (!new_page) return 0;
 
-    paging_map_ex(curr->mem->page_dir, vaddr, (uint32_t)new_page, 7, PAGING_MAP_NO_TLB_FLUSH);
-    curr->mem->mem_pages++;
+    map_user_fault_page(curr->mem, vaddr, new_page, 7);
     return 1;
 }
 
@@ -394,15 +480,25 @@ static void maybe_deliver_pending_signal(task_t* curr, registers_t* regs) {
     }
 }
 
-static int handle_mmap_demand_fault(task_t* curr, uint32_t cr2) {
+/*
+ * Resolve a fault in an mmap region. `populate_end` is non-zero when
+ * prefaulting: the batch then extends towards it instead of following the
+ * region's fault-around window.
+ */
+static int handle_mmap_demand_fault(task_t* curr, uint32_t cr2, uint32_t populate_end) {
     if (!curr || !curr->mem || !curr->mem->page_dir) return 0;
 
     uint32_t vaddr = cr2 & ~0xFFFu;
     mmap_pf_info_t info;
-    if (!mmap_pf_lookup(curr, vaddr, &info)) {
+    if (!mmap_pf_lookup(curr, vaddr, &info, populate_end != 0u)) {
         return 0;
     }
 
+    if (info.map_flags & VMA_MAP_GUARD) {
+        mmap_pf_unlock(&info);
+        return -1;
+    }
+
     uint32_t rel = vaddr - info.vaddr_start;
 
     if ((info.map_flags & MAP_SHARED)
@@ -411,113 +507,123 @@ static int handle_mmap_demand_fault(task_t* curr, uint32_t cr2) {
         && info.file->ops->get_phys_page) {
 
         if (info.file_offset > 0xFFFFFFFFu - rel) {
-            vfs_node_release(info.file);
+            mmap_pf_unlock(&info);
             return -1;
         }
 
         const uint32_t file_off = info.file_offset + rel;
+
+        /* Shared memory backed by a huge block goes in with one PDE. */
+        if ((info.file->flags & VFS_FLAG_SHM) != 0u) {
+            const uint32_t vaddr_huge = vaddr & ~PAGING_HUGE_MASK;
+
+            if (info.vaddr_start <= vaddr_huge && info.vaddr_end - vaddr_huge >= PAGING_HUGE_SIZE
+                && (paging_peek_pde(curr->mem->page_dir, vaddr_huge) & PTE_PRESENT) == 0u) {
+                const uint32_t huge_phys = shm_get_phys_huge(info.file, file_off - (vaddr - vaddr_huge));
+
+                if (huge_phys
+                    && (paging_map_huge_new(curr->mem->page_dir, vaddr_huge, huge_phys, 7u | 0x200u)
+                        || (paging_peek_pde(curr->mem->page_dir, vaddr_huge) & PTE_SUPER) != 0u)) {
+                    mmap_pf_unlock(&info);
+                    proc_acct_fault(curr, 0);
+                    return 1;
+                }
+            }
+        }
+
         const uint32_t phys = info.file->ops->get_phys_page(info.file, file_off);
 
         if (!phys) {
-            vfs_node_release(info.file);
+            mmap_pf_unlock(&info);
             return -1;
         }
 
         uint32_t pte_flags = 7u | 0x200u;
 
-        paging_map_ex(curr->mem->page_dir, vaddr, phys, pte_flags, PAGING_MAP_NO_TLB_FLUSH);
+        (void)paging_map_new(curr->mem->page_dir, vaddr, phys, pte_flags);
 
-        vfs_node_release(info.file);
+        mmap_pf_unlock(&info);
+        proc_acct_fault(curr, 0);
         return 1;
     }
 
-    if ((info.map_flags & MAP_STACK) == 0 && !info.file && (info.map_flags & MAP_SHARED) == 0) {
-        uint32_t vaddr_4m = vaddr & ~0x3FFFFFu;
-        uint32_t vaddr_4m_end = vaddr_4m + 0x400000u;
-
-        if (info.vaddr_start <= vaddr_4m && info.vaddr_end >= vaddr_4m_end) {
-            uint32_t pd_idx = vaddr_4m >> 22;
-
-            if ((curr->mem->page_dir[pd_idx] & 1u) == 0) {
-                void* huge_page = pmm_alloc_pages(10);
-
-                if (huge_page) {
-                    for (uint32_t i = 0; i < 1024; i++) {
-                        paging_zero_phys_page((uint32_t)huge_page + i * 4096u);
-                    }
+    /* Stacks stay executable: signal delivery runs code pushed onto them. */
+    const uint32_t anon_flags = (info.map_flags & MAP_STACK) ? 7u : (7u | PTE_NOEXEC);
 
-                    paging_map_4m(curr->mem->page_dir, vaddr_4m, (uint32_t)huge_page, 7);
+    /*
+     * Private anonymous memory takes a large page wherever one fits. A region
+     * marked huge (MADV_HUGEPAGE, or a large aligned mmap) also gets one on a
+     * stack, and reclaims for the block instead of settling for small pages.
+     * File pages have to be read in, so they never come from here.
+     */
+    const int want_huge = (info.map_flags & VMA_MAP_HUGE) != 0;
 
-                    curr->mem->mem_pages += 1024;
+    if (!info.file && (want_huge || (info.map_flags & (MAP_STACK | MAP_SHARED)) == 0)) {
+        uint32_t vaddr_huge = vaddr & ~PAGING_HUGE_MASK;
 
-                    return 1;
-                }
-            }
+        if (info.vaddr_start <= vaddr_huge && info.vaddr_end - vaddr_huge >= PAGING_HUGE_SIZE
+            && (paging_peek_pde(curr->mem->page_dir, vaddr_huge) & PTE_PRESENT) == 0u
+            && map_user_huge_page(curr->mem, vaddr_huge, anon_flags, want_huge)) {
+            mmap_pf_unlock(&info);
+            proc_acct_fault(curr, 0);
+            return 1;
         }
     }
 
-    if ((info.map_flags & VMA_MAP_HUGE) != 0) {
-        uint32_t vaddr_4m = vaddr & ~0x3FFFFFu;
-        uint32_t pd_idx = vaddr_4m >> 22;
-
-        if ((curr->mem->page_dir[pd_idx] & 1u) == 0) {
-            
-            void* huge_page = pmm_alloc_pages(10); 
-
-            if (huge_page) {
+    uint32_t batch_pages = info.fault_pages;
 
-                for (uint32_t i = 0; i < 1024; i++) {
-                    paging_zero_phys_page((uint32_t)huge_page + i * 4096u);
-                }
+    if (populate_end != 0u) {
+        batch_pages = (populate_end - vaddr + 0xFFFu) >> 12;
+    }
 
-                paging_map_4m(curr->mem->page_dir, vaddr_4m, (uint32_t)huge_page, 7);
-                curr->mem->mem_pages += 1024;
-                return 1;
-            }
-        }
+    if (batch_pages == 0u) {
+        batch_pages = 1u;
     }
 
-    uint32_t batch_pages = 8;
-    
     uint32_t max_vma_pages = (info.vaddr_end - vaddr) >> 12;
 
     if (batch_pages > max_vma_pages) {
         batch_pages = max_vma_pages;
     }
 
-    uint32_t pt_idx = (vaddr >> 12) & 0x3FFu;
-    uint32_t pt_remaining = 1024u - pt_idx;
+    uint32_t pt_idx = (vaddr >> 12) & (PAGING_PT_ENTRIES - 1u);
+    uint32_t pt_remaining = PAGING_PT_ENTRIES - pt_idx;
 
     if (batch_pages > pt_remaining) {
         batch_pages = pt_remaining;
     }
 
+    /* File contents are read() into the page, so it must be directly addressable. */
+    const int file_backed = (info.map_flags & MAP_STACK) == 0 && info.file;
+
     uint32_t mapped_count = 0;
 
+    /* Major when the page had to be read from its file rather than zero-filled. */
+    int major = 0;
+
     for (uint32_t i = 0; i < batch_pages; i++) {
         uint32_t curr_vaddr = vaddr + (i * 4096u);
         uint32_t curr_rel   = rel + (i * 4096u);
 
         if (i > 0) {
-            uint32_t existing_pte;
-            if (paging_get_present_pte(curr->mem->page_dir, curr_vaddr, &existing_pte)) {
+            /* Stop at anything already there, including swapped-out pages. */
+            if (paging_peek_pte(curr->mem->page_dir, curr_vaddr) != 0u) {
                 break;
             }
         }
 
-        void* new_page = pmm_alloc_block();
+        phys_addr_t new_page = (i == 0) ? alloc_user_fault_page(file_backed) : try_alloc_user_page(file_backed);
         if (!new_page) {
             if (i == 0) {
-                if (info.file) vfs_node_release(info.file);
+                mmap_pf_unlock(&info);
                 return -1;
             }
             break;
         }
 
-        memzero_nt_page(new_page);
+        paging_zero_phys_page(new_page);
 
-        if ((info.map_flags & MAP_STACK) == 0 &&
-            info.file &&
+        if (file_backed &&
             info.file->ops &&
             info.file->ops->read &&
             curr_rel < info.file_size) {
@@ -526,32 +632,70 @@ static int handle_mmap_demand_fault(task_t* curr, uint32_t cr2) {
             if (bytes > 4096) bytes = 4096;
 
             if (info.file_offset > 0xFFFFFFFFu - curr_rel) {
-                pmm_free_block(new_page);
+                pmm_free_phys(new_page);
                 break;
             }
 
-            int r = info.file->ops->read(info.file, info.file_offset + curr_rel, bytes, new_page);
+            int r = info.file->ops->read(info.file, info.file_offset + curr_rel, bytes, (void*)(uintptr_t)new_page);
 
             if (r < 0) {
-                pmm_free_block(new_page);
+                pmm_free_phys(new_page);
                 break;
             }
+
+            major = 1;
         }
 
-        paging_map_ex(curr->mem->page_dir, curr_vaddr, (uint32_t)new_page, 7, PAGING_MAP_NO_TLB_FLUSH);
+        if (!paging_map_new(curr->mem->page_dir, curr_vaddr, new_page, file_backed ? 7u : anon_flags)) {
+            /* Another thread faulted this page in first. */
+            pmm_free_phys(new_page);
+            break;
+        }
 
         mapped_count++;
     }
 
-    if (info.file) {
-        vfs_node_release(info.file);
-    }
+    mmap_pf_unlock(&info);
 
-    curr->mem->mem_pages += mapped_count;
+    __atomic_fetch_add(&curr->mem->mem_pages, mapped_count, __ATOMIC_RELAXED);
 
+    proc_acct_fault(curr, major);
     return 1;
 }
 
+int mmap_populate_range(task_t* t, uint32_t start, uint32_t end_excl) {
+    if (!t || !t->mem || !t->mem->page_dir || end_excl <= start) return -1;
+
+    uint32_t* dir = t->mem->page_dir;
+
+    uint32_t vaddr = start & ~0xFFFu;
+
+    while (vaddr < end_excl && vaddr != 0u) {
+        if ((paging_peek_pde(dir, vaddr) & PTE_SUPER) != 0u) {
+            vaddr = (vaddr & ~PAGING_HUGE_MASK) + PAGING_HUGE_SIZE;
+            continue;
+        }
+
+        const pte_t pte = paging_peek_pte(dir, vaddr);
+
+        if (pte_is_swap(pte)) {
+            /* Busy entries belong to reclaim; the next access resolves them. */
+            if (pte_swap_index(pte) != 0u && zswap_fault_in(t->mem, vaddr) < 0) return -1;
+
+            vaddr += 0x1000u;
+            continue;
+        }
+
+        if ((pte & PTE_PRESENT) == 0u) {
+            if (handle_mmap_demand_fault(t, vaddr, end_excl) != 1) return -1;
+        }
+
+        vaddr += 0x1000u;
+    }
+
+    return 0;
+}
+
 extern void proc_check_sleepers(uint32_t current_tick);
 extern void pmm_drain_local_pcp_caches(void);
 
@@ -589,6 +733,10 @@ void isr_handler(registers_t* regs) {
 
     if (cpu && regs->cs == 0x1B) {
         __atomic_store_n(&cpu->in_kernel, 1u, __ATOMIC_RELEASE);
+
+        if (curr) {
+            proc_acct_charge(curr, proc_acct_clock(), 1);
+        }
     }
 
     if (regs->int_no == IPI_TLB_VECTOR) {
@@ -617,9 +765,7 @@ void isr_handler(registers_t* regs) {
     if (regs->int_no == IPI_RCU_VECTOR) {
         lapic_eoi();
 
-        if (regs->cs == 0x1B) {
-            rcu_qs_count_inc();
-        }
+        rcu_ipi_handler(regs->cs == 0x1B);
 
         goto out;
     }
@@ -651,6 +797,9 @@ void isr_handler(registers_t* regs) {
 
             if (likely(cpu->index == 0)) {
                 timer_ticks++;
+
+                timerfd_tick(timer_ticks);
+                kmsg_tick();
             }
 
             proc_check_sleepers(timer_ticks);
@@ -660,6 +809,8 @@ void isr_handler(registers_t* regs) {
                 cpu->stat_idle_ticks++;
             }
 
+            sampler_tick(regs, cpu);
+
             if (((uint32_t)cpu->stat_total_ticks % 100) == 0) {
                 uint64_t delta_total = cpu->stat_total_ticks - cpu->snap_total_ticks;
                 uint64_t delta_idle  = cpu->stat_idle_ticks  - cpu->snap_idle_ticks;
@@ -685,7 +836,7 @@ void isr_handler(registers_t* regs) {
                 if (likely(curr->exec_start > 0)) {
                     uint64_t delta_exec = cpu->sched_ticks - curr->exec_start;
                     if (likely(delta_exec >= 1)) {
-                        uint64_t delta_vruntime = calc_delta_vruntime(delta_exec, curr->priority);
+                        uint64_t delta_vruntime = calc_delta_vruntime(delta_exec, sched_task_prio(curr));
                         curr->vruntime += delta_vruntime;
                         curr->exec_start = cpu->sched_ticks;
                     }
@@ -730,6 +881,8 @@ void isr_handler(registers_t* regs) {
                     if (ticks_to_next > max_sleep_shot) {
                         ticks_to_next = max_sleep_shot;
                     }
+
+                    ticks_to_next = sampler_clamp_ticks(ticks_to_next);
                 }
                 
                 lapic_timer_oneshot(ticks_to_next);
@@ -750,12 +903,17 @@ void isr_handler(registers_t* regs) {
             goto out;
         }
 
+        /* The timer tick is left out: at KERNEL_TIMER_HZ it would drown everything else. */
+        trace_event(YOS_TRACE_IRQ_ENTER, regs->int_no, 0u, 0u, 0u);
+
         if (irq_vector_handlers[regs->int_no].func) {
             irq_vector_handlers[regs->int_no].func(
                 regs, irq_vector_handlers[regs->int_no].ctx
             );
         }
 
+        trace_event(YOS_TRACE_IRQ_EXIT, regs->int_no, 0u, 0u, 0u);
+
         if (g_legacy_pic_enabled && regs->int_no >= 32 && regs->int_no <= 47) {
             if (regs->int_no >= 40) {
                 outb(0xA0, 0x20);
@@ -803,14 +961,12 @@ void isr_handler(registers_t* regs) {
 
             __asm__ volatile("sti");
 
+            trace_event(YOS_TRACE_PAGE_FAULT, cr2, regs->err_code, regs->eip, 0u);
+
             int handled = 0;
 
             if (cr2 >= 0xC0000000) {
-                uint32_t pd_idx = cr2 >> 22;
-                uint32_t* current_dir = (uint32_t*)get_cr3();
-                if ((kernel_page_directory[pd_idx] & 1) && !(current_dir[pd_idx] & 1)) {
-                    current_dir[pd_idx] = kernel_page_directory[pd_idx];
-                    __asm__ volatile("invlpg (%0)" :: "r"(cr2) : "memory");
+                if (paging_sync_kernel_mapping((uint32_t*)get_cr3(), cr2)) {
                     goto out;
                 }
             }
@@ -819,12 +975,28 @@ void isr_handler(registers_t* regs) {
             const int is_kernel_access_to_user = (regs->cs == 0x08 && cr2 < 0xC0000000);
 
             if (!handled && (is_user_access || is_kernel_access_to_user) && !(regs->err_code & 1) && curr && curr->mem && curr->mem->page_dir) {
+                /* Swapped-out pages come first: every handler below would map a fresh page over them. */
+                int swap_r = zswap_fault_in(curr->mem, cr2);
+                if (swap_r > 0) {
+                    proc_acct_fault(curr, 1);
+                    handled = 1;
+                } else if (swap_r < 0) {
+                    curr->pending_signals |= (1u << SIGSEGV);
+                    if (regs->cs == 0x1B) {
+                        maybe_deliver_pending_signal(curr, regs);
+                        goto out;
+                    }
+                    proc_kill(curr);
+                    sched_yield();
+                    goto out;
+                }
+
                 if (!handled && cr2 >= curr->stack_bottom && cr2 < curr->stack_top) {
-                    void* new_page = pmm_alloc_block();
+                    phys_addr_t new_page = alloc_user_fault_page(0);
                     if (new_page) {
                         uint32_t vaddr = cr2 & ~0xFFF;
-                        paging_map_ex(curr->mem->page_dir, vaddr, (uint32_t)new_page, 7, PAGING_MAP_NO_TLB_FLUSH);
-                        curr->mem->mem_pages++;
+                        map_user_fault_page(curr->mem, vaddr, new_page, 7);
+                        proc_acct_fault(curr, 0);
                         handled = 1;
                     } else {
                         curr->pending_signals |= (1u << SIGSEGV);
@@ -839,35 +1011,24 @@ void isr_handler(registers_t* regs) {
                 }
 
                 if (!handled && cr2 >= curr->mem->heap_start && cr2 < curr->mem->prog_break) {
-                    uint32_t vaddr_4m = cr2 & ~0x3FFFFFu;
-                    uint32_t vaddr_4m_end = vaddr_4m + 0x400000u;
-                    uint32_t pd_idx = vaddr_4m >> 22;
+                    uint32_t vaddr_huge = cr2 & ~PAGING_HUGE_MASK;
+                    uint32_t vaddr_huge_end = vaddr_huge + PAGING_HUGE_SIZE;
 
-                    if (curr->mem->heap_start <= vaddr_4m && curr->mem->prog_break >= vaddr_4m_end && (curr->mem->page_dir[pd_idx] & 1u) == 0) {
-                        void* huge_page = pmm_alloc_pages(10);
-
-                        if (huge_page) {
-                            for (uint32_t i = 0; i < 1024; i++) {
-                                paging_zero_phys_page((uint32_t)huge_page + i * 4096u);
-                            }
-
-                            paging_map_4m(curr->mem->page_dir, vaddr_4m, (uint32_t)huge_page, 7);
-                            
-                            curr->mem->mem_pages += 1024;
-                            
-                            handled = 1;
-                        }
+                    if (curr->mem->heap_start <= vaddr_huge && curr->mem->prog_break >= vaddr_huge_end
+                        && (paging_peek_pde(curr->mem->page_dir, vaddr_huge) & PTE_PRESENT) == 0u
+                        && map_user_huge_page(curr->mem, vaddr_huge, 7u | PTE_NOEXEC, 0)) {
+                        proc_acct_fault(curr, 0);
+                        handled = 1;
                     }
 
                     if (!handled) {
-                        void* new_page = pmm_alloc_block();
+                        phys_addr_t new_page = alloc_user_fault_page(0);
                         
                         if (new_page) {
                             uint32_t vaddr = cr2 & ~0xFFF;
                         
-                            paging_map_ex(curr->mem->page_dir, vaddr, (uint32_t)new_page, 7, PAGING_MAP_NO_TLB_FLUSH);
-                        
-                            curr->mem->mem_pages++;
+                            map_user_fault_page(curr->mem, vaddr, new_page, 7u | PTE_NOEXEC);
+                            proc_acct_fault(curr, 0);
                         
                             handled = 1;
                         } else {
@@ -887,7 +1048,7 @@ void isr_handler(registers_t* regs) {
                 }
 
                 if (!handled) {
-                    int r = handle_mmap_demand_fault(curr, cr2);
+                    int r = handle_mmap_demand_fault(curr, cr2, 0u);
                     if (r == 1) {
                         handled = 1;
                     } else if (r < 0) {
@@ -910,20 +1071,8 @@ void isr_handler(registers_t* regs) {
             }
 
             if (!handled && regs->cs == 0x08) {
-                uint32_t* dir = (uint32_t*)get_cr3();
-                uint32_t pd_idx = cr2 >> 22;
-                uint32_t pt_idx = (cr2 >> 12) & 0x3FF;
-
-                if ((dir[pd_idx] & 1u) != 0u) {
-                    uint32_t* pt = (uint32_t*)(dir[pd_idx] & ~0xFFFu);
-                    if ((pt[pt_idx] & 1u) == 0u) {
-                        uint32_t kernel_pte = 0;
-                        if (paging_get_present_pte(kernel_page_directory, cr2, &kernel_pte)) {
-                            pt[pt_idx] = kernel_pte;
-                            __asm__ volatile("invlpg (%0)" :: "r"(cr2) : "memory");
-                            goto out;
-                        }
-                    }
+                if (paging_sync_kernel_mapping((uint32_t*)get_cr3(), cr2)) {
+                    goto out;
                 }
             }
 
@@ -973,8 +1122,20 @@ out:
         __atomic_store_n(&cpu->in_kernel, 0u, __ATOMIC_RELEASE);
         rcu_qs_count_inc();
 
+        if (curr) {
+            proc_acct_charge(curr, proc_acct_clock(), 0);
+        }
+
         if (curr && curr->tls_base) {
-            regs->fs = ((GDT_USER_TLS_BASE + cpu->index) << 3) | 3;
+            /*
+             * fs and gs both address the TLS block: gcc emits %gs for __thread
+             * on i386. The descriptor is the one of the CPU we leave from,
+             * which is not `cpu` if the handler slept and woke up elsewhere.
+             */
+            const uint32_t tls_sel = ((GDT_USER_TLS_BASE + cpu_current()->index) << 3) | 3;
+
+            regs->fs = tls_sel;
+            regs->gs = tls_sel;
         }
     }
 #ifdef KERNEL_PROFILE
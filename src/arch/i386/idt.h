@@ -28,4 +28,20 @@ void idt_init(void);
 /* Load IDTR from the current idtp descriptor. */
 void idt_load(void);
 
+struct task;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fault in every page of [start, end_excl) that the task's mmap regions
+ * cover, as if it had been touched. Stops at the first failure.
+ */
+int mmap_populate_range(struct task* t, uint32_t start, uint32_t end_excl);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -11,6 +11,18 @@ public sysenter_entry
 extrn isr_handler
 extrn double_fault_report
 
+; MAX_CPUS in src/kernel/smp/cpu_limits.h.
+MAX_CPUS = 32
+
+; User code owns gs: it addresses the thread's TLS block there. Each CPU's
+; data segment sits MAX_CPUS descriptors past its TSS, so the task register
+; names the one to load for cpu_current().
+macro LOAD_CPU_GS {
+    str ax
+    add ax, (MAX_CPUS shl 3) or 3
+    mov gs, ax
+}
+
 load_page_directory:
     mov eax, [esp + 4]
     mov cr3, eax
@@ -128,6 +140,7 @@ sysenter_entry:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    LOAD_CPU_GS
     
     mov eax, esp
     push eax
@@ -168,6 +181,7 @@ isr_common:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    LOAD_CPU_GS
 
     mov eax, esp
     push eax   
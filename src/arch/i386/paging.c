@@ -5,6 +5,7 @@
 #include <kernel/smp/cpu.h>
 #include <kernel/proc.h>
 
+#include <mm/zswap.h>
 #include <mm/heap.h>
 #include <mm/pmm.h>
 
@@ -24,30 +25,66 @@ extern void enable_paging(void);
 /*
  * Kernel page directory template.
  *
- * Early boot builds an identity map of RAM into this directory and installs it
- * in CR3 before enabling paging.
+ * Early boot builds an identity map of low memory into this directory and
+ * installs it in CR3 before enabling paging.
  *
  * Later on, process directories clone PDEs from this template to share the
  * kernel half.
+ *
+ * With PAE the template is a PDPT over four page directories that are laid
+ * out back to back, so `kernel_pdes[virt >> PAGING_PDE_SHIFT]` addresses the
+ * kernel PDE for any address in both formats.
  */
 uint32_t* kernel_page_directory = 0;
 
-uint32_t page_dir[1024] __attribute__((aligned(4096)));
+#ifdef KERNEL_PAE
+
+#define PAGING_PDPT_ENTRIES 4u
+#define PAGING_KERNEL_PDES  (PAGING_PDPT_ENTRIES * PAGING_PT_ENTRIES)
+
+static pte_t kernel_pdpt[PAGING_PDPT_ENTRIES] __attribute__((aligned(32)));
+
+#else
+
+#define PAGING_KERNEL_PDES  1024u
+
+#endif
+
+static pte_t kernel_pdes[PAGING_KERNEL_PDES] __attribute__((aligned(4096)));
 
 /*
  * Paging updates are serialized.
  *
  * The kernel page tables are shared globally and can be modified concurrently
- * (e.g. VMM heap mappings, fixmap, AP startup). We keep the implementation
+ * (e.g. VMM heap mappings, kmap, AP startup). We keep the implementation
  * simple by guarding all table walks/updates with one lock.
  */
 static spinlock_t paging_lock;
 
 static uint32_t paging_ram_size_bytes = 0;
 
-#define PAGING_FIXMAP_BASE 0xFFFFE000u
-#define PAGING_FIXMAP_SLOTS 16u
+/* End of the identity-mapped low memory. Page tables always live below it. */
+static uint32_t paging_lowmem_end = 0;
 
+static int paging_nx_active = 0;
+
+/*
+ * Temporary mapping windows: PAGING_KMAP_SLOTS pages per CPU at the top of
+ * the address space, right below the last large page.
+ */
+#define PAGING_KMAP_BASE  0xFFF00000u
+#define PAGING_KMAP_SLOTS 4u
+#define PAGING_KMAP_END   (PAGING_KMAP_BASE + MAX_CPUS * PAGING_KMAP_SLOTS * 4096u)
+
+typedef struct {
+    uint32_t depth;
+    uint32_t irq_flags[PAGING_KMAP_SLOTS];
+} paging_kmap_cpu_t;
+
+static paging_kmap_cpu_t paging_kmap_cpus[MAX_CPUS];
+
+/* Kernel PTEs backing the kmap windows; one page table covers all of them. */
+static volatile pte_t* paging_kmap_ptes = 0;
 
 typedef struct {
     volatile uintptr_t key;
@@ -197,43 +234,97 @@ static inline void paging_unlock_dir_safe(uint32_t* dir, uint32_t flags) {
     spinlock_release_safe(paging_select_dir_lock(dir), flags);
 }
 
-static inline spinlock_t* paging_get_pt_lock(uint32_t pde) {
-    uint32_t phys = pde & ~0xFFFu;
+/*
+ * Table walking.
+ *
+ * paging_pde_slot() resolves the directory entry covering `virt`. In PAE mode
+ * that goes through the PDPT, whose entries are fixed for the lifetime of
+ * the directory, so the slot pointer itself is stable and only its contents
+ * need atomic access.
+ */
+static inline volatile pte_t* paging_pde_slot(uint32_t* dir, uint32_t virt) {
+#ifdef KERNEL_PAE
+    const pte_t pdpte = ((const pte_t*)dir)[virt >> 30];
+
+    if (unlikely((pdpte & PTE_PRESENT) == 0u)) {
+        return 0;
+    }
+
+    pte_t* pd = (pte_t*)(uintptr_t)pte_phys(pdpte);
+
+    return &pd[(virt >> PAGING_PDE_SHIFT) & (PAGING_PT_ENTRIES - 1u)];
+#else
+    return (volatile pte_t*)&dir[virt >> PAGING_PDE_SHIFT];
+#endif
+}
+
+static inline volatile pte_t* paging_pte_slot(pte_t pde, uint32_t virt) {
+    pte_t* pt = (pte_t*)(uintptr_t)pte_phys(pde);
 
-    page_t* page = pmm_phys_to_page(phys);
+    return &pt[(virt >> 12) & (PAGING_PT_ENTRIES - 1u)];
+}
+
+/* First address covered by the next PDE; 0 once the address space wraps. */
+static inline uint32_t paging_pde_next(uint32_t virt) {
+    return (virt & ~PAGING_HUGE_MASK) + PAGING_HUGE_SIZE;
+}
+
+static inline pte_t paging_load_pde(uint32_t* dir, uint32_t virt) {
+    volatile pte_t* slot = paging_pde_slot(dir, virt);
+
+    return slot ? pte_load(slot) : 0u;
+}
+
+static inline spinlock_t* paging_get_pt_lock(pte_t pde) {
+    page_t* page = pmm_phys_to_page(pte_phys(pde));
 
     return &page->pt_lock;
 }
 
-static uint32_t paging_ensure_pt(uint32_t* dir, uint32_t pd_idx) {
-    uint32_t pde = __atomic_load_n(&dir[pd_idx], __ATOMIC_ACQUIRE);
-    if (likely((pde & 1u) != 0u)) {
+pte_t paging_make_pte(phys_addr_t phys, uint32_t flags) {
+    pte_t pte = (pte_t)(phys & PTE_ADDR_MASK) | flags;
+
+    if ((flags & PTE_NOEXEC) != 0u && paging_nx_active) {
+        pte |= PTE_NX;
+    }
+
+    return pte;
+}
+
+static pte_t paging_ensure_pt(uint32_t* dir, uint32_t virt) {
+    volatile pte_t* slot = paging_pde_slot(dir, virt);
+    if (unlikely(!slot)) {
+        paging_halt("paging_ensure_pt: missing PDPT entry");
+    }
+
+    pte_t pde = pte_load(slot);
+    if (likely((pde & PTE_PRESENT) != 0u)) {
         return pde;
     }
 
     uint32_t int_flags = paging_lock_dir_safe(dir);
-    if ((dir[pd_idx] & 1u) == 0u) {
+    if ((pte_load(slot) & PTE_PRESENT) == 0u) {
         paging_unlock_dir_safe(dir, int_flags);
 
         void* new_pt_phys = pmm_alloc_block();
         if (!new_pt_phys) {
             paging_halt("pmm_alloc_block failed in paging_ensure_pt");
         }
-        
+
         paging_zero_phys_page((uint32_t)new_pt_phys);
 
         spinlock_init(&pmm_phys_to_page((uint32_t)new_pt_phys)->pt_lock);
 
         int_flags = paging_lock_dir_safe(dir);
 
-        if ((dir[pd_idx] & 1u) == 0u) {
-            pde = ((uint32_t)new_pt_phys) | 7u;
+        if ((pte_load(slot) & PTE_PRESENT) == 0u) {
+            pde = (pte_t)(uint32_t)new_pt_phys | PTE_PRESENT | PTE_RW | PTE_USER;
 
-            __atomic_store_n(&dir[pd_idx], pde, __ATOMIC_RELEASE);
+            pte_store(slot, pde);
 
             new_pt_phys = 0;
         } else {
-            pde = dir[pd_idx];
+            pde = pte_load(slot);
         }
 
         paging_unlock_dir_safe(dir, int_flags);
@@ -244,40 +335,15 @@ static uint32_t paging_ensure_pt(uint32_t* dir, uint32_t pd_idx) {
 
         return pde;
     }
-    
-    pde = dir[pd_idx];
+
+    pde = pte_load(slot);
 
     paging_unlock_dir_safe(dir, int_flags);
 
     return pde;
 }
 
-/*
- * Fixmap.
- *
- * Once paging is enabled, the kernel cannot blindly dereference a physical
- * address. For early boot helpers (zeroing page tables, etc.) we reserve a
- * small per-CPU virtual window (PAGING_FIXMAP_SLOTS) and map one physical page
- * there on demand.
- *
- * The fixmap is backed by the kernel page directory, so it is available
- * regardless of the currently active user directory.
- */
-
-static inline uint32_t* paging_pt_virt(uint32_t* dir, uint32_t virt) {
-    uint32_t pd_idx = virt >> 22;
-    if ((dir[pd_idx] & 1u) == 0u) {
-        return 0;
-    }
-
-    if ((dir[pd_idx] & (1u << 7)) != 0u) {
-        return 0;
-    }
-
-    return (uint32_t*)(dir[pd_idx] & ~0xFFFu);
-}
-
-static inline int paging_pde_pt_phys_valid(uint32_t pde);
+static inline int paging_pde_pt_phys_valid(pte_t pde);
 
 static inline void paging_tlb_flush_range_local(uint32_t start, uint32_t end) {
     if (end <= start) {
@@ -306,56 +372,88 @@ static inline void paging_tlb_flush_range_local(uint32_t start, uint32_t end) {
     }
 }
 
-___inline void __paging_unmap_range(
+/* Invalidate a range that was just unmapped from `dir` on every CPU that needs it. */
+static void paging_flush_unmapped(uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr) {
+    if (dir == kernel_page_directory) {
+        smp_tlb_shootdown_range(start_vaddr, end_vaddr);
+        paging_tlb_flush_range_local(start_vaddr, end_vaddr);
+
+        return;
+    }
+
+    cpu_t* me = cpu_current();
+
+    int is_dying = (me && me->current_task && me->current_task->state == TASK_ZOMBIE);
+    int refcount = (me && me->current_task && me->current_task->mem && me->current_task->mem->page_dir == dir) ? me->current_task->mem->refcount : 2;
+
+    if (unlikely(refcount == 1 && is_dying)) {
+        return;
+    }
+
+    paging_tlb_flush_range_local(start_vaddr, end_vaddr);
+
+    if (unlikely(refcount > 1)) {
+        smp_tlb_shootdown_range_dir(dir, start_vaddr, end_vaddr);
+    }
+}
+
+/* Clear the range and return 1 if anything was unmapped; the caller flushes. */
+___inline int __paging_unmap_range(
     uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr,
-    paging_unmap_visitor_t visitor, void* visitor_ctx,
-    int flush_tlb
+    paging_unmap_visitor_t visitor, void* visitor_ctx
 ) {
     if (unlikely(!dir)) {
-        return;
+        return 0;
     }
 
     if (unlikely(end_vaddr <= start_vaddr)) {
-        return;
+        return 0;
     }
 
     const uint32_t start = start_vaddr & ~0xFFFu;
     const uint32_t end = (end_vaddr + 0xFFFu) & ~0xFFFu;
 
     if (unlikely(end <= start)) {
-        return;
+        return 0;
     }
 
     int any_unmapped = 0;
 
-    for (uint32_t virt = start; virt < end; ) {
-        const uint32_t pd_idx = virt >> 22;
-        const uint32_t pde = __atomic_load_n(&dir[pd_idx], __ATOMIC_ACQUIRE);
-        
-        if ((pde & 1u) == 0u) {
-            virt = (virt & ~0x3FFFFFu) + 0x400000u;
+    for (uint32_t virt = start; virt < end && virt != 0u; ) {
+        volatile pte_t* slot = paging_pde_slot(dir, virt);
+        const pte_t pde = slot ? pte_load(slot) : 0u;
+
+        if ((pde & PTE_PRESENT) == 0u) {
+            virt = paging_pde_next(virt);
 
             continue;
         }
 
-        if ((pde & (1u << 7)) != 0u) {
+        if ((pde & PTE_SUPER) != 0u) {
             uint32_t int_flags = paging_lock_dir_safe(dir);
 
+            /* Reclaim may have split the huge page before we got the lock. */
+            if (unlikely(pte_load(slot) != pde)) {
+                paging_unlock_dir_safe(dir, int_flags);
+
+                continue;
+            }
+
             int proceed = 1;
 
-            if (visitor && !visitor(virt & ~0x3FFFFFu, pde, visitor_ctx)) {
+            if (visitor && !visitor(virt & ~PAGING_HUGE_MASK, pde, visitor_ctx)) {
                 proceed = 0;
             }
 
             if (proceed) {
-                __atomic_store_n(&dir[pd_idx], 0, __ATOMIC_RELEASE);
+                pte_store(slot, 0u);
 
                 any_unmapped = 1;
             }
 
             paging_unlock_dir_safe(dir, int_flags);
 
-            virt = (virt & ~0x3FFFFFu) + 0x400000u;
+            virt = paging_pde_next(virt);
 
             continue;
         }
@@ -364,19 +462,17 @@ ___inline void __paging_unmap_range(
 
         uint32_t int_flags = spinlock_acquire_safe(pt_lock);
 
-        uint32_t* pt = (uint32_t*)(pde & ~0xFFFu);
+        uint32_t chunk_end = paging_pde_next(virt);
 
-        uint32_t chunk_end = (virt & ~0x3FFFFFu) + 0x400000u;
-
-        if (unlikely(chunk_end > end)) {
+        if (unlikely(chunk_end > end || chunk_end == 0u)) {
             chunk_end = end;
         }
 
         while (virt < chunk_end) {
-            const uint32_t pt_idx = (virt >> 12) & 0x3FFu;
-            const uint32_t pte = __atomic_load_n(&pt[pt_idx], __ATOMIC_RELAXED);
-            
-            if ((pte & 1u) != 0u) {
+            volatile pte_t* pte_slot = paging_pte_slot(pde, virt);
+            const pte_t pte = pte_load(pte_slot);
+
+            if ((pte & PTE_PRESENT) != 0u) {
                 int proceed = 1;
 
                 if (visitor && !visitor(virt, pte, visitor_ctx)) {
@@ -384,9 +480,18 @@ ___inline void __paging_unmap_range(
                 }
 
                 if (proceed) {
-                    __atomic_store_n(&pt[pt_idx], 0u, __ATOMIC_RELEASE);
+                    pte_store(pte_slot, 0u);
                     any_unmapped = 1;
                 }
+            } else if (pte_is_swap(pte)) {
+                /*
+                 * Nothing is cached for a swapped-out page, only the entry
+                 * needs to go. A busy marker is resolved by its owner once it
+                 * notices the PTE changed under it.
+                 */
+                pte_store(pte_slot, 0u);
+
+                zswap_release_entry(pte_swap_index(pte));
             }
 
             virt += 0x1000u;
@@ -395,141 +500,387 @@ ___inline void __paging_unmap_range(
         spinlock_release_safe(pt_lock, int_flags);
     }
 
-    if (unlikely(!any_unmapped || !flush_tlb)) {
-        return;
+    return any_unmapped;
+}
+
+uint32_t paging_scan_range(
+    uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr,
+    paging_scan_visitor_t visitor, void* visitor_ctx
+) {
+    if (unlikely(!dir || !visitor)) {
+        return end_vaddr;
     }
 
-    if (dir == kernel_page_directory) {
-        smp_tlb_shootdown_range(start_vaddr, end_vaddr);
-        paging_tlb_flush_range_local(start_vaddr, end_vaddr);
+    uint32_t virt = start_vaddr & ~0xFFFu;
 
-        return;
+    while (virt < end_vaddr) {
+        volatile pte_t* slot = paging_pde_slot(dir, virt);
+        const pte_t pde = slot ? pte_load(slot) : 0u;
+
+        uint32_t chunk_end = paging_pde_next(virt);
+
+        if (unlikely(chunk_end > end_vaddr || chunk_end == 0u)) {
+            chunk_end = end_vaddr;
+        }
+
+        if ((pde & PTE_PRESENT) == 0u
+            || pte_phys(paging_load_pde(kernel_page_directory, virt)) == pte_phys(pde)) {
+            virt = chunk_end;
+
+            continue;
+        }
+
+        if ((pde & PTE_SUPER) != 0u) {
+            if (visitor(virt & ~PAGING_HUGE_MASK, (pte_t*)slot, visitor_ctx)) {
+                return virt;
+            }
+
+            virt = chunk_end;
+
+            continue;
+        }
+
+        if (unlikely(!paging_pde_pt_phys_valid(pde))) {
+            virt = chunk_end;
+
+            continue;
+        }
+
+        spinlock_t* pt_lock = paging_get_pt_lock(pde);
+
+        int stop = 0;
+
+        uint32_t int_flags = spinlock_acquire_safe(pt_lock);
+
+        while (virt < chunk_end) {
+            volatile pte_t* pte_slot = paging_pte_slot(pde, virt);
+
+            if (pte_load(pte_slot) != 0u
+                && visitor(virt, (pte_t*)pte_slot, visitor_ctx)) {
+                stop = 1;
+
+                break;
+            }
+
+            virt += 0x1000u;
+        }
+
+        spinlock_release_safe(pt_lock, int_flags);
+
+        if (stop) {
+            return virt;
+        }
     }
 
-    cpu_t* me = cpu_current();
+    return end_vaddr;
+}
 
-    int is_dying = (me && me->current_task && me->current_task->state == TASK_ZOMBIE);
-    int refcount = (me && me->current_task && me->current_task->mem && me->current_task->mem->page_dir == dir) ? me->current_task->mem->refcount : 2;
+int paging_split_huge(uint32_t* dir, uint32_t virt) {
+    if (unlikely(!dir || dir == kernel_page_directory)) {
+        return 0;
+    }
 
-    if (unlikely(refcount == 1 && is_dying)) {
+    volatile pte_t* slot = paging_pde_slot(dir, virt);
+    if (unlikely(!slot)) {
+        return 0;
+    }
+
+    const pte_t pde = pte_load(slot);
+
+    if ((pde & (PTE_PRESENT | PTE_USER | PTE_SUPER)) != (PTE_PRESENT | PTE_USER | PTE_SUPER)) {
+        return 0;
+    }
+
+    pte_t* pt = (pte_t*)pmm_alloc_block();
+    if (!pt) {
+        return 0;
+    }
+
+    const phys_addr_t base = pde_huge_phys(pde);
+    const pte_t flags = (pde & (PTE_RW | PTE_USER | PTE_PWT | PTE_PCD | 0x200u | PTE_NOEXEC)) | (pde & PTE_NX);
+
+    for (uint32_t i = 0; i < PAGING_PT_ENTRIES; i++) {
+        pt[i] = (pte_t)(base + ((phys_addr_t)i << 12)) | PTE_PRESENT | flags;
+    }
+
+    spinlock_init(&pmm_phys_to_page((uint32_t)pt)->pt_lock);
+
+    int split = 0;
+
+    uint32_t int_flags = paging_lock_dir_safe(dir);
+
+    if (pte_cmpxchg(slot, pde, (pte_t)(uint32_t)pt | PTE_PRESENT | PTE_RW | PTE_USER)) {
+        split = 1;
+    }
+
+    paging_unlock_dir_safe(dir, int_flags);
+
+    if (!split) {
+        pmm_free_block(pt);
+
+        return 0;
+    }
+
+    /* Every 4KiB frame of the block is now owned and freed on its own. */
+    pmm_split_pages((void*)(uintptr_t)base, PAGING_HUGE_ORDER);
+
+    paging_flush_user_range(dir, virt & ~PAGING_HUGE_MASK, (virt & ~PAGING_HUGE_MASK) + PAGING_HUGE_SIZE);
+
+    return 1;
+}
+
+pte_t paging_peek_pde(uint32_t* dir, uint32_t virt) {
+    if (unlikely(!dir)) {
+        return 0u;
+    }
+
+    return paging_load_pde(dir, virt);
+}
+
+pte_t paging_peek_pte(uint32_t* dir, uint32_t virt) {
+    if (unlikely(!dir)) {
+        return 0u;
+    }
+
+    const pte_t pde = paging_load_pde(dir, virt);
+
+    if ((pde & PTE_PRESENT) == 0u || (pde & PTE_SUPER) != 0u) {
+        return 0u;
+    }
+
+    if (unlikely(!paging_pde_pt_phys_valid(pde))) {
+        return 0u;
+    }
+
+    return pte_load(paging_pte_slot(pde, virt));
+}
+
+int paging_pte_cmpxchg(uint32_t* dir, uint32_t virt, pte_t expected, pte_t desired) {
+    if (unlikely(!dir)) {
+        return 0;
+    }
+
+    const pte_t pde = paging_load_pde(dir, virt);
+
+    if ((pde & PTE_PRESENT) == 0u || (pde & PTE_SUPER) != 0u) {
+        return 0;
+    }
+
+    spinlock_t* pt_lock = paging_get_pt_lock(pde);
+
+    uint32_t int_flags = spinlock_acquire_safe(pt_lock);
+
+    const int ok = pte_cmpxchg(paging_pte_slot(pde, virt), expected, desired);
+
+    spinlock_release_safe(pt_lock, int_flags);
+
+    return ok;
+}
+
+void paging_flush_user_range(uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr) {
+    if (unlikely(!dir || end_vaddr <= start_vaddr)) {
         return;
     }
 
     paging_tlb_flush_range_local(start_vaddr, end_vaddr);
 
-    if (unlikely(refcount > 1)) {
-        smp_tlb_shootdown_range_dir(dir, start_vaddr, end_vaddr);
-    }
+    smp_tlb_shootdown_range_dir(dir, start_vaddr, end_vaddr);
 }
 
 void paging_unmap_range_ex(
     uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr,
     paging_unmap_visitor_t visitor, void* visitor_ctx
 ) {
-    __paging_unmap_range(dir, start_vaddr, end_vaddr, visitor, visitor_ctx, 1);
+    if (__paging_unmap_range(dir, start_vaddr, end_vaddr, visitor, visitor_ctx)) {
+        paging_flush_unmapped(dir, start_vaddr, end_vaddr);
+    }
 }
 
 void paging_unmap_range(uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr) {
-    __paging_unmap_range(dir, start_vaddr, end_vaddr, 0, 0, 1);
+    paging_unmap_range_ex(dir, start_vaddr, end_vaddr, 0, 0);
 }
 
 void paging_unmap_range_no_tlb(
     uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr,
     paging_unmap_visitor_t visitor, void* visitor_ctx
 ) {
-    __paging_unmap_range(dir, start_vaddr, end_vaddr, visitor, visitor_ctx, 0);
+    (void)__paging_unmap_range(dir, start_vaddr, end_vaddr, visitor, visitor_ctx);
+}
+
+void paging_tlb_gather_init(paging_tlb_gather_t* tlb, uint32_t* dir) {
+    tlb->dir = dir;
+    tlb->start = 0u;
+    tlb->end = 0u;
+    tlb->frame_count = 0u;
+}
+
+void paging_unmap_range_gather(
+    paging_tlb_gather_t* tlb, uint32_t start_vaddr, uint32_t end_vaddr,
+    paging_unmap_visitor_t visitor, void* visitor_ctx
+) {
+    if (!__paging_unmap_range(tlb->dir, start_vaddr, end_vaddr, visitor, visitor_ctx)) {
+        return;
+    }
+
+    if (tlb->end <= tlb->start) {
+        tlb->start = start_vaddr;
+        tlb->end = end_vaddr;
+
+        return;
+    }
+
+    if (start_vaddr < tlb->start) tlb->start = start_vaddr;
+    if (end_vaddr > tlb->end) tlb->end = end_vaddr;
+}
+
+void paging_tlb_gather_free_huge(paging_tlb_gather_t* tlb, phys_addr_t phys) {
+    if (likely(tlb->frame_count < PAGING_GATHER_FRAMES)) {
+        tlb->frames[tlb->frame_count++] = phys;
+
+        return;
+    }
+
+    /*
+     * No room left. The visitor runs under page-table locks, so flushing
+     * here could deadlock against a CPU spinning on them; defer every small
+     * page past an RCU grace period instead, which cannot end before this
+     * CPU has finished the flush.
+     */
+    pmm_split_pages((void*)(uintptr_t)phys, PAGING_HUGE_ORDER);
+
+    for (uint32_t i = 0; i < PAGING_HUGE_PAGES; i++) {
+        pmm_free_phys_deferred(phys + i * 4096u);
+    }
+}
+
+void paging_tlb_gather_finish(paging_tlb_gather_t* tlb) {
+    if (tlb->end > tlb->start) {
+        paging_flush_unmapped(tlb->dir, tlb->start, tlb->end);
+    }
+
+    for (uint32_t i = 0; i < tlb->frame_count; i++) {
+        pmm_free_pages((void*)(uintptr_t)tlb->frames[i], PAGING_HUGE_ORDER);
+    }
+
+    paging_tlb_gather_init(tlb, tlb->dir);
+}
+
+void paging_drop_pdes(uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr) {
+    if (unlikely(!dir || dir == kernel_page_directory)) {
+        return;
+    }
+
+    for (uint32_t virt = start_vaddr & ~PAGING_HUGE_MASK; virt < end_vaddr && virt != 0u; virt = paging_pde_next(virt)) {
+        volatile pte_t* slot = paging_pde_slot(dir, virt);
+
+        if (slot) {
+            pte_store(slot, 0u);
+        }
+    }
 }
 
-static inline int paging_pde_pt_phys_valid(uint32_t pde) {
+static inline int paging_pde_pt_phys_valid(pte_t pde) {
     /*
      * Defensive validation for pointers coming from page tables.
      *
      * We only expect 4KiB page tables here (no PSE), and we reject obviously
-     * bogus PT addresses.
+     * bogus PT addresses. Page tables are always allocated from low memory.
      */
-    if ((pde & 1u) == 0u) return 0;
-    if ((pde & (1u << 7)) != 0u) return 0;
+    if ((pde & PTE_PRESENT) == 0u) return 0;
+    if ((pde & PTE_SUPER) != 0u) return 0;
 
-    uint32_t pt_phys = pde & ~0xFFFu;
+    const phys_addr_t pt_phys = pte_phys(pde);
     if (pt_phys == 0u) return 0;
-    if (paging_ram_size_bytes == 0u) return 0;
-    if (pt_phys >= paging_ram_size_bytes) return 0;
+    if (paging_lowmem_end == 0u) return 0;
+    if (pt_phys >= paging_lowmem_end) return 0;
 
     return 1;
 }
 
-static inline uint32_t paging_fixmap_virt(void) {
-    cpu_t* cpu = cpu_current();
-    uint32_t idx = 0;
+static inline int paging_is_enabled(void) {
+    uint32_t cr0;
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    return ((cr0 & (1u << 31)) != 0u) ? 1 : 0;
+}
 
-    if (cpu && cpu->index >= 0 && (uint32_t)cpu->index < PAGING_FIXMAP_SLOTS) {
-        /*
-         * Per-CPU slot selection keeps fixmap usage contention-free for the
-         * common case (each CPU clears/initializes its own freshly allocated
-         * tables).
-         */
-        idx = (uint32_t)cpu->index;
+/*
+ * Temporary mappings.
+ *
+ * Low memory is permanently identity-mapped, so only HIGHMEM frames need a
+ * window. Each CPU owns PAGING_KMAP_SLOTS consecutive slots used as a stack;
+ * interrupts stay off while any of them is in use, which keeps the owner
+ * pinned to its CPU and makes a local invlpg sufficient.
+ */
+void* paging_kmap_atomic(phys_addr_t phys) {
+    if (phys + PAGE_SIZE <= paging_lowmem_end || !paging_kmap_ptes) {
+        return (void*)(uintptr_t)phys;
     }
 
-    return PAGING_FIXMAP_BASE - idx * 4096u;
-}
+    uint32_t irq_flags;
+    __asm__ volatile("pushfl; popl %0; cli" : "=r"(irq_flags) : : "memory");
 
-static void paging_fixmap_set(uint32_t virt, uint32_t phys) {
-    uint32_t* pt = paging_pt_virt(kernel_page_directory, virt);
-    if (!pt) {
-        paging_halt("paging_fixmap_set: missing PT");
+    cpu_t* cpu = cpu_current();
+    const uint32_t cpu_idx = (cpu && cpu->index >= 0 && cpu->index < MAX_CPUS) ? (uint32_t)cpu->index : 0u;
+
+    paging_kmap_cpu_t* km = &paging_kmap_cpus[cpu_idx];
+    if (unlikely(km->depth >= PAGING_KMAP_SLOTS)) {
+        paging_halt("paging_kmap_atomic: slots exhausted");
     }
 
-    uint32_t pt_idx = (virt >> 12) & 0x3FFu;
-    pt[pt_idx] = (phys & ~0xFFFu) | PTE_PRESENT | PTE_RW;
+    const uint32_t slot = cpu_idx * PAGING_KMAP_SLOTS + km->depth;
+    const uint32_t virt = PAGING_KMAP_BASE + slot * 4096u;
+
+    km->irq_flags[km->depth++] = irq_flags;
+
+    pte_store(&paging_kmap_ptes[slot], paging_make_pte(phys, PTE_PRESENT | PTE_RW));
 
     __asm__ volatile("invlpg (%0)" :: "r" (virt) : "memory");
+
+    return (void*)virt;
 }
 
-static void paging_fixmap_clear(uint32_t virt) {
-    uint32_t* pt = paging_pt_virt(kernel_page_directory, virt);
-    if (!pt) {
-        paging_halt("paging_fixmap_clear: missing PT");
+void paging_kunmap_atomic(void* addr) {
+    const uint32_t virt = (uint32_t)(uintptr_t)addr & ~0xFFFu;
+
+    if (virt < PAGING_KMAP_BASE || virt >= PAGING_KMAP_END) {
+        return;
     }
 
-    uint32_t pt_idx = (virt >> 12) & 0x3FFu;
-    pt[pt_idx] = 0;
+    const uint32_t slot = (virt - PAGING_KMAP_BASE) >> 12;
+
+    paging_kmap_cpu_t* km = &paging_kmap_cpus[slot / PAGING_KMAP_SLOTS];
+
+    pte_store(&paging_kmap_ptes[slot], 0u);
 
     __asm__ volatile("invlpg (%0)" :: "r" (virt) : "memory");
-}
 
-static inline int paging_is_enabled(void) {
-    uint32_t cr0;
-    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
-    return ((cr0 & (1u << 31)) != 0u) ? 1 : 0;
+    const uint32_t irq_flags = km->irq_flags[--km->depth];
+
+    __asm__ volatile("pushl %0; popfl" : : "r"(irq_flags) : "memory");
 }
 
-void paging_zero_phys_page(uint32_t phys) {
+void paging_zero_phys_page(phys_addr_t phys) {
     /*
-     * This is used for freshly allocated page tables/directories.
+     * Used for freshly allocated page tables/directories and user pages.
      *
      * Before paging is enabled, the kernel still runs with a trivial physical
-     * identity map, so phys is directly writable. After paging, we bounce
-     * through the fixmap.
+     * identity map, so phys is directly writable. After paging, we go
+     * through a temporary mapping (free for low memory).
      */
     if ((phys & 0xFFFu) != 0u) {
         paging_halt("paging_zero_phys_page: unaligned phys");
     }
 
     if (!paging_is_enabled()) {
-        memzero_nt_page((void*)phys);
+        memzero_nt_page((void*)(uintptr_t)phys);
         return;
     }
 
-    if (!kernel_page_directory) {
-        paging_halt("paging_zero_phys_page: kernel_page_directory not set");
-    }
+    void* virt = paging_kmap_atomic(phys);
 
-    uint32_t virt = paging_fixmap_virt();
+    memzero_nt_page(virt);
 
-    paging_fixmap_set(virt, phys);
-    memzero_nt_page((void*)virt);
-    paging_fixmap_clear(virt);
+    paging_kunmap_atomic(virt);
 }
 
 __attribute__((noreturn)) static void paging_halt(const char* msg) {
@@ -734,6 +1085,68 @@ void paging_init_mtrr_wc(uint32_t phys_base, uint32_t size) {
     __asm__ volatile("pushl %0; popfl" : : "r"(flags) : "memory");
 }
 
+#define IA32_EFER_MSR 0xC0000080u
+#define EFER_NXE      (1ull << 11)
+
+#define CR4_PAE       (1u << 5)
+
+static inline void paging_enable_nxe_local(void) {
+    const uint64_t efer = paging_rdmsr_u64(IA32_EFER_MSR);
+
+    if ((efer & EFER_NXE) == 0u) {
+        paging_wrmsr_u64(IA32_EFER_MSR, efer | EFER_NXE);
+    }
+}
+
+#ifdef KERNEL_PAE
+
+static void paging_setup_pae(void) {
+    uint32_t a, b, c, d;
+
+    paging_cpuid(1, 0, &a, &b, &c, &d);
+    if ((d & (1u << 6)) == 0u) {
+        paging_halt("paging_init: CPU lacks PAE");
+    }
+
+    paging_cpuid(0x80000000u, 0, &a, &b, &c, &d);
+    if (a >= 0x80000001u) {
+        paging_cpuid(0x80000001u, 0, &a, &b, &c, &d);
+
+        if ((d & (1u << 20)) != 0u) {
+            paging_enable_nxe_local();
+
+            paging_nx_active = 1;
+        }
+    }
+
+    uint32_t cr4;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= CR4_PAE;
+    __asm__ volatile("mov %0, %%cr4" : : "r"(cr4) : "memory");
+}
+
+#endif
+
+int paging_nx_enabled(void) {
+    return paging_nx_active;
+}
+
+uint32_t paging_ap_cr4_bits(void) {
+#ifdef KERNEL_PAE
+    return CR4_PAE;
+#else
+    return 0u;
+#endif
+}
+
+void paging_init_ap(void) {
+    paging_init_pat();
+
+    if (paging_nx_active) {
+        paging_enable_nxe_local();
+    }
+}
+
 static inline uint32_t* read_cr3(void) {
     uint32_t val;
     __asm__ volatile("mov %%cr3, %0" : "=r"(val));
@@ -741,25 +1154,21 @@ static inline uint32_t* read_cr3(void) {
 }
 
 void paging_map_ex(
-    uint32_t* dir, uint32_t virt, uint32_t phys,
+    uint32_t* dir, uint32_t virt, phys_addr_t phys,
     uint32_t flags, uint32_t map_flags
 ) {
-    uint32_t pd_idx = virt >> 22;
-    uint32_t pt_idx = (virt >> 12) & 0x3FFu;
-    
-    uint32_t pde = paging_ensure_pt(dir, pd_idx);
-    uint32_t* pt = (uint32_t*)(pde & ~0xFFFu);
-    
-    uint32_t expected = 0;
-    uint32_t desired = (phys & ~0xFFFu) | flags;
-    
-    if (!__atomic_compare_exchange_n(&pt[pt_idx], &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+    const pte_t pde = paging_ensure_pt(dir, virt);
+    volatile pte_t* slot = paging_pte_slot(pde, virt);
+
+    const pte_t desired = paging_make_pte(phys, flags);
+
+    if (!pte_cmpxchg(slot, 0u, desired)) {
         spinlock_t* pt_lock = paging_get_pt_lock(pde);
 
         uint32_t int_flags = spinlock_acquire_safe(pt_lock);
-        
-        __atomic_store_n(&pt[pt_idx], desired, __ATOMIC_RELEASE);
-        
+
+        pte_store(slot, desired);
+
         spinlock_release_safe(pt_lock, int_flags);
     }
 
@@ -771,7 +1180,7 @@ void paging_map_ex(
         }
     }
 }
-void paging_map(uint32_t* dir, uint32_t virt, uint32_t phys, uint32_t flags) {
+void paging_map(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags) {
     paging_map_ex(dir, virt, phys, flags, 0u);
 }
 
@@ -789,24 +1198,21 @@ void paging_map_batch(
     while (pages_done < count) {
         uint32_t virt = virt_start + (pages_done << 12);
 
-        uint32_t pd_idx = virt >> 22;
-        uint32_t pt_idx = (virt >> 12) & 0x3FFu;
+        uint32_t pt_idx = (virt >> 12) & (PAGING_PT_ENTRIES - 1u);
 
-        uint32_t chunk_size = 1024u - pt_idx;
+        uint32_t chunk_size = PAGING_PT_ENTRIES - pt_idx;
         if (chunk_size > count - pages_done) chunk_size = count - pages_done;
 
-        uint32_t pde = paging_ensure_pt(dir, pd_idx);
-        
+        pte_t pde = paging_ensure_pt(dir, virt);
+
         spinlock_t* pt_lock = paging_get_pt_lock(pde);
 
         uint32_t pt_int_flags = spinlock_acquire_safe(pt_lock);
 
-        uint32_t* pt = (uint32_t*)(pde & ~0xFFFu);
+        volatile pte_t* pt = paging_pte_slot(pde, virt);
 
         for (uint32_t i = 0; i < chunk_size; i++) {
-            uint32_t new_pte = (phys_array[pages_done + i] & ~0xFFFu) | flags;
-
-            __atomic_store_n(&pt[pt_idx + i], new_pte, __ATOMIC_RELEASE);
+            pte_store(&pt[i], paging_make_pte(phys_array[pages_done + i], flags));
         }
 
         spinlock_release_safe(pt_lock, pt_int_flags);
@@ -825,32 +1231,69 @@ void paging_map_batch(
     }
 }
 
-void paging_map_4m(uint32_t* dir, uint32_t virt, uint32_t phys, uint32_t flags) {
+void paging_map_huge(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags) {
     if (!dir) return;
 
-    uint32_t pd_idx = virt >> 22;
+    volatile pte_t* slot = paging_pde_slot(dir, virt);
+    if (unlikely(!slot)) return;
+
     uint32_t int_flags = paging_lock_dir_safe(dir);
 
-    dir[pd_idx] = (phys & ~0x3FFFFFu) | flags | (1u << 7);
+    pte_store(slot, paging_make_pte(phys & ~(phys_addr_t)PAGING_HUGE_MASK, flags) | PTE_SUPER);
 
     paging_unlock_dir_safe(dir, int_flags);
 
     if (dir == kernel_page_directory) {
-        smp_tlb_shootdown_range(virt, virt + 0x400000u);
+        smp_tlb_shootdown_range(virt, virt + PAGING_HUGE_SIZE);
     } else {
         __asm__ volatile("invlpg (%0)" :: "r" (virt) : "memory");
     }
 }
 
+int paging_map_new(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags) {
+    if (unlikely(!dir)) {
+        return 0;
+    }
+
+    const pte_t pde = paging_ensure_pt(dir, virt);
+
+    if ((pde & PTE_SUPER) != 0u) {
+        return 0;
+    }
+
+    return pte_cmpxchg(paging_pte_slot(pde, virt), 0u, paging_make_pte(phys, flags));
+}
+
+int paging_map_huge_new(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags) {
+    if (unlikely(!dir)) {
+        return 0;
+    }
+
+    volatile pte_t* slot = paging_pde_slot(dir, virt);
+    if (unlikely(!slot)) {
+        return 0;
+    }
+
+    const pte_t desired = paging_make_pte(phys & ~(phys_addr_t)PAGING_HUGE_MASK, flags) | PTE_SUPER;
+
+    uint32_t int_flags = paging_lock_dir_safe(dir);
+
+    const int ok = pte_cmpxchg(slot, 0u, desired);
+
+    paging_unlock_dir_safe(dir, int_flags);
+
+    return ok;
+}
+
 static void paging_allocate_table(uint32_t virt) {
     /*
      * Ensure the kernel directory has a page table for `virt`.
      *
-     * This is used to pre-create the fixmap tables and a kernel window used by
+     * This is used to pre-create the kmap tables and a kernel window used by
      * higher-level allocators.
      */
-    uint32_t pd_idx = virt >> 22;
-    if ((kernel_page_directory[pd_idx] & 1u) != 0u) {
+    volatile pte_t* slot = &kernel_pdes[virt >> PAGING_PDE_SHIFT];
+    if ((pte_load(slot) & PTE_PRESENT) != 0u) {
         return;
     }
 
@@ -862,8 +1305,8 @@ static void paging_allocate_table(uint32_t virt) {
     paging_zero_phys_page((uint32_t)new_pt_phys);
 
     uint32_t int_flags = spinlock_acquire_safe(&paging_lock);
-    if ((kernel_page_directory[pd_idx] & 1u) == 0u) {
-        kernel_page_directory[pd_idx] = ((uint32_t)new_pt_phys) | 7u;
+    if ((pte_load(slot) & PTE_PRESENT) == 0u) {
+        pte_store(slot, (pte_t)(uint32_t)new_pt_phys | PTE_PRESENT | PTE_RW | PTE_USER);
         new_pt_phys = 0;
     }
     spinlock_release_safe(&paging_lock, int_flags);
@@ -878,8 +1321,9 @@ void paging_init(uint32_t ram_size_bytes) {
      * Early identity map.
      *
      * Boot code expects RAM to be reachable by physical addresses while we are
-     * still bringing the memory management up. We map [0..ram_size_bytes) as
-     * supervisor RW, then switch to this directory and enable paging.
+     * still bringing the memory management up. We map low memory as
+     * supervisor RW, then switch to this directory and enable paging. Anything
+     * above PMM_LOWMEM_LIMIT is left to the HIGHMEM zone and kmap.
      */
     paging_init_pat();
     spinlock_init(&paging_lock);
@@ -890,47 +1334,60 @@ void paging_init(uint32_t ram_size_bytes) {
     }
     paging_ram_size_bytes = ram_size_bytes;
 
-    kernel_page_directory = page_dir;
+    paging_lowmem_end = (ram_size_bytes < PMM_LOWMEM_LIMIT) ? ram_size_bytes : PMM_LOWMEM_LIMIT;
 
-    for(int i = 0; i < 1024; i++) {
+#ifdef KERNEL_PAE
+    paging_setup_pae();
+
+    /* PDPTEs only take P, PWT and PCD; everything else is reserved. */
+    for (uint32_t i = 0; i < PAGING_PDPT_ENTRIES; i++) {
+        kernel_pdpt[i] = (pte_t)(uint32_t)&kernel_pdes[i * PAGING_PT_ENTRIES] | PTE_PRESENT;
+    }
+
+    kernel_page_directory = (uint32_t*)kernel_pdpt;
+#else
+    kernel_page_directory = (uint32_t*)kernel_pdes;
+#endif
+
+    for (uint32_t i = 0; i < PAGING_KERNEL_PDES; i++) {
         /*
          * Default to supervisor, read-only, not-present (bit1=RW).
          *
          * This keeps the directory clean while still allowing a cheap
          * non-zero sentinel for debugging.
          */
-        page_dir[i] = 2; 
+        kernel_pdes[i] = PTE_RW;
     }
 
-    uint32_t aligned_ram = (ram_size_bytes + 0x3FFFFFu) & ~0x3FFFFFu;
-    for(uint32_t i = 0; i < aligned_ram; i += 0x400000u) { 
-        uint32_t pd_idx = i >> 22;
-        
-        page_dir[pd_idx] = i | PTE_PRESENT | PTE_RW | PTE_SUPER | PTE_GLOBAL;
+    uint32_t aligned_ram = (paging_lowmem_end + PAGING_HUGE_MASK) & ~PAGING_HUGE_MASK;
+    for (uint32_t i = 0; i < aligned_ram; i += PAGING_HUGE_SIZE) {
+        kernel_pdes[i >> PAGING_PDE_SHIFT] = (pte_t)i | PTE_PRESENT | PTE_RW | PTE_SUPER | PTE_GLOBAL;
     }
 
     /* Local APIC MMIO is accessed via a fixed physical address on x86. */
-    paging_map(page_dir, 0xFEE00000, 0xFEE00000, PTE_PRESENT | PTE_RW | PTE_PCD | PTE_PWT);
+    paging_map(kernel_page_directory, 0xFEE00000, 0xFEE00000, PTE_PRESENT | PTE_RW | PTE_PCD | PTE_PWT);
 
-    for (uint32_t i = 0; i < PAGING_FIXMAP_SLOTS; i++) {
-        uint32_t virt = PAGING_FIXMAP_BASE - i * 4096u;
+    /* The kmap windows must have their PT before paging turns on. */
+    paging_allocate_table(PAGING_KMAP_BASE);
 
-        /* Ensure fixmap slots have PTs pre-allocated before paging turns on. */
-        paging_allocate_table(virt);
-        paging_fixmap_clear(virt);
-    }
-    
-    for(uint32_t addr = 0xC0000000; addr != 0; addr += 0x400000) {
+    for (uint32_t addr = 0xC0000000; addr != 0; addr += PAGING_HUGE_SIZE) {
         /* Pre-allocate kernel PTs for the heap / early dynamic mappings. */
         paging_allocate_table(addr);
     }
 
-    paging_switch(page_dir);
+    const pte_t kmap_pde = kernel_pdes[PAGING_KMAP_BASE >> PAGING_PDE_SHIFT];
+    if ((kmap_pde & PTE_PRESENT) == 0u) {
+        paging_halt("paging_init: no kmap page table");
+    }
+
+    paging_kmap_ptes = paging_pte_slot(kmap_pde, PAGING_KMAP_BASE);
+
+    paging_switch(kernel_page_directory);
     enable_paging();
 }
 
 void paging_switch(uint32_t* dir_phys) {
-    /* CR3 expects a physical address aligned to 4KiB. */
+    /* CR3 expects a physical address aligned to 4KiB (32 bytes for a PDPT). */
     load_page_directory(dir_phys);
 }
 
@@ -938,6 +1395,30 @@ uint32_t* paging_get_dir(void) {
     return read_cr3();
 }
 
+/* Copy the present PDEs of one kernel page directory into a fresh one. */
+static void paging_copy_kernel_pdes(pte_t* dst, const pte_t* src, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const pte_t pde = pte_load(&src[i]);
+
+        if ((pde & PTE_PRESENT) != 0u) {
+            dst[i] = pde;
+        }
+    }
+}
+
+#ifdef KERNEL_PAE
+
+/*
+ * PDPT slots shared with the kernel by reference: 0 holds the low-memory
+ * identity map (below any user address), 3 the kernel heap and kmap. User
+ * space lives entirely in slots 1 and 2.
+ */
+static inline int paging_pdpt_slot_shared(uint32_t idx) {
+    return idx == 0u || idx == 3u;
+}
+
+#endif
+
 uint32_t* paging_clone_directory(void) {
     /*
      * Clone only present PDEs from the kernel template.
@@ -945,17 +1426,176 @@ uint32_t* paging_clone_directory(void) {
      * This creates a new address space that shares the kernel half with the
      * global directory.
      */
-    uint32_t* new_dir = (uint32_t*)pmm_alloc_block();
+    pte_t* new_dir = (pte_t*)pmm_alloc_block();
     if (!new_dir) return 0;
 
     paging_zero_phys_page((uint32_t)new_dir);
 
-    for (int i = 0; i < 1024; i++) {
-        if (kernel_page_directory[i] & 1) {
-            new_dir[i] = kernel_page_directory[i];
+#ifdef KERNEL_PAE
+    for (uint32_t i = 0; i < PAGING_PDPT_ENTRIES; i++) {
+        if (paging_pdpt_slot_shared(i)) {
+            new_dir[i] = kernel_pdpt[i];
+
+            continue;
+        }
+
+        pte_t* pd = (pte_t*)pmm_alloc_block();
+        if (!pd) {
+            for (uint32_t j = 0; j < i; j++) {
+                if (!paging_pdpt_slot_shared(j)) {
+                    pmm_free_block((void*)(uintptr_t)pte_phys(new_dir[j]));
+                }
+            }
+
+            pmm_free_block(new_dir);
+
+            return 0;
+        }
+
+        paging_zero_phys_page((uint32_t)pd);
+
+        paging_copy_kernel_pdes(pd, &kernel_pdes[i * PAGING_PT_ENTRIES], PAGING_PT_ENTRIES);
+
+        new_dir[i] = (pte_t)(uint32_t)pd | PTE_PRESENT;
+    }
+#else
+    paging_copy_kernel_pdes(new_dir, kernel_pdes, PAGING_KERNEL_PDES);
+#endif
+
+    return (uint32_t*)new_dir;
+}
+
+static void paging_free_pt(pte_t* pt, uint32_t base, int (*visitor)(uint32_t virt, pte_t pte, void* ctx), void* ctx) {
+    for (uint32_t j = 0; j < PAGING_PT_ENTRIES; j++) {
+        const pte_t pte = pt[j];
+
+        if ((pte & PTE_PRESENT) == 0u) {
+            if (pte_is_swap(pte)) {
+                pt[j] = 0u;
+
+                zswap_release_entry(pte_swap_index(pte));
+            }
+
+            continue;
+        }
+
+        pt[j] = 0u;
+
+        if (visitor) {
+            (void)visitor(base + (j << 12), pte, ctx);
+        }
+    }
+
+    pmm_free_block(pt);
+}
+
+/* Release everything a user PDE owns. Entries shared with the kernel are left alone. */
+static void paging_free_user_pdes(pte_t* pd, const pte_t* kernel_pd, uint32_t base, int (*visitor)(uint32_t virt, pte_t pte, void* ctx), void* ctx) {
+    for (uint32_t i = 0; i < PAGING_PT_ENTRIES; i++) {
+        const pte_t pde = pd[i];
+        const uint32_t virt = base + (i << PAGING_PDE_SHIFT);
+
+        if ((pde & PTE_PRESENT) == 0u) {
+            continue;
+        }
+
+        if (pte_phys(kernel_pd[i]) == pte_phys(pde)) {
+            continue;
+        }
+
+        if ((pde & PTE_USER) == 0u) {
+            continue;
+        }
+
+        pd[i] = 0u;
+
+        if ((pde & PTE_SUPER) != 0u) {
+            if (visitor) {
+                (void)visitor(virt, pde, ctx);
+            }
+
+            continue;
+        }
+
+        paging_free_pt((pte_t*)(uintptr_t)pte_phys(pde), virt, visitor, ctx);
+    }
+}
+
+void paging_free_directory(uint32_t* dir, int (*visitor)(uint32_t virt, pte_t pte, void* ctx), void* ctx) {
+    if (!dir || dir == kernel_page_directory) {
+        return;
+    }
+
+#ifdef KERNEL_PAE
+    pte_t* pdpt = (pte_t*)dir;
+
+    for (uint32_t i = 0; i < PAGING_PDPT_ENTRIES; i++) {
+        if (paging_pdpt_slot_shared(i) || (pdpt[i] & PTE_PRESENT) == 0u) {
+            continue;
+        }
+
+        pte_t* pd = (pte_t*)(uintptr_t)pte_phys(pdpt[i]);
+
+        paging_free_user_pdes(pd, &kernel_pdes[i * PAGING_PT_ENTRIES], i << 30, visitor, ctx);
+
+        pmm_free_block(pd);
+    }
+#else
+    paging_free_user_pdes((pte_t*)dir, kernel_pdes, 0u, visitor, ctx);
+#endif
+
+    pmm_free_block(dir);
+}
+
+int paging_sync_kernel_mapping(uint32_t* dir, uint32_t virt) {
+    if (!dir || dir == kernel_page_directory) {
+        return 0;
+    }
+
+    volatile pte_t* slot = paging_pde_slot(dir, virt);
+    if (!slot) {
+        return 0;
+    }
+
+    const pte_t kpde = kernel_pdes[virt >> PAGING_PDE_SHIFT];
+    if ((kpde & PTE_PRESENT) == 0u) {
+        return 0;
+    }
+
+    const pte_t pde = pte_load(slot);
+
+    if ((pde & PTE_PRESENT) == 0u) {
+        /*
+         * Below the kernel half the slot belongs to user space and must not
+         * alias a kernel page table. Shared PDPT slots never get here.
+         */
+        if (virt < 0xC0000000u) {
+            return 0;
         }
+
+        pte_cmpxchg(slot, pde, kpde);
+
+        __asm__ volatile("invlpg (%0)" :: "r"(virt) : "memory");
+
+        return 1;
+    }
+
+    if ((pde & PTE_SUPER) != 0u || (kpde & PTE_SUPER) != 0u || !paging_pde_pt_phys_valid(pde)) {
+        return 0;
     }
-    return new_dir;
+
+    volatile pte_t* pte_slot = paging_pte_slot(pde, virt);
+    const pte_t kpte = pte_load(paging_pte_slot(kpde, virt));
+
+    if ((kpte & PTE_PRESENT) == 0u || (pte_load(pte_slot) & PTE_PRESENT) != 0u) {
+        return 0;
+    }
+
+    pte_store(pte_slot, kpte);
+
+    __asm__ volatile("invlpg (%0)" :: "r"(virt) : "memory");
+
+    return 1;
 }
 
 int paging_is_user_accessible(uint32_t* dir, uint32_t virt) {
@@ -963,64 +1603,68 @@ int paging_is_user_accessible(uint32_t* dir, uint32_t virt) {
      * A mapping is considered user-accessible only if both PDE and PTE have the
      * user bit set.
      */
-    uint32_t pd_idx = virt >> 22;
-    uint32_t pt_idx = (virt >> 12) & 0x3FF;
+    const pte_t pde = paging_load_pde(dir, virt);
 
-    if (!(dir[pd_idx] & 1)) return 0;
-    if (!(dir[pd_idx] & 4)) return 0;
+    if (!(pde & PTE_PRESENT)) return 0;
+    if (!(pde & PTE_USER)) return 0;
 
-    if ((dir[pd_idx] & (1u << 7)) != 0u) {
-        /* 4MiB PDE (PSE): user bit is checked at the PDE level. */
+    if ((pde & PTE_SUPER) != 0u) {
+        /* Large PDE: user bit is checked at the PDE level. */
         return 1;
     }
 
-    uint32_t pde = dir[pd_idx];
     if (!paging_pde_pt_phys_valid(pde)) return 0;
 
-    uint32_t* pt = (uint32_t*)(pde & ~0xFFFu);
-    if (!(pt[pt_idx] & 1)) return 0;
-    if (!(pt[pt_idx] & 4)) return 0;
+    const pte_t pte = pte_load(paging_pte_slot(pde, virt));
+    if (!(pte & PTE_PRESENT)) return 0;
+    if (!(pte & PTE_USER)) return 0;
 
     return 1;
 }
 
-uint32_t paging_get_phys(uint32_t* dir, uint32_t virt) {
-    /* Translate a virtual address under a specific directory. */
-    uint32_t pd_idx = virt >> 22;
-    uint32_t pt_idx = (virt >> 12) & 0x3FF;
+int paging_is_mapped(uint32_t* dir, uint32_t virt) {
+    if (!dir) {
+        return 0;
+    }
+
+    const pte_t pde = paging_load_pde(dir, virt);
 
-    uint32_t pde = dir[pd_idx];
-    if ((pde & 1u) == 0u) return 0;
+    if ((pde & PTE_PRESENT) == 0u) return 0;
+    if ((pde & PTE_SUPER) != 0u) return 1;
+    if (!paging_pde_pt_phys_valid(pde)) return 0;
+
+    return (pte_load(paging_pte_slot(pde, virt)) & PTE_PRESENT) != 0u;
+}
 
-    if ((pde & (1u << 7)) != 0u) {
-        /* 4MiB page: physical base is in 4MiB units; offset is low 22 bits. */
-        uint32_t base = pde & 0xFFC00000u;
-        return base + (virt & 0x003FFFFFu);
+phys_addr_t paging_get_phys(uint32_t* dir, uint32_t virt) {
+    /* Translate a virtual address under a specific directory. */
+    const pte_t pde = paging_load_pde(dir, virt);
+    if ((pde & PTE_PRESENT) == 0u) return 0;
+
+    if ((pde & PTE_SUPER) != 0u) {
+        /* Large page: the offset is everything below the page size. */
+        return pde_huge_phys(pde) + (virt & PAGING_HUGE_MASK);
     }
 
     if (!paging_pde_pt_phys_valid(pde)) return 0;
 
-    uint32_t* pt = (uint32_t*)(pde & ~0xFFFu);
-    uint32_t pte = pt[pt_idx];
-    if ((pte & 1u) == 0u) return 0;
+    const pte_t pte = pte_load(paging_pte_slot(pde, virt));
+    if ((pte & PTE_PRESENT) == 0u) return 0;
 
-    return (pte & ~0xFFFu) + (virt & 0xFFFu);
+    return pte_phys(pte) + (virt & 0xFFFu);
 }
 
-int paging_get_present_pte(uint32_t* dir, uint32_t virt, uint32_t* out_pte) {
+int paging_get_present_pte(uint32_t* dir, uint32_t virt, pte_t* out_pte) {
     if (!dir) {
         return 0;
     }
 
-    uint32_t pd_idx = virt >> 22;
-    uint32_t pt_idx = (virt >> 12) & 0x3FFu;
-
-    uint32_t pde = dir[pd_idx];
-    if ((pde & 1u) == 0u) {
+    const pte_t pde = paging_load_pde(dir, virt);
+    if ((pde & PTE_PRESENT) == 0u) {
         return 0;
     }
 
-    if ((pde & (1u << 7)) != 0u) {
+    if ((pde & PTE_SUPER) != 0u) {
         return 0;
     }
 
@@ -1028,9 +1672,8 @@ int paging_get_present_pte(uint32_t* dir, uint32_t virt, uint32_t* out_pte) {
         return 0;
     }
 
-    uint32_t* pt = (uint32_t*)(pde & ~0xFFFu);
-    uint32_t pte = pt[pt_idx];
-    if ((pte & 1u) == 0u) {
+    const pte_t pte = pte_load(paging_pte_slot(pde, virt));
+    if ((pte & PTE_PRESENT) == 0u) {
         return 0;
     }
 
@@ -1039,4 +1682,4 @@ int paging_get_present_pte(uint32_t* dir, uint32_t virt, uint32_t* out_pte) {
     }
 
     return 1;
-}
\ No newline at end of file
+}
@@ -6,6 +6,8 @@
 
 #include <stdint.h>
 
+#include <lib/types.h>
+
 /*
  * i386 paging.
  *
@@ -13,11 +15,23 @@
  * directories/tables in 32-bit mode.
  *
  * The code intentionally keeps the contract small:
- *  - the kernel directory is a flat 1:1 map of RAM at boot time
+ *  - the kernel directory is a flat 1:1 map of low memory at boot time
  *  - processes clone the kernel half by copying PDEs
  *  - map/unmap operations are responsible for local TLB invalidation, while
  *    global kernel mappings additionally require cross-CPU invalidation
  *
+ * Two table formats are supported:
+ *  - classic 2-level tables with 32-bit entries and 4MiB large pages
+ *  - PAE (KERNEL_PAE=1): a 4-entry PDPT over 512-entry directories and tables
+ *    with 64-bit entries, 2MiB large pages, NX and 36+ bit physical addresses
+ *
+ * A directory handle (`uint32_t* dir`) is always the CR3 value: the page
+ * directory itself, or the PDPT in PAE mode. Code outside paging.c must not
+ * index it directly; use the pde/pte helpers below.
+ *
+ * RAM above PMM_LOWMEM_LIMIT is not identity-mapped. Such frames are only
+ * handed out for user pages and must be accessed through paging_kmap_atomic().
+ *
  * Higher layers (proc/vmm/heap) build policy on top of this.
  */
 
@@ -36,22 +50,180 @@ extern "C" {
 #define PTE_USER    0x004u
 #define PTE_PWT     0x008u
 #define PTE_PCD     0x010u
+#define PTE_ACCESSED 0x020u
+#define PTE_DIRTY   0x040u
 #define PTE_PAT     0x080u
 #define PTE_SUPER   0x080u
 #define PTE_GLOBAL  0x100u
 
+/*
+ * Software no-execute bit (AVL bit 11).
+ *
+ * Mapping helpers translate it into the hardware NX bit when PAE paging is
+ * active and the CPU supports NX; in 2-level mode it is only a marker.
+ */
+#define PTE_NOEXEC  0x800u
+
+#ifdef KERNEL_PAE
+
+typedef uint64_t pte_t;
+
+#define PAGING_PDE_SHIFT   21u
+#define PAGING_PT_ENTRIES  512u
+
+#define PTE_ADDR_MASK      0x000FFFFFFFFFF000ull
+#define PTE_NX             0x8000000000000000ull
+
+#else
+
+typedef uint32_t pte_t;
+
+#define PAGING_PDE_SHIFT   22u
+#define PAGING_PT_ENTRIES  1024u
+
+#define PTE_ADDR_MASK      0xFFFFF000u
+#define PTE_NX             0u
+
+#endif
+
+/* Large page geometry: 4MiB in 2-level mode, 2MiB with PAE. */
+#define PAGING_HUGE_SIZE   (1u << PAGING_PDE_SHIFT)
+#define PAGING_HUGE_MASK   (PAGING_HUGE_SIZE - 1u)
+#define PAGING_HUGE_ORDER  (PAGING_PDE_SHIFT - 12u)
+#define PAGING_HUGE_PAGES  (1u << PAGING_HUGE_ORDER)
+
+static inline phys_addr_t pte_phys(pte_t pte) {
+    return (phys_addr_t)(pte & PTE_ADDR_MASK);
+}
+
+static inline phys_addr_t pde_huge_phys(pte_t pde) {
+    return (phys_addr_t)(pde & PTE_ADDR_MASK) & ~(phys_addr_t)PAGING_HUGE_MASK;
+}
+
+static inline uint32_t pte_flags(pte_t pte) {
+    return (uint32_t)pte & 0xFFFu;
+}
+
+/*
+ * Entry access.
+ *
+ * 64-bit entries cannot be loaded or stored in one instruction without
+ * SSE/x87, so PAE entries are read with a torn-read retry and updated
+ * with cmpxchg8b. With 32-bit entries these are plain atomics.
+ */
+#ifdef KERNEL_PAE
+
+static inline pte_t pte_load(const volatile pte_t* p) {
+    const volatile uint32_t* w = (const volatile uint32_t*)p;
+
+    uint32_t lo;
+    uint32_t hi;
+
+    do {
+        lo = w[0];
+        __asm__ volatile("" ::: "memory");
+        hi = w[1];
+        __asm__ volatile("" ::: "memory");
+    } while (lo != w[0]);
+
+    return ((pte_t)hi << 32) | lo;
+}
+
+static inline int pte_cmpxchg(volatile pte_t* p, pte_t expected, pte_t desired) {
+    return __sync_bool_compare_and_swap(p, expected, desired);
+}
+
+static inline pte_t pte_xchg(volatile pte_t* p, pte_t desired) {
+    pte_t old = pte_load(p);
+
+    for (;;) {
+        const pte_t seen = __sync_val_compare_and_swap(p, old, desired);
+        if (seen == old) {
+            return old;
+        }
+
+        old = seen;
+    }
+}
+
+#else
+
+static inline pte_t pte_load(const volatile pte_t* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline int pte_cmpxchg(volatile pte_t* p, pte_t expected, pte_t desired) {
+    return __atomic_compare_exchange_n(
+        p, &expected, desired,
+        0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED
+    );
+}
+
+static inline pte_t pte_xchg(volatile pte_t* p, pte_t desired) {
+    return __atomic_exchange_n(p, desired, __ATOMIC_ACQ_REL);
+}
+
+#endif
+
+static inline void pte_store(volatile pte_t* p, pte_t value) {
+    (void)pte_xchg(p, value);
+}
+
+static inline void pte_clear_bits(volatile pte_t* p, uint32_t bits) {
+    pte_t old = pte_load(p);
+
+    while ((old & bits) != 0u && !pte_cmpxchg(p, old, old & ~(pte_t)bits)) {
+        old = pte_load(p);
+    }
+}
+
+/*
+ * Swap entries.
+ *
+ * A non-present user PTE with PTE_SWAP set does not map anything: bits 12..31
+ * carry a zswap entry index instead of a frame number. Index 0 is reserved as
+ * a "busy" marker for a page that is in the middle of being swapped out or in;
+ * whoever installed the marker owns the page and resolves it. PTE_NOEXEC is
+ * carried over from the mapping the entry replaced.
+ */
+#define PTE_SWAP    0x400u
+
+#define PTE_SWAP_BUSY PTE_SWAP
+
+static inline int pte_is_swap(pte_t pte) {
+    return (pte & (PTE_PRESENT | PTE_SWAP)) == PTE_SWAP;
+}
+
+static inline uint32_t pte_swap_index(pte_t pte) {
+    return (uint32_t)pte >> 12;
+}
+
+static inline pte_t pte_make_swap(uint32_t index) {
+    return (pte_t)((index << 12) | PTE_SWAP);
+}
+
 /* paging_map_ex() flags. */
 #define PAGING_MAP_NO_TLB_FLUSH 0x00000001u
 
 /* Build identity+kernel mappings and switch to the initial kernel directory. */
 void paging_init(uint32_t ram_size_bytes);
 
+/*
+ * Per-CPU paging state for APs: PAT and, with PAE, EFER.NXE. CR4.PAE itself is
+ * set by the trampoline from the value returned by paging_ap_cr4_bits().
+ */
+void paging_init_ap(void);
+uint32_t paging_ap_cr4_bits(void);
+
 /* Configure PAT to make a WC memory type available for selected mappings. */
 void paging_init_pat(void);
 
 /* Query CPU support for PAT. The result is cached after the first call. */
 int paging_pat_is_supported(void);
 
+/* 1 when PTE_NOEXEC mappings are enforced by hardware. */
+int paging_nx_enabled(void);
+
 /*
  * Program one variable MTRR as WC for a physical range.
  *
@@ -71,6 +243,19 @@ uint32_t* paging_get_dir(void);
  */
 uint32_t* paging_clone_directory(void); 
 
+/*
+ * Tear down a directory created by paging_clone_directory().
+ *
+ * Every present user leaf that is not shared with the kernel template is
+ * passed to `visitor` (large pages with PTE_SUPER set) so the caller can
+ * release the frame; swap entries are released here. Page tables and the
+ * directory itself are freed afterwards.
+ */
+void paging_free_directory(uint32_t* dir, int (*visitor)(uint32_t virt, pte_t pte, void* ctx), void* ctx);
+
+/* Build a leaf entry, translating PTE_NOEXEC into NX where supported. */
+pte_t paging_make_pte(phys_addr_t phys, uint32_t flags);
+
 /*
  * Map a 4KiB page.
  *
@@ -78,7 +263,7 @@ uint32_t* paging_clone_directory(void);
  * `virt` and `phys` are 4KiB-aligned.
  * `flags` are the PTE flags (PTE_PRESENT is expected for valid mappings).
  */
-void paging_map(uint32_t* dir, uint32_t virt, uint32_t phys, uint32_t flags);
+void paging_map(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags);
 
 void paging_map_batch(
     uint32_t* dir, uint32_t virt_start,
@@ -88,13 +273,23 @@ void paging_map_batch(
 
 void paging_map_ex(
     uint32_t* dir, uint32_t virt,
-    uint32_t phys, uint32_t flags,
+    phys_addr_t phys, uint32_t flags,
     uint32_t map_flags
 );
 
-void paging_map_4m(uint32_t* dir, uint32_t virt, uint32_t phys, uint32_t flags);
+/* Map one large page (PAGING_HUGE_SIZE bytes, naturally aligned). */
+void paging_map_huge(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags);
 
-typedef int (*paging_unmap_visitor_t)(uint32_t virt, uint32_t pte, void* ctx);
+/*
+ * Fault-side variants: install the entry only if the slot is still empty.
+ * Threads of one process fault concurrently without any mm-wide lock, so the
+ * loser of a race gets 0 back and must free its frame. No TLB flush is done;
+ * a non-present entry is never cached.
+ */
+int paging_map_new(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags);
+int paging_map_huge_new(uint32_t* dir, uint32_t virt, phys_addr_t phys, uint32_t flags);
+
+typedef int (*paging_unmap_visitor_t)(uint32_t virt, pte_t pte, void* ctx);
 
 void paging_unmap_range_ex(
     uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr,
@@ -108,27 +303,127 @@ void paging_unmap_range_no_tlb(
     paging_unmap_visitor_t visitor, void* visitor_ctx
 );
 
-/* Zero a physical page, using a temporary fixmap mapping once paging is on. */
-void paging_zero_phys_page(uint32_t phys);
+/*
+ * TLB gather.
+ *
+ * An operation that unmaps several ranges (munmap across regions, madvise,
+ * sbrk shrink) records them in a gather and pays for a single cross-CPU
+ * shootdown in paging_tlb_gather_finish(). Large frames released by the
+ * visitor are parked in the gather and only freed after that flush, since
+ * other CPUs can write through stale translations until then.
+ *
+ * A gather lives on the caller's stack and must be finished before the
+ * caller sleeps or returns.
+ */
+#define PAGING_GATHER_FRAMES 8u
+
+typedef struct {
+    uint32_t* dir;
+
+    uint32_t start;
+    uint32_t end;
+
+    uint32_t frame_count;
+    phys_addr_t frames[PAGING_GATHER_FRAMES];
+} paging_tlb_gather_t;
+
+void paging_tlb_gather_init(paging_tlb_gather_t* tlb, uint32_t* dir);
+
+void paging_unmap_range_gather(
+    paging_tlb_gather_t* tlb, uint32_t start_vaddr, uint32_t end_vaddr,
+    paging_unmap_visitor_t visitor, void* visitor_ctx
+);
+
+/* Free a large frame once the gathered ranges have been flushed. */
+void paging_tlb_gather_free_huge(paging_tlb_gather_t* tlb, phys_addr_t phys);
+
+void paging_tlb_gather_finish(paging_tlb_gather_t* tlb);
+
+/*
+ * Drop every PDE covering [start_vaddr, end_vaddr) without looking at what
+ * they map. Only valid for PDEs inherited from the kernel template.
+ */
+void paging_drop_pdes(uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr);
+
+/*
+ * Page-table scanning for reclaim.
+ *
+ * Visit every non-zero entry in [start_vaddr, end_vaddr). PTEs are visited
+ * with the owning page-table lock held, so the callback may rewrite `*entry`.
+ * Large PDEs are visited without any lock held (PTE_SUPER is set in *entry);
+ * the callback may only use atomic read-modify-write on them.
+ *
+ * A non-zero callback return stops the scan. Returns the address at which
+ * scanning stopped, or end_vaddr once the range is exhausted.
+ */
+typedef int (*paging_scan_visitor_t)(uint32_t virt, pte_t* entry, void* ctx);
+
+uint32_t paging_scan_range(
+    uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr,
+    paging_scan_visitor_t visitor, void* visitor_ctx
+);
+
+/*
+ * Replace a user large mapping by a page table mapping the same frames, so
+ * the range can be reclaimed page by page. Returns 1 if the PDE was split.
+ */
+int paging_split_huge(uint32_t* dir, uint32_t virt);
+
+/* Raw PDE covering `virt`. */
+pte_t paging_peek_pde(uint32_t* dir, uint32_t virt);
+
+/* Raw PTE for `virt`, or 0 when there is no page table or the PDE is large. */
+pte_t paging_peek_pte(uint32_t* dir, uint32_t virt);
+
+/* Atomically replace a PTE under its page-table lock. Returns 1 on success. */
+int paging_pte_cmpxchg(uint32_t* dir, uint32_t virt, pte_t expected, pte_t desired);
+
+/* Invalidate a user range on every CPU that may cache translations of `dir`. */
+void paging_flush_user_range(uint32_t* dir, uint32_t start_vaddr, uint32_t end_vaddr);
+
+/*
+ * Copy a kernel PDE or PTE covering `virt` into `dir` if the kernel template
+ * has it and `dir` does not. Used by the fault handler to pick up kernel
+ * mappings created after `dir` was cloned. Whole PDEs are only copied in the
+ * kernel half. Returns 1 if something changed.
+ */
+int paging_sync_kernel_mapping(uint32_t* dir, uint32_t virt);
+
+/*
+ * Temporary mappings.
+ *
+ * Map one physical page into a per-CPU window and return its virtual
+ * address. Low memory is returned as its identity address without touching
+ * the page tables. Interrupts stay disabled until the matching unmap, so the
+ * caller must not sleep; mappings nest and must be released in LIFO order.
+ */
+void* paging_kmap_atomic(phys_addr_t phys);
+void paging_kunmap_atomic(void* virt);
+
+/* Zero a physical page, going through a temporary mapping once paging is on. */
+void paging_zero_phys_page(phys_addr_t phys);
 
 /* Check that a virtual address resolves to a user-accessible mapping. */
 int paging_is_user_accessible(uint32_t* dir, uint32_t virt);
 
+/* Check that a virtual address is mapped at all (4KiB or large page). */
+int paging_is_mapped(uint32_t* dir, uint32_t virt);
+
 /* Translate a virtual address to a physical address. Returns 0 if unmapped. */
-uint32_t paging_get_phys(uint32_t* dir, uint32_t virt);
+phys_addr_t paging_get_phys(uint32_t* dir, uint32_t virt);
 
 /*
  * Get the PTE for a virtual address if present.
  * Returns 1 and stores PTE in *out_pte if the mapping exists, 0 otherwise.
  */
-int paging_get_present_pte(uint32_t* dir, uint32_t virt, uint32_t* out_pte);
+int paging_get_present_pte(uint32_t* dir, uint32_t virt, pte_t* out_pte);
 
 /*
  * Global kernel page directory.
  *
  * This is the directory installed during early boot and used as the reference
- * template for per-process directories. It is also the directory referenced by
- * the fixmap logic.
+ * template for per-process directories. It is also the directory that backs
+ * the temporary mapping windows.
  */
 extern uint32_t* kernel_page_directory;
 
@@ -5,13 +5,14 @@ format binary
 use16
 org 0
 
-    db 0xEB, 0x12 
+    db 0xEB, 0x16 
     db 0x90, 0x90 
     
     stack_ptr: dd 0
     code_ptr: dd 0
     cr3_ptr: dd 0
     arg_ptr: dd 0
+    cr4_bits: dd 0
 
 start_16:
     cli
@@ -53,6 +54,7 @@ start_32:
 
     mov eax, cr4
     or eax, 0x00000090  ; 0x10 (PSE) | 0x80 (PGE)
+    or eax, [ebx + 20]  ; paging mode bits (PAE)
     mov cr4, eax
     
     mov eax, cr0
@@ -174,19 +174,8 @@ static void ensure_mapped_range(uint32_t phys_start, uint32_t length) {
     const uint32_t end_page   = (phys_start + length + 0xFFFu) & ~0xFFFu;
 
     for (uint32_t page = start_page; page < end_page; page += 0x1000u) {
-        const uint32_t pde_idx = page >> 22;
-        const uint32_t pte_idx = (page >> 12) & 0x3FFu;
-
-        uint32_t* pd = kernel_page_directory;
-
-        if ((pd[pde_idx] & 1u) == 0u) {
-            paging_map(pd, page, page, 3u);
-        } else {
-            uint32_t* pt = (uint32_t*)(pd[pde_idx] & ~0xFFFu);
-            
-            if ((pt[pte_idx] & 1u) == 0u) {
-                paging_map(pd, page, page, 3u);
-            }
+        if (!paging_is_mapped(kernel_page_directory, page)) {
+            paging_map(kernel_page_directory, page, page, 3u);
         }
     }
 }
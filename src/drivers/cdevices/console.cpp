@@ -138,6 +138,8 @@ vfs_ops_t console_ops = {
     0,
     0,
     0,
+    0,
+    0,
 };
 
 vfs_node_t console_node = {
@@ -173,7 +175,9 @@ DRIVER_REGISTER(
     .klass = DRIVER_CLASS_CHAR,
     .stage = DRIVER_STAGE_VFS,
     .init = console_driver_init,
-    .shutdown = nullptr
+    .shutdown = nullptr,
+    .after = {},
+    .flags = 0u
 );
 
 }
\ No newline at end of file
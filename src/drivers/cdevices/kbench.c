@@ -0,0 +1,51 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <kernel/kbench.h>
+
+#include <yos/kbench.h>
+
+#include <stdint.h>
+
+static int kbench_dev_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    (void)node;
+
+    if (req == YOS_KBENCH_INFO) {
+        yos_kbench_info_t info;
+        kbench_get_info(&info);
+
+        *(yos_kbench_info_t*)arg = info;
+        return 0;
+    }
+
+    /* Synchronous: results are in the kernel log once this returns. */
+    if (req == YOS_KBENCH_RUN) {
+        return kbench_run();
+    }
+
+    return -1;
+}
+
+static cdevice_t g_kbench_cdev = {
+    .dev = {
+        .name = "kbench",
+    },
+    .ops = {
+        .ioctl = kbench_dev_ioctl,
+    },
+    .node_template = {
+        .name = "kbench",
+    },
+};
+
+static int kbench_driver_init(void) {
+    return cdevice_register(&g_kbench_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "kbench",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = kbench_driver_init,
+    .shutdown = 0
+);
@@ -0,0 +1,74 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <kernel/output/kmsg.h>
+
+#include <mm/heap.h>
+
+#include <stdint.h>
+
+/* Each open gets its own cursor, starting at the oldest record still kept. */
+static void kmsg_reader_release(void* private_data) {
+    if (private_data) {
+        kfree(private_data);
+    }
+}
+
+static int kmsg_dev_open(vfs_node_t* node) {
+    if (!node) {
+        return -1;
+    }
+
+    if (node->private_data) {
+        return 0;
+    }
+
+    kmsg_reader_t* r = (kmsg_reader_t*)kmalloc(sizeof(kmsg_reader_t));
+    if (!r) {
+        return -1;
+    }
+
+    kmsg_reader_init(r);
+
+    node->private_data = r;
+    node->private_release = kmsg_reader_release;
+    node->private_retain = 0;
+
+    return 0;
+}
+
+/* Formatted log lines; 0 once the reader has caught up with the log. */
+static int kmsg_dev_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)offset;
+
+    if (!node || !node->private_data || !buffer) {
+        return -1;
+    }
+
+    return (int)kmsg_read((kmsg_reader_t*)node->private_data, (char*)buffer, size);
+}
+
+static cdevice_t g_kmsg_cdev = {
+    .dev = {
+        .name = "kmsg",
+    },
+    .ops = {
+        .read = kmsg_dev_read,
+        .open = kmsg_dev_open,
+    },
+    .node_template = {
+        .name = "kmsg",
+    },
+};
+
+static int kmsg_driver_init(void) {
+    return cdevice_register(&g_kmsg_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "kmsg",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = kmsg_driver_init,
+    .shutdown = 0
+);
@@ -0,0 +1,99 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <kernel/locking/lockstat.h>
+
+#include <lib/string.h>
+
+#include <yos/lockstat.h>
+
+#include <stdint.h>
+
+/* Classes copied per batch; the copy to the caller happens outside the table walk. */
+#define LOCKSTAT_READ_BATCH 8u
+
+/*
+ * Whole yos_lockstat_class_t records, indexed by the file offset, so a
+ * reader can walk the table from the start with consecutive reads.
+ */
+static int lockstat_dev_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)node;
+
+    if (!buffer) {
+        return -1;
+    }
+
+    const uint32_t rec = (uint32_t)sizeof(yos_lockstat_class_t);
+
+    if (offset % rec != 0u) {
+        return -1;
+    }
+
+    yos_lockstat_class_t batch[LOCKSTAT_READ_BATCH];
+
+    uint8_t* out = (uint8_t*)buffer;
+    uint32_t first = offset / rec;
+    uint32_t done = 0;
+
+    while (size - done >= rec) {
+        uint32_t want = (size - done) / rec;
+        if (want > LOCKSTAT_READ_BATCH) {
+            want = LOCKSTAT_READ_BATCH;
+        }
+
+        const uint32_t got = lockstat_read(first, batch, want);
+        if (got == 0u) {
+            break;
+        }
+
+        memcpy(out + done, batch, got * rec);
+        done += got * rec;
+        first += got;
+    }
+
+    return (int)done;
+}
+
+static int lockstat_dev_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    (void)node;
+
+    if (req == YOS_LOCKSTAT_INFO) {
+        yos_lockstat_info_t info;
+        lockstat_get_info(&info);
+
+        *(yos_lockstat_info_t*)arg = info;
+        return 0;
+    }
+
+    if (req == YOS_LOCKSTAT_RESET) {
+        lockstat_reset();
+        return 0;
+    }
+
+    return -1;
+}
+
+static cdevice_t g_lockstat_cdev = {
+    .dev = {
+        .name = "lockstat",
+    },
+    .ops = {
+        .read = lockstat_dev_read,
+        .ioctl = lockstat_dev_ioctl,
+    },
+    .node_template = {
+        .name = "lockstat",
+    },
+};
+
+static int lockstat_driver_init(void) {
+    return cdevice_register(&g_lockstat_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "lockstat",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = lockstat_driver_init,
+    .shutdown = 0
+);
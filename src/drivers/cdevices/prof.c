@@ -0,0 +1,109 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <kernel/symbols/symbols.h>
+#include <kernel/sampler.h>
+
+#include <lib/string.h>
+
+#include <yos/prof.h>
+
+#include <stdint.h>
+
+/* Samples moved per batch; the copy to the caller happens outside the ring lock. */
+#define PROF_READ_BATCH 8u
+
+/* Stream of whole yos_prof_sample_t records; 0 once the buffers are empty. */
+static int prof_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)node;
+    (void)offset;
+
+    if (!buffer) {
+        return -1;
+    }
+
+    yos_prof_sample_t batch[PROF_READ_BATCH];
+
+    uint8_t* out = (uint8_t*)buffer;
+    uint32_t done = 0;
+
+    while (size - done >= sizeof(yos_prof_sample_t)) {
+        uint32_t want = (size - done) / (uint32_t)sizeof(yos_prof_sample_t);
+        if (want > PROF_READ_BATCH) {
+            want = PROF_READ_BATCH;
+        }
+
+        const uint32_t got = sampler_read(batch, want);
+        if (got == 0u) {
+            break;
+        }
+
+        memcpy(out + done, batch, got * sizeof(yos_prof_sample_t));
+        done += got * (uint32_t)sizeof(yos_prof_sample_t);
+    }
+
+    return (int)done;
+}
+
+static int prof_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    (void)node;
+
+    if (req == YOS_PROF_START) {
+        return sampler_start(*(const uint32_t*)arg);
+    }
+
+    if (req == YOS_PROF_STOP) {
+        sampler_stop();
+        return 0;
+    }
+
+    if (req == YOS_PROF_STATS) {
+        yos_prof_stats_t stats;
+        sampler_get_stats(&stats);
+
+        *(yos_prof_stats_t*)arg = stats;
+        return 0;
+    }
+
+    if (req == YOS_PROF_RESOLVE) {
+        yos_prof_sym_t* sym = (yos_prof_sym_t*)arg;
+
+        uint32_t sym_addr = 0;
+        const char* name = symbols_resolve(sym->addr, &sym_addr);
+
+        if (!name) {
+            return -1;
+        }
+
+        sym->sym_addr = sym_addr;
+        strlcpy(sym->name, name, sizeof(sym->name));
+        return 0;
+    }
+
+    return -1;
+}
+
+static cdevice_t g_prof_cdev = {
+    .dev = {
+        .name = "prof",
+    },
+    .ops = {
+        .read = prof_read,
+        .ioctl = prof_ioctl,
+    },
+    .node_template = {
+        .name = "prof",
+    },
+};
+
+static int prof_driver_init(void) {
+    return cdevice_register(&g_prof_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "prof",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = prof_driver_init,
+    .shutdown = 0
+);
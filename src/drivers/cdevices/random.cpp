@@ -215,7 +215,9 @@ DRIVER_REGISTER(
     .klass = DRIVER_CLASS_CHAR,
     .stage = DRIVER_STAGE_VFS,
     .init = random_driver_init,
-    .shutdown = 0
+    .shutdown = 0,
+    .after = {},
+    .flags = 0u
 );
 
 }
@@ -0,0 +1,76 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <lib/string.h>
+
+#include <yos/rcustat.h>
+
+#include <stdint.h>
+
+extern uint32_t rcu_read_stats(uint32_t first, yos_rcu_cpu_stats_t* out, uint32_t max);
+
+/* CPUs copied per batch. */
+#define RCUSTAT_READ_BATCH 8u
+
+/* Whole yos_rcu_cpu_stats_t records, one per CPU, indexed by the file offset. */
+static int rcustat_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)node;
+
+    if (!buffer) {
+        return -1;
+    }
+
+    const uint32_t rec = (uint32_t)sizeof(yos_rcu_cpu_stats_t);
+
+    if (offset % rec != 0u) {
+        return -1;
+    }
+
+    yos_rcu_cpu_stats_t batch[RCUSTAT_READ_BATCH];
+
+    uint8_t* out = (uint8_t*)buffer;
+    uint32_t first = offset / rec;
+    uint32_t done = 0;
+
+    while (size - done >= rec) {
+        uint32_t want = (size - done) / rec;
+        if (want > RCUSTAT_READ_BATCH) {
+            want = RCUSTAT_READ_BATCH;
+        }
+
+        const uint32_t got = rcu_read_stats(first, batch, want);
+        if (got == 0u) {
+            break;
+        }
+
+        memcpy(out + done, batch, got * rec);
+        done += got * rec;
+        first += got;
+    }
+
+    return (int)done;
+}
+
+static cdevice_t g_rcustat_cdev = {
+    .dev = {
+        .name = "rcustat",
+    },
+    .ops = {
+        .read = rcustat_read,
+    },
+    .node_template = {
+        .name = "rcustat",
+    },
+};
+
+static int rcustat_driver_init(void) {
+    return cdevice_register(&g_rcustat_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "rcustat",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = rcustat_driver_init,
+    .shutdown = 0
+);
@@ -0,0 +1,79 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <mm/heap.h>
+
+#include <lib/string.h>
+
+#include <yos/slabinfo.h>
+
+#include <stdint.h>
+
+/* Caches copied per batch; the copy to the caller happens outside the cache walk. */
+#define SLABINFO_READ_BATCH 8u
+
+/*
+ * Whole yos_slabinfo_t records, indexed by the file offset, so a reader
+ * can walk the caches from the start with consecutive reads.
+ */
+static int slabinfo_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)node;
+
+    if (!buffer) {
+        return -1;
+    }
+
+    const uint32_t rec = (uint32_t)sizeof(yos_slabinfo_t);
+
+    if (offset % rec != 0u) {
+        return -1;
+    }
+
+    yos_slabinfo_t batch[SLABINFO_READ_BATCH];
+
+    uint8_t* out = (uint8_t*)buffer;
+    uint32_t first = offset / rec;
+    uint32_t done = 0;
+
+    while (size - done >= rec) {
+        uint32_t want = (size - done) / rec;
+        if (want > SLABINFO_READ_BATCH) {
+            want = SLABINFO_READ_BATCH;
+        }
+
+        const uint32_t got = kmem_cache_read_stats(first, batch, want);
+        if (got == 0u) {
+            break;
+        }
+
+        memcpy(out + done, batch, got * rec);
+        done += got * rec;
+        first += got;
+    }
+
+    return (int)done;
+}
+
+static cdevice_t g_slabinfo_cdev = {
+    .dev = {
+        .name = "slabinfo",
+    },
+    .ops = {
+        .read = slabinfo_read,
+    },
+    .node_template = {
+        .name = "slabinfo",
+    },
+};
+
+static int slabinfo_driver_init(void) {
+    return cdevice_register(&g_slabinfo_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "slabinfo",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = slabinfo_driver_init,
+    .shutdown = 0
+);
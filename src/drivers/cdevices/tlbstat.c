@@ -0,0 +1,55 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <lib/string.h>
+
+#include <yos/tlbstat.h>
+
+#include <stdint.h>
+
+extern void smp_tlb_get_stats(yos_tlb_stats_t* out);
+
+/* One yos_tlb_stats_t snapshot per open, read from offset 0. */
+static int tlbstat_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)node;
+
+    if (!buffer || offset >= sizeof(yos_tlb_stats_t)) {
+        return 0;
+    }
+
+    yos_tlb_stats_t stats;
+    smp_tlb_get_stats(&stats);
+
+    uint32_t avail = (uint32_t)sizeof(stats) - offset;
+    if (size > avail) {
+        size = avail;
+    }
+
+    memcpy(buffer, (const uint8_t*)&stats + offset, size);
+
+    return (int)size;
+}
+
+static cdevice_t g_tlbstat_cdev = {
+    .dev = {
+        .name = "tlbstat",
+    },
+    .ops = {
+        .read = tlbstat_read,
+    },
+    .node_template = {
+        .name = "tlbstat",
+    },
+};
+
+static int tlbstat_driver_init(void) {
+    return cdevice_register(&g_tlbstat_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "tlbstat",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = tlbstat_driver_init,
+    .shutdown = 0
+);
@@ -0,0 +1,98 @@
+#include <drivers/cdev.h>
+#include <drivers/driver.h>
+
+#include <kernel/trace.h>
+
+#include <lib/string.h>
+
+#include <yos/trace.h>
+
+#include <stdint.h>
+
+/* Events moved per batch; the copy to the caller happens outside the ring lock. */
+#define TRACE_READ_BATCH 16u
+
+/* Stream of whole yos_trace_event_t records; 0 once the buffers are empty. */
+static int trace_dev_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)node;
+    (void)offset;
+
+    if (!buffer) {
+        return -1;
+    }
+
+    yos_trace_event_t batch[TRACE_READ_BATCH];
+
+    uint8_t* out = (uint8_t*)buffer;
+    uint32_t done = 0;
+
+    while (size - done >= sizeof(yos_trace_event_t)) {
+        uint32_t want = (size - done) / (uint32_t)sizeof(yos_trace_event_t);
+        if (want > TRACE_READ_BATCH) {
+            want = TRACE_READ_BATCH;
+        }
+
+        const uint32_t got = trace_read(batch, want);
+        if (got == 0u) {
+            break;
+        }
+
+        memcpy(out + done, batch, got * sizeof(yos_trace_event_t));
+        done += got * (uint32_t)sizeof(yos_trace_event_t);
+    }
+
+    return (int)done;
+}
+
+static int trace_dev_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    (void)node;
+
+    if (req == YOS_TRACE_SET_MASK) {
+        return trace_set_mask(*(const uint32_t*)arg);
+    }
+
+    if (req == YOS_TRACE_GET_MASK) {
+        *(uint32_t*)arg = __atomic_load_n(&g_trace_mask, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    if (req == YOS_TRACE_STATS) {
+        yos_trace_stats_t stats;
+        trace_get_stats(&stats);
+
+        *(yos_trace_stats_t*)arg = stats;
+        return 0;
+    }
+
+    if (req == YOS_TRACE_RESET) {
+        trace_reset();
+        return 0;
+    }
+
+    return -1;
+}
+
+static cdevice_t g_trace_cdev = {
+    .dev = {
+        .name = "trace",
+    },
+    .ops = {
+        .read = trace_dev_read,
+        .ioctl = trace_dev_ioctl,
+    },
+    .node_template = {
+        .name = "trace",
+    },
+};
+
+static int trace_driver_init(void) {
+    return cdevice_register(&g_trace_cdev);
+}
+
+DRIVER_REGISTER(
+    .name = "trace",
+    .klass = DRIVER_CLASS_CHAR,
+    .stage = DRIVER_STAGE_VFS,
+    .init = trace_driver_init,
+    .shutdown = 0
+);
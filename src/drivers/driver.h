@@ -23,6 +23,11 @@ typedef enum {
     DRIVER_CLASS_INPUT = 5,
 } driver_class_t;
 
+/* init may run on a parked AP, concurrently with other drivers of its stage. */
+#define DRIVER_FLAG_ASYNC 0x1u
+
+#define DRIVER_MAX_DEPS 2
+
 typedef struct driver_desc {
     const char* name;
 
@@ -31,6 +36,11 @@ typedef struct driver_desc {
 
     int (*init)(void);
     void (*shutdown)(void);
+
+    /* Drivers of the same stage whose init has to finish first. */
+    const char* after[DRIVER_MAX_DEPS];
+
+    uint32_t flags;
 } driver_desc_t;
 
 typedef struct device {
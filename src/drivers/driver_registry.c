@@ -1,12 +1,44 @@
 #include <drivers/driver.h>
 
+#include <kernel/init/boottime.h>
+#include <kernel/init/boot.h>
+#include <kernel/smp/cpu.h>
 #include <kernel/panic.h>
 
 #include <kernel/output/kprintf.h>
 
+#include <lib/string.h>
+
 extern const driver_desc_t __yosdrivers_start;
 extern const driver_desc_t __yosdrivers_end;
 
+typedef void (*smp_boot_work_fn_t)(void* arg);
+
+extern int smp_boot_work_submit(smp_boot_work_fn_t fn, void* arg);
+
+#define DRIVERS_STAGE_MAX 64u
+
+typedef enum {
+    DRIVER_RUN_PENDING = 0,
+    DRIVER_RUN_RUNNING = 1,
+    DRIVER_RUN_DONE = 2,
+    DRIVER_RUN_REPORTED = 3,
+} driver_run_state_t;
+
+typedef struct {
+    const driver_desc_t* desc;
+
+    volatile uint32_t state;
+
+    int rc;
+    int cpu;
+
+    uint64_t cycles;
+} driver_run_t;
+
+/* Stages only ever run from the boot CPU, one at a time. */
+static driver_run_t g_runs[DRIVERS_STAGE_MAX];
+
 static const driver_desc_t* drivers_begin(void) {
     return &__yosdrivers_start;
 }
@@ -19,61 +51,204 @@ static int stage_is_critical(driver_stage_t stage) {
     return stage == DRIVER_STAGE_EARLY || stage == DRIVER_STAGE_CORE;
 }
 
+static void driver_run_one(void* arg) {
+    driver_run_t* r = (driver_run_t*)arg;
+    cpu_t* cpu = cpu_current();
+
+    const uint64_t t0 = boottime_clock();
+
+    r->rc = r->desc->init();
+    r->cycles = boottime_clock() - t0;
+    r->cpu = cpu ? cpu->index : 0;
+
+    __atomic_store_n(&r->state, DRIVER_RUN_DONE, __ATOMIC_RELEASE);
+}
+
+static void driver_report(driver_stage_t stage, driver_run_t* r) {
+    const driver_desc_t* it = r->desc;
+    const int rc = r->rc;
+
+    boottime_probe(it->name, r->cpu, r->cycles);
+
+    if (rc >= 0) {
+        if (it->name) {
+            kprintf(
+                "[drivers] inited: %s stage=%u class=%u rc=%d cpu=%d\n",
+                it->name,
+                (unsigned)it->stage,
+                (unsigned)it->klass,
+                rc,
+                r->cpu
+            );
+        } else {
+            kprintf(
+                "[drivers] init ok: <noname> stage=%u class=%u rc=%d cpu=%d\n",
+                (unsigned)it->stage,
+                (unsigned)it->klass,
+                rc,
+                r->cpu
+            );
+        }
+
+        return;
+    }
+
+    if (stage_is_critical(stage)) {
+        panic("driver init failed");
+    }
+
+    if (it->name) {
+        kprintf(
+            "[drivers] init failed: %s stage=%u class=%u rc=%d\n",
+            it->name,
+            (unsigned)it->stage,
+            (unsigned)it->klass,
+            rc
+        );
+    } else {
+        kprintf(
+            "[drivers] init failed: <noname> stage=%u class=%u rc=%d\n",
+            (unsigned)it->stage,
+            (unsigned)it->klass,
+            rc
+        );
+    }
+}
+
+/*
+ * A dependency is met once the named driver of this stage has finished,
+ * whatever its result. Names that are not part of the stage were either
+ * run by an earlier stage or are not built in.
+ */
+static int driver_deps_done(const driver_run_t* runs, uint32_t count, const driver_desc_t* d) {
+    for (uint32_t k = 0; k < DRIVER_MAX_DEPS; k++) {
+        const char* dep = d->after[k];
+
+        if (!dep) {
+            continue;
+        }
+
+        for (uint32_t j = 0; j < count; j++) {
+            const driver_desc_t* other = runs[j].desc;
+
+            if (!other->name || strcmp(other->name, dep) != 0) {
+                continue;
+            }
+
+            if (__atomic_load_n(&runs[j].state, __ATOMIC_ACQUIRE) < DRIVER_RUN_DONE) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Start whatever is ready, in link order. Async drivers go to parked APs
+ * while one is free; everything else runs right here. Returns non-zero if
+ * anything was started.
+ */
+static int drivers_dispatch(driver_run_t* runs, uint32_t count, int async_ok) {
+    int started = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        driver_run_t* r = &runs[i];
+
+        if (r->state != DRIVER_RUN_PENDING || !driver_deps_done(runs, count, r->desc)) {
+            continue;
+        }
+
+        r->state = DRIVER_RUN_RUNNING;
+
+        if (async_ok && (r->desc->flags & DRIVER_FLAG_ASYNC) != 0u) {
+            if (smp_boot_work_submit(driver_run_one, r) >= 0) {
+                started = 1;
+                continue;
+            }
+        }
+
+        /* Dependents of a driver that just finished may come earlier in link order. */
+        driver_run_one(r);
+        return 1;
+    }
+
+    return started;
+}
+
+static uint32_t drivers_reap(driver_stage_t stage, driver_run_t* runs, uint32_t count, uint32_t* running) {
+    uint32_t reaped = 0u;
+
+    *running = 0u;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t state = __atomic_load_n(&runs[i].state, __ATOMIC_ACQUIRE);
+
+        if (state == DRIVER_RUN_RUNNING) {
+            (*running)++;
+        } else if (state == DRIVER_RUN_DONE) {
+            driver_report(stage, &runs[i]);
+
+            runs[i].state = DRIVER_RUN_REPORTED;
+            reaped++;
+        }
+    }
+
+    return reaped;
+}
+
 static void drivers_init_stage_impl(driver_stage_t stage) {
     const driver_desc_t* it = drivers_begin();
     const driver_desc_t* end = drivers_end();
 
+    uint32_t count = 0u;
+
     for (; it < end; it++) {
-        if (it->stage != stage) {
+        if (it->stage != stage || !it->init) {
             continue;
         }
 
-        if (!it->init) {
-            continue;
+        if (count == DRIVERS_STAGE_MAX) {
+            panic("too many drivers in one stage");
         }
 
-        const int rc = it->init();
-        if (rc >= 0) {
-            if (it->name) {
-                kprintf(
-                    "[drivers] inited: %s stage=%u class=%u rc=%d\n",
-                    it->name,
-                    (unsigned)it->stage,
-                    (unsigned)it->klass,
-                    rc
-                );
-            } else {
-                kprintf(
-                    "[drivers] init ok: <noname> stage=%u class=%u rc=%d\n",
-                    (unsigned)it->stage,
-                    (unsigned)it->klass,
-                    rc
-                );
-            }
+        memset(&g_runs[count], 0, sizeof(g_runs[count]));
+        g_runs[count].desc = it;
+        count++;
+    }
+
+    const int async_ok = !boot_cmdline_has("nobootasync");
 
+    uint32_t finished = 0u;
+
+    /* Every driver of the stage is done before this returns: that is the sync point for callers. */
+    while (finished < count) {
+        const int started = drivers_dispatch(g_runs, count, async_ok);
+
+        uint32_t running = 0u;
+        finished += drivers_reap(stage, g_runs, count, &running);
+
+        if (started || finished == count) {
             continue;
         }
 
-        if (rc < 0) {
-            if (stage_is_critical(stage)) {
-                panic("driver init failed");
-            }
+        if (running != 0u) {
+            __asm__ volatile("pause");
+            continue;
+        }
 
-            if (it->name) {
-                kprintf(
-                    "[drivers] init failed: %s stage=%u class=%u rc=%d\n",
-                    it->name,
-                    (unsigned)it->stage,
-                    (unsigned)it->klass,
-                    rc
-                );
-            } else {
+        /* Nothing ready and nothing in flight: the rest depends on a cycle. */
+        for (uint32_t i = 0; i < count; i++) {
+            if (g_runs[i].state == DRIVER_RUN_PENDING) {
                 kprintf(
-                    "[drivers] init failed: <noname> stage=%u class=%u rc=%d\n",
-                    (unsigned)it->stage,
-                    (unsigned)it->klass,
-                    rc
+                    "[drivers] unmet dependency: %s stage=%u, running it anyway\n",
+                    g_runs[i].desc->name ? g_runs[i].desc->name : "<noname>",
+                    (unsigned)stage
                 );
+
+                g_runs[i].state = DRIVER_RUN_RUNNING;
+                driver_run_one(&g_runs[i]);
+                break;
             }
         }
     }
@@ -1,6 +1,8 @@
 /* SPDX-License-Identifier: GPL-2.0 */
 /* Copyright (C) 2026 Yula1234 */
 
+#include <drivers/driver.h>
+
 #include <kernel/locking/mutex.h>
 #include <kernel/proc.h>
 
@@ -891,4 +893,19 @@ void ne2k_init(void) {
     g_ne2k.initialized_ = 1;
 
     ne2k_vfs_init();
-}
\ No newline at end of file
+}
+
+/* An ISA probe with reset timeouts; a missing card is not a boot failure. */
+static int ne2k_driver_init(void) {
+    ne2k_init();
+    return 0;
+}
+
+DRIVER_REGISTER(
+    .name = "ne2k",
+    .klass = DRIVER_CLASS_NET,
+    .stage = DRIVER_STAGE_CORE,
+    .init = ne2k_driver_init,
+    .shutdown = 0,
+    .flags = DRIVER_FLAG_ASYNC
+);
@@ -42,12 +42,15 @@ static uint8_t  g_mcfg_start_bus = 0u;
 static uint8_t  g_mcfg_end_bus = 0u;
 static bool     g_mcfg_enabled = false;
 
+/* The CF8/CFC address and data ports are one shared window. */
+static kernel::SpinLock g_legacy_cfg_lock;
+
 static void ensure_ecam_page_mapped(uint32_t offset_in_ecam) {
     const uint32_t page_offset = offset_in_ecam & ~0xFFFu;
     const uint32_t vaddr = g_mcfg_vaddr + page_offset;
     const uint32_t paddr = static_cast<uint32_t>(g_mcfg_base) + page_offset;
 
-    uint32_t pte = 0u;
+    pte_t pte = 0u;
 
     if (!paging_get_present_pte(kernel_page_directory, vaddr, &pte)) {
         paging_map_ex(
@@ -235,26 +238,32 @@ public:
 
         node->pub = driver;
 
-        kernel::SpinLockSafeGuard guard(lock_);
+        {
+            kernel::SpinLockSafeGuard guard(lock_);
 
-        drivers_.push_back(*node);
+            drivers_.push_back(*node);
+        }
 
+        /*
+         * Probes reset controllers and spin up links, and at boot several
+         * drivers register at once from different CPUs, so they run without
+         * the registry lock. The device list is fixed after enumeration;
+         * claiming a device first keeps other drivers off it meanwhile.
+         */
         for (PciDeviceNode& dev_node : devices_) {
             pci_device_t* dev = &dev_node.pub;
 
-            if (dev->attached_driver != nullptr) {
-                continue;
-            }
-
-            if (!match_device_to_driver(*dev, *driver)) {
+            if (!claim_device(dev, driver)) {
                 continue;
             }
 
             const int rc = driver->probe(dev);
 
-            if (rc == 0) {
-                dev->attached_driver = driver;
+            if (rc != 0) {
+                kernel::SpinLockSafeGuard guard(lock_);
 
+                dev->attached_driver = nullptr;
+            } else {
                 kernel::output::kprintf(
                     "[pci] attached driver '%s' to %02x:%02x.%x\n",
                     driver->base.name ? driver->base.name : "unknown",
@@ -269,8 +278,23 @@ public:
     }
 
 private:
+    bool claim_device(pci_device_t* dev, pci_driver_t* driver) {
+        kernel::SpinLockSafeGuard guard(lock_);
+
+        if (dev->attached_driver != nullptr) {
+            return false;
+        }
+
+        if (!match_device_to_driver(*dev, *driver)) {
+            return false;
+        }
+
+        dev->attached_driver = driver;
+        return true;
+    }
+
     void ensure_init() {
-        if (initialized_) {
+        if (__atomic_load_n(&initialized_, __ATOMIC_ACQUIRE)) {
             return;
         }
 
@@ -310,7 +334,7 @@ private:
 
         enumerate_buses_locked();
 
-        initialized_ = true;
+        __atomic_store_n(&initialized_, true, __ATOMIC_RELEASE);
     }
 
     void enumerate_buses_locked() {
@@ -415,6 +439,8 @@ uint32_t pci_read(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset) {
         (bus << 16) | (slot << 11) | (func << 8) | (offset & 0xFCu) | 0x80000000u
     );
 
+    kernel::SpinLockSafeGuard guard(kernel::pci::g_legacy_cfg_lock);
+
     outl(kernel::pci::kPciConfigAddr, address);
     
     return inl(kernel::pci::kPciConfigData);
@@ -432,6 +458,8 @@ void pci_write(uint8_t bus, uint8_t slot, uint8_t func, uint16_t offset, uint32_
         (bus << 16) | (slot << 11) | (func << 8) | (offset & 0xFCu) | 0x80000000u
     );
 
+    kernel::SpinLockSafeGuard guard(kernel::pci::g_legacy_cfg_lock);
+
     outl(kernel::pci::kPciConfigAddr, address);
     outl(kernel::pci::kPciConfigData, value);
 }
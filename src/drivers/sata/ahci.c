@@ -19,6 +19,7 @@
 
 #include <kernel/workqueue.h>
 #include <kernel/smp/cpu.h>
+#include <kernel/trace.h>
 
 #include "ahci.h"
 
@@ -1006,6 +1007,8 @@ static int ahci_send_command(
 
         spinlock_release(&state->lock);
 
+        trace_event(YOS_TRACE_AHCI_SUBMIT, port_no, new_slot, lba, count | ((uint32_t)is_write << 31));
+
         iowrite32(hba->iomem, AHCI_PORT_CI(port_no), 1u << new_slot);
 
         if (g_ahci_async_mode && can_wait_irq) {
@@ -1023,9 +1026,13 @@ static int ahci_send_command(
             result = 1;
         }
 
+        trace_event(YOS_TRACE_AHCI_COMPLETE, port_no, new_slot, result, 0u);
+
         return result;
     }
 
+    trace_event(YOS_TRACE_AHCI_SUBMIT, port_no, slot, lba, count | ((uint32_t)is_write << 31));
+
     iowrite32(hba->iomem, AHCI_PORT_CI(port_no), 1u << slot);
 
     if (g_ahci_async_mode && can_wait_irq) {
@@ -1047,6 +1054,8 @@ static int ahci_send_command(
         ahci_port_comreset(ex);
     }
 
+    trace_event(YOS_TRACE_AHCI_COMPLETE, port_no, slot, result, 0u);
+
     return result;
 }
 
@@ -1386,5 +1395,6 @@ DRIVER_REGISTER(
     .klass = DRIVER_CLASS_BLOCK,
     .stage = DRIVER_STAGE_CORE,
     .init = ahci_driver_init,
-    .shutdown = 0
+    .shutdown = 0,
+    .flags = DRIVER_FLAG_ASYNC
 );
\ No newline at end of file
@@ -1777,5 +1777,8 @@ DRIVER_REGISTER(
     .klass = DRIVER_CLASS_PSEUDO,
     .stage = DRIVER_STAGE_CORE,
     .init = uhci_driver_init,
-    .shutdown = 0
+    .shutdown = 0,
+    /* Root hub ports are handed to the class drivers "usb" registers. */
+    .after = { "usb" },
+    .flags = DRIVER_FLAG_ASYNC
 );
@@ -1579,6 +1579,8 @@ static vfs_ops_t g_gpu0_ops = {
     .get_phys_page = nullptr,
     .poll_status = nullptr,
     .poll_register = nullptr,
+    .read_user = nullptr,
+    .write_user = nullptr,
 };
 
 static vfs_node_t g_gpu0_node = {
@@ -758,5 +758,6 @@ DRIVER_REGISTER(
     .klass = DRIVER_CLASS_PSEUDO,
     .stage = DRIVER_STAGE_CORE,
     .init = virtio_pci_transport_init,
-    .shutdown = 0
+    .shutdown = 0,
+    .flags = DRIVER_FLAG_ASYNC
 );
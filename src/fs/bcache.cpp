@@ -10,6 +10,7 @@
 
 #include <kernel/smp/cpu.h>
 #include <kernel/sched.h>
+#include <kernel/trace.h>
 #include <kernel/proc.h>
 
 #include <mm/shrinker.h>
@@ -250,6 +251,22 @@ struct PerCpuHotCache {
         }
     }
 
+    BcacheEntry* take(uint32_t block_idx) {
+        const uint32_t slot_idx = slot_index_for(block_idx);
+
+        kernel::SpinLockSafeGuard guard(lock);
+
+        HotSlot& slot = slots[slot_idx];
+        if (!slot.entry || slot.block_idx != block_idx) {
+            return nullptr;
+        }
+
+        BcacheEntry* e = slot.entry;
+        slot = {};
+
+        return e;
+    }
+
 private:
     static uint32_t slot_index_for(uint32_t block_idx) {
         return kernel::HashTraits<uint32_t>::hash(block_idx)
@@ -296,6 +313,14 @@ struct HotCache {
         per_cpu[cpu_idx].put(block_idx, entry);
     }
 
+    void drop(uint32_t block_idx) {
+        for (int cpu = 0; cpu < cpu_count; cpu++) {
+            if (BcacheEntry* e = per_cpu[cpu].take(block_idx)) {
+                e->put();
+            }
+        }
+    }
+
 private:
     static int cpu_index() {
         cpu_t* cpu = cpu_current();
@@ -467,6 +492,9 @@ struct DiskIo {
             return false;
         }
 
+        /* Every block read from disk is a cache miss (or readahead filling one). */
+        trace_event(YOS_TRACE_BCACHE_MISS, block_idx, 0u, 0u, 0u);
+
         return bdev_read_sectors(g_bcache_bdev, start_lba, SECTORS_PER_BLK, buf) != 0;
     }
 
@@ -489,6 +517,8 @@ struct DiskIo {
             return false;
         }
 
+        trace_event(YOS_TRACE_BCACHE_FLUSH, block_idx, 0u, 0u, 0u);
+
         return bdev_write_sectors(g_bcache_bdev, start_lba, SECTORS_PER_BLK, buf) != 0;
     }
 
@@ -1321,6 +1351,49 @@ void bcache_flush_block(uint32_t block_idx) {
     }
 }
 
+int bcache_invalidate_block(uint32_t block_idx) {
+    /* Hot slots hold references of their own; release them first. */
+    g_hot_cache.drop(block_idx);
+
+    BcacheShard& shard = g_shards[BcacheShard::index_for(block_idx)];
+
+    BcacheEntry* e = nullptr;
+
+    {
+        kernel::RwSpinLockNativeWriteGuard meta_guard(shard.meta_lock);
+
+        e = shard.lookup_locked(block_idx);
+        if (!e) {
+            return 1;
+        }
+
+        const uint32_t busy = k_flag_dirty | k_flag_io_inflight | k_flag_evicting;
+
+        if (e->refcnt.load(kernel::memory_order::acquire) != 1u
+            || (e->flags.load(kernel::memory_order::acquire) & busy) != 0u) {
+            return 0;
+        }
+
+        e->flags.fetch_or(k_flag_evicting, kernel::memory_order::acq_rel);
+
+        /* Same late get() race as the CLOCK eviction path. */
+        if (e->refcnt.load(kernel::memory_order::acquire) != 1u) {
+            e->flags.fetch_and(~k_flag_evicting, kernel::memory_order::acq_rel);
+            return 0;
+        }
+
+        shard.dirty_unmark_locked(*e);
+
+        shard.map.remove(block_idx);
+        shard.clock_remove_locked(*e);
+        shard.entries--;
+    }
+
+    e->put();
+
+    return 1;
+}
+
 void bcache_readahead(uint32_t start_block, uint32_t count) {
     if (count == 0) {
         return;
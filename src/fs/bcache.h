@@ -61,6 +61,14 @@ void bcache_sync(void);
 /* Write back one dirty block if it is currently cached. */
 void bcache_flush_block(uint32_t block_idx);
 
+/*
+ * Drop a clean, unused block from the cache so the next read goes to disk.
+ *
+ * Returns non-zero if the block is no longer cached, 0 if it is dirty or
+ * in use and was left alone.
+ */
+int bcache_invalidate_block(uint32_t block_idx);
+
 /*
  * Best-effort sequential readahead.
  *
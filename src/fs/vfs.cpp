@@ -38,16 +38,7 @@ static bool vfs_ptr_mapped(const void* p) noexcept {
 
     const uint32_t v = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p));
 
-    const uint32_t pde = kernel_page_directory[v >> 22];
-    if ((pde & PTE_PRESENT) == 0u) {
-        return false;
-    }
-
-    if ((pde & (1u << 7)) != 0u) {
-        return true;
-    }
-
-    return paging_get_present_pte(kernel_page_directory, v, nullptr) != 0;
+    return paging_is_mapped(kernel_page_directory, v) != 0;
 }
 
 static int vfs_copy_to_user(void* user_dst, const void* src, uint32_t size) noexcept {
@@ -948,6 +939,8 @@ static vfs_ops_t yfs_vfs_ops = {
     0,
     0,
     0,
+    0,
+    0,
 };
 
 struct vfs_mount_node {
@@ -1734,7 +1727,7 @@ static int vfs_umount_impl(const char* mountpoint) {
         __atomic_store_n(&inst->umounting, 1u, __ATOMIC_RELEASE);
     }
 
-    synchronize_rcu();
+    synchronize_rcu_expedited();
 
     if (inst->refs > 1u) {
         __atomic_store_n(&inst->umounting, 0u, __ATOMIC_RELEASE);
@@ -1765,7 +1758,7 @@ static int vfs_umount_impl(const char* mountpoint) {
         call_rcu(const_cast<rcu_head_t*>(&retired->rcu), vfs_mount_table_rcu_free);
     }
 
-    synchronize_rcu();
+    synchronize_rcu_expedited();
 
     return inst->type->umount(inst);
 }
@@ -2670,7 +2663,7 @@ extern "C" int vfs_openat(int dirfd, const char* path, int flags) {
     return vfs_open_resolved(curr, resolved, flags);
 }
 
-extern "C" int vfs_read(int fd, void* buf, uint32_t size) {
+static int vfs_read_impl(int fd, void* buf, uint32_t size) {
     /*
      * Keep offset updates consistent under the fd lock.
      *
@@ -2699,6 +2692,17 @@ extern "C" int vfs_read(int fd, void* buf, uint32_t size) {
         off = d.get()->offset;
     }
 
+    if (d.get()->node->ops->read_user) {
+        const int r = d.get()->node->ops->read_user(d.get()->node, off, size, buf);
+
+        if (r > 0) {
+            kernel::SpinLockNativeSafeGuard guard(d.get()->lock);
+            d.get()->offset = off + (uint32_t)r;
+        }
+
+        return r;
+    }
+
     uint8_t kbuf[k_vfs_io_chunk];
 
     int total = 0;
@@ -2735,7 +2739,7 @@ extern "C" int vfs_read(int fd, void* buf, uint32_t size) {
     return total;
 }
 
-extern "C" int vfs_write(int fd, const void* buf, uint32_t size) {
+static int vfs_write_impl(int fd, const void* buf, uint32_t size) {
     /*
      * Handle append as a filesystem-level operation.
      *
@@ -2814,6 +2818,17 @@ extern "C" int vfs_write(int fd, const void* buf, uint32_t size) {
         }
     }
 
+    if (d.get()->node->ops->write_user) {
+        const int w = d.get()->node->ops->write_user(d.get()->node, off, size, buf);
+
+        if (w > 0) {
+            kernel::SpinLockNativeSafeGuard guard(d.get()->lock);
+            d.get()->offset = off + (uint32_t)w;
+        }
+
+        return w;
+    }
+
     uint8_t kbuf[k_vfs_io_chunk];
 
     int total = 0;
@@ -2850,6 +2865,28 @@ extern "C" int vfs_write(int fd, const void* buf, uint32_t size) {
     return total;
 }
 
+extern "C" int vfs_read(int fd, void* buf, uint32_t size) {
+    const int r = vfs_read_impl(fd, buf, size);
+
+    task_t* curr = proc_current();
+    if (r > 0 && curr) {
+        curr->ru.read_bytes += (uint32_t)r;
+    }
+
+    return r;
+}
+
+extern "C" int vfs_write(int fd, const void* buf, uint32_t size) {
+    const int w = vfs_write_impl(fd, buf, size);
+
+    task_t* curr = proc_current();
+    if (w > 0 && curr) {
+        curr->ru.write_bytes += (uint32_t)w;
+    }
+
+    return w;
+}
+
 extern "C" int vfs_ioctl(int fd, uint32_t req, void* arg) {
     /*
      * ioctl() is backend-defined.
@@ -48,6 +48,12 @@
 #define VFS_FLAG_DEVFS_NODE   256u
 /* Node is the devfs root directory. */
 #define VFS_FLAG_DEVFS_ROOT   512u
+/* One end of an IPC channel. */
+#define VFS_FLAG_IPC_CHAN     1024u
+/* Event counter (eventfd). */
+#define VFS_FLAG_EVENTFD      2048u
+/* Expiration counter of a kernel timer (timerfd). */
+#define VFS_FLAG_TIMERFD      4096u
 
 /*
  * When set, `fs_driver` is a retained reference to an internal filesystem
@@ -116,6 +122,14 @@ typedef struct vfs_ops {
      */
     int (*poll_status)(struct vfs_node* node, int events);
     int (*poll_register)(struct vfs_node* node, struct poll_waiter* w, struct task* task);
+
+    /*
+     * Optional user-buffer transfers. When set, vfs_read()/vfs_write() hand
+     * the user pointer straight to the backend, which copies with uaccess,
+     * instead of bouncing every chunk through a kernel buffer.
+     */
+    int (*read_user)(struct vfs_node* node, uint32_t offset, uint32_t size, void* user_buf);
+    int (*write_user)(struct vfs_node* node, uint32_t offset, uint32_t size, const void* user_buf);
 } vfs_ops_t;
 
 /* Flags passed to vfs_open/vfs_openat. */
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include <kernel/locking/spinlock.h>
+
 #include <arch/i386/paging.h>
 
 #include "ioapic.h"
@@ -20,6 +22,9 @@ static uint32_t g_ioapic_gsi_base = 0;
 static uint32_t g_ioapic_max_redir = 0;
 static int g_ioapic_inited = 0;
 
+/* IOREGSEL/IOWIN is a select-then-access pair; boot probes route IRQs from several CPUs. */
+static spinlock_t g_ioapic_lock = {0};
+
 static inline void ioapic_write_reg(uint8_t reg, uint32_t val) {
     if (!g_ioapic_mmio) return;
     volatile uint32_t* regsel = (volatile uint32_t*)((uintptr_t)g_ioapic_mmio + IOAPIC_REGSEL);
@@ -89,9 +94,14 @@ int ioapic_route_gsi(uint32_t gsi, uint8_t vector, uint8_t dest_apic_id, int act
     }
 
     high |= ((uint32_t)dest_apic_id) << 24;
+
+    uint32_t flags = spinlock_acquire_safe(&g_ioapic_lock);
+
     uint32_t old_low = ioapic_read_redir_low(index);
     ioapic_write_redir(index, old_low | (1u << 16), high);
     ioapic_write_redir(index, low | (1u << 16), high);
     ioapic_write_redir(index, low & ~(1u << 16), high);
+
+    spinlock_release_safe(&g_ioapic_lock, flags);
     return 1;
 }
@@ -10,16 +10,18 @@
 #include <drivers/block/bdev.h>
 #include <drivers/video/vga.h>
 #include <drivers/sata/ahci.h>
-#include <drivers/net/ne2k.h>
 #include <drivers/driver.h>
 #include <drivers/acpi.h>
 
 #include <kernel/symbols/symbols.h>
 #include <kernel/output/console.h>
+#include <kernel/output/kmsg.h>
+#include <kernel/init/boottime.h>
 #include <kernel/init/init.h>
 #include <kernel/init/boot.h>
 #include <kernel/tty/ldisc.h>
 #include <kernel/profiler.h>
+#include <kernel/kbench.h>
 #include <kernel/smp/cpu.h>
 #include <kernel/tty/tty.h>
 #include <kernel/tty/pty.h>
@@ -38,6 +40,7 @@
 #include <hal/io.h>
 
 #include <mm/shrinker.h>
+#include <mm/zswap.h>
 #include <mm/heap.h>
 #include <mm/pmm.h>
 #include <mm/vmm.h>
@@ -65,6 +68,7 @@ static uint32_t g_kernel_memory_end;
 extern void put_pixel(int x, int y, uint32_t color);
 
 extern void smp_boot_aps(void);
+extern void smp_boot_release_aps(void);
 
 typedef struct {
     uint32_t mod_start;
@@ -85,8 +89,8 @@ static void add_region(
     pmm_region_t* regions,
     uint32_t* count,
     uint32_t max_count,
-    uint32_t base,
-    uint32_t size,
+    uint64_t base,
+    uint64_t size,
     uint32_t type
 ) {
     if (!regions || !count || size == 0u) {
@@ -125,6 +129,7 @@ static void add_reserved(
 
 static void kmain_cpu_init(uint32_t magic, multiboot_info_t* mb_info) {
     validate_multiboot(magic, mb_info);
+    boot_cmdline_init(mb_info);
 
     symbols_init(mb_info);
 
@@ -175,12 +180,9 @@ static uint32_t kmain_memory_init(const multiboot_info_t* mb_info) {
             uint64_t addr64 = e->addr;
             uint64_t len64 = e->len;
             if (len64 != 0u) {
-                uint32_t base = clamp_u64_to_u32(addr64);
-                uint32_t end = clamp_u64_to_u32(addr64 + len64);
-                if (end > base) {
-                    uint32_t type = e->type == 1u ? PMM_REGION_AVAILABLE : PMM_REGION_RESERVED;
-                    add_region(regions, &region_count, max_regions, base, end - base, type);
-                }
+                /* Regions above 4 GiB are kept; the PMM clamps them to what it can address. */
+                uint32_t type = e->type == 1u ? PMM_REGION_AVAILABLE : PMM_REGION_RESERVED;
+                add_region(regions, &region_count, max_regions, addr64, len64, type);
             }
 
             uint32_t step = e->size + sizeof(uint32_t);
@@ -272,10 +274,13 @@ static void kmain_devices_init(void) {
 
     bdev_init();
 
-    ne2k_init();
+    boottime_mark("early_devices");
 
+    /* Async probes fan out to the parked APs; all of them are done when this returns. */
     drivers_init_stage(DRIVER_STAGE_CORE);
 
+    boottime_mark("probes");
+
     fb_select_active();
     
     if (!virtio_gpu_is_active()) {
@@ -350,8 +355,13 @@ static void kmain_spawn_core_tasks(void) {
     }
 }
 
+/* APs come up early and stay parked until released, running boot probes. */
 static void kmain_smp_init(void) {
     smp_boot_aps();
+}
+
+static void kmain_smp_release(void) {
+    smp_boot_release_aps();
  
     if (cpu_count > 1) {
         wait_for_ap_start();
@@ -367,38 +377,59 @@ static void kmain_smp_init(void) {
 }
 
 static void kmain_spawn_service_tasks(void) {
+    kmsg_start_flusher();
+
     proc_spawn_kthread("reaper", PRIO_HIGH, reaper_task_func, 0);
 
     ahci_set_async_mode(1);
     proc_spawn_kthread("syncer", PRIO_LOW, syncer_task, 0);
 
+    zswap_init();
     shrinker_start_kthread();
 
 #ifdef KERNEL_PROFILE
     proc_spawn_kthread("profiler", PRIO_LOW, profiler_task, 0);
 #endif
+
+    if (boot_cmdline_has("kbench")) {
+        kbench_spawn();
+    }
 }
 
 __attribute__((target("no-sse"))) void kmain(uint32_t magic, multiboot_info_t* mb_info) {
+    boottime_start();
+
     kmain_cpu_init(magic, mb_info);
+    boottime_mark("cpu");
 
     uint32_t memory_end_addr = kmain_memory_init(mb_info);
     g_kernel_memory_end = memory_end_addr;
+    boottime_mark("memory");
 
     cpp_call_global_ctors();
     
     kmain_platform_init();
+    boottime_mark("acpi");
+
     kmain_tasks_init();
 
     shrinker_init();
     pmm_register_shrinker();
+    boottime_mark("tasks");
+
+    kmain_smp_init();
+    boottime_mark("smp");
 
     kmain_devices_init();
+    boottime_mark("video");
+
     kmain_fs_init();
+    boottime_mark("fs");
     
     kmain_spawn_core_tasks();
-    kmain_smp_init();
+    kmain_smp_release();
     kmain_spawn_service_tasks();
+    boottime_mark("services");
 
 #ifdef KERNEL_PROFILE
     profiler_init();
@@ -7,10 +7,17 @@
 
 #include <kernel/panic.h>
 #include <kernel/sched.h>
+#include <kernel/trace.h>
 #include <kernel/proc.h>
 
 #include <kernel/waitq/waitqueue.h>
 
+#include <kernel/rcu.h>
+
+#include <mm/zswap.h>
+
+#include <yos/futex.h>
+
 #include <lib/cpp/intrusive_ref.h>
 #include <lib/cpp/lock_guard.h>
 #include <lib/cpp/dlist.h>
@@ -20,6 +27,8 @@
 
 #include <stdint.h>
 
+extern "C" volatile uint32_t timer_ticks;
+
 namespace {
 
 class FutexTable;
@@ -35,6 +44,13 @@ struct futex_entry_t {
 
     FutexShard* shard;
 
+    /* PI futexes, under g_pi_lock: the owner our waiters lend their priority to. */
+    bool pi;
+    task_t* pi_owner;
+    dlist_head_t pi_node;
+
+    rcu_head_t rcu;
+
     void release();
 };
 
@@ -143,11 +159,16 @@ public:
         }
 
         if (removed) {
-            delete removed;
+            /* Cancelling waiters reach entries through their task, without a reference. */
+            call_rcu(&removed->rcu, free_entry_rcu_cb);
         }
     }
 
 private:
+    static void free_entry_rcu_cb(rcu_head_t* head) {
+        delete container_of(head, futex_entry_t, rcu);
+    }
+
     static bool entry_is_unused(futex_entry_t& entry) {
         kernel::SpinLockSafeGuard guard(entry.lock);
 
@@ -177,16 +198,192 @@ void futex_entry_t::release() {
     futex_table.release_entry(*this);
 }
 
-static int futex_do_wait(futex_entry_t* entry, volatile const uint32_t* uaddr, uint32_t expected) {
-    if (!entry || !uaddr) {
+static bool futex_deadline_passed(const uint32_t* deadline_tick) {
+    return deadline_tick && (uint32_t)(timer_ticks - *deadline_tick) < 0x80000000u;
+}
+
+/*
+ * Priority inheritance. Waiters of a PI futex come and go with both its
+ * entry lock and this one held, so a walk down a blocking chain under this
+ * lock alone sees every waiter on the way. Owners are not referenced: an
+ * exiting task turns zombie before futex_pi_exit() unlinks it under this
+ * lock, and a zombie is never linked again.
+ */
+static kernel::SpinLock g_pi_lock;
+
+/* Chains are short; the bound also keeps a deadlocked cycle from spinning. */
+static constexpr uint32_t kPiMaxChain = 16u;
+
+/*
+ * Recompute what `t` borrows from the waiters of the PI futexes it owns and
+ * pass a change on along the chain of owners it is itself waiting for.
+ */
+static void pi_update_boost_locked(task_t* t) {
+    for (uint32_t depth = 0; t && depth < kPiMaxChain; depth++) {
+        task_prio_t top = PRIO_IDLE;
+        uint64_t top_vruntime = ~0ull;
+
+        futex_entry_t* owned;
+        dlist_for_each_entry(owned, &t->pi_owned, pi_node) {
+            task_t* w;
+            dlist_for_each_entry(w, &owned->waitq.waiters, sem_node) {
+                const task_prio_t prio = sched_task_prio(w);
+
+                if (prio <= t->priority) {
+                    continue;
+                }
+
+                if (prio > top) {
+                    top = prio;
+                }
+
+                if (w->vruntime < top_vruntime) {
+                    top_vruntime = w->vruntime;
+                }
+            }
+        }
+
+        const task_prio_t boost = top > t->priority ? top : PRIO_IDLE;
+
+        if (boost == t->pi_priority) {
+            return;
+        }
+
+        sched_set_pi_boost(t, boost, top_vruntime);
+
+        auto* blocked = static_cast<futex_entry_t*>(t->pi_blocked_on);
+        if (!blocked) {
+            return;
+        }
+
+        t = blocked->pi_owner;
+    }
+}
+
+static void pi_set_owner_locked(futex_entry_t* entry, task_t* owner) {
+    task_t* old = entry->pi_owner;
+
+    if (old == owner) {
+        if (owner) {
+            pi_update_boost_locked(owner);
+        }
+
+        return;
+    }
+
+    if (old) {
+        dlist_del(&entry->pi_node);
+        entry->pi_owner = nullptr;
+
+        pi_update_boost_locked(old);
+    }
+
+    if (owner) {
+        dlist_add_tail(&entry->pi_node, &owner->pi_owned);
+        entry->pi_owner = owner;
+
+        pi_update_boost_locked(owner);
+    }
+}
+
+/* `t` no longer waits on `entry`: its owner may have been running on `t`'s priority. */
+static void pi_waiter_leave_locked(futex_entry_t* entry, task_t* t) {
+    waitqueue_wait_cancel_locked(&entry->waitq, t);
+    t->pi_blocked_on = nullptr;
+
+    if (dlist_empty(&entry->waitq.waiters)) {
+        pi_set_owner_locked(entry, nullptr);
+    } else if (entry->pi_owner) {
+        pi_update_boost_locked(entry->pi_owner);
+    }
+}
+
+/* The waiter the lock goes to next: highest priority, the longest waiting of those. */
+static task_t* pi_top_waiter_locked(futex_entry_t* entry) {
+    task_t* top = nullptr;
+
+    task_t* w;
+    dlist_for_each_entry(w, &entry->waitq.waiters, sem_node) {
+        if (w->state == TASK_ZOMBIE || w->state == TASK_UNUSED) {
+            continue;
+        }
+
+        if (!top || sched_task_prio(w) > sched_task_prio(top)) {
+            top = w;
+        }
+    }
+
+    return top;
+}
+
+static bool pi_chain_reaches(task_t* owner, const task_t* curr) {
+    for (uint32_t depth = 0; owner && depth < kPiMaxChain; depth++) {
+        if (owner == curr) {
+            return true;
+        }
+
+        auto* blocked = static_cast<futex_entry_t*>(owner->pi_blocked_on);
+        if (!blocked) {
+            return false;
+        }
+
+        owner = blocked->pi_owner;
+    }
+
+    return false;
+}
+
+/*
+ * Take `t` off whichever futex it is queued on; false if a waker got there
+ * first. The entry is reached through the task without a reference and can
+ * be retired or requeued from under us: RCU keeps the memory valid until the
+ * task is seen pointing at it under its lock.
+ */
+static bool futex_unqueue_task(task_t* t) {
+    for (;;) {
+        kernel::RcuReadGuard rcu_guard;
+
+        void* raw = __atomic_load_n(&t->blocked_on_sem, __ATOMIC_ACQUIRE);
+        if (!raw || t->blocked_kind != TASK_BLOCK_FUTEX) {
+            return false;
+        }
+
+        auto* entry = static_cast<futex_entry_t*>(raw);
+
+        kernel::SpinLockSafeGuard guard(entry->lock);
+
+        if (__atomic_load_n(&t->blocked_on_sem, __ATOMIC_ACQUIRE) != raw) {
+            continue;
+        }
+
+        if (entry->pi) {
+            kernel::SpinLockGuard pi_guard(g_pi_lock);
+
+            pi_waiter_leave_locked(entry, t);
+        } else {
+            waitqueue_wait_cancel_locked(&entry->waitq, t);
+        }
+
+        return true;
+    }
+}
+
+static int futex_do_wait(
+    futex_entry_t* entry, task_t* curr,
+    volatile const uint32_t* uaddr, uint32_t expected,
+    const uint32_t* deadline_tick
+) {
+    if (!entry || !curr || !uaddr) {
         return -1;
     }
 
     for (;;) {
-        task_t* curr = proc_current();
+        if (curr->pending_signals != 0) {
+            return YOS_FUTEX_EINTR;
+        }
 
-        if (curr && curr->pending_signals != 0) {
-            return -2;
+        if (futex_deadline_passed(deadline_tick)) {
+            return YOS_FUTEX_ETIMEDOUT;
         }
 
         uint32_t v = 0u;
@@ -201,46 +398,57 @@ static int futex_do_wait(futex_entry_t* entry, volatile const uint32_t* uaddr, u
         {
             kernel::SpinLockSafeGuard guard(entry->lock);
 
-            if (!curr) {
-                return -1;
-            }
-
             (void)waitqueue_wait_prepare_locked(&entry->waitq, curr);
         }
 
         v = 0u;
-        if (uaccess_copy_from_user(&v, (const void*)uaddr, sizeof(v)) != 0) {
-            kernel::SpinLockSafeGuard guard(entry->lock);
+        const int fault = uaccess_copy_from_user(&v, (const void*)uaddr, sizeof(v));
 
-            if (curr) {
-                waitqueue_wait_cancel_locked(&entry->waitq, curr);
-            }
+        if (fault != 0 || v != expected) {
+            (void)futex_unqueue_task(curr);
+            (void)proc_change_state(curr, TASK_RUNNING);
 
-            if (curr) {
-                (void)proc_change_state(curr, TASK_RUNNING);
-            }
-            
-            return -1;
+            return fault != 0 ? -1 : 0;
         }
 
-        if (v != expected) {
-            kernel::SpinLockSafeGuard guard(entry->lock);
-
-            if (curr) {
-                waitqueue_wait_cancel_locked(&entry->waitq, curr);
-            }
-            
-            if (curr) {
-                (void)proc_change_state(curr, TASK_RUNNING);
+        if (deadline_tick) {
+            if (__atomic_load_n(&curr->blocked_on_sem, __ATOMIC_ACQUIRE)) {
+                proc_sleep_add(curr, *deadline_tick);
             }
+        } else {
+            sched_yield();
+        }
 
+        /* Dequeued by a wake, possibly on the futex we were requeued to. */
+        if (!futex_unqueue_task(curr)) {
             return 0;
         }
 
-        sched_yield();
+        /* Requeued, then timed out or interrupted: *uaddr is no longer ours to recheck. */
+        if (curr->futex_key != entry->key) {
+            return futex_deadline_passed(deadline_tick) ? YOS_FUTEX_ETIMEDOUT : 0;
+        }
+    }
+}
+
+static uint32_t futex_wake_locked(futex_entry_t* entry, uint32_t max_wake) {
+    uint32_t woken = 0;
+
+    while (woken < max_wake) {
+        task_t* t = waitqueue_dequeue_locked(&entry->waitq);
+        if (!t) {
+            break;
+        }
 
-        futex_remove_task(curr);
+        if (t->state == TASK_ZOMBIE || t->state == TASK_UNUSED) {
+            continue;
+        }
+
+        waitqueue_wake_task(t);
+        woken++;
     }
+
+    return woken;
 }
 
 static int futex_do_wake(futex_entry_t* entry, uint32_t max_wake) {
@@ -248,39 +456,285 @@ static int futex_do_wake(futex_entry_t* entry, uint32_t max_wake) {
         return 0;
     }
 
-    uint32_t woken = 0;
+    kernel::SpinLockSafeGuard guard(entry->lock);
 
-    {
-        kernel::SpinLockSafeGuard guard(entry->lock);
+    return (int)futex_wake_locked(entry, max_wake);
+}
+
+/*
+ * Requeued waiters keep sleeping, now on `to`. Each carries the zswap pin of
+ * the frame it waits on: the target frame is pinned before the waiter can
+ * run and drop it, the caller unpins the source once per *out_moved.
+ */
+static uint32_t futex_do_requeue(
+    futex_entry_t* from, futex_entry_t* to,
+    uint32_t nr_wake, uint32_t nr_requeue,
+    uint32_t* out_moved
+) {
+    futex_entry_t* first = from < to ? from : to;
+    futex_entry_t* second = from < to ? to : from;
+
+    kernel::SpinLockSafeGuard first_guard(first->lock);
+    kernel::SpinLockSafeGuard second_guard(second->lock);
+
+    const uint32_t woken = futex_wake_locked(from, nr_wake);
+
+    uint32_t moved = 0;
+
+    while (moved < nr_requeue && !dlist_empty(&from->waitq.waiters)) {
+        zswap_pin_phys(futex_key_to_phys(to->key));
+
+        task_t* t = waitqueue_requeue_locked(&from->waitq, &to->waitq);
+
+        t->futex_key = to->key;
+        moved++;
+    }
+
+    *out_moved = moved;
+
+    return woken;
+}
 
-        while (woken < max_wake) {
-            task_t* t = waitqueue_dequeue_locked(&entry->waitq);
-            if (!t) {
-                break;
+/*
+ * One go at the PI word with the entry and PI locks held: take it if it is
+ * free or its owner is gone, else mark it contended and queue `curr` behind
+ * the owner. Returns 0 once `curr` owns it, 1 when queued, or an error.
+ * The word sits in a pinned, present, writable frame, so the accesses here
+ * do not fault.
+ */
+static int pi_lock_step_locked(
+    futex_entry_t* entry, task_t* curr,
+    volatile uint32_t* uaddr, bool handed_over,
+    const uint32_t* deadline_tick
+) {
+    uint32_t v = 0u;
+    if (uaccess_copy_from_user(&v, (const void*)uaddr, sizeof(v)) != 0) {
+        return -1;
+    }
+
+    for (;;) {
+        const uint32_t tid = v & YOS_FUTEX_TID_MASK;
+
+        if (tid == curr->pid) {
+            /* An unlock made us the owner while we slept; anything else is a recursive lock. */
+            if (!handed_over) {
+                return YOS_FUTEX_EDEADLK;
+            }
+
+            pi_set_owner_locked(entry, dlist_empty(&entry->waitq.waiters) ? nullptr : curr);
+            return 0;
+        }
+
+        task_t* owner = tid != 0u ? proc_find_by_pid(tid) : nullptr;
+
+        if (owner && (owner->state == TASK_ZOMBIE || owner->state == TASK_UNUSED)) {
+            proc_task_put(owner);
+            owner = nullptr;
+        }
+
+        if (!owner) {
+            uint32_t next = curr->pid;
+
+            if (tid != 0u) {
+                next |= YOS_FUTEX_OWNER_DIED;
+            }
+
+            if (!dlist_empty(&entry->waitq.waiters)) {
+                next |= YOS_FUTEX_WAITERS;
+            }
+
+            uint32_t seen = v;
+            if (uaccess_cmpxchg_user_u32(uaddr, &seen, next) != 0) {
+                return -1;
             }
 
-            if (t->state == TASK_ZOMBIE || t->state == TASK_UNUSED) {
+            if (seen != v) {
+                v = seen;
                 continue;
             }
 
-            waitqueue_wake_task(t);
-            woken++;
+            pi_set_owner_locked(entry, (next & YOS_FUTEX_WAITERS) != 0u ? curr : nullptr);
+            return 0;
+        }
+
+        int rc = 1;
+
+        if (curr->pending_signals != 0) {
+            rc = YOS_FUTEX_EINTR;
+        } else if (futex_deadline_passed(deadline_tick)) {
+            rc = YOS_FUTEX_ETIMEDOUT;
+        } else if (pi_chain_reaches(owner, curr)) {
+            rc = YOS_FUTEX_EDEADLK;
+        } else if ((v & YOS_FUTEX_WAITERS) == 0u) {
+            uint32_t seen = v;
+            if (uaccess_cmpxchg_user_u32(uaddr, &seen, v | YOS_FUTEX_WAITERS) != 0) {
+                rc = -1;
+            } else if (seen != v) {
+                proc_task_put(owner);
+                v = seen;
+                continue;
+            }
+        }
+
+        if (rc == 1) {
+            if (waitqueue_wait_prepare_locked(&entry->waitq, curr) != 0) {
+                rc = -1;
+            } else {
+                curr->pi_blocked_on = entry;
+
+                pi_set_owner_locked(entry, owner);
+            }
         }
+
+        proc_task_put(owner);
+        return rc;
     }
+}
+
+static int futex_do_lock_pi(
+    futex_entry_t* entry, task_t* curr,
+    volatile uint32_t* uaddr,
+    const uint32_t* deadline_tick
+) {
+    bool handed_over = false;
 
-    return (int)woken;
+    for (;;) {
+        {
+            kernel::SpinLockSafeGuard guard(entry->lock);
+            kernel::SpinLockGuard pi_guard(g_pi_lock);
+
+            entry->pi = true;
+
+            const int rc = pi_lock_step_locked(entry, curr, uaddr, handed_over, deadline_tick);
+            if (rc != 1) {
+                return rc;
+            }
+        }
+
+        if (deadline_tick) {
+            if (__atomic_load_n(&curr->blocked_on_sem, __ATOMIC_ACQUIRE)) {
+                proc_sleep_add(curr, *deadline_tick);
+            }
+        } else {
+            sched_yield();
+        }
+
+        /* Timed out, interrupted, or the owner died; a handover already dequeued us. */
+        (void)futex_unqueue_task(curr);
+
+        handed_over = true;
+    }
 }
 
+static int futex_do_unlock_pi(futex_entry_t* entry, task_t* curr, volatile uint32_t* uaddr) {
+    kernel::SpinLockSafeGuard guard(entry->lock);
+    kernel::SpinLockGuard pi_guard(g_pi_lock);
+
+    entry->pi = true;
+
+    uint32_t v = 0u;
+    if (uaccess_copy_from_user(&v, (const void*)uaddr, sizeof(v)) != 0) {
+        return -1;
+    }
+
+    for (;;) {
+        if ((v & YOS_FUTEX_TID_MASK) != curr->pid) {
+            return YOS_FUTEX_EPERM;
+        }
+
+        task_t* next = pi_top_waiter_locked(entry);
+
+        uint32_t word = 0u;
+
+        if (next) {
+            word = next->pid;
+
+            /* Anyone else still queued keeps the new owner off the fast path. */
+            if (entry->waitq.waiters.next != &next->sem_node || entry->waitq.waiters.prev != &next->sem_node) {
+                word |= YOS_FUTEX_WAITERS;
+            }
+        }
+
+        uint32_t seen = v;
+        if (uaccess_cmpxchg_user_u32(uaddr, &seen, word) != 0) {
+            return -1;
+        }
+
+        if (seen != v) {
+            v = seen;
+            continue;
+        }
+
+        if (!next) {
+            pi_set_owner_locked(entry, nullptr);
+            return 0;
+        }
+
+        waitqueue_wait_cancel_locked(&entry->waitq, next);
+        next->pi_blocked_on = nullptr;
+
+        /* Drops what we borrowed and lends the new owner what the rest lend. */
+        pi_set_owner_locked(entry, dlist_empty(&entry->waitq.waiters) ? nullptr : next);
+
+        waitqueue_wake_task(next);
+
+        return 0;
+    }
 }
 
-extern "C" int futex_wait(uint32_t key, volatile const uint32_t* uaddr, uint32_t expected) {
-    kernel::IntrusiveRef<futex_entry_t> entry_ref = futex_table.acquire_entry(key, true);
+static bool futex_op_apply(uint32_t op, uint32_t oparg, uint32_t old, uint32_t* out) {
+    switch (op) {
+        case YOS_FUTEX_OP_SET:  *out = oparg;        return true;
+        case YOS_FUTEX_OP_ADD:  *out = old + oparg;  return true;
+        case YOS_FUTEX_OP_OR:   *out = old | oparg;  return true;
+        case YOS_FUTEX_OP_ANDN: *out = old & ~oparg; return true;
+        case YOS_FUTEX_OP_XOR:  *out = old ^ oparg;  return true;
+        default:                                     return false;
+    }
+}
+
+static bool futex_op_cmp(uint32_t cmp, uint32_t old, uint32_t cmparg) {
+    const int32_t a = (int32_t)old;
+    const int32_t b = (int32_t)cmparg;
+
+    switch (cmp) {
+        case YOS_FUTEX_OP_CMP_EQ: return a == b;
+        case YOS_FUTEX_OP_CMP_NE: return a != b;
+        case YOS_FUTEX_OP_CMP_LT: return a < b;
+        case YOS_FUTEX_OP_CMP_LE: return a <= b;
+        case YOS_FUTEX_OP_CMP_GT: return a > b;
+        case YOS_FUTEX_OP_CMP_GE: return a >= b;
+        default:                  return false;
+    }
+}
+
+}
+
+extern "C" int futex_wait(uint32_t* key, volatile const uint32_t* uaddr, uint32_t expected, const uint32_t* deadline_tick) {
+    task_t* curr = proc_current();
+
+    if (!key || !curr) {
+        return -1;
+    }
+
+    kernel::IntrusiveRef<futex_entry_t> entry_ref = futex_table.acquire_entry(*key, true);
 
     if (!entry_ref) {
         return -1;
     }
 
-    const int rc = futex_do_wait(entry_ref.get(), uaddr, expected);
+    trace_event(YOS_TRACE_FUTEX_WAIT, *key, expected, 0u, 0u);
+
+    curr->futex_key = *key;
+
+    const int rc = futex_do_wait(entry_ref.get(), curr, uaddr, expected, deadline_tick);
+
+    if (curr->futex_key != *key) {
+        *key = curr->futex_key;
+
+        /* Nobody else may come back for the requeue target: give it a chance to go away. */
+        kernel::IntrusiveRef<futex_entry_t> target = futex_table.acquire_entry(*key, false);
+    }
 
     return rc;
 }
@@ -294,22 +748,181 @@ extern "C" int futex_wake(uint32_t key, uint32_t max_wake) {
 
     const int rc = futex_do_wake(entry_ref.get(), max_wake);
 
+    trace_event(YOS_TRACE_FUTEX_WAKE, key, max_wake, rc, 0u);
+
     return rc;
 }
 
+/*
+ * The comparison is made before the entries are locked: reading the word may
+ * fault and sleep. A waiter that slips in between is requeued along with the
+ * rest and sees a spurious wakeup, which every futex user has to handle.
+ */
+extern "C" int futex_requeue(
+    uint32_t key, uint32_t key2,
+    volatile const uint32_t* uaddr, const uint32_t* cmpval,
+    uint32_t nr_wake, uint32_t nr_requeue
+) {
+    if (cmpval) {
+        uint32_t v = 0u;
+        if (uaccess_copy_from_user(&v, (const void*)uaddr, sizeof(v)) != 0) {
+            return -1;
+        }
+
+        if (v != *cmpval) {
+            return YOS_FUTEX_EAGAIN;
+        }
+    }
+
+    kernel::IntrusiveRef<futex_entry_t> from = futex_table.acquire_entry(key, false);
+
+    if (!from) {
+        return 0;
+    }
+
+    if (key == key2 || nr_requeue == 0u) {
+        return futex_do_wake(from.get(), nr_wake);
+    }
+
+    kernel::IntrusiveRef<futex_entry_t> to = futex_table.acquire_entry(key2, true);
+
+    if (!to) {
+        return -1;
+    }
+
+    uint32_t moved = 0u;
+    const uint32_t woken = futex_do_requeue(from.get(), to.get(), nr_wake, nr_requeue, &moved);
+
+    for (uint32_t i = 0; i < moved; i++) {
+        zswap_unpin_phys(futex_key_to_phys(key));
+    }
+
+    trace_event(YOS_TRACE_FUTEX_REQUEUE, key, key2, woken, moved);
+
+    return (int)(woken + moved);
+}
+
+extern "C" int futex_wake_op(
+    uint32_t key, uint32_t key2,
+    volatile uint32_t* uaddr2,
+    uint32_t nr_wake, uint32_t nr_wake2,
+    uint32_t op, uint32_t oparg,
+    uint32_t cmp, uint32_t cmparg
+) {
+    if (cmp > YOS_FUTEX_OP_CMP_GE) {
+        return -1;
+    }
+
+    uint32_t old = 0u;
+    if (uaccess_copy_from_user(&old, (const void*)uaddr2, sizeof(old)) != 0) {
+        return -1;
+    }
+
+    for (;;) {
+        uint32_t next = 0u;
+        if (!futex_op_apply(op, oparg, old, &next)) {
+            return -1;
+        }
+
+        uint32_t seen = old;
+        if (uaccess_cmpxchg_user_u32(uaddr2, &seen, next) != 0) {
+            return -1;
+        }
+
+        if (seen == old) {
+            break;
+        }
+
+        old = seen;
+    }
+
+    int woken = futex_wake(key, nr_wake);
+
+    if (futex_op_cmp(cmp, old, cmparg)) {
+        woken += futex_wake(key2, nr_wake2);
+    }
+
+    return woken;
+}
+
+extern "C" int futex_lock_pi(uint32_t key, volatile uint32_t* uaddr, const uint32_t* deadline_tick) {
+    task_t* curr = proc_current();
+
+    if (!curr || !uaddr) {
+        return -1;
+    }
+
+    kernel::IntrusiveRef<futex_entry_t> entry_ref = futex_table.acquire_entry(key, true);
+
+    if (!entry_ref) {
+        return -1;
+    }
+
+    return futex_do_lock_pi(entry_ref.get(), curr, uaddr, deadline_tick);
+}
+
+extern "C" int futex_unlock_pi(uint32_t key, volatile uint32_t* uaddr) {
+    task_t* curr = proc_current();
+
+    if (!curr || !uaddr) {
+        return -1;
+    }
+
+    /* Created if need be: a waiter setting YOS_FUTEX_WAITERS must not slip past the unlock. */
+    kernel::IntrusiveRef<futex_entry_t> entry_ref = futex_table.acquire_entry(key, true);
+
+    if (!entry_ref) {
+        return -1;
+    }
+
+    return futex_do_unlock_pi(entry_ref.get(), curr, uaddr);
+}
+
 extern "C" void futex_remove_task(struct task* t) {
     if (!t) {
         return;
     }
 
-    void* raw_sem = __atomic_load_n(&t->blocked_on_sem, __ATOMIC_ACQUIRE);
-    if (!raw_sem || t->blocked_kind != TASK_BLOCK_FUTEX) {
+    (void)futex_unqueue_task(t);
+}
+
+extern "C" void futex_pi_exit(struct task* t) {
+    if (!t) {
         return;
     }
 
-    auto* entry = static_cast<futex_entry_t*>(raw_sem);
+    for (;;) {
+        kernel::RcuReadGuard rcu_guard;
 
-    kernel::SpinLockSafeGuard guard(entry->lock);
+        futex_entry_t* entry = nullptr;
 
-    waitqueue_wait_cancel_locked(&entry->waitq, t);
-}
\ No newline at end of file
+        {
+            kernel::SpinLockSafeGuard pi_guard(g_pi_lock);
+
+            if (dlist_empty(&t->pi_owned)) {
+                return;
+            }
+
+            entry = container_of(t->pi_owned.next, futex_entry_t, pi_node);
+        }
+
+        kernel::SpinLockSafeGuard guard(entry->lock);
+        kernel::SpinLockGuard pi_guard(g_pi_lock);
+
+        if (entry->pi_owner != t) {
+            continue;
+        }
+
+        /* The woken waiter finds the owner dead and takes the lock over. */
+        task_t* next = pi_top_waiter_locked(entry);
+
+        pi_set_owner_locked(entry, nullptr);
+
+        if (next) {
+            waitqueue_wait_cancel_locked(&entry->waitq, next);
+            next->pi_blocked_on = nullptr;
+
+            waitqueue_wake_task(next);
+        }
+    }
+}
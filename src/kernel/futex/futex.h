@@ -1,19 +1,74 @@
 #ifndef KERNEL_FUTEX_FUTEX_H
 #define KERNEL_FUTEX_FUTEX_H
 
+#include <lib/types.h>
+
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-int futex_wait(uint32_t key, volatile const uint32_t* uaddr, uint32_t expected);
+/*
+ * Futexes are keyed by physical address. The word is 4-byte aligned, so the
+ * key drops the two low bits to cover the whole PAE physical range in 32 bits.
+ */
+static inline uint32_t futex_key_from_phys(phys_addr_t phys) {
+    return (uint32_t)(phys >> 2);
+}
+
+static inline phys_addr_t futex_key_to_phys(uint32_t key) {
+    return (phys_addr_t)key << 2;
+}
+
+/*
+ * Sleep while *uaddr == expected, until woken or, with a non-null
+ * `deadline_tick`, until timer_ticks reaches it. The caller pins the frame
+ * behind *key; a requeue hands the waiter and its pin over to another futex,
+ * and *key is updated to the one the caller has to unpin on return.
+ */
+int futex_wait(uint32_t* key, volatile const uint32_t* uaddr, uint32_t expected, const uint32_t* deadline_tick);
 
 int futex_wake(uint32_t key, uint32_t max_wake);
 
+/*
+ * Wake up to nr_wake waiters on `key` and move up to nr_requeue of the rest
+ * onto `key2` without waking them. With a non-null `cmpval` nothing happens
+ * unless *uaddr still holds it. Returns woken plus requeued.
+ */
+int futex_requeue(
+    uint32_t key, uint32_t key2,
+    volatile const uint32_t* uaddr, const uint32_t* cmpval,
+    uint32_t nr_wake, uint32_t nr_requeue
+);
+
+/* Atomically update *uaddr2 and wake waiters on both keys, see yos_futex_wake_op_t. */
+int futex_wake_op(
+    uint32_t key, uint32_t key2,
+    volatile uint32_t* uaddr2,
+    uint32_t nr_wake, uint32_t nr_wake2,
+    uint32_t op, uint32_t oparg,
+    uint32_t cmp, uint32_t cmparg
+);
+
+/*
+ * Take the priority-inheritance lock at *uaddr (see YOS_FUTEX_WAITERS),
+ * sleeping until its owner hands it over and lending the owner, and whoever
+ * that owner waits on in turn, the caller's priority meanwhile. The caller
+ * has checked that the word is writable and pins its frame, as the word is
+ * updated under the futex locks.
+ */
+int futex_lock_pi(uint32_t key, volatile uint32_t* uaddr, const uint32_t* deadline_tick);
+
+/* Hand the PI lock at *uaddr to its highest-priority waiter, or free it. */
+int futex_unlock_pi(uint32_t key, volatile uint32_t* uaddr);
+
 struct task;
 void futex_remove_task(struct task* t);
 
+/* Wake a waiter on each PI futex an exiting task still owns, to take it over. */
+void futex_pi_exit(struct task* t);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,8 +16,14 @@
 
 #include <kernel/smp/cpu.h>
 
+#include <lib/string.h>
+
 #include "boot.h"
 
+#define BOOT_CMDLINE_MAX 256u
+
+static char g_boot_cmdline[BOOT_CMDLINE_MAX];
+
 static void halt_forever(void) {
     __asm__ volatile("cli");
     while (1) __asm__ volatile("hlt");
@@ -42,6 +48,43 @@ void validate_multiboot(uint32_t magic, const multiboot_info_t* mb_info) {
     }
 }
 
+void boot_cmdline_init(const multiboot_info_t* mb_info) {
+    g_boot_cmdline[0] = '\0';
+
+    if (!mb_info || !(mb_info->flags & (1u << 2)) || mb_info->cmdline == 0u) {
+        return;
+    }
+
+    strlcpy(g_boot_cmdline, (const char*)mb_info->cmdline, sizeof(g_boot_cmdline));
+}
+
+int boot_cmdline_has(const char* word) {
+    if (!word || !word[0]) {
+        return 0;
+    }
+
+    const size_t len = strlen(word);
+    const char* p = g_boot_cmdline;
+
+    while (*p) {
+        while (*p == ' ') {
+            p++;
+        }
+
+        const char* start = p;
+
+        while (*p && *p != ' ') {
+            p++;
+        }
+
+        if ((size_t)(p - start) == len && strncmp(start, word, len) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
 void init_fb_info(const multiboot_info_t* mb_info) {
     fb_ptr = (uint32_t*)(uint32_t)mb_info->framebuffer_addr;
     fb_width = mb_info->framebuffer_width;
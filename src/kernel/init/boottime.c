@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <kernel/output/kprintf.h>
+
+#include <hal/delay.h>
+
+#include "boottime.h"
+
+#define BOOTTIME_MAX_STAGES 32u
+#define BOOTTIME_MAX_PROBES 64u
+
+typedef struct {
+    const char* name;
+    uint64_t tsc;
+} boottime_stage_t;
+
+typedef struct {
+    const char* name;
+    uint64_t cycles;
+    int cpu;
+} boottime_probe_t;
+
+static uint64_t g_boot_tsc;
+
+static boottime_stage_t g_stages[BOOTTIME_MAX_STAGES];
+static volatile uint32_t g_stage_count;
+
+static boottime_probe_t g_probes[BOOTTIME_MAX_PROBES];
+static volatile uint32_t g_probe_count;
+
+static volatile uint32_t g_reported;
+
+static uint32_t boottime_us(uint64_t cycles) {
+    const uint64_t khz = g_cpu_tsc_hz / 1000ull;
+
+    if (khz == 0u) {
+        return 0u;
+    }
+
+    const uint64_t us = (cycles * 1000ull) / khz;
+
+    return us > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)us;
+}
+
+void boottime_start(void) {
+    g_boot_tsc = boottime_clock();
+}
+
+void boottime_mark(const char* name) {
+    const uint64_t now = boottime_clock();
+    const uint32_t slot = __atomic_fetch_add(&g_stage_count, 1u, __ATOMIC_RELAXED);
+
+    if (slot >= BOOTTIME_MAX_STAGES) {
+        return;
+    }
+
+    g_stages[slot].name = name;
+    g_stages[slot].tsc = now;
+}
+
+void boottime_probe(const char* name, int cpu, uint64_t cycles) {
+    const uint32_t slot = __atomic_fetch_add(&g_probe_count, 1u, __ATOMIC_RELAXED);
+
+    if (slot >= BOOTTIME_MAX_PROBES) {
+        return;
+    }
+
+    g_probes[slot].name = name;
+    g_probes[slot].cycles = cycles;
+    g_probes[slot].cpu = cpu;
+}
+
+void boottime_report(void) {
+    if (__atomic_exchange_n(&g_reported, 1u, __ATOMIC_ACQ_REL) != 0u) {
+        return;
+    }
+
+    uint32_t stages = __atomic_load_n(&g_stage_count, __ATOMIC_ACQUIRE);
+    uint32_t probes = __atomic_load_n(&g_probe_count, __ATOMIC_ACQUIRE);
+
+    if (stages > BOOTTIME_MAX_STAGES) {
+        stages = BOOTTIME_MAX_STAGES;
+    }
+
+    if (probes > BOOTTIME_MAX_PROBES) {
+        probes = BOOTTIME_MAX_PROBES;
+    }
+
+    kprintf("[boot] report tsc_khz=%u stages=%u probes=%u\n", (uint32_t)(g_cpu_tsc_hz / 1000ull), stages, probes);
+
+    uint64_t prev = g_boot_tsc;
+
+    for (uint32_t i = 0; i < stages; i++) {
+        const boottime_stage_t* s = &g_stages[i];
+
+        /* A mark taken on another CPU can read a TSC a little behind ours. */
+        const uint64_t delta = s->tsc > prev ? s->tsc - prev : 0u;
+        const uint64_t at = s->tsc > g_boot_tsc ? s->tsc - g_boot_tsc : 0u;
+
+        kprintf(
+            "[boot] stage=%s time_us=%u at_us=%u\n",
+            s->name ? s->name : "?",
+            boottime_us(delta),
+            boottime_us(at)
+        );
+
+        if (s->tsc > prev) {
+            prev = s->tsc;
+        }
+    }
+
+    for (uint32_t i = 0; i < probes; i++) {
+        const boottime_probe_t* p = &g_probes[i];
+
+        kprintf(
+            "[boot] probe=%s cpu=%d time_us=%u\n",
+            p->name ? p->name : "<noname>",
+            p->cpu,
+            boottime_us(p->cycles)
+        );
+    }
+}
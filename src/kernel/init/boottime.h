@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef KERNEL_INIT_BOOTTIME_H
+#define KERNEL_INIT_BOOTTIME_H
+
+#include <lib/compiler.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Boot-time profile. Stages are raw TSC stamps taken as boot goes along;
+ * they are converted with the calibrated rate only when the report is
+ * printed, so marks taken before calibration are fine too.
+ */
+
+___inline uint64_t boottime_clock(void) {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | (uint64_t)lo;
+}
+
+/* Start of the profile; the first mark is measured from here. */
+void boottime_start(void);
+
+/* End of the boot stage `name`, which began at the previous mark. */
+void boottime_mark(const char* name);
+
+/* One driver init that took `cycles` on logical CPU `cpu`. */
+void boottime_probe(const char* name, int cpu, uint64_t cycles);
+
+/* Print stages and probes to the kernel log, once. */
+void boottime_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <mm/heap.h>
 
+#include "boottime.h"
 #include "init.h"
 
 static void init_task_prepare_dirs(void) {
@@ -141,6 +142,10 @@ void init_task(void* arg) {
 
     init_task_set_cwd(self);
 
+    /* Everything up to here is time-to-shell. */
+    boottime_mark("init");
+    boottime_report();
+
     init_task_spawn_shell_loop(self, tty);
 }
 
@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/cpp/new.h>
+
+#include <kernel/waitq/poll_waitq.h>
+#include <kernel/ipc/channel.h>
+#include <kernel/futex/futex.h>
+
+#include <lib/string.h>
+
+#include <arch/i386/paging.h>
+
+#include <mm/heap.h>
+#include <mm/pmm.h>
+
+#include <yos/channel.h>
+#include <yos/ioctl.h>
+
+#include <stddef.h>
+
+namespace {
+
+constexpr uint32_t k_page_size = 4096u;
+constexpr uint32_t k_page_count = YOS_CHAN_MAP_SIZE / k_page_size;
+
+static_assert(sizeof(yos_chan_shared_t) <= YOS_CHAN_HDR_SIZE);
+static_assert((YOS_CHAN_RING_SIZE & (YOS_CHAN_RING_SIZE - 1u)) == 0u);
+
+struct IpcChannel;
+
+struct IpcChannelEnd {
+    IpcChannel* chan;
+    uint32_t side;
+};
+
+struct IpcChannel {
+    poll_waitq_t poll_waitq;
+
+    volatile uint32_t refs;
+
+    IpcChannelEnd ends[2];
+
+    /* Lowmem frames: the kernel reaches the header through its identity mapping. */
+    uint32_t pages[k_page_count];
+
+    yos_chan_shared_t* shared() const {
+        return (yos_chan_shared_t*)pages[0];
+    }
+
+    uint32_t word_key(uint32_t ring, size_t field) const {
+        const size_t off = offsetof(yos_chan_shared_t, ring) + ring * sizeof(yos_chan_ring_t) + field;
+
+        return futex_key_from_phys((phys_addr_t)pages[0] + off);
+    }
+
+    /* The peer of `side` sleeps on the head of the ring it reads and the tail of the one it writes. */
+    void wake_peer(uint32_t side, uint32_t events) {
+        const uint32_t peer = side ^ 1u;
+
+        poll_waitq_wake_all(&poll_waitq, events);
+
+        if (events & (VFS_POLLIN | VFS_POLLHUP)) {
+            (void)futex_wake(word_key(side, offsetof(yos_chan_ring_t, head)), 0x7FFFFFFFu);
+        }
+
+        if (events & (VFS_POLLOUT | VFS_POLLHUP)) {
+            (void)futex_wake(word_key(peer, offsetof(yos_chan_ring_t, tail)), 0x7FFFFFFFu);
+        }
+    }
+
+    void free_pages() {
+        for (uint32_t i = 0; i < k_page_count; i++) {
+            if (pages[i] != 0u) {
+                pmm_free_block((void*)pages[i]);
+            }
+
+            pages[i] = 0u;
+        }
+    }
+
+    bool alloc_pages() {
+        for (uint32_t i = 0; i < k_page_count; i++) {
+            void* p = pmm_alloc_block();
+
+            if (!p) {
+                free_pages();
+                return false;
+            }
+
+            paging_zero_phys_page((uint32_t)p);
+
+            pages[i] = (uint32_t)p;
+        }
+
+        yos_chan_shared_t* sh = shared();
+
+        sh->magic = YOS_CHAN_MAGIC;
+        sh->version = YOS_CHAN_VERSION;
+        sh->ring_size = YOS_CHAN_RING_SIZE;
+        sh->data_offset = YOS_CHAN_HDR_SIZE;
+
+        return true;
+    }
+};
+
+static IpcChannelEnd* chan_end(vfs_node_t* node) {
+    if (!node || (node->flags & VFS_FLAG_IPC_CHAN) == 0u) {
+        return nullptr;
+    }
+
+    auto* end = static_cast<IpcChannelEnd*>(node->private_data);
+
+    return (end && end->chan) ? end : nullptr;
+}
+
+static void chan_poll_waitq_finalize(void* ctx) {
+    auto* chan = static_cast<IpcChannel*>(ctx);
+
+    if (!chan) {
+        return;
+    }
+
+    chan->free_pages();
+
+    delete chan;
+}
+
+}
+
+extern "C" {
+
+static void chan_private_retain(void* private_data) {
+    auto* end = static_cast<IpcChannelEnd*>(private_data);
+
+    if (!end || !end->chan) {
+        return;
+    }
+
+    __atomic_fetch_add(&end->chan->refs, 1u, __ATOMIC_RELAXED);
+}
+
+static void chan_private_release(void* private_data) {
+    auto* end = static_cast<IpcChannelEnd*>(private_data);
+
+    if (!end || !end->chan) {
+        return;
+    }
+
+    IpcChannel* chan = end->chan;
+
+    if (__atomic_sub_fetch(&chan->refs, 1u, __ATOMIC_ACQ_REL) != 0u) {
+        return;
+    }
+
+    poll_waitq_detach_all(&chan->poll_waitq);
+    poll_waitq_put(&chan->poll_waitq);
+}
+
+static int chan_close(vfs_node_t* node) {
+    IpcChannelEnd* end = chan_end(node);
+
+    if (!end) {
+        return -1;
+    }
+
+    (void)__atomic_fetch_or(&end->chan->shared()->closed, 1u << end->side, __ATOMIC_SEQ_CST);
+
+    end->chan->wake_peer(end->side, VFS_POLLHUP | VFS_POLLIN | VFS_POLLOUT);
+
+    return 0;
+}
+
+static uint32_t chan_get_phys_page(vfs_node_t* node, uint32_t offset) {
+    IpcChannelEnd* end = chan_end(node);
+
+    if (!end) {
+        return 0u;
+    }
+
+    const uint32_t idx = offset / k_page_size;
+
+    return idx < k_page_count ? end->chan->pages[idx] : 0u;
+}
+
+/*
+ * The positions come from user memory and are only compared: a peer that
+ * scribbles over them can make poll() lie to itself and nothing else.
+ */
+static int chan_poll_status(vfs_node_t* node, int events) {
+    IpcChannelEnd* end = chan_end(node);
+
+    if (!end) {
+        return VFS_POLLNVAL;
+    }
+
+    const yos_chan_shared_t* sh = end->chan->shared();
+
+    const yos_chan_ring_t* rx = &sh->ring[end->side ^ 1u];
+    const yos_chan_ring_t* tx = &sh->ring[end->side];
+
+    int ready = 0;
+
+    if (events & VFS_POLLIN) {
+        if (__atomic_load_n(&rx->head, __ATOMIC_ACQUIRE) != __atomic_load_n(&rx->tail, __ATOMIC_ACQUIRE)) {
+            ready |= VFS_POLLIN;
+        }
+    }
+
+    if (events & VFS_POLLOUT) {
+        const uint32_t used = __atomic_load_n(&tx->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&tx->tail, __ATOMIC_ACQUIRE);
+
+        uint32_t need = __atomic_load_n(&tx->want_space, __ATOMIC_ACQUIRE);
+
+        if (need == 0u || need > YOS_CHAN_RING_SIZE) {
+            need = 1u;
+        }
+
+        if (used <= YOS_CHAN_RING_SIZE && YOS_CHAN_RING_SIZE - used >= need) {
+            ready |= VFS_POLLOUT;
+        }
+    }
+
+    if (__atomic_load_n(&sh->closed, __ATOMIC_ACQUIRE) & (1u << (end->side ^ 1u))) {
+        ready |= VFS_POLLHUP;
+    }
+
+    return ready;
+}
+
+static int chan_poll_register(vfs_node_t* node, poll_waiter_t* w, task_t* task) {
+    IpcChannelEnd* end = chan_end(node);
+
+    if (!end || !w || !task) {
+        return -1;
+    }
+
+    return poll_waitq_register(&end->chan->poll_waitq, w, task);
+}
+
+static int chan_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    IpcChannelEnd* end = chan_end(node);
+
+    if (!end || !arg) {
+        return -1;
+    }
+
+    switch (req) {
+        case YOS_CHAN_GET_INFO: {
+            yos_chan_info_t* info = (yos_chan_info_t*)arg;
+
+            info->map_size = YOS_CHAN_MAP_SIZE;
+            info->ring_size = YOS_CHAN_RING_SIZE;
+            info->side = end->side;
+
+            return 0;
+        }
+
+        case YOS_CHAN_NOTIFY: {
+            const uint32_t events = *(const uint32_t*)arg;
+
+            if (events == 0u || (events & ~(uint32_t)(VFS_POLLIN | VFS_POLLOUT)) != 0u) {
+                return -1;
+            }
+
+            end->chan->wake_peer(end->side, events);
+
+            return 0;
+        }
+
+        default:
+            return -1;
+    }
+}
+
+static vfs_ops_t chan_ops = {
+    .read = nullptr,
+    .write = nullptr,
+    .open = nullptr,
+    .close = chan_close,
+    .ioctl = chan_ioctl,
+    .get_phys_page = chan_get_phys_page,
+    .poll_status = chan_poll_status,
+    .poll_register = chan_poll_register,
+    .read_user = nullptr,
+    .write_user = nullptr,
+};
+
+int ipc_channel_create(vfs_node_t** out_side0, vfs_node_t** out_side1) {
+    if (!out_side0 || !out_side1) {
+        return -1;
+    }
+
+    *out_side0 = nullptr;
+    *out_side1 = nullptr;
+
+    IpcChannel* chan = new (kernel::nothrow) IpcChannel();
+
+    if (!chan) {
+        return -1;
+    }
+
+    if (!chan->alloc_pages()) {
+        delete chan;
+        return -1;
+    }
+
+    vfs_node_t* nodes[2];
+
+    nodes[0] = (vfs_node_t*)kmalloc(sizeof(vfs_node_t));
+    nodes[1] = (vfs_node_t*)kmalloc(sizeof(vfs_node_t));
+
+    if (!nodes[0] || !nodes[1]) {
+        if (nodes[0]) kfree(nodes[0]);
+        if (nodes[1]) kfree(nodes[1]);
+
+        chan->free_pages();
+        delete chan;
+
+        return -1;
+    }
+
+    chan->refs = 2u;
+
+    for (uint32_t side = 0; side < 2u; side++) {
+        vfs_node_t* node = nodes[side];
+
+        chan->ends[side].chan = chan;
+        chan->ends[side].side = side;
+
+        memset(node, 0, sizeof(*node));
+        strlcpy(node->name, "chan", sizeof(node->name));
+
+        node->flags = VFS_FLAG_IPC_CHAN;
+        node->size = YOS_CHAN_MAP_SIZE;
+        node->refs = 1u;
+        node->ops = &chan_ops;
+        node->private_data = &chan->ends[side];
+        node->private_retain = chan_private_retain;
+        node->private_release = chan_private_release;
+    }
+
+    poll_waitq_init_finalizable(&chan->poll_waitq, chan_poll_waitq_finalize, chan);
+
+    *out_side0 = nodes[0];
+    *out_side1 = nodes[1];
+
+    return 0;
+}
+
+}
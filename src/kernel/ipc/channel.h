@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef KERNEL_IPC_CHANNEL_H
+#define KERNEL_IPC_CHANNEL_H
+
+#include <fs/vfs.h>
+
+/*
+ * IPC channels (see yos/channel.h).
+ *
+ * A channel is a zeroed YOS_CHAN_MAP_SIZE block of lowmem pages shared by
+ * two VFS nodes (VFS_FLAG_IPC_CHAN), one per side. Each node maps the whole
+ * block through get_phys_page, polls on the ring positions in its header and
+ * takes the YOS_CHAN_NOTIFY doorbell. Closing a side marks it in the header
+ * and wakes the other one.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int ipc_channel_create(vfs_node_t** out_side0, vfs_node_t** out_side1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
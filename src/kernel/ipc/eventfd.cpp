@@ -0,0 +1,714 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/cpp/lock_guard.h>
+#include <lib/cpp/new.h>
+
+#include <kernel/waitq/poll_waitq.h>
+#include <kernel/uaccess/uaccess.h>
+#include <kernel/ipc/eventfd.h>
+#include <kernel/locking/sem.h>
+
+#include <lib/string.h>
+#include <lib/dlist.h>
+
+#include <hal/apic.h>
+
+#include <mm/heap.h>
+
+#include <yos/eventfd.h>
+#include <yos/ioctl.h>
+
+extern volatile uint32_t timer_ticks;
+
+namespace {
+
+constexpr uint32_t k_payload = (uint32_t)sizeof(uint64_t);
+
+/*
+ * Tasks about to sleep count themselves in `count` under the object's
+ * lock. A wake takes the count under the same lock and hands each of them a
+ * token, so none is missed between dropping the lock and sem_wait(). A token
+ * left over from an earlier wake only costs a recheck.
+ */
+struct Sleepers {
+    semaphore_t sem;
+    uint32_t count;
+
+    void init() {
+        sem_init(&sem, 0);
+        count = 0u;
+    }
+
+    uint32_t take() {
+        const uint32_t n = count;
+        count = 0u;
+        return n;
+    }
+
+    void wake(uint32_t n) {
+        while (n-- != 0u) {
+            sem_signal(&sem);
+        }
+    }
+};
+
+struct EventCounter {
+    poll_waitq_t poll_waitq;
+
+    kernel::SpinLock lock;
+
+    uint64_t value;
+    uint32_t flags;
+
+    Sleepers readers;
+    Sleepers writers;
+
+    volatile uint32_t refs;
+};
+
+/* Everything but poll_waitq and refs is under g_timer_lock, which the timer interrupt takes. */
+struct EventTimer {
+    poll_waitq_t poll_waitq;
+
+    dlist_head_t armed_node;
+
+    uint32_t deadline;
+    uint32_t interval;
+    uint64_t expirations;
+    uint32_t flags;
+
+    Sleepers readers;
+
+    volatile uint32_t refs;
+};
+
+kernel::SpinLock g_timer_lock;
+
+dlist_head_t g_armed_timers = { &g_armed_timers, &g_armed_timers };
+
+/* Read locklessly by the tick: no armed timer, or none due before g_next_deadline. */
+volatile uint32_t g_armed_count;
+volatile uint32_t g_next_deadline;
+
+static bool tick_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static uint32_t ms_to_ticks(uint32_t ms) {
+    uint64_t t = ((uint64_t)ms * KERNEL_TIMER_HZ + 999ull) / 1000ull;
+
+    /* Deadlines are compared modulo 2^32, so keep them within half of it. */
+    if (t > 0x7FFFFFFFull) {
+        t = 0x7FFFFFFFull;
+    }
+
+    return (uint32_t)t;
+}
+
+static uint32_t ticks_to_ms(uint32_t ticks) {
+    const uint64_t ms = ((uint64_t)ticks * 1000ull) / KERNEL_TIMER_HZ;
+
+    return ms > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)ms;
+}
+
+static int copy_payload_out(void* dst, const uint64_t* value, int is_user) {
+    if (is_user) {
+        return uaccess_copy_to_user(dst, value, k_payload);
+    }
+
+    memcpy(dst, value, k_payload);
+    return 0;
+}
+
+static EventCounter* counter_of(vfs_node_t* node) {
+    if (!node || (node->flags & VFS_FLAG_EVENTFD) == 0u) {
+        return nullptr;
+    }
+
+    return static_cast<EventCounter*>(node->private_data);
+}
+
+static EventTimer* timer_of(vfs_node_t* node) {
+    if (!node || (node->flags & VFS_FLAG_TIMERFD) == 0u) {
+        return nullptr;
+    }
+
+    return static_cast<EventTimer*>(node->private_data);
+}
+
+static void timer_disarm_locked(EventTimer* t) {
+    if (!dlist_node_linked(&t->armed_node)) {
+        return;
+    }
+
+    dlist_del(&t->armed_node);
+
+    __atomic_sub_fetch(&g_armed_count, 1u, __ATOMIC_RELAXED);
+}
+
+static void timer_arm_locked(EventTimer* t, uint32_t deadline) {
+    t->deadline = deadline;
+
+    if (!dlist_node_linked(&t->armed_node)) {
+        dlist_add_tail(&t->armed_node, &g_armed_timers);
+
+        __atomic_add_fetch(&g_armed_count, 1u, __ATOMIC_RELAXED);
+    }
+
+    if (g_armed_count == 1u || tick_before(deadline, g_next_deadline)) {
+        __atomic_store_n(&g_next_deadline, deadline, __ATOMIC_RELAXED);
+    }
+}
+
+static void counter_poll_waitq_finalize(void* ctx) {
+    delete static_cast<EventCounter*>(ctx);
+}
+
+static void timer_poll_waitq_finalize(void* ctx) {
+    delete static_cast<EventTimer*>(ctx);
+}
+
+}
+
+extern "C" {
+
+static void counter_private_retain(void* private_data) {
+    auto* ec = static_cast<EventCounter*>(private_data);
+
+    if (ec) {
+        __atomic_fetch_add(&ec->refs, 1u, __ATOMIC_RELAXED);
+    }
+}
+
+static void counter_private_release(void* private_data) {
+    auto* ec = static_cast<EventCounter*>(private_data);
+
+    if (!ec || __atomic_sub_fetch(&ec->refs, 1u, __ATOMIC_ACQ_REL) != 0u) {
+        return;
+    }
+
+    poll_waitq_detach_all(&ec->poll_waitq);
+    poll_waitq_put(&ec->poll_waitq);
+}
+
+static int counter_read_impl(vfs_node_t* node, uint32_t size, void* buffer, int is_user) {
+    EventCounter* ec = counter_of(node);
+
+    if (!ec || !buffer || size < k_payload) {
+        return -1;
+    }
+
+    /* Fault now rather than after the counter has been taken. */
+    const uint64_t zero = 0ull;
+
+    if (copy_payload_out(buffer, &zero, is_user) != 0) {
+        return -1;
+    }
+
+    const bool block = (ec->flags & YOS_EFD_NONBLOCK) == 0u;
+
+    for (;;) {
+        uint64_t taken = 0ull;
+        uint32_t wake_writers = 0u;
+        bool was_full = false;
+
+        {
+            kernel::SpinLockSafeGuard guard(ec->lock);
+
+            if (ec->value != 0ull) {
+                taken = (ec->flags & YOS_EFD_SEMAPHORE) ? 1ull : ec->value;
+                was_full = ec->value == YOS_EFD_MAX;
+
+                ec->value -= taken;
+
+                wake_writers = ec->writers.take();
+            } else if (block) {
+                ec->readers.count++;
+            }
+        }
+
+        if (taken != 0ull) {
+            ec->writers.wake(wake_writers);
+
+            if (was_full) {
+                poll_waitq_wake_all(&ec->poll_waitq, VFS_POLLOUT);
+            }
+
+            return copy_payload_out(buffer, &taken, is_user) == 0 ? (int)k_payload : -1;
+        }
+
+        if (!block) {
+            return 0;
+        }
+
+        sem_wait(&ec->readers.sem);
+    }
+}
+
+static int counter_write_impl(vfs_node_t* node, uint32_t size, const void* buffer, int is_user) {
+    EventCounter* ec = counter_of(node);
+
+    if (!ec || !buffer || size < k_payload) {
+        return -1;
+    }
+
+    uint64_t add;
+
+    if (is_user) {
+        if (uaccess_copy_from_user(&add, buffer, k_payload) != 0) {
+            return -1;
+        }
+    } else {
+        memcpy(&add, buffer, k_payload);
+    }
+
+    if (add > YOS_EFD_MAX) {
+        return -1;
+    }
+
+    if (add == 0ull) {
+        return (int)k_payload;
+    }
+
+    const bool block = (ec->flags & YOS_EFD_NONBLOCK) == 0u;
+
+    for (;;) {
+        bool added = false;
+        bool was_empty = false;
+        uint32_t wake_readers = 0u;
+
+        {
+            kernel::SpinLockSafeGuard guard(ec->lock);
+
+            if (ec->value <= YOS_EFD_MAX - add) {
+                was_empty = ec->value == 0ull;
+                ec->value += add;
+                added = true;
+
+                wake_readers = ec->readers.take();
+            } else if (block) {
+                ec->writers.count++;
+            }
+        }
+
+        if (added) {
+            ec->readers.wake(wake_readers);
+
+            /* poll() registers before it looks, so only the first event needs a wake. */
+            if (was_empty) {
+                poll_waitq_wake_all(&ec->poll_waitq, VFS_POLLIN);
+            }
+
+            return (int)k_payload;
+        }
+
+        if (!block) {
+            return 0;
+        }
+
+        sem_wait(&ec->writers.sem);
+    }
+}
+
+static int counter_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)offset;
+    return counter_read_impl(node, size, buffer, 0);
+}
+
+static int counter_write(vfs_node_t* node, uint32_t offset, uint32_t size, const void* buffer) {
+    (void)offset;
+    return counter_write_impl(node, size, buffer, 0);
+}
+
+static int counter_read_user(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)offset;
+    return counter_read_impl(node, size, buffer, 1);
+}
+
+static int counter_write_user(vfs_node_t* node, uint32_t offset, uint32_t size, const void* buffer) {
+    (void)offset;
+    return counter_write_impl(node, size, buffer, 1);
+}
+
+static int counter_poll_status(vfs_node_t* node, int events) {
+    EventCounter* ec = counter_of(node);
+
+    if (!ec) {
+        return VFS_POLLNVAL;
+    }
+
+    uint64_t value;
+
+    {
+        kernel::SpinLockSafeGuard guard(ec->lock);
+        value = ec->value;
+    }
+
+    int ready = 0;
+
+    if ((events & VFS_POLLIN) && value != 0ull) {
+        ready |= VFS_POLLIN;
+    }
+
+    if ((events & VFS_POLLOUT) && value < YOS_EFD_MAX) {
+        ready |= VFS_POLLOUT;
+    }
+
+    return ready;
+}
+
+static int counter_poll_register(vfs_node_t* node, poll_waiter_t* w, task_t* task) {
+    EventCounter* ec = counter_of(node);
+
+    if (!ec || !w || !task) {
+        return -1;
+    }
+
+    return poll_waitq_register(&ec->poll_waitq, w, task);
+}
+
+static vfs_ops_t counter_ops = {
+    .read = counter_read,
+    .write = counter_write,
+    .open = nullptr,
+    .close = nullptr,
+    .ioctl = nullptr,
+    .get_phys_page = nullptr,
+    .poll_status = counter_poll_status,
+    .poll_register = counter_poll_register,
+    .read_user = counter_read_user,
+    .write_user = counter_write_user,
+};
+
+static void timer_private_retain(void* private_data) {
+    auto* t = static_cast<EventTimer*>(private_data);
+
+    if (t) {
+        __atomic_fetch_add(&t->refs, 1u, __ATOMIC_RELAXED);
+    }
+}
+
+static void timer_private_release(void* private_data) {
+    auto* t = static_cast<EventTimer*>(private_data);
+
+    if (!t || __atomic_sub_fetch(&t->refs, 1u, __ATOMIC_ACQ_REL) != 0u) {
+        return;
+    }
+
+    /* Once off the list the tick cannot reach it any more. */
+    {
+        kernel::SpinLockSafeGuard guard(g_timer_lock);
+        timer_disarm_locked(t);
+    }
+
+    poll_waitq_detach_all(&t->poll_waitq);
+    poll_waitq_put(&t->poll_waitq);
+}
+
+static int timer_read_impl(vfs_node_t* node, uint32_t size, void* buffer, int is_user) {
+    EventTimer* t = timer_of(node);
+
+    if (!t || !buffer || size < k_payload) {
+        return -1;
+    }
+
+    const uint64_t zero = 0ull;
+
+    if (copy_payload_out(buffer, &zero, is_user) != 0) {
+        return -1;
+    }
+
+    const bool block = (t->flags & YOS_TFD_NONBLOCK) == 0u;
+
+    for (;;) {
+        uint64_t fired = 0ull;
+
+        {
+            kernel::SpinLockSafeGuard guard(g_timer_lock);
+
+            fired = t->expirations;
+            t->expirations = 0ull;
+
+            if (fired == 0ull && block) {
+                t->readers.count++;
+            }
+        }
+
+        if (fired != 0ull) {
+            return copy_payload_out(buffer, &fired, is_user) == 0 ? (int)k_payload : -1;
+        }
+
+        if (!block) {
+            return 0;
+        }
+
+        sem_wait(&t->readers.sem);
+    }
+}
+
+static int timer_read(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)offset;
+    return timer_read_impl(node, size, buffer, 0);
+}
+
+static int timer_read_user(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)offset;
+    return timer_read_impl(node, size, buffer, 1);
+}
+
+static int timer_poll_status(vfs_node_t* node, int events) {
+    EventTimer* t = timer_of(node);
+
+    if (!t) {
+        return VFS_POLLNVAL;
+    }
+
+    if ((events & VFS_POLLIN) == 0) {
+        return 0;
+    }
+
+    kernel::SpinLockSafeGuard guard(g_timer_lock);
+
+    return t->expirations != 0ull ? VFS_POLLIN : 0;
+}
+
+static int timer_poll_register(vfs_node_t* node, poll_waiter_t* w, task_t* task) {
+    EventTimer* t = timer_of(node);
+
+    if (!t || !w || !task) {
+        return -1;
+    }
+
+    return poll_waitq_register(&t->poll_waitq, w, task);
+}
+
+static int timer_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    EventTimer* t = timer_of(node);
+
+    if (!t || !arg) {
+        return -1;
+    }
+
+    switch (req) {
+        case YOS_TFD_SETTIME: {
+            const yos_timerspec_t spec = *(const yos_timerspec_t*)arg;
+
+            if ((spec.flags & ~YOS_TFD_TIMER_ABSTIME) != 0u) {
+                return -1;
+            }
+
+            kernel::SpinLockSafeGuard guard(g_timer_lock);
+
+            const uint32_t now = timer_ticks;
+
+            t->expirations = 0ull;
+
+            if (spec.value_ms == 0u) {
+                timer_disarm_locked(t);
+                return 0;
+            }
+
+            uint32_t deadline;
+
+            if (spec.flags & YOS_TFD_TIMER_ABSTIME) {
+                deadline = ms_to_ticks(spec.value_ms);
+
+                /* A deadline already behind us fires on the next tick. */
+                if (tick_before(deadline, now)) {
+                    deadline = now;
+                }
+            } else {
+                deadline = now + ms_to_ticks(spec.value_ms);
+            }
+
+            t->interval = spec.interval_ms ? ms_to_ticks(spec.interval_ms) : 0u;
+
+            timer_arm_locked(t, deadline);
+
+            return 0;
+        }
+
+        case YOS_TFD_GETTIME: {
+            yos_timerspec_t spec;
+
+            {
+                kernel::SpinLockSafeGuard guard(g_timer_lock);
+
+                const uint32_t now = timer_ticks;
+                const bool armed = dlist_node_linked(&t->armed_node);
+
+                spec.value_ms = (armed && tick_before(now, t->deadline)) ? ticks_to_ms(t->deadline - now) : 0u;
+                spec.interval_ms = armed ? ticks_to_ms(t->interval) : 0u;
+                spec.flags = 0u;
+            }
+
+            *(yos_timerspec_t*)arg = spec;
+
+            return 0;
+        }
+
+        default:
+            return -1;
+    }
+}
+
+static vfs_ops_t timer_ops = {
+    .read = timer_read,
+    .write = nullptr,
+    .open = nullptr,
+    .close = nullptr,
+    .ioctl = timer_ioctl,
+    .get_phys_page = nullptr,
+    .poll_status = timer_poll_status,
+    .poll_register = timer_poll_register,
+    .read_user = timer_read_user,
+    .write_user = nullptr,
+};
+
+static vfs_node_t* event_node_alloc(const char* name, uint32_t flags, vfs_ops_t* ops, void* private_data,
+                                    void (*retain)(void*), void (*release)(void*)) {
+    vfs_node_t* node = (vfs_node_t*)kmalloc(sizeof(vfs_node_t));
+
+    if (!node) {
+        return nullptr;
+    }
+
+    memset(node, 0, sizeof(*node));
+    strlcpy(node->name, name, sizeof(node->name));
+
+    node->flags = flags;
+    node->refs = 1u;
+    node->ops = ops;
+    node->private_data = private_data;
+    node->private_retain = retain;
+    node->private_release = release;
+
+    return node;
+}
+
+vfs_node_t* eventfd_create_node(uint32_t initval, uint32_t flags) {
+    if ((flags & ~(YOS_EFD_SEMAPHORE | YOS_EFD_NONBLOCK)) != 0u) {
+        return nullptr;
+    }
+
+    EventCounter* ec = new (kernel::nothrow) EventCounter();
+
+    if (!ec) {
+        return nullptr;
+    }
+
+    ec->value = initval;
+    ec->flags = flags;
+    ec->refs = 1u;
+
+    ec->readers.init();
+    ec->writers.init();
+
+    vfs_node_t* node = event_node_alloc(
+        "eventfd", VFS_FLAG_EVENTFD, &counter_ops, ec,
+        counter_private_retain, counter_private_release
+    );
+
+    if (!node) {
+        delete ec;
+        return nullptr;
+    }
+
+    poll_waitq_init_finalizable(&ec->poll_waitq, counter_poll_waitq_finalize, ec);
+
+    return node;
+}
+
+vfs_node_t* timerfd_create_node(uint32_t flags) {
+    if ((flags & ~YOS_TFD_NONBLOCK) != 0u) {
+        return nullptr;
+    }
+
+    EventTimer* t = new (kernel::nothrow) EventTimer();
+
+    if (!t) {
+        return nullptr;
+    }
+
+    t->armed_node.next = nullptr;
+    t->armed_node.prev = nullptr;
+    t->flags = flags;
+    t->refs = 1u;
+
+    t->readers.init();
+
+    vfs_node_t* node = event_node_alloc(
+        "timerfd", VFS_FLAG_TIMERFD, &timer_ops, t,
+        timer_private_retain, timer_private_release
+    );
+
+    if (!node) {
+        delete t;
+        return nullptr;
+    }
+
+    poll_waitq_init_finalizable(&t->poll_waitq, timer_poll_waitq_finalize, t);
+
+    return node;
+}
+
+void timerfd_tick(uint32_t now) {
+    if (__atomic_load_n(&g_armed_count, __ATOMIC_RELAXED) == 0u
+        || tick_before(now, __atomic_load_n(&g_next_deadline, __ATOMIC_RELAXED))) {
+        return;
+    }
+
+    /* A holder on another CPU only delays the expirations by one tick. */
+    if (!g_timer_lock.try_acquire()) {
+        return;
+    }
+
+    EventTimer* t;
+    EventTimer* n;
+
+    bool have_next = false;
+    uint32_t next = now;
+
+    dlist_for_each_entry_safe(t, n, &g_armed_timers, armed_node) {
+        if (!tick_before(now, t->deadline)) {
+            uint64_t fired = 1ull;
+
+            if (t->interval != 0u) {
+                const uint32_t late = (now - t->deadline) / t->interval;
+
+                fired += late;
+                t->deadline += (late + 1u) * t->interval;
+            } else {
+                timer_disarm_locked(t);
+            }
+
+            const bool was_empty = t->expirations == 0ull;
+
+            t->expirations += fired;
+
+            t->readers.wake(t->readers.take());
+
+            if (was_empty) {
+                poll_waitq_wake_all(&t->poll_waitq, VFS_POLLIN);
+            }
+
+            if (t->interval == 0u) {
+                continue;
+            }
+        }
+
+        if (!have_next || tick_before(t->deadline, next)) {
+            next = t->deadline;
+            have_next = true;
+        }
+    }
+
+    if (have_next) {
+        __atomic_store_n(&g_next_deadline, next, __ATOMIC_RELAXED);
+    }
+
+    g_timer_lock.release();
+}
+
+}
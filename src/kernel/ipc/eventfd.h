@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef KERNEL_IPC_EVENTFD_H
+#define KERNEL_IPC_EVENTFD_H
+
+#include <fs/vfs.h>
+
+#include <stdint.h>
+
+/*
+ * Event counters and timers (see yos/eventfd.h).
+ *
+ * Both are VFS nodes (VFS_FLAG_EVENTFD, VFS_FLAG_TIMERFD) around a 64-bit
+ * count that read() hands out in 8 bytes, and both implement poll_status and
+ * poll_register, so they sit in a poll() set next to pipes and channels.
+ * Armed timers are kept on one list that timerfd_tick() walks from the
+ * timer interrupt.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+vfs_node_t* eventfd_create_node(uint32_t initval, uint32_t flags);
+vfs_node_t* timerfd_create_node(uint32_t flags);
+
+/* Timer interrupt of the CPU that advances timer_ticks, interrupts off. */
+void timerfd_tick(uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,6 +10,7 @@
 #include <lib/cpp/vfs.h>
 
 #include <kernel/ipc/ipc_endpoint.h>
+#include <kernel/ipc/channel.h>
 #include <kernel/waitq/poll_waitq.h>
 #include <kernel/proc.h>
 
@@ -20,6 +21,8 @@
 
 #include <fs/vfs.h>
 
+#include <yos/channel.h>
+
 #include "pipe.h"
 
 static bool ipc_name_valid(const char* name) {
@@ -40,6 +43,9 @@ struct IpcPendingConn {
 
     kernel::VirtualFSNode c2s_r;
     kernel::VirtualFSNode s2c_w;
+
+    /* Server side of a channel connection; the pipe ends stay empty then. */
+    kernel::VirtualFSNode chan;
     
     kernel::SpinLock lock;
     
@@ -61,6 +67,18 @@ struct IpcPendingConn {
         refcount = 1u;
     }
 
+    IpcPendingConn(kernel::IntrusiveRef<IpcEndpoint>&& ep,
+                   uint32_t pid,
+                   kernel::VirtualFSNode&& server_end) {
+
+        owner = kernel::move(ep);
+        client_pid = pid;
+        chan = kernel::move(server_end);
+
+        queued = 0u;
+        refcount = 1u;
+    }
+
     IpcPendingConn(const IpcPendingConn&) = delete;
     IpcPendingConn& operator=(const IpcPendingConn&) = delete;
 
@@ -78,6 +96,7 @@ struct IpcPendingConn {
     void discard_nodes() {
         c2s_r.reset();
         s2c_w.reset();
+        chan.reset();
     }
 
     void mark_queued(bool value) {
@@ -91,11 +110,12 @@ struct IpcPendingConn {
 
 class IpcEndpoint {
 public:
-    IpcEndpoint(const char* n, vfs_node_t* node)
+    IpcEndpoint(const char* n, vfs_node_t* node, uint32_t listen_flags)
         : name(n ? n : "") {
         poll_waitq_init_finalizable(&poll_waitq, ipc_endpoint_poll_waitq_finalize, this);
 
         listen_node = node;
+        flags = listen_flags;
         refcount = 1u;
         closing = 0u;
     }
@@ -249,6 +269,7 @@ public:
     kernel::DBLinkedList<kernel::IntrusiveRef<IpcPendingConn>> pending_conns;
     poll_waitq_t poll_waitq;
     vfs_node_t* listen_node;
+    uint32_t flags;
     uint32_t refcount;
     uint32_t closing;
 };
@@ -279,6 +300,7 @@ void IpcPendingConn::release() {
 
     c2s_r.reset();
     s2c_w.reset();
+    chan.reset();
     delete this;
 }
 
@@ -365,11 +387,13 @@ static vfs_ops_t ipc_listen_ops = {
     .get_phys_page = nullptr,
     .poll_status = ipc_listen_vfs_poll_status,
     .poll_register = ipc_listen_vfs_poll_register,
+    .read_user = nullptr,
+    .write_user = nullptr,
 };
 
-struct vfs_node* ipc_listen_create(const char* name) {
+struct vfs_node* ipc_listen_create(const char* name, uint32_t flags) {
     vfs_node_t* node = nullptr;
-    if (ipc_name_valid(name)) {
+    if (ipc_name_valid(name) && (flags & ~YOS_IPC_LISTEN_CHAN) == 0u) {
         node = (vfs_node_t*)kmalloc(sizeof(vfs_node_t));
     }
     
@@ -377,7 +401,7 @@ struct vfs_node* ipc_listen_create(const char* name) {
         return nullptr;
     }
 
-    IpcEndpoint* ep = new (kernel::nothrow) IpcEndpoint(name, node);
+    IpcEndpoint* ep = new (kernel::nothrow) IpcEndpoint(name, node, flags);
     if (!ep) {
         kfree(node);
         return nullptr;
@@ -486,6 +510,66 @@ int ipc_connect(const char* name,
     return 0;
 }
 
+int ipc_connect_chan(const char* name,
+                     struct vfs_node** out_chan,
+                     void** out_pending_handle) {
+    if (out_chan) {
+        *out_chan = 0;
+    }
+    if (out_pending_handle) {
+        *out_pending_handle = 0;
+    }
+
+    if (!out_chan || !out_pending_handle) {
+        return -1;
+    }
+    if (!ipc_name_valid(name)) {
+        return -1;
+    }
+
+    kernel::IntrusiveRef<IpcEndpoint> ep;
+    if (!g_endpoints.find_and_retain(kernel::string(name), ep)) {
+        return -1;
+    }
+
+    IpcEndpoint* ep_raw = ep.get();
+
+    /* Servers that did not ask for channels keep seeing only pipe pairs. */
+    if ((ep_raw->flags & YOS_IPC_LISTEN_CHAN) == 0u) {
+        return -1;
+    }
+
+    vfs_node_t* client_raw = nullptr;
+    vfs_node_t* server_raw = nullptr;
+    if (ipc_channel_create(&client_raw, &server_raw) != 0) {
+        return -1;
+    }
+
+    kernel::VirtualFSNode client_end = kernel::VirtualFSNode::adopt(client_raw);
+    kernel::VirtualFSNode server_end = kernel::VirtualFSNode::adopt(server_raw);
+
+    task_t* curr = proc_current();
+    IpcPendingConn* p = new (kernel::nothrow) IpcPendingConn(
+        kernel::move(ep),
+        curr ? curr->pid : 0u,
+        kernel::move(server_end)
+    );
+    if (!p) {
+        return -1;
+    }
+
+    kernel::IntrusiveRef<IpcPendingConn> handle =
+        kernel::IntrusiveRef<IpcPendingConn>::adopt(p);
+    if (!ep_raw->enqueue_pending(p)) {
+        return -1;
+    }
+
+    *out_chan = client_end.release();
+    *out_pending_handle = (void*)handle.detach();
+
+    return 0;
+}
+
 void ipc_connect_commit(void* pending_handle) {
     IpcPendingConn* p = (IpcPendingConn*)pending_handle;
     if (!p) {
@@ -573,15 +657,19 @@ static int ipc_listen_vfs_poll_register(vfs_node_t* node, poll_waiter_t* w, task
 
 int ipc_accept(struct vfs_node* listen_node,
                struct vfs_node** out_c2s_r,
-               struct vfs_node** out_s2c_w) {
+               struct vfs_node** out_s2c_w,
+               struct vfs_node** out_chan) {
     if (out_c2s_r) {
         *out_c2s_r = 0;
     }
     if (out_s2c_w) {
         *out_s2c_w = 0;
     }
+    if (out_chan) {
+        *out_chan = 0;
+    }
 
-    if (!listen_node || !out_c2s_r || !out_s2c_w) {
+    if (!listen_node || !out_c2s_r || !out_s2c_w || !out_chan) {
         return -1;
     }
 
@@ -617,6 +705,11 @@ int ipc_accept(struct vfs_node* listen_node,
             continue;
         }
 
+        if (p->chan) {
+            *out_chan = p->chan.release();
+            return YOS_IPC_ACCEPTED_CHAN;
+        }
+
         *out_c2s_r = p->c2s_r.release();
         *out_s2c_w = p->s2c_w.release();
 
@@ -15,9 +15,17 @@ struct vfs_node;
 extern "C" {
 #endif
 
-struct vfs_node* ipc_listen_create(const char* name);
-
-int ipc_accept(struct vfs_node* listen_node, struct vfs_node** out_c2s_r, struct vfs_node** out_s2c_w);
+/* `flags`: YOS_IPC_LISTEN_CHAN to take channel connections too. */
+struct vfs_node* ipc_listen_create(const char* name, uint32_t flags);
+
+/*
+ * Pick up the next live connection: 1 with a pipe pair, YOS_IPC_ACCEPTED_CHAN
+ * with the server end of a channel in *out_chan, 0 if none is pending.
+ */
+int ipc_accept(struct vfs_node* listen_node,
+               struct vfs_node** out_c2s_r,
+               struct vfs_node** out_s2c_w,
+               struct vfs_node** out_chan);
 
 int ipc_listen_poll_ready(struct vfs_node* listen_node);
 
@@ -28,6 +36,11 @@ int ipc_connect(const char* name,
                 struct vfs_node** out_s2c_r,
                 void** out_pending_handle);
 
+/* Connect through a channel; fails unless the endpoint listens with YOS_IPC_LISTEN_CHAN. */
+int ipc_connect_chan(const char* name,
+                     struct vfs_node** out_chan,
+                     void** out_pending_handle);
+
 void ipc_connect_commit(void* pending_handle);
 
 void ipc_connect_cancel(void* pending_handle);
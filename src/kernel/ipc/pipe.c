@@ -16,11 +16,17 @@
 #include <hal/align.h>
 
 #include <mm/heap.h>
+#include <mm/pmm.h>
+#include <mm/vma.h>
+
+#include <yos/ioctl.h>
 
 #include "pipe.h"
 
 #define PIPE_SIZE 32768u
 
+#define PIPE_PAGE_MASK ((uint32_t)PAGE_SIZE - 1u)
+
 /*
  * Pipe Core.
  *
@@ -36,7 +42,17 @@
  *    allowing completely lock-free concurrent data copying.
  *  - Standard VFS paths (`pipe_read`/`pipe_write`) use fast `memcpy` because 
  *    the VFS layer already safely buffered the data into kernel space.
- *  - Non-blocking syscall paths use `uaccess` directly.
+ *  - read(2)/write(2) and the non-blocking syscall paths use `uaccess`
+ *    directly, so data is copied once on each side.
+ *
+ * Storage Model:
+ *  - The ring is `size` bytes, a power of two so the free-running pointers
+ *    wrap cleanly, held as one low-memory page per PAGE_SIZE bytes.
+ *  - Resizing (YOS_PIPE_SET_SIZE) takes both locks and moves what is
+ *    buffered into a new page vector at the same ring positions.
+ *  - In gift mode a whole free slot can be swapped for the writer's own
+ *    page instead of copied into. Only the writer touches free slots, and
+ *    the acquire/release pair on `write_ptr` publishes the new page.
  */
 
 typedef struct {
@@ -56,13 +72,132 @@ typedef struct {
 
     poll_waitq_t poll_waitq __cacheline_aligned;
 
-    char* buffer __cacheline_aligned;
+    char** pages __cacheline_aligned;
 
     uint32_t size;
+    volatile uint32_t flags;
     
     volatile uint32_t refs;
 } pipe_t;
 
+static void pipe_pages_free(char** pages, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        pmm_free_block(pages[i]);
+    }
+
+    kfree(pages);
+}
+
+static char** pipe_pages_alloc(uint32_t count) {
+    char** pages = (char**)kmalloc(count * sizeof(char*));
+
+    if (!pages) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        pages[i] = (char*)pmm_alloc_block();
+
+        if (!pages[i]) {
+            pipe_pages_free(pages, i);
+
+            return 0;
+        }
+    }
+
+    return pages;
+}
+
+/* Copy `len` bytes out of the ring at `pos`. Returns how many made it before a fault. */
+static uint32_t pipe_ring_copy_out(pipe_t* p, uint32_t pos, char* dst, uint32_t len, int is_user) {
+    uint32_t done = 0u;
+
+    while (done < len) {
+        const uint32_t off = (pos + done) & (p->size - 1u);
+        const uint32_t in_page = off & PIPE_PAGE_MASK;
+
+        uint32_t n = PAGE_SIZE - in_page;
+
+        if (n > len - done) {
+            n = len - done;
+        }
+
+        const char* src = p->pages[off >> PAGE_SHIFT] + in_page;
+
+        if (is_user) {
+            if (uaccess_copy_to_user(&dst[done], src, n) != 0) {
+                break;
+            }
+        } else {
+            memcpy(&dst[done], src, n);
+        }
+
+        done += n;
+    }
+
+    return done;
+}
+
+/*
+ * Swap the free ring slot for the writer's page at `src`. The slot's own
+ * page is nobody else's business: readers never look past write_ptr.
+ */
+static int pipe_ring_gift(pipe_t* p, uint32_t slot, const char* src) {
+    task_t* curr = proc_current();
+
+    phys_addr_t phys = 0u;
+
+    if (!curr || !curr->mem || vma_detach_page(curr->mem, (uint32_t)(uintptr_t)src, &phys) != 0) {
+        return 0;
+    }
+
+    char* old = p->pages[slot];
+
+    p->pages[slot] = (char*)(uintptr_t)phys;
+
+    pmm_free_block(old);
+
+    return 1;
+}
+
+/* Copy `len` bytes into the ring at `pos`. Returns how many made it before a fault. */
+static uint32_t pipe_ring_copy_in(pipe_t* p, uint32_t pos, const char* src, uint32_t len, int is_user, int gift) {
+    uint32_t done = 0u;
+
+    while (done < len) {
+        const uint32_t off = (pos + done) & (p->size - 1u);
+        const uint32_t in_page = off & PIPE_PAGE_MASK;
+
+        uint32_t n = PAGE_SIZE - in_page;
+
+        if (n > len - done) {
+            n = len - done;
+        }
+
+        if (gift && n == PAGE_SIZE
+            && ((uintptr_t)&src[done] & PIPE_PAGE_MASK) == 0u
+            && pipe_ring_gift(p, off >> PAGE_SHIFT, &src[done])) {
+            done += n;
+
+            continue;
+        }
+
+        char* dst = p->pages[off >> PAGE_SHIFT] + in_page;
+
+        if (is_user) {
+            if (uaccess_copy_from_user(dst, &src[done], n) != 0) {
+                break;
+            }
+        } else {
+            memcpy(dst, &src[done], n);
+        }
+
+        done += n;
+    }
+
+    return done;
+}
+
 static void pipe_poll_waitq_finalize(void* ctx) {
     pipe_t* p = (pipe_t*)ctx;
 
@@ -70,9 +205,9 @@ static void pipe_poll_waitq_finalize(void* ctx) {
         return;
     }
 
-    if (p->buffer) {
-        kfree(p->buffer);
-        p->buffer = 0;
+    if (p->pages) {
+        pipe_pages_free(p->pages, p->size / PAGE_SIZE);
+        p->pages = 0;
     }
 
     kfree(p);
@@ -141,59 +276,25 @@ ___inline int pipe_read_impl(vfs_node_t* node, uint32_t size, void* buffer, int
                     const uint32_t want = size - read_count;
                     const uint32_t take = (want < available) ? want : available;
 
-                    const uint32_t rp_mod = rp % p->size;
-                    const uint32_t contig = p->size - rp_mod;
-
-                    const uint32_t n1 = (take < contig) ? take : contig;
-
-                    if (is_user) {
-                        if (uaccess_copy_to_user(&buf[read_count], &p->buffer[rp_mod], n1) != 0) {
-                            if (read_count == 0) {
-                                read_count = (uint32_t)-1;
-                            }
-                            
-                            if (__atomic_load_n(&p->write_ptr, __ATOMIC_ACQUIRE) > rp) {
-                                sem_signal_all(&p->sem_read);
-                            }
-
-                            return (int)read_count;
-                        }
-                    } else {
-                        memcpy(&buf[read_count], &p->buffer[rp_mod], n1);
-                    }
-
-                    const uint32_t n2 = take - n1;
-                    if (n2 > 0u) {
-                        if (is_user) {
-                            if (uaccess_copy_to_user(&buf[read_count + n1], &p->buffer[0], n2) != 0) {
-                                __atomic_store_n(&p->read_ptr, rp + n1, __ATOMIC_RELEASE);
-                                
-                                sem_signal_all(&p->sem_write);
-
-                                poll_waitq_wake_all(&p->poll_waitq, VFS_POLLOUT);
-                                
-                                if (__atomic_load_n(&p->write_ptr, __ATOMIC_ACQUIRE) > (rp + n1)) {
-                                    sem_signal_all(&p->sem_read);
-                                }
-
-                                return -1;
-                            }
-                        } else {
-                            memcpy(&buf[read_count + n1], &p->buffer[0], n2);
-                        }
-                    }
+                    const uint32_t done = pipe_ring_copy_out(p, rp, &buf[read_count], take, is_user);
 
-                    __atomic_store_n(&p->read_ptr, rp + take, __ATOMIC_RELEASE);
-                    read_count += take;
+                    if (done > 0u) {
+                        __atomic_store_n(&p->read_ptr, rp + done, __ATOMIC_RELEASE);
+                        read_count += done;
 
-                    sem_signal_all(&p->sem_write);
+                        sem_signal_all(&p->sem_write);
 
-                    poll_waitq_wake_all(&p->poll_waitq, VFS_POLLOUT);
+                        poll_waitq_wake_all(&p->poll_waitq, VFS_POLLOUT);
+                    }
 
-                    if (__atomic_load_n(&p->write_ptr, __ATOMIC_ACQUIRE) > (rp + take)) {
+                    if (__atomic_load_n(&p->write_ptr, __ATOMIC_ACQUIRE) != rp + done) {
                         sem_signal_all(&p->sem_read);
                     }
 
+                    if (done != take) {
+                        return (read_count == 0u) ? -1 : (int)read_count;
+                    }
+
                     break;
                 }
 
@@ -231,21 +332,13 @@ ___inline int pipe_write_impl(vfs_node_t* node, uint32_t size, const void* buffe
         return -1;
     }
 
-    if (!block) {
-        if ((node->flags & VFS_FLAG_PIPE_WRITE) == 0u) {
-            return -1;
-        }
-
-        if (size > p->size) {
-            return 0;
-        }
+    if (!block && (node->flags & VFS_FLAG_PIPE_WRITE) == 0u) {
+        return -1;
     }
 
     const char* buf = (const char*)buffer;
     uint32_t written_count = 0u;
 
-    const uint32_t require_space = (!block || size <= p->size) ? size : 1u;
-
     while (written_count < size) {
         bool waited = false;
 
@@ -257,10 +350,20 @@ ___inline int pipe_write_impl(vfs_node_t* node, uint32_t size, const void* buffe
                     while (sem_try_acquire(&p->sem_write)) {}
                 }
 
+                /* A resize needs this lock too, so the size holds until it is dropped. */
+                const uint32_t cap = p->size;
+
+                if (!block && size > cap) {
+                    return 0;
+                }
+
+                /* Writes that fit the pipe go in whole, bigger ones as space frees up. */
+                const uint32_t require_space = (!block || size <= cap) ? size : 1u;
+
                 const uint32_t rp = __atomic_load_n(&p->read_ptr, __ATOMIC_ACQUIRE);
                 
                 const uint32_t wp = p->write_ptr;
-                const uint32_t space = p->size - (wp - rp);
+                const uint32_t space = cap - (wp - rp);
 
                 if (__atomic_load_n(&p->readers, __ATOMIC_ACQUIRE) == 0) {
                     return (written_count == 0u) ? -1 : (int)written_count;
@@ -268,57 +371,29 @@ ___inline int pipe_write_impl(vfs_node_t* node, uint32_t size, const void* buffe
 
                 if (space >= require_space) {
                     const uint32_t want = size - written_count;
-                    const uint32_t take = (!block) ? want : ((want < space) ? want : space);
+                    const uint32_t take = (want < space) ? want : space;
 
-                    const uint32_t wp_mod = wp % p->size;
-                    const uint32_t contig = p->size - wp_mod;
+                    const int gift = is_user && (p->flags & YOS_PIPE_F_GIFT) != 0u;
 
-                    const uint32_t n1 = (take < contig) ? take : contig;
+                    const uint32_t done = pipe_ring_copy_in(p, wp, &buf[written_count], take, is_user, gift);
 
-                    if (is_user) {
-                        if (uaccess_copy_from_user(&p->buffer[wp_mod], &buf[written_count], n1) != 0) {
-                            if (p->size - (wp - __atomic_load_n(&p->read_ptr, __ATOMIC_ACQUIRE)) > 0u) {
-                                sem_signal_all(&p->sem_write);
-                            }
+                    if (done > 0u) {
+                        __atomic_store_n(&p->write_ptr, wp + done, __ATOMIC_RELEASE);
+                        written_count += done;
 
-                            return (written_count == 0) ? -1 : (int)written_count;
-                        }
-                    } else {
-                        memcpy(&p->buffer[wp_mod], &buf[written_count], n1);
-                    }
+                        sem_signal_all(&p->sem_read);
 
-                    const uint32_t n2 = take - n1;
-                    if (n2 > 0u) {
-                        if (is_user) {
-                            if (uaccess_copy_from_user(&p->buffer[0], &buf[written_count + n1], n2) != 0) {
-                                __atomic_store_n(&p->write_ptr, wp + n1, __ATOMIC_RELEASE);
-                                
-                                sem_signal_all(&p->sem_read);
-
-                                poll_waitq_wake_all(&p->poll_waitq, VFS_POLLIN);
-
-                                if (p->size - ((wp + n1) - __atomic_load_n(&p->read_ptr, __ATOMIC_ACQUIRE)) > 0u) {
-                                    sem_signal_all(&p->sem_write);
-                                }
-                                return -1;
-                            }
-                        } else {
-                            memcpy(&p->buffer[0], &buf[written_count + n1], n2);
-                        }
+                        poll_waitq_wake_all(&p->poll_waitq, VFS_POLLIN);
                     }
 
-                    __atomic_store_n(&p->write_ptr, wp + take, __ATOMIC_RELEASE);
-
-                    written_count += take;
-
-                    sem_signal_all(&p->sem_read);
-
-                    poll_waitq_wake_all(&p->poll_waitq, VFS_POLLIN);
-
-                    if (p->size - ((wp + take) - __atomic_load_n(&p->read_ptr, __ATOMIC_ACQUIRE)) > 0u) {
+                    if (cap - ((wp + done) - __atomic_load_n(&p->read_ptr, __ATOMIC_ACQUIRE)) > 0u) {
                         sem_signal_all(&p->sem_write);
                     }
 
+                    if (done != take) {
+                        return (written_count == 0u) ? -1 : (int)written_count;
+                    }
+
                     break;
                 }
 
@@ -355,6 +430,16 @@ static int pipe_write(vfs_node_t* node, uint32_t offset, uint32_t size, const vo
     return pipe_write_impl(node, size, buffer, 1, 0);
 }
 
+static int pipe_read_user(vfs_node_t* node, uint32_t offset, uint32_t size, void* buffer) {
+    (void)offset;
+    return pipe_read_impl(node, size, buffer, 1, 1);
+}
+
+static int pipe_write_user(vfs_node_t* node, uint32_t offset, uint32_t size, const void* buffer) {
+    (void)offset;
+    return pipe_write_impl(node, size, buffer, 1, 1);
+}
+
 int pipe_write_nonblock(vfs_node_t* node, uint32_t size, const void* buffer) {
     return pipe_write_impl(node, size, buffer, 0, 1);
 }
@@ -517,15 +602,125 @@ static int pipe_close(vfs_node_t* node) {
     return 0;
 }
 
+/*
+ * Move the buffered bytes into a ring of `want` bytes, rounded up to a
+ * power of two. They keep their ring positions, so the pointers stay valid.
+ */
+static int pipe_set_size(pipe_t* p, uint32_t want) {
+    if (want > YOS_PIPE_MAX_SIZE) {
+        return -1;
+    }
+
+    uint32_t size = YOS_PIPE_MIN_SIZE;
+
+    while (size < want) {
+        size <<= 1;
+    }
+
+    char** pages = pipe_pages_alloc(size / PAGE_SIZE);
+
+    if (!pages) {
+        return -1;
+    }
+
+    char** old_pages;
+    uint32_t old_size;
+
+    {
+        guard(mutex)(&p->read_lock);
+        guard(mutex)(&p->write_lock);
+
+        const uint32_t rp = p->read_ptr;
+        const uint32_t used = p->write_ptr - rp;
+
+        if (used > size) {
+            pipe_pages_free(pages, size / PAGE_SIZE);
+
+            return -1;
+        }
+
+        for (uint32_t done = 0u; done < used; ) {
+            const uint32_t src = (rp + done) & (p->size - 1u);
+            const uint32_t dst = (rp + done) & (size - 1u);
+
+            /* Both rings break at page boundaries, and at the same offsets within a page. */
+            uint32_t n = PAGE_SIZE - (src & PIPE_PAGE_MASK);
+
+            if (n > used - done) {
+                n = used - done;
+            }
+
+            memcpy(pages[dst >> PAGE_SHIFT] + (dst & PIPE_PAGE_MASK), p->pages[src >> PAGE_SHIFT] + (src & PIPE_PAGE_MASK), n);
+
+            done += n;
+        }
+
+        old_pages = p->pages;
+        old_size = p->size;
+
+        p->pages = pages;
+        __atomic_store_n(&p->size, size, __ATOMIC_RELEASE);
+    }
+
+    pipe_pages_free(old_pages, old_size / PAGE_SIZE);
+
+    sem_signal_all(&p->sem_write);
+
+    poll_waitq_wake_all(&p->poll_waitq, VFS_POLLOUT);
+
+    return (int)size;
+}
+
+static int pipe_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    if (!node || !arg) {
+        return -1;
+    }
+
+    pipe_t* p = (pipe_t*)node->private_data;
+
+    if (!p) {
+        return -1;
+    }
+
+    switch (req) {
+        case YOS_PIPE_GET_SIZE:
+            *(uint32_t*)arg = __atomic_load_n(&p->size, __ATOMIC_ACQUIRE);
+            return 0;
+
+        case YOS_PIPE_SET_SIZE:
+            return pipe_set_size(p, *(const uint32_t*)arg);
+
+        case YOS_PIPE_GET_FLAGS:
+            *(uint32_t*)arg = p->flags;
+            return 0;
+
+        case YOS_PIPE_SET_FLAGS: {
+            const uint32_t flags = *(const uint32_t*)arg;
+
+            if ((flags & ~YOS_PIPE_F_GIFT) != 0u) {
+                return -1;
+            }
+
+            p->flags = flags;
+            return 0;
+        }
+
+        default:
+            return -1;
+    }
+}
+
 static vfs_ops_t pipe_ops = {
     .read = pipe_read,
     .write = pipe_write,
     .open = 0,
     .close = pipe_close,
-    .ioctl = 0,
+    .ioctl = pipe_ioctl,
     .get_phys_page = 0,
     .poll_status = pipe_vfs_poll_status,
     .poll_register = pipe_vfs_poll_register,
+    .read_user = pipe_read_user,
+    .write_user = pipe_write_user,
 };
 
 int vfs_create_pipe(vfs_node_t** read_node, vfs_node_t** write_node) {
@@ -552,9 +747,9 @@ int vfs_create_pipe(vfs_node_t** read_node, vfs_node_t** write_node) {
     p->refs = 2u;
     p->size = PIPE_SIZE;
 
-    p->buffer = (char*)kmalloc(p->size);
+    p->pages = pipe_pages_alloc(p->size / PAGE_SIZE);
 
-    if (!p->buffer) {
+    if (!p->pages) {
         kfree(p);
         
         return -1;
@@ -579,7 +774,7 @@ int vfs_create_pipe(vfs_node_t** read_node, vfs_node_t** write_node) {
         *read_node = 0;
         *write_node = 0;
 
-        kfree(p->buffer);
+        pipe_pages_free(p->pages, p->size / PAGE_SIZE);
         kfree(p);
 
         return -1;
@@ -11,8 +11,9 @@
 /*
  * VFS pipes.
  *
- * This module implements a classic byte-stream pipe on top of a fixed-size
- * in-kernel ring buffer.
+ * This module implements a classic byte-stream pipe on top of an in-kernel
+ * ring buffer of whole pages, 32 KiB by default and resizable through
+ * YOS_PIPE_SET_SIZE (see yos/ioctl.h).
  *
  * The pipe is exposed as two VFS nodes:
  *  - a read end (VFS_FLAG_PIPE_READ)
@@ -0,0 +1,356 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#include <kernel/output/kprintf.h>
+#include <kernel/smp/cpu.h>
+#include <kernel/kbench.h>
+#include <kernel/sched.h>
+#include <kernel/proc.h>
+
+#include <drivers/block/bdev.h>
+
+#include <lib/compiler.h>
+#include <lib/string.h>
+
+#include <hal/delay.h>
+
+#include <fs/bcache.h>
+
+#include <mm/heap.h>
+#include <mm/pmm.h>
+
+/* Upper bound on samples kept per benchmark. */
+#define KBENCH_MAX_SAMPLES 1024u
+
+/* Objects held at once by the allocator benchmarks. */
+#define KBENCH_BATCH 64u
+
+#define KBENCH_ALLOC_ROUNDS  8u
+#define KBENCH_PINGPONG      512u
+#define KBENCH_PINGPONG_WARM 16u
+#define KBENCH_BCACHE_HITS   512u
+#define KBENCH_BCACHE_MISSES 128u
+
+/* Blocks cycled through by the miss benchmark; block 0 serves the hits. */
+#define KBENCH_BCACHE_SPAN 64u
+
+static uint32_t g_samples[KBENCH_MAX_SAMPLES];
+static uint32_t g_sample_count;
+
+static volatile uint32_t g_running;
+static volatile uint32_t g_runs;
+
+static volatile uint32_t g_pp_turn;
+static volatile uint32_t g_pp_stop;
+static volatile uint32_t g_pp_done;
+
+static uint64_t kbench_clock(void) {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | (uint64_t)lo;
+}
+
+static void kbench_sample(uint64_t cycles) {
+    if (g_sample_count < KBENCH_MAX_SAMPLES) {
+        g_samples[g_sample_count++] = cycles > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)cycles;
+    }
+}
+
+static uint32_t kbench_ns(uint32_t cycles) {
+    const uint32_t khz = (uint32_t)(g_cpu_tsc_hz / 1000ull);
+    if (khz == 0u) {
+        return 0;
+    }
+
+    const uint64_t ns = ((uint64_t)cycles * 1000000ull) / khz;
+
+    return ns > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)ns;
+}
+
+static void kbench_sort(uint32_t* v, uint32_t n) {
+    static const uint32_t gaps[] = { 701u, 301u, 132u, 57u, 23u, 10u, 4u, 1u };
+
+    for (uint32_t g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++) {
+        const uint32_t gap = gaps[g];
+
+        for (uint32_t i = gap; i < n; i++) {
+            const uint32_t x = v[i];
+            uint32_t j = i;
+
+            while (j >= gap && v[j - gap] > x) {
+                v[j] = v[j - gap];
+                j -= gap;
+            }
+
+            v[j] = x;
+        }
+    }
+}
+
+/* Log the samples gathered since the last report and start over. */
+static void kbench_report(const char* name, const char* variant) {
+    const uint32_t n = g_sample_count;
+    g_sample_count = 0;
+
+    if (n == 0u) {
+        kprintf("kbench: name=%s%s%s skipped=nosamples\n", name, variant ? "/" : "", variant ? variant : "");
+        return;
+    }
+
+    kbench_sort(g_samples, n);
+
+    uint32_t p99 = (n * 99u) / 100u;
+    if (p99 >= n) {
+        p99 = n - 1u;
+    }
+
+    kprintf(
+        "kbench: name=%s%s%s samples=%u min_ns=%u median_ns=%u p99_ns=%u\n",
+        name, variant ? "/" : "", variant ? variant : "", n,
+        kbench_ns(g_samples[0]), kbench_ns(g_samples[n / 2u]), kbench_ns(g_samples[p99])
+    );
+}
+
+static void kbench_pong(void* arg) {
+    (void)arg;
+
+    for (;;) {
+        while (__atomic_load_n(&g_pp_turn, __ATOMIC_ACQUIRE) != 1u) {
+            if (__atomic_load_n(&g_pp_stop, __ATOMIC_ACQUIRE)) {
+                __atomic_store_n(&g_pp_done, 1u, __ATOMIC_RELEASE);
+                return;
+            }
+
+            sched_yield();
+        }
+
+        __atomic_store_n(&g_pp_turn, 0u, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * sched_yield() ping-pong with a kernel thread. A round trip is two
+ * switches when both tasks share a CPU; otherwise each side mostly spins
+ * through yields with nothing else to run, so the placement is reported.
+ */
+static void kbench_context_switch(void) {
+    __atomic_store_n(&g_pp_turn, 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_pp_stop, 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_pp_done, 0u, __ATOMIC_RELEASE);
+
+    task_t* pong = proc_spawn_kthread("kbench-pong", PRIO_USER, kbench_pong, 0);
+    if (!pong) {
+        kprintf("kbench: name=sched_yield skipped=nothread\n");
+        return;
+    }
+
+    task_t* self = proc_current();
+    const int same_cpu = self && pong->assigned_cpu == self->assigned_cpu;
+
+    for (uint32_t i = 0; i < KBENCH_PINGPONG_WARM + KBENCH_PINGPONG; i++) {
+        const uint64_t t0 = kbench_clock();
+
+        __atomic_store_n(&g_pp_turn, 1u, __ATOMIC_RELEASE);
+
+        while (__atomic_load_n(&g_pp_turn, __ATOMIC_ACQUIRE) != 0u) {
+            sched_yield();
+        }
+
+        const uint64_t t1 = kbench_clock();
+
+        if (i >= KBENCH_PINGPONG_WARM) {
+            kbench_sample((t1 - t0) / 2u);
+        }
+    }
+
+    __atomic_store_n(&g_pp_stop, 1u, __ATOMIC_RELEASE);
+
+    while (!__atomic_load_n(&g_pp_done, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+
+    kbench_report("sched_yield", same_cpu ? "same_cpu" : "cross_cpu");
+}
+
+/* kmalloc size classes, smallest to the largest slab-backed one. */
+static const struct {
+    uint32_t size;
+    const char* name;
+} g_kmalloc_sizes[] = {
+    { 8u, "8" }, { 16u, "16" }, { 32u, "32" }, { 64u, "64" }, { 128u, "128" },
+    { 256u, "256" }, { 512u, "512" }, { 1024u, "1024" }, { 2048u, "2048" },
+};
+
+static void kbench_kmalloc(void) {
+    void* objs[KBENCH_BATCH];
+
+    for (uint32_t c = 0; c < sizeof(g_kmalloc_sizes) / sizeof(g_kmalloc_sizes[0]); c++) {
+        const uint32_t size = g_kmalloc_sizes[c].size;
+        const char* variant = g_kmalloc_sizes[c].name;
+
+        uint32_t free_samples[KBENCH_ALLOC_ROUNDS * KBENCH_BATCH];
+        uint32_t free_count = 0;
+
+        for (uint32_t r = 0; r < KBENCH_ALLOC_ROUNDS; r++) {
+            for (uint32_t i = 0; i < KBENCH_BATCH; i++) {
+                const uint64_t t0 = kbench_clock();
+                objs[i] = kmalloc(size);
+                const uint64_t t1 = kbench_clock();
+
+                kbench_sample(t1 - t0);
+            }
+
+            for (uint32_t i = 0; i < KBENCH_BATCH; i++) {
+                const uint64_t t0 = kbench_clock();
+                kfree(objs[i]);
+                const uint64_t t1 = kbench_clock();
+
+                free_samples[free_count++] = (uint32_t)(t1 - t0);
+            }
+        }
+
+        kbench_report("kmalloc", variant);
+
+        for (uint32_t i = 0; i < free_count; i++) {
+            kbench_sample(free_samples[i]);
+        }
+
+        kbench_report("kfree", variant);
+    }
+}
+
+static void kbench_pmm_one(const char* variant, void* (*alloc)(void), void (*release)(void*)) {
+    void* pages[KBENCH_BATCH];
+    uint32_t free_samples[KBENCH_ALLOC_ROUNDS * KBENCH_BATCH];
+    uint32_t free_count = 0;
+
+    for (uint32_t r = 0; r < KBENCH_ALLOC_ROUNDS; r++) {
+        for (uint32_t i = 0; i < KBENCH_BATCH; i++) {
+            const uint64_t t0 = kbench_clock();
+            pages[i] = alloc();
+            const uint64_t t1 = kbench_clock();
+
+            kbench_sample(t1 - t0);
+        }
+
+        for (uint32_t i = 0; i < KBENCH_BATCH; i++) {
+            if (!pages[i]) {
+                continue;
+            }
+
+            const uint64_t t0 = kbench_clock();
+            release(pages[i]);
+            const uint64_t t1 = kbench_clock();
+
+            free_samples[free_count++] = (uint32_t)(t1 - t0);
+        }
+    }
+
+    kbench_report("pmm_alloc_block", variant);
+
+    for (uint32_t i = 0; i < free_count; i++) {
+        kbench_sample(free_samples[i]);
+    }
+
+    kbench_report("pmm_free_block", variant);
+}
+
+static void kbench_pmm(void) {
+    kbench_pmm_one("pcp", pmm_alloc_block, pmm_free_block);
+    kbench_pmm_one("nocache", pmm_alloc_block_nocache, pmm_free_block_nocache);
+}
+
+static void kbench_bcache(void) {
+    if (!bdev_root()) {
+        kprintf("kbench: name=bcache_read skipped=nodev\n");
+        return;
+    }
+
+    uint8_t* buf = (uint8_t*)pmm_alloc_block();
+    if (!buf) {
+        kprintf("kbench: name=bcache_read skipped=nomem\n");
+        return;
+    }
+
+    if (bcache_read(0u, buf)) {
+        for (uint32_t i = 0; i < KBENCH_BCACHE_HITS; i++) {
+            const uint64_t t0 = kbench_clock();
+            (void)bcache_read(0u, buf);
+            const uint64_t t1 = kbench_clock();
+
+            kbench_sample(t1 - t0);
+        }
+    }
+
+    kbench_report("bcache_read", "hit");
+
+    for (uint32_t i = 0; i < KBENCH_BCACHE_MISSES; i++) {
+        const uint32_t block = 1u + (i % KBENCH_BCACHE_SPAN);
+
+        /* Dirty or busy blocks stay cached; timing them would count a hit. */
+        if (!bcache_invalidate_block(block)) {
+            continue;
+        }
+
+        const uint64_t t0 = kbench_clock();
+        const int ok = bcache_read(block, buf);
+        const uint64_t t1 = kbench_clock();
+
+        if (ok) {
+            kbench_sample(t1 - t0);
+        }
+    }
+
+    kbench_report("bcache_read", "miss");
+
+    pmm_free_block(buf);
+}
+
+int kbench_run(void) {
+    if (__atomic_exchange_n(&g_running, 1u, __ATOMIC_ACQUIRE) != 0u) {
+        return -1;
+    }
+
+    g_sample_count = 0;
+
+    kprintf(
+        "kbench: begin side=kernel tsc_khz=%u cpus=%d\n",
+        (uint32_t)(g_cpu_tsc_hz / 1000ull), cpu_count
+    );
+
+    kbench_context_switch();
+    kbench_kmalloc();
+    kbench_pmm();
+    kbench_bcache();
+
+    kprintf("kbench: end side=kernel\n");
+
+    __atomic_fetch_add(&g_runs, 1u, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_running, 0u, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+static void kbench_task(void* arg) {
+    (void)arg;
+
+    (void)kbench_run();
+}
+
+void kbench_spawn(void) {
+    if (!proc_spawn_kthread("kbench", PRIO_LOW, kbench_task, 0)) {
+        kprintf("kbench: boot run failed to start\n");
+    }
+}
+
+void kbench_get_info(yos_kbench_info_t* out) {
+    if (!out) {
+        return;
+    }
+
+    out->tsc_khz = (uint32_t)(g_cpu_tsc_hz / 1000ull);
+    out->runs = __atomic_load_n(&g_runs, __ATOMIC_RELAXED);
+}
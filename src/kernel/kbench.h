@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef KERNEL_KBENCH_H
+#define KERNEL_KBENCH_H
+
+#include <yos/kbench.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Kernel microbenchmark suite.
+ *
+ * Times context switches, kmalloc/kfree, PMM order-0 allocation with and
+ * without the per-CPU caches and bcache hits and misses, and logs median
+ * and p99 per benchmark through kprintf. Paths that start in user mode
+ * (syscalls, futexes, pipes, page faults) are measured by the userland
+ * kbench tool instead.
+ */
+
+/*
+ * Run the suite in the calling task. Returns 0 when done, -1 if another run
+ * is in progress.
+ */
+int kbench_run(void);
+
+/* Run the suite once from its own kernel thread; used for the boot run. */
+void kbench_spawn(void);
+
+void kbench_get_info(yos_kbench_info_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
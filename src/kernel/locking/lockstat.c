@@ -0,0 +1,356 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#include <kernel/locking/spinlock.h>
+#include <kernel/smp/cpu_limits.h>
+
+#include <lib/compiler.h>
+#include <lib/string.h>
+
+#include <hal/align.h>
+#include <hal/delay.h>
+#include <hal/cpu.h>
+#include <hal/irq.h>
+
+#include "lockstat.h"
+
+#ifdef KERNEL_LOCKSTAT
+
+#define LOCKSTAT_MAX_CLASSES 512u
+
+/* Twice the class limit, so probing always finds a free slot or the site. */
+#define LOCKSTAT_HASH_SIZE 1024u
+
+/* Hash slot of a site that arrived after the class table filled up. */
+#define LOCKSTAT_CLASS_FULL 0xFFFFFFFFu
+
+/* Contended spinlocks one CPU can hold with their hold time running. */
+#define LOCKSTAT_SPIN_DEPTH 8u
+
+typedef struct {
+    uintptr_t site;
+    uint32_t type;
+    volatile uintptr_t lock;
+
+    uint32_t contended;
+    volatile uint64_t wait_cycles;
+
+    uint32_t held;
+    volatile uint64_t hold_cycles;
+
+    uint32_t wait_hist[YOS_LOCKSTAT_BUCKETS];
+    uint32_t hold_hist[YOS_LOCKSTAT_BUCKETS];
+} lockstat_class_t;
+
+typedef struct {
+    volatile uintptr_t site;
+    volatile uint32_t cls;
+} lockstat_slot_t;
+
+typedef struct {
+    spinlock_t* lock;
+    uint32_t cls;
+    uint64_t start;
+} lockstat_spin_hold_t;
+
+typedef struct {
+    uint32_t depth;
+    lockstat_spin_hold_t holds[LOCKSTAT_SPIN_DEPTH];
+} __cacheline_aligned lockstat_spin_stack_t;
+
+/* Index 0 is LOCKSTAT_NO_CLASS and never used. */
+static lockstat_class_t g_classes[LOCKSTAT_MAX_CLASSES + 1u];
+static volatile uint32_t g_class_count;
+
+static lockstat_slot_t g_slots[LOCKSTAT_HASH_SIZE];
+
+static uint32_t g_overflow;
+
+static lockstat_spin_stack_t g_spin_stacks[MAX_CPUS];
+
+/*
+ * i386 has no 8-byte atomic add or load without SSE/x87: sums are read with
+ * a torn-read retry and updated with cmpxchg8b.
+ */
+static uint64_t lockstat_load64(const volatile uint64_t* p) {
+    const volatile uint32_t* w = (const volatile uint32_t*)p;
+
+    uint32_t lo;
+    uint32_t hi;
+
+    do {
+        lo = w[0];
+        __asm__ volatile("" ::: "memory");
+        hi = w[1];
+        __asm__ volatile("" ::: "memory");
+    } while (lo != w[0]);
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static void lockstat_add64(volatile uint64_t* p, uint64_t v) {
+    uint64_t old = lockstat_load64(p);
+
+    for (;;) {
+        const uint64_t seen = __sync_val_compare_and_swap(p, old, old + v);
+        if (seen == old) {
+            return;
+        }
+
+        old = seen;
+    }
+}
+
+static void lockstat_store64(volatile uint64_t* p, uint64_t v) {
+    uint64_t old = lockstat_load64(p);
+
+    for (;;) {
+        const uint64_t seen = __sync_val_compare_and_swap(p, old, v);
+        if (seen == old) {
+            return;
+        }
+
+        old = seen;
+    }
+}
+
+___inline uint32_t lockstat_bucket(uint64_t cycles) {
+    if (cycles == 0u) {
+        return 0u;
+    }
+
+    const uint32_t b = 63u - (uint32_t)__builtin_clzll(cycles);
+
+    return b < YOS_LOCKSTAT_BUCKETS ? b : YOS_LOCKSTAT_BUCKETS - 1u;
+}
+
+___inline uint32_t lockstat_hash(uintptr_t site) {
+    uint32_t h = (uint32_t)site * 0x9E3779B1u;
+    return h >> 22;
+}
+
+/*
+ * Find or register the class of `site`. Called with interrupts off, so the
+ * CPU that claims a slot publishes its class before anything on that CPU
+ * can look the site up again.
+ */
+static uint32_t lockstat_class_of(uintptr_t site, uint32_t type) {
+    uint32_t h = lockstat_hash(site);
+
+    for (uint32_t probe = 0; probe < LOCKSTAT_HASH_SIZE; probe++) {
+        lockstat_slot_t* slot = &g_slots[h];
+
+        uintptr_t cur = __atomic_load_n(&slot->site, __ATOMIC_ACQUIRE);
+
+        if (cur == 0u) {
+            if (__atomic_compare_exchange_n(&slot->site, &cur, site, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                uint32_t cls = __atomic_add_fetch(&g_class_count, 1u, __ATOMIC_RELAXED);
+
+                if (unlikely(cls > LOCKSTAT_MAX_CLASSES)) {
+                    cls = LOCKSTAT_CLASS_FULL;
+                } else {
+                    g_classes[cls].type = type;
+                    __atomic_store_n(&g_classes[cls].site, site, __ATOMIC_RELEASE);
+                }
+
+                __atomic_store_n(&slot->cls, cls, __ATOMIC_RELEASE);
+                return cls;
+            }
+        }
+
+        if (cur == site) {
+            uint32_t cls;
+
+            while ((cls = __atomic_load_n(&slot->cls, __ATOMIC_ACQUIRE)) == LOCKSTAT_NO_CLASS) {
+                cpu_relax();
+            }
+
+            return cls;
+        }
+
+        h = (h + 1u) & (LOCKSTAT_HASH_SIZE - 1u);
+    }
+
+    return LOCKSTAT_CLASS_FULL;
+}
+
+uint32_t lockstat_contended(uint32_t type, const void* lock, uintptr_t site, uint64_t wait_cycles) {
+    const uint32_t flags = irq_save();
+
+    const uint32_t cls = lockstat_class_of(site, type);
+
+    if (unlikely(cls == LOCKSTAT_CLASS_FULL)) {
+        __atomic_fetch_add(&g_overflow, 1u, __ATOMIC_RELAXED);
+        irq_restore(flags);
+        return LOCKSTAT_NO_CLASS;
+    }
+
+    lockstat_class_t* c = &g_classes[cls];
+
+    __atomic_store_n(&c->lock, (uintptr_t)lock, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&c->contended, 1u, __ATOMIC_RELAXED);
+    lockstat_add64(&c->wait_cycles, wait_cycles);
+    __atomic_fetch_add(&c->wait_hist[lockstat_bucket(wait_cycles)], 1u, __ATOMIC_RELAXED);
+
+    irq_restore(flags);
+
+    return cls;
+}
+
+void lockstat_held(uint32_t cls, uint64_t hold_cycles) {
+    if (unlikely(cls == LOCKSTAT_NO_CLASS || cls > LOCKSTAT_MAX_CLASSES)) {
+        return;
+    }
+
+    lockstat_class_t* c = &g_classes[cls];
+
+    __atomic_fetch_add(&c->held, 1u, __ATOMIC_RELAXED);
+    lockstat_add64(&c->hold_cycles, hold_cycles);
+    __atomic_fetch_add(&c->hold_hist[lockstat_bucket(hold_cycles)], 1u, __ATOMIC_RELAXED);
+}
+
+void lockstat_spin_acquired(spinlock_t* lock, uint32_t cls, uint64_t now) {
+    if (cls == LOCKSTAT_NO_CLASS) {
+        return;
+    }
+
+    const uint32_t flags = irq_save();
+
+    lockstat_spin_stack_t* st = &g_spin_stacks[hal_cpu_index()];
+
+    /*
+     * A lock released on another CPU leaves its entry behind here; once
+     * those fill the stack, start over. Their releases just find nothing.
+     */
+    if (unlikely(st->depth == LOCKSTAT_SPIN_DEPTH)) {
+        st->depth = 0u;
+    }
+
+    lockstat_spin_hold_t* h = &st->holds[st->depth++];
+
+    h->lock = lock;
+    h->cls = cls;
+    h->start = now;
+
+    __atomic_store_n(&lock->lockstat, 1u, __ATOMIC_RELAXED);
+
+    irq_restore(flags);
+}
+
+void lockstat_spin_release(spinlock_t* lock) {
+    const uint64_t now = lockstat_clock();
+
+    const uint32_t flags = irq_save();
+
+    __atomic_store_n(&lock->lockstat, 0u, __ATOMIC_RELAXED);
+
+    lockstat_spin_stack_t* st = &g_spin_stacks[hal_cpu_index()];
+
+    for (uint32_t i = st->depth; i-- > 0u;) {
+        lockstat_spin_hold_t* h = &st->holds[i];
+
+        if (h->lock != lock) {
+            continue;
+        }
+
+        lockstat_held(h->cls, now - h->start);
+
+        st->depth--;
+        if (i != st->depth) {
+            *h = st->holds[st->depth];
+        }
+
+        break;
+    }
+
+    irq_restore(flags);
+}
+
+void lockstat_get_info(yos_lockstat_info_t* out) {
+    if (!out) {
+        return;
+    }
+
+    uint32_t classes = __atomic_load_n(&g_class_count, __ATOMIC_RELAXED);
+    if (classes > LOCKSTAT_MAX_CLASSES) {
+        classes = LOCKSTAT_MAX_CLASSES;
+    }
+
+    out->enabled = 1u;
+    out->tsc_khz = (uint32_t)(g_cpu_tsc_hz / 1000ull);
+    out->classes = classes;
+    out->overflow = __atomic_load_n(&g_overflow, __ATOMIC_RELAXED);
+}
+
+void lockstat_reset(void) {
+    for (uint32_t i = 1; i <= LOCKSTAT_MAX_CLASSES; i++) {
+        lockstat_class_t* c = &g_classes[i];
+
+        __atomic_store_n(&c->contended, 0u, __ATOMIC_RELAXED);
+        lockstat_store64(&c->wait_cycles, 0u);
+        __atomic_store_n(&c->held, 0u, __ATOMIC_RELAXED);
+        lockstat_store64(&c->hold_cycles, 0u);
+
+        for (uint32_t b = 0; b < YOS_LOCKSTAT_BUCKETS; b++) {
+            __atomic_store_n(&c->wait_hist[b], 0u, __ATOMIC_RELAXED);
+            __atomic_store_n(&c->hold_hist[b], 0u, __ATOMIC_RELAXED);
+        }
+    }
+
+    __atomic_store_n(&g_overflow, 0u, __ATOMIC_RELAXED);
+}
+
+uint32_t lockstat_read(uint32_t first, yos_lockstat_class_t* out, uint32_t max) {
+    if (!out) {
+        return 0;
+    }
+
+    uint32_t count = __atomic_load_n(&g_class_count, __ATOMIC_RELAXED);
+    if (count > LOCKSTAT_MAX_CLASSES) {
+        count = LOCKSTAT_MAX_CLASSES;
+    }
+
+    uint32_t n = 0;
+
+    /* Counters are read without stopping writers; each one is individually consistent. */
+    for (uint32_t i = first + 1u; i <= count && n < max; i++) {
+        const lockstat_class_t* c = &g_classes[i];
+        yos_lockstat_class_t* o = &out[n++];
+
+        o->site = (uint32_t)__atomic_load_n(&c->site, __ATOMIC_ACQUIRE);
+        o->lock = (uint32_t)__atomic_load_n(&c->lock, __ATOMIC_RELAXED);
+        o->type = c->type;
+        o->contended = __atomic_load_n(&c->contended, __ATOMIC_RELAXED);
+        o->wait_cycles = lockstat_load64(&c->wait_cycles);
+        o->held = __atomic_load_n(&c->held, __ATOMIC_RELAXED);
+        o->hold_cycles = lockstat_load64(&c->hold_cycles);
+
+        for (uint32_t b = 0; b < YOS_LOCKSTAT_BUCKETS; b++) {
+            o->wait_hist[b] = __atomic_load_n(&c->wait_hist[b], __ATOMIC_RELAXED);
+            o->hold_hist[b] = __atomic_load_n(&c->hold_hist[b], __ATOMIC_RELAXED);
+        }
+    }
+
+    return n;
+}
+
+#else
+
+void lockstat_get_info(yos_lockstat_info_t* out) {
+    if (out) {
+        memset(out, 0, sizeof(*out));
+    }
+}
+
+void lockstat_reset(void) {
+}
+
+uint32_t lockstat_read(uint32_t first, yos_lockstat_class_t* out, uint32_t max) {
+    (void)first;
+    (void)out;
+    (void)max;
+
+    return 0;
+}
+
+#endif
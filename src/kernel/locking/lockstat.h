@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef KERNEL_LOCKING_LOCKSTAT_H
+#define KERNEL_LOCKING_LOCKSTAT_H
+
+#include <yos/lockstat.h>
+
+#include <lib/compiler.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Lock contention statistics, built in with KERNEL_LOCKSTAT=1.
+ *
+ * Lock fast paths are not instrumented: the clock is only read once an
+ * acquisition has failed its first attempt, and the wait is charged to the
+ * class of the acquiring call site. Exclusive acquisitions that waited also
+ * time their hold until release.
+ */
+
+/* Return address of the lock function using it: the acquisition site. */
+#define LOCKSTAT_SITE() ((uintptr_t)__builtin_return_address(0))
+
+#ifdef KERNEL_LOCKSTAT
+
+/* Class indices start at 1; 0 means "not recorded". */
+#define LOCKSTAT_NO_CLASS 0u
+
+___inline uint64_t lockstat_clock(void) {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | (uint64_t)lo;
+}
+
+/* Charge one contended acquisition to the class of `site`. Returns the class. */
+uint32_t lockstat_contended(uint32_t type, const void* lock, uintptr_t site, uint64_t wait_cycles);
+
+/* Record the hold time of an acquisition previously charged to `cls`. */
+void lockstat_held(uint32_t cls, uint64_t hold_cycles);
+
+/*
+ * Hold timer for sleeping locks. Embedded in the lock and only touched by
+ * the owner; a zeroed timer is idle.
+ */
+typedef struct {
+    uint32_t cls;
+    uint64_t start;
+} lockstat_hold_t;
+
+___inline void lockstat_hold_begin(lockstat_hold_t* h, uint32_t cls, uint64_t now) {
+    h->start = now;
+    h->cls = cls;
+}
+
+___inline void lockstat_hold_end(lockstat_hold_t* h) {
+    const uint32_t cls = h->cls;
+
+    if (cls != LOCKSTAT_NO_CLASS) {
+        h->cls = LOCKSTAT_NO_CLASS;
+        lockstat_held(cls, lockstat_clock() - h->start);
+    }
+}
+
+#endif
+
+/* /dev/lockstat backend; also present, and empty, without KERNEL_LOCKSTAT. */
+void lockstat_get_info(yos_lockstat_info_t* out);
+
+/* Zero every counter; registered call sites are kept. */
+void lockstat_reset(void);
+
+/* Copy up to `max` classes, starting with the `first`-th registered, into `out`. */
+uint32_t lockstat_read(uint32_t first, yos_lockstat_class_t* out, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,6 +23,10 @@ void mutex_init(mutex_t* m) {
 
     spinlock_init(&m->wait_lock);
     waitqueue_init(&m->waitq, (void*)m, TASK_BLOCK_SEM);
+
+#ifdef KERNEL_LOCKSTAT
+    m->stat_hold.cls = LOCKSTAT_NO_CLASS;
+#endif
 }
 
 /*
@@ -66,7 +70,7 @@ ___noinline static int mutex_spin_on_owner(mutex_t* m) {
     return 0;
 }
 
-___noinline static void mutex_lock_slowpath(mutex_t* m, task_t* curr) {
+___noinline static void mutex_lock_contended(mutex_t* m, task_t* curr) {
     const uintptr_t curr_val = (uintptr_t)curr;
 
     if (mutex_spin_on_owner(m)) {
@@ -133,6 +137,23 @@ ___noinline static void mutex_lock_slowpath(mutex_t* m, task_t* curr) {
     spinlock_release_safe(&m->wait_lock, flags);
 }
 
+static void mutex_lock_slowpath(mutex_t* m, task_t* curr, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    const uint64_t start = lockstat_clock();
+
+    mutex_lock_contended(m, curr);
+
+    const uint64_t now = lockstat_clock();
+    const uint32_t cls = lockstat_contended(YOS_LOCKSTAT_MUTEX, m, site, now - start);
+
+    lockstat_hold_begin(&m->stat_hold, cls, now);
+#else
+    (void)site;
+
+    mutex_lock_contended(m, curr);
+#endif
+}
+
 void mutex_lock(mutex_t* m) {
     if (unlikely(!m)) {
         return;
@@ -153,7 +174,7 @@ void mutex_lock(mutex_t* m) {
         return;
     }
 
-    mutex_lock_slowpath(m, curr);
+    mutex_lock_slowpath(m, curr, LOCKSTAT_SITE());
 }
 
 ___noinline static void mutex_unlock_slowpath(mutex_t* m, task_t* curr) {
@@ -189,6 +210,10 @@ void mutex_unlock(mutex_t* m) {
     task_t* curr = proc_current();
     const uintptr_t curr_val = (uintptr_t)curr;
 
+#ifdef KERNEL_LOCKSTAT
+    lockstat_hold_end(&m->stat_hold);
+#endif
+
     uintptr_t expected = curr_val;
 
     /*
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 
+#include "lockstat.h"
 #include "spinlock.h"
 #include "guards.h"
 
@@ -20,6 +21,10 @@ typedef struct {
 
     spinlock_t wait_lock;
     waitqueue_t waitq;
+
+#ifdef KERNEL_LOCKSTAT
+    lockstat_hold_t stat_hold;
+#endif
 } mutex_t;
 
 void mutex_init(mutex_t* m);
@@ -30,6 +30,10 @@ void rwlock_init(rwlock_t* rw) {
 
     waitqueue_init(&rw->read_waitq_, (void*)rw, TASK_BLOCK_SEM);
     waitqueue_init(&rw->write_waitq_, (void*)rw, TASK_BLOCK_SEM);
+
+#ifdef KERNEL_LOCKSTAT
+    rw->stat_hold_.cls = LOCKSTAT_NO_CLASS;
+#endif
 }
 
 static void rwlock_wake_waiters(rwlock_t* rw) {
@@ -102,7 +106,7 @@ static int rwlock_spin_on_writer(rwlock_t* rw) {
     return 0;
 }
 
-static void rwlock_acquire_read_slowpath(rwlock_t* rw) {
+static void rwlock_acquire_read_contended(rwlock_t* rw) {
     task_t* curr = proc_current();
 
     for (;;) {
@@ -150,6 +154,20 @@ static void rwlock_acquire_read_slowpath(rwlock_t* rw) {
     }
 }
 
+static void rwlock_acquire_read_slowpath(rwlock_t* rw, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    const uint64_t start = lockstat_clock();
+
+    rwlock_acquire_read_contended(rw);
+
+    (void)lockstat_contended(YOS_LOCKSTAT_RWLOCK_READ, rw, site, lockstat_clock() - start);
+#else
+    (void)site;
+
+    rwlock_acquire_read_contended(rw);
+#endif
+}
+
 void rwlock_acquire_read(rwlock_t* rw) {
     if (unlikely(!rw)) {
         return;
@@ -168,7 +186,7 @@ void rwlock_acquire_read(rwlock_t* rw) {
         }
     }
 
-    rwlock_acquire_read_slowpath(rw);
+    rwlock_acquire_read_slowpath(rw, LOCKSTAT_SITE());
 }
 
 void rwlock_release_read(rwlock_t* rw) {
@@ -189,7 +207,7 @@ void rwlock_release_read(rwlock_t* rw) {
     }
 }
 
-static void rwlock_acquire_write_slowpath(rwlock_t* rw, task_t* curr) {
+static void rwlock_acquire_write_contended(rwlock_t* rw, task_t* curr) {
     const uintptr_t curr_val = (uintptr_t)curr;
 
     for (;;) {
@@ -238,6 +256,23 @@ static void rwlock_acquire_write_slowpath(rwlock_t* rw, task_t* curr) {
     }
 }
 
+static void rwlock_acquire_write_slowpath(rwlock_t* rw, task_t* curr, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    const uint64_t start = lockstat_clock();
+
+    rwlock_acquire_write_contended(rw, curr);
+
+    const uint64_t now = lockstat_clock();
+    const uint32_t cls = lockstat_contended(YOS_LOCKSTAT_RWLOCK_WRITE, rw, site, now - start);
+
+    lockstat_hold_begin(&rw->stat_hold_, cls, now);
+#else
+    (void)site;
+
+    rwlock_acquire_write_contended(rw, curr);
+#endif
+}
+
 void rwlock_acquire_write(rwlock_t* rw) {
     if (unlikely(!rw)) {
         return;
@@ -258,7 +293,7 @@ void rwlock_acquire_write(rwlock_t* rw) {
         return;
     }
 
-    rwlock_acquire_write_slowpath(rw, curr);
+    rwlock_acquire_write_slowpath(rw, curr, LOCKSTAT_SITE());
 }
 
 void rwlock_release_write(rwlock_t* rw) {
@@ -266,6 +301,10 @@ void rwlock_release_write(rwlock_t* rw) {
         return;
     }
 
+#ifdef KERNEL_LOCKSTAT
+    lockstat_hold_end(&rw->stat_hold_);
+#endif
+
     __atomic_store_n(&rw->writer_owner_, 0u, __ATOMIC_RELAXED);
 
     const uint32_t s = __atomic_fetch_and(&rw->state_, ~RWLOCK_WRITER, __ATOMIC_RELEASE);
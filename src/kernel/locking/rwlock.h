@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 
+#include "lockstat.h"
 #include "spinlock.h"
 #include "guards.h"
 
@@ -23,6 +24,10 @@ typedef struct {
 
     waitqueue_t read_waitq_;
     waitqueue_t write_waitq_;
+
+#ifdef KERNEL_LOCKSTAT
+    lockstat_hold_t stat_hold_;
+#endif
 } rwlock_t;
 
 void rwlock_init(rwlock_t* rw);
@@ -6,6 +6,7 @@
 #include <hal/cpu.h>
 #include <hal/irq.h>
 
+#include "lockstat.h"
 #include "rwspinlock.h"
 
 /*
@@ -28,10 +29,12 @@ void rwspinlock_init(rwspinlock_t* rw) {
     spinlock_init(&rw->wait_lock);
 }
 
-void rwspinlock_acquire_read(rwspinlock_t* rw) {
-    if (unlikely(!rw)) {
-        return;
-    }
+___inline void rwspin_read_lock(rwspinlock_t* rw, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    uint64_t start = 0u;
+#else
+    (void)site;
+#endif
 
     uint32_t s;
 
@@ -43,6 +46,11 @@ void rwspinlock_acquire_read(rwspinlock_t* rw) {
          * We do not attempt CAS while these bits are set, avoiding cache bouncing.
          */
         if (unlikely((s & (RW_STATE_WRITER_LOCKED | RW_STATE_WRITER_PENDING)) != 0u)) {
+#ifdef KERNEL_LOCKSTAT
+            if (start == 0u) {
+                start = lockstat_clock();
+            }
+#endif
             cpu_relax();
             continue;
         }
@@ -53,25 +61,45 @@ void rwspinlock_acquire_read(rwspinlock_t* rw) {
         );
 
         if (likely(acquired)) {
+#ifdef KERNEL_LOCKSTAT
+            if (unlikely(start != 0u)) {
+                (void)lockstat_contended(YOS_LOCKSTAT_RWSPIN_READ, rw, site, lockstat_clock() - start);
+            }
+#endif
             return;
         }
     }
 }
 
-void rwspinlock_release_read(rwspinlock_t* rw) {
+void rwspinlock_acquire_read(rwspinlock_t* rw) {
     if (unlikely(!rw)) {
         return;
     }
 
-    __atomic_fetch_sub(&rw->state, 1u, __ATOMIC_RELEASE);
+    rwspin_read_lock(rw, LOCKSTAT_SITE());
 }
 
-void rwspinlock_acquire_write(rwspinlock_t* rw) {
+void rwspinlock_release_read(rwspinlock_t* rw) {
     if (unlikely(!rw)) {
         return;
     }
 
+    __atomic_fetch_sub(&rw->state, 1u, __ATOMIC_RELEASE);
+}
+
+___inline void rwspin_write_lock(rwspinlock_t* rw, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    uint64_t start = 0u;
+
+    if (unlikely(!spinlock_try_acquire(&rw->wait_lock))) {
+        start = lockstat_clock();
+        spinlock_acquire_queued(&rw->wait_lock);
+    }
+#else
+    (void)site;
+
     spinlock_acquire(&rw->wait_lock);
+#endif
 
     __atomic_fetch_or(&rw->state, RW_STATE_WRITER_PENDING, __ATOMIC_ACQUIRE);
 
@@ -87,14 +115,37 @@ void rwspinlock_acquire_write(rwspinlock_t* rw) {
             );
 
             if (likely(acquired)) {
+#ifdef KERNEL_LOCKSTAT
+                /* The hold ends when wait_lock is released with the write lock. */
+                if (unlikely(start != 0u)) {
+                    const uint64_t now = lockstat_clock();
+                    const uint32_t cls = lockstat_contended(YOS_LOCKSTAT_RWSPIN_WRITE, rw, site, now - start);
+
+                    lockstat_spin_acquired(&rw->wait_lock, cls, now);
+                }
+#endif
                 return;
             }
         }
 
+#ifdef KERNEL_LOCKSTAT
+        if (start == 0u) {
+            start = lockstat_clock();
+        }
+#endif
+
         cpu_relax();
     }
 }
 
+void rwspinlock_acquire_write(rwspinlock_t* rw) {
+    if (unlikely(!rw)) {
+        return;
+    }
+
+    rwspin_write_lock(rw, LOCKSTAT_SITE());
+}
+
 void rwspinlock_release_write(rwspinlock_t* rw) {
     if (unlikely(!rw)) {
         return;
@@ -109,7 +160,9 @@ void rwspinlock_release_write(rwspinlock_t* rw) {
 uint32_t rwspinlock_acquire_read_safe(rwspinlock_t* rw) {
     uint32_t flags = irq_save();
 
-    rwspinlock_acquire_read(rw);
+    if (likely(rw)) {
+        rwspin_read_lock(rw, LOCKSTAT_SITE());
+    }
 
     return flags;
 }
@@ -125,7 +178,9 @@ void rwspinlock_release_read_safe(rwspinlock_t* rw, uint32_t flags) {
 uint32_t rwspinlock_acquire_write_safe(rwspinlock_t* rw) {
     uint32_t flags = irq_save();
 
-    rwspinlock_acquire_write(rw);
+    if (likely(rw)) {
+        rwspin_write_lock(rw, LOCKSTAT_SITE());
+    }
 
     return flags;
 }
@@ -152,16 +207,23 @@ void percpu_rwspinlock_init(percpu_rwspinlock_t* rw) {
     }
 }
 
-void percpu_rwspinlock_acquire_read(percpu_rwspinlock_t* rw) {
-    if (unlikely(!rw)) {
-        return;
-    }
+___inline void percpu_rwspin_read_lock(percpu_rwspinlock_t* rw, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    uint64_t start = 0u;
+#else
+    (void)site;
+#endif
 
     const int cpu = hal_cpu_index();
 
     for (;;) {
         /* Wait out the active writer gently */
         if (unlikely(__atomic_load_n(&rw->writer_active, __ATOMIC_ACQUIRE) != 0u)) {
+#ifdef KERNEL_LOCKSTAT
+            if (start == 0u) {
+                start = lockstat_clock();
+            }
+#endif
             cpu_relax();
             continue;
         }
@@ -169,6 +231,11 @@ void percpu_rwspinlock_acquire_read(percpu_rwspinlock_t* rw) {
         __atomic_fetch_add(&rw->readers[cpu].count, 1u, __ATOMIC_SEQ_CST);
 
         if (likely(__atomic_load_n(&rw->writer_active, __ATOMIC_SEQ_CST) == 0u)) {
+#ifdef KERNEL_LOCKSTAT
+            if (unlikely(start != 0u)) {
+                (void)lockstat_contended(YOS_LOCKSTAT_RWSPIN_READ, rw, site, lockstat_clock() - start);
+            }
+#endif
             return;
         }
 
@@ -178,12 +245,26 @@ void percpu_rwspinlock_acquire_read(percpu_rwspinlock_t* rw) {
          */
         __atomic_fetch_sub(&rw->readers[cpu].count, 1u, __ATOMIC_SEQ_CST);
 
+#ifdef KERNEL_LOCKSTAT
+        if (start == 0u) {
+            start = lockstat_clock();
+        }
+#endif
+
         while (__atomic_load_n(&rw->writer_active, __ATOMIC_ACQUIRE) != 0u) {
             cpu_relax();
         }
     }
 }
 
+void percpu_rwspinlock_acquire_read(percpu_rwspinlock_t* rw) {
+    if (unlikely(!rw)) {
+        return;
+    }
+
+    percpu_rwspin_read_lock(rw, LOCKSTAT_SITE());
+}
+
 void percpu_rwspinlock_release_read(percpu_rwspinlock_t* rw) {
     if (unlikely(!rw)) {
         return;
@@ -194,12 +275,19 @@ void percpu_rwspinlock_release_read(percpu_rwspinlock_t* rw) {
     __atomic_fetch_sub(&rw->readers[cpu].count, 1u, __ATOMIC_RELEASE);
 }
 
-void percpu_rwspinlock_acquire_write(percpu_rwspinlock_t* rw) {
-    if (unlikely(!rw)) {
-        return;
+___inline void percpu_rwspin_write_lock(percpu_rwspinlock_t* rw, uintptr_t site) {
+#ifdef KERNEL_LOCKSTAT
+    uint64_t start = 0u;
+
+    if (unlikely(!spinlock_try_acquire(&rw->writer_mutex))) {
+        start = lockstat_clock();
+        spinlock_acquire_queued(&rw->writer_mutex);
     }
+#else
+    (void)site;
 
     spinlock_acquire(&rw->writer_mutex);
+#endif
 
     /*
      * SEQ_CST guarantees visibility of writer_active before we proceed
@@ -209,9 +297,31 @@ void percpu_rwspinlock_acquire_write(percpu_rwspinlock_t* rw) {
 
     for (int i = 0; i < MAX_CPUS; i++) {
         while (__atomic_load_n(&rw->readers[i].count, __ATOMIC_ACQUIRE) != 0u) {
+#ifdef KERNEL_LOCKSTAT
+            if (start == 0u) {
+                start = lockstat_clock();
+            }
+#endif
             cpu_relax();
         }
     }
+
+#ifdef KERNEL_LOCKSTAT
+    if (unlikely(start != 0u)) {
+        const uint64_t now = lockstat_clock();
+        const uint32_t cls = lockstat_contended(YOS_LOCKSTAT_RWSPIN_WRITE, rw, site, now - start);
+
+        lockstat_spin_acquired(&rw->writer_mutex, cls, now);
+    }
+#endif
+}
+
+void percpu_rwspinlock_acquire_write(percpu_rwspinlock_t* rw) {
+    if (unlikely(!rw)) {
+        return;
+    }
+
+    percpu_rwspin_write_lock(rw, LOCKSTAT_SITE());
 }
 
 void percpu_rwspinlock_release_write(percpu_rwspinlock_t* rw) {
@@ -227,7 +337,9 @@ void percpu_rwspinlock_release_write(percpu_rwspinlock_t* rw) {
 uint32_t percpu_rwspinlock_acquire_read_safe(percpu_rwspinlock_t* rw) {
     uint32_t flags = irq_save();
 
-    percpu_rwspinlock_acquire_read(rw);
+    if (likely(rw)) {
+        percpu_rwspin_read_lock(rw, LOCKSTAT_SITE());
+    }
 
     return flags;
 }
@@ -243,7 +355,9 @@ void percpu_rwspinlock_release_read_safe(percpu_rwspinlock_t* rw, uint32_t flags
 uint32_t percpu_rwspinlock_acquire_write_safe(percpu_rwspinlock_t* rw) {
     uint32_t flags = irq_save();
 
-    percpu_rwspinlock_acquire_write(rw);
+    if (likely(rw)) {
+        percpu_rwspin_write_lock(rw, LOCKSTAT_SITE());
+    }
 
     return flags;
 }
@@ -10,6 +10,7 @@
 
 #include <hal/cpu.h>
 
+#include "lockstat.h"
 #include "sem.h"
 
 extern "C" volatile uint32_t timer_ticks;
@@ -86,31 +87,7 @@ extern "C" int sem_try_acquire(semaphore_t* sem) {
     return 0;
 }
 
-extern "C" void sem_wait(semaphore_t* sem) {
-    if (kernel::unlikely(!sem)) {
-        return;
-    }
-
-    task_t* curr = proc_current();
-
-    if (kernel::unlikely(!curr)) {
-        /*
-         * Early boot or contextless execution.
-         * We cannot sleep, so we must spin indefinitely.
-         */
-        while (!sem_try_acquire_fast(sem)) {
-            cpu_relax();
-        }
-
-        return;
-    }
-
-    if (kernel::likely(sem_try_acquire_fast(sem))) {
-        curr->blocked_on_sem = nullptr;
-        curr->blocked_kind = TASK_BLOCK_NONE;
-        return;
-    }
-
+static void sem_wait_contended(semaphore_t* sem, task_t* curr) {
     if (kernel::likely(sem_optimistic_spin(sem))) {
         curr->blocked_on_sem = nullptr;
         curr->blocked_kind = TASK_BLOCK_NONE;
@@ -150,31 +127,43 @@ extern "C" void sem_wait(semaphore_t* sem) {
     }
 }
 
-extern "C" int sem_wait_timeout(semaphore_t* sem, uint32_t deadline_tick) {
+extern "C" void sem_wait(semaphore_t* sem) {
     if (kernel::unlikely(!sem)) {
-        return 0;
+        return;
     }
 
     task_t* curr = proc_current();
 
     if (kernel::unlikely(!curr)) {
+        /*
+         * Early boot or contextless execution.
+         * We cannot sleep, so we must spin indefinitely.
+         */
         while (!sem_try_acquire_fast(sem)) {
-            if (kernel::unlikely((uint32_t)(timer_ticks - deadline_tick) < 0x80000000u)) {
-                return 0;
-            }
-
             cpu_relax();
         }
 
-        return 1;
+        return;
     }
 
     if (kernel::likely(sem_try_acquire_fast(sem))) {
         curr->blocked_on_sem = nullptr;
         curr->blocked_kind = TASK_BLOCK_NONE;
-        return 1;
+        return;
     }
 
+#ifdef KERNEL_LOCKSTAT
+    const uint64_t start = lockstat_clock();
+
+    sem_wait_contended(sem, curr);
+
+    (void)lockstat_contended(YOS_LOCKSTAT_SEM, sem, LOCKSTAT_SITE(), lockstat_clock() - start);
+#else
+    sem_wait_contended(sem, curr);
+#endif
+}
+
+static int sem_wait_timeout_contended(semaphore_t* sem, task_t* curr, uint32_t deadline_tick) {
     if (kernel::likely(sem_optimistic_spin(sem))) {
         curr->blocked_on_sem = nullptr;
         curr->blocked_kind = TASK_BLOCK_NONE;
@@ -221,6 +210,46 @@ extern "C" int sem_wait_timeout(semaphore_t* sem, uint32_t deadline_tick) {
     }
 }
 
+extern "C" int sem_wait_timeout(semaphore_t* sem, uint32_t deadline_tick) {
+    if (kernel::unlikely(!sem)) {
+        return 0;
+    }
+
+    task_t* curr = proc_current();
+
+    if (kernel::unlikely(!curr)) {
+        while (!sem_try_acquire_fast(sem)) {
+            if (kernel::unlikely((uint32_t)(timer_ticks - deadline_tick) < 0x80000000u)) {
+                return 0;
+            }
+
+            cpu_relax();
+        }
+
+        return 1;
+    }
+
+    if (kernel::likely(sem_try_acquire_fast(sem))) {
+        curr->blocked_on_sem = nullptr;
+        curr->blocked_kind = TASK_BLOCK_NONE;
+        return 1;
+    }
+
+#ifdef KERNEL_LOCKSTAT
+    const uint64_t start = lockstat_clock();
+
+    const int acquired = sem_wait_timeout_contended(sem, curr, deadline_tick);
+
+    if (acquired) {
+        (void)lockstat_contended(YOS_LOCKSTAT_SEM, sem, LOCKSTAT_SITE(), lockstat_clock() - start);
+    }
+
+    return acquired;
+#else
+    return sem_wait_timeout_contended(sem, curr, deadline_tick);
+#endif
+}
+
 extern "C" void sem_signal(semaphore_t* sem) {
     if (kernel::unlikely(!sem)) {
         return;
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: GPL-2.0 */
 /* Copyright (C) 2026 Yula1234 */
 
+#include <kernel/locking/lockstat.h>
 #include <kernel/smp/cpu_limits.h>
 #include <kernel/panic.h>
 
@@ -53,7 +54,7 @@ ___inline qnode_t* decode_tail(uint32_t val) {
     return &g_qnodes[cpu][idx];
 }
 
-void spinlock_acquire_slowpath(spinlock_t* lock) {
+static void spinlock_queue_acquire(spinlock_t* lock) {
     const int cpu = hal_cpu_index();
 
     if (unlikely(cpu < 0 || cpu >= MAX_CPUS)) {
@@ -161,4 +162,30 @@ void spinlock_acquire_slowpath(spinlock_t* lock) {
 
 release_node:
     this_cpu_dec(&g_qnode_idx[cpu]);
-}
\ No newline at end of file
+}
+
+#ifdef KERNEL_LOCKSTAT
+
+void spinlock_acquire_queued(spinlock_t* lock) {
+    spinlock_queue_acquire(lock);
+}
+
+void spinlock_acquire_slowpath(spinlock_t* lock) {
+    const uintptr_t site = LOCKSTAT_SITE();
+    const uint64_t start = lockstat_clock();
+
+    spinlock_queue_acquire(lock);
+
+    const uint64_t now = lockstat_clock();
+    const uint32_t cls = lockstat_contended(YOS_LOCKSTAT_SPIN, lock, site, now - start);
+
+    lockstat_spin_acquired(lock, cls, now);
+}
+
+#else
+
+void spinlock_acquire_slowpath(spinlock_t* lock) {
+    spinlock_queue_acquire(lock);
+}
+
+#endif
@@ -21,7 +21,9 @@ typedef struct {
         volatile uint32_t val;
         struct {
             volatile uint8_t locked;
-            uint8_t reserved;
+
+            /* Set by lockstat while the holder's hold time is being measured. */
+            uint8_t lockstat;
             volatile uint16_t tail;
         };
     };
@@ -32,6 +34,18 @@ typedef struct {
 /* Out-of-line slow path, implemented in spinlock.c */
 void spinlock_acquire_slowpath(spinlock_t* lock);
 
+#ifdef KERNEL_LOCKSTAT
+/*
+ * Queue for the lock without charging the wait to lockstat, for locks built
+ * on spinlock_t that account their own waits. They start the hold timer
+ * with lockstat_spin_acquired() once the whole acquisition is done.
+ */
+void spinlock_acquire_queued(spinlock_t* lock);
+
+void lockstat_spin_acquired(spinlock_t* lock, uint32_t cls, uint64_t now);
+void lockstat_spin_release(spinlock_t* lock);
+#endif
+
 ___inline void spinlock_init(spinlock_t* lock) {
 #ifdef __cplusplus
     if (kernel::unlikely(!lock)) {
@@ -89,6 +103,16 @@ ___inline void spinlock_release(spinlock_t* lock) {
      * This compiles down to a single 'mov byte ptr [eax], 0' instruction,
      * completely avoiding the heavy 'lock' prefix.
      */
+#ifdef KERNEL_LOCKSTAT
+#ifdef __cplusplus
+    if (kernel::unlikely(__atomic_load_n(&lock->lockstat, __ATOMIC_RELAXED) != 0u)) {
+#else
+    if (unlikely(__atomic_load_n(&lock->lockstat, __ATOMIC_RELAXED) != 0u)) {
+#endif
+        lockstat_spin_release(lock);
+    }
+#endif
+
     __atomic_store_n(&lock->locked, 0u, __ATOMIC_RELEASE);
 }
 
@@ -0,0 +1,508 @@
+#include <kernel/output/console.h>
+#include <kernel/output/kprintf.h>
+#include <kernel/output/kmsg.h>
+
+#include <kernel/locking/sem.h>
+#include <kernel/smp/cpu.h>
+#include <kernel/panic.h>
+#include <kernel/proc.h>
+
+#include <lib/cpp/lock_guard.h>
+#include <lib/compiler.h>
+#include <lib/div64.h>
+#include <lib/string.h>
+
+#include <hal/delay.h>
+#include <hal/apic.h>
+#include <hal/cpu.h>
+#include <hal/irq.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern volatile uint32_t timer_ticks;
+
+namespace kernel::output {
+namespace {
+
+static constexpr uint32_t k_stage_size = 4096u;
+static constexpr uint32_t k_history_size = 65536u;
+
+/* Staging buffer used before the flusher runs, when per-CPU data may not be set up yet. */
+static constexpr uint32_t k_boot_stage = MAX_CPUS;
+
+/* The flusher polls every 4 ms, and is woken early once a staging ring is half full. */
+static constexpr uint32_t k_flush_idle_ticks = KERNEL_TIMER_HZ / 250u;
+static constexpr uint32_t k_stage_wake = k_stage_size / 2u;
+
+static constexpr uint16_t k_record_pad = 1u;
+
+/* "[sssss.uuuuuu] " */
+static constexpr uint32_t k_prefix_max = 24u;
+
+struct KmsgRecord {
+    uint32_t seq;
+    uint16_t len;
+    uint16_t flags;
+    uint64_t tsc;
+};
+
+static_assert(sizeof(KmsgRecord) == 16u, "kmsg record header must stay 16 bytes");
+
+___inline uint32_t record_size(uint32_t len) {
+    return (static_cast<uint32_t>(sizeof(KmsgRecord)) + len + 15u) & ~15u;
+}
+
+/*
+ * Byte ring of variable-size records addressed by free-running positions.
+ * A record never wraps: when it does not fit before the end, a pad record
+ * fills the rest and the record starts at offset 0.
+ */
+template <uint32_t Size>
+struct RecordRing {
+    static_assert((Size & (Size - 1u)) == 0u, "ring size must be a power of two");
+
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t dropped;
+
+    alignas(16) uint8_t data[Size];
+
+    KmsgRecord* at(uint32_t pos) {
+        return reinterpret_cast<KmsgRecord*>(&data[pos & (Size - 1u)]);
+    }
+
+    static uint32_t to_end(uint32_t pos) {
+        return Size - (pos & (Size - 1u));
+    }
+
+    /* Bytes an append of `len` text bytes at `pos` consumes, wrap padding included. */
+    static uint32_t cost(uint32_t pos, uint32_t len) {
+        const uint32_t need = record_size(len);
+        const uint32_t end = to_end(pos);
+
+        return need > end ? end + need : need;
+    }
+
+    uint32_t next(uint32_t pos) {
+        const KmsgRecord* r = at(pos);
+
+        if (r->flags & k_record_pad) {
+            return pos + to_end(pos);
+        }
+
+        return pos + record_size(r->len);
+    }
+
+    /* Write one record at `pos`; the caller has made room. Returns the position after it. */
+    uint32_t put(uint32_t pos, uint32_t seq, uint64_t tsc, const char* text, uint32_t len) {
+        if (record_size(len) > to_end(pos)) {
+            KmsgRecord* pad = at(pos);
+
+            pad->seq = 0u;
+            pad->len = 0u;
+            pad->flags = k_record_pad;
+            pad->tsc = 0u;
+
+            pos += to_end(pos);
+        }
+
+        KmsgRecord* r = at(pos);
+
+        r->seq = seq;
+        r->len = static_cast<uint16_t>(len);
+        r->flags = 0u;
+        r->tsc = tsc;
+
+        memcpy(r + 1, text, len);
+
+        return pos + record_size(len);
+    }
+};
+
+/*
+ * Single producer per staging ring: its CPU, with interrupts off (the boot
+ * ring is serialized by g_boot_lock instead). The consumer is whoever holds
+ * g_log_lock.
+ */
+static RecordRing<k_stage_size> g_stage[MAX_CPUS + 1];
+
+/* Sequence-ordered history, overwrite-oldest. Guarded by g_log_lock. */
+static RecordRing<k_history_size> g_history;
+
+static uint32_t g_console_pos;
+
+static spinlock_t g_log_lock;
+static spinlock_t g_boot_lock;
+
+static uint32_t g_next_seq;
+
+static volatile uint32_t g_flusher_live;
+
+static semaphore_t g_flush_sem;
+
+/* A wake is on its way to the flusher; set until the flusher next drains. */
+static volatile uint32_t g_flush_pending;
+
+/* The wake was requested with interrupts off and is left to the timer tick. */
+static volatile uint32_t g_flush_deferred;
+
+___inline uint64_t kmsg_clock() {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+/* Interrupts off, so `idx` stays this CPU's ring. Returns how many bytes the ring now holds. */
+static uint32_t stage(uint32_t idx, const char* text, uint32_t len) {
+    RecordRing<k_stage_size>& ring = g_stage[idx];
+
+    const uint32_t head = ring.head;
+    const uint32_t tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+
+    if (kernel::unlikely(ring.cost(head, len) > k_stage_size - (head - tail))) {
+        __atomic_fetch_add(&ring.dropped, 1u, __ATOMIC_RELAXED);
+    } else {
+        const uint32_t seq = __atomic_fetch_add(&g_next_seq, 1u, __ATOMIC_RELAXED);
+        const uint32_t new_head = ring.put(head, seq, kmsg_clock(), text, len);
+
+        __atomic_store_n(&ring.head, new_head, __ATOMIC_RELEASE);
+
+        return new_head - tail;
+    }
+
+    return head - tail;
+}
+
+/*
+ * Get the flusher running before a burst overruns a staging ring. Waking it
+ * takes scheduler locks, which a caller with interrupts off (an IRQ handler,
+ * a spinlock holder) may already hold, so that case waits for the next tick.
+ */
+static void kick_flusher(bool can_wake) {
+    if (__atomic_exchange_n(&g_flush_pending, 1u, __ATOMIC_ACQ_REL) != 0u) {
+        return;
+    }
+
+    if (can_wake) {
+        sem_signal(&g_flush_sem);
+    } else {
+        __atomic_store_n(&g_flush_deferred, 1u, __ATOMIC_RELEASE);
+    }
+}
+
+static void history_append(const KmsgRecord* rec) {
+    const uint32_t cost = g_history.cost(g_history.head, rec->len);
+
+    while (k_history_size - (g_history.head - g_history.tail) < cost) {
+        g_history.tail = g_history.next(g_history.tail);
+    }
+
+    g_history.head = g_history.put(
+        g_history.head, rec->seq, rec->tsc, reinterpret_cast<const char*>(rec + 1), rec->len
+    );
+}
+
+/*
+ * Move every staged record into the history, lowest sequence number first.
+ * Caller holds g_log_lock (or is the only CPU left running).
+ */
+static void collect() {
+    for (;;) {
+        RecordRing<k_stage_size>* best = nullptr;
+        uint32_t best_pos = 0u;
+
+        for (uint32_t i = 0; i <= MAX_CPUS; i++) {
+            RecordRing<k_stage_size>& ring = g_stage[i];
+
+            uint32_t tail = ring.tail;
+            const uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+
+            if (tail != head && (ring.at(tail)->flags & k_record_pad)) {
+                tail = ring.next(tail);
+                __atomic_store_n(&ring.tail, tail, __ATOMIC_RELEASE);
+            }
+
+            if (tail == head) {
+                continue;
+            }
+
+            if (!best || static_cast<int32_t>(ring.at(tail)->seq - best->at(best_pos)->seq) < 0) {
+                best = &ring;
+                best_pos = tail;
+            }
+        }
+
+        if (!best) {
+            return;
+        }
+
+        const KmsgRecord* rec = best->at(best_pos);
+
+        history_append(rec);
+
+        __atomic_store_n(&best->tail, best_pos + record_size(rec->len), __ATOMIC_RELEASE);
+    }
+}
+
+static uint32_t take_dropped() {
+    uint32_t dropped = 0u;
+
+    for (uint32_t i = 0; i <= MAX_CPUS; i++) {
+        dropped += __atomic_exchange_n(&g_stage[i].dropped, 0u, __ATOMIC_RELAXED);
+    }
+
+    return dropped;
+}
+
+/* Copy the next record the console has not shown into `out`. Returns -1 if there is none. */
+static int next_console_record(char* out) {
+    if (static_cast<int32_t>(g_history.tail - g_console_pos) > 0) {
+        g_console_pos = g_history.tail;
+    }
+
+    while (g_console_pos != g_history.head) {
+        const KmsgRecord* r = g_history.at(g_console_pos);
+        const uint32_t next = g_history.next(g_console_pos);
+
+        g_console_pos = next;
+
+        if (r->flags & k_record_pad) {
+            continue;
+        }
+
+        memcpy(out, r + 1, r->len);
+        return r->len;
+    }
+
+    return -1;
+}
+
+/* Write everything pending to the console, one record at a time outside g_log_lock. */
+static void pump_console() {
+    char text[KMSG_TEXT_MAX];
+
+    for (;;) {
+        int n;
+
+        {
+            kernel::SpinLockNativeSafeGuard guard(g_log_lock);
+
+            collect();
+            n = next_console_record(text);
+        }
+
+        if (n < 0) {
+            return;
+        }
+
+        console_write(text, static_cast<size_t>(n));
+    }
+}
+
+static void kmsg_flusher_task(void*) {
+    __atomic_store_n(&g_flusher_live, 1u, __ATOMIC_RELEASE);
+
+    for (;;) {
+        __atomic_store_n(&g_flush_pending, 0u, __ATOMIC_RELEASE);
+
+        pump_console();
+
+        const uint32_t dropped = take_dropped();
+
+        if (dropped != 0u) {
+            kprintf("kmsg: %u messages dropped\n", dropped);
+            continue;
+        }
+
+        (void)sem_wait_timeout(&g_flush_sem, timer_ticks + k_flush_idle_ticks);
+    }
+}
+
+static char* put_uint(char* p, uint32_t v, int width, char fill) {
+    char rev[10];
+    int n = 0;
+
+    do {
+        rev[n++] = static_cast<char>('0' + v % 10u);
+        v /= 10u;
+    } while (v != 0u);
+
+    for (int i = n; i < width; i++) {
+        *p++ = fill;
+    }
+
+    while (n > 0) {
+        *p++ = rev[--n];
+    }
+
+    return p;
+}
+
+static uint32_t format_prefix(char* out, uint64_t tsc) {
+    uint32_t sec;
+    uint32_t usec;
+
+    tsc_to_sec_usec(tsc, g_cpu_tsc_hz, &sec, &usec);
+
+    char* p = out;
+
+    *p++ = '[';
+    p = put_uint(p, sec, 5, ' ');
+    *p++ = '.';
+    p = put_uint(p, usec, 6, '0');
+    *p++ = ']';
+    *p++ = ' ';
+
+    return static_cast<uint32_t>(p - out);
+}
+
+}
+}
+
+using namespace kernel::output;
+
+extern "C" void kmsg_store(const char* text, uint32_t len) {
+    if (!text || len == 0u) {
+        return;
+    }
+
+    if (len > KMSG_TEXT_MAX) {
+        len = KMSG_TEXT_MAX;
+    }
+
+    if (kernel::unlikely(panic_in_progress())) {
+        console_write_emergency(text, len);
+        return;
+    }
+
+    if (kernel::likely(__atomic_load_n(&g_flusher_live, __ATOMIC_ACQUIRE) != 0u)) {
+        /* A resched IPI can migrate the task, so the CPU index is only read with interrupts off. */
+        const uint32_t flags = irq_save();
+        const uint32_t staged = stage(static_cast<uint32_t>(hal_cpu_index()), text, len);
+        irq_restore(flags);
+
+        if (kernel::unlikely(staged >= k_stage_wake)) {
+            kick_flusher((flags & 0x200u) != 0u);
+        }
+        return;
+    }
+
+    kernel::SpinLockNativeSafeGuard guard(g_boot_lock);
+
+    (void)stage(k_boot_stage, text, len);
+    pump_console();
+}
+
+extern "C" void kmsg_tick(void) {
+    if (kernel::unlikely(__atomic_load_n(&g_flush_deferred, __ATOMIC_RELAXED) != 0u)
+        && __atomic_exchange_n(&g_flush_deferred, 0u, __ATOMIC_ACQ_REL) != 0u) {
+        sem_signal(&g_flush_sem);
+    }
+}
+
+extern "C" void kmsg_start_flusher(void) {
+    sem_init(&g_flush_sem, 0);
+
+    if (!proc_spawn_kthread("kmsg", PRIO_HIGH, kmsg_flusher_task, 0)) {
+        kernel::output::kprintf("kmsg: flusher spawn failed, console output stays synchronous\n");
+    }
+}
+
+extern "C" void kmsg_flush_emergency(void) {
+    char text[KMSG_TEXT_MAX];
+
+    /* Other CPUs are stopped or about to be; whoever held g_log_lock is not coming back. */
+    collect();
+
+    for (;;) {
+        const int n = next_console_record(text);
+        if (n < 0) {
+            return;
+        }
+
+        console_write_emergency(text, static_cast<size_t>(n));
+    }
+}
+
+extern "C" void kmsg_reader_init(kmsg_reader_t* r) {
+    if (!r) {
+        return;
+    }
+
+    memset(r, 0, sizeof(*r));
+    r->line_start = 1u;
+}
+
+extern "C" uint32_t kmsg_read(kmsg_reader_t* r, char* buf, uint32_t size) {
+    if (!r || !buf) {
+        return 0;
+    }
+
+    char line[k_prefix_max + KMSG_TEXT_MAX];
+
+    uint32_t done = 0;
+
+    while (done < size) {
+        uint32_t n = 0;
+        uint32_t next = 0;
+        int ends_line = 0;
+
+        {
+            kernel::SpinLockNativeSafeGuard guard(g_log_lock);
+
+            collect();
+
+            if (!r->started || static_cast<int32_t>(g_history.tail - r->pos) > 0) {
+                /* First read, or the writer lapped us: continue from the oldest record. */
+                r->pos = g_history.tail;
+                r->partial = 0u;
+                r->started = 1u;
+            }
+
+            while (r->pos != g_history.head && (g_history.at(r->pos)->flags & k_record_pad)) {
+                r->pos = g_history.next(r->pos);
+            }
+
+            if (r->pos != g_history.head) {
+                const KmsgRecord* rec = g_history.at(r->pos);
+
+                if (r->line_start) {
+                    n = format_prefix(line, rec->tsc);
+                }
+
+                memcpy(line + n, rec + 1, rec->len);
+                n += rec->len;
+
+                ends_line = rec->len != 0u && reinterpret_cast<const char*>(rec + 1)[rec->len - 1u] == '\n';
+                next = g_history.next(r->pos);
+            }
+        }
+
+        if (n == 0u) {
+            break;
+        }
+
+        uint32_t chunk = n - r->partial;
+        if (chunk > size - done) {
+            chunk = size - done;
+        }
+
+        memcpy(buf + done, line + r->partial, chunk);
+        done += chunk;
+
+        if (r->partial + chunk < n) {
+            r->partial += chunk;
+            break;
+        }
+
+        r->pos = next;
+        r->partial = 0u;
+        r->line_start = ends_line ? 1u : 0u;
+    }
+
+    return done;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Kernel log buffer.
+ *
+ * kprintf() stores each message as a record (global sequence number, TSC
+ * timestamp, text) in the logging CPU's staging buffer without taking a lock.
+ * The "kmsg" kthread moves records into the shared history, in sequence
+ * order, and writes them to the console. Until that thread runs, and during a
+ * panic, messages are written out synchronously by the caller.
+ */
+
+/* Longest message kept; longer output is truncated. */
+#define KMSG_TEXT_MAX 512u
+
+/* Log `len` bytes of formatted text. */
+void kmsg_store(const char* text, uint32_t len);
+
+/* Spawn the flusher; kprintf() stops writing to the console itself once it runs. */
+void kmsg_start_flusher(void);
+
+/* Timer interrupt of CPU 0: deliver a flusher wake asked for with interrupts off. */
+void kmsg_tick(void);
+
+/* Push everything not yet on the console out through the emergency path. */
+void kmsg_flush_emergency(void);
+
+/* Per-open cursor into the history, for /dev/kmsg. */
+typedef struct {
+    uint32_t pos;
+    uint32_t partial;
+    uint8_t line_start;
+    uint8_t started;
+} kmsg_reader_t;
+
+void kmsg_reader_init(kmsg_reader_t* r);
+
+/*
+ * Copy the next history records, as text lines prefixed with
+ * "[seconds.micros] ", into `buf`. Returns the number of bytes written,
+ * 0 once the reader has caught up.
+ */
+uint32_t kmsg_read(kmsg_reader_t* r, char* buf, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
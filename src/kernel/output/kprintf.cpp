@@ -1,7 +1,6 @@
 #include <kernel/output/kprintf.h>
-#include <kernel/output/console.h>
+#include <kernel/output/kmsg.h>
 
-#include <lib/cpp/lock_guard.h>
 #include <lib/string.h>
 #include <lib/types.h>
 
@@ -11,26 +10,23 @@
 namespace kernel::output {
 namespace {
 
-static spinlock_t g_kprintf_lock;
-
-class ConsoleSink {
+/*
+ * Formats one message into a fixed buffer; output past the end is dropped
+ * but still counted, so kprintf() returns the full formatted length.
+ */
+class BufferSink {
 public:
-    ConsoleSink() = default;
-
-    ~ConsoleSink() {
-        flush();
-    }
+    BufferSink() = default;
 
-    ConsoleSink(const ConsoleSink&) = delete;
-    ConsoleSink& operator=(const ConsoleSink&) = delete;
+    BufferSink(const BufferSink&) = delete;
+    BufferSink& operator=(const BufferSink&) = delete;
 
-    ConsoleSink(ConsoleSink&&) = delete;
-    ConsoleSink& operator=(ConsoleSink&&) = delete;
+    BufferSink(BufferSink&&) = delete;
+    BufferSink& operator=(BufferSink&&) = delete;
 
     void putc(char c) {
-        buf_[pos_++] = c;
-        if (pos_ == sizeof(buf_)) {
-            flush();
+        if (pos_ < sizeof(buf_)) {
+            buf_[pos_++] = c;
         }
         written_++;
     }
@@ -46,19 +42,11 @@ public:
             return;
         }
 
-        size_t i = 0;
-        while (i < len) {
-            if (pos_ == sizeof(buf_)) {
-                flush();
-            }
-
-            const size_t space = sizeof(buf_) - pos_;
-            const size_t chunk = (len - i < space) ? (len - i) : space;
+        const size_t space = sizeof(buf_) - pos_;
+        const size_t chunk = (len < space) ? len : space;
 
-            memcpy(&buf_[pos_], &s[i], chunk);
-            pos_ += chunk;
-            i += chunk;
-        }
+        memcpy(&buf_[pos_], s, chunk);
+        pos_ += chunk;
 
         written_ += static_cast<int>(len);
     }
@@ -67,17 +55,16 @@ public:
         return written_;
     }
 
-private:
-    void flush() {
-        if (pos_ == 0) {
-            return;
-        }
+    const char* data() const {
+        return buf_;
+    }
 
-        console_write(buf_, pos_);
-        pos_ = 0;
+    size_t size() const {
+        return pos_;
     }
 
-    char buf_[256] = {};
+private:
+    char buf_[KMSG_TEXT_MAX];
     size_t pos_ = 0;
     int written_ = 0;
 };
@@ -301,7 +288,7 @@ static int cstr_len(const char* s) {
     return n;
 }
 
-static void emit_str(ConsoleSink& out, const Spec& s, const char* str) {
+static void emit_str(BufferSink& out, const Spec& s, const char* str) {
     if (!str) {
         str = "(null)";
     }
@@ -327,7 +314,7 @@ static void emit_str(ConsoleSink& out, const Spec& s, const char* str) {
     }
 }
 
-static void emit_char(ConsoleSink& out, const Spec& s, char c) {
+static void emit_char(BufferSink& out, const Spec& s, char c) {
     int pad = 0;
     if (s.width > 1) {
         pad = s.width - 1;
@@ -345,7 +332,7 @@ static void emit_char(ConsoleSink& out, const Spec& s, char c) {
 }
 
 static void emit_u(
-    ConsoleSink& out,
+    BufferSink& out,
     const Spec& s,
     uint64_t v,
     unsigned base,
@@ -398,7 +385,7 @@ static void emit_u(
     }
 }
 
-static void emit_i(ConsoleSink& out, const Spec& s, int64_t v) {
+static void emit_i(BufferSink& out, const Spec& s, int64_t v) {
     char sign_ch = '\0';
     uint64_t mag = 0;
 
@@ -428,15 +415,16 @@ static void emit_i(ConsoleSink& out, const Spec& s, int64_t v) {
     emit_u(out, s, mag, 10u, false, prefix, prefix_len);
 }
 
-static int kvprintf_locked(ConsoleSink& out, const char* fmt, va_list ap);
+static int kvprintf_format(BufferSink& out, const char* fmt, va_list ap);
 
 }
 
 int kvprintf(const char* fmt, va_list ap) {
-    kernel::SpinLockNativeSafeGuard guard(g_kprintf_lock);
+    BufferSink out;
+    const int n = kvprintf_format(out, fmt, ap);
 
-    ConsoleSink out;
-    return kvprintf_locked(out, fmt, ap);
+    kmsg_store(out.data(), static_cast<uint32_t>(out.size()));
+    return n;
 }
 
 int kprintf(const char* fmt, ...) {
@@ -464,7 +452,7 @@ extern "C" int kprintf(const char* fmt, ...) {
 namespace kernel::output {
 namespace {
 
-static int kvprintf_locked(ConsoleSink& out, const char* fmt, va_list ap) {
+static int kvprintf_format(BufferSink& out, const char* fmt, va_list ap) {
     if (!fmt) {
         return 0;
     }
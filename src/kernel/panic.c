@@ -3,6 +3,7 @@
 
 #include <arch/i386/idt.h>
 #include <drivers/video/fbdev.h>
+#include <kernel/output/kmsg.h>
 
 extern void smp_panic_stop_other_cpus(void);
 
@@ -46,6 +47,9 @@ void kernel_panic(const char* message, const char* file, uint32_t line, register
 
     if (__atomic_exchange_n(&g_kernel_panic_in_progress, 1, __ATOMIC_ACQ_REL) == 0) {
         smp_panic_stop_other_cpus();
+
+        /* Staged log lines would otherwise never reach the console. */
+        kmsg_flush_emergency();
     }
 
     if (!fb_ptr || fb_width == 0 || fb_height == 0 || !g_fb_mapped || !fb_kernel_can_render()) {
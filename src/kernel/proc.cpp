@@ -18,12 +18,15 @@
 #include <lib/radixtree.h>
 #include <lib/hash_map.h>
 #include <lib/string.h>
+#include <lib/div64.h>
 #include <lib/dlist.h>
 
+#include <mm/zswap.h>
 #include <mm/heap.h>
 #include <mm/pmm.h>
 #include <mm/vma.h>
 
+#include <hal/delay.h>
 #include <hal/apic.h>
 #include <hal/simd.h>
 #include <hal/cpu.h>
@@ -814,6 +817,57 @@ extern "C" void irq_return(void);
 extern "C" void idle_task_func(void*);
 extern volatile uint32_t timer_ticks;
 
+static void proc_rusage_export(const task_rusage_t* ru, yos_rusage_t* out) {
+    uint32_t sec, usec;
+
+    tsc_to_sec_usec(ru->utime_tsc, g_cpu_tsc_hz, &sec, &usec);
+    out->utime_sec = sec;
+    out->utime_usec = usec;
+
+    tsc_to_sec_usec(ru->stime_tsc, g_cpu_tsc_hz, &sec, &usec);
+    out->stime_sec = sec;
+    out->stime_usec = usec;
+
+    out->read_bytes = ru->read_bytes;
+    out->write_bytes = ru->write_bytes;
+    out->minflt = ru->minflt;
+    out->majflt = ru->majflt;
+    out->nvcsw = ru->nvcsw;
+    out->nivcsw = ru->nivcsw;
+}
+
+static void proc_rusage_add(task_rusage_t* dst, const task_rusage_t* src) {
+    dst->utime_tsc += src->utime_tsc;
+    dst->stime_tsc += src->stime_tsc;
+    dst->read_bytes += src->read_bytes;
+    dst->write_bytes += src->write_bytes;
+    dst->minflt += src->minflt;
+    dst->majflt += src->majflt;
+    dst->nvcsw += src->nvcsw;
+    dst->nivcsw += src->nivcsw;
+}
+
+int proc_getrusage(task_t* t, int who, yos_rusage_t* out) {
+    if (!t || !out) return -1;
+
+    if (who == YOS_RUSAGE_SELF) {
+        /* Bring the running task's system time up to now. */
+        if (t == proc_current()) {
+            proc_acct_charge(t, proc_acct_clock(), 0);
+        }
+
+        proc_rusage_export(&t->ru, out);
+        return 0;
+    }
+
+    if (who == YOS_RUSAGE_CHILDREN) {
+        proc_rusage_export(&t->ru_children, out);
+        return 0;
+    }
+
+    return -1;
+}
+
 uint32_t proc_list_snapshot(yos_proc_info_t* out, uint32_t cap) {
     if (!out || cap == 0) return 0;
 
@@ -848,6 +902,9 @@ uint32_t proc_list_snapshot(yos_proc_info_t* out, uint32_t cap) {
         e->mem_pages = (t->mem) ? t->mem->mem_pages : 0;
         e->term_mode = (uint32_t)t->term_mode;
         strlcpy(e->name, t->name, sizeof(e->name));
+
+        /* Read without locking: another task's counters may be mid-update. */
+        proc_rusage_export(&t->ru, &e->ru);
     }
     return count;
 }
@@ -1766,6 +1823,37 @@ extern "C" void proc_mem_retain(proc_mem_t* mem) {
     __atomic_fetch_add(&mem->refcount, 1, __ATOMIC_RELAXED);
 }
 
+/*
+ * Teardown visitor: free the frames a dying address space owns. Entries
+ * tagged 0x200 map memory owned by someone else (shared files, shm).
+ */
+static int proc_mem_free_frame(uint32_t virt, pte_t pte, void* ctx) {
+    (void)virt;
+    (void)ctx;
+
+    if ((pte & 0x200u) != 0u) {
+        return 1;
+    }
+
+    if ((pte & PTE_SUPER) != 0u) {
+        const phys_addr_t phys = pde_huge_phys(pte);
+
+        if (phys) {
+            pmm_free_pages((void*)(uintptr_t)phys, PAGING_HUGE_ORDER);
+        }
+
+        return 1;
+    }
+
+    const phys_addr_t phys = pte_phys(pte);
+
+    if ((pte & PTE_USER) != 0u && phys != 0u) {
+        pmm_free_phys(phys);
+    }
+
+    return 1;
+}
+
 extern "C" void proc_mem_release(proc_mem_t* mem) {
     if (!mem) {
         return;
@@ -1795,56 +1883,7 @@ extern "C" void proc_mem_release(proc_mem_t* mem) {
     if (mem->page_dir && mem->page_dir != kernel_page_directory) {
         paging_unregister_dir_lock(mem->page_dir);
 
-        for (int i = 0; i < 1024; i++) {
-            uint32_t pde = mem->page_dir[i];
-
-            if (!(pde & 1)) continue;
-
-            if ((kernel_page_directory[i] & ~0xFFFu) == (pde & ~0xFFFu)) {
-                continue;
-            }
-
-            if (pde & 4) {
-                if (pde & (1u << 7)) {
-                    uint32_t phys = pde & ~0x3FFFFFu;
-                    
-                    if (phys) {
-                        pmm_free_pages((void*)phys, 10);
-                    }
-                    
-                    mem->page_dir[i] = 0;
-                    
-                    continue;
-                }
-                
-                uint32_t* pt = (uint32_t*)(pde & ~0xFFF);
-
-                for (int j = 0; j < 1024; j++) {
-                    uint32_t pte = pt[j];
-
-                    if ((pte & 1u) == 0u) {
-                        continue;
-                    }
-
-                    const uint32_t phys = pte & ~0xFFFu;
-                    const uint32_t flags = pte & 0xFFFu;
-
-                    pt[j] = 0u;
-
-                    if ((flags & 0x200u) != 0u) {
-                        continue;
-                    }
-
-                    if ((flags & 4u) != 0u && phys != 0u) {
-                        pmm_free_block((void*)phys);
-                    }
-                }
-
-                pmm_free_block(pt);
-            }
-        }
-
-        pmm_free_block(mem->page_dir);
+        paging_free_directory(mem->page_dir, proc_mem_free_frame, nullptr);
         mem->page_dir = 0;
     }
 
@@ -1870,6 +1909,8 @@ static task_t* alloc_task(void) {
     spinlock_init(&t->poll_lock);
     dlist_init(&t->poll_waiters);
 
+    dlist_init(&t->pi_owned);
+
     t->pgrp_node.next = nullptr;
     t->pgrp_node.prev = nullptr;
 
@@ -2116,6 +2157,8 @@ void proc_kill(task_t* t) {
         sem_remove_task(t);
     }
 
+    futex_pi_exit(t);
+
     poll_task_cleanup(t);
 
     proc_sleep_remove(t);
@@ -2657,12 +2700,7 @@ task_t* proc_spawn_elf(const char* filename, int argc, char** argv) {
         }
     }
 
-    uint32_t start_pde_idx = proc::detail::user_elf_min_vaddr >> 22;
-    uint32_t end_pde_idx   = (max_vaddr - 1) >> 22;
-
-    for (uint32_t i = start_pde_idx; i <= end_pde_idx; i++) {
-        t->mem->page_dir[i] = 0;
-    }
+    paging_drop_pdes(t->mem->page_dir, proc::detail::user_elf_min_vaddr, max_vaddr);
 
     t->mem->prog_break = (max_vaddr + proc::detail::page_mask) & ~proc::detail::page_mask;
     t->mem->heap_start = t->mem->prog_break;
@@ -2776,6 +2814,17 @@ int proc_waitpid(uint32_t pid, int* out_status) {
         *out_status = target->exit_status;
     }
 
+    /*
+     * A joined thread of the same address space stays part of the waiter's
+     * own usage; a child process goes into its children totals.
+     */
+    if (waiter && waiter != target && target->state == TASK_ZOMBIE) {
+        task_rusage_t* dst = (target->mem && target->mem == waiter->mem) ? &waiter->ru : &waiter->ru_children;
+
+        proc_rusage_add(dst, &target->ru);
+        proc_rusage_add(&waiter->ru_children, &target->ru_children);
+    }
+
     __atomic_fetch_sub(&target->exit_waiters, 1, __ATOMIC_ACQ_REL);
 
     proc_task_put(target);
@@ -3185,6 +3234,59 @@ int proc_change_state(task_t* t, task_state_t new_state) {
     return ok ? 0 : -1;
 }
 
+extern "C" uint32_t proc_mem_snapshot(proc_mem_t** out, uint32_t cap) {
+    if (!out || cap == 0u) {
+        return 0u;
+    }
+
+    uint32_t count = 0u;
+
+    kernel::RcuReadGuard rcu_guard;
+
+    dlist_head_t* it = proc::detail::all_tasks_next_rcu(&proc::detail::all_tasks_head);
+    while (it && it != &proc::detail::all_tasks_head && count < cap) {
+        task_t* t = container_of(it, task_t, all_tasks_node);
+        it = proc::detail::all_tasks_next_rcu(it);
+
+        if (t->state == TASK_UNUSED || t->state == TASK_ZOMBIE) {
+            continue;
+        }
+
+        proc_mem_t* mem = t->mem;
+
+        if (!mem || !mem->page_dir || mem->page_dir == kernel_page_directory) {
+            continue;
+        }
+
+        bool seen = false;
+
+        for (uint32_t i = 0u; i < count; i++) {
+            if (out[i] == mem) {
+                seen = true;
+                break;
+            }
+        }
+
+        if (seen) {
+            continue;
+        }
+
+        uint32_t refs = __atomic_load_n(&mem->refcount, __ATOMIC_RELAXED);
+
+        while (refs != 0u) {
+            if (__atomic_compare_exchange_n(
+                    &mem->refcount, &refs, refs + 1u,
+                    0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+                )) {
+                out[count++] = mem;
+                break;
+            }
+        }
+    }
+
+    return count;
+}
+
 void proc_invoke_oom_killer(void) {
     task_t* victim = nullptr;
 
@@ -6,6 +6,7 @@
 
 #include <kernel/locking/rwspinlock.h>
 #include <kernel/locking/spinlock.h>
+#include <kernel/locking/mutex.h>
 #include <kernel/locking/sem.h>
 #include <kernel/smp/cpu.h>
 
@@ -73,6 +74,13 @@ typedef struct proc_mem {
 
     spinlock_t pt_lock;
 
+    /*
+     * mmap_mutex serializes the operations that change the layout (mmap,
+     * munmap, madvise, brk) and may sleep while faults drain. mmap_lock only
+     * covers the tree updates themselves. Page faults take neither.
+     */
+    mutex_t mmap_mutex;
+
     spinlock_t mmap_lock;
     maple_tree_t mmap_mt;
 
@@ -83,10 +91,19 @@ typedef struct proc_mem {
     
     uint32_t mem_pages;
 
+    /* Where the zswap scanner resumes its page-table walk. */
+    uint32_t swap_cursor;
+
     uint32_t leader_pid;
     uint32_t refcount;
 
     volatile uint32_t active_cpus;
+
+    /*
+     * Bumped by every user TLB shootdown. CPUs that skipped the IPI while
+     * lazy compare it on their way back and flush if it moved.
+     */
+    volatile uint32_t tlb_gen;
 } proc_mem_t;
 
 typedef enum {
@@ -129,6 +146,24 @@ typedef struct fd_table {
     rcu_head_t rcu;
 } fd_table_t;
 
+/*
+ * Resource usage of one task. Times are TSC cycles, converted when they
+ * leave the kernel. Only the task itself updates its counters.
+ */
+typedef struct task_rusage {
+    uint64_t utime_tsc;
+    uint64_t stime_tsc;
+
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+
+    uint32_t minflt;
+    uint32_t majflt;
+
+    uint32_t nvcsw;
+    uint32_t nivcsw;
+} task_rusage_t;
+
 typedef struct task {
     /* cacheline 1 */
 
@@ -207,6 +242,18 @@ typedef struct task {
     
     task_block_kind_t blocked_kind;
     int is_blocked_on_kbd;
+
+    /* Key of the futex a waiter is queued on; a requeue changes it. */
+    uint32_t futex_key;
+
+    /*
+     * Priority inheritance, under the futex PI lock: the priority borrowed
+     * from waiters (PRIO_IDLE if none), the PI futex this task sleeps on and
+     * the ones it owns that others are waiting for.
+     */
+    task_prio_t pi_priority;
+    void* pi_blocked_on;
+    dlist_head_t pi_owned;
     
     uint32_t wait_for_pid;
 
@@ -223,7 +270,15 @@ typedef struct task {
     
     uint8_t term_mode;
 
-    /* cacheline 8+ */
+    /* cacheline 8: charged on every kernel entry and exit */
+    uint64_t acct_tsc __cacheline_aligned;
+
+    task_rusage_t ru;
+
+    /* Children reaped by waitpid, with what they had reaped themselves. */
+    task_rusage_t ru_children;
+
+    /* cacheline 10+ */
     uint32_t start_tick __cacheline_aligned;
 
     uint32_t sid;
@@ -296,6 +351,9 @@ int proc_signal_pgrp(uint32_t pgid, uint32_t sig);
 int proc_pgrp_in_session(uint32_t pgid, uint32_t sid);
 
 int proc_waitpid(uint32_t pid, int* out_status);
+
+/* YOS_RUSAGE_SELF or YOS_RUSAGE_CHILDREN usage of `t`. */
+int proc_getrusage(task_t* t, int who, yos_rusage_t* out);
 void reaper_task_func(void* arg);
 
 task_t* proc_get_list_head();
@@ -324,12 +382,64 @@ void proc_invoke_oom_killer(void);
 void proc_mem_retain(proc_mem_t* mem);
 void proc_mem_release(proc_mem_t* mem);
 
+/*
+ * Take a reference on up to `cap` distinct live address spaces.
+ * The caller drops each one with proc_mem_release().
+ */
+uint32_t proc_mem_snapshot(proc_mem_t** out, uint32_t cap);
+
 ___inline task_t* proc_current() { 
     cpu_t* cpu = cpu_current();
     
     return cpu->current_task; 
 }
 
+/* Faults on other threads raise the count concurrently, so the drop is clamped at zero. */
+___inline void proc_mem_pages_sub(proc_mem_t* mem, uint32_t pages) {
+    uint32_t old = __atomic_load_n(&mem->mem_pages, __ATOMIC_RELAXED);
+
+    while (old != 0u) {
+        const uint32_t desired = (old > pages) ? (old - pages) : 0u;
+
+        if (__atomic_compare_exchange_n(&mem->mem_pages, &old, desired, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+}
+
+___inline uint64_t proc_acct_clock(void) {
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/*
+ * Charge the cycles since the task's last accounting point to user or
+ * system time. Called on entry from and exit to user mode and when the
+ * task is switched in or out; a zero stamp means it has not run yet.
+ */
+___inline void proc_acct_charge(task_t* t, uint64_t now, int user) {
+    const uint64_t last = t->acct_tsc;
+
+    if (last != 0u && now > last) {
+        if (user) {
+            t->ru.utime_tsc += now - last;
+        } else {
+            t->ru.stime_tsc += now - last;
+        }
+    }
+
+    t->acct_tsc = now;
+}
+
+___inline void proc_acct_fault(task_t* t, int major) {
+    if (major) {
+        t->ru.majflt++;
+    } else {
+        t->ru.minflt++;
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
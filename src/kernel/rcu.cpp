@@ -5,73 +5,306 @@
 #include <lib/cpp/atomic.h>
 #include <lib/compiler.h>
 
+#include <kernel/locking/sem.h>
+#include <kernel/init/boot.h>
 #include <kernel/workqueue.h>
 #include <kernel/smp/cpu.h>
+#include <kernel/proc.h>
+#include <kernel/sched.h>
 #include <kernel/rcu.h>
 
+#include <lib/string.h>
+
+#include <yos/rcustat.h>
+
 #include <hal/align.h>
 #include <hal/apic.h>
 
+/*
+ * Callbacks of a CPU move through three segments, always in queue order:
+ *
+ *   NEXT  cpu->rcu_queue     queued by call_rcu(), no grace period yet
+ *   WAIT  cpu->rcu_pending   waiting for the grace period started for them
+ *   DONE  RcuCpuState::done  grace period over, waiting to be invoked
+ *
+ * Grace periods are per CPU: starting one snapshots every CPU's quiescent
+ * state counter, and it is over once each CPU that was in the kernel has
+ * moved its counter. The tick checks this every RCU_CHECK_INTERVAL ticks;
+ * an expedite request makes every CPU check on its next tick, and CPUs
+ * holding callbacks get an IPI so they check right away: an idle CPU may
+ * not tick again for two seconds.
+ *
+ * DONE callbacks run in thread context: on the per-CPU "rcu" workqueue, or
+ * with the "rcu_nocbs" boot word on a dedicated "rcuo" thread per CPU that
+ * runs at user priority and invokes them in bounded batches.
+ */
+
+#define RCU_CHECK_INTERVAL 8u
+
+/* A NEXT backlog this long asks for an expedited grace period. */
+#define RCU_QLEN_HIGH 1024u
+
+/* Callbacks an offload thread runs before it gives the CPU away. */
+#define RCU_OFFLOAD_BATCH 64u
+
+struct RcuSegment {
+    rcu_head_t* head = nullptr;
+    rcu_head_t* tail = nullptr;
+
+    uint32_t count = 0;
+};
+
 struct RcuCpuState {
-    rcu_head_t* ready_list = nullptr;
+    kernel::SpinLock done_lock;
+    RcuSegment done;
+
+    uint32_t wait_count = 0;
+
+    uint32_t ticks = 0;
+    uint32_t expedite_seen = 0;
+
+    uint32_t force = 0;
+
     workqueue_t* wq = nullptr;
     work_struct_t work{};
+
+    task_t* offload_task = nullptr;
+    semaphore_t offload_sem{};
+
+    /* Written by the owning CPU, or by its invoker for `invoked`; read racily. */
+    uint32_t queued = 0;
+    uint32_t invoked = 0;
+
+    uint32_t gps = 0;
+    uint32_t gps_expedited = 0;
+    uint32_t ipis = 0;
 };
 
 __cacheline_aligned static RcuCpuState g_rcu_state[MAX_CPUS];
 
+static volatile uint32_t g_rcu_expedite_seq;
+
+static bool g_rcu_offload;
+
+___inline RcuCpuState* rcu_cpu_state(const cpu_t* cpu) {
+    if (!cpu || cpu->index < 0 || cpu->index >= MAX_CPUS) {
+        return nullptr;
+    }
+
+    return &g_rcu_state[cpu->index];
+}
+
+/* Waiters may only give the CPU away from a real task with interrupts on. */
+static bool rcu_can_block(void) {
+    uint32_t flags;
+    __asm__ volatile("pushfl\n\tpopl %0" : "=r"(flags));
+
+    cpu_t* cpu = cpu_current();
+
+    return (flags & 0x200u) != 0u
+        && cpu && cpu->current_task && cpu->current_task != cpu->idle_task;
+}
+
+static void rcu_send_ipi(int cpu_idx) {
+    lapic_write(LAPIC_ICRHI, (uint32_t)cpus[cpu_idx].id << 24);
+    lapic_write(LAPIC_ICRLO, (uint32_t)IPI_RCU_VECTOR | 0x00004000u);
+}
+
 extern "C" void call_rcu(rcu_head_t* head, void (*func)(rcu_head_t*)) {
     if (!head || !func) {
         return;
     }
 
     head->func = func;
-
-    cpu_t* cpu = cpu_current();
+    head->next = nullptr;
 
     kernel::ScopedIrqDisable irq_guard;
 
-    head->next = cpu->rcu_queue;
-    
-    if (!cpu->rcu_queue) {
-        cpu->rcu_queue_tail = head;
+    cpu_t* cpu = cpu_current();
+    RcuCpuState* state = rcu_cpu_state(cpu);
+
+    /* NEXT is FIFO so rcu_barrier() can reason with counts alone. */
+    if (cpu->rcu_queue) {
+        cpu->rcu_queue_tail->next = head;
+    } else {
+        cpu->rcu_queue = head;
     }
 
-    cpu->rcu_queue = head;
+    cpu->rcu_queue_tail = head;
 
-    __atomic_fetch_add(&cpu->rcu_qlen, 1u, __ATOMIC_RELAXED);
+    const uint32_t qlen = cpu->rcu_qlen + 1u;
+    __atomic_store_n(&cpu->rcu_qlen, qlen, __ATOMIC_RELAXED);
+
+    if (state) {
+        __atomic_store_n(&state->queued, state->queued + 1u, __ATOMIC_RELEASE);
+
+        if (kernel::unlikely(qlen == RCU_QLEN_HIGH)) {
+            state->force = 1u;
+        }
+    }
 }
 
-___inline void rcu_invoke_callbacks(rcu_head_t* list) {
+static void rcu_invoke_callbacks(RcuCpuState& state, rcu_head_t* list) {
     while (list) {
         rcu_head_t* next = list->next;
 
         void (*f)(rcu_head_t*) = list->func;
 
         if (next) {
-            __builtin_prefetch(next, 0, 0); 
+            __builtin_prefetch(next, 0, 0);
         }
 
         list->next = nullptr;
         list->func = nullptr;
 
         f(list);
-        
+
+        __atomic_fetch_add(&state.invoked, 1u, __ATOMIC_RELEASE);
+
         list = next;
     }
 }
 
+/* Detach up to `max` callbacks from the head of DONE; 0 takes them all. */
+static rcu_head_t* rcu_done_take(RcuCpuState& state, uint32_t max) {
+    kernel::SpinLockSafeGuard guard(state.done_lock);
+
+    rcu_head_t* list = state.done.head;
+    if (!list) {
+        return nullptr;
+    }
+
+    if (max == 0u || state.done.count <= max) {
+        state.done.head = nullptr;
+        state.done.tail = nullptr;
+        state.done.count = 0u;
+
+        return list;
+    }
+
+    rcu_head_t* last = list;
+    for (uint32_t i = 1; i < max; i++) {
+        last = last->next;
+    }
+
+    state.done.head = last->next;
+    state.done.count -= max;
+
+    last->next = nullptr;
+
+    return list;
+}
+
 static void rcu_execute_callbacks_work(work_struct_t* work) {
     RcuCpuState* state = container_of(work, RcuCpuState, work);
-    
-    rcu_head_t* list = __atomic_exchange_n(&state->ready_list, nullptr, __ATOMIC_ACQ_REL);
+
+    rcu_head_t* list = rcu_done_take(*state, 0u);
 
     if (list) {
-        rcu_invoke_callbacks(list);
+        rcu_invoke_callbacks(*state, list);
+    }
+}
+
+static void rcu_offload_task(void* arg) {
+    RcuCpuState* state = (RcuCpuState*)arg;
+
+    for (;;) {
+        sem_wait(&state->offload_sem);
+
+        /* A flood is worked off in slices so it cannot monopolise the CPU. */
+        while (rcu_head_t* list = rcu_done_take(*state, RCU_OFFLOAD_BATCH)) {
+            rcu_invoke_callbacks(*state, list);
+
+            sched_yield();
+        }
+    }
+}
+
+static void rcu_kick_invoker(RcuCpuState& state) {
+    if (state.offload_task) {
+        sem_signal(&state.offload_sem);
+    } else if (state.wq) {
+        queue_work(state.wq, &state.work);
     }
 }
 
-extern "C" volatile uint32_t timer_ticks;
+static void rcu_start_gp(cpu_t* cpu, RcuCpuState* state) {
+    /* Caller has interrupts off. */
+    cpu->rcu_pending = cpu->rcu_queue;
+    cpu->rcu_pending_tail = cpu->rcu_queue_tail;
+
+    if (state) {
+        state->wait_count = cpu->rcu_qlen;
+    }
+
+    cpu->rcu_queue = nullptr;
+    cpu->rcu_queue_tail = nullptr;
+    cpu->rcu_qlen = 0u;
+
+    cpu->rcu_gp_active = true;
+
+    for (int i = 0; i < cpu_count; i++) {
+        cpu->rcu_qs_snapshot[i] = __atomic_load_n(&cpus[i].rcu_qs_count, __ATOMIC_RELAXED);
+    }
+}
+
+/* WAIT has seen its grace period: append it to DONE, keeping queue order. */
+static void rcu_complete_gp(cpu_t* cpu, RcuCpuState* state, bool forced) {
+    rcu_head_t* ready_list = nullptr;
+    rcu_head_t* ready_tail = nullptr;
+
+    uint32_t ready_count = 0u;
+
+    {
+        kernel::ScopedIrqDisable irq_guard;
+
+        if (!cpu->rcu_gp_active) {
+            return;
+        }
+
+        ready_list = cpu->rcu_pending;
+        ready_tail = cpu->rcu_pending_tail;
+
+        cpu->rcu_pending = nullptr;
+        cpu->rcu_pending_tail = nullptr;
+
+        cpu->rcu_gp_active = false;
+
+        if (state) {
+            ready_count = state->wait_count;
+            state->wait_count = 0u;
+        }
+    }
+
+    if (!state) {
+        return;
+    }
+
+    __atomic_fetch_add(&state->gps, 1u, __ATOMIC_RELAXED);
+
+    if (forced) {
+        __atomic_fetch_add(&state->gps_expedited, 1u, __ATOMIC_RELAXED);
+    }
+
+    if (!ready_list) {
+        return;
+    }
+
+    {
+        kernel::SpinLockSafeGuard guard(state->done_lock);
+
+        if (state->done.tail) {
+            state->done.tail->next = ready_list;
+        } else {
+            state->done.head = ready_list;
+        }
+
+        state->done.tail = ready_tail;
+        state->done.count += ready_count;
+    }
+
+    rcu_kick_invoker(*state);
+}
 
 void rcu_process_local(void) {
     cpu_t* cpu = cpu_current();
@@ -80,19 +313,32 @@ void rcu_process_local(void) {
         return;
     }
 
+    RcuCpuState* state = rcu_cpu_state(cpu);
+
     if (cpu->rcu_gp_active) {
-        if ((timer_ticks & 7) != 0) {
-            return; 
+        bool forced = false;
+
+        if (state) {
+            const uint32_t seq = __atomic_load_n(&g_rcu_expedite_seq, __ATOMIC_ACQUIRE);
+
+            if (state->force || seq != state->expedite_seen) {
+                state->force = 0u;
+                state->expedite_seen = seq;
+
+                forced = true;
+            } else if ((++state->ticks % RCU_CHECK_INTERVAL) != 0u) {
+                return;
+            }
         }
 
         bool all_passed = true;
-        
+
         for (int i = 0; i < cpu_count; i++) {
-            
+
             if (cpus[i].id == -1 || &cpus[i] == cpu) {
                 continue;
             }
-            
+
             if (__atomic_load_n(&cpus[i].in_kernel, __ATOMIC_ACQUIRE) == 0u) {
                 continue;
             }
@@ -100,49 +346,21 @@ void rcu_process_local(void) {
             uint32_t current_qs = __atomic_load_n(&cpus[i].rcu_qs_count, __ATOMIC_ACQUIRE);
 
             if (current_qs != cpu->rcu_qs_snapshot[i]) {
-                all_passed = false;
-                break;
+                continue;
             }
-        }
-
-        if (all_passed) {
-            rcu_head_t* ready_list = nullptr;
-            rcu_head_t* ready_tail = nullptr;
-
-            {
-                kernel::ScopedIrqDisable irq_guard;
 
-                if (cpu->rcu_gp_active) {
-                    ready_list = cpu->rcu_pending;
-                    ready_tail = cpu->rcu_pending_tail;
+            all_passed = false;
 
-                    cpu->rcu_pending = nullptr;
-                    cpu->rcu_pending_tail = nullptr;
-                    
-                    cpu->rcu_gp_active = false;
-                }
+            if (!forced) {
+                break;
             }
+        }
 
-            if (ready_list) {
-                int idx = cpu->index;
-
-                if (idx >= 0 && idx < MAX_CPUS) {
-                    RcuCpuState& state = g_rcu_state[idx];
-                    
-                    rcu_head_t* old_head = __atomic_load_n(&state.ready_list, __ATOMIC_RELAXED);
-
-                    do {
-                        ready_tail->next = old_head;
-                    } while (!__atomic_compare_exchange_n(
-                        &state.ready_list, &old_head, ready_list, 
-                        true, __ATOMIC_RELEASE, __ATOMIC_RELAXED
-                    ));
-                    
-                    if (state.wq) {
-                        queue_work(state.wq, &state.work);
-                    }
-                }
-            }
+        if (all_passed) {
+            rcu_complete_gp(cpu, state, forced);
+        } else if (forced && state) {
+            /* Stay in a hurry until this grace period is over. */
+            state->force = 1u;
         }
     }
 
@@ -150,29 +368,63 @@ void rcu_process_local(void) {
         kernel::ScopedIrqDisable irq_guard;
 
         if (cpu->rcu_queue) {
-            cpu->rcu_pending = cpu->rcu_queue;
-            cpu->rcu_pending_tail = cpu->rcu_queue_tail;
-            
-            cpu->rcu_queue = nullptr;
-            cpu->rcu_queue_tail = nullptr;
-            cpu->rcu_qlen = 0u;
+            rcu_start_gp(cpu, state);
+        }
+    }
+}
+
+extern "C" void rcu_ipi_handler(int from_user) {
+    cpu_t* cpu = cpu_current();
 
-            cpu->rcu_gp_active = true;
+    /* Only user space and the idle loop are known to hold no read-side section. */
+    if (from_user || (cpu && cpu->current_task == cpu->idle_task)) {
+        rcu_qs_count_inc();
+    }
 
-            for (int i = 0; i < cpu_count; i++) {
-                cpu->rcu_qs_snapshot[i] = __atomic_load_n(&cpus[i].rcu_qs_count, __ATOMIC_RELAXED);
-            }
+    RcuCpuState* state = rcu_cpu_state(cpu);
+    if (state) {
+        __atomic_fetch_add(&state->ipis, 1u, __ATOMIC_RELAXED);
+    }
+
+    rcu_process_local();
+}
+
+/*
+ * Ask every CPU to check its grace period on its next tick, and interrupt
+ * the ones whose next tick may be far away so they do it right now.
+ */
+static void rcu_expedite(void) {
+    __atomic_fetch_add(&g_rcu_expedite_seq, 1u, __ATOMIC_RELEASE);
+
+    cpu_t* me = cpu_current();
+
+    for (int i = 0; i < cpu_count; i++) {
+        if (cpus[i].id == -1 || &cpus[i] == me || !cpus[i].started) {
+            continue;
         }
+
+        if (!cpus[i].rcu_gp_active && !cpus[i].rcu_queue) {
+            continue;
+        }
+
+        rcu_send_ipi(i);
     }
 }
 
-extern "C" void synchronize_rcu(void) {
+/*
+ * Wait until every CPU that was in the kernel has passed a quiescent state.
+ * With `expedite` the busy ones are interrupted and the caller spins;
+ * otherwise it yields the CPU between checks and lets them get there alone.
+ */
+static void rcu_wait_for_gp(bool expedite) {
     const int n = cpu_count;
     uint32_t* snap = (uint32_t*)__builtin_alloca(sizeof(uint32_t) * n);
     uint8_t* need_wait = (uint8_t*)__builtin_alloca(sizeof(uint8_t) * n);
 
     cpu_t* me = cpu_current();
 
+    const bool can_yield = !expedite && rcu_can_block();
+
     for (int i = 0; i < n; i++) {
         need_wait[i] = 0u;
 
@@ -188,8 +440,9 @@ extern "C" void synchronize_rcu(void) {
 
         need_wait[i] = 1u;
 
-        lapic_write(LAPIC_ICRHI, (uint32_t)cpus[i].id << 24);
-        lapic_write(LAPIC_ICRLO, (uint32_t)IPI_RCU_VECTOR | 0x00004000u);
+        if (expedite) {
+            rcu_send_ipi(i);
+        }
     }
 
     for (int i = 0; i < n; i++) {
@@ -198,17 +451,106 @@ extern "C" void synchronize_rcu(void) {
         }
 
         while (__atomic_load_n(&cpus[i].rcu_qs_count, __ATOMIC_RELAXED) == snap[i]) {
-            rcu_qs_count_inc();
+            if (__atomic_load_n(&cpus[i].in_kernel, __ATOMIC_ACQUIRE) == 0u) {
+                break;
+            }
 
-            __asm__ volatile("pause" ::: "memory");
+            if (can_yield) {
+                sched_yield();
+            } else {
+                rcu_qs_count_inc();
+
+                __asm__ volatile("pause" ::: "memory");
+            }
         }
     }
 }
 
+extern "C" void synchronize_rcu(void) {
+    rcu_wait_for_gp(false);
+}
+
+extern "C" void synchronize_rcu_expedited(void) {
+    rcu_wait_for_gp(true);
+}
+
+extern "C" void rcu_barrier(void) {
+    const int n = cpu_count;
+    uint32_t* target = (uint32_t*)__builtin_alloca(sizeof(uint32_t) * n);
+
+    for (int i = 0; i < n; i++) {
+        target[i] = __atomic_load_n(&g_rcu_state[i].queued, __ATOMIC_ACQUIRE);
+    }
+
+    const bool can_yield = rcu_can_block();
+
+    /* Queues are FIFO, so once `invoked` reaches the snapshot every earlier callback ran. */
+    for (int i = 0; i < n; i++) {
+        while ((int32_t)(__atomic_load_n(&g_rcu_state[i].invoked, __ATOMIC_ACQUIRE) - target[i]) < 0) {
+            rcu_expedite();
+
+            if (can_yield) {
+                /* One expedite round per tick is plenty. */
+                proc_usleep(1000u);
+            } else {
+                rcu_qs_count_inc();
+                rcu_process_local();
+
+                __asm__ volatile("pause" ::: "memory");
+            }
+        }
+    }
+}
+
+extern "C" uint32_t rcu_read_stats(uint32_t first, yos_rcu_cpu_stats_t* out, uint32_t max) {
+    if (!out) {
+        return 0;
+    }
+
+    uint32_t n = 0;
+
+    for (uint32_t i = first; i < (uint32_t)cpu_count && n < max; i++) {
+        const RcuCpuState& s = g_rcu_state[i];
+        yos_rcu_cpu_stats_t* o = &out[n++];
+
+        memset(o, 0, sizeof(*o));
+
+        o->cpu = i;
+        o->queued = __atomic_load_n(&s.queued, __ATOMIC_RELAXED);
+        o->invoked = __atomic_load_n(&s.invoked, __ATOMIC_RELAXED);
+
+        o->next = __atomic_load_n(&cpus[i].rcu_qlen, __ATOMIC_RELAXED);
+        o->wait = __atomic_load_n(&s.wait_count, __ATOMIC_RELAXED);
+        o->done = __atomic_load_n(&s.done.count, __ATOMIC_RELAXED);
+
+        o->gps = __atomic_load_n(&s.gps, __ATOMIC_RELAXED);
+        o->gps_expedited = __atomic_load_n(&s.gps_expedited, __ATOMIC_RELAXED);
+        o->ipis = __atomic_load_n(&s.ipis, __ATOMIC_RELAXED);
+
+        o->offloaded = s.offload_task ? 1u : 0u;
+    }
+
+    return n;
+}
+
 extern "C" void rcu_init_workers(void) {
+    g_rcu_offload = boot_cmdline_has("rcu_nocbs") != 0;
+
     for (int i = 0; i < cpu_count; i++) {
-        g_rcu_state[i].wq = create_workqueue("rcu");
+        RcuCpuState& state = g_rcu_state[i];
+
+        init_work(&state.work, rcu_execute_callbacks_work);
+
+        if (g_rcu_offload) {
+            sem_init(&state.offload_sem, 0);
+
+            state.offload_task = proc_spawn_kthread("rcuo", PRIO_USER, rcu_offload_task, &state);
 
-        init_work(&g_rcu_state[i].work, rcu_execute_callbacks_work);
+            if (state.offload_task) {
+                continue;
+            }
+        }
+
+        state.wq = create_workqueue("rcu");
     }
-}
\ No newline at end of file
+}
@@ -25,14 +25,24 @@ typedef struct rcu_head {
     void (*func)(struct rcu_head*);
 } rcu_head_t;
 
+/* Wait for a grace period, yielding the CPU while other CPUs get there. */
 void synchronize_rcu(void);
 
+/* Same, but interrupt busy CPUs and spin: for latency-sensitive updaters. */
+void synchronize_rcu_expedited(void);
+
+/* Wait until every callback queued before the call has been invoked. */
+void rcu_barrier(void);
+
 void rcu_init_workers(void);
 
 void call_rcu(rcu_head_t* head, void (*func)(rcu_head_t*));
 
 void rcu_process_local(void);
 
+/* IPI_RCU_VECTOR: report a quiescent state if that is safe, then check our grace period. */
+void rcu_ipi_handler(int from_user);
+
 ___inline void rcu_ptr_init(rcu_ptr_t* r) {
     WRITE_ONCE(r->ptr, NULL);
 }
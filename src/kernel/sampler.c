@@ -0,0 +1,316 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#include <kernel/locking/spinlock.h>
+#include <kernel/sampler.h>
+#include <kernel/proc.h>
+
+#include <lib/compiler.h>
+#include <lib/string.h>
+
+#include <hal/align.h>
+#include <hal/apic.h>
+
+#include <mm/heap.h>
+
+/* Per-CPU buffer size in samples; a power of two. */
+#define SAMPLER_RING_SAMPLES 512u
+#define SAMPLER_RING_MASK    (SAMPLER_RING_SAMPLES - 1u)
+
+/* How far up the kernel stack a backtrace looks for return addresses. */
+#define SAMPLER_SCAN_WORDS 256u
+
+extern volatile uint32_t timer_ticks;
+
+extern char __text_start[];
+extern char __text_end[];
+
+/*
+ * Single-producer ring: only the owning CPU's timer interrupt advances
+ * `head`; readers advance `tail` under g_read_lock.
+ */
+typedef struct {
+    volatile uint32_t head __cacheline_aligned;
+
+    uint32_t next_tick;
+
+    uint32_t recorded;
+    uint32_t dropped;
+
+    volatile uint32_t tail __cacheline_aligned;
+
+    yos_prof_sample_t* slots;
+} sampler_ring_t;
+
+static sampler_ring_t g_rings[MAX_CPUS];
+
+static volatile uint32_t g_active;
+static uint32_t g_hz;
+static uint32_t g_period_ticks = 1u;
+
+static uint32_t g_base_recorded;
+static uint32_t g_base_dropped;
+
+/* Serializes readers against each other and against start. Never taken from interrupts. */
+static spinlock_t g_read_lock;
+
+static uint32_t g_read_cursor;
+
+___inline int in_kernel_text(uint32_t addr) {
+    return addr >= (uint32_t)__text_start && addr < (uint32_t)__text_end;
+}
+
+/*
+ * Stack scanning finds stale pointers as well as live return addresses.
+ * Only keep values that directly follow a call instruction: call rel32
+ * (E8) or an indirect call through FF /2 with a 0, 1 or 4 byte operand.
+ */
+static int looks_like_return(uint32_t addr) {
+    if (!in_kernel_text(addr) || addr - 6u < (uint32_t)__text_start) {
+        return 0;
+    }
+
+    const uint8_t* p = (const uint8_t*)addr;
+
+    if (p[-5] == 0xE8u) {
+        return 1;
+    }
+
+    if (p[-2] == 0xFFu && ((p[-1] >> 3) & 7u) == 2u) {
+        return 1;
+    }
+
+    if (p[-3] == 0xFFu && ((p[-2] >> 3) & 7u) == 2u) {
+        return 1;
+    }
+
+    if (p[-6] == 0xFFu && ((p[-5] >> 3) & 7u) == 2u) {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * The kernel is built without frame pointers, so a backtrace is the list of
+ * plausible return addresses between the interrupted stack pointer and the
+ * top of the task's kernel stack.
+ */
+static uint32_t scan_kernel_stack(const registers_t* regs, const task_t* t, uint32_t* ips, uint32_t max) {
+    if (!t || !t->kstack || t->kstack_size == 0u || max == 0u) {
+        return 0;
+    }
+
+    /* No privilege change: the CPU did not push esp, so the frame ends where the old stack begins. */
+    const uint32_t sp = (uint32_t)(uintptr_t)&regs->useresp;
+
+    const uint32_t lo = (uint32_t)(uintptr_t)t->kstack;
+    const uint32_t hi = lo + t->kstack_size;
+
+    if (sp < lo || sp >= hi) {
+        return 0;
+    }
+
+    const uint32_t* w = (const uint32_t*)(uintptr_t)sp;
+    const uint32_t* end = (const uint32_t*)(uintptr_t)(hi & ~3u);
+
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < SAMPLER_SCAN_WORDS && w < end && n < max; i++, w++) {
+        if (looks_like_return(*w)) {
+            ips[n++] = *w;
+        }
+    }
+
+    return n;
+}
+
+void sampler_tick(registers_t* regs, cpu_t* cpu) {
+    if (likely(!__atomic_load_n(&g_active, __ATOMIC_RELAXED))) {
+        return;
+    }
+
+    if (unlikely(!regs || !cpu || cpu->index < 0 || cpu->index >= MAX_CPUS)) {
+        return;
+    }
+
+    sampler_ring_t* ring = &g_rings[cpu->index];
+
+    yos_prof_sample_t* slots = __atomic_load_n(&ring->slots, __ATOMIC_ACQUIRE);
+    if (unlikely(!slots)) {
+        return;
+    }
+
+    const uint32_t now = timer_ticks;
+
+    if ((int32_t)(now - ring->next_tick) < 0) {
+        return;
+    }
+
+    ring->next_tick = now + g_period_ticks;
+
+    const uint32_t head = ring->head;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= SAMPLER_RING_SAMPLES) {
+        ring->dropped++;
+        return;
+    }
+
+    yos_prof_sample_t* s = &slots[head & SAMPLER_RING_MASK];
+
+    task_t* t = cpu->current_task;
+
+    s->pid = t ? t->pid : 0u;
+    s->cpu = (uint16_t)cpu->index;
+    s->flags = 0u;
+
+    memset(s->comm, 0, sizeof(s->comm));
+
+    if (t) {
+        strlcpy(s->comm, t->name, sizeof(s->comm));
+    }
+
+    s->ip[0] = regs->eip;
+    s->depth = 1u;
+
+    if ((regs->cs & 3u) == 3u) {
+        s->flags |= YOS_PROF_SAMPLE_USER;
+    } else if (t && t == cpu->idle_task) {
+        s->flags |= YOS_PROF_SAMPLE_IDLE;
+    } else {
+        uint32_t callers[YOS_PROF_MAX_DEPTH - 1u];
+        const uint32_t n = scan_kernel_stack(regs, t, callers, YOS_PROF_MAX_DEPTH - 1u);
+
+        for (uint32_t i = 0; i < n; i++) {
+            s->ip[1u + i] = callers[i];
+        }
+
+        s->depth += n;
+    }
+
+    __atomic_store_n(&ring->head, head + 1u, __ATOMIC_RELEASE);
+
+    ring->recorded++;
+}
+
+uint32_t sampler_clamp_ticks(uint32_t ticks) {
+    if (likely(!__atomic_load_n(&g_active, __ATOMIC_RELAXED))) {
+        return ticks;
+    }
+
+    return ticks > g_period_ticks ? g_period_ticks : ticks;
+}
+
+static int sampler_alloc_rings(void) {
+    for (int i = 0; i < cpu_count && i < MAX_CPUS; i++) {
+        if (g_rings[i].slots) {
+            continue;
+        }
+
+        yos_prof_sample_t* slots = (yos_prof_sample_t*)kzalloc(SAMPLER_RING_SAMPLES * sizeof(yos_prof_sample_t));
+        if (!slots) {
+            return -1;
+        }
+
+        __atomic_store_n(&g_rings[i].slots, slots, __ATOMIC_RELEASE);
+    }
+
+    return 0;
+}
+
+int sampler_start(uint32_t hz) {
+    if (hz == 0u || hz > KERNEL_TIMER_HZ) {
+        hz = KERNEL_TIMER_HZ;
+    }
+
+    if (sampler_alloc_rings() != 0) {
+        return -1;
+    }
+
+    uint32_t flags = spinlock_acquire_safe(&g_read_lock);
+
+    __atomic_store_n(&g_active, 0u, __ATOMIC_RELEASE);
+
+    g_hz = hz;
+    g_period_ticks = KERNEL_TIMER_HZ / hz;
+
+    uint32_t recorded = 0u;
+    uint32_t dropped = 0u;
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        sampler_ring_t* ring = &g_rings[i];
+
+        /* Discard leftovers from the consumer side; producers only touch head. */
+        __atomic_store_n(&ring->tail, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+
+        recorded += ring->recorded;
+        dropped += ring->dropped;
+    }
+
+    g_base_recorded = recorded;
+    g_base_dropped = dropped;
+
+    __atomic_store_n(&g_active, 1u, __ATOMIC_RELEASE);
+
+    spinlock_release_safe(&g_read_lock, flags);
+
+    return 0;
+}
+
+void sampler_stop(void) {
+    __atomic_store_n(&g_active, 0u, __ATOMIC_RELEASE);
+}
+
+void sampler_get_stats(yos_prof_stats_t* out) {
+    if (!out) {
+        return;
+    }
+
+    uint32_t recorded = 0u;
+    uint32_t dropped = 0u;
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        recorded += __atomic_load_n(&g_rings[i].recorded, __ATOMIC_RELAXED);
+        dropped += __atomic_load_n(&g_rings[i].dropped, __ATOMIC_RELAXED);
+    }
+
+    out->active = __atomic_load_n(&g_active, __ATOMIC_RELAXED);
+    out->hz = g_hz;
+    out->samples = recorded - g_base_recorded;
+    out->dropped = dropped - g_base_dropped;
+}
+
+uint32_t sampler_read(yos_prof_sample_t* out, uint32_t max) {
+    if (!out || max == 0u) {
+        return 0;
+    }
+
+    uint32_t n = 0;
+
+    uint32_t flags = spinlock_acquire_safe(&g_read_lock);
+
+    /* Rotate the starting CPU so one busy CPU cannot starve the others. */
+    for (uint32_t k = 0; k < MAX_CPUS && n < max; k++) {
+        sampler_ring_t* ring = &g_rings[(g_read_cursor + k) % MAX_CPUS];
+
+        if (!ring->slots) {
+            continue;
+        }
+
+        uint32_t tail = ring->tail;
+        const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        while (tail != head && n < max) {
+            out[n++] = ring->slots[tail & SAMPLER_RING_MASK];
+            tail++;
+        }
+
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    g_read_cursor = (g_read_cursor + 1u) % MAX_CPUS;
+
+    spinlock_release_safe(&g_read_lock, flags);
+
+    return n;
+}
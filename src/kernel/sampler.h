@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef KERNEL_SAMPLER_H
+#define KERNEL_SAMPLER_H
+
+#include <kernel/smp/cpu.h>
+
+#include <arch/i386/idt.h>
+
+#include <yos/prof.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Statistical sampling profiler.
+ *
+ * Unlike the -finstrument-functions profiler (profiler.cpp), this one is
+ * always built in and costs one flag test per timer tick while off. When on,
+ * each CPU records the interrupted EIP plus a kernel stack backtrace (or the
+ * user EIP) into its own single-producer ring; /dev/prof drains them.
+ */
+
+/* Called from the local timer interrupt with the interrupted frame. */
+void sampler_tick(registers_t* regs, cpu_t* cpu);
+
+/*
+ * Clamp a one-shot timer delay so a tickless CPU still wakes up once per
+ * sampling period while the profiler runs.
+ */
+uint32_t sampler_clamp_ticks(uint32_t ticks);
+
+/* Start sampling at `hz` (clamped to the timer rate), dropping old samples. */
+int sampler_start(uint32_t hz);
+
+void sampler_stop(void);
+
+void sampler_get_stats(yos_prof_stats_t* out);
+
+/* Move up to `max` recorded samples into `out`. Returns the number moved. */
+uint32_t sampler_read(yos_prof_sample_t* out, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
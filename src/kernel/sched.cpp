@@ -14,6 +14,7 @@
 
 #include <kernel/smp/cpu.h>
 #include <kernel/panic.h>
+#include <kernel/trace.h>
 
 #include <lib/compiler.h>
 #include <lib/rbtree.h>
@@ -245,10 +246,12 @@ void sched_add(task_t* t) {
         return;
     }
 
+    const task_prio_t prio = sched_task_prio(t);
+
     uint32_t base_quantum;
-    if (t->priority >= PRIO_GUI) {
+    if (prio >= PRIO_GUI) {
         base_quantum = 8;
-    } else if (t->priority >= PRIO_USER) {
+    } else if (prio >= PRIO_USER) {
         base_quantum = 4;
     } else {
         base_quantum = 2;
@@ -282,6 +285,8 @@ void sched_add(task_t* t) {
 
     enqueue_task(target, t);
 
+    trace_event(YOS_TRACE_SCHED_WAKEUP, t->pid, target_cpu_idx, 0u, 0u);
+
     g_cpu_cache.store(cpu_cache_invalid, kernel::memory_order::relaxed);
 
     if (target->current_task && target->current_task->pid != 0) {
@@ -378,8 +383,22 @@ void sched_set_current(task_t* t) {
     uint32_t cpu_bit = 1u << cpu->index;
 
     if (next_mem == nullptr) {
+        /*
+         * Kernel threads run on whatever address space is loaded. Go lazy so
+         * shootdowns for it stop interrupting this CPU; only the first switch
+         * away from a user task may sample the generation.
+         */
+        if (cpu->active_mem && !cpu->tlb_lazy) {
+            cpu->tlb_gen_seen = __atomic_load_n(&cpu->active_mem->tlb_gen, __ATOMIC_ACQUIRE);
+
+            __atomic_store_n(&cpu->tlb_lazy, 1u, __ATOMIC_SEQ_CST);
+        }
+
         return;
     } else {
+        /* Pairs with the generation bump in the shootdown path. */
+        const bool was_lazy = __atomic_exchange_n(&cpu->tlb_lazy, 0u, __ATOMIC_SEQ_CST) != 0u;
+
         if (cpu->active_mem != next_mem) {
             proc_mem_retain(next_mem);
 
@@ -402,6 +421,9 @@ void sched_set_current(task_t* t) {
             if ((active & cpu_bit) == 0u) {
                 __atomic_fetch_or(&next_mem->active_cpus, cpu_bit, __ATOMIC_RELEASE);
 
+                paging_switch(next_mem->page_dir);
+            } else if (was_lazy && __atomic_load_n(&next_mem->tlb_gen, __ATOMIC_SEQ_CST) != cpu->tlb_gen_seen) {
+                /* Shootdowns were skipped while lazy: drop the whole user TLB. */
                 paging_switch(next_mem->page_dir);
             }
         }
@@ -448,6 +470,9 @@ void sched_yield(void) {
     
     const bool irq_was_enabled = (irq_flags & 0x200u) != 0u;
 
+    /* A task that is no longer runnable is giving the CPU up itself. */
+    const bool voluntary = prev && prev->state != TASK_RUNNING && prev->state != TASK_RUNNABLE;
+
     if (kernel::likely(prev && prev != me->idle_task && prev->pid != 0)) {
         if (prev->state == TASK_RUNNING || prev->state == TASK_RUNNABLE) {
             prev->state = TASK_RUNNABLE;
@@ -455,7 +480,7 @@ void sched_yield(void) {
             if (prev->exec_start > 0) {
                 uint64_t delta_exec = me->sched_ticks - prev->exec_start;
                 if (delta_exec > 0) {
-                    uint64_t delta_vruntime = calc_delta_vruntime(delta_exec, prev->priority);
+                    uint64_t delta_vruntime = calc_delta_vruntime(delta_exec, sched_task_prio(prev));
                     prev->vruntime += delta_vruntime;
                 }
             }
@@ -532,6 +557,22 @@ void sched_yield(void) {
         }
 
         next->exec_start = me->sched_ticks;
+
+        const uint64_t now = proc_acct_clock();
+
+        if (kernel::likely(prev)) {
+            proc_acct_charge(prev, now, 0);
+
+            if (voluntary) {
+                prev->ru.nvcsw++;
+            } else {
+                prev->ru.nivcsw++;
+            }
+        }
+
+        next->acct_tsc = now;
+
+        trace_event(YOS_TRACE_SCHED_SWITCH, prev ? prev->pid : 0u, next->pid, prev ? static_cast<uint32_t>(prev->state) : 0u, 0u);
         
         sched_set_current(next);
         fpu_set_ts();
@@ -581,4 +622,42 @@ void sched_remove(task_t* t) {
 
         g_cpu_cache.store(cpu_cache_invalid, kernel::memory_order::relaxed);
     }
-}
\ No newline at end of file
+}
+
+void sched_set_pi_boost(task_t* t, task_prio_t prio, uint64_t vruntime) {
+    if (kernel::unlikely(!t || t->pid == 0)) {
+        return;
+    }
+
+    const int cpu_idx = t->assigned_cpu;
+    if (cpu_idx < 0 || cpu_idx >= MAX_CPUS) {
+        t->pi_priority = prio;
+        return;
+    }
+
+    cpu_t* target = &cpus[cpu_idx];
+
+    kernel::SpinLockNativeSafeGuard guard(target->lock);
+
+    t->pi_priority = prio;
+
+    /*
+     * The weight only changes how fast vruntime grows from here on. A queued
+     * owner also has to get a CPU before the waiters it keeps off theirs.
+     */
+    if (prio <= t->priority || !t->is_queued || t->vruntime <= vruntime) {
+        return;
+    }
+
+    dequeue_task(target, t);
+    t->vruntime = vruntime;
+    enqueue_task(target, t);
+
+    if (target->current_task && target->current_task->pid != 0) {
+        if (t->vruntime < target->current_task->vruntime) {
+            if (target->id != cpu_current()->id) {
+                sched_resched_cpu(target);
+            }
+        }
+    }
+}
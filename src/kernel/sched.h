@@ -28,6 +28,18 @@ void sched_resched_cpu(cpu_t* target);
 
 uint64_t calc_delta_vruntime(uint64_t delta_exec, task_prio_t prio);
 
+/* The priority `t` runs with: its own, or a higher one lent by PI futex waiters. */
+___inline task_prio_t sched_task_prio(const task_t* t) {
+    return t->pi_priority > t->priority ? t->pi_priority : t->priority;
+}
+
+/*
+ * Lend `t` priority `prio` (PRIO_IDLE takes the loan back) and, while it
+ * waits for a CPU, move it up to no later than `vruntime`. The caller keeps
+ * `t` from going away.
+ */
+void sched_set_pi_boost(task_t* t, task_prio_t prio, uint64_t vruntime);
+
 #ifdef __cplusplus
 }
 #endif
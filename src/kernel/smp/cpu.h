@@ -71,6 +71,14 @@ typedef struct {
 
     struct proc_mem* active_mem;
 
+    /*
+     * Set while a kernel thread or idle runs on top of active_mem: remote
+     * shootdowns for it skip this CPU, which catches up through tlb_gen_seen
+     * when it switches back to a user task.
+     */
+    volatile uint32_t tlb_lazy;
+    uint32_t tlb_gen_seen;
+
     volatile uint32_t runq_count;
     volatile uint32_t load_percent;
     
@@ -5,12 +5,14 @@
 #include <arch/i386/gdt.h>
 #include <arch/i386/idt.h>
 
+#include <hal/delay.h>
 #include <hal/simd.h>
 #include <hal/apic.h>
 #include <hal/io.h>
 
 #include <kernel/locking/spinlock.h>
 #include <kernel/sched.h>
+#include <kernel/rcu.h>
 
 #include <mm/heap.h>
 #include <mm/pmm.h>
@@ -19,6 +21,8 @@
 
 #include <lib/string.h>
 
+#include <yos/tlbstat.h>
+
 #include "cpu.h"
 #include "mb.h"
 
@@ -43,6 +47,41 @@ typedef struct {
 static spinlock_t tlb_queue_lock = {0};
 static tlb_shootdown_req_t tlb_reqs[TLB_REQ_COUNT];
 
+enum {
+    TLB_STAT_SHOOTDOWNS,
+    TLB_STAT_IPIS,
+    TLB_STAT_LAZY_SKIPS,
+    TLB_STAT_LOCAL_ONLY,
+    TLB_STAT_SLOT_WAITS,
+    TLB_STAT_COUNT,
+};
+
+static uint32_t tlb_stats[MAX_CPUS][TLB_STAT_COUNT];
+
+static inline void tlb_stat_add(uint32_t stat, uint32_t n) {
+    cpu_t* me = cpu_current();
+
+    if (me) {
+        __atomic_fetch_add(&tlb_stats[me->index][stat], n, __ATOMIC_RELAXED);
+    }
+}
+
+void smp_tlb_get_stats(yos_tlb_stats_t* out) {
+    uint32_t sum[TLB_STAT_COUNT] = {0};
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        for (uint32_t k = 0; k < TLB_STAT_COUNT; k++) {
+            sum[k] += __atomic_load_n(&tlb_stats[i][k], __ATOMIC_RELAXED);
+        }
+    }
+
+    out->shootdowns = sum[TLB_STAT_SHOOTDOWNS];
+    out->ipis = sum[TLB_STAT_IPIS];
+    out->lazy_skips = sum[TLB_STAT_LAZY_SKIPS];
+    out->local_only = sum[TLB_STAT_LOCAL_ONLY];
+    out->slot_waits = sum[TLB_STAT_SLOT_WAITS];
+}
+
 static inline int smp_interrupts_enabled(void) {
     uint32_t flags;
     __asm__ volatile("pushfl; popl %0" : "=r"(flags));
@@ -102,6 +141,103 @@ static inline void tlb_flush_range_local(uint32_t start, uint32_t end) {
     }
 }
 
+static void tlb_flush_all_local(void) {
+    uint32_t cr4;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
+
+    if (cr4 & 0x80u) {
+        __asm__ volatile("mov %0, %%cr4" :: "r"(cr4 & ~0x80u) : "memory"); /* Clear PGE */
+        __asm__ volatile("mov %0, %%cr4" :: "r"(cr4) : "memory");          /* Set PGE */
+        return;
+    }
+
+    uint32_t cr3;
+    __asm__ volatile("mov %%cr3, %0; mov %0, %%cr3" : "=r"(cr3) :: "memory");
+}
+
+/*
+ * Boot work. Until smp_boot_release_aps(), a started AP stays parked with
+ * interrupts off and runs the driver probes the BSP hands it, in the same
+ * context the BSP probes in: no current task, polled I/O, IRQs routed to
+ * the BSP. ap_running_count stays 0 meanwhile, so nothing is scheduled
+ * here and shootdowns stay local; each item starts from a flushed TLB.
+ */
+typedef void (*smp_boot_work_fn_t)(void* arg);
+
+typedef struct {
+    smp_boot_work_fn_t fn;
+    void* arg;
+
+    volatile int parked;
+} __cacheline_aligned smp_boot_slot_t;
+
+static smp_boot_slot_t boot_slots[MAX_CPUS];
+static volatile int boot_released = 0;
+
+static void smp_boot_work_loop(cpu_t* cpu) {
+    smp_boot_slot_t* slot = &boot_slots[cpu->index];
+
+    __atomic_store_n(&slot->parked, 1, __ATOMIC_RELEASE);
+
+    while (!__atomic_load_n(&boot_released, __ATOMIC_ACQUIRE)) {
+        smp_boot_work_fn_t fn = __atomic_load_n(&slot->fn, __ATOMIC_ACQUIRE);
+
+        if (!fn) {
+            __asm__ volatile("pause");
+            continue;
+        }
+
+        tlb_flush_all_local();
+
+        /* Grace periods started meanwhile wait for the item, like for any reader. */
+        __atomic_store_n(&cpu->in_kernel, 1u, __ATOMIC_RELEASE);
+
+        fn(slot->arg);
+
+        rcu_qs_count_inc();
+        __atomic_store_n(&cpu->in_kernel, 0u, __ATOMIC_RELEASE);
+
+        __atomic_store_n(&slot->fn, (smp_boot_work_fn_t)0, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&slot->parked, 0, __ATOMIC_RELEASE);
+
+    tlb_flush_all_local();
+}
+
+/* Hand `fn` to an idle parked AP. Returns its logical index, or -1 if none is free. */
+int smp_boot_work_submit(smp_boot_work_fn_t fn, void* arg) {
+    if (!fn || __atomic_load_n(&boot_released, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    cpu_t* me = cpu_current();
+
+    for (int i = 0; i < cpu_count; i++) {
+        smp_boot_slot_t* slot = &boot_slots[i];
+
+        if (&cpus[i] == me || !__atomic_load_n(&slot->parked, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        if (__atomic_load_n(&slot->fn, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        slot->arg = arg;
+        __atomic_store_n(&slot->fn, fn, __ATOMIC_RELEASE);
+
+        return i;
+    }
+
+    return -1;
+}
+
+/* Let parked APs into the scheduler. Every submitted item must have finished. */
+void smp_boot_release_aps(void) {
+    __atomic_store_n(&boot_released, 1, __ATOMIC_RELEASE);
+}
+
 void smp_ap_main(cpu_t* cpu_arg) {
     cpu_t* cpu = cpu_arg; 
     cpu->started = 1;
@@ -115,13 +251,7 @@ void smp_ap_main(cpu_t* cpu_arg) {
     cpu_setup_gs(cpu->index);
 
     paging_switch(kernel_page_directory);
-    paging_init_pat();
-
-    if (fb_ptr && fb_pitch && fb_height) {
-        uint32_t fb_base = (uint32_t)fb_ptr;
-        uint32_t fb_size = fb_pitch * fb_height;
-        paging_init_mtrr_wc(fb_base, fb_size);
-    }
+    paging_init_ap();
 
     cpu_enable_sysenter();
     
@@ -129,6 +259,15 @@ void smp_ap_main(cpu_t* cpu_arg) {
     lapic_timer_init(KERNEL_TIMER_HZ);
     kernel_init_simd();
 
+    smp_boot_work_loop(cpu);
+
+    /* The active framebuffer is only known once the boot probes are done. */
+    if (fb_ptr && fb_pitch && fb_height) {
+        uint32_t fb_base = (uint32_t)fb_ptr;
+        uint32_t fb_size = fb_pitch * fb_height;
+        paging_init_mtrr_wc(fb_base, fb_size);
+    }
+
     __asm__ volatile("sti");
     
     __atomic_fetch_add(&ap_running_count, 1, __ATOMIC_RELEASE);
@@ -136,10 +275,6 @@ void smp_ap_main(cpu_t* cpu_arg) {
     sched_yield();
 }
 
-static void mdulay(int ms) {
-    for (volatile int i = 0; i < ms * 10000; i++);
-}
-
 void smp_boot_aps(void) {
     uint32_t size = smp_trampoline_end - smp_trampoline_start;
     if (size > 4096) return;
@@ -150,17 +285,20 @@ void smp_boot_aps(void) {
     volatile uint32_t* tramp_code  = (volatile uint32_t*)(0x1000 + 8);
     volatile uint32_t* tramp_cr3   = (volatile uint32_t*)(0x1000 + 12);
     volatile uint32_t* tramp_arg   = (volatile uint32_t*)(0x1000 + 16);
+    volatile uint32_t* tramp_cr4   = (volatile uint32_t*)(0x1000 + 20);
 
     *tramp_code = (uint32_t)smp_ap_main;
     *tramp_cr3  = (uint32_t)kernel_page_directory;
+    *tramp_cr4  = paging_ap_cr4_bits();
 
     cpu_t* bsp = cpu_current();
 
     for (int i = 0; i < cpu_count; i++) {
         if (cpus[i].id == bsp->id) continue;
 
-        void* stack = kmalloc_a(4096);
-        *tramp_stack = (uint32_t)stack + 4096;
+        /* Deep enough for driver probes run before the AP enters the scheduler. */
+        void* stack = kmalloc_a(KSTACK_SIZE);
+        *tramp_stack = (uint32_t)stack + KSTACK_SIZE;
         
         *tramp_arg = (uint32_t)&cpus[i];
 
@@ -168,15 +306,23 @@ void smp_boot_aps(void) {
 
         lapic_write(LAPIC_ICRHI, cpus[i].id << 24);
         lapic_write(LAPIC_ICRLO, 0x00004500);
-        mdulay(10);
+        mdelay(10u);
 
         lapic_write(LAPIC_ICRHI, cpus[i].id << 24);
         lapic_write(LAPIC_ICRLO, 0x00004601);
-        mdulay(1);
+        udelay(200u);
 
         lapic_write(LAPIC_ICRHI, cpus[i].id << 24);
         lapic_write(LAPIC_ICRLO, 0x00004601);
-        mdulay(100);
+
+        /*
+         * The trampoline stack and argument are shared, so the next AP can
+         * only be woken once this one is off them. It sets `started` first
+         * thing in smp_ap_main(); give up on it after 100 ms.
+         */
+        for (uint32_t waited = 0; waited < 100000u && !cpus[i].started; waited += 10u) {
+            udelay(10u);
+        }
     }
 }
 
@@ -202,6 +348,14 @@ void smp_tlb_ipi_handler(void) {
     }
 }
 
+/*
+ * Remote CPUs that may cache translations of `page_dir`.
+ *
+ * CPUs running a kernel thread on top of this address space are lazy and
+ * are left out. The generation bump before looking at their lazy flag pairs
+ * with the exchange in sched_set_current(): either we see the CPU awake and
+ * interrupt it, or it sees the new generation and flushes on its own.
+ */
 static inline uint32_t smp_tlb_cpu_mask_for_page_dir(uint32_t* page_dir) {
     if (!page_dir) {
         return 0u;
@@ -210,7 +364,8 @@ static inline uint32_t smp_tlb_cpu_mask_for_page_dir(uint32_t* page_dir) {
     cpu_t* me = cpu_current();
     const int me_id = me ? me->id : -1;
 
-    uint32_t mask = 0u;
+    uint32_t candidates = 0u;
+    proc_mem_t* mem = 0;
 
     for (int i = 0; i < cpu_count; i++) {
         cpu_t* c = &cpus[i];
@@ -230,26 +385,88 @@ static inline uint32_t smp_tlb_cpu_mask_for_page_dir(uint32_t* page_dir) {
             continue;
         }
 
+        mem = active_mem;
+        candidates |= (1u << c->index);
+    }
+
+    if (candidates == 0u) {
+        return 0u;
+    }
+
+    __atomic_fetch_add(&mem->tlb_gen, 1u, __ATOMIC_SEQ_CST);
+
+    uint32_t mask = 0u;
+    uint32_t skipped = 0u;
+
+    for (int i = 0; i < cpu_count; i++) {
+        cpu_t* c = &cpus[i];
+
+        if ((candidates & (1u << c->index)) == 0u) {
+            continue;
+        }
+
+        if (__atomic_load_n(&c->tlb_lazy, __ATOMIC_SEQ_CST) != 0u) {
+            skipped++;
+            continue;
+        }
+
         mask |= (1u << c->index);
     }
 
+    if (skipped != 0u) {
+        tlb_stat_add(TLB_STAT_LAZY_SKIPS, skipped);
+    }
+
     return mask;
 }
 
+/*
+ * Spin until an acknowledgement mask drains. Requests aimed at this CPU are
+ * serviced meanwhile: we may be spinning with interrupts off while another
+ * sender waits on us.
+ */
+static void tlb_wait_mask(volatile uint32_t* pending) {
+    while (__atomic_load_n(pending, __ATOMIC_ACQUIRE) != 0u) {
+        smp_tlb_ipi_handler();
+
+        __asm__ volatile("pause");
+    }
+}
+
 static int tlb_alloc_request(uint32_t start, uint32_t end, uint32_t mask) {
     uint32_t flags = spinlock_acquire_safe(&tlb_queue_lock);
 
     int idx = -1;
-    for (int i = 0; i < TLB_REQ_COUNT; i++) {
-        if (!tlb_reqs[i].in_use) {
-            idx = i;
+    int waited = 0;
+
+    for (;;) {
+        for (int i = 0; i < TLB_REQ_COUNT; i++) {
+            if (!tlb_reqs[i].in_use) {
+                idx = i;
+                break;
+            }
+        }
+
+        if (idx >= 0) {
             break;
         }
-    }
 
-    if (idx < 0) {
+        /*
+         * All slots busy. Flushing only locally would leave stale entries on
+         * the other CPUs, so wait for a slot to be released instead.
+         */
         spinlock_release_safe(&tlb_queue_lock, flags);
-        return -1;
+
+        if (!waited) {
+            tlb_stat_add(TLB_STAT_SLOT_WAITS, 1u);
+            waited = 1;
+        }
+
+        smp_tlb_ipi_handler();
+
+        __asm__ volatile("pause");
+
+        flags = spinlock_acquire_safe(&tlb_queue_lock);
     }
 
     tlb_reqs[idx].start = start;
@@ -275,6 +492,8 @@ static void tlb_free_request(int idx) {
 }
 
 static void tlb_send_ipi_to_mask(uint32_t mask) {
+    uint32_t sent = 0u;
+
     for (int i = 0; i < cpu_count; i++) {
         cpu_t* c = &cpus[i];
         uint32_t bit = 1u << c->index;
@@ -289,7 +508,12 @@ static void tlb_send_ipi_to_mask(uint32_t mask) {
 
         lapic_write(LAPIC_ICRHI, (uint32_t)c->id << 24);
         lapic_write(LAPIC_ICRLO, (uint32_t)IPI_TLB_VECTOR | 0x00004000);
+
+        sent++;
     }
+
+    tlb_stat_add(TLB_STAT_SHOOTDOWNS, 1u);
+    tlb_stat_add(TLB_STAT_IPIS, sent);
 }
 
 void smp_tlb_shootdown_range_dir(uint32_t* page_dir, uint32_t start, uint32_t end) {
@@ -304,23 +528,18 @@ void smp_tlb_shootdown_range_dir(uint32_t* page_dir, uint32_t start, uint32_t en
 
     const uint32_t mask = smp_tlb_cpu_mask_for_page_dir(page_dir);
     if (mask == 0u) {
+        tlb_stat_add(TLB_STAT_LOCAL_ONLY, 1u);
         tlb_flush_range_local(start, end);
         return;
     }
 
     int req_idx = tlb_alloc_request(start, end, mask);
-    if (req_idx < 0) {
-        tlb_flush_range_local(start, end);
-        return;
-    }
 
     tlb_send_ipi_to_mask(mask);
 
     tlb_flush_range_local(start, end);
 
-    while (__atomic_load_n(&tlb_reqs[req_idx].pending_mask, __ATOMIC_ACQUIRE) != 0u) {
-        __asm__ volatile("pause");
-    }
+    tlb_wait_mask(&tlb_reqs[req_idx].pending_mask);
 
     tlb_free_request(req_idx);
 }
@@ -352,18 +571,12 @@ void smp_tlb_shootdown_range(uint32_t start, uint32_t end) {
     }
 
     int req_idx = tlb_alloc_request(start, end, mask);
-    if (req_idx < 0) {
-        tlb_flush_range_local(start, end);
-        return;
-    }
 
     tlb_send_ipi_to_mask(mask);
 
     tlb_flush_range_local(start, end);
 
-    while (__atomic_load_n(&tlb_reqs[req_idx].pending_mask, __ATOMIC_ACQUIRE) != 0u) {
-        __asm__ volatile("pause");
-    }
+    tlb_wait_mask(&tlb_reqs[req_idx].pending_mask);
 
     tlb_free_request(req_idx);
 }
@@ -3,6 +3,7 @@
 
 #include <kernel/waitq/poll_waitq.h>
 #include <kernel/ipc/ipc_endpoint.h>
+#include <kernel/ipc/eventfd.h>
 #include <kernel/uaccess/uaccess.h>
 #include <kernel/tty/tty_bridge.h>
 #include <kernel/futex/futex.h>
@@ -11,6 +12,7 @@
 #include <kernel/syscall.h>
 #include <kernel/smp/cpu.h>
 #include <kernel/smp/mb.h>
+#include <kernel/trace.h>
 
 #include <drivers/input/keyboard.h>
 #include <drivers/virtio/vgpu.h>
@@ -23,17 +25,22 @@
 #include <hal/simd.h>
 #include <hal/apic.h>
 
+#include <mm/zswap.h>
 #include <mm/heap.h>
 #include <mm/pmm.h>
 #include <mm/vma.h>
 #include <mm/shm.h>
 
+#include <yos/channel.h>
+#include <yos/futex.h>
 #include <yos/ioctl.h>
+#include <yos/mman.h>
 #include <yos/proc.h>
 
 #include <arch/i386/paging.h>
 #include <arch/i386/gdt.h>
 
+#include <lib/cpp/lock_guard.h>
 #include <lib/string.h>
 
 #include "syscall.h"
@@ -236,6 +243,8 @@ static void syscall_sbrk(registers_t* regs, task_t* curr) {
         return;
     }
 
+    kernel::MutexNativeGuard write_guard(curr->mem->mmap_mutex);
+
     uint32_t old_brk = curr->mem->prog_break;
     int64_t new_brk64 = (int64_t)(uint64_t)old_brk + (int64_t)incr;
     if (new_brk64 < 0 || new_brk64 >= 0x80000000ll) {
@@ -274,11 +283,15 @@ static void syscall_sbrk(registers_t* regs, task_t* curr) {
         uint32_t start_free = (new_brk + 0xFFFu) & ~0xFFFu;
         uint32_t end_free = (old_brk + 0xFFFu) & ~0xFFFu;
 
+        paging_tlb_gather_t tlb;
+        paging_tlb_gather_init(&tlb, curr->mem->page_dir);
+
         struct SbrkUnmapCtx {
             proc_mem_t* mem = nullptr;
-        } ctx{curr->mem};
+            paging_tlb_gather_t* tlb = nullptr;
+        } ctx{curr->mem, &tlb};
 
-        auto visitor =[](uint32_t /*virt*/, uint32_t pte, void* vctx) -> int {
+        auto visitor =[](uint32_t /*virt*/, pte_t pte, void* vctx) -> int {
             if ((pte & 4u) == 0u) {
                 return 0;
             }
@@ -288,30 +301,25 @@ static void syscall_sbrk(registers_t* regs, task_t* curr) {
                 return 0;
             }
 
-            bool is_4m = (pte & (1u << 7)) != 0u;
-            uint32_t phys = is_4m ? (pte & ~0x3FFFFFu) : (pte & ~0xFFFu);
+            bool is_huge = (pte & PTE_SUPER) != 0u;
+            phys_addr_t phys = is_huge ? pde_huge_phys(pte) : pte_phys(pte);
 
-            if (ctxp->mem->mem_pages > 0u) {
-                uint32_t pages = is_4m ? 1024 : 1;
-                if (ctxp->mem->mem_pages >= pages) {
-                    ctxp->mem->mem_pages -= pages;
-                } else {
-                    ctxp->mem->mem_pages = 0;
-                }
-            }
+            proc_mem_pages_sub(ctxp->mem, is_huge ? PAGING_HUGE_PAGES : 1u);
 
             if (phys != 0u && (pte & 0x200u) == 0u) {
-                if (is_4m) {
-                    pmm_free_pages((void*)phys, 10);
+                if (is_huge) {
+                    paging_tlb_gather_free_huge(ctxp->tlb, phys);
                 } else {
-                    pmm_free_block_deferred((void*)phys);
+                    pmm_free_phys_deferred(phys);
                 }
             }
 
             return 1;
         };
 
-        paging_unmap_range_ex(curr->mem->page_dir, start_free, end_free, visitor, &ctx);
+        paging_unmap_range_gather(&tlb, start_free, end_free, visitor, &ctx);
+
+        paging_tlb_gather_finish(&tlb);
     }
 
     curr->mem->prog_break = new_brk;
@@ -565,7 +573,7 @@ static void syscall_mmap(registers_t* regs, task_t* curr) {
         return;
     }
 
-    if (((uint32_t)flags & ~(MAP_PRIVATE | MAP_SHARED)) != 0) {
+    if (((uint32_t)flags & ~(MAP_PRIVATE | MAP_SHARED | YOS_MAP_POPULATE)) != 0) {
         regs->eax = 0;
         return;
     }
@@ -609,7 +617,7 @@ static void syscall_mmap(registers_t* regs, task_t* curr) {
             regs->eax = 0;
             return;
         }
-        if (size > d->node->size) {
+        if (size > shm_node_size(d->node)) {
             file_desc_release(d);
             regs->eax = 0;
             return;
@@ -642,14 +650,18 @@ static void syscall_mmap(registers_t* regs, task_t* curr) {
         return;
     }
 
+    /* Large shared memory lands huge-aligned so its huge blocks can be mapped whole. */
+    const uint32_t align = ((d->node->flags & VFS_FLAG_SHM) && size >= PAGING_HUGE_SIZE) ? PAGING_HUGE_SIZE : 4096u;
+
     uint32_t vaddr = 0;
-    if (!vma_alloc_slot(curr->mem, size, &vaddr)) {
+    if (!vma_alloc_slot_aligned(curr->mem, size, align, &vaddr)) {
         file_desc_release(d);
         regs->eax = 0;
         return;
     }
 
-    uint32_t file_size = (d->node->size < size) ? d->node->size : size;
+    const uint32_t node_size = (d->node->flags & VFS_FLAG_SHM) ? shm_node_size(d->node) : d->node->size;
+    uint32_t file_size = (node_size < size) ? node_size : size;
 
     vma_region_t* region = vma_create(curr->mem, vaddr, size, d->node, 0u, file_size, map_kind);
     if (!region) {
@@ -660,6 +672,11 @@ static void syscall_mmap(registers_t* regs, task_t* curr) {
 
     file_desc_release(d);
 
+    if ((uint32_t)flags & YOS_MAP_POPULATE) {
+        /* Best effort, like a later fault would be: the mapping stays valid. */
+        (void)mmap_populate_range(curr, vaddr, vaddr + ((size + 4095u) & ~4095u));
+    }
+
     regs->eax = vaddr;
 }
 
@@ -677,6 +694,74 @@ static void syscall_munmap(registers_t* regs, task_t* curr) {
     regs->eax = (uint32_t)result;
 }
 
+static void syscall_madvise(registers_t* regs, task_t* curr) {
+    uint32_t vaddr = regs->ebx;
+    uint32_t len = regs->ecx;
+    uint32_t advice = regs->edx;
+
+    if (!curr->mem || !curr->mem->page_dir || (vaddr & 4095u) != 0u) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    if (len == 0u) {
+        regs->eax = 0;
+        return;
+    }
+
+    if (len > 0xFFFFFFFFu - 4095u || vaddr + ((len + 4095u) & ~4095u) < vaddr) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    const uint32_t end = vaddr + ((len + 4095u) & ~4095u);
+
+    int result = -1;
+
+    switch (advice) {
+        case YOS_MADV_NORMAL:
+            result = vma_advise(curr->mem, vaddr, end, 0u, VMA_MAP_SEQUENTIAL | VMA_MAP_RANDOM);
+            break;
+
+        case YOS_MADV_RANDOM:
+            result = vma_advise(curr->mem, vaddr, end, VMA_MAP_RANDOM, VMA_MAP_SEQUENTIAL);
+            break;
+
+        case YOS_MADV_SEQUENTIAL:
+            result = vma_advise(curr->mem, vaddr, end, VMA_MAP_SEQUENTIAL, VMA_MAP_RANDOM);
+            break;
+
+        case YOS_MADV_HUGEPAGE:
+            result = vma_advise(curr->mem, vaddr, end, VMA_MAP_HUGE, 0u);
+            break;
+
+        case YOS_MADV_WILLNEED:
+            if (vma_validate_range(curr->mem, vaddr, end)) {
+                (void)mmap_populate_range(curr, vaddr, end);
+
+                result = 0;
+            }
+            break;
+
+        case YOS_MADV_DONTNEED:
+            result = vma_discard(curr->mem, vaddr, end);
+            break;
+
+        case YOS_MADV_GUARD_INSTALL:
+            result = vma_advise(curr->mem, vaddr, end, VMA_MAP_GUARD, 0u);
+
+            if (result == 0) {
+                result = vma_discard(curr->mem, vaddr, end);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    regs->eax = (uint32_t)result;
+}
+
 static void syscall_stat(registers_t* regs, task_t* curr) {
     const char* user_path = (const char*)regs->ebx;
     user_stat_t* u_stat = (user_stat_t*)regs->ecx;
@@ -1040,6 +1125,7 @@ static void syscall_kbd_try_read(registers_t* regs, task_t* curr) {
 static void syscall_ipc_listen(registers_t* regs, task_t* curr) {
     const char* u_name = (const char*)regs->ebx;
     int* out_fds = (int*)regs->ecx;
+    uint32_t flags = (uint32_t)regs->edx;
 
     if (out_fds && !ensure_user_buffer_writable_mappable(curr, out_fds, (uint32_t)sizeof(int) * 2u)) {
         regs->eax = (uint32_t)-1;
@@ -1052,7 +1138,7 @@ static void syscall_ipc_listen(registers_t* regs, task_t* curr) {
         return;
     }
 
-    vfs_node_t* node = ipc_listen_create(name);
+    vfs_node_t* node = ipc_listen_create(name, flags);
     if (!node) {
         regs->eax = (uint32_t)-1;
         return;
@@ -1094,13 +1180,34 @@ static void syscall_ipc_accept(registers_t* regs, task_t* curr) {
 
     vfs_node_t* in_r = 0;
     vfs_node_t* out_w = 0;
-    int ar = ipc_accept(lf->node, &in_r, &out_w);
+    vfs_node_t* chan = 0;
+    int ar = ipc_accept(lf->node, &in_r, &out_w, &chan);
     file_desc_release(lf);
     if (ar <= 0) {
         regs->eax = (uint32_t)ar;
         return;
     }
 
+    if (ar == YOS_IPC_ACCEPTED_CHAN) {
+        file_desc_t* fc = 0;
+
+        int fd_c = proc_fd_alloc(curr, &fc);
+        if (fd_c < 0 || !fc) {
+            vfs_node_release(chan);
+            regs->eax = (uint32_t)-1;
+            return;
+        }
+
+        fc->node = chan;
+        fc->offset = 0;
+        fc->flags = 0;
+
+        out_fds[0] = fd_c;
+        out_fds[1] = -1;
+        regs->eax = (uint32_t)YOS_IPC_ACCEPTED_CHAN;
+        return;
+    }
+
     file_desc_t* fr = 0;
     file_desc_t* fw = 0;
 
@@ -1200,6 +1307,89 @@ static void syscall_ipc_connect(registers_t* regs, task_t* curr) {
     regs->eax = 0;
 }
 
+static void syscall_ipc_connect_chan(registers_t* regs, task_t* curr) {
+    const char* u_name = (const char*)regs->ebx;
+
+    char name[32];
+    if (copy_user_str_bounded(curr, name, (uint32_t)sizeof(name), u_name) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    vfs_node_t* chan = 0;
+    void* pending = 0;
+    if (ipc_connect_chan(name, &chan, &pending) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    file_desc_t* fc = 0;
+
+    int fd_c = proc_fd_alloc(curr, &fc);
+    if (fd_c < 0 || !fc) {
+        ipc_connect_cancel(pending);
+        vfs_node_release(chan);
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    fc->node = chan;
+    fc->offset = 0;
+    fc->flags = 0;
+
+    ipc_connect_commit(pending);
+
+    regs->eax = (uint32_t)fd_c;
+}
+
+static void syscall_install_node(registers_t* regs, task_t* curr, vfs_node_t* node) {
+    if (!node) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    file_desc_t* d = 0;
+    int fd = proc_fd_alloc(curr, &d);
+    if (fd < 0 || !d) {
+        vfs_node_release(node);
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    d->node = node;
+    d->offset = 0;
+    d->flags = 0;
+    regs->eax = (uint32_t)fd;
+}
+
+static void syscall_eventfd(registers_t* regs, task_t* curr) {
+    syscall_install_node(regs, curr, eventfd_create_node((uint32_t)regs->ebx, (uint32_t)regs->ecx));
+}
+
+static void syscall_timerfd_create(registers_t* regs, task_t* curr) {
+    syscall_install_node(regs, curr, timerfd_create_node((uint32_t)regs->ebx));
+}
+
+static void syscall_get_nprocs(registers_t* regs, task_t* curr) {
+    (void)curr;
+
+    regs->eax = (uint32_t)(1 + ap_running_count);
+}
+
+static void syscall_getrusage(registers_t* regs, task_t* curr) {
+    void* u_out = (void*)regs->ecx;
+
+    yos_rusage_t ru;
+    if (!u_out
+        || proc_getrusage(curr, (int)regs->ebx, &ru) != 0
+        || uaccess_copy_to_user(u_out, &ru, (uint32_t)sizeof(ru)) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    regs->eax = 0;
+}
+
 static void syscall_shm_create_named(registers_t* regs, task_t* curr) {
     const char* u_name = (const char*)regs->ebx;
     uint32_t size = (uint32_t)regs->ecx;
@@ -1281,62 +1471,220 @@ static void syscall_shm_unlink_named(registers_t* regs, task_t* curr) {
     regs->eax = (uint32_t)shm_unlink_named(name);
 }
 
+/*
+ * Fault the futex word in if it was never touched or got swapped out; a
+ * waiter additionally pins the frame so that it cannot move to another
+ * physical page while the key is in use.
+ */
+static int futex_resolve_key(task_t* curr, volatile const uint32_t* uaddr, bool pin, uint32_t* out_key) {
+    for (int attempt = 0; attempt < 4; attempt++) {
+        const phys_addr_t phys = paging_get_phys(curr->mem->page_dir, (uint32_t)uaddr);
+
+        if (!phys) {
+            uint32_t v = 0u;
+            if (uaccess_copy_from_user(&v, (const void*)uaddr, sizeof(v)) != 0) {
+                return -1;
+            }
+
+            continue;
+        }
+
+        if (!pin) {
+            *out_key = futex_key_from_phys(phys);
+            return 0;
+        }
+
+        zswap_pin_phys(phys);
+
+        if (paging_get_phys(curr->mem->page_dir, (uint32_t)uaddr) == phys) {
+            *out_key = futex_key_from_phys(phys);
+            return 0;
+        }
+
+        zswap_unpin_phys(phys);
+    }
+
+    return -1;
+}
+
+static int futex_user_key(task_t* curr, volatile const uint32_t* uaddr, bool pin, uint32_t* out_key) {
+    if (((uint32_t)uaddr & 3u) != 0) {
+        return -1;
+    }
+
+    if (!check_user_buffer_present(curr, (const void*)uaddr, 4u)) {
+        return -1;
+    }
+
+    if (!curr->mem || !curr->mem->page_dir) {
+        return -1;
+    }
+
+    return futex_resolve_key(curr, uaddr, pin, out_key);
+}
+
+static uint32_t futex_deadline_tick(uint32_t timeout_ms, uint32_t flags) {
+    /* Round up so that a wait never ends before the requested time. */
+    const uint32_t ticks = (uint32_t)(((uint64_t)timeout_ms * KERNEL_TIMER_HZ + 999ull) / 1000ull);
+
+    return (flags & YOS_FUTEX_ABSTIME) != 0u ? ticks : timer_ticks + ticks;
+}
+
 static void syscall_futex_wait(registers_t* regs, task_t* curr) {
     volatile const uint32_t* uaddr = (volatile const uint32_t*)regs->ebx;
     uint32_t expected = (uint32_t)regs->ecx;
 
-    if (((uint32_t)uaddr & 3u) != 0) {
+    uint32_t key = 0u;
+    if (futex_user_key(curr, uaddr, true, &key) != 0) {
         regs->eax = (uint32_t)-1;
         return;
     }
 
-    if (!check_user_buffer_present(curr, (const void*)uaddr, 4u)) {
+    regs->eax = (uint32_t)futex_wait(&key, uaddr, expected, 0);
+
+    zswap_unpin_phys(futex_key_to_phys(key));
+}
+
+static void syscall_futex_wake(registers_t* regs, task_t* curr) {
+    volatile const uint32_t* uaddr = (volatile const uint32_t*)regs->ebx;
+    uint32_t max_wake = (uint32_t)regs->ecx;
+
+    uint32_t key = 0u;
+    if (futex_user_key(curr, uaddr, false, &key) != 0) {
         regs->eax = (uint32_t)-1;
         return;
     }
 
-    if (!curr->mem || !curr->mem->page_dir) {
+    regs->eax = (uint32_t)futex_wake(key, max_wake);
+}
+
+static void syscall_futex_wait_timeout(registers_t* regs, task_t* curr) {
+    volatile const uint32_t* uaddr = (volatile const uint32_t*)regs->ebx;
+    uint32_t expected = (uint32_t)regs->ecx;
+    uint32_t timeout_ms = (uint32_t)regs->edx;
+    uint32_t flags = (uint32_t)regs->esi;
+
+    if ((flags & ~YOS_FUTEX_ABSTIME) != 0u) {
         regs->eax = (uint32_t)-1;
         return;
     }
 
-    uint32_t phys = paging_get_phys(curr->mem->page_dir, (uint32_t)uaddr);
-    if (!phys) {
+    const uint32_t deadline = futex_deadline_tick(timeout_ms, flags);
+
+    uint32_t key = 0u;
+    if (futex_user_key(curr, uaddr, true, &key) != 0) {
         regs->eax = (uint32_t)-1;
         return;
     }
-    uint32_t key = phys & ~3u;
 
-    regs->eax = (uint32_t)futex_wait(key, uaddr, expected);
+    regs->eax = (uint32_t)futex_wait(&key, uaddr, expected, &deadline);
+
+    zswap_unpin_phys(futex_key_to_phys(key));
 }
 
-static void syscall_futex_wake(registers_t* regs, task_t* curr) {
-    volatile const uint32_t* uaddr = (volatile const uint32_t*)regs->ebx;
-    uint32_t max_wake = (uint32_t)regs->ecx;
+static void syscall_futex_requeue(registers_t* regs, task_t* curr) {
+    const yos_futex_requeue_t* u_req = (const yos_futex_requeue_t*)regs->ebx;
 
-    if (((uint32_t)uaddr & 3u) != 0) {
+    yos_futex_requeue_t req;
+    if (!u_req || uaccess_copy_from_user(&req, u_req, sizeof(req)) != 0) {
         regs->eax = (uint32_t)-1;
         return;
     }
 
-    if (!check_user_buffer_present(curr, (const void*)uaddr, 4u)) {
+    if ((req.flags & ~YOS_FUTEX_REQUEUE_CMP) != 0u) {
         regs->eax = (uint32_t)-1;
         return;
     }
 
-    if (!curr->mem || !curr->mem->page_dir) {
+    uint32_t key = 0u;
+    uint32_t key2 = 0u;
+
+    if (futex_user_key(curr, req.uaddr, false, &key) != 0
+        || futex_user_key(curr, req.uaddr2, false, &key2) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    const uint32_t* cmpval = (req.flags & YOS_FUTEX_REQUEUE_CMP) != 0u ? &req.cmpval : 0;
+
+    regs->eax = (uint32_t)futex_requeue(key, key2, req.uaddr, cmpval, req.nr_wake, req.nr_requeue);
+}
+
+static void syscall_futex_wake_op(registers_t* regs, task_t* curr) {
+    const yos_futex_wake_op_t* u_req = (const yos_futex_wake_op_t*)regs->ebx;
+
+    yos_futex_wake_op_t req;
+    if (!u_req || uaccess_copy_from_user(&req, u_req, sizeof(req)) != 0) {
         regs->eax = (uint32_t)-1;
         return;
     }
 
-    uint32_t phys = paging_get_phys(curr->mem->page_dir, (uint32_t)uaddr);
-    if (!phys) {
+    if (!check_user_buffer_writable_present(curr, (void*)req.uaddr2, 4u)) {
         regs->eax = (uint32_t)-1;
         return;
     }
-    uint32_t key = phys & ~3u;
 
-    regs->eax = (uint32_t)futex_wake(key, max_wake);
+    uint32_t key = 0u;
+    uint32_t key2 = 0u;
+
+    if (futex_user_key(curr, req.uaddr, false, &key) != 0
+        || futex_user_key(curr, req.uaddr2, false, &key2) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    regs->eax = (uint32_t)futex_wake_op(
+        key, key2, req.uaddr2,
+        req.nr_wake, req.nr_wake2,
+        req.op, req.oparg,
+        req.cmp, req.cmparg
+    );
+}
+
+/* The kernel updates a PI word itself, under its locks: it has to be writable and stay put. */
+static int futex_pi_user_key(task_t* curr, volatile uint32_t* uaddr, uint32_t* out_key) {
+    if (!check_user_buffer_writable_present(curr, (void*)uaddr, 4u)) {
+        return -1;
+    }
+
+    return futex_user_key(curr, uaddr, true, out_key);
+}
+
+static void syscall_futex_lock_pi(registers_t* regs, task_t* curr) {
+    volatile uint32_t* uaddr = (volatile uint32_t*)regs->ebx;
+    uint32_t timeout_ms = (uint32_t)regs->ecx;
+    uint32_t flags = (uint32_t)regs->edx;
+
+    if ((flags & ~YOS_FUTEX_ABSTIME) != 0u) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    const uint32_t deadline = futex_deadline_tick(timeout_ms, flags);
+
+    uint32_t key = 0u;
+    if (futex_pi_user_key(curr, uaddr, &key) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    regs->eax = (uint32_t)futex_lock_pi(key, uaddr, timeout_ms != YOS_FUTEX_INFINITE ? &deadline : 0);
+
+    zswap_unpin_phys(futex_key_to_phys(key));
+}
+
+static void syscall_futex_unlock_pi(registers_t* regs, task_t* curr) {
+    volatile uint32_t* uaddr = (volatile uint32_t*)regs->ebx;
+
+    uint32_t key = 0u;
+    if (futex_pi_user_key(curr, uaddr, &key) != 0) {
+        regs->eax = (uint32_t)-1;
+        return;
+    }
+
+    regs->eax = (uint32_t)futex_unlock_pi(key, uaddr);
+
+    zswap_unpin_phys(futex_key_to_phys(key));
 }
 
 static void syscall_ioctl(registers_t* regs, task_t* curr) {
@@ -1979,6 +2327,7 @@ static void syscall_set_tls(registers_t* regs, task_t* curr) {
     if (cpu) {
         gdt_set_user_tls(cpu->index, (uint32_t)curr->tls_base);
         regs->fs = ((GDT_USER_TLS_BASE + cpu->index) << 3) | 3;
+        regs->gs = regs->fs;
     }
     
     regs->eax = 0;
@@ -2042,6 +2391,17 @@ static const syscall_fn_t syscall_table[] = {
     [54] = syscall_unlinkat,
     [55] = syscall_statat,
     [56] = syscall_set_tls,
+    [57] = syscall_madvise,
+    [58] = syscall_futex_wait_timeout,
+    [59] = syscall_futex_requeue,
+    [60] = syscall_futex_wake_op,
+    [61] = syscall_futex_lock_pi,
+    [62] = syscall_futex_unlock_pi,
+    [63] = syscall_ipc_connect_chan,
+    [64] = syscall_eventfd,
+    [65] = syscall_timerfd_create,
+    [66] = syscall_get_nprocs,
+    [67] = syscall_getrusage,
 };
 
 extern "C" void syscall_handler(registers_t* regs) {
@@ -2075,7 +2435,11 @@ extern "C" void syscall_handler(registers_t* regs) {
         regs->esi = regs->ebp;
     }
 
+    trace_event(YOS_TRACE_SYSCALL_ENTER, sys_num, regs->ebx, regs->ecx, regs->edx);
+
     fn(regs, curr);
+
+    trace_event(YOS_TRACE_SYSCALL_EXIT, sys_num, regs->eax, 0u, 0u);
     
     if (is_sysenter && sys_num != 16) {
         regs->ecx = orig_ecx;
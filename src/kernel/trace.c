@@ -0,0 +1,241 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#include <kernel/locking/spinlock.h>
+#include <kernel/smp/cpu.h>
+#include <kernel/trace.h>
+#include <kernel/proc.h>
+
+#include <lib/compiler.h>
+
+#include <hal/align.h>
+#include <hal/delay.h>
+#include <hal/irq.h>
+
+#include <mm/heap.h>
+
+/* Per-CPU buffer size in events; a power of two. */
+#define TRACE_RING_EVENTS 4096u
+#define TRACE_RING_MASK   (TRACE_RING_EVENTS - 1u)
+
+/*
+ * Overwrite-oldest ring. Only the owning CPU writes, with interrupts off so
+ * tracepoints in interrupt handlers cannot interleave with one in progress;
+ * an event is published by advancing `head` after it is fully written.
+ * Readers never block the writer: a copied event is only kept if the writer
+ * had not yet wrapped around to its slot when the copy finished.
+ */
+typedef struct {
+    volatile uint32_t head __cacheline_aligned;
+
+    /* Reader side, under g_read_lock. */
+    uint32_t tail __cacheline_aligned;
+    uint32_t overwritten;
+
+    yos_trace_event_t* slots;
+} trace_ring_t;
+
+volatile uint32_t g_trace_mask;
+
+static trace_ring_t g_rings[MAX_CPUS];
+
+static uint32_t g_base_events;
+
+/* Serializes readers, reset and buffer allocation. Never taken from tracepoints. */
+static spinlock_t g_read_lock;
+
+static uint32_t g_read_cursor;
+
+___inline uint64_t trace_clock(void) {
+    uint32_t lo;
+    uint32_t hi;
+
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+
+    return ((uint64_t)hi << 32) | (uint64_t)lo;
+}
+
+void trace_log(uint32_t type, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    const uint32_t flags = irq_save();
+
+    cpu_t* cpu = cpu_current();
+
+    if (unlikely(!cpu || cpu->index < 0 || cpu->index >= MAX_CPUS)) {
+        irq_restore(flags);
+        return;
+    }
+
+    trace_ring_t* ring = &g_rings[cpu->index];
+
+    yos_trace_event_t* slots = __atomic_load_n(&ring->slots, __ATOMIC_ACQUIRE);
+    if (unlikely(!slots)) {
+        irq_restore(flags);
+        return;
+    }
+
+    const uint32_t head = ring->head;
+
+    yos_trace_event_t* e = &slots[head & TRACE_RING_MASK];
+
+    e->tsc = trace_clock();
+    e->type = (uint16_t)type;
+    e->cpu = (uint16_t)cpu->index;
+    e->pid = cpu->current_task ? cpu->current_task->pid : 0u;
+    e->args[0] = a0;
+    e->args[1] = a1;
+    e->args[2] = a2;
+    e->args[3] = a3;
+
+    __atomic_store_n(&ring->head, head + 1u, __ATOMIC_RELEASE);
+
+    irq_restore(flags);
+}
+
+static int trace_alloc_rings(void) {
+    for (int i = 0; i < cpu_count && i < MAX_CPUS; i++) {
+        if (g_rings[i].slots) {
+            continue;
+        }
+
+        yos_trace_event_t* slots = (yos_trace_event_t*)kzalloc(TRACE_RING_EVENTS * sizeof(yos_trace_event_t));
+        if (!slots) {
+            return -1;
+        }
+
+        __atomic_store_n(&g_rings[i].slots, slots, __ATOMIC_RELEASE);
+    }
+
+    return 0;
+}
+
+int trace_set_mask(uint32_t mask) {
+    mask &= YOS_TRACE_ALL;
+
+    if (mask != 0u) {
+        uint32_t flags = spinlock_acquire_safe(&g_read_lock);
+        const int rc = trace_alloc_rings();
+        spinlock_release_safe(&g_read_lock, flags);
+
+        if (rc != 0) {
+            return -1;
+        }
+    }
+
+    __atomic_store_n(&g_trace_mask, mask, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+static uint32_t trace_total_events(void) {
+    uint32_t total = 0u;
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        total += __atomic_load_n(&g_rings[i].head, __ATOMIC_RELAXED);
+    }
+
+    return total;
+}
+
+void trace_get_stats(yos_trace_stats_t* out) {
+    if (!out) {
+        return;
+    }
+
+    uint32_t flags = spinlock_acquire_safe(&g_read_lock);
+
+    uint32_t overwritten = 0u;
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        trace_ring_t* ring = &g_rings[i];
+
+        const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        overwritten += ring->overwritten;
+
+        /* Count what the writer has already lapped, even if nobody read it yet. */
+        if (head - ring->tail > TRACE_RING_EVENTS) {
+            overwritten += head - ring->tail - TRACE_RING_EVENTS;
+        }
+    }
+
+    out->mask = __atomic_load_n(&g_trace_mask, __ATOMIC_RELAXED);
+    out->tsc_khz = (uint32_t)(g_cpu_tsc_hz / 1000ull);
+    out->events = trace_total_events() - g_base_events;
+    out->overwritten = overwritten;
+
+    spinlock_release_safe(&g_read_lock, flags);
+}
+
+void trace_reset(void) {
+    uint32_t flags = spinlock_acquire_safe(&g_read_lock);
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        trace_ring_t* ring = &g_rings[i];
+
+        ring->tail = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        ring->overwritten = 0u;
+    }
+
+    g_base_events = trace_total_events();
+
+    spinlock_release_safe(&g_read_lock, flags);
+}
+
+uint32_t trace_read(yos_trace_event_t* out, uint32_t max) {
+    if (!out || max == 0u) {
+        return 0;
+    }
+
+    uint32_t n = 0;
+
+    uint32_t flags = spinlock_acquire_safe(&g_read_lock);
+
+    /* Rotate the starting CPU so one busy CPU cannot starve the others. */
+    for (uint32_t k = 0; k < MAX_CPUS && n < max; k++) {
+        trace_ring_t* ring = &g_rings[(g_read_cursor + k) % MAX_CPUS];
+
+        if (!ring->slots) {
+            continue;
+        }
+
+        uint32_t tail = ring->tail;
+
+        while (n < max) {
+            const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+            if (head - tail > TRACE_RING_EVENTS) {
+                ring->overwritten += head - tail - TRACE_RING_EVENTS;
+                tail = head - TRACE_RING_EVENTS;
+            }
+
+            if (tail == head) {
+                break;
+            }
+
+            out[n] = ring->slots[tail & TRACE_RING_MASK];
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            /*
+             * Event tail + N reuses this slot and is written while head still
+             * equals tail + N, so from that point on the copy may be torn.
+             */
+            if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail >= TRACE_RING_EVENTS) {
+                ring->overwritten++;
+                tail++;
+                continue;
+            }
+
+            n++;
+            tail++;
+        }
+
+        ring->tail = tail;
+    }
+
+    g_read_cursor = (g_read_cursor + 1u) % MAX_CPUS;
+
+    spinlock_release_safe(&g_read_lock, flags);
+
+    return n;
+}
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef KERNEL_TRACE_H
+#define KERNEL_TRACE_H
+
+#include <yos/trace.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Static tracepoints.
+ *
+ * Events go into per-CPU overwrite-oldest rings drained through /dev/trace.
+ * A tracepoint is a test of g_trace_mask: while its bit is clear the
+ * arguments are not evaluated and nothing else runs.
+ */
+
+extern volatile uint32_t g_trace_mask;
+
+void trace_log(uint32_t type, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+#define trace_event(type, a0, a1, a2, a3)                                         \
+    do {                                                                          \
+        if (__builtin_expect((g_trace_mask & YOS_TRACE_BIT(type)) != 0u, 0)) {    \
+            trace_log((type), (uint32_t)(a0), (uint32_t)(a1),                     \
+                      (uint32_t)(a2), (uint32_t)(a3));                            \
+        }                                                                         \
+    } while (0)
+
+/* Enable exactly the events in `mask`. Returns -1 if the buffers cannot be allocated. */
+int trace_set_mask(uint32_t mask);
+
+void trace_get_stats(yos_trace_stats_t* out);
+
+/* Drop every event not read yet and restart the counters. */
+void trace_reset(void);
+
+/* Move up to `max` events into `out`. Returns the number moved. */
+uint32_t trace_read(yos_trace_event_t* out, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -98,6 +98,35 @@ fixup:
     return -1;
 }
 
+__attribute__((no_instrument_function))
+static int uaccess_cmpxchg_user_u32_impl(volatile uint32_t* uaddr, uint32_t* expected, uint32_t desired) {
+    const uintptr_t addr = (uintptr_t)uaddr;
+
+    if (!uaddr || !expected || (addr & 3u) != 0u || addr >= KERNEL_BASE - 3u) {
+        return -1;
+    }
+
+    uint32_t old = *expected;
+
+    __asm__ volatile goto(
+        "1: lock cmpxchgl %[desired], (%[ptr])\n"
+        ".pushsection .uaccess_fixup, \"a\"\n"
+        ".long 1b, %l[fixup]\n"
+        ".popsection\n"
+        : "+a"(old)
+        : [ptr] "r"(uaddr), [desired] "r"(desired)
+        : "memory", "cc"
+        : fixup
+    );
+
+    *expected = old;
+
+    return 0;
+
+fixup:
+    return -1;
+}
+
 extern "C" int uaccess_copy_from_user(void* dst, const void* user_src, uint32_t size) {
     return uaccess_memcpy_from_user_impl(dst, user_src, size);
 }
@@ -106,6 +135,10 @@ extern "C" int uaccess_copy_to_user(void* user_dst, const void* src, uint32_t si
     return uaccess_memcpy_to_user_impl(user_dst, src, size);
 }
 
+extern "C" int uaccess_cmpxchg_user_u32(volatile uint32_t* uaddr, uint32_t* expected, uint32_t desired) {
+    return uaccess_cmpxchg_user_u32_impl(uaddr, expected, desired);
+}
+
 static int check_user_range_basic(task_t* task, uintptr_t start, uintptr_t end_excl) {
     if (!task || !task->mem || !task->mem->page_dir) {
         return 0;
@@ -30,6 +30,12 @@ int uaccess_copy_from_user(void* dst, const void* user_src, uint32_t size);
 
 int uaccess_copy_to_user(void* user_dst, const void* src, uint32_t size);
 
+/*
+ * Atomically replace the user word at `uaddr` with `desired` if it still
+ * holds `*expected`. `*expected` receives the value seen either way.
+ */
+int uaccess_cmpxchg_user_u32(volatile uint32_t* uaddr, uint32_t* expected, uint32_t desired);
+
 #ifdef __cplusplus
 }
 #endif
@@ -95,6 +95,29 @@ task_t* waitqueue_dequeue_locked(waitqueue_t* q) {
     return task;
 }
 
+task_t* waitqueue_requeue_locked(waitqueue_t* from, waitqueue_t* to) {
+    if (unlikely(!from
+        || !to)) {
+        return 0;
+    }
+
+    if (dlist_empty(&from->waiters)) {
+        return 0;
+    }
+
+    task_t* task = container_of(from->waiters.next, task_t, sem_node);
+
+    dlist_del(&task->sem_node);
+
+    /* One store: a concurrent cancel sees either queue, never "not waiting". */
+    __atomic_store_n(&task->blocked_on_sem, to->blocked_on, __ATOMIC_RELEASE);
+    task->blocked_kind = to->kind;
+
+    dlist_add_tail(&task->sem_node, &to->waiters);
+
+    return task;
+}
+
 void waitqueue_detach_all_locked(waitqueue_t* q, dlist_head_t* out_list) {
     if (unlikely(!q
         || !out_list)) {
@@ -35,6 +35,12 @@ void waitqueue_wait_cancel_locked(
 
 task_t* waitqueue_dequeue_locked(waitqueue_t* q);
 
+/*
+ * Move the oldest waiter of `from` to the tail of `to` without waking it.
+ * The caller holds the locks of both queues.
+ */
+task_t* waitqueue_requeue_locked(waitqueue_t* from, waitqueue_t* to);
+
 void waitqueue_detach_all_locked(waitqueue_t* q, dlist_head_t* out_list);
 
 task_t* waitqueue_detached_list_pop(dlist_head_t* list);
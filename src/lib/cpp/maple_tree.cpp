@@ -210,6 +210,46 @@ void ma_recalc_pivots(ma_node_t* node) noexcept {
     }
 }
 
+/*
+ * Last index covered by a subtree, read from its rightmost entry. Node
+ * pivots cannot be used for this: the last child of every node carries
+ * kMaxKey, and leaf pivots keep that value after later inserts.
+ */
+bool ma_subtree_max(const ma_node_t* node, uint32_t* out) noexcept {
+    while (node && !ma_node_is_leaf(node)) {
+        const ma_node_t* last = nullptr;
+
+        for (uint8_t i = 0u; i < MT_SLOT_COUNT; i++) {
+            if (node->slots[i]) {
+                last = static_cast<const ma_node_t*>(ma_slot_rcu(node, i));
+            }
+        }
+
+        node = last;
+    }
+
+    if (!node) {
+        return false;
+    }
+
+    bool has_val = false;
+
+    for (uint8_t i = 0; i < MT_SLOT_COUNT; i++) {
+        if (node->slots[i]) {
+            uint32_t e_last = *((uint32_t*)mt_entry_to_slot(node->slots[i]) + 1) - 1u;
+
+            if (!has_val
+                || e_last > *out) {
+                *out = e_last;
+
+                has_val = true;
+            }
+        }
+    }
+
+    return has_val;
+}
+
 void ma_propagate_pivots(maple_tree_t* mt, ma_node_t* node) noexcept {
     while (node) {
         ma_recalc_pivots(node);
@@ -222,42 +262,7 @@ void ma_propagate_pivots(maple_tree_t* mt, ma_node_t* node) noexcept {
             if (pslot < MT_PIVOT_COUNT) {
                 uint32_t max_val = 0;
 
-                bool has_val = false;
-
-                if (ma_node_is_leaf(node)) {
-                    for (uint8_t i = 0; i < MT_SLOT_COUNT; i++) {
-                        if (node->slots[i]) {
-                            uint32_t e_end = *((uint32_t*)mt_entry_to_slot(node->slots[i]) + 1);
-
-                            if (!has_val
-                                || e_end - 1u > max_val) {
-                                max_val = e_end - 1u;
-
-                                has_val = true;
-                            }
-                        }
-                    }
-                } else {
-                    for (uint8_t i = 0; i < MT_PIVOT_COUNT; i++) {
-                        if (node->pivots[i] != 0u) {
-                            if (node->pivots[i] == kMaxKey) {
-                                max_val = kMaxKey;
-
-                                has_val = true;
-                                break;
-                            }
-
-                            if (!has_val
-                                || node->pivots[i] > max_val) {
-                                max_val = node->pivots[i];
-
-                                has_val = true;
-                            }
-                        }
-                    }
-                }
-
-                if (has_val && parent->pivots[pslot] != kMaxKey) {
+                if (ma_subtree_max(node, &max_val) && parent->pivots[pslot] != kMaxKey) {
                     parent->pivots[pslot] = max_val;
                 }
             }
@@ -299,6 +304,8 @@ int split_node(
 
     uint32_t split_pivot = orig->pivots[mid - 1u];
 
+    (void)ma_subtree_max(orig, &split_pivot);
+
     orig->pivots[mid - 1u] = kMaxKey;
 
     if (parent == nullptr) {
@@ -473,9 +480,10 @@ void rebalance_after_erase(maple_tree_t* mt, ma_node_t* parent) noexcept {
             return;
         }
 
-        ma_recalc_pivots(parent);
+        /* A dropped last child leaves the separators above it too high. */
+        ma_propagate_pivots(mt, parent);
 
-        parent = ma_parent(parent);
+        return;
     }
 }
 
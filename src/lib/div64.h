@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef LIB_DIV64_H
+#define LIB_DIV64_H
+
+#include <lib/compiler.h>
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 64-bit unsigned divide returning the remainder too.
+ *
+ * A plain `/` and `%` pair on the same operands makes gcc call
+ * __udivmoddi4, which the kernel has no libgcc to provide. Shift and
+ * subtract is slow next to a hardware divide, so keep this off hot paths.
+ */
+___inline uint64_t div64_u64_rem(uint64_t n, uint64_t d, uint64_t* rem) {
+    uint64_t q = 0u;
+    uint64_t r = 0u;
+
+    if (d != 0u) {
+        for (int i = 63; i >= 0; i--) {
+            r = (r << 1) | ((n >> i) & 1u);
+            if (r >= d) {
+                r -= d;
+                q |= 1ull << i;
+            }
+        }
+    }
+
+    if (rem) {
+        *rem = r;
+    }
+
+    return q;
+}
+
+/* Split a TSC count into whole seconds and microseconds at `hz` ticks per second. */
+___inline void tsc_to_sec_usec(uint64_t tsc, uint64_t hz, uint32_t* sec, uint32_t* usec) {
+    if (hz == 0u) {
+        *sec = 0u;
+        *usec = 0u;
+        return;
+    }
+
+    uint64_t rem;
+    *sec = (uint32_t)div64_u64_rem(tsc, hz, &rem);
+    *usec = (uint32_t)div64_u64_rem(rem * 1000000ull, hz, 0);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -815,6 +815,7 @@ public:
 
         ~LockedView() {
             map_->resizing.store(0u, kernel::memory_order::release);
+            map_->seqlock_.store(map_->seqlock_.load(kernel::memory_order::relaxed) + 1u, kernel::memory_order::release);
         }
 
         Iterator begin() {
@@ -917,6 +918,7 @@ private:
         {
             kernel::SpinLockGuard lock_other(other.table_lock);
 
+            quiesce_locked();
             other.quiesce_locked();
 
             old_buckets = buckets;
@@ -949,9 +951,8 @@ private:
         }
     }
 
+    /* Both maps must be inside quiesce_locked(); this closes both write sections. */
     void steal_from_locked(HashMap& other) {
-        seqlock_.store(seqlock_.load(kernel::memory_order::relaxed) + 1u, kernel::memory_order::release);
-
         buckets = other.buckets;
         bucket_count = other.bucket_count;
         bucket_mask = other.bucket_mask;
@@ -0,0 +1,293 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#include <lib/compiler.h>
+#include <lib/string.h>
+#include <lib/lz4.h>
+
+#define LZ4_MIN_MATCH      4u
+#define LZ4_LAST_LITERALS  5u
+#define LZ4_MF_LIMIT       12u
+#define LZ4_MAX_OFFSET     0xFFFFu
+#define LZ4_SKIP_TRIGGER   6u
+
+#define LZ4_RUN_MASK       15u
+#define LZ4_ML_MASK        15u
+
+___inline uint32_t lz4_read32(const uint8_t* p) {
+    uint32_t v;
+
+    __builtin_memcpy(&v, p, sizeof(v));
+
+    return v;
+}
+
+___inline uint32_t lz4_hash(uint32_t seq) {
+    return (seq * 2654435761u) >> (32u - LZ4_HASH_LOG);
+}
+
+/*
+ * Extra length bytes needed to encode `len` above the 15 stored in the token.
+ * Used to check output room before anything of a sequence is written.
+ */
+___inline uint32_t lz4_length_bytes(uint32_t len) {
+    if (len < 15u) {
+        return 0u;
+    }
+
+    return (len - 15u) / 255u + 1u;
+}
+
+___inline uint8_t* lz4_write_length(uint8_t* op, uint32_t len) {
+    len -= 15u;
+
+    while (len >= 255u) {
+        *op++ = 255u;
+        len -= 255u;
+    }
+
+    *op++ = (uint8_t)len;
+
+    return op;
+}
+
+static uint8_t* lz4_emit_last_literals(
+    uint8_t* op, const uint8_t* oend,
+    const uint8_t* anchor, uint32_t lit_len
+) {
+    const uint32_t need = 1u + lz4_length_bytes(lit_len) + lit_len;
+
+    if ((uint32_t)(oend - op) < need) {
+        return 0;
+    }
+
+    if (lit_len >= LZ4_RUN_MASK) {
+        *op++ = (uint8_t)(LZ4_RUN_MASK << 4);
+        op = lz4_write_length(op, lit_len);
+    } else {
+        *op++ = (uint8_t)(lit_len << 4);
+    }
+
+    memcpy(op, anchor, lit_len);
+
+    return op + lit_len;
+}
+
+uint32_t lz4_compress(
+    const void* src, uint32_t len,
+    void* dst, uint32_t cap,
+    void* workmem
+) {
+    if (unlikely(!src || !dst || !workmem || len > LZ4_MAX_INPUT_SIZE)) {
+        return 0u;
+    }
+
+    const uint8_t* const base = (const uint8_t*)src;
+    const uint8_t* const iend = base + len;
+
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+
+    uint8_t* op = (uint8_t*)dst;
+    const uint8_t* const oend = op + cap;
+
+    uint16_t* table = (uint16_t*)workmem;
+
+    if (len < LZ4_MF_LIMIT + 1u) {
+        goto last_literals;
+    }
+
+    memset(table, 0, LZ4_WORKMEM_SIZE);
+
+    const uint8_t* const mflimit = iend - LZ4_MF_LIMIT;
+    const uint8_t* const match_limit = iend - LZ4_LAST_LITERALS;
+
+    ip++;
+
+    while (ip <= mflimit) {
+        const uint8_t* ref = 0;
+        uint32_t attempts = 1u << LZ4_SKIP_TRIGGER;
+
+        /* Greedy search: a single probe per position, accelerating over noise. */
+        for (;;) {
+            const uint32_t seq = lz4_read32(ip);
+            const uint32_t h = lz4_hash(seq);
+
+            ref = base + table[h];
+            table[h] = (uint16_t)(ip - base);
+
+            if (ref < ip
+                && (uint32_t)(ip - ref) <= LZ4_MAX_OFFSET
+                && lz4_read32(ref) == seq) {
+                break;
+            }
+
+            ip += attempts++ >> LZ4_SKIP_TRIGGER;
+
+            if (ip > mflimit) {
+                goto last_literals;
+            }
+        }
+
+        while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+            ip--;
+            ref--;
+        }
+
+        const uint8_t* mp = ip + LZ4_MIN_MATCH;
+        const uint8_t* rp = ref + LZ4_MIN_MATCH;
+
+        while (mp < match_limit && *mp == *rp) {
+            mp++;
+            rp++;
+        }
+
+        const uint32_t lit_len = (uint32_t)(ip - anchor);
+        const uint32_t match_len = (uint32_t)(mp - ip) - LZ4_MIN_MATCH;
+
+        const uint32_t need = 1u
+            + lz4_length_bytes(lit_len) + lit_len
+            + 2u
+            + lz4_length_bytes(match_len);
+
+        if ((uint32_t)(oend - op) < need) {
+            return 0u;
+        }
+
+        uint8_t* token = op++;
+
+        if (lit_len >= LZ4_RUN_MASK) {
+            *token = (uint8_t)(LZ4_RUN_MASK << 4);
+            op = lz4_write_length(op, lit_len);
+        } else {
+            *token = (uint8_t)(lit_len << 4);
+        }
+
+        memcpy(op, anchor, lit_len);
+        op += lit_len;
+
+        const uint32_t offset = (uint32_t)(ip - ref);
+
+        *op++ = (uint8_t)(offset & 0xFFu);
+        *op++ = (uint8_t)(offset >> 8);
+
+        if (match_len >= LZ4_ML_MASK) {
+            *token |= (uint8_t)LZ4_ML_MASK;
+            op = lz4_write_length(op, match_len);
+        } else {
+            *token |= (uint8_t)match_len;
+        }
+
+        ip = mp;
+        anchor = ip;
+
+        if (ip <= mflimit) {
+            table[lz4_hash(lz4_read32(ip - 2))] = (uint16_t)(ip - 2 - base);
+        }
+    }
+
+last_literals:
+    op = lz4_emit_last_literals(op, oend, anchor, (uint32_t)(iend - anchor));
+
+    if (!op) {
+        return 0u;
+    }
+
+    return (uint32_t)(op - (uint8_t*)dst);
+}
+
+int lz4_decompress(const void* src, uint32_t len, void* dst, uint32_t cap) {
+    if (unlikely(!src || !dst)) {
+        return -1;
+    }
+
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* const iend = ip + len;
+
+    uint8_t* const obase = (uint8_t*)dst;
+    uint8_t* op = obase;
+    const uint8_t* const oend = obase + cap;
+
+    while (ip < iend) {
+        const uint32_t token = *ip++;
+
+        uint32_t lit_len = token >> 4;
+
+        if (lit_len == LZ4_RUN_MASK) {
+            uint32_t b;
+
+            do {
+                if (unlikely(ip >= iend)) {
+                    return -1;
+                }
+
+                b = *ip++;
+                lit_len += b;
+            } while (b == 255u);
+        }
+
+        if (unlikely(lit_len > (uint32_t)(iend - ip)
+            || lit_len > (uint32_t)(oend - op))) {
+            return -1;
+        }
+
+        memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+
+        /* The final sequence carries literals only. */
+        if (ip == iend) {
+            break;
+        }
+
+        if (unlikely((uint32_t)(iend - ip) < 2u)) {
+            return -1;
+        }
+
+        const uint32_t offset = (uint32_t)ip[0] | ((uint32_t)ip[1] << 8);
+        ip += 2;
+
+        if (unlikely(offset == 0u || offset > (uint32_t)(op - obase))) {
+            return -1;
+        }
+
+        uint32_t match_len = token & LZ4_ML_MASK;
+
+        if (match_len == LZ4_ML_MASK) {
+            uint32_t b;
+
+            do {
+                if (unlikely(ip >= iend)) {
+                    return -1;
+                }
+
+                b = *ip++;
+                match_len += b;
+            } while (b == 255u);
+        }
+
+        match_len += LZ4_MIN_MATCH;
+
+        if (unlikely(match_len > (uint32_t)(oend - op))) {
+            return -1;
+        }
+
+        const uint8_t* ref = op - offset;
+
+        /* Overlapping copies are how LZ4 encodes runs; copy forward bytewise. */
+        if (offset >= 4u) {
+            while (match_len >= 4u) {
+                __builtin_memcpy(op, ref, 4u);
+                op += 4;
+                ref += 4;
+                match_len -= 4u;
+            }
+        }
+
+        while (match_len-- > 0u) {
+            *op++ = *ref++;
+        }
+    }
+
+    return (int)(op - obase);
+}
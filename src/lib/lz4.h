@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef LIB_LZ4_H
+#define LIB_LZ4_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * LZ4 block format codec.
+ *
+ * Only the raw block format is implemented (no frame headers, no checksums).
+ * The compressor is the classic greedy single-probe variant: it trades a few
+ * percent of ratio for a tiny, allocation-free hot loop, which is what page
+ * sized inputs on the reclaim path want.
+ *
+ * Both directions are bounds-checked against the caller supplied capacity,
+ * so a corrupted or truncated block can never write past `dst + cap`.
+ */
+
+#define LZ4_HASH_LOG       12u
+#define LZ4_WORKMEM_SIZE   ((1u << LZ4_HASH_LOG) * sizeof(uint16_t))
+
+/* Largest input accepted by lz4_compress(); offsets are kept in 16 bits. */
+#define LZ4_MAX_INPUT_SIZE 0xFFFFu
+
+/*
+ * Compress `len` bytes from `src` into `dst`.
+ *
+ * `workmem` must point to LZ4_WORKMEM_SIZE bytes of scratch space; its
+ * previous contents are irrelevant.
+ *
+ * Returns the compressed size, or 0 if the result does not fit in `cap`
+ * bytes. Callers use a `cap` below the input size to reject pages that do
+ * not compress well enough to be worth storing.
+ */
+uint32_t lz4_compress(
+    const void* src, uint32_t len,
+    void* dst, uint32_t cap,
+    void* workmem
+);
+
+/*
+ * Decompress a block of `len` bytes into `dst`.
+ *
+ * Returns the number of bytes produced, or -1 if the block is malformed or
+ * would overflow `cap`.
+ */
+int lz4_decompress(const void* src, uint32_t len, void* dst, uint32_t cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,7 +23,7 @@ extern "C" {
 #define MT_NODE_RANGE  1u
 
 typedef struct ma_node {
-    uint32_t parent;
+    uintptr_t parent;
     union {
         struct {
             uint32_t pivots[MT_PIVOT_COUNT];
@@ -86,7 +86,7 @@ ___inline void* mt_slot_to_entry(void* ptr) {
 }
 
 ___inline void* mt_entry_to_slot(void* entry) {
-    return (void*)((uintptr_t)entry & ~1u);
+    return (void*)((uintptr_t)entry & ~(uintptr_t)1u);
 }
 
 ___inline int ma_node_is_leaf(const ma_node_t* node) {
@@ -98,21 +98,21 @@ ___inline int ma_node_is_range(const ma_node_t* node) {
 }
 
 ___inline ma_node_t* ma_parent(const ma_node_t* node) {
-    return (ma_node_t*)(node->parent & ~0x1Fu);
+    return (ma_node_t*)(node->parent & ~(uintptr_t)0x1Fu);
 }
 
 ___inline uint32_t ma_parent_slot(const ma_node_t* node) {
-    return (node->parent >> 1u) & 0x0Fu;
+    return (uint32_t)(node->parent >> 1u) & 0x0Fu;
 }
 
 ___inline void ma_set_parent(ma_node_t* node, ma_node_t* parent, uint8_t slot) {
-    uint32_t type_bit = node->parent & 1u;
+    uintptr_t type_bit = node->parent & 1u;
 
-    node->parent = ((uint32_t)parent & ~0x1Fu) | type_bit | (((uint32_t)slot & 0x0Fu) << 1u);
+    node->parent = ((uintptr_t)parent & ~(uintptr_t)0x1Fu) | type_bit | (((uintptr_t)slot & 0x0Fu) << 1u);
 }
 
 ___inline void ma_set_type(ma_node_t* node, uint32_t type) {
-    node->parent = (node->parent & ~1u) | (type & 1u);
+    node->parent = (node->parent & ~(uintptr_t)1u) | (type & 1u);
 }
 
 ___inline uint32_t ma_pivot(const ma_node_t* node, uint8_t idx) {
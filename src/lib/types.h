@@ -10,4 +10,11 @@
 typedef int32_t  ssize_t;
 typedef int32_t  off_t;
 
+/* Physical addresses may lie above 4 GiB only with PAE paging. */
+#ifdef KERNEL_PAE
+typedef uint64_t phys_addr_t;
+#else
+typedef uint32_t phys_addr_t;
+#endif
+
 #endif
\ No newline at end of file
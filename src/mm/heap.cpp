@@ -42,8 +42,13 @@ static constexpr uint32_t compute_reciprocal(uint32_t divisor) noexcept {
  * Kernel heap implementation.
  *
  * This is a hybrid allocator:
- *  - small allocations come from size-segregated caches (SLUB-like)
- *  - large allocations are backed by whole pages from VMM
+ *  - allocations up to 64 KiB come from size-segregated caches (SLUB-like)
+ *  - larger ones are backed by whole pages from VMM
+ *
+ * Caches up to 2 KiB build their slabs from VMM pages. The multi-page
+ * classes above that take one high-order block straight from the PMM and
+ * use it through the permanent low-memory mapping: it is physically
+ * contiguous, needs no page table work and costs no TLB shootdown on free.
  *
  * Ownership and size tracking are stored in per-page metadata:
  *  - for slab objects: page->slab_cache points to the owning cache
@@ -70,6 +75,12 @@ struct KmemCache {
 
     uint32_t pages_per_slab;
 
+    /* Slabs are PMM blocks of this order in the low-memory mapping, not VMM pages. */
+    bool direct;
+    uint32_t slab_order;
+
+    kernel::atomic<uint32_t> slabs;
+
     kernel::SpinLock lock;
 
     struct __cacheline_aligned PerCpuSlab {
@@ -78,6 +89,10 @@ struct KmemCache {
         kernel::atomic<void*> remote_free;
         kernel::atomic<uint32_t> remote_free_count;
 
+        /* Bumped only by the owning CPU with interrupts off; readers sum them racily. */
+        uint32_t allocs;
+        uint32_t frees;
+
         __cacheline_aligned RemoteFreeBatch remote_batches[MAX_CPUS];
     };
 
@@ -90,14 +105,22 @@ struct KmemCache {
 };
 
 constexpr size_t k_malloc_min_size = 8;
-constexpr size_t k_malloc_max_size = 2048;
+constexpr size_t k_malloc_max_size = 65536;
 
 constexpr int k_malloc_shift_low = 3;
-constexpr int k_malloc_shift_high = 11;
+constexpr int k_malloc_shift_high = 16;
 
 constexpr size_t k_cache_count = k_malloc_shift_high - k_malloc_shift_low + 1;
 
+/* Classes above this are backed by high-order PMM blocks. */
+constexpr size_t k_direct_min_size = 4096;
+
+/* Objects a direct slab should hold, and the largest block it may take. */
+constexpr uint32_t k_direct_min_objects = 8;
+constexpr uint32_t k_direct_max_order = 6;
+
 static_assert(k_malloc_shift_low >= 1, "k_malloc_shift_low must be at least 1");
+static_assert(k_direct_max_order <= PMM_MAX_ORDER, "direct slab order exceeds the buddy allocator");
 
 static constexpr uint32_t k_align_default = 0u;
 
@@ -115,23 +138,16 @@ public:
         for (size_t i = 0; i < k_cache_count; i++) {
             KmemCache* c = &caches_[i];
 
-            c->name[0] = 's';
-            c->name[1] = '\0';
+            format_cache_name(*c, size);
 
             c->object_size = size;
             c->reciprocal_size = compute_reciprocal(static_cast<uint32_t>(size));
             c->align = k_align_default;
             c->flags = 0;
 
-            uint32_t pps = 1;
-            
-            if (size > 128 && size <= 512) {
-                pps = 2;
-            } else if (size > 512) {
-                pps = 4;
-            }
+            set_slab_geometry(*c, size >= k_direct_min_size);
 
-            c->pages_per_slab = pps;
+            c->slabs.store(0u);
 
             for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
                 c->cpu_slabs[cpu].page = nullptr;
@@ -139,6 +155,9 @@ public:
                 c->cpu_slabs[cpu].remote_free.store(nullptr);
                 c->cpu_slabs[cpu].remote_free_count.store(0u);
 
+                c->cpu_slabs[cpu].allocs = 0u;
+                c->cpu_slabs[cpu].frees = 0u;
+
                 for (int tgt = 0; tgt < MAX_CPUS; tgt++) {
                     c->cpu_slabs[cpu].remote_batches[tgt].head = nullptr;
                     c->cpu_slabs[cpu].remote_batches[tgt].tail = nullptr;
@@ -230,13 +249,21 @@ public:
                     finish_cpu_slab_full(cache, cpu_index, *page);
                 }
 
+                local.allocs++;
+
                 return obj;
             }
         }
 
         irq_guard.restore();
 
-        return cache_alloc_slowpath(cache, cpu_index);
+        void* obj = cache_alloc_slowpath(cache, cpu_index);
+
+        if (kernel::likely(obj)) {
+            count_slow_alloc(cache);
+        }
+
+        return obj;
     }
 
     void cache_free(KmemCache& cache, void* obj) noexcept {
@@ -297,6 +324,8 @@ public:
             panic("SLUB: invalid object address");
         }
 
+        cache.cpu_slabs[cpu_index].frees++;
+
         const uint32_t owner_tag = page_owner_tag(*page);
         const int owner_cpu = static_cast<int>(owner_tag) - 1;
 
@@ -349,7 +378,12 @@ public:
         if (kernel::likely(size <= k_malloc_max_size)) {
             const int idx = get_cache_index(size);
 
-            return cache_alloc(caches_[idx]);
+            void* obj = cache_alloc(caches_[idx]);
+
+            /* A fragmented buddy can refuse a direct slab while plain pages are still around. */
+            if (kernel::likely(obj) || !caches_[idx].direct) {
+                return obj;
+            }
         }
 
         const uint32_t pages_needed = static_cast<uint32_t>((size + PAGE_SIZE - 1) / PAGE_SIZE);
@@ -389,10 +423,10 @@ public:
         const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
 
         /*
-         * Heap API is only defined for addresses from the kernel heap range.
-         * Foreign pointers are ignored.
+         * Heap API is only defined for addresses from the kernel heap range
+         * and direct slabs. Foreign pointers are ignored.
          */
-        if (kernel::unlikely(!heap_range_contains(addr))) {
+        if (kernel::unlikely(!heap_owns(addr))) {
             return;
         }
 
@@ -530,6 +564,27 @@ public:
         return new_ptr;
     }
 
+    uint32_t read_stats(uint32_t first, yos_slabinfo_t* out, uint32_t max) noexcept {
+        uint32_t n = 0u;
+        uint32_t index = 0u;
+
+        for (size_t i = 0; i < k_cache_count && n < max; i++, index++) {
+            if (index >= first) {
+                fill_cache_stats(caches_[i], out[n++], false);
+            }
+        }
+
+        kernel::SpinLockSafeGuard guard(dynamic_caches_lock_);
+
+        for (KmemCache* it = dynamic_used_head_; it && n < max; it = it->next_dyn, index++) {
+            if (index >= first) {
+                fill_cache_stats(*it, out[n++], true);
+            }
+        }
+
+        return n;
+    }
+
     KmemCache* cache_create(const char* name, size_t size, uint32_t align, uint32_t flags) noexcept {
         if (kernel::unlikely(!name || size == 0u)) {
             return nullptr;
@@ -669,7 +724,7 @@ public:
 
         for (uint32_t i = 0; i < free_pages_count; i++) {
             if (free_pages_virt[i] != 0u) {
-                vmm_->free_pages(reinterpret_cast<void*>(free_pages_virt[i]), cache.pages_per_slab);
+                slab_backing_free(cache, reinterpret_cast<void*>(free_pages_virt[i]));
             }
         }
 
@@ -735,7 +790,7 @@ private:
         }
 
         const uintptr_t header_addr = addr - sizeof(AlignedAllocHeader);
-        if (kernel::unlikely(!heap_range_contains(header_addr))) {
+        if (kernel::unlikely(!heap_owns(header_addr))) {
             return false;
         }
 
@@ -764,7 +819,7 @@ private:
         }
 
         const uintptr_t original_addr = header->original;
-        if (kernel::unlikely(!heap_range_contains(original_addr))) {
+        if (kernel::unlikely(!heap_owns(original_addr))) {
             return false;
         }
 
@@ -854,7 +909,7 @@ private:
          * Build a freelist inside the page.
          * Each free object stores the tagged pointer to the next free object.
          */
-        if (kernel::unlikely(cache.object_size == 0u || cache.object_size > PAGE_SIZE)) {
+        if (kernel::unlikely(cache.object_size == 0u || cache.object_size > cache.pages_per_slab * PAGE_SIZE)) {
             panic("SLUB: invalid object_size in slub_init_page");
         }
 
@@ -1123,7 +1178,7 @@ private:
                 }
             }
 
-            void* new_virt = vmm_->alloc_pages(cache.pages_per_slab);
+            void* new_virt = slab_backing_alloc(cache);
             if (kernel::unlikely(!new_virt)) {
                 return nullptr;
             }
@@ -1136,7 +1191,7 @@ private:
             page_t* new_page = pmm_->phys_to_page(phys);
 
             if (kernel::unlikely(!new_page)) {
-                vmm_->free_pages(new_virt, cache.pages_per_slab);
+                slab_backing_free(cache, new_virt);
                 return nullptr;
             }
 
@@ -1160,6 +1215,8 @@ private:
 
             slub_init_page(cache, *new_page, new_virt);
 
+            cache.slabs.fetch_add(1u, kernel::memory_order::relaxed);
+
             {
                 kernel::SpinLockSafeGuard guard(cache.lock);
 
@@ -1271,7 +1328,9 @@ private:
         }
 
         if (need_free_page) {
-            vmm_->free_pages(reinterpret_cast<void*>(page_virt), cache.pages_per_slab);
+            cache.slabs.fetch_sub(1u, kernel::memory_order::relaxed);
+
+            slab_backing_free(cache, reinterpret_cast<void*>(page_virt));
         }
     }
 
@@ -1283,6 +1342,146 @@ private:
         return v >= start && v < end;
     }
 
+    bool direct_slab_contains(uintptr_t addr) noexcept {
+        /*
+         * Direct slabs live in the identity-mapped low memory, so the address
+         * is the frame. Any page of one, head or tail, points at its cache.
+         */
+        if (addr >= static_cast<uintptr_t>(PMM_LOWMEM_LIMIT)) {
+            return false;
+        }
+
+        page_t* page = pmm_->phys_to_page(static_cast<phys_addr_t>(addr));
+        if (kernel::unlikely(!page)) {
+            return false;
+        }
+
+        const auto* cache = static_cast<const KmemCache*>(page->slab_cache);
+
+        return !is_dynamic_cache(cache) && cache->direct;
+    }
+
+    ___always_inline inline bool heap_owns(uintptr_t addr) noexcept {
+        return heap_range_contains(addr) || direct_slab_contains(addr);
+    }
+
+    void set_slab_geometry(KmemCache& cache, bool direct) noexcept {
+        const size_t size = cache.object_size;
+
+        cache.direct = direct;
+        cache.slab_order = 0u;
+
+        if (!direct) {
+            uint32_t pps = 1;
+
+            if (size > 128 && size <= 512) {
+                pps = 2;
+            } else if (size > 512) {
+                pps = 4;
+            }
+
+            cache.pages_per_slab = pps;
+            return;
+        }
+
+        /* Smallest block holding k_direct_min_objects, unless that gets too big. */
+        uint32_t order = 0u;
+
+        while (order < k_direct_max_order
+               && (static_cast<size_t>(PAGE_SIZE) << order) < size * k_direct_min_objects) {
+            order++;
+        }
+
+        cache.slab_order = order;
+        cache.pages_per_slab = 1u << order;
+    }
+
+    [[nodiscard]] void* slab_backing_alloc(KmemCache& cache) noexcept {
+        if (cache.direct) {
+            return pmm_->alloc_pages(cache.slab_order);
+        }
+
+        return vmm_->alloc_pages(cache.pages_per_slab);
+    }
+
+    void slab_backing_free(KmemCache& cache, void* virt) noexcept {
+        if (cache.direct) {
+            pmm_->free_pages(virt, cache.slab_order);
+        } else {
+            vmm_->free_pages(virt, cache.pages_per_slab);
+        }
+    }
+
+    static void count_slow_alloc(KmemCache& cache) noexcept {
+        /* The slow path ran with interrupts on and may have moved CPUs. */
+        kernel::ScopedIrqDisable irq_guard;
+
+        cpu_t* cpu = cpu_current();
+        if (kernel::likely(cpu && cpu->index >= 0 && cpu->index < MAX_CPUS)) {
+            cache.cpu_slabs[cpu->index].allocs++;
+        }
+    }
+
+    static void format_cache_name(KmemCache& cache, size_t size) noexcept {
+        static const char prefix[] = "kmalloc-";
+
+        char digits[12];
+        size_t n = 0;
+
+        do {
+            digits[n++] = static_cast<char>('0' + size % 10u);
+            size /= 10u;
+        } while (size != 0u && n < sizeof(digits));
+
+        size_t i = 0;
+        for (; i + 1u < sizeof(prefix); i++) {
+            cache.name[i] = prefix[i];
+        }
+
+        while (n != 0u && i + 1u < sizeof(cache.name)) {
+            cache.name[i++] = digits[--n];
+        }
+
+        cache.name[i] = '\0';
+    }
+
+    void fill_cache_stats(const KmemCache& cache, yos_slabinfo_t& out, bool dynamic) const noexcept {
+        memset(&out, 0, sizeof(out));
+
+        for (size_t i = 0; i + 1u < sizeof(out.name) && cache.name[i] != '\0'; i++) {
+            out.name[i] = cache.name[i];
+        }
+
+        uint32_t allocs = 0u;
+        uint32_t frees = 0u;
+
+        for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+            allocs += __atomic_load_n(&cache.cpu_slabs[cpu].allocs, __ATOMIC_RELAXED);
+            frees += __atomic_load_n(&cache.cpu_slabs[cpu].frees, __ATOMIC_RELAXED);
+        }
+
+        const uint32_t slab_bytes = cache.pages_per_slab * PAGE_SIZE;
+
+        out.object_size = static_cast<uint32_t>(cache.object_size);
+        out.objects_per_slab = cache.object_size != 0u
+            ? slab_bytes / static_cast<uint32_t>(cache.object_size)
+            : 0u;
+        out.pages_per_slab = cache.pages_per_slab;
+
+        out.flags = (cache.direct ? YOS_SLABINFO_DIRECT : 0u)
+            | (dynamic ? YOS_SLABINFO_DYNAMIC : 0u);
+
+        out.slabs = cache.slabs.load(kernel::memory_order::relaxed);
+        out.allocs = allocs;
+        out.frees = frees;
+
+        /* Counters move while we sum them; never report more live objects than room. */
+        const uint32_t live = allocs - frees;
+        const uint32_t room = out.slabs * out.objects_per_slab;
+
+        out.active_objects = (live > room) ? room : live;
+    }
+
     ___inline int get_cache_index(size_t size) noexcept {
         /*
          * Round size up to the next power-of-two bucket.
@@ -1386,15 +1585,7 @@ private:
         cache->align = align;
         cache->flags = flags;
 
-        uint32_t pps = 1;
-        
-        if (size > 128 && size <= 512) {
-            pps = 2;
-        } else if (size > 512) {
-            pps = 4;
-        }
-        
-        cache->pages_per_slab = pps;
+        set_slab_geometry(*cache, false);
 
         cache->next_dyn = nullptr;
 
@@ -1423,7 +1614,7 @@ private:
         }
     }
 
-    size_t get_allocated_size(void* ptr, size_t requested_size) const noexcept {
+    size_t get_allocated_size(void* ptr, size_t requested_size) noexcept {
         /*
          * Used by kzalloc() to determine how much memory can safely be zeroed.
          * For slab objects we return cache->object_size.
@@ -1431,7 +1622,7 @@ private:
          */
         const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
 
-        if (kernel::unlikely(!heap_range_contains(addr))) {
+        if (kernel::unlikely(!heap_owns(addr))) {
             return requested_size;
         }
 
@@ -1619,4 +1810,18 @@ int kmem_cache_destroy(kmem_cache_t* cache) {
     return heap->cache_destroy(*reinterpret_cast<KmemCache*>(cache));
 }
 
+uint32_t kmem_cache_read_stats(uint32_t first, yos_slabinfo_t* out, uint32_t max) {
+    if (!out) {
+        return 0;
+    }
+
+    HeapState* heap = heap_state_if_inited();
+
+    if (kernel::unlikely(!heap)) {
+        return 0;
+    }
+
+    return heap->read_stats(first, out, max);
+}
+
 }
@@ -4,6 +4,8 @@
 #ifndef MM_HEAP_H
 #define MM_HEAP_H
 
+#include <yos/slabinfo.h>
+
 #include <stddef.h>
 #include <stdint.h>
 
@@ -14,8 +16,8 @@ extern "C" {
 /*
  * Kernel heap allocator.
  *
- * Small allocations are served from size-segregated caches (SLUB-like).
- * Larger requests are backed by whole pages via VMM.
+ * Allocations up to 64 KiB are served from size-segregated caches
+ * (SLUB-like). Larger requests are backed by whole pages via VMM.
  *
  * Pointers returned here are kernel virtual addresses.
  */
@@ -56,6 +58,12 @@ void kmem_cache_free(kmem_cache_t* cache, void* obj);
 /* Destroy a cache if it has no live objects. Returns 1 on success, 0 otherwise. */
 int kmem_cache_destroy(kmem_cache_t* cache);
 
+/*
+ * Copy statistics of up to `max` caches, starting at cache number `first`,
+ * into `out`. Returns the number of records written.
+ */
+uint32_t kmem_cache_read_stats(uint32_t first, yos_slabinfo_t* out, uint32_t max);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,7 +42,10 @@ static constexpr uint32_t pcp_capacity[k_pcp_max_order + 1] = {256, 128, 64, 32}
 static constexpr uint32_t pcp_refill_batch[k_pcp_max_order + 1] = {32, 16, 8, 4};
 static constexpr uint32_t pcp_drain_batch[k_pcp_max_order + 1] = {128, 64, 32, 16};
 
-static PerCpuPageCache pcp_caches[MAX_CPUS][PMM_ZONE_COUNT]{};
+/* HIGHMEM frames have no pointer form, so only the low zones are cached. */
+static constexpr uint32_t k_pcp_zones = PMM_ZONE_HIGHMEM;
+
+static PerCpuPageCache pcp_caches[MAX_CPUS][k_pcp_zones]{};
 
 static inline uint32_t pcp_cpu_index() {
     cpu_t* cpu = cpu_current();
@@ -204,22 +207,23 @@ void PmmState::init_regions(
      * Size the mem_map by the highest address any AVAILABLE region reaches.
      * This keeps PFN indexing simple and avoids sparse metadata.
      */
-    uint32_t max_end = 0u;
+    uint64_t max_end = 0u;
     for (uint32_t i = 0u; i < region_count; i++) {
         if (regions[i].type != PMM_REGION_AVAILABLE) {
             continue;
         }
 
-        const uint32_t base = regions[i].base;
-        const uint32_t size = regions[i].size;
+        const uint64_t base = regions[i].base;
+        const uint64_t size = regions[i].size;
 
-        if (size == 0u) {
+        if (size == 0u
+            || base >= PMM_MAX_PHYS) {
             continue;
         }
 
-        uint32_t end = base + size;
-        if (end < base) {
-            end = 0xFFFFFFFFu;
+        uint64_t end = base + size;
+        if (end > PMM_MAX_PHYS) {
+            end = PMM_MAX_PHYS;
         }
 
         if (end > max_end) {
@@ -227,30 +231,35 @@ void PmmState::init_regions(
         }
     }
 
-    const uint32_t max_addr = align_down(max_end);
-    total_pages_ = max_addr / PAGE_SIZE;
-    if (total_pages_ == 0u) {
-        return;
-    }
-
     /*
      * Place the page metadata immediately after the kernel image.
      * Treat it as reserved: free_range() must never hand these pages out.
+     * It has to stay inside the identity-mapped low memory, so very large
+     * machines lose whatever the metadata cannot describe.
      */
     const uint32_t mem_map_phys = align_up(kernel_end_addr);
+    const uint64_t map_room = (PMM_LOWMEM_LIMIT > mem_map_phys)
+        ? (PMM_LOWMEM_LIMIT - mem_map_phys) / sizeof(page_t)
+        : 0u;
+
+    uint64_t page_count = max_end >> PAGE_SHIFT;
+    if (page_count > map_room) {
+        page_count = map_room;
+    }
+
+    total_pages_ = static_cast<uint32_t>(page_count);
+    if (total_pages_ == 0u) {
+        return;
+    }
+
+    const uint64_t tracked_end = static_cast<uint64_t>(total_pages_) << PAGE_SHIFT;
+
     mem_map_ = reinterpret_cast<page_t*>(mem_map_phys);
 
     const uint32_t mem_map_size = total_pages_
         * static_cast<uint32_t>(sizeof(page_t));
 
     const uint32_t mem_map_end = align_up(mem_map_phys + mem_map_size);
-    if (mem_map_end < mem_map_phys) {
-        /* mem_map would overflow. */
-        mem_map_ = nullptr;
-        total_pages_ = 0u;
-
-        return;
-    }
 
     memset(mem_map_, 0, mem_map_size);
 
@@ -261,11 +270,11 @@ void PmmState::init_regions(
             continue;
         }
 
-        uint32_t start = align_up(regions[i].base);
-        uint32_t end = align_down(regions[i].base + regions[i].size);
+        uint64_t start = (regions[i].base + PAGE_SIZE - 1u) & ~static_cast<uint64_t>(PAGE_SIZE - 1u);
+        uint64_t end = (regions[i].base + regions[i].size) & ~static_cast<uint64_t>(PAGE_SIZE - 1u);
 
-        if (end <= start) {
-            continue;
+        if (end > tracked_end) {
+            end = tracked_end;
         }
 
         if (start < mem_map_end) {
@@ -277,7 +286,7 @@ void PmmState::init_regions(
             continue;
         }
 
-        free_range(start, end, 0u, reserved, reserved_count);
+        free_range(start, end, reserved, reserved_count);
     }
 }
 
@@ -301,20 +310,20 @@ void* PmmState::alloc_pages(uint32_t order) noexcept {
 }
 
 void* PmmState::alloc_pages_zone(uint32_t order, pmm_zone_t zone) noexcept {
-    if (order <= k_pcp_max_order) {
-        if (kernel::unlikely(zone >= PMM_ZONE_COUNT)) {
-            return nullptr;
-        }
+    if (kernel::unlikely(zone >= k_pcp_zones)) {
+        return nullptr;
+    }
 
+    if (order <= k_pcp_max_order) {
         return pcp_alloc_from_cache(this, zone, order);
     }
 
     SpinLockSafeGuard guard(zones_[zone].lock);
 
-    return alloc_pages_zone_unlocked(order, zone);
+    return lowmem_addr(alloc_block_unlocked(order, zone));
 }
 
-void* PmmState::alloc_pages_zone_unlocked(uint32_t order, pmm_zone_t zone) noexcept {
+page_t* PmmState::alloc_block_unlocked(uint32_t order, pmm_zone_t zone) noexcept {
     if (kernel::unlikely(order > PMM_MAX_ORDER)) {
         return nullptr;
     }
@@ -383,7 +392,7 @@ void* PmmState::alloc_pages_zone_unlocked(uint32_t order, pmm_zone_t zone) noexc
 
     cpu_used_pages_[pcp_cpu_index()] += (1u << order);
 
-    return reinterpret_cast<void*>(page_to_phys(page));
+    return page;
 }
 
 uint32_t PmmState::alloc_pages_order0_batch(pmm_zone_t preferred, void** out, uint32_t cap) noexcept {
@@ -402,7 +411,7 @@ uint32_t PmmState::alloc_pages_batch(
         return 0u;
     }
 
-    if (kernel::unlikely(preferred >= PMM_ZONE_COUNT)) {
+    if (kernel::unlikely(preferred >= k_pcp_zones)) {
         preferred = PMM_ZONE_NORMAL;
     }
 
@@ -415,18 +424,18 @@ uint32_t PmmState::alloc_pages_batch(
     {
         SpinLockSafeGuard guard(zones_[preferred].lock);
         for (; n < cap; n++) {
-            void* p = alloc_pages_zone_unlocked(order, preferred);
-            if (!p) break;
-            out[n] = p;
+            page_t* page = alloc_block_unlocked(order, preferred);
+            if (!page) break;
+            out[n] = lowmem_addr(page);
         }
     }
 
     if (n < cap) {
         SpinLockSafeGuard guard(zones_[fallback].lock);
         for (; n < cap; n++) {
-            void* p = alloc_pages_zone_unlocked(order, fallback);
-            if (!p) break;
-            out[n] = p;
+            page_t* page = alloc_block_unlocked(order, fallback);
+            if (!page) break;
+            out[n] = lowmem_addr(page);
         }
     }
 
@@ -438,8 +447,8 @@ void PmmState::free_pages_batch(uint32_t order, void* const* pages, uint32_t n)
         return;
     }
 
-    void* dma_pages[256] = {};
-    void* normal_pages[256] = {};
+    page_t* dma_pages[256] = {};
+    page_t* normal_pages[256] = {};
 
     uint32_t dma_count = 0u;
     uint32_t normal_count = 0u;
@@ -447,28 +456,28 @@ void PmmState::free_pages_batch(uint32_t order, void* const* pages, uint32_t n)
     for (uint32_t i = 0u; i < n; i++) {
         if (kernel::unlikely(!pages[i])) continue;
 
-        page_t* page = phys_to_page(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pages[i])));
+        page_t* page = phys_to_page(reinterpret_cast<uintptr_t>(pages[i]));
         if (kernel::unlikely(!page)) continue;
 
         const pmm_zone_t zone = zone_for_flags(page->flags);
         if (zone == PMM_ZONE_DMA) {
-            dma_pages[dma_count++] = pages[i];
+            dma_pages[dma_count++] = page;
         } else {
-            normal_pages[normal_count++] = pages[i];
+            normal_pages[normal_count++] = page;
         }
     }
 
     if (dma_count > 0u) {
         SpinLockSafeGuard guard(zones_[PMM_ZONE_DMA].lock);
         for (uint32_t i = 0u; i < dma_count; i++) {
-            free_pages_unlocked(dma_pages[i], order);
+            free_block_unlocked(dma_pages[i], order);
         }
     }
 
     if (normal_count > 0u) {
         SpinLockSafeGuard guard(zones_[PMM_ZONE_NORMAL].lock);
         for (uint32_t i = 0u; i < normal_count; i++) {
-            free_pages_unlocked(normal_pages[i], order);
+            free_block_unlocked(normal_pages[i], order);
         }
     }
 }
@@ -478,38 +487,105 @@ void PmmState::free_pages(void* addr, uint32_t order) noexcept {
         return;
     }
 
-    page_t* page = phys_to_page(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(addr)));
+    page_t* page = phys_to_page(reinterpret_cast<uintptr_t>(addr));
     if (kernel::unlikely(!page)) {
         return;
     }
 
-    if (order <= k_pcp_max_order) {
+    const pmm_zone_t zone = zone_for_flags(page->flags);
+
+    if (order <= k_pcp_max_order
+        && zone < k_pcp_zones) {
         if (kernel::unlikely((page->flags & PMM_FLAG_KERNEL) != 0u || (page->flags & PMM_FLAG_USED) == 0u)) {
             return;
         }
 
-        const pmm_zone_t zone = zone_for_flags(page->flags);
-
         pcp_free_to_cache(this, zone, order, addr);
         
         return;
     }
 
+    SpinLockSafeGuard guard(zones_[zone].lock);
+
+    free_block_unlocked(page, order);
+}
+
+void* PmmState::alloc_block_nocache() noexcept {
+    SpinLockSafeGuard guard(zones_[PMM_ZONE_NORMAL].lock);
+
+    return lowmem_addr(alloc_block_unlocked(0u, PMM_ZONE_NORMAL));
+}
+
+void PmmState::free_block_nocache(void* addr) noexcept {
+    if (kernel::unlikely(!addr)) {
+        return;
+    }
+
+    page_t* page = phys_to_page(reinterpret_cast<uintptr_t>(addr));
+    if (kernel::unlikely(!page)) {
+        return;
+    }
+
+    const pmm_zone_t zone = zone_for_flags(page->flags);
+
+    SpinLockSafeGuard guard(zones_[zone].lock);
+
+    free_block_unlocked(page, 0u);
+}
+
+page_t* PmmState::alloc_page_high() noexcept {
+    SpinLockSafeGuard guard(zones_[PMM_ZONE_HIGHMEM].lock);
+
+    return alloc_block_unlocked(0u, PMM_ZONE_HIGHMEM);
+}
+
+void PmmState::free_page(page_t* page) noexcept {
+    if (kernel::unlikely(!page)) {
+        return;
+    }
+
     const pmm_zone_t zone = zone_for_flags(page->flags);
 
+    if (zone < k_pcp_zones) {
+        free_pages(lowmem_addr(page), 0u);
+
+        return;
+    }
+
     SpinLockSafeGuard guard(zones_[zone].lock);
 
-    free_pages_unlocked(addr, order);
+    free_block_unlocked(page, 0u);
 }
 
-page_t* PmmState::phys_to_page(uint32_t phys_addr) noexcept {
-    const uint32_t idx = phys_addr / PAGE_SIZE;
+void PmmState::split_pages(void* addr, uint32_t order) noexcept {
+    if (kernel::unlikely(!addr || order == 0u || order > PMM_MAX_ORDER)) {
+        return;
+    }
+
+    page_t* head = phys_to_page(reinterpret_cast<uintptr_t>(addr));
+    if (kernel::unlikely(!head || (head->flags & PMM_FLAG_USED) == 0u)) {
+        return;
+    }
+
+    const pmm_zone_t zone = zone_for_flags(head->flags);
+    const uint32_t count = 1u << order;
+
+    /* Tail pages never went through the allocator; give them head state. */
+    for (uint32_t i = 0u; i < count; i++) {
+        pcp_fix_shattered_page_metadata(head[i], zone);
+
+        head[i].order = 0u;
+    }
+}
+
+page_t* PmmState::phys_to_page(phys_addr_t phys_addr) noexcept {
+    const phys_addr_t idx = phys_addr >> PAGE_SHIFT;
 
     if (kernel::unlikely(idx >= total_pages_)) {
         return nullptr;
     }
 
-    return &mem_map_[idx];
+    return &mem_map_[static_cast<uint32_t>(idx)];
 }
 
 uint32_t PmmState::page_to_phys(page_t* page) const noexcept {
@@ -518,6 +594,18 @@ uint32_t PmmState::page_to_phys(page_t* page) const noexcept {
     return idx * PAGE_SIZE;
 }
 
+uint32_t PmmState::page_to_pfn(const page_t* page) const noexcept {
+    return static_cast<uint32_t>(page - mem_map_);
+}
+
+void* PmmState::lowmem_addr(page_t* page) const noexcept {
+    if (!page) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<void*>(page_to_phys(page));
+}
+
 uint32_t PmmState::get_used_blocks() const noexcept {
     uint32_t total = 0u;
     for (uint32_t i = 0u; i < MAX_CPUS; i++) {
@@ -548,7 +636,7 @@ void PmmState::init_used_pages(uint32_t total_pages, uint32_t kernel_end_addr) n
     const uint32_t kernel_end = align_up(kernel_end_addr);
 
     for (uint32_t i = 0u; i < total_pages; i++) {
-        const uint32_t addr = i * PAGE_SIZE;
+        const uint64_t addr = static_cast<uint64_t>(i) << PAGE_SHIFT;
         page_t& page = mem_map_[i];
 
         page.flags = PMM_FLAG_USED | zone_flags_for_addr(addr);
@@ -569,65 +657,32 @@ void PmmState::init_used_pages(uint32_t total_pages, uint32_t kernel_end_addr) n
 }
 
 void PmmState::free_range(
-    uint32_t start, uint32_t end,
-    uint32_t zone_flags,
+    uint64_t start, uint64_t end,
     const pmm_reserved_region_t* reserved, uint32_t reserved_count
 ) noexcept {
     /*
      * Free the range using the largest blocks that fit.
      * This builds near-optimal initial freelists and avoids early fragmentation
      * that would later amplify buddy split pressure.
+     *
+     * Blocks never straddle a zone boundary: the buddy merge rules compare
+     * zones, so a block spanning two of them would corrupt both freelists.
      */
-    if (end <= start) {
-        return;
-    }
-
-    uint32_t cur = align_up(start);
-    const uint32_t end_aligned = align_down(end);
+    uint64_t cur = start;
 
-    if (end_aligned <= cur) {
-        return;
-    }
-
-    if (zone_flags != 0u
-        && (zone_flags & PMM_FLAG_DMA) == 0u
-        && cur < k_dma_limit) {
-
-        cur = k_dma_limit;
-    }
-
-    while (cur < end_aligned) {
-        if (zone_flags != 0u
-            && (zone_flags & PMM_FLAG_DMA) != 0u
-            && cur >= k_dma_limit) {
-
-            break;
+    while (cur < end) {
+        uint64_t limit = zone_end_for_addr(cur);
+        if (limit > end) {
+            limit = end;
         }
 
         uint32_t max_order = PMM_MAX_ORDER;
         while (max_order > 0u) {
-            const uint32_t block_size = PAGE_SIZE << max_order;
-            const uint32_t block_end = cur + block_size;
-
-            if (block_end < cur
-                || block_end > end_aligned) {
-                max_order--;
-
-                continue;
-            }
-
-            const uint32_t cur_zone_flags = (zone_flags != 0u)
-                ? zone_flags
-                : zone_flags_for_addr(cur);
+            const uint64_t block_size = static_cast<uint64_t>(PAGE_SIZE) << max_order;
+            const uint64_t block_end = cur + block_size;
 
-            if ((cur_zone_flags & PMM_FLAG_DMA) != 0u) {
-                if (block_end > k_dma_limit) {
-                    max_order--;
-
-                    continue;
-                }
-            } else if (cur < k_dma_limit
-                && block_end > k_dma_limit) {
+            if ((cur & (block_size - 1u)) != 0u
+                || block_end > limit) {
                 max_order--;
 
                 continue;
@@ -642,13 +697,7 @@ void PmmState::free_range(
             break;
         }
 
-        const uint32_t block_size = PAGE_SIZE << max_order;
-        const uint32_t block_end = cur + block_size;
-
-        if (block_end <= cur
-            || block_end > end_aligned) {
-            break;
-        }
+        const uint64_t block_end = cur + (static_cast<uint64_t>(PAGE_SIZE) << max_order);
 
         if (range_is_reserved(cur, block_end, reserved, reserved_count)) {
             /*
@@ -660,13 +709,13 @@ void PmmState::free_range(
             continue;
         }
 
-        free_pages_unlocked(reinterpret_cast<void*>(cur), max_order);
+        free_block_unlocked(phys_to_page(cur), max_order);
         cur = block_end;
     }
 }
 
 bool PmmState::range_is_reserved(
-    uint32_t start, uint32_t end,
+    uint64_t start, uint64_t end,
     const pmm_reserved_region_t* reserved,
     uint32_t reserved_count
 ) const noexcept {
@@ -689,13 +738,9 @@ bool PmmState::range_is_reserved(
             continue;
         }
 
-        const uint32_t r_start = align_down(base);
-        uint32_t r_end = base + size;
-
-        if (r_end < base) {
-            r_end = 0xFFFFFFFFu;
-        }
-        r_end = align_up(r_end);
+        const uint64_t r_start = align_down(base);
+        const uint64_t r_end = (static_cast<uint64_t>(base) + size + PAGE_SIZE - 1u)
+            & ~static_cast<uint64_t>(PAGE_SIZE - 1u);
 
         if (r_end <= start) {
             continue;
@@ -711,19 +756,39 @@ bool PmmState::range_is_reserved(
     return false;
 }
 
-uint32_t PmmState::zone_flags_for_addr(uint32_t addr) noexcept {
+uint32_t PmmState::zone_flags_for_addr(uint64_t addr) noexcept {
     if (addr < k_dma_limit) {
         return PMM_FLAG_DMA;
     }
 
+    if (addr >= PMM_LOWMEM_LIMIT) {
+        return PMM_FLAG_HIGHMEM;
+    }
+
     return 0u;
 }
 
+uint64_t PmmState::zone_end_for_addr(uint64_t addr) noexcept {
+    if (addr < k_dma_limit) {
+        return k_dma_limit;
+    }
+
+    if (addr < PMM_LOWMEM_LIMIT) {
+        return PMM_LOWMEM_LIMIT;
+    }
+
+    return PMM_MAX_PHYS;
+}
+
 pmm_zone_t PmmState::zone_for_flags(uint32_t flags) noexcept {
     if ((flags & PMM_FLAG_DMA) != 0u) {
         return PMM_ZONE_DMA;
     }
 
+    if ((flags & PMM_FLAG_HIGHMEM) != 0u) {
+        return PMM_ZONE_HIGHMEM;
+    }
+
     return PMM_ZONE_NORMAL;
 }
 
@@ -800,9 +865,7 @@ void PmmState::free_area_remove(pmm_zone_t zone, uint32_t order, page_t* page) n
     }
 }
 
-void PmmState::free_pages_unlocked(void* addr, uint32_t order) noexcept {
-    page_t* page = phys_to_page(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(addr)));
-
+void PmmState::free_block_unlocked(page_t* page, uint32_t order) noexcept {
     if (!page) {
         return;
     }
@@ -905,7 +968,7 @@ void pmm_drain_local_pcp_caches(void) {
         return;
     }
 
-    for (uint32_t zone = 0; zone < PMM_ZONE_COUNT; zone++) {
+    for (uint32_t zone = 0; zone < kernel::k_pcp_zones; zone++) {
         auto& cache = kernel::pcp_caches[cpu][zone];
 
         for (uint32_t order = 0; order <= kernel::k_pcp_max_order; order++) {
@@ -924,6 +987,9 @@ void pmm_drain_local_pcp_caches(void) {
 
 static size_t pcp_shrinker_cb(size_t target_pages, void* ctx) {
     (void)ctx;
+    (void)target_pages;
+
+    const uint32_t free_before = pmm_get_free_blocks();
     
     cpu_t* me = cpu_current();
     uint32_t mask = 0;
@@ -949,7 +1015,13 @@ static size_t pcp_shrinker_cb(size_t target_pages, void* ctx) {
         cpu_relax();
     }
 
-    return target_pages; 
+    /*
+     * Report what actually reached the buddy allocator, so shrinkers behind
+     * this one still run when draining the caches was not enough.
+     */
+    const uint32_t free_after = pmm_get_free_blocks();
+
+    return (free_after > free_before) ? (free_after - free_before) : 0u;
 }
 
 static shrinker_t g_pcp_shrinker = {
@@ -1012,6 +1084,16 @@ void pmm_free_pages(void* addr, uint32_t order) {
     pmm->free_pages(addr, order);
 }
 
+void pmm_split_pages(void* addr, uint32_t order) {
+    kernel::PmmState* pmm = kernel::pmm_state();
+
+    if (kernel::unlikely(!pmm)) {
+        return;
+    }
+
+    pmm->split_pages(addr, order);
+}
+
 void* pmm_alloc_block(void) {
     return pmm_alloc_pages(0u);
 }
@@ -1020,6 +1102,26 @@ void pmm_free_block(void* addr) {
     pmm_free_pages(addr, 0u);
 }
 
+void* pmm_alloc_block_nocache(void) {
+    kernel::PmmState* pmm = kernel::pmm_state();
+
+    if (kernel::unlikely(!pmm)) {
+        return nullptr;
+    }
+
+    return pmm->alloc_block_nocache();
+}
+
+void pmm_free_block_nocache(void* addr) {
+    kernel::PmmState* pmm = kernel::pmm_state();
+
+    if (kernel::unlikely(!pmm)) {
+        return;
+    }
+
+    pmm->free_block_nocache(addr);
+}
+
 static void pmm_free_block_rcu_cb(rcu_head_t* head) {
     if (!head) {
         return;
@@ -1027,9 +1129,7 @@ static void pmm_free_block_rcu_cb(rcu_head_t* head) {
 
     page_t* page = container_of(head, page_t, rcu);
 
-    void* phys_addr = (void*)(uintptr_t)kernel::pmm_state()->page_to_phys(page);
-
-    kernel::pmm_state()->free_pages(phys_addr, 0u);
+    kernel::pmm_state()->free_page(page);
 }
 
 void pmm_free_block_deferred(void* addr) {
@@ -1037,24 +1137,56 @@ void pmm_free_block_deferred(void* addr) {
         return;
     }
 
-    page_t* page = kernel::pmm_state()->phys_to_page(
-        (uint32_t)(uintptr_t)addr
-    );
+    pmm_free_phys_deferred((uintptr_t)addr);
+}
+
+phys_addr_t pmm_alloc_page_user(void) {
+    kernel::PmmState* pmm = kernel::pmm_state();
+
+    if (kernel::unlikely(!pmm)) {
+        return 0u;
+    }
+
+    page_t* page = pmm->alloc_page_high();
+    if (page) {
+        return (phys_addr_t)pmm->page_to_pfn(page) << PAGE_SHIFT;
+    }
+
+    return (uintptr_t)pmm->alloc_pages(0u);
+}
+
+void pmm_free_phys(phys_addr_t phys) {
+    kernel::PmmState* pmm = kernel::pmm_state();
+
+    if (kernel::unlikely(!pmm || phys == 0u)) {
+        return;
+    }
+
+    pmm->free_page(pmm->phys_to_page(phys));
+}
+
+void pmm_free_phys_deferred(phys_addr_t phys) {
+    kernel::PmmState* pmm = kernel::pmm_state();
+
+    if (kernel::unlikely(!pmm || phys == 0u)) {
+        return;
+    }
+
+    page_t* page = pmm->phys_to_page(phys);
 
     if (!page) {
-        pmm_free_block(addr);
         return;
     }
 
     if ((page->flags & PMM_FLAG_KERNEL) != 0u) {
-        pmm_free_block(addr);
+        pmm->free_page(page);
         return;
     }
 
     call_rcu(&page->rcu, pmm_free_block_rcu_cb);
 }
 
-page_t* pmm_phys_to_page(uint32_t phys_addr) {
+page_t* pmm_phys_to_page(phys_addr_t phys_addr) {
     kernel::PmmState* pmm = kernel::pmm_state();
 
     if (kernel::unlikely(!pmm)) {
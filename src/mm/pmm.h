@@ -14,6 +14,8 @@
 
 #include <kernel/rcu.h>
 
+#include <lib/types.h>
+
 #include <stdint.h>
 #include <stddef.h>
 
@@ -27,21 +29,42 @@
  */
 #define PMM_MAX_ORDER 11
 
+/*
+ * RAM below this address is permanently identity-mapped and can be handed
+ * out as a plain pointer. User space starts right above it.
+ */
+#define PMM_LOWMEM_LIMIT 0x40000000u
+
+/*
+ * Highest physical address tracked. mem_map lives in low memory, so this is
+ * bounded by what its metadata may cost (32 bytes per 4KiB frame).
+ */
+#ifdef KERNEL_PAE
+#define PMM_MAX_PHYS (16ull << 30)
+#else
+#define PMM_MAX_PHYS (4ull << 30)
+#endif
+
 typedef enum {
     PMM_FLAG_FREE     = 0,
     PMM_FLAG_USED     = (1u << 0),
     PMM_FLAG_KERNEL   = (1u << 1),
     PMM_FLAG_DMA      = (1u << 2),
+    PMM_FLAG_HIGHMEM  = (1u << 3),
 } page_flags_t;
 
 /*
  * Split low DMA-addressable memory from the rest.
  * This is a contention win: independent zones can make progress in parallel.
+ *
+ * HIGHMEM holds frames above PMM_LOWMEM_LIMIT. They have no permanent kernel
+ * mapping and are only reachable through pmm_alloc_page_user().
  */
 typedef enum {
     PMM_ZONE_DMA = 0,
     PMM_ZONE_NORMAL = 1,
-    PMM_ZONE_COUNT = 2,
+    PMM_ZONE_HIGHMEM = 2,
+    PMM_ZONE_COUNT = 3,
 } pmm_zone_t;
 
 typedef enum {
@@ -50,8 +73,8 @@ typedef enum {
 } pmm_region_type_t;
 
 typedef struct {
-    uint32_t base;
-    uint32_t size;
+    uint64_t base;
+    uint64_t size;
     uint32_t type;
 } pmm_region_t;
 
@@ -147,6 +170,19 @@ public:
 
     void free_pages(void* addr, uint32_t order) noexcept;
 
+    /*
+     * Order-0 frames straight from the NORMAL zone buddy lists, skipping the
+     * per-CPU caches. Only meant for measuring what those caches save.
+     */
+    [[nodiscard]] void* alloc_block_nocache() noexcept;
+    void free_block_nocache(void* addr) noexcept;
+
+    /*
+     * Turn an allocated high-order block into independent order-0 pages.
+     * Used when a huge mapping is broken up and its frames get freed one by one.
+     */
+    void split_pages(void* addr, uint32_t order) noexcept;
+
     [[nodiscard]] uint32_t alloc_pages_batch(
         uint32_t order,
         pmm_zone_t preferred,
@@ -155,8 +191,16 @@ public:
 
     void free_pages_batch(uint32_t order, void* const* pages, uint32_t n) noexcept;
 
-    [[nodiscard]] page_t* phys_to_page(uint32_t phys_addr) noexcept;
+    /*
+     * Order-0 frames that may live in HIGHMEM. Callers only get a page_t and
+     * must go through a temporary mapping to touch the contents.
+     */
+    [[nodiscard]] page_t* alloc_page_high() noexcept;
+    void free_page(page_t* page) noexcept;
+
+    [[nodiscard]] page_t* phys_to_page(phys_addr_t phys_addr) noexcept;
     [[nodiscard]] uint32_t page_to_phys(page_t* page) const noexcept;
+    [[nodiscard]] uint32_t page_to_pfn(const page_t* page) const noexcept;
 
     [[nodiscard]] uint32_t get_used_blocks() const noexcept;
     [[nodiscard]] uint32_t get_free_blocks() const noexcept;
@@ -169,28 +213,30 @@ private:
     static void list_add(page_t** head, page_t* page) noexcept;
     static void list_remove(page_t** head, page_t* page) noexcept;
 
-    [[nodiscard]] void* alloc_pages_zone_unlocked(uint32_t order, pmm_zone_t zone) noexcept;
+    [[nodiscard]] page_t* alloc_block_unlocked(uint32_t order, pmm_zone_t zone) noexcept;
 
     void free_area_push(pmm_zone_t zone, uint32_t order, page_t* page) noexcept;
     [[nodiscard]] page_t* free_area_pop(pmm_zone_t zone, uint32_t order) noexcept;
     void free_area_remove(pmm_zone_t zone, uint32_t order, page_t* page) noexcept;
 
-    void free_pages_unlocked(void* addr, uint32_t order) noexcept;
+    void free_block_unlocked(page_t* page, uint32_t order) noexcept;
+
+    [[nodiscard]] void* lowmem_addr(page_t* page) const noexcept;
 
     void init_used_pages(uint32_t total_pages, uint32_t kernel_end_addr) noexcept;
 
     void free_range(
-        uint32_t start, uint32_t end,
-        uint32_t zone_flags,
+        uint64_t start, uint64_t end,
         const pmm_reserved_region_t* reserved, uint32_t reserved_count
     ) noexcept;
 
     bool range_is_reserved(
-        uint32_t start, uint32_t end,
+        uint64_t start, uint64_t end,
         const pmm_reserved_region_t* reserved, uint32_t reserved_count
     ) const noexcept;
 
-    static uint32_t zone_flags_for_addr(uint32_t addr) noexcept;
+    static uint32_t zone_flags_for_addr(uint64_t addr) noexcept;
+    static uint64_t zone_end_for_addr(uint64_t addr) noexcept;
     static pmm_zone_t zone_for_flags(uint32_t flags) noexcept;
 
     page_t* mem_map_ = nullptr;
@@ -242,11 +288,26 @@ void* pmm_alloc_block(void);
 void pmm_free_block(void* addr);
 void pmm_free_block_deferred(void* addr);
 
+/* Order-0 allocation that bypasses the per-CPU caches; for benchmarks. */
+void* pmm_alloc_block_nocache(void);
+void pmm_free_block_nocache(void* addr);
+
 void* pmm_alloc_pages(uint32_t order);
 void* pmm_alloc_pages_zone(uint32_t order, pmm_zone_t zone);
 void pmm_free_pages(void* addr, uint32_t order);
+void pmm_split_pages(void* addr, uint32_t order);
+
+/*
+ * User frames: prefer HIGHMEM, fall back to low memory. Returns 0 when out
+ * of memory. The result may not be dereferenced; see paging_kmap_atomic().
+ */
+phys_addr_t pmm_alloc_page_user(void);
+
+/* Free an order-0 frame from any zone, immediately or after an RCU period. */
+void pmm_free_phys(phys_addr_t phys);
+void pmm_free_phys_deferred(phys_addr_t phys);
 
-page_t* pmm_phys_to_page(uint32_t phys_addr);
+page_t* pmm_phys_to_page(phys_addr_t phys_addr);
 uint32_t pmm_page_to_phys(page_t* page);
 
 uint32_t pmm_get_used_blocks(void);
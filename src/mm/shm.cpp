@@ -2,8 +2,8 @@
 // Copyright (C) 2026 Yula1234
 
 #include <lib/cpp/intrusive_ref.h>
-#include <lib/cpp/unique_ptr.h>
 #include <lib/cpp/atomic.h>
+#include <lib/cpp/mutex.h>
 #include <lib/cpp/string.h>
 #include <lib/cpp/new.h>
 
@@ -17,68 +17,46 @@
 
 #include <fs/vfs.h>
 
+#include <yos/ioctl.h>
+
 namespace kernel {
 namespace shm {
 
 static constexpr uint32_t k_page_size = 4096u;
 static constexpr uint32_t k_name_max_len = 31u;
 
+/*
+ * Pages are allocated on first use. A huge-page-sized chunk that lies
+ * entirely inside the object when it is first touched is backed by one
+ * PAGING_HUGE_ORDER block, so that faults can map it with a single PDE;
+ * everything else, and any chunk a huge block could not be found for,
+ * gets 4K pages.
+ *
+ * The page table only ever grows. A table outgrown by resize() is kept
+ * until the object dies, so lookups and phys_pages() users need no lock.
+ * Shrinking keeps the pages past the new size: mappings that reached them
+ * still point there. They are zeroed when a later resize exposes them again.
+ */
 class ShmObject {
 public:
     static kernel::IntrusiveRef<ShmObject> create(uint32_t size) {
-        if (size == 0u) {
-            return {};
-        }
-
-        const uint32_t page_count = (size + (k_page_size - 1u)) / k_page_size;
-
-        if (page_count == 0u) {
+        if (size == 0u || size > k_size_max) {
             return {};
         }
 
-        const size_t pages_align = alignof(uint32_t);
-        const size_t pages_off = (sizeof(ShmObject) + pages_align - 1u)
-            & ~(pages_align - 1u);
-        const size_t alloc_size = pages_off + sizeof(uint32_t) * (size_t)page_count;
-
-        void* raw = ::operator new(alloc_size, kernel::nothrow);
-
-        if (!raw) {
-            return {};
-        }
-
-        struct ObjectDeleter {
-            void operator()(ShmObject* p) const noexcept {
-                if (!p) {
-                    return;
-                }
-
-                p->~ShmObject();
-                ::operator delete(p);
-            }
-        };
-
-        uint32_t* pages = (uint32_t*)((unsigned char*)raw + pages_off);
-        memset(pages, 0, sizeof(uint32_t) * (size_t)page_count);
-
-        kernel::unique_ptr<ShmObject, ObjectDeleter> obj(
-            new (raw) ShmObject(
-                size,
-                page_count,
-                pages
-            )
-        );
+        ShmObject* obj = new (kernel::nothrow) ShmObject(size);
 
         if (!obj) {
-            ::operator delete(raw);
             return {};
         }
 
-        if (!obj->allocate_phys_pages()) {
+        kernel::IntrusiveRef<ShmObject> ref = kernel::IntrusiveRef<ShmObject>::adopt(obj);
+
+        if (!obj->grow_table(page_count_for(size))) {
             return {};
         }
 
-        return kernel::IntrusiveRef<ShmObject>::adopt(obj.release());
+        return ref;
     }
 
     ShmObject(const ShmObject&) = delete;
@@ -100,118 +78,293 @@ public:
     }
 
     uint32_t size() const {
-        return size_;
+        return size_.load(kernel::memory_order::acquire);
     }
 
-    bool get_phys_pages(const uint32_t*& out_pages, uint32_t& out_page_count) const {
-        out_pages = pages_;
-        out_page_count = page_count_;
+    /* Frame backing `offset`, allocated if need be; 0 past the end or without memory. */
+    uint32_t phys_page(uint32_t offset) {
+        const uint32_t idx = offset / k_page_size;
 
-        return out_pages && out_page_count != 0u;
-    }
+        if (idx >= page_count_for(size())) {
+            return 0u;
+        }
 
-private:
-    ShmObject(uint32_t size, uint32_t page_count, uint32_t* pages)
-        : size_(size),
-          page_count_(page_count),
-          pages_(pages) {
+        const uint32_t phys = peek_page(idx);
+
+        if (phys != 0u) {
+            return phys;
+        }
+
+        kernel::MutexGuard guard(lock_);
+
+        return populate(idx);
     }
 
-    ~ShmObject() {
-        if (!pages_) {
-            return;
+    /*
+     * Base of the huge block behind the chunk starting at `offset`, which
+     * must be chunk-aligned, or 0 when that chunk is (or has to be) backed
+     * by 4K pages.
+     */
+    uint32_t phys_huge(uint32_t offset) {
+        if ((offset & PAGING_HUGE_MASK) != 0u) {
+            return 0u;
         }
 
-        for (uint32_t i = 0; i < page_count_; i++) {
-            const uint32_t phys = pages_[i];
+        const uint32_t first = offset / k_page_size;
 
-            if (phys != 0u) {
-                pmm_free_block((void*)phys);
-            }
+        if (first + PAGING_HUGE_PAGES > page_count_for(size())) {
+            return 0u;
+        }
+
+        kernel::MutexGuard guard(lock_);
+
+        const PageTable* t = table_.load(kernel::memory_order::relaxed);
+        const uint32_t c = first / PAGING_HUGE_PAGES;
+
+        if (t->chunk[c] == k_chunk_empty) {
+            (void)populate(first);
         }
+
+        return t->chunk[c] == k_chunk_huge ? t->pages[first] : 0u;
     }
 
-    bool allocate_phys_pages() {
-        class PhysPagesBuilder {
-        public:
-            PhysPagesBuilder(uint32_t* pages, uint32_t page_count)
-                : pages_(pages),
-                  capacity_(page_count) {
+    /* Populate the whole object; the array stays valid for as long as the object. */
+    bool get_phys_pages(const uint32_t*& out_pages, uint32_t& out_page_count) {
+        out_pages = nullptr;
+        out_page_count = 0u;
+
+        kernel::MutexGuard guard(lock_);
+
+        const uint32_t count = page_count_for(size());
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (!populate(i)) {
+                return false;
             }
+        }
 
-            PhysPagesBuilder(const PhysPagesBuilder&) = delete;
-            PhysPagesBuilder& operator=(const PhysPagesBuilder&) = delete;
+        out_pages = table_.load(kernel::memory_order::relaxed)->pages;
+        out_page_count = count;
 
-            PhysPagesBuilder(PhysPagesBuilder&&) = delete;
-            PhysPagesBuilder& operator=(PhysPagesBuilder&&) = delete;
+        return true;
+    }
 
-            ~PhysPagesBuilder() {
-                if (committed_) {
-                    return;
-                }
+    bool resize(uint32_t new_size) {
+        if (new_size == 0u || new_size > k_size_max) {
+            return false;
+        }
 
-                if (!pages_) {
-                    return;
-                }
+        kernel::MutexGuard guard(lock_);
 
-                for (uint32_t i = 0; i < allocated_; i++) {
-                    const uint32_t phys = pages_[i];
-                    if (phys != 0u) {
-                        pmm_free_block((void*)phys);
-                    }
+        const uint32_t old_size = size();
 
-                    pages_[i] = 0u;
-                }
-            }
+        if (new_size <= old_size) {
+            size_.store(new_size, kernel::memory_order::release);
+            return true;
+        }
 
-            bool allocate_and_append_zeroed_page() {
-                if (!pages_ || allocated_ >= capacity_) {
-                    return false;
-                }
+        const uint32_t new_pages = page_count_for(new_size);
+
+        if (!grow_table(new_pages)) {
+            return false;
+        }
 
-                void* p = pmm_alloc_block();
+        const PageTable* t = table_.load(kernel::memory_order::relaxed);
 
-                if (!p) {
-                    return false;
-                }
+        /* What an earlier shrink hid may have been written since: hand it back zeroed. */
+        const uint32_t tail = old_size % k_page_size;
+        uint32_t idx = old_size / k_page_size;
 
-                paging_zero_phys_page((uint32_t)p);
+        if (tail != 0u) {
+            if (t->pages[idx] != 0u) {
+                void* va = paging_kmap_atomic(t->pages[idx]);
 
-                pages_[allocated_] = (uint32_t)p;
-                allocated_++;
+                memset((unsigned char*)va + tail, 0, k_page_size - tail);
 
-                return true;
+                paging_kunmap_atomic(va);
             }
 
-            void commit() {
-                committed_ = true;
+            idx++;
+        }
+
+        for (; idx < new_pages; idx++) {
+            if (t->pages[idx] != 0u) {
+                paging_zero_phys_page(t->pages[idx]);
             }
+        }
+
+        size_.store(new_size, kernel::memory_order::release);
+
+        return true;
+    }
 
-        private:
-            uint32_t* pages_ = nullptr;
-            uint32_t capacity_ = 0u;
-            uint32_t allocated_ = 0u;
-            bool committed_ = false;
-        };
+private:
+    static constexpr uint32_t k_size_max = 0xFFFFFFFFu - (k_page_size - 1u);
 
-        PhysPagesBuilder builder(pages_, page_count_);
+    static constexpr uint8_t k_chunk_empty = 0u;
+    static constexpr uint8_t k_chunk_huge = 1u;
+    static constexpr uint8_t k_chunk_small = 2u;
 
-        for (uint32_t i = 0; i < page_count_; i++) {
-            if (!builder.allocate_and_append_zeroed_page()) {
-                return false;
+    struct PageTable {
+        PageTable* retired;
+
+        uint32_t capacity;
+
+        uint32_t* pages;
+        uint8_t* chunk;
+    };
+
+    static uint32_t page_count_for(uint32_t size) {
+        return (uint32_t)(((uint64_t)size + (k_page_size - 1u)) / k_page_size);
+    }
+
+    static uint32_t chunk_count_for(uint32_t page_count) {
+        return (page_count + (PAGING_HUGE_PAGES - 1u)) / PAGING_HUGE_PAGES;
+    }
+
+    static PageTable* alloc_table(uint32_t capacity) {
+        const uint32_t chunks = chunk_count_for(capacity);
+
+        const size_t pages_off = sizeof(PageTable);
+        const size_t chunk_off = pages_off + sizeof(uint32_t) * (size_t)capacity;
+        const size_t alloc_size = chunk_off + (size_t)chunks;
+
+        void* raw = ::operator new(alloc_size, kernel::nothrow);
+
+        if (!raw) {
+            return nullptr;
+        }
+
+        memset(raw, 0, alloc_size);
+
+        auto* t = (PageTable*)raw;
+
+        t->capacity = capacity;
+        t->pages = (uint32_t*)((unsigned char*)raw + pages_off);
+        t->chunk = (uint8_t*)raw + chunk_off;
+
+        return t;
+    }
+
+    explicit ShmObject(uint32_t size)
+        : size_(size) {
+    }
+
+    ~ShmObject() {
+        PageTable* t = table_.load(kernel::memory_order::relaxed);
+
+        if (t) {
+            free_frames(t);
+        }
+
+        while (t) {
+            PageTable* next = t->retired;
+
+            ::operator delete(t);
+
+            t = next;
+        }
+    }
+
+    static void free_frames(const PageTable* t) {
+        for (uint32_t i = 0; i < t->capacity; i++) {
+            const uint32_t phys = t->pages[i];
+
+            if (phys == 0u) {
+                continue;
             }
+
+            if (t->chunk[i / PAGING_HUGE_PAGES] == k_chunk_huge) {
+                pmm_free_pages((void*)phys, PAGING_HUGE_ORDER);
+                i += PAGING_HUGE_PAGES - 1u;
+                continue;
+            }
+
+            pmm_free_block((void*)phys);
         }
+    }
 
-        builder.commit();
+    uint32_t peek_page(uint32_t idx) const {
+        const PageTable* t = table_.load(kernel::memory_order::acquire);
+
+        return __atomic_load_n(&t->pages[idx], __ATOMIC_ACQUIRE);
+    }
+
+    bool grow_table(uint32_t page_count) {
+        PageTable* old = table_.load(kernel::memory_order::relaxed);
+
+        if (old && old->capacity >= page_count) {
+            return true;
+        }
+
+        PageTable* t = alloc_table(page_count);
+
+        if (!t) {
+            return false;
+        }
+
+        if (old) {
+            memcpy(t->pages, old->pages, sizeof(uint32_t) * (size_t)old->capacity);
+            memcpy(t->chunk, old->chunk, (size_t)chunk_count_for(old->capacity));
+        }
+
+        t->retired = old;
+
+        table_.store(t, kernel::memory_order::release);
 
         return true;
     }
 
+    /* Called with lock_ held. */
+    uint32_t populate(uint32_t idx) {
+        PageTable* t = table_.load(kernel::memory_order::relaxed);
+
+        if (t->pages[idx] != 0u) {
+            return t->pages[idx];
+        }
+
+        const uint32_t c = idx / PAGING_HUGE_PAGES;
+        const uint32_t first = c * PAGING_HUGE_PAGES;
+
+        if (t->chunk[c] == k_chunk_empty
+            && first + PAGING_HUGE_PAGES <= page_count_for(size())) {
+            void* block = pmm_alloc_pages(PAGING_HUGE_ORDER);
+
+            if (block) {
+                for (uint32_t i = 0; i < PAGING_HUGE_PAGES; i++) {
+                    paging_zero_phys_page((uint32_t)block + i * k_page_size);
+                }
+
+                for (uint32_t i = 0; i < PAGING_HUGE_PAGES; i++) {
+                    __atomic_store_n(&t->pages[first + i], (uint32_t)block + i * k_page_size, __ATOMIC_RELEASE);
+                }
+
+                t->chunk[c] = k_chunk_huge;
+
+                return t->pages[idx];
+            }
+        }
+
+        void* p = pmm_alloc_block();
+
+        if (!p) {
+            return 0u;
+        }
+
+        paging_zero_phys_page((uint32_t)p);
+
+        t->chunk[c] = k_chunk_small;
+
+        __atomic_store_n(&t->pages[idx], (uint32_t)p, __ATOMIC_RELEASE);
+
+        return (uint32_t)p;
+    }
+
 private:
-    const uint32_t size_;
+    kernel::atomic<uint32_t> size_;
+    kernel::atomic<PageTable*> table_{nullptr};
 
-    const uint32_t page_count_;
-    uint32_t* const pages_;
+    kernel::Mutex lock_;
 
     kernel::atomic<uint32_t> refcount_{1u};
 };
@@ -521,29 +674,48 @@ static int shm_close(vfs_node_t* node) {
     return 0;
 }
 
-static uint32_t shm_get_phys_page(vfs_node_t* node, uint32_t offset) {
+static ShmObject* node_object(vfs_node_t* node) {
     if (!node || (node->flags & VFS_FLAG_SHM) == 0u) {
-        return 0u;
+        return nullptr;
     }
 
     auto* data = (kernel::shm::ShmNodeData*)node->private_data;
     if (!data || !data->obj) {
-        return 0u;
+        return nullptr;
     }
 
-    const uint32_t* pages = nullptr;
-    uint32_t page_count = 0u;
+    return data->obj.get();
+}
 
-    if (!data->obj->get_phys_pages(pages, page_count) || !pages || page_count == 0u) {
-        return 0u;
-    }
+static uint32_t shm_get_phys_page(vfs_node_t* node, uint32_t offset) {
+    ShmObject* obj = node_object(node);
 
-    const uint32_t page_idx = offset / 4096u;
-    if (page_idx >= page_count) {
-        return 0u;
+    return obj ? obj->phys_page(offset) : 0u;
+}
+
+static int shm_ioctl(vfs_node_t* node, uint32_t req, void* arg) {
+    ShmObject* obj = node_object(node);
+
+    if (!obj || !arg) {
+        return -1;
     }
 
-    return pages[page_idx];
+    switch (req) {
+        case YOS_SHM_GET_SIZE:
+            *(uint32_t*)arg = obj->size();
+            return 0;
+
+        case YOS_SHM_SET_SIZE:
+            if (!obj->resize(*(const uint32_t*)arg)) {
+                return -1;
+            }
+
+            node->size = obj->size();
+            return 0;
+
+        default:
+            return -1;
+    }
 }
 
 static vfs_ops_t shm_ops = {
@@ -551,10 +723,12 @@ static vfs_ops_t shm_ops = {
     .write = shm_write,
     .open = 0,
     .close = shm_close,
-    .ioctl = 0,
+    .ioctl = shm_ioctl,
     .get_phys_page = shm_get_phys_page,
     .poll_status = 0,
     .poll_register = 0,
+    .read_user = 0,
+    .write_user = 0,
 };
 
 }
@@ -593,6 +767,18 @@ int shm_get_phys_pages(struct vfs_node* node, const uint32_t** out_pages, uint32
     return 1;
 }
 
+uint32_t shm_get_phys_huge(struct vfs_node* node, uint32_t offset) {
+    kernel::shm::ShmObject* obj = kernel::shm::node_object(node);
+
+    return obj ? obj->phys_huge(offset) : 0u;
+}
+
+uint32_t shm_node_size(struct vfs_node* node) {
+    kernel::shm::ShmObject* obj = kernel::shm::node_object(node);
+
+    return obj ? obj->size() : 0u;
+}
+
 struct vfs_node* shm_create_node(uint32_t size) {
     auto obj = kernel::shm::ShmObject::create(size);
 
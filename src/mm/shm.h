@@ -22,6 +22,15 @@ int shm_unlink_named(const char* name);
 
 int shm_get_phys_pages(struct vfs_node* node, const uint32_t** out_pages, uint32_t* out_page_count);
 
+/* Current size; other handles learn about YOS_SHM_SET_SIZE through this, not node->size. */
+uint32_t shm_node_size(struct vfs_node* node);
+
+/*
+ * Base of the huge block backing the PAGING_HUGE_SIZE chunk at `offset`
+ * (chunk-aligned), populating it first; 0 if that chunk uses 4K pages.
+ */
+uint32_t shm_get_phys_huge(struct vfs_node* node, uint32_t offset);
+
 #ifdef __cplusplus
 }
 
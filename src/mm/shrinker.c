@@ -45,9 +45,9 @@ void unregister_shrinker(shrinker_t* s) {
     mutex_unlock(&g_shrinker_mutex);
 }
 
-static void run_shrinkers(size_t target_pages) {
+static size_t run_shrinkers(size_t target_pages) {
     if (target_pages == 0) {
-        return;
+        return 0;
     }
 
     mutex_lock(&g_shrinker_mutex);
@@ -67,6 +67,12 @@ static void run_shrinkers(size_t target_pages) {
     }
 
     mutex_unlock(&g_shrinker_mutex);
+
+    return freed;
+}
+
+size_t shrinker_reclaim_direct(size_t target_pages) {
+    return run_shrinkers(target_pages);
 }
 
 static void mshrinker_task_func(void* arg) {
@@ -29,6 +29,12 @@ void shrinker_start_kthread(void);
 void register_shrinker(shrinker_t* s);
 void unregister_shrinker(shrinker_t* s);
 
+/*
+ * Run the shrinkers synchronously on behalf of an allocation that failed.
+ * May sleep. Returns the number of pages reported as freed.
+ */
+size_t shrinker_reclaim_direct(size_t target_pages);
+
 #ifdef __cplusplus
 }
 #endif
@@ -11,6 +11,7 @@
 
 #include <arch/i386/paging.h>
 
+#include <kernel/sched.h>
 #include <kernel/proc.h>
 
 #include <fs/vfs.h>
@@ -26,6 +27,9 @@ constexpr uint32_t user_addr_max = 0xC0000000u;
 constexpr uint32_t user_stack_addr_min = 0x60000000u;
 constexpr uint32_t user_stack_addr_max = 0x80000000u;
 
+constexpr uint32_t fault_around_default = 8u;
+constexpr uint32_t fault_around_max = 64u;
+
 static kmem_cache_t* g_vma_region_cache = nullptr;
 
 ___inline uint32_t align_down_4k(uint32_t v) noexcept {
@@ -57,6 +61,86 @@ static void free_region_rcu_cb(rcu_head_t* head) noexcept {
 
 static vma_region_t* alloc_region() noexcept;
 
+/*
+ * Seqcount around in-place edits of a region, so vma_lock_fault() never
+ * copies half-updated bounds. Called with mmap_lock held.
+ */
+___inline void region_seq_begin(vma_region_t* region) noexcept {
+    __atomic_store_n(&region->vm_seq, region->vm_seq + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+___inline void region_seq_end(vma_region_t* region) noexcept {
+    __atomic_store_n(&region->vm_seq, region->vm_seq + 1u, __ATOMIC_RELEASE);
+}
+
+___inline bool region_try_lock_read(vma_region_t* region) noexcept {
+    uint32_t old = __atomic_load_n(&region->vm_lock, __ATOMIC_RELAXED);
+
+    while ((old & VMA_LOCK_WRITER) == 0u) {
+        if (__atomic_compare_exchange_n(&region->vm_lock, &old, old + 1u, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Regions a writer has taken away from the fault path. Filled under
+ * mmap_lock; wait_readers() and finish() run after it is dropped, since
+ * faults holding a region may sleep.
+ */
+struct RegionDrain {
+    vma_region_t* locked = nullptr;
+    vma_region_t* retired = nullptr;
+
+    /* The region stays in the tree; finish() hands it back to faults. */
+    void lock(vma_region_t* region) noexcept {
+        __atomic_fetch_or(&region->vm_lock, VMA_LOCK_WRITER, __ATOMIC_SEQ_CST);
+
+        region->drain_next = locked;
+        locked = region;
+    }
+
+    /* The region left the tree; finish() frees it. */
+    void retire(vma_region_t* region) noexcept {
+        __atomic_fetch_or(&region->vm_lock, VMA_LOCK_WRITER, __ATOMIC_SEQ_CST);
+
+        region->drain_next = retired;
+        retired = region;
+    }
+
+    static void wait_list(vma_region_t* region) noexcept {
+        for (; region; region = region->drain_next) {
+            while ((__atomic_load_n(&region->vm_lock, __ATOMIC_ACQUIRE) & ~VMA_LOCK_WRITER) != 0u) {
+                sched_yield();
+            }
+        }
+    }
+
+    void wait_readers() noexcept {
+        wait_list(locked);
+        wait_list(retired);
+    }
+
+    void finish() noexcept {
+        while (locked) {
+            vma_region_t* region = locked;
+            locked = region->drain_next;
+
+            __atomic_fetch_and(&region->vm_lock, ~VMA_LOCK_WRITER, __ATOMIC_RELEASE);
+        }
+
+        while (retired) {
+            vma_region_t* region = retired;
+            retired = region->drain_next;
+
+            call_rcu(&region->rcu, free_region_rcu_cb);
+        }
+    }
+};
+
 static vma_region_t* create_initialized_region(
     uint32_t start, uint32_t end, uint32_t length, uint32_t flags,
     vfs_node_t* file, uint32_t file_offset, uint32_t file_size) noexcept
@@ -206,7 +290,7 @@ ___inline void vmacache_update(task_t* t, proc_mem_t* mem, uint32_t vaddr, vma_r
     vma_mru_cache_update(t, vma);
 }
 
-static void merge_regions_into_left(proc_mem_t* mem, vma_region_t* left, vma_region_t* right) noexcept {
+static void merge_regions_into_left(proc_mem_t* mem, RegionDrain& drain, vma_region_t* left, vma_region_t* right) noexcept {
     if (kernel::unlikely(!mem || !left || !right)) {
         return;
     }
@@ -215,6 +299,8 @@ static void merge_regions_into_left(proc_mem_t* mem, vma_region_t* left, vma_reg
     uint32_t right_span = region_span(right);
     uint32_t merged_span = left_span + right_span;
 
+    region_seq_begin(left);
+
     mt_erase_region(mem, left);
     mt_erase_region(mem, right);
 
@@ -239,9 +325,11 @@ static void merge_regions_into_left(proc_mem_t* mem, vma_region_t* left, vma_reg
 
     mt_insert_region(mem, left);
 
+    region_seq_end(left);
+
     vmacache_invalidate(mem);
 
-    call_rcu(&right->rcu, free_region_rcu_cb);
+    drain.retire(right);
 }
 
 ___inline vma_region_t* vma_find_lockless(task_t* t, proc_mem_t* mem, uint32_t vaddr) noexcept {
@@ -299,43 +387,40 @@ static vma_region_t* vma_find_overlap_unlocked(proc_mem_t* mem, uint32_t start,
     return nullptr;
 }
 
-static void unmap_range(uint32_t* page_dir, uint32_t start, uint32_t end) noexcept {
-    const uint32_t aligned_start = align_down_4k(start);
-    const uint32_t aligned_end = align_up_4k(end);
-
+static void unmap_range(proc_mem_t* mem, paging_tlb_gather_t* tlb, uint32_t start, uint32_t end) noexcept {
     struct UnmapCtx {
+        paging_tlb_gather_t* tlb;
         uint32_t freed_pages = 0u;
-    } ctx{};
+    } ctx{tlb};
 
-    auto visitor = [](uint32_t /*virt*/, uint32_t pte, void* vctx) -> int {
+    auto visitor = [](uint32_t /*virt*/, pte_t pte, void* vctx) -> int {
         if ((pte & 4u) == 0u) {
             return 0;
         }
 
-        bool is_4m = (pte & (1u << 7)) != 0u;
-        uint32_t phys = is_4m ? (pte & ~0x3FFFFFu) : (pte & ~0xFFFu);
+        auto* ctxp = static_cast<UnmapCtx*>(vctx);
+
+        bool is_huge = (pte & PTE_SUPER) != 0u;
+        phys_addr_t phys = is_huge ? pde_huge_phys(pte) : pte_phys(pte);
 
         if (phys != 0u && (pte & 0x200u) == 0u) {
-            if (is_4m) {
-                pmm_free_pages((void*)phys, 10);
+            if (is_huge) {
+                paging_tlb_gather_free_huge(ctxp->tlb, phys);
             } else {
-                pmm_free_block_deferred((void*)phys);
+                pmm_free_phys_deferred(phys);
             }
         }
 
-        auto* ctxp = static_cast<UnmapCtx*>(vctx);
-
-        if (ctxp) {
-            ctxp->freed_pages += is_4m ? 1024 : 1;
-        }
+        ctxp->freed_pages += is_huge ? PAGING_HUGE_PAGES : 1;
 
         return 1;
     };
 
-    paging_unmap_range_ex(page_dir, start, end, visitor, &ctx);
+    paging_unmap_range_gather(tlb, align_down_4k(start), align_up_4k(end), visitor, &ctx);
 
-    (void)aligned_start;
-    (void)aligned_end;
+    if (ctx.freed_pages != 0u) {
+        proc_mem_pages_sub(mem, ctx.freed_pages);
+    }
 }
 
 ___inline void release_region_file(vma_region_t* region) noexcept {
@@ -369,6 +454,63 @@ ___inline void free_region(vma_region_t* region) noexcept {
     }
 }
 
+/*
+ * Cut `region` at `addr` and return the new right half. The left half keeps
+ * the original node. Called with mmap_lock held.
+ */
+static vma_region_t* split_region(proc_mem_t* mem, vma_region_t* region, uint32_t addr) noexcept {
+    const uint32_t m_start = region->vaddr_start;
+    const uint32_t m_end = region->vaddr_end;
+
+    vma_region_t* right = create_initialized_region(
+        addr, m_end, m_end - addr, region->map_flags,
+        region->file, region->file_offset, region->file_size
+    );
+
+    if (kernel::unlikely(!right)) {
+        return nullptr;
+    }
+
+    if (right->file) {
+        vfs_node_retain(right->file);
+    }
+
+    adjust_file_bounds(right, addr - m_start, m_end - addr, true);
+
+    region_seq_begin(region);
+
+    mt_erase_region(mem, region);
+
+    region->vaddr_end = addr;
+    region->length = addr - m_start;
+
+    adjust_file_bounds(region, 0u, region->length, false);
+
+    mt_insert_region(mem, region);
+    mt_insert_region(mem, right);
+
+    region_seq_end(region);
+
+    return right;
+}
+
+/* Check that [start, end_excl) has no holes. Called with mmap_lock held. */
+static bool range_fully_mapped(proc_mem_t* mem, uint32_t start, uint32_t end_excl) noexcept {
+    uint32_t cur = start;
+
+    while (cur < end_excl) {
+        vma_region_t* region = static_cast<vma_region_t*>(mt_load(&mem->mmap_mt, cur));
+
+        if (!region || cur < region->vaddr_start || cur >= region->vaddr_end) {
+            return false;
+        }
+
+        cur = region->vaddr_end;
+    }
+
+    return true;
+}
+
 struct UnmapSpanCollector {
     struct span_t {
         uint32_t start;
@@ -437,6 +579,7 @@ extern "C" void vma_init(proc_mem_t* mem) {
 
     mt_init_cache();
 
+    mutex_init(&mem->mmap_mutex);
     spinlock_init(&mem->mmap_lock);
 
     mt_init(&mem->mmap_mt);
@@ -496,7 +639,7 @@ extern "C" vma_region_t* vma_create(
 
     uint32_t aligned_size = align_up_4k(size + diff);
 
-    if (kernel::likely(aligned_size >= 0x400000u && (aligned_vaddr & 0x3FFFFFu) == 0)) {
+    if (kernel::likely(aligned_size >= PAGING_HUGE_SIZE && (aligned_vaddr & PAGING_HUGE_MASK) == 0)) {
         flags |= VMA_MAP_HUGE;
     }
 
@@ -529,6 +672,12 @@ extern "C" vma_region_t* vma_create(
     pseudo_new.file_offset = file_offset - diff;
     pseudo_new.file_size = aligned_file_size;
 
+    kernel::MutexNativeGuard write_guard(mem->mmap_mutex);
+
+    RegionDrain drain;
+
+    vma_region_t* extended = nullptr;
+
     {
         kernel::SpinLockNativeGuard guard(mem->mmap_lock);
 
@@ -538,7 +687,8 @@ extern "C" vma_region_t* vma_create(
             vma_region_t* prev = static_cast<vma_region_t*>(mt_load(&mem->mmap_mt, prev_idx));
 
             if (kernel::likely(prev && regions_are_mergeable(prev, &pseudo_new))) {
-                
+                region_seq_begin(prev);
+
                 mt_erase_region(mem, prev);
 
                 prev->vaddr_end = pseudo_new.vaddr_end;
@@ -550,6 +700,8 @@ extern "C" vma_region_t* vma_create(
                 }
                 
                 mt_insert_region(mem, prev);
+
+                region_seq_end(prev);
                 
                 vmacache_invalidate(mem);
 
@@ -559,23 +711,30 @@ extern "C" vma_region_t* vma_create(
                     vma_region_t* next = static_cast<vma_region_t*>(mt_load(&mem->mmap_mt, next_idx));
 
                     if (kernel::likely(next && regions_are_mergeable(prev, next))) {
-                        merge_regions_into_left(mem, prev, next);
+                        merge_regions_into_left(mem, drain, prev, next);
                     }
                 }
 
                 if (mem->mmap_top < prev->vaddr_end) {
                     mem->mmap_top = prev->vaddr_end;
                 }
-                
-                if (file) {
-                    vfs_node_release(file);
-                }
 
-                return prev;
+                extended = prev;
             }
         }
     }
 
+    if (extended) {
+        drain.wait_readers();
+        drain.finish();
+
+        if (file) {
+            vfs_node_release(file);
+        }
+
+        return extended;
+    }
+
     vma_region_t* region = create_initialized_region(
         aligned_vaddr, aligned_vaddr + aligned_size,
         size, flags, file, file_offset - diff, aligned_file_size
@@ -607,7 +766,7 @@ extern "C" vma_region_t* vma_create(
                 vma_region_t* prev = static_cast<vma_region_t*>(mt_load(&mem->mmap_mt, prev_idx));
                 
                 if (prev && regions_are_mergeable(prev, merged)) {
-                    merge_regions_into_left(mem, prev, merged);
+                    merge_regions_into_left(mem, drain, prev, merged);
 
                     merged = prev;
                 }
@@ -626,7 +785,7 @@ extern "C" vma_region_t* vma_create(
                     break;
                 }
 
-                merge_regions_into_left(mem, merged, next);
+                merge_regions_into_left(mem, drain, merged, next);
             }
 
             region = merged;
@@ -637,6 +796,9 @@ extern "C" vma_region_t* vma_create(
         }
     }
 
+    drain.wait_readers();
+    drain.finish();
+
     if (kernel::likely(has_overlap)) {
         free_region(region);
 
@@ -667,7 +829,12 @@ extern "C" int vma_remove(proc_mem_t* mem, uint32_t vaddr, uint32_t len) {
 
     uint32_t vaddr_end = vaddr + align_up_4k(len);
     
+    kernel::MutexNativeGuard write_guard(mem->mmap_mutex);
+
     UnmapSpanCollector collector;
+    RegionDrain drain;
+
+    int result = 0;
 
     {
         kernel::SpinLockNativeGuard guard(mem->mmap_lock);
@@ -721,8 +888,8 @@ extern "C" int vma_remove(proc_mem_t* mem, uint32_t vaddr, uint32_t len) {
                 curr = static_cast<vma_region_t*>(mt_load(&mem->mmap_mt, idx));
                 
                 if (kernel::unlikely(!curr)) {
-                    collector.cleanup();
-                    return -1;
+                    result = -1;
+                    break;
                 }
 
                 idx = curr->vaddr_start;
@@ -743,20 +910,20 @@ extern "C" int vma_remove(proc_mem_t* mem, uint32_t vaddr, uint32_t len) {
                 continue;
             }
 
-            collector.push(o_start, o_end);
+            vma_region_t* new_right = nullptr;
 
             if (kernel::unlikely(o_start > m_start && o_end < m_end)) {
                 uint32_t right_len = m_end - o_end;
                 uint32_t right_off = curr->file_offset + (o_end - m_start);
 
-                vma_region_t* new_right = create_initialized_region(
+                new_right = create_initialized_region(
                     o_end, m_end, right_len, curr->map_flags,
                     curr->file, curr->file ? right_off : 0u, 0u
                 );
 
                 if (kernel::unlikely(!new_right)) {
-                    collector.cleanup();
-                    return -1;
+                    result = -1;
+                    break;
                 }
 
                 if (curr->file) {
@@ -764,56 +931,51 @@ extern "C" int vma_remove(proc_mem_t* mem, uint32_t vaddr, uint32_t len) {
                 }
 
                 adjust_file_bounds(new_right, o_end - m_start, right_len, true);
-
-                mt_erase_region(mem, curr);
-
-                curr->vaddr_end = o_start;
-                curr->length = o_start - m_start;
-                adjust_file_bounds(curr, 0u, curr->length, false);
-
-                mt_insert_region(mem, curr);
-                mt_insert_region(mem, new_right);
-
-                idx = o_end;
-                continue;
             }
 
+            collector.push(o_start, o_end);
+
             if (kernel::likely(o_start == m_start && o_end == m_end)) {
                 mt_erase_region(mem, curr);
 
-                call_rcu(&curr->rcu, free_region_rcu_cb);
+                drain.retire(curr);
                 
                 idx = o_end;
                 continue;
             }
 
-            if (o_start == m_start && o_end < m_end) {
-                mt_erase_region(mem, curr);
+            /*
+             * Faults already inside `curr` may still map pages into the cut;
+             * hold new ones off until those are drained and the cut unmapped.
+             */
+            drain.lock(curr);
 
-                curr->vaddr_start = o_end;
-                curr->length = m_end - o_end;
+            region_seq_begin(curr);
 
-                adjust_file_bounds(curr, o_end - m_start, curr->length, true);
+            mt_erase_region(mem, curr);
 
-                mt_insert_region(mem, curr);
+            if (new_right) {
+                curr->vaddr_end = o_start;
+                curr->length = o_start - m_start;
 
-                idx = o_end;
-                continue;
-            }
+                adjust_file_bounds(curr, 0u, curr->length, false);
 
-            if (o_start > m_start && o_end == m_end) {
-                mt_erase_region(mem, curr);
+                mt_insert_region(mem, new_right);
+            } else if (o_start == m_start) {
+                curr->vaddr_start = o_end;
+                curr->length = m_end - o_end;
 
+                adjust_file_bounds(curr, o_end - m_start, curr->length, true);
+            } else {
                 curr->vaddr_end = o_start;
                 curr->length = o_start - m_start;
 
                 adjust_file_bounds(curr, 0u, curr->length, false);
+            }
 
-                mt_insert_region(mem, curr);
+            mt_insert_region(mem, curr);
 
-                idx = o_end;
-                continue;
-            }
+            region_seq_end(curr);
 
             idx = o_end;
         }
@@ -821,17 +983,26 @@ extern "C" int vma_remove(proc_mem_t* mem, uint32_t vaddr, uint32_t len) {
         vmacache_invalidate(mem);
     }
 
+    drain.wait_readers();
+
+    paging_tlb_gather_t tlb;
+    paging_tlb_gather_init(&tlb, mem->page_dir);
+
     for (uint32_t i = 0u; i < collector.len; i++) {
-        unmap_range(mem->page_dir, collector.spans[i].start, collector.spans[i].end);
+        unmap_range(mem, &tlb, collector.spans[i].start, collector.spans[i].end);
     }
 
+    paging_tlb_gather_finish(&tlb);
+
+    drain.finish();
+
     collector.cleanup();
 
     if (mem->free_area_cache > vaddr) {
         mem->free_area_cache = vaddr;
     }
 
-    return 0;
+    return result;
 }
 
 extern "C" int vma_validate_range(proc_mem_t* mem, uint32_t start, uint32_t end_excl) {
@@ -945,3 +1116,286 @@ extern "C" uint32_t vma_alloc_slot(proc_mem_t* mem, uint32_t size, uint32_t* out
     mem->free_area_cache = mmap_base;
     return 0;
 }
+
+extern "C" uint32_t vma_alloc_slot_aligned(proc_mem_t* mem, uint32_t size, uint32_t align, uint32_t* out_vaddr) {
+    if (align <= page_size) {
+        return vma_alloc_slot(mem, size, out_vaddr);
+    }
+
+    if (kernel::unlikely(!out_vaddr || (align & (align - 1u)) != 0u)) {
+        return 0;
+    }
+
+    const uint32_t aligned_size = align_up_4k(size);
+    const uint32_t padded = aligned_size + (align - page_size);
+
+    if (kernel::unlikely(aligned_size == 0u || padded < aligned_size)) {
+        return 0;
+    }
+
+    uint32_t vaddr = 0u;
+
+    if (!vma_alloc_slot(mem, padded, &vaddr)) {
+        return 0;
+    }
+
+    *out_vaddr = (vaddr + (align - 1u)) & ~(align - 1u);
+
+    return 1;
+}
+
+extern "C" int vma_advise(proc_mem_t* mem, uint32_t start, uint32_t end_excl, uint32_t set, uint32_t clear) {
+    if (kernel::unlikely(!mem || (start & page_mask) || end_excl <= start)) {
+        return -1;
+    }
+
+    end_excl = align_up_4k(end_excl);
+
+    if (kernel::unlikely(end_excl == 0u || start < user_addr_min || end_excl > user_addr_max)) {
+        return -1;
+    }
+
+    kernel::MutexNativeGuard write_guard(mem->mmap_mutex);
+    kernel::SpinLockNativeGuard guard(mem->mmap_lock);
+
+    if (!range_fully_mapped(mem, start, end_excl)) {
+        return -1;
+    }
+
+    int result = 0;
+
+    uint32_t cur = start;
+
+    while (cur < end_excl) {
+        vma_region_t* region = static_cast<vma_region_t*>(mt_load(&mem->mmap_mt, cur));
+
+        if (((region->map_flags & ~clear) | set) == region->map_flags) {
+            cur = region->vaddr_end;
+            continue;
+        }
+
+        if (region->vaddr_start < cur) {
+            region = split_region(mem, region, cur);
+        }
+
+        if (region && region->vaddr_end > end_excl) {
+            region = split_region(mem, region, end_excl) ? region : nullptr;
+        }
+
+        if (kernel::unlikely(!region)) {
+            result = -1;
+            break;
+        }
+
+        region_seq_begin(region);
+
+        region->map_flags = (region->map_flags & ~clear) | set;
+
+        region_seq_end(region);
+
+        __atomic_store_n(&region->fault_pages, 0u, __ATOMIC_RELAXED);
+
+        cur = region->vaddr_end;
+    }
+
+    vmacache_invalidate(mem);
+
+    return result;
+}
+
+extern "C" int vma_discard(proc_mem_t* mem, uint32_t start, uint32_t end_excl) {
+    if (kernel::unlikely(!mem || !mem->page_dir || (start & page_mask) || end_excl <= start)) {
+        return -1;
+    }
+
+    end_excl = align_up_4k(end_excl);
+
+    if (kernel::unlikely(end_excl == 0u || !vma_validate_range(mem, start, end_excl))) {
+        return -1;
+    }
+
+    /*
+     * A large page straddling either end has to be split first, otherwise
+     * unmapping it would throw away data outside the range. If the split
+     * fails for lack of memory, leave that part alone.
+     */
+    if ((start & PAGING_HUGE_MASK) != 0u) {
+        (void)paging_split_huge(mem->page_dir, start);
+
+        if ((paging_peek_pde(mem->page_dir, start) & PTE_SUPER) != 0u) {
+            start = (start & ~PAGING_HUGE_MASK) + PAGING_HUGE_SIZE;
+        }
+    }
+
+    if ((end_excl & PAGING_HUGE_MASK) != 0u && end_excl > start) {
+        (void)paging_split_huge(mem->page_dir, end_excl);
+
+        if ((paging_peek_pde(mem->page_dir, end_excl) & PTE_SUPER) != 0u) {
+            end_excl &= ~PAGING_HUGE_MASK;
+        }
+    }
+
+    if (end_excl > start) {
+        paging_tlb_gather_t tlb;
+        paging_tlb_gather_init(&tlb, mem->page_dir);
+
+        unmap_range(mem, &tlb, start, end_excl);
+
+        paging_tlb_gather_finish(&tlb);
+    }
+
+    return 0;
+}
+
+/*
+ * Clearing the entry with a compare-and-swap rather than through the unmap
+ * walk keeps a page the zswap scanner is busy with (or has already parked)
+ * where it is, and settles the race with a concurrent munmap or sbrk.
+ */
+static bool detach_pte(proc_mem_t* mem, uint32_t vaddr, phys_addr_t* out_phys) noexcept {
+    const pte_t pte = paging_peek_pte(mem->page_dir, vaddr);
+
+    constexpr pte_t need = PTE_PRESENT | PTE_RW | PTE_USER;
+
+    if ((pte & need) != need || (pte & 0x200u) != 0u) {
+        return false;
+    }
+
+    const phys_addr_t phys = pte_phys(pte);
+
+    if (phys == 0u || phys >= PMM_LOWMEM_LIMIT) {
+        return false;
+    }
+
+    if (!paging_pte_cmpxchg(mem->page_dir, vaddr, pte, 0u)) {
+        return false;
+    }
+
+    paging_flush_user_range(mem->page_dir, vaddr, vaddr + page_size);
+
+    /* The frame now belongs to the pipe, so it no longer counts towards the writer's RSS. */
+    proc_mem_pages_sub(mem, 1u);
+
+    *out_phys = phys;
+
+    return true;
+}
+
+extern "C" int vma_detach_page(proc_mem_t* mem, uint32_t vaddr, phys_addr_t* out_phys) {
+    if (kernel::unlikely(!mem || !mem->page_dir || !out_phys || (vaddr & page_mask))) {
+        return -1;
+    }
+
+    if (kernel::unlikely(vaddr < user_addr_min || vaddr >= user_addr_max)) {
+        return -1;
+    }
+
+    const uint32_t brk = align_up_4k(__atomic_load_n(&mem->prog_break, __ATOMIC_RELAXED));
+
+    if (vaddr >= mem->heap_start && vaddr + page_size <= brk) {
+        return detach_pte(mem, vaddr, out_phys) ? 0 : -1;
+    }
+
+    vma_snapshot_t snap;
+    vma_region_t* region = vma_lock_fault(proc_current(), mem, vaddr, &snap);
+
+    if (!region) {
+        return -1;
+    }
+
+    int result = -1;
+
+    if ((snap.map_flags & (VMA_MAP_SHARED | VMA_MAP_PRIVATE)) == VMA_MAP_PRIVATE
+        && detach_pte(mem, vaddr, out_phys)) {
+        result = 0;
+    }
+
+    vma_unlock_fault(region);
+
+    return result;
+}
+
+extern "C" uint32_t vma_fault_around(vma_region_t* region, uint32_t vaddr) {
+    if (kernel::unlikely(!region)) {
+        return 1u;
+    }
+
+    const uint32_t flags = region->map_flags;
+
+    if (flags & VMA_MAP_RANDOM) {
+        return 1u;
+    }
+
+    if (flags & VMA_MAP_SEQUENTIAL) {
+        return fault_around_max;
+    }
+
+    const uint32_t last = __atomic_load_n(&region->fault_vaddr, __ATOMIC_RELAXED);
+    uint32_t pages = __atomic_load_n(&region->fault_pages, __ATOMIC_RELAXED);
+
+    if (pages == 0u) {
+        pages = fault_around_default;
+    } else if (vaddr > last && vaddr - last <= pages * page_size) {
+        /* Landed right past the previous window: the access is streaming. */
+        if (pages < fault_around_max) {
+            pages *= 2u;
+        }
+    } else if (pages > 1u) {
+        pages /= 2u;
+    }
+
+    __atomic_store_n(&region->fault_vaddr, vaddr, __ATOMIC_RELAXED);
+    __atomic_store_n(&region->fault_pages, pages, __ATOMIC_RELAXED);
+
+    return pages;
+}
+
+extern "C" vma_region_t* vma_lock_fault(task_t* t, proc_mem_t* mem, uint32_t vaddr, vma_snapshot_t* snap) {
+    if (kernel::unlikely(!mem || !snap)) {
+        return nullptr;
+    }
+
+    for (;;) {
+        {
+            kernel::RcuReadGuard guard;
+
+            vma_region_t* region = vma_find_lockless(t, mem, vaddr);
+
+            if (kernel::unlikely(!region)) {
+                return nullptr;
+            }
+
+            const uint32_t seq = __atomic_load_n(&region->vm_seq, __ATOMIC_ACQUIRE);
+
+            if (kernel::likely((seq & 1u) == 0u && region_try_lock_read(region))) {
+                snap->vaddr_start = region->vaddr_start;
+                snap->vaddr_end = region->vaddr_end;
+
+                snap->file_offset = region->file_offset;
+                snap->file_size = region->file_size;
+
+                snap->map_flags = region->map_flags;
+
+                snap->file = region->file;
+
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+                if (kernel::likely(__atomic_load_n(&region->vm_seq, __ATOMIC_RELAXED) == seq
+                                   && vaddr >= snap->vaddr_start && vaddr < snap->vaddr_end)) {
+                    return region;
+                }
+
+                vma_unlock_fault(region);
+            }
+        }
+
+        /* A writer owns the region; it is only ever held across a short unmap. */
+        sched_yield();
+    }
+}
+
+extern "C" void vma_unlock_fault(vma_region_t* region) {
+    if (kernel::likely(region)) {
+        __atomic_fetch_sub(&region->vm_lock, 1u, __ATOMIC_RELEASE);
+    }
+}
@@ -6,6 +6,7 @@
 
 #include <lib/maple_tree.h>
 #include <lib/compiler.h>
+#include <lib/types.h>
 
 #include <kernel/rcu.h>
 
@@ -21,6 +22,24 @@ struct proc_mem;
 #define VMA_MAP_STACK    4u
 #define VMA_MAP_HUGE     8u
 
+/* Access-pattern hints set by madvise(); they only steer fault-around. */
+#define VMA_MAP_SEQUENTIAL 16u
+#define VMA_MAP_RANDOM     32u
+
+/* Guard range: any access faults with SIGSEGV instead of populating a page. */
+#define VMA_MAP_GUARD      64u
+
+/*
+ * Per-region fault lock.
+ *
+ * Page faults find their region under RCU and take it for reading; they
+ * never touch the mm-wide locks. Writers (munmap, merges in vma_create) set
+ * VMA_LOCK_WRITER under mmap_lock, which turns new faults away, and wait for
+ * the readers to drain before unmapping the region's pages or freeing it.
+ * Regions dropped from the tree keep the writer bit until they are freed.
+ */
+#define VMA_LOCK_WRITER  0x80000000u
+
 typedef struct vma_region vma_region_t;
 
 struct __cacheline_aligned vma_region {
@@ -33,11 +52,40 @@ struct __cacheline_aligned vma_region {
 
     uint32_t map_flags;
 
+    /*
+     * Fault-around state: the last fault address and the window mapped for
+     * it. Updated locklessly from the fault path; it is only a heuristic.
+     */
+    uint32_t fault_vaddr;
+    uint32_t fault_pages;
+
     struct vfs_node* file;
 
+    /* Reader count plus VMA_LOCK_WRITER. */
+    volatile uint32_t vm_lock;
+
+    /* Odd while a writer is changing the fields above. */
+    volatile uint32_t vm_seq;
+
+    /* Link on the writer's list of regions to drain. */
+    vma_region_t* drain_next;
+
     rcu_head_t rcu;
 };
 
+/* Stable copy of a region taken by vma_lock_fault(). */
+typedef struct {
+    uint32_t vaddr_start;
+    uint32_t vaddr_end;
+
+    uint32_t file_offset;
+    uint32_t file_size;
+
+    uint32_t map_flags;
+
+    struct vfs_node* file;
+} vma_snapshot_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -64,6 +112,44 @@ int vma_validate_range(struct proc_mem* mem, uint32_t start, uint32_t end_excl);
 
 uint32_t vma_alloc_slot(struct proc_mem* mem, uint32_t size,uint32_t* out_vaddr);
 
+/* As vma_alloc_slot, starting at a multiple of `align` (a power of two). */
+uint32_t vma_alloc_slot_aligned(struct proc_mem* mem, uint32_t size, uint32_t align, uint32_t* out_vaddr);
+
+/*
+ * Set `set` and clear `clear` in the map flags of [start, end_excl), splitting
+ * regions at the boundaries. Fails if part of the range is not mapped.
+ */
+int vma_advise(struct proc_mem* mem, uint32_t start, uint32_t end_excl, uint32_t set, uint32_t clear);
+
+/*
+ * Drop the pages backing [start, end_excl) but keep the regions: the next
+ * access faults in fresh zero pages (or file contents) again.
+ */
+int vma_discard(struct proc_mem* mem, uint32_t start, uint32_t end_excl);
+
+/*
+ * Take the page at `vaddr` away from `mem` and hand its frame to the caller,
+ * as if by vma_discard() on that page alone. Only private, writable, resident
+ * pages in low memory qualify: heap pages or those of a private mapping.
+ * The caller owns the frame on success and frees it with pmm_free_block().
+ */
+int vma_detach_page(struct proc_mem* mem, uint32_t vaddr, phys_addr_t* out_phys);
+
+/*
+ * Number of pages to map around a fault at `vaddr`. Grows while faults walk
+ * the region sequentially and shrinks when they jump around. Call under RCU.
+ */
+uint32_t vma_fault_around(vma_region_t* region, uint32_t vaddr);
+
+/*
+ * Find the region covering `vaddr` and take its fault lock, filling `snap`
+ * with a consistent copy of it. Waits out writers busy with the region.
+ * Returns NULL if nothing is mapped at `vaddr`. May sleep; call without RCU.
+ */
+vma_region_t* vma_lock_fault(struct task* t, struct proc_mem* mem, uint32_t vaddr, vma_snapshot_t* snap);
+
+void vma_unlock_fault(vma_region_t* region);
+
 #ifdef __cplusplus
 }
 #endif
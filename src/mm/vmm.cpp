@@ -244,16 +244,16 @@ static bool map_new_pages(uintptr_t virt_base, size_t count, kernel::PmmState* p
         size_t remaining = count - mapped_total;
         uintptr_t cur_virt = virt_base + (mapped_total * PAGE_SIZE);
 
-        if (remaining >= 1024 && (cur_virt & 0x3FFFFFu) == 0) {
-            void* phys_4m = pmm->alloc_pages_zone(10, PMM_ZONE_NORMAL);
-            if (phys_4m) {
-                paging_map_4m(
+        if (remaining >= PAGING_HUGE_PAGES && (cur_virt & PAGING_HUGE_MASK) == 0) {
+            void* phys_huge = pmm->alloc_pages_zone(PAGING_HUGE_ORDER, PMM_ZONE_NORMAL);
+            if (phys_huge) {
+                paging_map_huge(
                     kernel_page_directory,
                     static_cast<uint32_t>(cur_virt),
-                    static_cast<uint32_t>(reinterpret_cast<uintptr_t>(phys_4m)),
+                    static_cast<uint32_t>(reinterpret_cast<uintptr_t>(phys_huge)),
                     PTE_PRESENT | PTE_RW
                 );
-                mapped_total += 1024;
+                mapped_total += PAGING_HUGE_PAGES;
                 continue;
             }
         }
@@ -284,14 +284,14 @@ static bool map_new_pages(uintptr_t virt_base, size_t count, kernel::PmmState* p
         if (kernel::unlikely(allocated < chunk)) {
             struct RollbackCtx { kernel::PmmState* p; } ctx = { pmm };
             
-            auto visitor = [](uint32_t virt, uint32_t pte, void* vctx) -> int {
+            auto visitor = [](uint32_t virt, pte_t pte, void* vctx) -> int {
                 (void)virt;
                 auto* c = static_cast<RollbackCtx*>(vctx);
-                if ((pte & (1u << 7)) != 0u) {
-                    uint32_t phys = pte & ~0x3FFFFFu;
-                    if (phys) c->p->free_pages(reinterpret_cast<void*>(phys), 10);
+                if ((pte & PTE_SUPER) != 0u) {
+                    uint32_t phys = static_cast<uint32_t>(pde_huge_phys(pte));
+                    if (phys) c->p->free_pages(reinterpret_cast<void*>(phys), PAGING_HUGE_ORDER);
                 } else if ((pte & 1u) != 0u) {
-                    uint32_t phys = pte & ~0xFFFu;
+                    uint32_t phys = static_cast<uint32_t>(pte_phys(pte));
                     if (phys) c->p->free_pages(reinterpret_cast<void*>(phys), 0);
                 }
                 return 1;
@@ -593,7 +593,7 @@ void VmmState::free_pages(void* ptr, size_t count) noexcept {
     used_pages_count_.fetch_sub(count, kernel::memory_order::relaxed);
 
     if (count == 1u) {
-        const uint32_t phys = paging_get_phys(kernel_page_directory, static_cast<uint32_t>(virt_base));
+        const uint32_t phys = static_cast<uint32_t>(paging_get_phys(kernel_page_directory, static_cast<uint32_t>(virt_base)));
 
         if (kernel::likely(phys && pmm_)) {
             page_t* page = pmm_->phys_to_page(phys);
@@ -637,19 +637,19 @@ void VmmState::free_pages(void* ptr, size_t count) noexcept {
             kernel::PmmState* p;
         } ctx = { batch, pmm_ };
 
-        auto visitor = [](uint32_t virt, uint32_t pte, void* vctx) -> int {
+        auto visitor = [](uint32_t virt, pte_t pte, void* vctx) -> int {
             auto* c = static_cast<VmmUnmapCtx*>(vctx);
-            bool is_4m = (pte & (1u << 7)) != 0u;
-            uint32_t phys = is_4m ? (pte & ~0x3FFFFFu) : (pte & ~0xFFFu);
+            bool is_huge = (pte & PTE_SUPER) != 0u;
+            uint32_t phys = static_cast<uint32_t>(is_huge ? pde_huge_phys(pte) : pte_phys(pte));
             
             if (kernel::likely(phys && c->p)) {
                 page_t* page = c->p->phys_to_page(phys);
                 if (kernel::unlikely(page && page->slab_cache)) {
                     panic("VMM: freeing slab page");
                 }
-                if (is_4m) {
-                    smp_tlb_shootdown_range(virt, virt + 0x400000u);
-                    c->p->free_pages(reinterpret_cast<void*>(phys), 10);
+                if (is_huge) {
+                    smp_tlb_shootdown_range(virt, virt + PAGING_HUGE_SIZE);
+                    c->p->free_pages(reinterpret_cast<void*>(phys), PAGING_HUGE_ORDER);
                 } else {
                     c->b->phys_pages[c->b->phys_count++] = phys;
                 }
@@ -682,20 +682,20 @@ void VmmState::free_pages(void* ptr, size_t count) noexcept {
             kernel::PmmState* p;
         } ctx = { {}, 0, pmm_ };
 
-        auto visitor = [](uint32_t virt, uint32_t pte, void* vctx) -> int {
+        auto visitor = [](uint32_t virt, pte_t pte, void* vctx) -> int {
             (void)virt;
             
             auto* c = static_cast<VmmSyncCtx*>(vctx);
-            bool is_4m = (pte & (1u << 7)) != 0u;
-            uint32_t phys = is_4m ? (pte & ~0x3FFFFFu) : (pte & ~0xFFFu);
+            bool is_huge = (pte & PTE_SUPER) != 0u;
+            uint32_t phys = static_cast<uint32_t>(is_huge ? pde_huge_phys(pte) : pte_phys(pte));
             
             if (kernel::likely(phys && c->p)) {
                 page_t* page = c->p->phys_to_page(phys);
                 if (kernel::unlikely(page && page->slab_cache)) {
                     panic("VMM: freeing slab page");
                 }
-                if (is_4m) {
-                    c->p->free_pages(reinterpret_cast<void*>(phys), 10);
+                if (is_huge) {
+                    c->p->free_pages(reinterpret_cast<void*>(phys), PAGING_HUGE_ORDER);
                 } else {
                     c->phys_batch[c->phys_count++] = phys;
                 }
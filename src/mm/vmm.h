@@ -17,8 +17,9 @@
  * the physical pages back to PMM.
  */
 
+/* The top 4MiB are left to the paging code's temporary mapping windows. */
 #define KERNEL_HEAP_START 0xC0000000u
-#define KERNEL_HEAP_SIZE  0x40000000u
+#define KERNEL_HEAP_SIZE  0x3FC00000u
 #define PAGE_SIZE         4096
 
 #ifdef __cplusplus
@@ -0,0 +1,873 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#include <lib/cpp/lock_guard.h>
+#include <lib/compiler.h>
+#include <lib/string.h>
+#include <lib/dlist.h>
+#include <lib/lz4.h>
+
+#include <arch/i386/paging.h>
+
+#include <kernel/proc.h>
+
+#include <mm/shrinker.h>
+#include <mm/zswap.h>
+#include <mm/pmm.h>
+
+namespace {
+
+constexpr uint32_t page_size = 4096u;
+
+constexpr uint32_t user_addr_min = 0x40000000u;
+constexpr uint32_t user_addr_max = 0xC0000000u;
+
+/*
+ * Pool layout.
+ *
+ * Compressed pages live in 64-byte granular size classes. Each pool page
+ * starts with a small header and holds objects of a single class; the last
+ * class still packs two objects per page, so storing a page never costs a
+ * full page. Anything that compresses worse stays resident.
+ */
+constexpr uint32_t chunk_shift = 6u;
+constexpr uint32_t chunk_granule = 1u << chunk_shift;
+
+constexpr uint32_t zspage_header_size = chunk_granule;
+constexpr uint32_t zspage_payload = page_size - zspage_header_size;
+
+constexpr uint32_t max_stored_size = (zspage_payload / 2u) & ~(chunk_granule - 1u);
+constexpr uint32_t class_count = max_stored_size >> chunk_shift;
+
+constexpr uint16_t chunk_none = 0xFFFFu;
+
+/*
+ * Entry table: a lazily populated two-level array indexed by the 20-bit swap
+ * index stored in the PTE. Index 0 is the busy marker and never allocated.
+ */
+constexpr uint32_t entry_index_bits = 20u;
+constexpr uint32_t entry_index_limit = 1u << entry_index_bits;
+
+constexpr uint16_t entry_len_free = 0u;
+constexpr uint16_t entry_len_filled = 0xFFFFu;
+
+constexpr uint32_t pin_slots = 64u;
+
+constexpr uint32_t scan_batch = 32u;
+constexpr uint32_t scan_budget_per_mem = 4096u;
+constexpr uint32_t scan_max_mems = 64u;
+
+struct ZsPageHeader {
+    dlist_head_t node;
+
+    uint16_t size_class;
+    uint16_t used;
+    uint16_t capacity;
+    uint16_t free_head;
+    uint16_t bump;
+};
+
+static_assert(sizeof(ZsPageHeader) <= zspage_header_size);
+
+struct ZswapEntry {
+    union {
+        uint32_t zspage_phys;
+        uint32_t next_free;
+        uint32_t fill;
+    };
+
+    uint16_t chunk;
+    uint16_t length;
+};
+
+static_assert(sizeof(ZswapEntry) == 8u);
+
+constexpr uint32_t leaf_entries = page_size / sizeof(ZswapEntry);
+constexpr uint32_t dir_entries = entry_index_limit / leaf_entries;
+
+struct SizeClass {
+    dlist_head_t partial;
+};
+
+struct PinSlot {
+    uint32_t pfn;
+    uint32_t count;
+};
+
+___inline uint32_t class_for_length(uint32_t length) noexcept {
+    return ((length + chunk_granule - 1u) >> chunk_shift) - 1u;
+}
+
+___inline uint32_t class_object_size(uint32_t size_class) noexcept {
+    return (size_class + 1u) << chunk_shift;
+}
+
+___inline ZsPageHeader* zspage_header(uint32_t phys) noexcept {
+    return reinterpret_cast<ZsPageHeader*>(phys);
+}
+
+___inline uint8_t* zspage_object(uint32_t phys, uint32_t size_class, uint32_t chunk) noexcept {
+    return reinterpret_cast<uint8_t*>(phys + zspage_header_size + chunk * class_object_size(size_class));
+}
+
+class ZswapPool {
+public:
+    void init() noexcept {
+        for (uint32_t i = 0; i < class_count; i++) {
+            dlist_init(&classes_[i].partial);
+        }
+    }
+
+    /*
+     * Copy a compressed page into the pool.
+     * Returns the new entry index, or 0 if the pool cannot grow.
+     */
+    uint32_t store(const void* data, uint32_t length) noexcept {
+        const uint32_t size_class = class_for_length(length);
+
+        uint32_t zspage_phys = 0u;
+        uint16_t chunk = chunk_none;
+        uint32_t index = 0u;
+
+        uint32_t spare_page = 0u;
+        uint32_t empty_page = 0u;
+
+        for (;;) {
+            bool need_page = false;
+
+            {
+                kernel::SpinLockSafeGuard guard(lock_);
+
+                if (!alloc_chunk_locked(size_class, spare_page, zspage_phys, chunk)) {
+                    need_page = true;
+                } else {
+                    index = alloc_index_locked();
+
+                    if (index != 0u) {
+                        ZswapEntry& e = entry_locked(index);
+
+                        e.zspage_phys = zspage_phys;
+                        e.chunk = chunk;
+                        e.length = static_cast<uint16_t>(length);
+
+                        stored_pages_++;
+                        stored_bytes_ += length;
+                    } else {
+                        empty_page = free_chunk_locked(zspage_phys, chunk);
+                    }
+                }
+            }
+
+            if (!need_page) {
+                break;
+            }
+
+            /* No partial page in this class: grow outside the lock and retry. */
+            spare_page = reinterpret_cast<uint32_t>(pmm_alloc_block());
+
+            if (!spare_page) {
+                return 0u;
+            }
+        }
+
+        if (spare_page != 0u) {
+            pmm_free_block(reinterpret_cast<void*>(spare_page));
+        }
+
+        if (empty_page != 0u) {
+            pmm_free_block(reinterpret_cast<void*>(empty_page));
+        }
+
+        if (index == 0u) {
+            return 0u;
+        }
+
+        memcpy(zspage_object(zspage_phys, size_class, chunk), data, length);
+
+        return index;
+    }
+
+    /* Record a page whose every 32-bit word equals `fill`; nothing is pooled. */
+    uint32_t store_filled(uint32_t fill) noexcept {
+        kernel::SpinLockSafeGuard guard(lock_);
+
+        const uint32_t index = alloc_index_locked();
+
+        if (index == 0u) {
+            return 0u;
+        }
+
+        ZswapEntry& e = entry_locked(index);
+
+        e.fill = fill;
+        e.chunk = 0u;
+        e.length = entry_len_filled;
+
+        stored_pages_++;
+
+        return index;
+    }
+
+    /*
+     * Decompress entry `index` into the page at `dst`.
+     *
+     * The caller owns the entry (it holds the busy marker of the only PTE that
+     * references it), so the entry cannot change or go away underneath.
+     */
+    int load(uint32_t index, void* dst) noexcept {
+        const ZswapEntry* e = entry_lookup(index);
+
+        if (kernel::unlikely(!e || e->length == entry_len_free)) {
+            return -1;
+        }
+
+        if (e->length == entry_len_filled) {
+            uint32_t* words = static_cast<uint32_t*>(dst);
+
+            for (uint32_t i = 0; i < page_size / sizeof(uint32_t); i++) {
+                words[i] = e->fill;
+            }
+
+            return 0;
+        }
+
+        const uint32_t size_class = class_for_length(e->length);
+        const uint8_t* src = zspage_object(e->zspage_phys, size_class, e->chunk);
+
+        const int produced = lz4_decompress(src, e->length, dst, page_size);
+
+        if (kernel::unlikely(produced != static_cast<int>(page_size))) {
+            return -1;
+        }
+
+        return 0;
+    }
+
+    void release(uint32_t index) noexcept {
+        uint32_t empty_page = 0u;
+
+        {
+            kernel::SpinLockSafeGuard guard(lock_);
+
+            ZswapEntry* e = entry_lookup(index);
+
+            if (kernel::unlikely(!e || e->length == entry_len_free)) {
+                return;
+            }
+
+            if (e->length != entry_len_filled) {
+                stored_bytes_ -= e->length;
+
+                empty_page = free_chunk_locked(e->zspage_phys, e->chunk);
+            }
+
+            stored_pages_--;
+
+            e->length = entry_len_free;
+            e->chunk = 0u;
+            e->next_free = free_index_;
+
+            free_index_ = index;
+        }
+
+        if (empty_page != 0u) {
+            pmm_free_block(reinterpret_cast<void*>(empty_page));
+        }
+    }
+
+    void pin(uint32_t pfn) noexcept {
+        kernel::SpinLockSafeGuard guard(pin_lock_);
+
+        PinSlot* empty = nullptr;
+
+        for (uint32_t i = 0; i < pin_slots; i++) {
+            if (pins_[i].count != 0u && pins_[i].pfn == pfn) {
+                pins_[i].count++;
+
+                return;
+            }
+
+            if (!empty && pins_[i].count == 0u) {
+                empty = &pins_[i];
+            }
+        }
+
+        if (empty) {
+            empty->pfn = pfn;
+            empty->count = 1u;
+
+            return;
+        }
+
+        /* Out of slots: stop swapping anything until the pins drain. */
+        pin_overflow_++;
+    }
+
+    void unpin(uint32_t pfn) noexcept {
+        kernel::SpinLockSafeGuard guard(pin_lock_);
+
+        for (uint32_t i = 0; i < pin_slots; i++) {
+            if (pins_[i].count != 0u && pins_[i].pfn == pfn) {
+                pins_[i].count--;
+
+                return;
+            }
+        }
+
+        if (pin_overflow_ > 0u) {
+            pin_overflow_--;
+        }
+    }
+
+    bool pinned(uint32_t pfn) noexcept {
+        kernel::SpinLockSafeGuard guard(pin_lock_);
+
+        if (pin_overflow_ != 0u) {
+            return true;
+        }
+
+        for (uint32_t i = 0; i < pin_slots; i++) {
+            if (pins_[i].count != 0u && pins_[i].pfn == pfn) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void stats(zswap_stats_t& out) noexcept {
+        kernel::SpinLockSafeGuard guard(lock_);
+
+        out.stored_pages = stored_pages_;
+        out.pool_pages = pool_pages_;
+        out.stored_bytes = stored_bytes_;
+    }
+
+    uint32_t pool_pages() noexcept {
+        return __atomic_load_n(&pool_pages_, __ATOMIC_RELAXED);
+    }
+
+private:
+    /* Takes ownership of `spare_page` (and clears it) only if it gets used. */
+    bool alloc_chunk_locked(
+        uint32_t size_class, uint32_t& spare_page,
+        uint32_t& out_phys, uint16_t& out_chunk
+    ) noexcept {
+        SizeClass& sc = classes_[size_class];
+
+        if (dlist_empty(&sc.partial)) {
+            if (!spare_page) {
+                return false;
+            }
+
+            ZsPageHeader* hdr = zspage_header(spare_page);
+
+            hdr->size_class = static_cast<uint16_t>(size_class);
+            hdr->used = 0u;
+            hdr->capacity = static_cast<uint16_t>(zspage_payload / class_object_size(size_class));
+            hdr->free_head = chunk_none;
+            hdr->bump = 0u;
+
+            dlist_add(&hdr->node, &sc.partial);
+
+            pool_pages_++;
+            spare_page = 0u;
+        }
+
+        ZsPageHeader* hdr = container_of(sc.partial.next, ZsPageHeader, node);
+        const uint32_t phys = reinterpret_cast<uint32_t>(hdr);
+
+        uint16_t chunk;
+
+        if (hdr->free_head != chunk_none) {
+            chunk = hdr->free_head;
+
+            __builtin_memcpy(&hdr->free_head, zspage_object(phys, size_class, chunk), sizeof(uint16_t));
+        } else {
+            chunk = hdr->bump++;
+        }
+
+        hdr->used++;
+
+        if (hdr->used == hdr->capacity) {
+            dlist_del(&hdr->node);
+        }
+
+        out_phys = phys;
+        out_chunk = chunk;
+
+        return true;
+    }
+
+    /* Returns the pool page if it became empty and must be freed. */
+    uint32_t free_chunk_locked(uint32_t phys, uint16_t chunk) noexcept {
+        ZsPageHeader* hdr = zspage_header(phys);
+        SizeClass& sc = classes_[hdr->size_class];
+
+        if (hdr->used == hdr->capacity) {
+            dlist_add(&hdr->node, &sc.partial);
+        }
+
+        hdr->used--;
+
+        if (hdr->used == 0u) {
+            dlist_del(&hdr->node);
+
+            pool_pages_--;
+
+            return phys;
+        }
+
+        __builtin_memcpy(zspage_object(phys, hdr->size_class, chunk), &hdr->free_head, sizeof(uint16_t));
+
+        hdr->free_head = chunk;
+
+        return 0u;
+    }
+
+    uint32_t alloc_index_locked() noexcept {
+        if (free_index_ != 0u) {
+            const uint32_t index = free_index_;
+
+            free_index_ = entry_locked(index).next_free;
+
+            return index;
+        }
+
+        if (next_index_ >= entry_index_limit) {
+            return 0u;
+        }
+
+        const uint32_t leaf = next_index_ / leaf_entries;
+
+        if (!dir_[leaf]) {
+            /* Leaves are never freed, so lockless readers may walk them. */
+            void* page = pmm_alloc_block();
+
+            if (!page) {
+                return 0u;
+            }
+
+            memset(page, 0, page_size);
+
+            __atomic_store_n(&dir_[leaf], static_cast<ZswapEntry*>(page), __ATOMIC_RELEASE);
+        }
+
+        return next_index_++;
+    }
+
+    ZswapEntry& entry_locked(uint32_t index) noexcept {
+        return dir_[index / leaf_entries][index % leaf_entries];
+    }
+
+    ZswapEntry* entry_lookup(uint32_t index) noexcept {
+        if (kernel::unlikely(index == 0u || index >= entry_index_limit)) {
+            return nullptr;
+        }
+
+        ZswapEntry* leaf = __atomic_load_n(&dir_[index / leaf_entries], __ATOMIC_ACQUIRE);
+
+        if (kernel::unlikely(!leaf)) {
+            return nullptr;
+        }
+
+        return &leaf[index % leaf_entries];
+    }
+
+    kernel::SpinLock lock_;
+
+    SizeClass classes_[class_count];
+
+    ZswapEntry* dir_[dir_entries] = {};
+
+    uint32_t free_index_ = 0u;
+    uint32_t next_index_ = 1u;
+
+    uint32_t stored_pages_ = 0u;
+    uint32_t stored_bytes_ = 0u;
+    uint32_t pool_pages_ = 0u;
+
+    kernel::SpinLock pin_lock_;
+
+    PinSlot pins_[pin_slots] = {};
+    uint32_t pin_overflow_ = 0u;
+};
+
+static __cacheline_aligned ZswapPool g_pool;
+
+static uint32_t g_swapouts = 0u;
+static uint32_t g_swapins = 0u;
+static uint32_t g_rejected = 0u;
+
+/*
+ * Compression scratch. Reclaim only runs from shrinker callbacks, which the
+ * shrinker core already serializes, so one set of buffers is enough.
+ */
+static uint8_t g_lz4_workmem[LZ4_WORKMEM_SIZE] __attribute__((aligned(64)));
+static uint8_t g_compress_buf[max_stored_size] __attribute__((aligned(64)));
+
+struct ScanBatch {
+    uint32_t count;
+    uint32_t virt[scan_batch];
+    pte_t pte[scan_batch];
+
+    uint32_t scanned;
+    uint32_t budget;
+
+    uint32_t split_virt;
+};
+
+___inline bool page_is_swappable_frame(phys_addr_t phys) noexcept {
+    page_t* page = pmm_phys_to_page(phys);
+
+    if (!page) {
+        return false;
+    }
+
+    return (page->flags & PMM_FLAG_USED) != 0u
+        && (page->flags & PMM_FLAG_KERNEL) == 0u;
+}
+
+/*
+ * Second-chance selection, run under the page-table lock.
+ *
+ * Referenced pages lose their accessed bit and survive this pass. Cold ones
+ * are parked behind a busy marker so that neither the owner nor munmap can
+ * reuse the frame while it is being compressed.
+ */
+static int scan_visitor(uint32_t virt, pte_t* entry, void* ctx) {
+    ScanBatch* batch = static_cast<ScanBatch*>(ctx);
+
+    if (batch->scanned++ >= batch->budget) {
+        return 1;
+    }
+
+    const pte_t pte = pte_load(entry);
+
+    if ((pte & PTE_PRESENT) == 0u
+        || (pte & PTE_USER) == 0u
+        || (pte & (PTE_GLOBAL | 0x200u)) != 0u) {
+        return 0;
+    }
+
+    if ((pte & PTE_ACCESSED) != 0u) {
+        pte_clear_bits(entry, PTE_ACCESSED);
+
+        return 0;
+    }
+
+    if ((pte & PTE_SUPER) != 0u) {
+        batch->split_virt = virt;
+
+        return 1;
+    }
+
+    if (!page_is_swappable_frame(pte_phys(pte))) {
+        return 0;
+    }
+
+    if (!pte_cmpxchg(entry, pte, PTE_SWAP_BUSY)) {
+        return 0;
+    }
+
+    batch->virt[batch->count] = virt;
+    batch->pte[batch->count] = pte;
+    batch->count++;
+
+    return (batch->count == scan_batch) ? 1 : 0;
+}
+
+static bool page_fill_pattern(const uint32_t* words, uint32_t& out_fill) noexcept {
+    const uint32_t first = words[0];
+
+    for (uint32_t i = 1; i < page_size / sizeof(uint32_t); i++) {
+        if (words[i] != first) {
+            return false;
+        }
+    }
+
+    out_fill = first;
+
+    return true;
+}
+
+/* Compress and pool one frame. Returns the entry index or 0. */
+static uint32_t swap_out_frame(phys_addr_t phys) noexcept {
+    const uint32_t* words = static_cast<const uint32_t*>(paging_kmap_atomic(phys));
+
+    uint32_t fill = 0u;
+
+    if (page_fill_pattern(words, fill)) {
+        paging_kunmap_atomic(const_cast<uint32_t*>(words));
+
+        return g_pool.store_filled(fill);
+    }
+
+    const uint32_t length = lz4_compress(
+        words, page_size,
+        g_compress_buf, max_stored_size,
+        g_lz4_workmem
+    );
+
+    paging_kunmap_atomic(const_cast<uint32_t*>(words));
+
+    if (length == 0u) {
+        return 0u;
+    }
+
+    return g_pool.store(g_compress_buf, length);
+}
+
+___inline uint32_t pfn_of(phys_addr_t phys) noexcept {
+    return static_cast<uint32_t>(phys >> PAGE_SHIFT);
+}
+
+___inline void restore_or_drop(uint32_t* dir, uint32_t virt, pte_t pte) noexcept {
+    if (!paging_pte_cmpxchg(dir, virt, PTE_SWAP_BUSY, pte)) {
+        /* Unmapped while parked: the frame is ours to free. */
+        pmm_free_phys_deferred(pte_phys(pte));
+    }
+}
+
+static uint32_t evict_batch(proc_mem_t* mem, const ScanBatch& batch) noexcept {
+    uint32_t* dir = mem->page_dir;
+
+    uint32_t lo = batch.virt[0];
+    uint32_t hi = batch.virt[0];
+
+    for (uint32_t i = 1; i < batch.count; i++) {
+        lo = (batch.virt[i] < lo) ? batch.virt[i] : lo;
+        hi = (batch.virt[i] > hi) ? batch.virt[i] : hi;
+    }
+
+    /* After this no CPU can write to the parked frames any more. */
+    paging_flush_user_range(dir, lo, hi + page_size);
+
+    uint32_t evicted = 0u;
+
+    for (uint32_t i = 0; i < batch.count; i++) {
+        const uint32_t virt = batch.virt[i];
+        const pte_t pte = batch.pte[i];
+        const phys_addr_t phys = pte_phys(pte);
+
+        if (g_pool.pinned(pfn_of(phys))) {
+            restore_or_drop(dir, virt, pte);
+
+            continue;
+        }
+
+        const uint32_t index = swap_out_frame(phys);
+
+        if (index == 0u) {
+            __atomic_fetch_add(&g_rejected, 1u, __ATOMIC_RELAXED);
+
+            restore_or_drop(dir, virt, pte | PTE_ACCESSED);
+
+            continue;
+        }
+
+        /* The entry remembers PTE_NOEXEC so the page comes back the same way. */
+        const pte_t swap = pte_make_swap(index) | (pte & PTE_NOEXEC);
+
+        if (!paging_pte_cmpxchg(dir, virt, PTE_SWAP_BUSY, swap)) {
+            g_pool.release(index);
+
+            pmm_free_phys_deferred(phys);
+
+            continue;
+        }
+
+        pmm_free_phys_deferred(phys);
+
+        evicted++;
+    }
+
+    if (evicted != 0u) {
+        proc_mem_pages_sub(mem, evicted);
+
+        __atomic_fetch_add(&g_swapouts, evicted, __ATOMIC_RELAXED);
+    }
+
+    return evicted;
+}
+
+static uint32_t scan_mem(proc_mem_t* mem, uint32_t want) noexcept {
+    uint32_t cursor = mem->swap_cursor;
+
+    if (cursor < user_addr_min || cursor >= user_addr_max) {
+        cursor = user_addr_min;
+    }
+
+    ScanBatch batch;
+
+    batch.scanned = 0u;
+    batch.budget = scan_budget_per_mem;
+
+    uint32_t evicted = 0u;
+    uint32_t wraps = 0u;
+
+    while (evicted < want && batch.scanned < batch.budget && wraps < 2u) {
+        batch.count = 0u;
+        batch.split_virt = 0u;
+
+        uint32_t stop = paging_scan_range(
+            mem->page_dir, cursor, user_addr_max,
+            scan_visitor, &batch
+        );
+
+        if (batch.split_virt != 0u) {
+            /* Revisit the range page by page, or step over it if we cannot. */
+            if (!paging_split_huge(mem->page_dir, batch.split_virt)) {
+                stop = batch.split_virt + PAGING_HUGE_SIZE;
+            }
+        }
+
+        if (batch.count != 0u) {
+            evicted += evict_batch(mem, batch);
+        }
+
+        cursor = stop;
+
+        if (cursor >= user_addr_max || cursor < user_addr_min) {
+            cursor = user_addr_min;
+            wraps++;
+        }
+    }
+
+    mem->swap_cursor = cursor;
+
+    return evicted;
+}
+
+static size_t zswap_shrinker_cb(size_t target_pages, void* ctx) {
+    (void)ctx;
+
+    proc_mem_t* mems[scan_max_mems];
+
+    const uint32_t count = proc_mem_snapshot(mems, scan_max_mems);
+    const uint32_t pool_before = g_pool.pool_pages();
+
+    uint32_t evicted = 0u;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (evicted < target_pages) {
+            evicted += scan_mem(mems[i], static_cast<uint32_t>(target_pages) - evicted);
+        }
+
+        proc_mem_release(mems[i]);
+    }
+
+    const uint32_t pool_after = g_pool.pool_pages();
+    const uint32_t grown = (pool_after > pool_before) ? (pool_after - pool_before) : 0u;
+
+    return (evicted > grown) ? (evicted - grown) : 0u;
+}
+
+static shrinker_t g_zswap_shrinker = {
+    .name = "zswap",
+    .reclaim = zswap_shrinker_cb,
+    .ctx = nullptr,
+    .list = {nullptr, nullptr}
+};
+
+}
+
+extern "C" void zswap_init(void) {
+    g_pool.init();
+
+    register_shrinker(&g_zswap_shrinker);
+}
+
+extern "C" int zswap_fault_in(proc_mem_t* mem, uint32_t vaddr) {
+    if (kernel::unlikely(!mem || !mem->page_dir)) {
+        return 0;
+    }
+
+    vaddr &= ~0xFFFu;
+
+    const pte_t pte = paging_peek_pte(mem->page_dir, vaddr);
+
+    if (kernel::likely(!pte_is_swap(pte))) {
+        return 0;
+    }
+
+    const uint32_t index = pte_swap_index(pte);
+
+    /* Someone else owns the page right now; the access simply retries. */
+    if (index == 0u || !paging_pte_cmpxchg(mem->page_dir, vaddr, pte, PTE_SWAP_BUSY)) {
+        return 1;
+    }
+
+    phys_addr_t frame = pmm_alloc_page_user();
+
+    if (!frame) {
+        shrinker_reclaim_direct(32u);
+
+        frame = pmm_alloc_page_user();
+    }
+
+    int loaded = -1;
+
+    if (frame) {
+        void* dst = paging_kmap_atomic(frame);
+
+        loaded = g_pool.load(index, dst);
+
+        paging_kunmap_atomic(dst);
+    }
+
+    if (loaded != 0) {
+        if (frame) {
+            pmm_free_phys(frame);
+        }
+
+        if (!paging_pte_cmpxchg(mem->page_dir, vaddr, PTE_SWAP_BUSY, pte)) {
+            g_pool.release(index);
+        }
+
+        return -1;
+    }
+
+    g_pool.release(index);
+
+    const pte_t mapped = paging_make_pte(frame, PTE_PRESENT | PTE_RW | PTE_USER | (uint32_t)(pte & PTE_NOEXEC));
+
+    if (!paging_pte_cmpxchg(mem->page_dir, vaddr, PTE_SWAP_BUSY, mapped)) {
+        pmm_free_phys(frame);
+
+        return 1;
+    }
+
+    __atomic_fetch_add(&mem->mem_pages, 1u, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_swapins, 1u, __ATOMIC_RELAXED);
+
+    return 1;
+}
+
+extern "C" void zswap_release_entry(uint32_t index) {
+    if (index == 0u) {
+        return;
+    }
+
+    g_pool.release(index);
+}
+
+extern "C" void zswap_pin_phys(phys_addr_t phys) {
+    g_pool.pin(pfn_of(phys));
+}
+
+extern "C" void zswap_unpin_phys(phys_addr_t phys) {
+    g_pool.unpin(pfn_of(phys));
+}
+
+extern "C" void zswap_get_stats(zswap_stats_t* out) {
+    if (!out) {
+        return;
+    }
+
+    g_pool.stats(*out);
+
+    out->swapouts = __atomic_load_n(&g_swapouts, __ATOMIC_RELAXED);
+    out->swapins = __atomic_load_n(&g_swapins, __ATOMIC_RELAXED);
+    out->rejected = __atomic_load_n(&g_rejected, __ATOMIC_RELAXED);
+}
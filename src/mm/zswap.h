@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/* Copyright (C) 2026 Yula1234 */
+
+#ifndef MM_ZSWAP_H
+#define MM_ZSWAP_H
+
+#include <stdint.h>
+
+#include <lib/types.h>
+
+/*
+ * Compressed in-RAM swap.
+ *
+ * Under memory pressure the zswap shrinker walks user page tables, gives
+ * recently used pages a second chance via the accessed bit, and replaces
+ * cold private pages by LZ4-compressed copies kept in a compact chunk pool.
+ * The PTE is rewritten into a swap entry (see PTE_SWAP in paging.h) and the
+ * frame goes back to the PMM. A later fault decompresses the page into a
+ * fresh frame.
+ *
+ * Pages that do not compress to less than half a page, shared mappings and
+ * pages pinned by a sleeping futex waiter are never swapped out.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct proc_mem;
+
+typedef struct {
+    uint32_t stored_pages;
+    uint32_t pool_pages;
+    uint32_t stored_bytes;
+
+    uint32_t swapouts;
+    uint32_t swapins;
+    uint32_t rejected;
+} zswap_stats_t;
+
+/* Register the zswap shrinker. Call after the page-cache shrinkers. */
+void zswap_init(void);
+
+/*
+ * Resolve a fault on a swapped-out page.
+ *
+ * Returns 1 if the fault was handled (or raced with another resolver and
+ * should simply be retried), 0 if `vaddr` is not a swap entry and -1 when
+ * the page could not be brought back.
+ */
+int zswap_fault_in(struct proc_mem* mem, uint32_t vaddr);
+
+/* Drop a swap entry whose PTE was torn down. Index 0 (busy) is ignored. */
+void zswap_release_entry(uint32_t index);
+
+/*
+ * Keep the frame at `phys` resident while the kernel holds on to its
+ * physical address (futex keys). Pins nest.
+ */
+void zswap_pin_phys(phys_addr_t phys);
+void zswap_unpin_phys(phys_addr_t phys);
+
+void zswap_get_stats(zswap_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,279 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/hash_map.h>
+#include <lib/chashmap.h>
+
+#include <cstdio>
+#include <unordered_map>
+
+#include "libbench.h"
+
+typedef HashMap<uint32_t, uint32_t, 64> lb_hashmap_t;
+
+static void* chash_value(uint32_t key) {
+    return (void*)(((uintptr_t)key << 4u) | 8u);
+}
+
+void lb_bench_hashmap(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    lb_hashmap_t map;
+
+    /* Growth from the initial 64 buckets is part of what gets timed. */
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)map.insert_unique(i, i);
+    }
+    lb_report_rate("hashmap/insert", n, lb_now_ns() - t0);
+
+    lb_rng rng(o.seed);
+    uint32_t found = 0;
+    uint32_t v = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += map.find(rng.below(2u * n), v) ? 1u : 0u;
+    }
+    lb_report_rate("hashmap/find", n, lb_now_ns() - t0);
+
+    lb_latency lat;
+
+    for (uint32_t i = 0; i < n; i += 64u) {
+        const uint32_t key = rng.below(n);
+
+        const uint64_t s = lb_now_ns();
+        found += map.find(key, v) ? 1u : 0u;
+        lat.add(lb_now_ns() - s);
+    }
+    lat.report("hashmap/find_lat");
+
+    /* Mostly lookups; one in eight operations inserts or removes a thread-private key. */
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t t) {
+            lb_rng r(o.seed + t);
+            const uint32_t own = n + t * 256u;
+            uint32_t out = 0;
+
+            for (uint32_t i = 0; i < per; i++) {
+                if ((i & 7u) == 7u) {
+                    const uint32_t k = own + (i & 255u);
+
+                    if (!map.insert_unique(k, k)) {
+                        (void)map.remove(k);
+                    }
+                } else {
+                    (void)map.find(r.below(n), out);
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "hashmap/mixed/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads, ns);
+
+        for (uint32_t k = n; k < n + threads * 256u; k++) {
+            (void)map.remove(k);
+        }
+    }
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)map.remove(i);
+    }
+    lb_report_rate("hashmap/remove", n, lb_now_ns() - t0);
+
+    if (found == 0u || map.contains(0u)) {
+        lb_fuzz_fail("hashmap", o.seed, 0u, "bench left the map inconsistent");
+    }
+}
+
+void lb_fuzz_hashmap(const lb_opts& o) {
+    lb_hashmap_t map;
+    std::unordered_map<uint32_t, uint32_t> ref;
+
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t key = rng.below(8192u);
+        const uint32_t val = (uint32_t)rng.next();
+        const uint32_t op = rng.below(100u);
+
+        uint32_t out = 0;
+
+        if (op < 30u) {
+            const bool fresh = ref.find(key) == ref.end();
+
+            if (map.insert_unique(key, val) != fresh) {
+                lb_fuzz_fail("hashmap", o.seed, step, "insert_unique disagrees");
+            }
+
+            ref.emplace(key, val);
+        } else if (op < 45u) {
+            if (!map.insert_or_assign(key, val)) {
+                lb_fuzz_fail("hashmap", o.seed, step, "insert_or_assign failed");
+            }
+
+            ref[key] = val;
+        } else if (op < 70u) {
+            auto r = ref.find(key);
+            const bool got = map.remove_and_get(key, out);
+
+            if (got != (r != ref.end()) || (got && out != r->second)) {
+                lb_fuzz_fail("hashmap", o.seed, step, "remove_and_get disagrees");
+            }
+
+            if (r != ref.end()) {
+                ref.erase(r);
+            }
+        } else if (op < 99u) {
+            auto r = ref.find(key);
+            const bool got = map.find(key, out);
+
+            if (got != (r != ref.end()) || (got && out != r->second)) {
+                lb_fuzz_fail("hashmap", o.seed, step, "find disagrees");
+            }
+        } else {
+            map.clear();
+            ref.clear();
+
+            if (map.contains(key)) {
+                lb_fuzz_fail("hashmap", o.seed, step, "key survived clear");
+            }
+        }
+    }
+
+    lb_fuzz_pass("hashmap", o.seed, o.fuzz_ops);
+}
+
+void lb_bench_chashmap(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    chashmap_t* map = chashmap_create();
+    if (!map) {
+        lb_fuzz_fail("chashmap", o.seed, 0u, "create failed");
+    }
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)chashmap_insert_unique(map, i, chash_value(i));
+    }
+    lb_report_rate("chashmap/insert", n, lb_now_ns() - t0);
+
+    lb_rng rng(o.seed);
+    uint32_t found = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += chashmap_find(map, rng.below(2u * n)) ? 1u : 0u;
+    }
+    lb_report_rate("chashmap/find", n, lb_now_ns() - t0);
+
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t t) {
+            lb_rng r(o.seed + t);
+            const uint32_t own = n + t * 256u;
+
+            for (uint32_t i = 0; i < per; i++) {
+                if ((i & 7u) == 7u) {
+                    const uint32_t k = own + (i & 255u);
+
+                    if (chashmap_insert_unique(map, k, chash_value(k)) != 0) {
+                        chashmap_remove(map, k);
+                    }
+                } else {
+                    (void)chashmap_find(map, r.below(n));
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "chashmap/mixed/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads, ns);
+
+        for (uint32_t k = n; k < n + threads * 256u; k++) {
+            chashmap_remove(map, k);
+        }
+    }
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        chashmap_remove(map, i);
+    }
+    lb_report_rate("chashmap/remove", n, lb_now_ns() - t0);
+
+    if (found == 0u) {
+        lb_fuzz_fail("chashmap", o.seed, 0u, "bench lost keys");
+    }
+
+    chashmap_destroy(map);
+}
+
+static void chash_count(uint32_t key, void* value, void* ctx) {
+    auto* seen = (std::unordered_map<uint32_t, void*>*)ctx;
+
+    (*seen)[key] = value;
+}
+
+void lb_fuzz_chashmap(const lb_opts& o) {
+    chashmap_t* map = chashmap_create();
+    if (!map) {
+        lb_fuzz_fail("chashmap", o.seed, 0u, "create failed");
+    }
+
+    std::unordered_map<uint32_t, void*> ref;
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t key = rng.below(8192u);
+        void* val = chash_value((uint32_t)rng.next() >> 8);
+        const uint32_t op = rng.below(100u);
+
+        if (op < 30u) {
+            const bool fresh = ref.find(key) == ref.end();
+
+            if ((chashmap_insert_unique(map, key, val) == 0) != fresh) {
+                lb_fuzz_fail("chashmap", o.seed, step, "insert_unique disagrees");
+            }
+
+            ref.emplace(key, val);
+        } else if (op < 45u) {
+            if (chashmap_set(map, key, val) != 0) {
+                lb_fuzz_fail("chashmap", o.seed, step, "set failed");
+            }
+
+            ref[key] = val;
+        } else if (op < 70u) {
+            auto r = ref.find(key);
+
+            if (chashmap_remove_and_get(map, key) != (r == ref.end() ? nullptr : r->second)) {
+                lb_fuzz_fail("chashmap", o.seed, step, "remove_and_get disagrees");
+            }
+
+            if (r != ref.end()) {
+                ref.erase(r);
+            }
+        } else if (op < 98u) {
+            auto r = ref.find(key);
+
+            if (chashmap_find(map, key) != (r == ref.end() ? nullptr : r->second)) {
+                lb_fuzz_fail("chashmap", o.seed, step, "find disagrees");
+            }
+        } else {
+            std::unordered_map<uint32_t, void*> seen;
+            chashmap_iterate(map, chash_count, &seen);
+
+            if (seen != ref) {
+                lb_fuzz_fail("chashmap", o.seed, step, "iterate disagrees");
+            }
+        }
+    }
+
+    chashmap_destroy(map);
+
+    lb_fuzz_pass("chashmap", o.seed, o.fuzz_ops);
+}
@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/compiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include "libbench.h"
+
+/* lflist.h is only included from C in the kernel and spells the hints unqualified. */
+using kernel::likely;
+using kernel::unlikely;
+
+#include <lib/lflist.h>
+
+void lb_bench_lflist(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    std::vector<lfnode_t> nodes(n);
+
+    lflist_head_t list;
+    lflist_init(&list);
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        lflist_push(&list, &nodes[i]);
+    }
+    lb_report_rate("lflist/push", n, lb_now_ns() - t0);
+
+    uint32_t popped = 0;
+
+    t0 = lb_now_ns();
+    while (lflist_pop(&list)) {
+        popped++;
+    }
+    lb_report_rate("lflist/pop", n, lb_now_ns() - t0);
+
+    for (uint32_t i = 0; i < n; i++) {
+        lflist_push(&list, &nodes[i]);
+    }
+
+    /* Free-list traffic as in mm/dma/pool.c: every thread takes a node and gives it back. */
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t) {
+            for (uint32_t i = 0; i < per; i++) {
+                lfnode_t* node = lflist_pop(&list);
+
+                if (node) {
+                    lflist_push(&list, node);
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "lflist/pop_push/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads, ns);
+    }
+
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads / 16u;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t) {
+            for (uint32_t i = 0; i < per; i++) {
+                uint32_t cnt = 0;
+                lfnode_t* first = lflist_pop_batch(&list, 16u, &cnt);
+
+                if (first) {
+                    lfnode_t* last = first;
+
+                    while (last->next_) {
+                        last = last->next_;
+                    }
+
+                    lflist_push_batch(&list, first, last);
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "lflist/batch16/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads * 16u, ns);
+    }
+
+    /* Lost or duplicated nodes after the contended runs mean the version tag failed. */
+    std::set<lfnode_t*> seen;
+    lfnode_t* node;
+
+    while ((node = lflist_pop(&list)) != nullptr) {
+        if (!seen.insert(node).second) {
+            lb_fuzz_fail("lflist", o.seed, 0u, "node popped twice after contention");
+        }
+    }
+
+    if (seen.size() != n || popped != n) {
+        lb_fuzz_fail("lflist", o.seed, 0u, "nodes lost under contention");
+    }
+}
+
+void lb_fuzz_lflist(const lb_opts& o) {
+    const uint32_t pool_size = 1024u;
+
+    std::vector<lfnode_t> pool(pool_size);
+    std::vector<lfnode_t*> free_nodes;
+    std::vector<lfnode_t*> ref;
+
+    for (uint32_t i = 0; i < pool_size; i++) {
+        free_nodes.push_back(&pool[i]);
+    }
+
+    lflist_head_t list;
+    lflist_init(&list);
+
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t op = rng.below(100u);
+
+        if (op < 35u && !free_nodes.empty()) {
+            const uint32_t pick = rng.below((uint32_t)free_nodes.size());
+            lfnode_t* node = free_nodes[pick];
+
+            free_nodes[pick] = free_nodes.back();
+            free_nodes.pop_back();
+
+            lflist_push(&list, node);
+            ref.push_back(node);
+        } else if (op < 50u && !free_nodes.empty()) {
+            /* Chain up to eight free nodes and push them in one go; first ends up on top. */
+            const uint32_t cnt = 1u + rng.below((uint32_t)std::min<size_t>(free_nodes.size(), 8u));
+            std::vector<lfnode_t*> chain(free_nodes.end() - cnt, free_nodes.end());
+
+            free_nodes.resize(free_nodes.size() - cnt);
+
+            for (uint32_t i = 0; i + 1u < cnt; i++) {
+                chain[i]->next_ = chain[i + 1u];
+            }
+
+            lflist_push_batch(&list, chain.front(), chain.back());
+
+            for (uint32_t i = cnt; i-- > 0u;) {
+                ref.push_back(chain[i]);
+            }
+        } else if (op < 85u) {
+            lfnode_t* node = lflist_pop(&list);
+            lfnode_t* expect = ref.empty() ? nullptr : ref.back();
+
+            if (node != expect) {
+                lb_fuzz_fail("lflist", o.seed, step, "pop is not LIFO");
+            }
+
+            if (node) {
+                ref.pop_back();
+                free_nodes.push_back(node);
+            }
+        } else {
+            const uint32_t want = 1u + rng.below(8u);
+            uint32_t cnt = 0;
+            lfnode_t* node = lflist_pop_batch(&list, want, &cnt);
+
+            if (cnt != std::min<size_t>(want, ref.size())) {
+                lb_fuzz_fail("lflist", o.seed, step, "pop_batch returned the wrong count");
+            }
+
+            for (uint32_t i = 0; i < cnt; i++, node = node->next_) {
+                if (!node || node != ref.back()) {
+                    lb_fuzz_fail("lflist", o.seed, step, "pop_batch chain is out of order");
+                }
+
+                ref.pop_back();
+                free_nodes.push_back(node);
+            }
+
+            if (node) {
+                lb_fuzz_fail("lflist", o.seed, step, "pop_batch chain is not terminated");
+            }
+        }
+    }
+
+    lb_fuzz_pass("lflist", o.seed, o.fuzz_ops);
+}
@@ -0,0 +1,320 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/maple_tree.h>
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "libbench.h"
+
+/*
+ * The tree reads {start, end} from the first two words of every entry, the
+ * way vma_region_t is laid out, so the items mimic that. Ranges are
+ * non-overlapping and stored as [start, end - 1], as mm/vma.cpp does.
+ */
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} mt_item_t;
+
+static int mt_item_store(maple_tree_t* mt, mt_item_t* it) {
+    return mt_store(mt, it->start, it->end - 1u, it);
+}
+
+static int mt_item_erase(maple_tree_t* mt, mt_item_t* it) {
+    return mt_erase(mt, it->start, it->end - 1u);
+}
+
+typedef std::map<uint32_t, mt_item_t*> mt_ref_t;
+
+/* The reference entry covering index, if any. */
+static mt_item_t* mt_ref_at(const mt_ref_t& ref, uint32_t index) {
+    auto r = ref.upper_bound(index);
+
+    if (r == ref.begin()) {
+        return nullptr;
+    }
+
+    --r;
+    return index < r->second->end ? r->second : nullptr;
+}
+
+/* The first reference entry ending after index, if any. */
+static mt_item_t* mt_ref_from(const mt_ref_t& ref, uint32_t index) {
+    mt_item_t* it = mt_ref_at(ref, index);
+
+    if (it) {
+        return it;
+    }
+
+    auto r = ref.upper_bound(index);
+    return r == ref.end() ? nullptr : r->second;
+}
+
+static bool mt_ref_free(const mt_ref_t& ref, uint32_t start, uint32_t end) {
+    mt_item_t* it = mt_ref_from(ref, start);
+    return !it || it->start >= end;
+}
+
+void lb_bench_maple(const lb_opts& o) {
+    mt_init_cache();
+
+    const uint32_t n = o.ops;
+    const uint32_t span = 16u;
+
+    /* Page-sized VMAs with one-page holes, like a busy address space. */
+    std::vector<mt_item_t> items(n);
+
+    for (uint32_t i = 0; i < n; i++) {
+        items[i].start = i * span;
+        items[i].end = i * span + span / 2u;
+    }
+
+    maple_tree_t mt;
+    mt_init(&mt);
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)mt_item_store(&mt, &items[i]);
+    }
+    lb_report_rate("maple/store", n, lb_now_ns() - t0);
+
+    lb_rng rng(o.seed);
+    uint32_t found = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += mt_load(&mt, rng.below(n * span)) ? 1u : 0u;
+    }
+    lb_report_rate("maple/load", n, lb_now_ns() - t0);
+
+    lb_latency lat;
+
+    for (uint32_t i = 0; i < n; i += 64u) {
+        const uint32_t idx = rng.below(n * span);
+
+        const uint64_t s = lb_now_ns();
+        found += mt_load(&mt, idx) ? 1u : 0u;
+        lat.add(lb_now_ns() - s);
+    }
+    lat.report("maple/load_lat");
+
+    uint32_t walked = 0;
+    uint32_t idx = 0;
+
+    /* mt_next() steps past the entry ending at idx, so start from the first entry's last index. */
+    t0 = lb_now_ns();
+    if (mt_item_t* first = (mt_item_t*)mt_load(&mt, 0u)) {
+        idx = first->end - 1u;
+        walked++;
+
+        while (mt_next(&mt, &idx)) {
+            walked++;
+        }
+    }
+    lb_report_rate("maple/next", walked, lb_now_ns() - t0);
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t out = 0;
+        found += mt_gap_find(&mt, span / 2u, &out, rng.below(n * span), 0xFFFFFFFFu) ? 1u : 0u;
+    }
+    lb_report_rate("maple/gap_find", n, lb_now_ns() - t0);
+
+    /* Page-fault style lookups scale with readers; one in 16 operations remaps a VMA. */
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t t) {
+            lb_rng r(o.seed + t);
+
+            for (uint32_t i = 0; i < per; i++) {
+                if ((i & 15u) == 15u) {
+                    mt_item_t* it = &items[t * per + r.below(per)];
+
+                    (void)mt_item_erase(&mt, it);
+                    (void)mt_item_store(&mt, it);
+                } else {
+                    (void)mt_load(&mt, r.below(n * span));
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "maple/mixed/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads, ns);
+
+        lb_rcu_quiesce();
+    }
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)mt_item_erase(&mt, &items[i]);
+    }
+    lb_report_rate("maple/erase", n, lb_now_ns() - t0);
+
+    if (found == 0u || walked != n || !mt_empty(&mt)) {
+        lb_fuzz_fail("maple", o.seed, 0u, "bench left the tree inconsistent");
+    }
+
+    mt_destroy(&mt);
+    lb_rcu_quiesce();
+}
+
+void lb_fuzz_maple(const lb_opts& o) {
+    mt_init_cache();
+
+    const uint32_t space = 1u << 16;
+    const uint32_t max_len = 64u;
+
+    maple_tree_t mt;
+    mt_init(&mt);
+
+    mt_ref_t ref;
+    std::vector<mt_item_t*> live;
+
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t op = rng.below(100u);
+        const uint32_t index = rng.below(space);
+
+        if (op < 35u) {
+            const uint32_t end = index + 1u + rng.below(max_len);
+
+            if (!mt_ref_free(ref, index, end)) {
+                continue;
+            }
+
+            mt_item_t* it = new mt_item_t{ index, end };
+
+            if (mt_item_store(&mt, it) != 0) {
+                lb_fuzz_fail("maple", o.seed, step, "store into a free range failed");
+            }
+
+            ref.emplace(index, it);
+            live.push_back(it);
+        } else if (op < 65u) {
+            if (live.empty()) {
+                continue;
+            }
+
+            const uint32_t pick = rng.below((uint32_t)live.size());
+            mt_item_t* it = live[pick];
+
+            if (mt_item_erase(&mt, it) != 0) {
+                lb_fuzz_fail("maple", o.seed, step, "erase of a stored range failed");
+            }
+
+            if (mt_load(&mt, it->start) == it) {
+                lb_fuzz_fail("maple", o.seed, step, "erased range still loads");
+            }
+
+            ref.erase(it->start);
+            live[pick] = live.back();
+            live.pop_back();
+
+            /* Readers never run concurrently here, so the item can go right away. */
+            delete it;
+        } else if (op < 80u) {
+            /* Like mm/vma.cpp expects: the first entry ending past index; callers check the start. */
+            if (mt_load(&mt, index) != mt_ref_from(ref, index)) {
+                lb_fuzz_fail("maple", o.seed, step, "load disagrees");
+            }
+        } else if (op < 86u) {
+            uint32_t idx = index;
+            mt_item_t* expect = mt_ref_from(ref, index);
+            void* got = mt_find_after(&mt, idx);
+
+            if (got != expect) {
+                lb_fuzz_fail("maple", o.seed, step, "find_after disagrees");
+            }
+        } else if (op < 92u) {
+            uint32_t idx = index;
+            mt_item_t* expect = index == 0xFFFFFFFFu ? nullptr : mt_ref_from(ref, index + 1u);
+            const int got = mt_next(&mt, &idx);
+
+            if ((got != 0) != (expect != nullptr)
+                || (got && (idx < expect->start || idx >= expect->end))) {
+                lb_fuzz_fail("maple", o.seed, step, "next disagrees");
+            }
+        } else if (op < 97u) {
+            uint32_t idx = index;
+            mt_item_t* expect = nullptr;
+
+            /* mt_prev() reports the last entry ending at or below index, as the VMA merge code wants. */
+            auto r = ref.lower_bound(index);
+
+            while (r != ref.begin()) {
+                --r;
+
+                if (r->second->end <= index) {
+                    expect = r->second;
+                    break;
+                }
+            }
+
+            const int got = mt_prev(&mt, &idx);
+
+            if ((got != 0) != (expect != nullptr)
+                || (got && (idx < expect->start || idx >= expect->end))) {
+                lb_fuzz_fail("maple", o.seed, step, "prev disagrees");
+            }
+        } else {
+            const uint32_t size = 1u + rng.below(max_len * 2u);
+            const uint32_t ceiling = index + rng.below(space);
+
+            /* Lowest gap of at least size at or above index that ends by ceiling. */
+            uint32_t cur = index;
+            bool expect_ok = false;
+
+            for (auto r = ref.begin(); ; ++r) {
+                const uint32_t next_start = r == ref.end() ? 0xFFFFFFFFu : r->second->start;
+
+                if (r != ref.end() && r->second->end <= cur) {
+                    continue;
+                }
+
+                const uint32_t gap_end = std::min(next_start, ceiling);
+
+                if (gap_end > cur && gap_end - cur >= size) {
+                    expect_ok = true;
+                    break;
+                }
+
+                if (r == ref.end() || r->second->end >= ceiling) {
+                    break;
+                }
+
+                cur = std::max(cur, r->second->end);
+            }
+
+            uint32_t out = 0;
+            const int got = mt_gap_find(&mt, size, &out, index, ceiling);
+
+            if ((got != 0) != expect_ok || (got && out != cur)) {
+                lb_fuzz_fail("maple", o.seed, step, "gap_find disagrees");
+            }
+        }
+
+        if ((step & 4095u) == 4095u) {
+            lb_rcu_quiesce();
+        }
+    }
+
+    for (mt_item_t* it : live) {
+        (void)mt_item_erase(&mt, it);
+        delete it;
+    }
+
+    if (!mt_empty(&mt)) {
+        lb_fuzz_fail("maple", o.seed, o.fuzz_ops, "tree not empty after erasing everything");
+    }
+
+    mt_destroy(&mt);
+    lb_rcu_quiesce();
+
+    lb_fuzz_pass("maple", o.seed, o.fuzz_ops);
+}
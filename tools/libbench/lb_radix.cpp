@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/radixtree.h>
+#include <lib/idr.h>
+
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "libbench.h"
+
+/* Values are never dereferenced; any non-NULL word tells the slots apart. */
+static void* radix_value(uint32_t key) {
+    return (void*)(((uintptr_t)key << 4u) | 8u);
+}
+
+/* Dense low keys plus a sparse tail, so both wide nodes and tall trees get built. */
+static uint32_t radix_fuzz_key(lb_rng& rng) {
+    const uint32_t r = rng.below(8u);
+
+    if (r < 5u) {
+        return rng.below(1024u);
+    }
+
+    if (r < 7u) {
+        return rng.below(1u << 20);
+    }
+
+    return (uint32_t)rng.next();
+}
+
+void lb_bench_radixtree(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    radix_tree_t tree;
+    radix_tree_init(&tree);
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)radix_tree_insert(&tree, i, radix_value(i));
+    }
+    lb_report_rate("radixtree/insert_dense", n, lb_now_ns() - t0);
+
+    lb_rng rng(o.seed);
+    uint32_t found = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += radix_tree_lookup(&tree, rng.below(n)) ? 1u : 0u;
+    }
+    lb_report_rate("radixtree/lookup", n, lb_now_ns() - t0);
+
+    lb_latency lat;
+
+    for (uint32_t i = 0; i < n; i += 64u) {
+        const uint32_t key = rng.below(n);
+
+        const uint64_t s = lb_now_ns();
+        found += radix_tree_lookup(&tree, key) ? 1u : 0u;
+        lat.add(lb_now_ns() - s);
+    }
+    lat.report("radixtree/lookup_lat");
+
+    uint32_t walked = 0;
+    uint32_t key = 0;
+
+    t0 = lb_now_ns();
+    while (radix_tree_find_next(&tree, &key)) {
+        walked++;
+
+        if (++key == 0u) {
+            break;
+        }
+    }
+    lb_report_rate("radixtree/find_next", walked, lb_now_ns() - t0);
+
+    /* Readers are lockless; each thread also churns a private key range above the prefill. */
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t t) {
+            lb_rng r(o.seed + t);
+            const uint32_t own = n + t * per;
+
+            for (uint32_t i = 0; i < per; i++) {
+                if ((i & 7u) == 7u) {
+                    const uint32_t k = own + (i & 255u);
+
+                    if (radix_tree_insert(&tree, k, radix_value(k)) != 0) {
+                        (void)radix_tree_remove(&tree, k);
+                    }
+                } else {
+                    (void)radix_tree_lookup(&tree, r.below(n));
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "radixtree/mixed/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads, ns);
+
+        for (uint32_t t = 0; t < threads; t++) {
+            for (uint32_t i = 0; i < 256u; i++) {
+                (void)radix_tree_remove(&tree, n + t * per + i);
+            }
+        }
+
+        lb_rcu_quiesce();
+    }
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)radix_tree_remove(&tree, i);
+    }
+    lb_report_rate("radixtree/remove", n, lb_now_ns() - t0);
+
+    if (found == 0u || walked != n) {
+        lb_fuzz_fail("radixtree", o.seed, 0u, "bench saw missing keys");
+    }
+
+    radix_tree_destroy(&tree);
+    lb_rcu_quiesce();
+}
+
+void lb_fuzz_radixtree(const lb_opts& o) {
+    radix_tree_t tree;
+    radix_tree_init(&tree);
+
+    std::map<uint32_t, void*> ref;
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t key = radix_fuzz_key(rng);
+        const uint32_t op = rng.below(100u);
+
+        if (op < 40u) {
+            const bool fresh = ref.find(key) == ref.end();
+            const int rc = radix_tree_insert(&tree, key, radix_value(key));
+
+            if ((rc == 0) != fresh) {
+                lb_fuzz_fail("radixtree", o.seed, step, "insert disagrees on collision");
+            }
+
+            ref.emplace(key, radix_value(key));
+        } else if (op < 75u) {
+            auto r = ref.find(key);
+            void* expect = r == ref.end() ? nullptr : r->second;
+
+            if (radix_tree_remove(&tree, key) != expect) {
+                lb_fuzz_fail("radixtree", o.seed, step, "remove returned the wrong value");
+            }
+
+            if (r != ref.end()) {
+                ref.erase(r);
+            }
+        } else if (op < 90u) {
+            auto r = ref.find(key);
+
+            if (radix_tree_lookup(&tree, key) != (r == ref.end() ? nullptr : r->second)) {
+                lb_fuzz_fail("radixtree", o.seed, step, "lookup disagrees");
+            }
+        } else {
+            auto r = ref.lower_bound(key);
+            uint32_t k = key;
+            void* v = radix_tree_find_next(&tree, &k);
+
+            if (r == ref.end() ? v != nullptr : (v != r->second || k != r->first)) {
+                lb_fuzz_fail("radixtree", o.seed, step, "find_next disagrees");
+            }
+        }
+
+        if ((step & 4095u) == 4095u) {
+            lb_rcu_quiesce();
+        }
+    }
+
+    for (auto& kv : ref) {
+        (void)radix_tree_remove(&tree, kv.first);
+    }
+
+    radix_tree_destroy(&tree);
+    lb_rcu_quiesce();
+
+    lb_fuzz_pass("radixtree", o.seed, o.fuzz_ops);
+}
+
+void lb_bench_idr(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    idr_t idr;
+    idr_init(&idr);
+
+    std::vector<int> ids(n);
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        ids[i] = idr_alloc(&idr, radix_value(i));
+    }
+    lb_report_rate("idr/alloc", n, lb_now_ns() - t0);
+
+    lb_rng rng(o.seed);
+    uint32_t found = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += idr_find(&idr, ids[rng.below(n)]) ? 1u : 0u;
+    }
+    lb_report_rate("idr/find", n, lb_now_ns() - t0);
+
+    /* Steady state of a handle table: free a random id and allocate a new one. */
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        const uint32_t slot = rng.below(n);
+
+        idr_remove(&idr, ids[slot]);
+        ids[slot] = idr_alloc(&idr, radix_value(slot));
+    }
+    lb_report_rate("idr/churn", n, lb_now_ns() - t0);
+
+    for (uint32_t i = 0; i < n; i++) {
+        idr_remove(&idr, ids[i]);
+    }
+
+    if (found != n) {
+        lb_fuzz_fail("idr", o.seed, 0u, "bench lost ids");
+    }
+
+    idr_destroy(&idr);
+    lb_rcu_quiesce();
+}
+
+void lb_fuzz_idr(const lb_opts& o) {
+    idr_t idr;
+    idr_init(&idr);
+
+    /* idr hands out the lowest free id at or after its cursor, wrapping to 1. */
+    std::map<int, void*> ref;
+    uint32_t next_id = 1u;
+
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t op = rng.below(100u);
+
+        if (op < 45u || ref.empty()) {
+            uint32_t expect = next_id;
+
+            while (ref.count((int)expect)) {
+                expect++;
+            }
+
+            void* value = radix_value(step);
+            const int id = idr_alloc(&idr, value);
+
+            if (id != (int)expect) {
+                lb_fuzz_fail("idr", o.seed, step, "alloc returned an unexpected id");
+            }
+
+            ref.emplace(id, value);
+            next_id = expect + 1u;
+        } else if (op < 85u) {
+            auto r = ref.begin();
+            std::advance(r, rng.below((uint32_t)std::min<size_t>(ref.size(), 64u)));
+
+            idr_remove(&idr, r->first);
+
+            if (idr_find(&idr, r->first) != nullptr) {
+                lb_fuzz_fail("idr", o.seed, step, "removed id still found");
+            }
+
+            ref.erase(r);
+        } else {
+            const int id = 1 + (int)rng.below(next_id + 16u);
+            auto r = ref.find(id);
+
+            if (idr_find(&idr, id) != (r == ref.end() ? nullptr : r->second)) {
+                lb_fuzz_fail("idr", o.seed, step, "find disagrees");
+            }
+        }
+
+        if ((step & 4095u) == 4095u) {
+            lb_rcu_quiesce();
+        }
+    }
+
+    for (auto& kv : ref) {
+        idr_remove(&idr, kv.first);
+    }
+
+    idr_destroy(&idr);
+    lb_rcu_quiesce();
+
+    lb_fuzz_pass("idr", o.seed, o.fuzz_ops);
+}
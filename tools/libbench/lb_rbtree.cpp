@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/rbtree.h>
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "libbench.h"
+
+typedef struct {
+    struct rb_node node;
+    uint32_t key;
+} rb_item_t;
+
+static rb_item_t* rb_item_find(struct rb_root* root, uint32_t key) {
+    struct rb_node* n = root->rb_node;
+
+    while (n) {
+        rb_item_t* it = rb_entry(n, rb_item_t, node);
+
+        if (key < it->key) {
+            n = n->rb_left;
+        } else if (key > it->key) {
+            n = n->rb_right;
+        } else {
+            return it;
+        }
+    }
+
+    return nullptr;
+}
+
+static bool rb_item_insert(struct rb_root* root, rb_item_t* item) {
+    struct rb_node** link = &root->rb_node;
+    struct rb_node* parent = nullptr;
+
+    while (*link) {
+        rb_item_t* it = rb_entry(*link, rb_item_t, node);
+        parent = *link;
+
+        if (item->key < it->key) {
+            link = &(*link)->rb_left;
+        } else if (item->key > it->key) {
+            link = &(*link)->rb_right;
+        } else {
+            return false;
+        }
+    }
+
+    rb_link_node(&item->node, parent, link);
+    rb_insert_color(&item->node, root);
+    return true;
+}
+
+/* Black height of the subtree, or -1 if a red-red edge or unequal black heights appear. */
+static int rb_check(const struct rb_node* n, const struct rb_node* parent) {
+    if (!n) {
+        return 1;
+    }
+
+    if (rb_parent(n) != parent) {
+        return -1;
+    }
+
+    const bool red = (n->__parent_color & 1u) == 0u;
+
+    if (red && ((n->rb_left && (n->rb_left->__parent_color & 1u) == 0u)
+        || (n->rb_right && (n->rb_right->__parent_color & 1u) == 0u))) {
+        return -1;
+    }
+
+    const int lh = rb_check(n->rb_left, n);
+    const int rh = rb_check(n->rb_right, n);
+
+    if (lh < 0 || lh != rh) {
+        return -1;
+    }
+
+    return lh + (red ? 0 : 1);
+}
+
+void lb_bench_rbtree(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    std::vector<rb_item_t> items(n);
+    lb_rng rng(o.seed);
+
+    for (uint32_t i = 0; i < n; i++) {
+        items[i].key = (uint32_t)rng.next();
+    }
+
+    struct rb_root root = RB_ROOT;
+    uint32_t inserted = 0;
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        inserted += rb_item_insert(&root, &items[i]) ? 1u : 0u;
+    }
+    lb_report_rate("rbtree/insert", n, lb_now_ns() - t0);
+
+    lb_latency lat;
+    uint32_t found = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += rb_item_find(&root, items[rng.below(n)].key) ? 1u : 0u;
+    }
+    lb_report_rate("rbtree/lookup", n, lb_now_ns() - t0);
+
+    for (uint32_t i = 0; i < n; i += 64u) {
+        const uint32_t key = items[rng.below(n)].key;
+
+        const uint64_t s = lb_now_ns();
+        found += rb_item_find(&root, key) ? 1u : 0u;
+        lat.add(lb_now_ns() - s);
+    }
+    lat.report("rbtree/lookup_lat");
+
+    t0 = lb_now_ns();
+    for (struct rb_node* it = rb_first(&root); it; it = rb_next(it)) {
+        found++;
+    }
+    lb_report_rate("rbtree/iterate", inserted, lb_now_ns() - t0);
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        rb_item_t* it = rb_item_find(&root, items[i].key);
+
+        if (it == &items[i]) {
+            rb_erase(&it->node, &root);
+        }
+    }
+    lb_report_rate("rbtree/erase", n, lb_now_ns() - t0);
+
+    if (root.rb_node || found == 0u) {
+        lb_fuzz_fail("rbtree", o.seed, 0u, "bench left the tree inconsistent");
+    }
+}
+
+void lb_fuzz_rbtree(const lb_opts& o) {
+    const uint32_t key_space = 4096u;
+
+    std::vector<rb_item_t> pool(key_space);
+    std::map<uint32_t, rb_item_t*> ref;
+
+    for (uint32_t i = 0; i < key_space; i++) {
+        pool[i].key = i;
+    }
+
+    struct rb_root root = RB_ROOT;
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t key = rng.below(key_space);
+        const uint32_t op = rng.below(100u);
+
+        if (op < 40u) {
+            const bool fresh = ref.find(key) == ref.end();
+
+            if (rb_item_insert(&root, &pool[key]) != fresh) {
+                lb_fuzz_fail("rbtree", o.seed, step, "insert disagrees on duplicate");
+            }
+
+            ref[key] = &pool[key];
+        } else if (op < 75u) {
+            rb_item_t* it = rb_item_find(&root, key);
+            const bool present = ref.erase(key) != 0u;
+
+            if ((it != nullptr) != present) {
+                lb_fuzz_fail("rbtree", o.seed, step, "find before erase disagrees");
+            }
+
+            if (it) {
+                rb_erase(&it->node, &root);
+            }
+        } else if (op < 97u) {
+            auto r = ref.find(key);
+            rb_item_t* it = rb_item_find(&root, key);
+
+            if (it != (r == ref.end() ? nullptr : r->second)) {
+                lb_fuzz_fail("rbtree", o.seed, step, "lookup disagrees");
+            }
+
+            /* Neighbours through rb_next/rb_prev must match the ordered reference. */
+            if (it) {
+                auto nx = std::next(r);
+                struct rb_node* rn = rb_next(&it->node);
+
+                if ((rn ? rb_entry(rn, rb_item_t, node) : nullptr) != (nx == ref.end() ? nullptr : nx->second)) {
+                    lb_fuzz_fail("rbtree", o.seed, step, "rb_next disagrees");
+                }
+
+                struct rb_node* rp = rb_prev(&it->node);
+
+                if ((rp ? rb_entry(rp, rb_item_t, node) : nullptr) != (r == ref.begin() ? nullptr : std::prev(r)->second)) {
+                    lb_fuzz_fail("rbtree", o.seed, step, "rb_prev disagrees");
+                }
+            }
+        } else {
+            if (rb_check(root.rb_node, nullptr) < 0) {
+                lb_fuzz_fail("rbtree", o.seed, step, "red-black invariants broken");
+            }
+
+            auto r = ref.begin();
+
+            for (struct rb_node* it = rb_first(&root); it; it = rb_next(it), ++r) {
+                if (r == ref.end() || rb_entry(it, rb_item_t, node) != r->second) {
+                    lb_fuzz_fail("rbtree", o.seed, step, "in-order walk disagrees");
+                }
+            }
+
+            if (r != ref.end()) {
+                lb_fuzz_fail("rbtree", o.seed, step, "in-order walk ends early");
+            }
+        }
+    }
+
+    lb_fuzz_pass("rbtree", o.seed, o.fuzz_ops);
+}
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/rhashtable.h>
+
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include "libbench.h"
+
+struct rh_item {
+    kernel::RHashNode node;
+    uint32_t key;
+    uint32_t value;
+};
+
+struct rh_key {
+    const uint32_t& operator()(const rh_item& it) const noexcept {
+        return it.key;
+    }
+};
+
+/* Small initial table so the benchmarks and the fuzzer also go through resizes. */
+typedef kernel::RHashTable<uint32_t, rh_item, &rh_item::node, rh_key, kernel::HashTraits<uint32_t>, 16> lb_rhash_t;
+
+static bool rh_lookup(const lb_rhash_t& table, uint32_t key, uint32_t* out) {
+    return table.with_value_unlocked(key, [out](rh_item* it) {
+        *out = it->value;
+        return true;
+    });
+}
+
+void lb_bench_rhashtable(const lb_opts& o) {
+    const uint32_t n = o.ops;
+
+    std::vector<rh_item> items(n + o.max_threads * 256u);
+
+    for (uint32_t i = 0; i < items.size(); i++) {
+        items[i].key = i;
+        items[i].value = i;
+    }
+
+    lb_rhash_t* table = new lb_rhash_t();
+
+    uint64_t t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)table->insert_unique(&items[i]);
+    }
+    lb_report_rate("rhashtable/insert", n, lb_now_ns() - t0);
+
+    lb_rng rng(o.seed);
+    uint32_t found = 0;
+    uint32_t v = 0;
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        found += rh_lookup(*table, rng.below(2u * n), &v) ? 1u : 0u;
+    }
+    lb_report_rate("rhashtable/lookup", n, lb_now_ns() - t0);
+
+    lb_latency lat;
+
+    for (uint32_t i = 0; i < n; i += 64u) {
+        const uint32_t key = rng.below(n);
+
+        const uint64_t s = lb_now_ns();
+        found += rh_lookup(*table, key, &v) ? 1u : 0u;
+        lat.add(lb_now_ns() - s);
+    }
+    lat.report("rhashtable/lookup_lat");
+
+    /* Lookups are lockless, so this is the scaling case HashMap's bucket locks are compared to. */
+    for (uint32_t threads = 1; threads <= o.max_threads; threads *= 2u) {
+        const uint32_t per = n / threads;
+
+        const uint64_t ns = lb_run_threads(threads, [&](uint32_t t) {
+            lb_rng r(o.seed + t);
+            rh_item* own = &items[n + t * 256u];
+            uint32_t out = 0;
+
+            for (uint32_t i = 0; i < per; i++) {
+                if ((i & 7u) == 7u) {
+                    rh_item* it = &own[i & 255u];
+
+                    if (table->insert_unique(it) != lb_rhash_t::InsertResult::Inserted) {
+                        (void)table->remove(it->key);
+                    }
+                } else {
+                    (void)rh_lookup(*table, r.below(n), &out);
+                }
+            }
+        });
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "rhashtable/mixed/%ut", threads);
+        lb_report_rate(name, (uint64_t)per * threads, ns);
+
+        for (uint32_t k = n; k < n + threads * 256u; k++) {
+            (void)table->remove(k);
+        }
+
+        lb_rcu_quiesce();
+    }
+
+    t0 = lb_now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        (void)table->remove(i);
+    }
+    lb_report_rate("rhashtable/remove", n, lb_now_ns() - t0);
+
+    if (found == 0u || rh_lookup(*table, 0u, &v)) {
+        lb_fuzz_fail("rhashtable", o.seed, 0u, "bench left the table inconsistent");
+    }
+
+    lb_rcu_quiesce();
+    delete table;
+}
+
+void lb_fuzz_rhashtable(const lb_opts& o) {
+    const uint32_t key_space = 8192u;
+
+    std::vector<rh_item> pool(key_space);
+    std::unordered_map<uint32_t, uint32_t> ref;
+
+    lb_rhash_t* table = new lb_rhash_t();
+    lb_rng rng(o.seed);
+
+    for (uint32_t step = 0; step < o.fuzz_ops; step++) {
+        const uint32_t key = rng.below(key_space);
+        const uint32_t op = rng.below(100u);
+
+        uint32_t out = 0;
+
+        if (op < 40u) {
+            const bool fresh = ref.find(key) == ref.end();
+
+            /* A live item is never touched; only free pool slots get a new value. */
+            if (fresh) {
+                pool[key].key = key;
+                pool[key].value = (uint32_t)rng.next();
+            }
+
+            rh_item probe;
+            probe.key = key;
+            probe.value = 0u;
+
+            const auto res = table->insert_unique(fresh ? &pool[key] : &probe);
+
+            if (res != (fresh ? lb_rhash_t::InsertResult::Inserted : lb_rhash_t::InsertResult::AlreadyPresent)) {
+                lb_fuzz_fail("rhashtable", o.seed, step, "insert_unique disagrees");
+            }
+
+            ref.emplace(key, pool[key].value);
+        } else if (op < 75u) {
+            const bool present = ref.erase(key) != 0u;
+            rh_item* it = table->remove(key);
+
+            if (it != (present ? &pool[key] : nullptr)) {
+                lb_fuzz_fail("rhashtable", o.seed, step, "remove disagrees");
+            }
+        } else {
+            auto r = ref.find(key);
+            const bool got = rh_lookup(*table, key, &out);
+
+            if (got != (r != ref.end()) || (got && out != r->second)) {
+                lb_fuzz_fail("rhashtable", o.seed, step, "lookup disagrees");
+            }
+        }
+
+        if ((step & 4095u) == 4095u) {
+            lb_rcu_quiesce();
+        }
+    }
+
+    lb_rcu_quiesce();
+    delete table;
+
+    lb_fuzz_pass("rhashtable", o.seed, o.fuzz_ops);
+}
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <lib/compiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "libbench.h"
+
+/* Last: in C++ it defines likely/unlikely as macros, which the std headers must not see. */
+#include <lib/ringbuf.h>
+
+void lb_bench_ringbuf(const lb_opts& o) {
+    static const size_t chunks[] = { 1u, 64u, 1024u };
+
+    const size_t cap = 64u * 1024u;
+
+    std::vector<uint8_t> storage(cap);
+    std::vector<uint8_t> src(4096u, 0xA5u);
+    std::vector<uint8_t> dst(4096u);
+
+    ringbuf_t rb{};
+    ringbuf_init(&rb, storage.data(), cap);
+
+    /* Pipe-like traffic: the writer keeps the buffer half full while the reader drains it. */
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        const size_t chunk = chunks[c];
+        const uint64_t total = (uint64_t)o.ops * 64u;
+
+        ringbuf_clear(&rb);
+
+        uint64_t moved = 0;
+        const uint64_t t0 = lb_now_ns();
+
+        while (moved < total) {
+            (void)ringbuf_write(&rb, src.data(), chunk);
+
+            if (ringbuf_size(&rb) >= cap / 2u) {
+                moved += ringbuf_read(&rb, dst.data(), chunk);
+            }
+        }
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "ringbuf/copy/%zub", chunk);
+        lb_report_rate(name, moved / chunk, lb_now_ns() - t0);
+    }
+
+    ringbuf_clear(&rb);
+
+    const uint64_t t0 = lb_now_ns();
+    uint64_t bytes = 0;
+
+    for (uint32_t i = 0; i < o.ops; i++) {
+        (void)ringbuf_write(&rb, src.data(), 1024u);
+
+        const uint8_t* p = nullptr;
+        const size_t len = ringbuf_peek_contiguous(&rb, &p);
+
+        ringbuf_consume(&rb, len);
+        bytes += len;
+    }
+
+    lb_report_rate("ringbuf/peek_consume", o.ops, lb_now_ns() - t0);
+
+    if (bytes == 0u || dst[0] != 0xA5u) {
+        lb_fuzz_fail("ringbuf", o.seed, 0u, "bench moved no data");
+    }
+}
+
+void lb_fuzz_ringbuf(const lb_opts& o) {
+    lb_rng rng(o.seed);
+
+    for (uint32_t round = 0, step = 0; step < o.fuzz_ops; round++) {
+        /* Odd capacities too, so wrap-around lands on every offset. */
+        const size_t cap = 1u + rng.below(300u);
+
+        std::vector<uint8_t> storage(cap);
+        std::deque<uint8_t> ref;
+
+        ringbuf_t rb{};
+        ringbuf_init(&rb, storage.data(), cap);
+
+        uint8_t next_byte = (uint8_t)round;
+
+        for (uint32_t i = 0; i < 4096u && step < o.fuzz_ops; i++, step++) {
+            const uint32_t op = rng.below(100u);
+            const size_t len = rng.below((uint32_t)cap * 2u + 1u);
+
+            if (op < 30u) {
+                std::vector<uint8_t> in(len);
+
+                for (size_t k = 0; k < len; k++) {
+                    in[k] = next_byte++;
+                }
+
+                const size_t want = std::min(len, cap - ref.size());
+                const size_t got = ringbuf_write(&rb, in.data(), len);
+
+                if (got != want) {
+                    lb_fuzz_fail("ringbuf", o.seed, step, "write accepted the wrong length");
+                }
+
+                /* Bytes that did not fit are dropped from the stream, as a producer would. */
+                ref.insert(ref.end(), in.begin(), in.begin() + (ptrdiff_t)got);
+                next_byte = (uint8_t)(next_byte - (uint8_t)(len - got));
+            } else if (op < 40u) {
+                const size_t want = ref.size() < cap ? 1u : 0u;
+
+                if (ringbuf_push(&rb, next_byte) != want) {
+                    lb_fuzz_fail("ringbuf", o.seed, step, "push disagrees on free space");
+                }
+
+                if (want) {
+                    ref.push_back(next_byte++);
+                }
+            } else if (op < 70u) {
+                std::vector<uint8_t> out(len + 1u);
+
+                const size_t want = std::min(len, ref.size());
+                const size_t got = ringbuf_read(&rb, out.data(), len);
+
+                if (got != want) {
+                    lb_fuzz_fail("ringbuf", o.seed, step, "read returned the wrong length");
+                }
+
+                for (size_t k = 0; k < got; k++) {
+                    if (out[k] != ref.front()) {
+                        lb_fuzz_fail("ringbuf", o.seed, step, "read returned the wrong bytes");
+                    }
+
+                    ref.pop_front();
+                }
+            } else if (op < 80u) {
+                uint8_t b = 0;
+                const size_t got = ringbuf_pop(&rb, &b);
+
+                if (got != (ref.empty() ? 0u : 1u) || (got && b != ref.front())) {
+                    lb_fuzz_fail("ringbuf", o.seed, step, "pop disagrees");
+                }
+
+                if (got) {
+                    ref.pop_front();
+                }
+            } else if (op < 97u) {
+                const uint8_t* p = nullptr;
+                const size_t contig = ringbuf_peek_contiguous(&rb, &p);
+
+                if ((contig == 0u) != ref.empty() || contig > ref.size()) {
+                    lb_fuzz_fail("ringbuf", o.seed, step, "peek length disagrees");
+                }
+
+                for (size_t k = 0; k < contig; k++) {
+                    if (p[k] != ref[k]) {
+                        lb_fuzz_fail("ringbuf", o.seed, step, "peek bytes disagree");
+                    }
+                }
+
+                const size_t drop = std::min(len, contig);
+
+                ringbuf_consume(&rb, drop);
+                ref.erase(ref.begin(), ref.begin() + (ptrdiff_t)drop);
+            } else {
+                ringbuf_clear(&rb);
+                ref.clear();
+            }
+
+            if (ringbuf_size(&rb) != ref.size() || ringbuf_free_space(&rb) != cap - ref.size()) {
+                lb_fuzz_fail("ringbuf", o.seed, step, "size bookkeeping disagrees");
+            }
+        }
+    }
+
+    lb_fuzz_pass("ringbuf", o.seed, o.fuzz_ops);
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef TOOLS_LIBBENCH_H
+#define TOOLS_LIBBENCH_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+struct lb_opts {
+    /* Operations per benchmark phase and per fuzz run. */
+    uint32_t ops;
+    uint32_t fuzz_ops;
+
+    /* Largest thread count of the scaling runs; they double from 1. */
+    uint32_t max_threads;
+
+    uint64_t seed;
+};
+
+/* splitmix64: cheap, seedable and identical everywhere, so a failing seed replays. */
+struct lb_rng {
+    uint64_t state;
+
+    explicit lb_rng(uint64_t seed) : state(seed) {
+    }
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(next() % n);
+    }
+};
+
+uint64_t lb_now_ns();
+
+/* Per-operation latencies of one phase, reported as min/median/p99. */
+class lb_latency {
+public:
+    void add(uint64_t ns) {
+        samples_.push_back(ns > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)ns);
+    }
+
+    void report(const char* name);
+
+private:
+    std::vector<uint32_t> samples_;
+};
+
+/* "libbench: name=<name> ops= total_ns= ops_per_s=" */
+void lb_report_rate(const char* name, uint64_t ops, uint64_t ns);
+
+/* Run fn(thread_index) on `threads` threads released together; returns the wall time. */
+uint64_t lb_run_threads(uint32_t threads, const std::function<void(uint32_t)>& fn);
+
+/* Run the deferred RCU callbacks; only call with no worker threads left. */
+void lb_rcu_quiesce();
+
+/* Print the divergence from the reference container and exit non-zero. */
+[[noreturn]] void lb_fuzz_fail(const char* name, uint64_t seed, uint32_t step, const char* what);
+
+void lb_fuzz_pass(const char* name, uint64_t seed, uint32_t ops);
+
+void lb_bench_rbtree(const lb_opts& o);
+void lb_fuzz_rbtree(const lb_opts& o);
+
+void lb_bench_radixtree(const lb_opts& o);
+void lb_fuzz_radixtree(const lb_opts& o);
+
+void lb_bench_idr(const lb_opts& o);
+void lb_fuzz_idr(const lb_opts& o);
+
+void lb_bench_maple(const lb_opts& o);
+void lb_fuzz_maple(const lb_opts& o);
+
+void lb_bench_hashmap(const lb_opts& o);
+void lb_fuzz_hashmap(const lb_opts& o);
+
+void lb_bench_chashmap(const lb_opts& o);
+void lb_fuzz_chashmap(const lb_opts& o);
+
+void lb_bench_rhashtable(const lb_opts& o);
+void lb_fuzz_rhashtable(const lb_opts& o);
+
+void lb_bench_ringbuf(const lb_opts& o);
+void lb_fuzz_ringbuf(const lb_opts& o);
+
+void lb_bench_lflist(const lb_opts& o);
+void lb_fuzz_lflist(const lb_opts& o);
+
+#endif
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <kernel/rcu.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "libbench.h"
+
+/*
+ * Host benchmark and differential fuzzer for the src/lib containers.
+ *
+ * The container sources are compiled unmodified against the shim/ headers
+ * and shim.cpp. Benchmarks print one "libbench: name=... key=value" line
+ * per phase, in the same shape as the in-guest bench/kbench output.
+ * Fuzzing drives each container and a std:: reference with the same
+ * random operations and stops at the first divergence, printing the seed
+ * that replays it.
+ *
+ * Usage: libbench [bench|fuzz|all] [-n ops] [-f fuzz_ops] [-t threads] [-s seed] [container...]
+ */
+
+typedef struct {
+    const char* name;
+    void (*bench)(const lb_opts& o);
+    void (*fuzz)(const lb_opts& o);
+} lb_container_t;
+
+static const lb_container_t g_containers[] = {
+    { "rbtree",     lb_bench_rbtree,     lb_fuzz_rbtree },
+    { "radixtree",  lb_bench_radixtree,  lb_fuzz_radixtree },
+    { "idr",        lb_bench_idr,        lb_fuzz_idr },
+    { "maple",      lb_bench_maple,      lb_fuzz_maple },
+    { "hashmap",    lb_bench_hashmap,    lb_fuzz_hashmap },
+    { "chashmap",   lb_bench_chashmap,   lb_fuzz_chashmap },
+    { "rhashtable", lb_bench_rhashtable, lb_fuzz_rhashtable },
+    { "ringbuf",    lb_bench_ringbuf,    lb_fuzz_ringbuf },
+    { "lflist",     lb_bench_lflist,     lb_fuzz_lflist },
+};
+
+#define LB_CONTAINER_COUNT (sizeof(g_containers) / sizeof(g_containers[0]))
+
+uint64_t lb_now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+void lb_latency::report(const char* name) {
+    if (samples_.empty()) {
+        std::printf("libbench: name=%s skipped=nosamples\n", name);
+        return;
+    }
+
+    std::sort(samples_.begin(), samples_.end());
+
+    const size_t n = samples_.size();
+    size_t p99 = (n * 99u) / 100u;
+    if (p99 >= n) {
+        p99 = n - 1u;
+    }
+
+    std::printf(
+        "libbench: name=%s samples=%zu min_ns=%u median_ns=%u p99_ns=%u\n",
+        name, n, samples_[0], samples_[n / 2u], samples_[p99]
+    );
+
+    samples_.clear();
+}
+
+void lb_report_rate(const char* name, uint64_t ops, uint64_t ns) {
+    std::printf(
+        "libbench: name=%s ops=%llu total_ns=%llu ops_per_s=%llu\n",
+        name, (unsigned long long)ops, (unsigned long long)ns,
+        ns ? (unsigned long long)((ops * 1000000000ull) / ns) : 0ull
+    );
+}
+
+uint64_t lb_run_threads(uint32_t threads, const std::function<void(uint32_t)>& fn) {
+    std::atomic<uint32_t> ready{0u};
+    std::atomic<bool> go{false};
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+
+    for (uint32_t i = 0; i < threads; i++) {
+        pool.emplace_back([&, i] {
+            ready.fetch_add(1u);
+
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            fn(i);
+        });
+    }
+
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+
+    const uint64_t t0 = lb_now_ns();
+    go.store(true, std::memory_order_release);
+
+    for (std::thread& t : pool) {
+        t.join();
+    }
+
+    return lb_now_ns() - t0;
+}
+
+void lb_rcu_quiesce() {
+    synchronize_rcu();
+}
+
+void lb_fuzz_fail(const char* name, uint64_t seed, uint32_t step, const char* what) {
+    std::printf(
+        "libbench: fuzz=%s seed=%llu step=%u result=fail what=\"%s\"\n",
+        name, (unsigned long long)seed, step, what
+    );
+    std::fflush(stdout);
+    std::exit(1);
+}
+
+void lb_fuzz_pass(const char* name, uint64_t seed, uint32_t ops) {
+    std::printf("libbench: fuzz=%s seed=%llu ops=%u result=ok\n", name, (unsigned long long)seed, ops);
+}
+
+static void usage() {
+    std::printf("Usage: libbench [bench|fuzz|all] [-n ops] [-f fuzz_ops] [-t threads] [-s seed] [container...]\n");
+    std::printf("Containers:");
+
+    for (size_t i = 0; i < LB_CONTAINER_COUNT; i++) {
+        std::printf(" %s", g_containers[i].name);
+    }
+
+    std::printf("\n");
+}
+
+static const lb_container_t* find_container(const char* name) {
+    for (size_t i = 0; i < LB_CONTAINER_COUNT; i++) {
+        if (std::strcmp(g_containers[i].name, name) == 0) {
+            return &g_containers[i];
+        }
+    }
+
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    lb_opts o;
+    o.ops = 200000u;
+    o.fuzz_ops = 200000u;
+    o.max_threads = std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+    o.seed = 1u;
+
+    bool run_bench = true;
+    bool run_fuzz = true;
+
+    std::vector<const lb_container_t*> selected;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+
+        if (std::strcmp(arg, "bench") == 0) {
+            run_fuzz = false;
+        } else if (std::strcmp(arg, "fuzz") == 0) {
+            run_bench = false;
+        } else if (std::strcmp(arg, "all") == 0) {
+            run_bench = true;
+            run_fuzz = true;
+        } else if (i + 1 < argc && std::strcmp(arg, "-n") == 0) {
+            o.ops = (uint32_t)std::strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && std::strcmp(arg, "-f") == 0) {
+            o.fuzz_ops = (uint32_t)std::strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && std::strcmp(arg, "-t") == 0) {
+            o.max_threads = (uint32_t)std::strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && std::strcmp(arg, "-s") == 0) {
+            o.seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (const lb_container_t* c = find_container(arg)) {
+            selected.push_back(c);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (o.ops == 0u || o.fuzz_ops == 0u || o.max_threads == 0u || o.max_threads > MAX_CPUS) {
+        usage();
+        return 1;
+    }
+
+    if (selected.empty()) {
+        for (size_t i = 0; i < LB_CONTAINER_COUNT; i++) {
+            selected.push_back(&g_containers[i]);
+        }
+    }
+
+    for (const lb_container_t* c : selected) {
+        if (run_fuzz) {
+            c->fuzz(o);
+        }
+
+        if (run_bench) {
+            c->bench(o);
+        }
+
+        lb_rcu_quiesce();
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
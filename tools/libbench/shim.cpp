@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <kernel/locking/spinlock.h>
+#include <kernel/smp/cpu.h>
+#include <kernel/panic.h>
+#include <kernel/rcu.h>
+
+#include <lib/cpp/new.h>
+
+#include <mm/heap.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include "libbench.h"
+
+/*
+ * Kernel services the containers call, implemented on top of libc and
+ * pthreads. Only what src/lib needs: the heap, slab caches, RCU callbacks,
+ * the spinlock slow path, per-CPU identity and panic().
+ */
+
+cpu_t cpus[MAX_CPUS];
+int cpu_count = MAX_CPUS;
+
+static std::atomic<int> g_next_cpu{0};
+
+static thread_local cpu_t* t_cpu;
+
+extern "C" cpu_t* cpu_current(void) {
+    if (!t_cpu) {
+        const int idx = g_next_cpu.fetch_add(1, std::memory_order_relaxed) % MAX_CPUS;
+
+        cpus[idx].index = idx;
+        t_cpu = &cpus[idx];
+    }
+
+    return t_cpu;
+}
+
+extern "C" void kernel_panic(const char* message, const char* file, uint32_t line, void* regs) {
+    (void)regs;
+
+    std::fprintf(stderr, "libbench: panic: %s (%s:%u)\n", message, file, line);
+    std::abort();
+}
+
+/* No queueing: waiters spin on the lock word, yielding once in a while. */
+extern "C" void spinlock_acquire_slowpath(spinlock_t* lock) {
+    for (uint32_t spins = 0;; spins++) {
+        uint32_t expected = 0u;
+
+        if (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED) == 0u
+            && __atomic_compare_exchange_n(&lock->val, &expected, SPINLOCK_LOCKED_VAL, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return;
+        }
+
+        if ((spins & 1023u) == 1023u) {
+            std::this_thread::yield();
+        } else {
+            __builtin_ia32_pause();
+        }
+    }
+}
+
+extern "C" void* kmalloc(size_t size) {
+    return std::malloc(size ? size : 1u);
+}
+
+extern "C" void* kzalloc(size_t size) {
+    return std::calloc(1u, size ? size : 1u);
+}
+
+extern "C" void* krealloc(void* ptr, size_t new_size) {
+    return std::realloc(ptr, new_size ? new_size : 1u);
+}
+
+extern "C" void kfree(void* ptr) {
+    std::free(ptr);
+}
+
+extern "C" void* kmalloc_aligned(size_t size, uint32_t align) {
+    if (align < sizeof(void*)) {
+        align = sizeof(void*);
+    }
+
+    return std::aligned_alloc(align, (size + align - 1u) & ~(size_t)(align - 1u));
+}
+
+extern "C" void* kmalloc_a(size_t size) {
+    return kmalloc_aligned(size, 4096u);
+}
+
+struct kmem_cache {
+    size_t size;
+    uint32_t align;
+};
+
+extern "C" kmem_cache_t* kmem_cache_create(const char* name, size_t size, uint32_t align, uint32_t flags) {
+    (void)name;
+    (void)flags;
+
+    kmem_cache_t* cache = (kmem_cache_t*)std::malloc(sizeof(kmem_cache_t));
+    if (!cache) {
+        return nullptr;
+    }
+
+    cache->size = size;
+    cache->align = align ? align : (uint32_t)sizeof(void*);
+
+    return cache;
+}
+
+extern "C" void* kmem_cache_alloc(kmem_cache_t* cache) {
+    return kmalloc_aligned(cache->size, cache->align);
+}
+
+extern "C" void kmem_cache_free(kmem_cache_t* cache, void* obj) {
+    (void)cache;
+
+    std::free(obj);
+}
+
+extern "C" int kmem_cache_destroy(kmem_cache_t* cache) {
+    std::free(cache);
+    return 1;
+}
+
+/*
+ * Readers are not tracked, so callbacks only run from synchronize_rcu(),
+ * which the harness calls once no worker thread is left running.
+ */
+static std::mutex g_rcu_lock;
+static rcu_head_t* g_rcu_pending;
+
+extern "C" void call_rcu(rcu_head_t* head, void (*func)(rcu_head_t*)) {
+    std::lock_guard<std::mutex> guard(g_rcu_lock);
+
+    head->func = func;
+    head->next = g_rcu_pending;
+    g_rcu_pending = head;
+}
+
+extern "C" void synchronize_rcu(void) {
+    rcu_head_t* list;
+
+    {
+        std::lock_guard<std::mutex> guard(g_rcu_lock);
+
+        list = g_rcu_pending;
+        g_rcu_pending = nullptr;
+    }
+
+    while (list) {
+        rcu_head_t* next = list->next;
+
+        list->func(list);
+        list = next;
+    }
+}
+
+extern "C" void rcu_init_workers(void) {
+}
+
+extern "C" void rcu_process_local(void) {
+}
+
+void* operator new(size_t size, const kernel::nothrow_t&) noexcept {
+    return std::malloc(size ? size : 1u);
+}
+
+void* operator new[](size_t size, const kernel::nothrow_t&) noexcept {
+    return std::malloc(size ? size : 1u);
+}
+
+void operator delete(void* ptr, const kernel::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const kernel::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void* operator new(size_t size, std::align_val_t align, const kernel::nothrow_t&) noexcept {
+    return kmalloc_aligned(size, (uint32_t)align);
+}
+
+void* operator new[](size_t size, std::align_val_t align, const kernel::nothrow_t&) noexcept {
+    return kmalloc_aligned(size, (uint32_t)align);
+}
+
+void operator delete(void* ptr, std::align_val_t, const kernel::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const kernel::nothrow_t&) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef HAL_IRQ_H
+#define HAL_IRQ_H
+
+/* Host threads cannot mask interrupts; the *_safe lock variants degrade to plain ones. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+__attribute__((always_inline)) static inline void irq_disable(void) {
+}
+
+__attribute__((always_inline)) static inline void irq_enable(void) {
+}
+
+__attribute__((always_inline)) static inline uint32_t irq_save(void) {
+    return 0u;
+}
+
+__attribute__((always_inline)) static inline void irq_restore(uint32_t flags) {
+    (void)flags;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
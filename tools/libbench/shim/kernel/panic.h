@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef KERNEL_PANIC_H
+#define KERNEL_PANIC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+__attribute__((noreturn)) void kernel_panic(const char* message, const char* file, uint32_t line, void* regs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define panic(msg) kernel_panic(msg, __FILE__, __LINE__, 0)
+
+#endif
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef KERNEL_CPU_H
+#define KERNEL_CPU_H
+
+/*
+ * Host stand-in for the per-CPU block: only the fields the containers
+ * touch. Every host thread is given its own slot, assigned round-robin on
+ * first use, so per-CPU counters stay per-thread up to MAX_CPUS threads.
+ */
+
+#include <kernel/locking/spinlock.h>
+#include <kernel/smp/cpu_limits.h>
+
+#include <lib/compiler.h>
+
+#include <hal/align.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int index;
+    volatile uint32_t rcu_qs_count;
+} __cacheline_aligned cpu_t;
+
+extern cpu_t cpus[MAX_CPUS];
+
+extern int cpu_count;
+
+cpu_t* cpu_current(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
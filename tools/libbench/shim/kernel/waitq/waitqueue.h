@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef KERNEL_WAITQ_WAITQUEUE_H
+#define KERNEL_WAITQ_WAITQUEUE_H
+
+/* Only the type, so the sleeping lock headers parse; none of them is used on the host. */
+
+#include <lib/dlist.h>
+
+typedef struct waitqueue {
+    dlist_head_t waiters;
+
+    void* blocked_on;
+    int kind;
+} waitqueue_t;
+
+#endif
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef LIB_CPP_NEW_H
+#define LIB_CPP_NEW_H
+
+/*
+ * The kernel declares its own placement and aligned operator new, which
+ * clash with the host's <new>. Keep the host ones and add only the
+ * kernel::nothrow overloads.
+ */
+
+#include <stddef.h>
+
+#include <new>
+
+namespace kernel {
+
+struct nothrow_t {
+    explicit nothrow_t() = default;
+};
+
+inline constexpr nothrow_t nothrow;
+
+}
+
+void* operator new(size_t size, const kernel::nothrow_t& tag) noexcept;
+void* operator new[](size_t size, const kernel::nothrow_t& tag) noexcept;
+void operator delete(void* ptr, const kernel::nothrow_t& tag) noexcept;
+void operator delete[](void* ptr, const kernel::nothrow_t& tag) noexcept;
+
+void* operator new(size_t size, std::align_val_t align, const kernel::nothrow_t& tag) noexcept;
+void* operator new[](size_t size, std::align_val_t align, const kernel::nothrow_t& tag) noexcept;
+void operator delete(void* ptr, std::align_val_t align, const kernel::nothrow_t& tag) noexcept;
+void operator delete[](void* ptr, std::align_val_t align, const kernel::nothrow_t& tag) noexcept;
+
+#endif
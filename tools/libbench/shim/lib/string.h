@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef LIB_STRING_H
+#define LIB_STRING_H
+
+/* The kernel's string routines are the libc ones on the host. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#endif
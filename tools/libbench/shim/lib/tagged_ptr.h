@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef _LIB_TAGGED_PTR_H
+#define _LIB_TAGGED_PTR_H
+
+/*
+ * Host version of tagged_ptr_t. The kernel packs a 32-bit pointer and tag
+ * into one cmpxchg8b; on x86-64 the pair is 16 bytes and goes through
+ * cmpxchg16b (-mcx16) instead. Same API and ABA behaviour. The spare
+ * word is cleared by every successful swap and otherwise carried along
+ * from tagged_ptr_load(), which is where lflist.h takes `expected` from.
+ */
+
+#include <lib/compiler.h>
+
+#include <stdint.h>
+
+typedef struct {
+    void*    ptr_;
+    uint32_t version_;
+    uint32_t reserved_;
+} __attribute__((aligned(16))) tagged_ptr_t;
+
+typedef unsigned __int128 tagged_ptr_raw_t;
+
+___inline tagged_ptr_raw_t tagged_ptr_to_raw(tagged_ptr_t v) {
+    tagged_ptr_raw_t raw = 0;
+    __builtin_memcpy(&raw, &v, sizeof(v));
+    return raw;
+}
+
+___inline tagged_ptr_t tagged_ptr_from_raw(tagged_ptr_raw_t raw) {
+    tagged_ptr_t v;
+    __builtin_memcpy(&v, &raw, sizeof(v));
+    return v;
+}
+
+___inline int tagged_ptr_cas(
+    volatile tagged_ptr_t* dst,
+    tagged_ptr_t           expected,
+    tagged_ptr_t           desired
+) {
+    desired.reserved_ = 0u;
+
+    return __sync_bool_compare_and_swap(
+        (volatile tagged_ptr_raw_t*)dst, tagged_ptr_to_raw(expected), tagged_ptr_to_raw(desired)
+    );
+}
+
+___inline tagged_ptr_t tagged_ptr_load(volatile tagged_ptr_t* src) {
+    return tagged_ptr_from_raw(__sync_val_compare_and_swap((volatile tagged_ptr_raw_t*)src, 0, 0));
+}
+
+#endif
@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef LIB_TYPES_H
+#define LIB_TYPES_H
+
+/* ssize_t and off_t come from libc on the host; the kernel's 32-bit ones would clash. */
+#include <sys/types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint64_t phys_addr_t;
+
+#endif
@@ -12,6 +12,9 @@
 
 #define COMP_PENDING_MAX 128u
 
+/* How long a send into a full channel waits for the server to drain it. */
+#define COMP_CHAN_SEND_WAIT_MS 20
+
 typedef struct {
     uint8_t buf[COMP_RX_CAP];
     uint32_t r;
@@ -68,6 +71,9 @@ typedef struct {
     uint32_t seq;
     comp_rx_ring_t rx;
 
+    /* Used instead of the pipes when the server took a channel connection. */
+    chan_t ch;
+
     int input_ring_shm_fd;
     uint32_t input_ring_size_bytes;
     char input_ring_shm_name[32];
@@ -82,6 +88,58 @@ typedef struct {
     } pending[COMP_PENDING_MAX];
 } comp_conn_t;
 
+static inline int comp_conn_writable(const comp_conn_t* c) {
+    return c && c->connected && (c->ch.shared || c->fd_c2s_w >= 0);
+}
+
+static inline int comp_conn_readable(const comp_conn_t* c) {
+    return c && c->connected && (c->ch.shared || c->fd_s2c_r >= 0);
+}
+
+/* The fd to poll() for server messages; a channel is armed for a POLLIN doorbell first. */
+static inline int comp_conn_poll_fd(comp_conn_t* c) {
+    if (!c || !c->connected) return -1;
+    if (c->ch.shared) {
+        (void)chan_poll_arm(&c->ch, POLLIN);
+        return c->ch.fd;
+    }
+    return c->fd_s2c_r;
+}
+
+/* A whole frame, written straight into the channel ring when there is one. */
+static inline int comp_conn_send(comp_conn_t* c, uint16_t type, uint32_t seq, const void* payload, uint32_t payload_len) {
+    if (!comp_conn_writable(c)) return -1;
+    if (payload_len > COMP_IPC_MAX_PAYLOAD) return -1;
+
+    if (!c->ch.shared) {
+        return comp_conn_send(c, type, seq, payload, payload_len);
+    }
+
+    const uint32_t frame_size = (uint32_t)sizeof(comp_ipc_hdr_t) + payload_len;
+
+    uint8_t* dst = (uint8_t*)chan_send_reserve(&c->ch, frame_size);
+    if (!dst) {
+        if (chan_peer_closed(&c->ch)) return -1;
+        if ((chan_wait(&c->ch, POLLOUT, COMP_CHAN_SEND_WAIT_MS) & POLLOUT) == 0) return -1;
+
+        dst = (uint8_t*)chan_send_reserve(&c->ch, frame_size);
+        if (!dst) return -1;
+    }
+
+    comp_ipc_hdr_t h;
+    h.magic = COMP_IPC_MAGIC;
+    h.version = (uint16_t)COMP_IPC_VERSION;
+    h.type = type;
+    h.len = payload_len;
+    h.seq = seq;
+
+    memcpy(dst, &h, sizeof(h));
+    if (payload_len) {
+        memcpy(dst + sizeof(h), payload, payload_len);
+    }
+    return chan_send_commit(&c->ch);
+}
+
 static inline void comp_input_ring_close(comp_conn_t* c) {
     if (!c) return;
     if (c->input_ring) {
@@ -246,9 +304,43 @@ static inline int comp_pending_take_for_seq(comp_conn_t* c,
     return 0;
 }
 
-static inline int comp_try_recv_raw(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, void* out_payload, uint32_t payload_cap) {
-    if (!c || !c->connected || c->fd_s2c_r < 0) return -1;
+/* One frame per channel message: 1, 0 when there is none, -1 on hangup or a frame that does not fit. */
+static inline int comp_chan_recv_frame(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, void* out_payload, uint32_t payload_cap) {
+    for (;;) {
+        const void* msg = 0;
+        uint32_t len = 0;
+
+        int r = chan_recv_peek(&c->ch, &msg, &len);
+        if (r <= 0) return r;
+
+        comp_ipc_hdr_t hdr;
+        if (len < (uint32_t)sizeof(hdr)) {
+            chan_recv_done(&c->ch);
+            continue;
+        }
+
+        memcpy(&hdr, msg, sizeof(hdr));
+        if (hdr.magic != COMP_IPC_MAGIC || hdr.version != COMP_IPC_VERSION
+            || hdr.len > COMP_IPC_MAX_PAYLOAD || len != (uint32_t)sizeof(hdr) + hdr.len) {
+            chan_recv_done(&c->ch);
+            continue;
+        }
 
+        if (hdr.len) {
+            if (hdr.len > payload_cap || !out_payload) {
+                chan_recv_done(&c->ch);
+                return -1;
+            }
+            memcpy(out_payload, (const uint8_t*)msg + sizeof(hdr), hdr.len);
+        }
+        chan_recv_done(&c->ch);
+
+        *out_hdr = hdr;
+        return 1;
+    }
+}
+
+static inline int comp_pipe_recv_frame(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, void* out_payload, uint32_t payload_cap) {
     int saw_eof = 0;
 
     for (;;) {
@@ -307,6 +399,22 @@ static inline int comp_try_recv_raw(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, voi
             comp_rx_drop(&c->rx, hdr.len);
         }
 
+        *out_hdr = hdr;
+        return 1;
+    }
+}
+
+static inline int comp_try_recv_raw(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, void* out_payload, uint32_t payload_cap) {
+    if (!comp_conn_readable(c)) return -1;
+
+    for (;;) {
+        comp_ipc_hdr_t hdr;
+
+        int fr = c->ch.shared
+            ? comp_chan_recv_frame(c, &hdr, out_payload, payload_cap)
+            : comp_pipe_recv_frame(c, &hdr, out_payload, payload_cap);
+        if (fr <= 0) return fr;
+
         if (hdr.type == (uint16_t)COMP_IPC_MSG_INPUT_RING_NAME && hdr.len == (uint32_t)sizeof(comp_ipc_input_ring_name_t)) {
             comp_ipc_input_ring_name_t msg;
             memcpy(&msg, out_payload, sizeof(msg));
@@ -322,8 +430,8 @@ static inline int comp_try_recv_raw(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, voi
                         memcpy(c->input_ring_shm_name, msg.shm_name, sizeof(c->input_ring_shm_name));
                         c->input_ring = ring;
                         c->input_ring_enabled = 1;
-                        if (c->fd_c2s_w >= 0) {
-                            (void)comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_INPUT_RING_ACK, c->seq++, 0, 0);
+                        if (comp_conn_writable(c)) {
+                            (void)comp_conn_send(c, (uint16_t)COMP_IPC_MSG_INPUT_RING_ACK, c->seq++, 0, 0);
                         }
                     } else {
                         if (ring) munmap((void*)ring, msg.size_bytes);
@@ -357,7 +465,11 @@ static inline int comp_wait_reply(comp_conn_t* c,
         int r = comp_try_recv_raw(c, &hdr, payload, (uint32_t)sizeof(payload));
         if (r < 0) return -1;
         if (r == 0) {
-            usleep(1000);
+            if (c->ch.shared) {
+                (void)chan_wait(&c->ch, POLLIN, 1);
+            } else {
+                usleep(1000);
+            }
             continue;
         }
 
@@ -379,6 +491,7 @@ static inline void comp_conn_reset(comp_conn_t* c) {
     c->connected = 0;
     c->fd_c2s_w = -1;
     c->fd_s2c_r = -1;
+    chan_reset(&c->ch);
     c->input_ring_shm_fd = -1;
     c->input_ring_size_bytes = 0;
     c->input_ring_shm_name[0] = '\0';
@@ -395,6 +508,7 @@ static inline void comp_disconnect(comp_conn_t* c) {
     if (!c) return;
     c->connected = 0;
     comp_input_ring_close(c);
+    chan_close(&c->ch);
     if (c->fd_c2s_w >= 0) {
         close(c->fd_c2s_w);
         c->fd_c2s_w = -1;
@@ -413,6 +527,13 @@ static inline int comp_connect(comp_conn_t* c, const char* endpoint_name) {
     if (!c) return -1;
     comp_conn_reset(c);
 
+    /* Servers that do not take channels (flux_wm) get the pipe pair. */
+    if (chan_connect(&c->ch, endpoint_name) == 0) {
+        c->connected = 1;
+        c->seq = 1;
+        return 0;
+    }
+
     int fds[2] = { -1, -1 };
     if (ipc_connect(endpoint_name, fds) != 0) {
         return -1;
@@ -428,28 +549,28 @@ static inline int comp_connect(comp_conn_t* c, const char* endpoint_name) {
 static inline int comp_wait_ack_or_error(comp_conn_t* c, uint32_t want_seq, uint16_t req_type, uint32_t surface_id, uint16_t* out_err_code, uint32_t max_iters);
 
 static inline int comp_send_hello(comp_conn_t* c) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
 
     comp_ipc_hello_t hello;
     hello.client_pid = (uint32_t)getpid();
     hello.caps = COMP_IPC_CAP_DAMAGE;
-    return comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_HELLO, c->seq++, &hello, (uint32_t)sizeof(hello));
+    return comp_conn_send(c, (uint16_t)COMP_IPC_MSG_HELLO, c->seq++, &hello, (uint32_t)sizeof(hello));
 }
 
 static inline int comp_send_hello_sync(comp_conn_t* c, uint32_t max_iters, uint16_t* out_err_code) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
 
     comp_ipc_hello_t hello;
     hello.client_pid = (uint32_t)getpid();
     hello.caps = COMP_IPC_CAP_DAMAGE;
 
     uint32_t seq = c->seq++;
-    if (comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_HELLO, seq, &hello, (uint32_t)sizeof(hello)) != 0) return -1;
+    if (comp_conn_send(c, (uint16_t)COMP_IPC_MSG_HELLO, seq, &hello, (uint32_t)sizeof(hello)) != 0) return -1;
     return comp_wait_ack_or_error(c, seq, (uint16_t)COMP_IPC_MSG_HELLO, 0u, out_err_code, max_iters);
 }
 
 static inline int comp_send_damage(comp_conn_t* c, uint32_t surface_id, const comp_ipc_rect_t* rects, uint32_t rect_count) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (surface_id == 0u) return -1;
     if (rect_count > COMP_IPC_DAMAGE_MAX_RECTS) return -1;
     if (rect_count && !rects) return -1;
@@ -465,7 +586,7 @@ static inline int comp_send_damage(comp_conn_t* c, uint32_t surface_id, const co
         memcpy((void*)d->rects, (const void*)rects, rect_count * (uint32_t)sizeof(comp_ipc_rect_t));
     }
 
-    return comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_DAMAGE, c->seq++, payload, payload_len);
+    return comp_conn_send(c, (uint16_t)COMP_IPC_MSG_DAMAGE, c->seq++, payload, payload_len);
 }
 
 static inline int comp_send_attach_shm_name(comp_conn_t* c,
@@ -476,7 +597,7 @@ static inline int comp_send_attach_shm_name(comp_conn_t* c,
                                            uint32_t height,
                                            uint32_t stride,
                                            uint32_t format) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (!shm_name) return -1;
     if (surface_id == 0) return -1;
     if (size_bytes == 0 || width == 0 || height == 0) return -1;
@@ -496,11 +617,11 @@ static inline int comp_send_attach_shm_name(comp_conn_t* c,
     if (n >= sizeof(a.shm_name)) return -1;
     memcpy(a.shm_name, shm_name, n + 1u);
 
-    return comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_ATTACH_SHM_NAME, c->seq++, &a, (uint32_t)sizeof(a));
+    return comp_conn_send(c, (uint16_t)COMP_IPC_MSG_ATTACH_SHM_NAME, c->seq++, &a, (uint32_t)sizeof(a));
 }
 
 static inline int comp_send_commit(comp_conn_t* c, uint32_t surface_id, int32_t x, int32_t y, uint32_t flags) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (surface_id == 0) return -1;
 
     comp_ipc_commit_t cm;
@@ -508,21 +629,21 @@ static inline int comp_send_commit(comp_conn_t* c, uint32_t surface_id, int32_t
     cm.x = x;
     cm.y = y;
     cm.flags = flags;
-    return comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_COMMIT, c->seq++, &cm, (uint32_t)sizeof(cm));
+    return comp_conn_send(c, (uint16_t)COMP_IPC_MSG_COMMIT, c->seq++, &cm, (uint32_t)sizeof(cm));
 }
 
 static inline int comp_send_destroy_surface(comp_conn_t* c, uint32_t surface_id, uint32_t flags) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (surface_id == 0) return -1;
 
     comp_ipc_destroy_surface_t d;
     d.surface_id = surface_id;
     d.flags = flags;
-    return comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_DESTROY_SURFACE, c->seq++, &d, (uint32_t)sizeof(d));
+    return comp_conn_send(c, (uint16_t)COMP_IPC_MSG_DESTROY_SURFACE, c->seq++, &d, (uint32_t)sizeof(d));
 }
 
 static inline int comp_try_recv(comp_conn_t* c, comp_ipc_hdr_t* out_hdr, void* out_payload, uint32_t payload_cap) {
-    if (!c || !c->connected || c->fd_s2c_r < 0) return -1;
+    if (!comp_conn_readable(c)) return -1;
 
     int pr = comp_pending_pop(c, out_hdr, out_payload, payload_cap);
     if (pr != 0) return pr;
@@ -580,7 +701,7 @@ static inline int comp_send_attach_shm_name_sync(comp_conn_t* c,
                                                  uint32_t format,
                                                  uint32_t max_iters,
                                                  uint16_t* out_err_code) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (!shm_name) return -1;
     if (surface_id == 0) return -1;
     if (size_bytes == 0 || width == 0 || height == 0) return -1;
@@ -601,12 +722,12 @@ static inline int comp_send_attach_shm_name_sync(comp_conn_t* c,
     memcpy(a.shm_name, shm_name, n + 1u);
 
     uint32_t seq = c->seq++;
-    if (comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_ATTACH_SHM_NAME, seq, &a, (uint32_t)sizeof(a)) != 0) return -1;
+    if (comp_conn_send(c, (uint16_t)COMP_IPC_MSG_ATTACH_SHM_NAME, seq, &a, (uint32_t)sizeof(a)) != 0) return -1;
     return comp_wait_ack_or_error(c, seq, (uint16_t)COMP_IPC_MSG_ATTACH_SHM_NAME, surface_id, out_err_code, max_iters);
 }
 
 static inline int comp_send_commit_sync(comp_conn_t* c, uint32_t surface_id, int32_t x, int32_t y, uint32_t flags, uint32_t max_iters, uint16_t* out_err_code) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (surface_id == 0) return -1;
 
     comp_ipc_commit_t cm;
@@ -616,12 +737,28 @@ static inline int comp_send_commit_sync(comp_conn_t* c, uint32_t surface_id, int
     cm.flags = flags | COMP_IPC_COMMIT_FLAG_ACK;
 
     uint32_t seq = c->seq++;
-    if (comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_COMMIT, seq, &cm, (uint32_t)sizeof(cm)) != 0) return -1;
+    if (comp_conn_send(c, (uint16_t)COMP_IPC_MSG_COMMIT, seq, &cm, (uint32_t)sizeof(cm)) != 0) return -1;
+    return comp_wait_ack_or_error(c, seq, (uint16_t)COMP_IPC_MSG_COMMIT, surface_id, out_err_code, max_iters);
+}
+
+/* Commit and block until a frame containing the commit has been presented. */
+static inline int comp_send_commit_presented_sync(comp_conn_t* c, uint32_t surface_id, int32_t x, int32_t y, uint32_t flags, uint32_t max_iters, uint16_t* out_err_code) {
+    if (!comp_conn_writable(c)) return -1;
+    if (surface_id == 0) return -1;
+
+    comp_ipc_commit_t cm;
+    cm.surface_id = surface_id;
+    cm.x = x;
+    cm.y = y;
+    cm.flags = (flags & ~COMP_IPC_COMMIT_FLAG_ACK) | COMP_IPC_COMMIT_FLAG_PRESENTED;
+
+    uint32_t seq = c->seq++;
+    if (comp_conn_send(c, (uint16_t)COMP_IPC_MSG_COMMIT, seq, &cm, (uint32_t)sizeof(cm)) != 0) return -1;
     return comp_wait_ack_or_error(c, seq, (uint16_t)COMP_IPC_MSG_COMMIT, surface_id, out_err_code, max_iters);
 }
 
 static inline int comp_send_destroy_surface_sync(comp_conn_t* c, uint32_t surface_id, uint32_t flags, uint32_t max_iters, uint16_t* out_err_code) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     if (surface_id == 0) return -1;
 
     comp_ipc_destroy_surface_t d;
@@ -629,7 +766,7 @@ static inline int comp_send_destroy_surface_sync(comp_conn_t* c, uint32_t surfac
     d.flags = flags;
 
     uint32_t seq = c->seq++;
-    if (comp_ipc_send(c->fd_c2s_w, (uint16_t)COMP_IPC_MSG_DESTROY_SURFACE, seq, &d, (uint32_t)sizeof(d)) != 0) return -1;
+    if (comp_conn_send(c, (uint16_t)COMP_IPC_MSG_DESTROY_SURFACE, seq, &d, (uint32_t)sizeof(d)) != 0) return -1;
     return comp_wait_ack_or_error(c, seq, (uint16_t)COMP_IPC_MSG_DESTROY_SURFACE, surface_id, out_err_code, max_iters);
 }
 
@@ -638,7 +775,7 @@ static inline int comp_wm_connect(comp_conn_t* c) {
 }
 
 static inline int comp_wm_send_cmd(comp_conn_t* c, uint32_t kind, uint32_t client_id, uint32_t surface_id, int32_t x, int32_t y, uint32_t flags) {
-    if (!c || !c->connected || c->fd_c2s_w < 0) return -1;
+    if (!comp_conn_writable(c)) return -1;
     comp_ipc_wm_cmd_t cmd;
     cmd.kind = kind;
     cmd.client_id = client_id;
@@ -657,6 +794,12 @@ static inline int comp_wm_send_cmd(comp_conn_t* c, uint32_t kind, uint32_t clien
     frame.h.seq = c->seq;
     frame.body = cmd;
 
+    if (c->ch.shared) {
+        if (comp_conn_send(c, frame.h.type, frame.h.seq, &frame.body, frame.h.len) != 0) return -1;
+        c->seq++;
+        return 0;
+    }
+
     const uint32_t size = (uint32_t)sizeof(frame);
     int r = pipe_try_write(c->fd_c2s_w, &frame, size);
     if (r == (int)size) {
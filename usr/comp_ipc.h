@@ -87,6 +87,9 @@ typedef struct __attribute__((packed)) {
 
 #define COMP_IPC_COMMIT_FLAG_RAISE 1u
 #define COMP_IPC_COMMIT_FLAG_ACK   2u
+#define COMP_IPC_COMMIT_FLAG_PRESENTED 4u
+
+#define COMP_IPC_ACK_FLAG_PRESENTED 1u
 
 typedef struct __attribute__((packed)) {
     uint32_t surface_id;
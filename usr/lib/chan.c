@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+
+#define CHAN_REC_HDR ((uint32_t)sizeof(yos_chan_rec_t))
+
+static uint32_t chan_rec_size(uint32_t len) {
+    return CHAN_REC_HDR + ((len + YOS_CHAN_REC_ALIGN - 1u) & ~(YOS_CHAN_REC_ALIGN - 1u));
+}
+
+static void chan_doorbell(chan_t* ch, uint32_t events) {
+    (void)ioctl(ch->fd, YOS_CHAN_NOTIFY, &events);
+}
+
+static int chan_room(const chan_t* ch, uint32_t head, uint32_t tail, uint32_t need) {
+    const uint32_t used = head - tail;
+
+    return used <= ch->ring_size && ch->ring_size - used >= need;
+}
+
+void chan_reset(chan_t* ch) {
+    if (!ch) return;
+
+    memset(ch, 0, sizeof(*ch));
+    ch->fd = -1;
+}
+
+int chan_open(chan_t* ch, int fd) {
+    if (!ch) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    chan_reset(ch);
+    if (fd < 0) return -1;
+
+    yos_chan_info_t info;
+    if (ioctl(fd, YOS_CHAN_GET_INFO, &info) != 0
+        || info.side > 1u
+        || info.ring_size != YOS_CHAN_RING_SIZE
+        || info.map_size != YOS_CHAN_MAP_SIZE) {
+        close(fd);
+        return -1;
+    }
+
+    uint8_t* base = (uint8_t*)mmap(fd, info.map_size, MAP_SHARED);
+    if (!base) {
+        close(fd);
+        return -1;
+    }
+
+    yos_chan_shared_t* sh = (yos_chan_shared_t*)base;
+    if (sh->magic != YOS_CHAN_MAGIC
+        || sh->version != YOS_CHAN_VERSION
+        || sh->ring_size != info.ring_size
+        || sh->data_offset != YOS_CHAN_HDR_SIZE) {
+        munmap(base, info.map_size);
+        close(fd);
+        return -1;
+    }
+
+    const uint32_t peer = info.side ^ 1u;
+
+    ch->fd = fd;
+    ch->side = info.side;
+    ch->ring_size = info.ring_size;
+    ch->map_size = info.map_size;
+    ch->shared = sh;
+
+    ch->tx = &sh->ring[info.side];
+    ch->rx = &sh->ring[peer];
+
+    ch->tx_data = base + YOS_CHAN_HDR_SIZE + info.side * info.ring_size;
+    ch->rx_data = base + YOS_CHAN_HDR_SIZE + peer * info.ring_size;
+
+    return 0;
+}
+
+int chan_connect(chan_t* ch, const char* endpoint_name) {
+    if (!ch) return -1;
+
+    const int fd = ipc_connect_chan(endpoint_name);
+    if (fd < 0) {
+        chan_reset(ch);
+        return -1;
+    }
+
+    return chan_open(ch, fd);
+}
+
+void chan_close(chan_t* ch) {
+    if (!ch) return;
+
+    /* The peer sees the hangup once both the mapping and the fd are gone. */
+    if (ch->shared) {
+        munmap((void*)ch->shared, ch->map_size);
+    }
+    if (ch->fd >= 0) {
+        close(ch->fd);
+    }
+
+    chan_reset(ch);
+}
+
+int chan_peer_closed(const chan_t* ch) {
+    if (!ch || !ch->shared) return 1;
+
+    return (__atomic_load_n(&ch->shared->closed, __ATOMIC_ACQUIRE) & (1u << (ch->side ^ 1u))) != 0u;
+}
+
+void* chan_send_reserve(chan_t* ch, uint32_t len) {
+    if (!ch || !ch->shared || len == 0u || len > YOS_CHAN_MSG_MAX) return 0;
+    if (chan_peer_closed(ch)) return 0;
+
+    const uint32_t size = ch->ring_size;
+    const uint32_t head = ch->tx->head;
+    const uint32_t off = head & (size - 1u);
+    const uint32_t rec = chan_rec_size(len);
+
+    /* Records never wrap: a short tail end of the ring is skipped with a marker. */
+    const uint32_t pad = (size - off < rec) ? size - off : 0u;
+
+    if (!chan_room(ch, head, __atomic_load_n(&ch->tx->tail, __ATOMIC_ACQUIRE), pad + rec)) {
+        ch->tx_want = pad + rec;
+        return 0;
+    }
+
+    uint32_t at = off;
+    if (pad) {
+        yos_chan_rec_t* wrap = (yos_chan_rec_t*)(ch->tx_data + off);
+        wrap->len = 0u;
+        wrap->flags = YOS_CHAN_REC_WRAP;
+        at = 0u;
+    }
+
+    yos_chan_rec_t* r = (yos_chan_rec_t*)(ch->tx_data + at);
+    r->len = len;
+    r->flags = 0u;
+
+    ch->tx_pending = pad + rec;
+    ch->tx_want = 0u;
+
+    return r + 1;
+}
+
+int chan_send_commit(chan_t* ch) {
+    if (!ch || !ch->shared || ch->tx_pending == 0u) return -1;
+
+    yos_chan_ring_t* tx = ch->tx;
+    const uint32_t prev = tx->head;
+
+    __atomic_store_n(&tx->head, prev + ch->tx_pending, __ATOMIC_SEQ_CST);
+    ch->tx_pending = 0u;
+
+    /*
+     * Only a ring that was empty can have a reader asleep on it. The reader
+     * raises want_data before its last look at head, we look at want_data
+     * after publishing head: one of us sees the other.
+     */
+    if (__atomic_load_n(&tx->tail, __ATOMIC_SEQ_CST) == prev
+        && __atomic_load_n(&tx->want_data, __ATOMIC_SEQ_CST) != 0u
+        && __atomic_exchange_n(&tx->want_data, 0u, __ATOMIC_SEQ_CST) != 0u) {
+        chan_doorbell(ch, POLLIN);
+    }
+
+    return 0;
+}
+
+int chan_try_send(chan_t* ch, const void* buf, uint32_t len) {
+    if (!buf) return -1;
+
+    void* p = chan_send_reserve(ch, len);
+    if (!p) {
+        if (!ch || len == 0u || len > YOS_CHAN_MSG_MAX || chan_peer_closed(ch)) return -1;
+        return 0;
+    }
+
+    memcpy(p, buf, len);
+    return chan_send_commit(ch) == 0 ? 1 : -1;
+}
+
+static void chan_rx_advance(chan_t* ch, uint32_t tail) {
+    yos_chan_ring_t* rx = ch->rx;
+
+    __atomic_store_n(&rx->tail, tail, __ATOMIC_SEQ_CST);
+
+    /* The writer is only told once the room it asked for is there. */
+    const uint32_t want = __atomic_load_n(&rx->want_space, __ATOMIC_SEQ_CST);
+    if (want == 0u) return;
+
+    if (chan_room(ch, __atomic_load_n(&rx->head, __ATOMIC_ACQUIRE), tail, want)
+        && __atomic_exchange_n(&rx->want_space, 0u, __ATOMIC_SEQ_CST) != 0u) {
+        chan_doorbell(ch, POLLOUT);
+    }
+}
+
+int chan_recv_peek(chan_t* ch, const void** out_msg, uint32_t* out_len) {
+    if (!ch || !ch->shared || !out_msg || !out_len) return -1;
+
+    yos_chan_ring_t* rx = ch->rx;
+    const uint32_t size = ch->ring_size;
+
+    /* Looked at first: a peer marked closed has nothing left in flight. */
+    const int closed = chan_peer_closed(ch);
+
+    for (;;) {
+        const uint32_t tail = rx->tail;
+        const uint32_t used = __atomic_load_n(&rx->head, __ATOMIC_ACQUIRE) - tail;
+
+        if (used == 0u) return closed ? -1 : 0;
+        if (used > size || used < CHAN_REC_HDR) return -1;
+
+        const uint32_t off = tail & (size - 1u);
+
+        /* The peer can still write to the ring: use a copy of what was checked. */
+        yos_chan_rec_t rec;
+        memcpy(&rec, ch->rx_data + off, sizeof(rec));
+
+        if (rec.flags & YOS_CHAN_REC_WRAP) {
+            if (size - off > used) return -1;
+
+            chan_rx_advance(ch, tail + (size - off));
+            continue;
+        }
+
+        const uint32_t n = chan_rec_size(rec.len);
+        if (rec.len == 0u || rec.len > YOS_CHAN_MSG_MAX || n > used || n > size - off) return -1;
+
+        if (rx->want_data != 0u) {
+            __atomic_store_n(&rx->want_data, 0u, __ATOMIC_RELAXED);
+        }
+
+        ch->rx_pending = n;
+        *out_msg = ch->rx_data + off + CHAN_REC_HDR;
+        *out_len = rec.len;
+        return 1;
+    }
+}
+
+void chan_recv_done(chan_t* ch) {
+    if (!ch || !ch->shared || ch->rx_pending == 0u) return;
+
+    const uint32_t n = ch->rx_pending;
+    ch->rx_pending = 0u;
+
+    chan_rx_advance(ch, ch->rx->tail + n);
+}
+
+int chan_try_recv(chan_t* ch, void* buf, uint32_t cap) {
+    const void* msg = 0;
+    uint32_t len = 0u;
+
+    const int r = chan_recv_peek(ch, &msg, &len);
+    if (r <= 0) return r;
+
+    if (!buf || len > cap) return -1;
+
+    memcpy(buf, msg, len);
+    chan_recv_done(ch);
+    return (int)len;
+}
+
+static int chan_ready(const chan_t* ch, int events, uint32_t* out_head, uint32_t* out_tail) {
+    int ready = 0;
+
+    if (events & POLLIN) {
+        const uint32_t head = __atomic_load_n(&ch->rx->head, __ATOMIC_SEQ_CST);
+        if (head != ch->rx->tail) ready |= POLLIN;
+        if (out_head) *out_head = head;
+    }
+
+    if (events & POLLOUT) {
+        const uint32_t tail = __atomic_load_n(&ch->tx->tail, __ATOMIC_SEQ_CST);
+        if (chan_room(ch, ch->tx->head, tail, ch->tx_want ? ch->tx_want : 1u)) ready |= POLLOUT;
+        if (out_tail) *out_tail = tail;
+    }
+
+    if (chan_peer_closed(ch)) ready |= POLLHUP;
+
+    return ready;
+}
+
+static void chan_disarm(chan_t* ch, int events) {
+    if ((events & POLLIN) && ch->rx->want_data != 0u) {
+        __atomic_store_n(&ch->rx->want_data, 0u, __ATOMIC_RELAXED);
+    }
+    if ((events & POLLOUT) && ch->tx->want_space != 0u) {
+        __atomic_store_n(&ch->tx->want_space, 0u, __ATOMIC_RELAXED);
+    }
+}
+
+/* Announce the wait, then look again, so that a doorbell cannot slip through in between. */
+static int chan_arm(chan_t* ch, int events, uint32_t* out_head, uint32_t* out_tail) {
+    if (events & POLLIN) {
+        __atomic_store_n(&ch->rx->want_data, 1u, __ATOMIC_SEQ_CST);
+    }
+    if (events & POLLOUT) {
+        __atomic_store_n(&ch->tx->want_space, ch->tx_want ? ch->tx_want : 1u, __ATOMIC_SEQ_CST);
+    }
+
+    const int ready = chan_ready(ch, events, out_head, out_tail);
+    if (ready) {
+        chan_disarm(ch, events);
+    }
+
+    return ready;
+}
+
+int chan_poll_arm(chan_t* ch, int events) {
+    if (!ch || !ch->shared) return POLLNVAL;
+
+    return chan_arm(ch, events, 0, 0);
+}
+
+int chan_wait(chan_t* ch, int events, int timeout_ms) {
+    if (!ch || !ch->shared) return POLLNVAL;
+
+    events &= POLLIN | POLLOUT;
+    if (events == 0) return 0;
+
+    uint32_t head = 0u;
+    uint32_t tail = 0u;
+
+    const int ready = chan_arm(ch, events, &head, &tail);
+    if (ready) return ready;
+
+    if (events == POLLIN || events == POLLOUT) {
+        volatile uint32_t* word = (events == POLLIN) ? &ch->rx->head : &ch->tx->tail;
+        const uint32_t seen = (events == POLLIN) ? head : tail;
+
+        if (timeout_ms < 0) {
+            (void)futex_wait(word, seen);
+        } else {
+            (void)futex_wait_timeout(word, seen, (uint32_t)timeout_ms, 0u);
+        }
+    } else {
+        pollfd_t pfd;
+        pfd.fd = ch->fd;
+        pfd.events = (int16_t)events;
+        pfd.revents = 0;
+
+        (void)poll(&pfd, 1u, timeout_ms);
+    }
+
+    chan_disarm(ch, events);
+
+    return chan_ready(ch, events, 0, 0);
+}
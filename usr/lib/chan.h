@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef _CHAN_H
+#define _CHAN_H
+
+#include <stdint.h>
+
+#include <yos/channel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Message channels over a mapped channel fd (see yos/channel.h).
+ *
+ * Sending and receiving are plain memory operations on the shared rings. A
+ * syscall is only made to ring the peer's doorbell, and only when the peer
+ * has announced that it is about to sleep: on a send that makes its ring
+ * non-empty, or on a receive that frees the room its writer waits for.
+ *
+ * One thread sends and one thread receives on each side.
+ */
+typedef struct {
+    int fd;
+    uint32_t side;
+    uint32_t ring_size;
+    uint32_t map_size;
+
+    yos_chan_shared_t* shared;
+
+    yos_chan_ring_t* tx;
+    yos_chan_ring_t* rx;
+
+    uint8_t* tx_data;
+    uint8_t* rx_data;
+
+    /* Bytes reserved by chan_send_reserve(), or the room a failed reservation needed. */
+    uint32_t tx_pending;
+    uint32_t tx_want;
+
+    /* Size of the record chan_recv_peek() handed out. */
+    uint32_t rx_pending;
+} chan_t;
+
+void chan_reset(chan_t* ch);
+
+/* Map the channel behind `fd`, which the chan_t owns from then on, even on failure. */
+int chan_open(chan_t* ch, int fd);
+
+/* ipc_connect_chan() and chan_open(). */
+int chan_connect(chan_t* ch, const char* endpoint_name);
+
+void chan_close(chan_t* ch);
+
+int chan_peer_closed(const chan_t* ch);
+
+/*
+ * Room for a `len`-byte message in the ring, to be filled in place and
+ * published by chan_send_commit(). Null if it does not fit right now.
+ */
+void* chan_send_reserve(chan_t* ch, uint32_t len);
+int chan_send_commit(chan_t* ch);
+
+/* 1 when sent, 0 when the ring is full, -1 if the peer is gone or the message too large. */
+int chan_try_send(chan_t* ch, const void* buf, uint32_t len);
+
+/*
+ * The next message, left in the ring until chan_recv_done(). Returns 1,
+ * 0 when there is none, -1 once the peer is gone and everything it sent
+ * has been read, or if the ring is corrupt.
+ */
+int chan_recv_peek(chan_t* ch, const void** out_msg, uint32_t* out_len);
+void chan_recv_done(chan_t* ch);
+
+/* chan_recv_peek() and a copy: the length, 0, -1, or -1 leaving a message that does not fit `cap`. */
+int chan_try_recv(chan_t* ch, void* buf, uint32_t cap);
+
+/*
+ * Ask the peer for a doorbell on POLLIN and/or POLLOUT (the room the last
+ * failed chan_send_reserve() needed) before sleeping in poll() on ch->fd.
+ * Returns what is ready already, in which case the caller should not sleep.
+ */
+int chan_poll_arm(chan_t* ch, int events);
+
+/*
+ * Sleep until one of `events` is ready or timeout_ms passes (< 0: forever).
+ * A single event waits on the ring's futex word, both go through poll().
+ * Returns the ready events, 0 on timeout.
+ */
+int chan_wait(chan_t* ch, int events, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
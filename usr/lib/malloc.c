@@ -13,612 +13,877 @@
 #endif
 #endif
 
-#define MALLOC_ALIGNMENT       8u
-#define MALLOC_MIN_SIZE        16u
-#define MALLOC_SYS_ALLOC_MIN   65536u
-#define MALLOC_MMAP_THRESHOLD  (128u * 1024u)
-
-#define CHUNK_IN_USE_PREV      1u
-#define CHUNK_IS_FREE          2u
-#define CHUNK_IS_MMAPPED       4u
-#define CHUNK_FLAG_MASK        7u
-
-#define NUM_BINS               64u
-#define NUM_ARENAS             4u
-
-#define TCACHE_MAX_BINS        32u
-#define TCACHE_MAX_ENTRIES     64u
-#define TCACHE_MAX_SIZE        256u
-
-typedef struct malloc_chunk {
-    uint32_t prev_size_;
-    uint32_t size_;
-
-    struct malloc_chunk* fd_;
-    struct malloc_chunk* bk_;
-} malloc_chunk_t;
+/*
+ * Size-class allocator.
+ *
+ * Requests up to MALLOC_MAX_SMALL bytes are rounded up to a size class and
+ * served from spans: runs of pages cut into objects of a single class. Each
+ * thread keeps a short free list per class in its TLS block and only takes
+ * the class lock to move a whole batch to or from the central lists. Spans
+ * come from a page heap that coalesces free runs and gives the pages of idle
+ * ones back to the kernel with MADV_DONTNEED. Bigger requests take a page run
+ * of their own, and above MALLOC_MMAP_THRESHOLD a mapping of their own.
+ *
+ * A two-level page map leads from any address inside a span to its record,
+ * so free() needs neither a header nor boundary tags.
+ */
+
+#define MALLOC_PAGE_SHIFT         12u
+#define MALLOC_PAGE_SIZE          4096u
+
+#define MALLOC_MAX_SMALL          (32u * 1024u)
+#define MALLOC_NUM_CLASSES        42u
+#define MALLOC_MMAP_THRESHOLD     (1024u * 1024u)
+
+/* The page heap grows by at least this much at a time. */
+#define MALLOC_HEAP_GROW          (1024u * 1024u)
+
+/* Free, still resident page heap memory beyond this is given back to the kernel. */
+#define MALLOC_RELEASE_THRESHOLD  (1024u * 1024u)
+
+/* A freed run at least this long is released at once to join a released neighbour. */
+#define MALLOC_RELEASE_MIN        (64u * 1024u)
+
+/* Free runs of n pages live on list n, longer ones on list 0. */
+#define MALLOC_FREE_LISTS         128u
+
+#define PAGEMAP_LEAF_BITS         10u
+#define PAGEMAP_LEAF_SIZE         (1u << PAGEMAP_LEAF_BITS)
+#define PAGEMAP_ROOT_SIZE         (1u << (32u - MALLOC_PAGE_SHIFT - PAGEMAP_LEAF_BITS))
+
+#define SPAN_FREE                 1u
+#define SPAN_SMALL                2u
+#define SPAN_LARGE                3u
+#define SPAN_MAPPED               4u
+
+typedef struct span {
+    uint32_t start_;
+    uint32_t npages_;
+
+    uint8_t state_;
+    uint8_t cls_;
+    /* SPAN_FREE: the pages were handed back and fault in as zero pages. */
+    uint8_t released_;
+    /* SPAN_SMALL: on its class's partial list. */
+    uint8_t listed_;
+
+    uint32_t used_;
+    uint32_t carved_;
+    uint32_t capacity_;
+    void* freelist_;
+
+    struct span* next_;
+    struct span* prev_;
+} span_t;
+
+typedef struct malloc_central {
+    pthread_mutex_t lock_;
+    /* Spans of the class with objects left to hand out. */
+    span_t partial_;
+    uint32_t spans_;
+    uint32_t objects_out_;
+} malloc_central_t;
 
 typedef struct tcache_bin {
-    malloc_chunk_t* head_;
+    void* head_;
     uint32_t count_;
 } tcache_bin_t;
 
 typedef struct tcache {
-    struct tcache* self_;
-    tcache_bin_t bins_[TCACHE_MAX_BINS];
+    tcache_bin_t bins_[MALLOC_NUM_CLASSES];
 } tcache_t;
 
-typedef struct malloc_state {
+typedef struct malloc_heap {
     pthread_mutex_t lock_;
-    uint32_t index_;
+    span_t free_[MALLOC_FREE_LISTS];
+    span_t* spare_records_;
 
-    malloc_chunk_t bins_[NUM_BINS];
-    uint64_t binmap_;
+    uint32_t heap_bytes_;
+    uint32_t free_bytes_;
+    uint32_t released_bytes_;
+    uint32_t small_bytes_;
+    uint32_t large_bytes_;
+    uint32_t mapped_bytes_;
+} malloc_heap_t;
 
-    malloc_chunk_t* top_chunk_;
-    uint32_t top_size_;
+static malloc_heap_t g_heap;
+static malloc_central_t g_central[MALLOC_NUM_CLASSES];
 
-    int initialized_;
-} malloc_state_t;
+static span_t** g_pagemap[PAGEMAP_ROOT_SIZE];
 
-static malloc_state_t g_arenas[NUM_ARENAS];
+/* Class 0 stands for "not a small request"; classes 1.. grow by a quarter per step. */
+static uint32_t g_class_size[MALLOC_NUM_CLASSES];
+static uint16_t g_class_pages[MALLOC_NUM_CLASSES];
+static uint16_t g_class_batch[MALLOC_NUM_CLASSES];
+static uint8_t g_class_lookup[(1024u >> 3) + 1u];
 
-static uint8_t g_page_to_arena[1048576];
+static volatile uint32_t g_malloc_ready = 0;
 
 static int g_zero_fd = -1;
 
-static inline void set_tls_direct(void* tls_base) {
-    (void)syscall(56, (int)(uintptr_t)tls_base, 0, 0);
+static __thread tcache_t t_tcache;
+
+static void* sys_map(uint32_t size) {
+    int fd = __atomic_load_n(&g_zero_fd, __ATOMIC_ACQUIRE);
+
+    if (unlikely(fd < 0)) {
+        const int new_fd = open("/dev/zero", 0);
+
+        if (unlikely(new_fd < 0)) {
+            return NULL;
+        }
+
+        int expected = -1;
+        const int claimed = __atomic_compare_exchange_n(
+            &g_zero_fd, &expected, new_fd, 0,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+        );
+
+        if (!claimed) {
+            (void)close(new_fd);
+        }
+
+        fd = __atomic_load_n(&g_zero_fd, __ATOMIC_ACQUIRE);
+    }
+
+    void* p = mmap(fd, size, MAP_PRIVATE);
+
+    if (unlikely(!p || p == (void*)-1)) {
+        return NULL;
+    }
+
+    return p;
 }
 
-static inline uint32_t chunk_size(const malloc_chunk_t* c) {
-    return c->size_ & ~CHUNK_FLAG_MASK;
+static inline void* page_addr(uint32_t page) {
+    return (void*)(uintptr_t)(page << MALLOC_PAGE_SHIFT);
 }
 
-static inline int chunk_prev_in_use(const malloc_chunk_t* c) {
-    return (c->size_ & CHUNK_IN_USE_PREV) != 0u;
+static inline uint32_t addr_page(const void* p) {
+    return (uint32_t)(uintptr_t)p >> MALLOC_PAGE_SHIFT;
 }
 
-static inline int chunk_is_free(const malloc_chunk_t* c) {
-    return (c->size_ & CHUNK_IS_FREE) != 0u;
+static inline span_t* pagemap_get(uint32_t page) {
+    if (unlikely(page >= PAGEMAP_ROOT_SIZE * PAGEMAP_LEAF_SIZE)) {
+        return NULL;
+    }
+
+    span_t** leaf = __atomic_load_n(&g_pagemap[page >> PAGEMAP_LEAF_BITS], __ATOMIC_ACQUIRE);
+
+    return leaf ? leaf[page & (PAGEMAP_LEAF_SIZE - 1u)] : NULL;
 }
 
-static inline malloc_chunk_t* chunk_next(const malloc_chunk_t* c) {
-    return (malloc_chunk_t*)((char*)c + chunk_size(c));
+static inline void pagemap_set(uint32_t page, span_t* s) {
+    g_pagemap[page >> PAGEMAP_LEAF_BITS][page & (PAGEMAP_LEAF_SIZE - 1u)] = s;
 }
 
-static inline void chunk_set_size_and_flags(malloc_chunk_t* c, uint32_t size, uint32_t flags) {
-    c->size_ = size | flags;
+/* Heap lock held. */
+static int pagemap_ensure(uint32_t first, uint32_t npages) {
+    const uint32_t last = first + npages - 1u;
+
+    for (uint32_t i = first >> PAGEMAP_LEAF_BITS; i <= last >> PAGEMAP_LEAF_BITS; i++) {
+        if (g_pagemap[i]) {
+            continue;
+        }
+
+        span_t** leaf = (span_t**)sys_map(PAGEMAP_LEAF_SIZE * (uint32_t)sizeof(span_t*));
+
+        if (unlikely(!leaf)) {
+            return 0;
+        }
+
+        __atomic_store_n(&g_pagemap[i], leaf, __ATOMIC_RELEASE);
+    }
+
+    return 1;
 }
 
-static inline void* chunk_to_mem(malloc_chunk_t* c) {
-    return (void*)((char*)c + 8u);
+static inline void span_list_init(span_t* head) {
+    head->next_ = head;
+    head->prev_ = head;
 }
 
-static inline malloc_chunk_t* mem_to_chunk(void* mem) {
-    return (malloc_chunk_t*)((char*)mem - 8u);
+static inline int span_list_empty(const span_t* head) {
+    return head->next_ == head;
 }
 
-static inline uint32_t compute_bin_index(uint32_t size) {
-    if (size <= 256u) {
-        return (size >> 3u) - 2u;
-    }
+static inline void span_list_push(span_t* head, span_t* s) {
+    s->next_ = head->next_;
+    s->prev_ = head;
 
-    uint32_t idx = 31u;
-    uint32_t remaining = size >> 9u;
+    head->next_->prev_ = s;
+    head->next_ = s;
+}
 
-    while (remaining > 0u && idx < NUM_BINS - 1u) {
-        remaining >>= 1u;
-        idx++;
-    }
+static inline void span_list_remove(span_t* s) {
+    s->prev_->next_ = s->next_;
+    s->next_->prev_ = s->prev_;
 
-    return idx;
+    s->next_ = NULL;
+    s->prev_ = NULL;
 }
 
-static void bin_insert(malloc_state_t* arena, malloc_chunk_t* chunk, uint32_t size) {
-    const uint32_t idx = compute_bin_index(size);
-    malloc_chunk_t* head = &arena->bins_[idx];
+static void init_classes(void) {
+    static const uint32_t tiny[] = { 8u, 16u, 32u, 48u, 64u, 80u, 96u, 112u, 128u };
 
-    malloc_chunk_t* fwd = head->fd_;
+    uint32_t n = 1u;
 
-    chunk->fd_ = fwd;
-    chunk->bk_ = head;
+    for (uint32_t i = 0; i < sizeof(tiny) / sizeof(tiny[0]); i++) {
+        g_class_size[n++] = tiny[i];
+    }
 
-    fwd->bk_ = chunk;
-    head->fd_ = chunk;
+    for (uint32_t base = 128u; base < MALLOC_MAX_SMALL; base <<= 1u) {
+        for (uint32_t q = 5u; q <= 8u; q++) {
+            g_class_size[n++] = (base * q) >> 2u;
+        }
+    }
 
-    arena->binmap_ |= (1ULL << idx);
-}
+    for (uint32_t c = 1u; c < MALLOC_NUM_CLASSES; c++) {
+        const uint32_t size = g_class_size[c];
+
+        /* Enough objects per span that a batch rarely needs more than one. */
+        const uint32_t per_span = (size <= 4096u) ? 16u : 8u;
+        const uint32_t bytes = size * per_span;
+
+        g_class_pages[c] = (uint16_t)((bytes + MALLOC_PAGE_SIZE - 1u) >> MALLOC_PAGE_SHIFT);
 
-static void bin_remove(malloc_state_t* arena, malloc_chunk_t* chunk) {
-    malloc_chunk_t* fwd = chunk->fd_;
-    malloc_chunk_t* bck = chunk->bk_;
+        uint32_t batch = 4096u / size;
 
-    if (unlikely(fwd->bk_ != chunk 
-        || bck->fd_ != chunk)) {
-        
-        __builtin_trap(); 
+        if (batch < 2u) batch = 2u;
+        if (batch > 32u) batch = 32u;
+
+        g_class_batch[c] = (uint16_t)batch;
     }
 
-    bck->fd_ = fwd;
-    fwd->bk_ = bck;
+    uint32_t c = 1u;
+
+    for (uint32_t i = 0; i <= (1024u >> 3); i++) {
+        while (g_class_size[c] < (i << 3)) {
+            c++;
+        }
 
-    if (unlikely(fwd == bck)) {
-        const uint32_t idx = compute_bin_index(chunk_size(chunk));
-        arena->binmap_ &= ~(1ULL << idx);
+        g_class_lookup[i] = (uint8_t)c;
     }
 }
 
-static void ensure_inited(malloc_state_t* arena) {
-    if (likely(arena->initialized_)) {
+static void ensure_inited(void) {
+    if (likely(__atomic_load_n(&g_malloc_ready, __ATOMIC_ACQUIRE))) {
         return;
     }
 
-    arena->index_ = (uint32_t)(arena - g_arenas);
+    (void)pthread_mutex_lock(&g_heap.lock_);
 
-    for (uint32_t i = 0; i < NUM_BINS; i++) {
-        arena->bins_[i].fd_ = &arena->bins_[i];
-        arena->bins_[i].bk_ = &arena->bins_[i];
-        arena->bins_[i].size_ = 0u;
-    }
+    if (!g_malloc_ready) {
+        init_classes();
 
-    arena->binmap_ = 0ull;
+        for (uint32_t i = 0; i < MALLOC_FREE_LISTS; i++) {
+            span_list_init(&g_heap.free_[i]);
+        }
 
-    arena->top_chunk_ = NULL;
-    arena->top_size_ = 0u;
+        for (uint32_t c = 0; c < MALLOC_NUM_CLASSES; c++) {
+            span_list_init(&g_central[c].partial_);
+        }
 
-    arena->initialized_ = 1;
-}
+        __atomic_store_n(&g_malloc_ready, 1u, __ATOMIC_RELEASE);
+    }
 
-static malloc_state_t* acquire_arena(void) {
-    const uint32_t pid = (uint32_t)getpid();
-    const uint32_t preferred = pid & (NUM_ARENAS - 1u);
+    (void)pthread_mutex_unlock(&g_heap.lock_);
+}
 
-    if (pthread_mutex_trylock(&g_arenas[preferred].lock_) == 0) {
-        return &g_arenas[preferred];
+static inline uint32_t size_to_class(uint32_t size) {
+    if (size <= 1024u) {
+        return g_class_lookup[(size + 7u) >> 3];
     }
 
-    for (uint32_t i = 1; i < NUM_ARENAS; i++) {
-        const uint32_t idx = (preferred + i) & (NUM_ARENAS - 1u);
-        
-        if (pthread_mutex_trylock(&g_arenas[idx].lock_) == 0) {
-            return &g_arenas[idx];
-        }
-    }
+    /* 2^p < size <= 2^(p+1), and the classes split that range in quarters. */
+    const uint32_t p = 31u - (uint32_t)__builtin_clz(size - 1u);
 
-    (void)pthread_mutex_lock(&g_arenas[preferred].lock_);
-    
-    return &g_arenas[preferred];
+    return 10u + (p - 7u) * 4u + ((size - 1u - (1u << p)) >> (p - 2u));
 }
 
-static void* mmap_alloc(uint32_t size) {
-    int fd = __atomic_load_n(&g_zero_fd, __ATOMIC_ACQUIRE);
+/* Span records: heap lock held. */
+static span_t* span_record_new(void) {
+    span_t* s = g_heap.spare_records_;
 
-    if (unlikely(fd < 0)) {
-        const int new_fd = open("/dev/zero", 0);
+    if (likely(s != NULL)) {
+        g_heap.spare_records_ = s->next_;
+    } else {
+        span_t* page = (span_t*)sys_map(MALLOC_PAGE_SIZE);
 
-        if (unlikely(new_fd < 0)) {
+        if (unlikely(!page)) {
             return NULL;
         }
 
-        int expected = -1;
-        const bool claimed = __atomic_compare_exchange_n(
-            &g_zero_fd, &expected, new_fd, false,
-            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
-        );
+        const uint32_t n = MALLOC_PAGE_SIZE / (uint32_t)sizeof(span_t);
 
-        if (!claimed) {
-            (void)close(new_fd);
+        for (uint32_t i = 1u; i < n; i++) {
+            page[i].next_ = g_heap.spare_records_;
+            g_heap.spare_records_ = &page[i];
         }
 
-        fd = __atomic_load_n(&g_zero_fd, __ATOMIC_ACQUIRE);
+        s = &page[0];
     }
 
-    const uint32_t alloc_size = size + 8u;
+    memset(s, 0, sizeof(*s));
 
-    void* ptr = mmap(fd, alloc_size, MAP_PRIVATE);
+    return s;
+}
 
-    if (unlikely(!ptr || ptr == (void*)-1)) {
-        return NULL;
-    }
+static void span_record_free(span_t* s) {
+    s->state_ = 0u;
+    s->next_ = g_heap.spare_records_;
+    g_heap.spare_records_ = s;
+}
 
-    malloc_chunk_t* chunk = (malloc_chunk_t*)ptr;
+static inline uint32_t span_bytes(const span_t* s) {
+    return s->npages_ << MALLOC_PAGE_SHIFT;
+}
 
-    chunk->size_ = size | CHUNK_IN_USE_PREV | CHUNK_IS_MMAPPED;
+/* Free runs are found through their first and last pages, which is all coalescing looks at. */
+static void heap_insert_free(span_t* s) {
+    s->state_ = SPAN_FREE;
 
-    return (void*)((char*)chunk + 8u);
-}
+    pagemap_set(s->start_, s);
+    pagemap_set(s->start_ + s->npages_ - 1u, s);
 
-static void mmap_free(malloc_chunk_t* chunk) {
-    const uint32_t size = chunk_size(chunk);
-    const uint32_t alloc_size = size + 8u;
+    span_list_push(&g_heap.free_[s->npages_ < MALLOC_FREE_LISTS ? s->npages_ : 0u], s);
 
-    (void)munmap((void*)chunk, alloc_size);
+    if (s->released_) {
+        g_heap.released_bytes_ += span_bytes(s);
+    } else {
+        g_heap.free_bytes_ += span_bytes(s);
+    }
 }
 
-static inline tcache_t* get_tcache(void) {
-    uint16_t fs_sel;
-    
-    __asm__ volatile ("mov %%fs, %0" : "=r"(fs_sel));
+static void heap_remove_free(span_t* s) {
+    span_list_remove(s);
 
-    if (unlikely(fs_sel == 0x23 || fs_sel == 0x2B)) {
-        tcache_t* tcb = (tcache_t*)mmap_alloc(sizeof(tcache_t));
-        
-        if (unlikely(!tcb)) {
-            return NULL;
-        }
-        
-        for (uint32_t i = 0; i < TCACHE_MAX_BINS; i++) {
-            tcb->bins_[i].head_ = NULL;
-            tcb->bins_[i].count_ = 0u;
-        }
-        
-        tcb->self_ = tcb;
-        set_tls_direct(tcb);
-        
-        return tcb;
+    if (s->released_) {
+        g_heap.released_bytes_ -= span_bytes(s);
+    } else {
+        g_heap.free_bytes_ -= span_bytes(s);
     }
-    
-    tcache_t* tcb;
-    __asm__ volatile ("mov %%fs:0, %0" : "=r"(tcb));
-    
-    return tcb;
 }
 
-static void free_internal(malloc_state_t* arena, malloc_chunk_t* c, uint32_t size);
+/* Drop the pages of a span that is not on a free list. */
+static void span_release_pages(span_t* s) {
+    (void)madvise(page_addr(s->start_), span_bytes(s), MADV_DONTNEED);
 
-static int extend_heap(malloc_state_t* arena, uint32_t min_size) {
-    uint32_t request = min_size + 8u;
+    s->released_ = 1u;
+}
 
-    if (request < MALLOC_SYS_ALLOC_MIN) {
-        request = MALLOC_SYS_ALLOC_MIN;
+/*
+ * Free runs merge only in the same state: a released run that took in resident pages
+ * would count as resident again and be released twice over. A long enough resident
+ * run being freed gives its own pages back so it can still join a released neighbour.
+ */
+static int heap_can_merge(span_t* s, const span_t* other) {
+    if (s->released_ == other->released_) {
+        return 1;
     }
 
-    request = (request + 4095u) & ~4095u;
+    if (!s->released_ && span_bytes(s) >= MALLOC_RELEASE_MIN) {
+        span_release_pages(s);
+        return 1;
+    }
 
-    int fd = __atomic_load_n(&g_zero_fd, __ATOMIC_ACQUIRE);
+    return 0;
+}
 
-    if (unlikely(fd < 0)) {
-        const int new_fd = open("/dev/zero", 0);
+/* Return a span to the heap, merged with the free runs on either side. */
+static void heap_free_span(span_t* s) {
+    if (s->start_ > 0u) {
+        span_t* prev = pagemap_get(s->start_ - 1u);
 
-        if (unlikely(new_fd < 0)) {
-            return 0;
-        }
+        if (prev && prev->state_ == SPAN_FREE && prev->start_ + prev->npages_ == s->start_
+            && heap_can_merge(s, prev)) {
+            heap_remove_free(prev);
 
-        int expected = -1;
-        const bool claimed = __atomic_compare_exchange_n(
-            &g_zero_fd, &expected, new_fd, false,
-            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
-        );
+            s->start_ = prev->start_;
+            s->npages_ += prev->npages_;
 
-        if (!claimed) {
-            (void)close(new_fd);
+            span_record_free(prev);
         }
+    }
 
-        fd = __atomic_load_n(&g_zero_fd, __ATOMIC_ACQUIRE);
+    span_t* next = pagemap_get(s->start_ + s->npages_);
+
+    if (next && next->state_ == SPAN_FREE && next->start_ == s->start_ + s->npages_
+        && heap_can_merge(s, next)) {
+        heap_remove_free(next);
+
+        s->npages_ += next->npages_;
+
+        span_record_free(next);
     }
 
-    void* p = mmap(fd, request, MAP_PRIVATE);
+    heap_insert_free(s);
+}
 
-    if (unlikely(!p || p == (void*)-1)) {
-        return 0;
+/* The longest free run still resident, or NULL. */
+static span_t* heap_find_resident(void) {
+    for (uint32_t n = 0; n < MALLOC_FREE_LISTS; n++) {
+        span_t* head = &g_heap.free_[n == 0u ? 0u : MALLOC_FREE_LISTS - n];
+
+        for (span_t* s = head->next_; s != head; s = s->next_) {
+            if (!s->released_) {
+                return s;
+            }
+        }
     }
 
-    const uint32_t start_page = (uint32_t)(uintptr_t)p >> 12u;
-    const uint32_t end_page = ((uint32_t)(uintptr_t)p + request - 1u) >> 12u;
+    return NULL;
+}
 
-    for (uint32_t i = start_page; i <= end_page; i++) {
-        g_page_to_arena[i] = (uint8_t)arena->index_;
+/* Hand resident free runs back to the kernel, longest first, once too much has piled up. */
+static void heap_scavenge(void) {
+    if (likely(g_heap.free_bytes_ <= MALLOC_RELEASE_THRESHOLD)) {
+        return;
     }
 
-    malloc_chunk_t* end_dummy = (malloc_chunk_t*)((char*)p + request - 8u);
-    chunk_set_size_and_flags(end_dummy, 8u, CHUNK_IN_USE_PREV);
+    while (g_heap.free_bytes_ > MALLOC_RELEASE_THRESHOLD / 2u) {
+        span_t* s = heap_find_resident();
 
-    if (arena->top_chunk_ != NULL && arena->top_size_ > 0u) {
-        const uint32_t old_size = arena->top_size_;
+        if (!s) {
+            break;
+        }
 
-        if (old_size >= MALLOC_MIN_SIZE + 8u) {
-            malloc_chunk_t* dummy = (malloc_chunk_t*)((char*)arena->top_chunk_ + old_size - 8u);
-            chunk_set_size_and_flags(dummy, 8u, CHUNK_IN_USE_PREV);
+        heap_remove_free(s);
+        span_release_pages(s);
 
-            malloc_chunk_t* old_top = arena->top_chunk_;
-            chunk_set_size_and_flags(old_top, old_size - 8u, CHUNK_IN_USE_PREV);
+        /* Merges with the released runs around it, so the lists are walked afresh. */
+        heap_free_span(s);
+    }
+}
 
-            free_internal(arena, old_top, old_size - 8u);
-        } else {
-            malloc_chunk_t* dummy = arena->top_chunk_;
-            chunk_set_size_and_flags(dummy, old_size, CHUNK_IN_USE_PREV);
-        }
+static int heap_grow(uint32_t npages) {
+    uint32_t bytes = npages << MALLOC_PAGE_SHIFT;
+
+    if (bytes < MALLOC_HEAP_GROW) {
+        bytes = MALLOC_HEAP_GROW;
     }
 
-    arena->top_chunk_ = (malloc_chunk_t*)p;
-    arena->top_size_ = request - 8u;
+    void* p = sys_map(bytes);
 
-    return 1;
-}
+    if (unlikely(!p)) {
+        return 0;
+    }
+
+    span_t* s = span_record_new();
+
+    if (unlikely(!s || !pagemap_ensure(addr_page(p), bytes >> MALLOC_PAGE_SHIFT))) {
+        if (s) {
+            span_record_free(s);
+        }
+
+        (void)munmap(p, bytes);
+
+        return 0;
+    }
 
-static void split_and_insert(malloc_state_t* arena, malloc_chunk_t* c, uint32_t total_size, uint32_t request_size) {
-    const uint32_t rem = total_size - request_size;
+    s->start_ = addr_page(p);
+    s->npages_ = bytes >> MALLOC_PAGE_SHIFT;
 
-    if (rem >= MALLOC_MIN_SIZE) {
-        chunk_set_size_and_flags(c, request_size, c->size_ & CHUNK_FLAG_MASK);
+    /* Nothing is resident yet: the pages fault in as they are first touched. */
+    s->released_ = 1u;
 
-        malloc_chunk_t* remainder = chunk_next(c);
-        chunk_set_size_and_flags(remainder, rem, CHUNK_IN_USE_PREV | CHUNK_IS_FREE);
+    g_heap.heap_bytes_ += bytes;
 
-        malloc_chunk_t* next_after = chunk_next(remainder);
+    heap_free_span(s);
 
-        if (next_after == arena->top_chunk_) {
-            arena->top_chunk_ = remainder;
-            arena->top_size_ += rem;
-        } else {
-            next_after->size_ &= ~CHUNK_IN_USE_PREV;
-            next_after->prev_size_ = rem;
+    return 1;
+}
 
-            bin_insert(arena, remainder, rem);
+static span_t* heap_find(uint32_t npages) {
+    for (uint32_t n = npages; n < MALLOC_FREE_LISTS; n++) {
+        if (!span_list_empty(&g_heap.free_[n])) {
+            return g_heap.free_[n].next_;
         }
-    } else {
-        malloc_chunk_t* next = chunk_next(c);
+    }
+
+    span_t* best = NULL;
+    span_t* head = &g_heap.free_[0];
 
-        if (next != arena->top_chunk_) {
-            next->size_ |= CHUNK_IN_USE_PREV;
+    for (span_t* s = head->next_; s != head; s = s->next_) {
+        if (s->npages_ >= npages && (!best || s->npages_ < best->npages_)) {
+            best = s;
         }
     }
+
+    return best;
 }
 
-static void* carve_top(malloc_state_t* arena, uint32_t request) {
-    malloc_chunk_t* c = arena->top_chunk_;
-    const uint32_t rem = arena->top_size_ - request;
+/* A run of exactly `npages` pages, its page map entries left to the caller. Heap lock held. */
+static span_t* heap_alloc(uint32_t npages) {
+    span_t* s = heap_find(npages);
 
-    if (rem >= MALLOC_MIN_SIZE) {
-        arena->top_chunk_ = (malloc_chunk_t*)((char*)c + request);
-        arena->top_size_ = rem;
+    if (!s) {
+        if (unlikely(!heap_grow(npages))) {
+            return NULL;
+        }
 
-        chunk_set_size_and_flags(c, request, CHUNK_IN_USE_PREV);
+        s = heap_find(npages);
 
-        return chunk_to_mem(c);
+        if (unlikely(!s)) {
+            return NULL;
+        }
     }
 
-    const uint32_t size = arena->top_size_;
+    heap_remove_free(s);
 
-    arena->top_chunk_ = NULL;
-    arena->top_size_ = 0u;
+    if (s->npages_ > npages) {
+        span_t* rest = span_record_new();
 
-    chunk_set_size_and_flags(c, size, CHUNK_IN_USE_PREV);
+        if (likely(rest != NULL)) {
+            rest->start_ = s->start_ + npages;
+            rest->npages_ = s->npages_ - npages;
+            rest->released_ = s->released_;
 
-    return chunk_to_mem(c);
-}
+            heap_insert_free(rest);
 
-static void* malloc_internal(malloc_state_t* arena, uint32_t request) {
-    const uint32_t idx = compute_bin_index(request);
-    uint64_t available_map = arena->binmap_ & (~0ULL << idx);
+            s->npages_ = npages;
+        }
+    }
 
-    while (available_map != 0) {
-        const uint32_t i = (uint32_t)__builtin_ctzll(available_map);
-        
-        malloc_chunk_t* head = &arena->bins_[i];
-        malloc_chunk_t* c = head->fd_;
+    s->released_ = 0u;
+    s->cls_ = 0u;
+    s->listed_ = 0u;
+    s->used_ = 0u;
+    s->carved_ = 0u;
+    s->capacity_ = 0u;
+    s->freelist_ = NULL;
 
-        while (c != head) {
-            const uint32_t c_size = chunk_size(c);
+    return s;
+}
 
-            if (c_size >= request) {
-                bin_remove(arena, c);
-                c->size_ &= ~CHUNK_IS_FREE;
+static span_t* central_new_span(uint32_t cls) {
+    (void)pthread_mutex_lock(&g_heap.lock_);
 
-                split_and_insert(arena, c, c_size, request);
+    span_t* s = heap_alloc(g_class_pages[cls]);
 
-                return chunk_to_mem(c);
-            }
+    if (likely(s != NULL)) {
+        s->state_ = SPAN_SMALL;
+        s->cls_ = (uint8_t)cls;
+        s->capacity_ = span_bytes(s) / g_class_size[cls];
 
-            c = c->fd_;
+        for (uint32_t i = 0; i < s->npages_; i++) {
+            pagemap_set(s->start_ + i, s);
         }
 
-        available_map &= ~(1ULL << i);
+        g_heap.small_bytes_ += span_bytes(s);
     }
 
-    if (arena->top_size_ < request) {
-        if (unlikely(!extend_heap(arena, request))) {
-            return NULL;
-        }
-    }
+    (void)pthread_mutex_unlock(&g_heap.lock_);
 
-    return carve_top(arena, request);
+    return s;
 }
 
-static void free_internal(malloc_state_t* arena, malloc_chunk_t* c, uint32_t size) {
-    if (!chunk_prev_in_use(c)) {
-        const uint32_t prev_sz = c->prev_size_;
-        malloc_chunk_t* prev = (malloc_chunk_t*)((char*)c - prev_sz);
+/* Up to `want` objects of the class as a list in *out_head; returns how many. */
+static uint32_t central_fetch(uint32_t cls, void** out_head, uint32_t want) {
+    malloc_central_t* c = &g_central[cls];
+    const uint32_t size = g_class_size[cls];
 
-        bin_remove(arena, prev);
+    void* head = NULL;
+    uint32_t n = 0;
 
-        c = prev;
-        size += prev_sz;
-    }
+    (void)pthread_mutex_lock(&c->lock_);
 
-    malloc_chunk_t* next = (malloc_chunk_t*)((char*)c + size);
+    while (n < want) {
+        span_t* s = c->partial_.next_;
 
-    if (next == arena->top_chunk_) {
-        arena->top_chunk_ = c;
-        arena->top_size_ += size;
-        
-        return;
-    }
+        if (s == &c->partial_) {
+            s = central_new_span(cls);
 
-    if (chunk_is_free(next)) {
-        const uint32_t next_sz = chunk_size(next);
+            if (unlikely(!s)) {
+                break;
+            }
 
-        bin_remove(arena, next);
-        size += next_sz;
+            span_list_push(&c->partial_, s);
+            s->listed_ = 1u;
+            c->spans_++;
+        }
+
+        while (n < want && s->freelist_) {
+            void* obj = s->freelist_;
 
-        next = (malloc_chunk_t*)((char*)c + size);
+            s->freelist_ = *(void**)obj;
+            *(void**)obj = head;
+            head = obj;
+
+            s->used_++;
+            n++;
+        }
+
+        /* Fresh spans are cut up as they are used, so untouched pages stay unfaulted. */
+        while (n < want && s->carved_ < s->capacity_) {
+            void* obj = (char*)page_addr(s->start_) + s->carved_ * size;
+
+            s->carved_++;
+            *(void**)obj = head;
+            head = obj;
+
+            s->used_++;
+            n++;
+        }
+
+        if (!s->freelist_ && s->carved_ == s->capacity_) {
+            span_list_remove(s);
+            s->listed_ = 0u;
+        }
     }
 
-    chunk_set_size_and_flags(c, size, CHUNK_IN_USE_PREV | CHUNK_IS_FREE);
+    c->objects_out_ += n;
 
-    next->size_ &= ~CHUNK_IN_USE_PREV;
-    next->prev_size_ = size;
+    (void)pthread_mutex_unlock(&c->lock_);
 
-    bin_insert(arena, c, size);
+    *out_head = head;
+
+    return n;
 }
 
-static void* realloc_internal(malloc_state_t* arena, malloc_chunk_t* c, uint32_t old_size, uint32_t request) {
-    if (old_size >= request) {
-        split_and_insert(arena, c, old_size, request);
+/* Take back a list of `n` objects of the class; spans left empty go back to the page heap. */
+static void central_release(uint32_t cls, void* head, uint32_t n) {
+    malloc_central_t* c = &g_central[cls];
 
-        return chunk_to_mem(c);
-    }
+    (void)pthread_mutex_lock(&c->lock_);
 
-    malloc_chunk_t* next = chunk_next(c);
+    while (head) {
+        void* obj = head;
+        head = *(void**)obj;
 
-    if (next == arena->top_chunk_) {
-        const uint32_t needed = request - old_size;
+        span_t* s = pagemap_get(addr_page(obj));
 
-        if (arena->top_size_ < needed) {
-            if (unlikely(!extend_heap(arena, needed))) {
-                return NULL;
-            }
+        if (unlikely(!s || s->state_ != SPAN_SMALL || s->cls_ != cls)) {
+            __builtin_trap();
+        }
 
-            next = chunk_next(c);
+        *(void**)obj = s->freelist_;
+        s->freelist_ = obj;
+        s->used_--;
 
-            if (unlikely(next != arena->top_chunk_)) {
-                return NULL;
+        if (s->used_ == 0u) {
+            if (s->listed_) {
+                span_list_remove(s);
             }
-        }
 
-        arena->top_chunk_ = (malloc_chunk_t*)((char*)next + needed);
-        arena->top_size_ -= needed;
+            s->listed_ = 0u;
+            c->spans_--;
+
+            (void)pthread_mutex_lock(&g_heap.lock_);
+
+            g_heap.small_bytes_ -= span_bytes(s);
 
-        chunk_set_size_and_flags(c, request, c->size_ & CHUNK_FLAG_MASK);
+            heap_free_span(s);
+            heap_scavenge();
 
-        return chunk_to_mem(c);
+            (void)pthread_mutex_unlock(&g_heap.lock_);
+        } else if (!s->listed_) {
+            span_list_push(&c->partial_, s);
+            s->listed_ = 1u;
+        }
     }
 
-    if (chunk_is_free(next)) {
-        const uint32_t next_sz = chunk_size(next);
+    c->objects_out_ -= n;
 
-        if (old_size + next_sz >= request) {
-            bin_remove(arena, next);
+    (void)pthread_mutex_unlock(&c->lock_);
+}
 
-            const uint32_t total = old_size + next_sz;
-            c->size_ = total | (c->size_ & CHUNK_FLAG_MASK);
+static void* small_alloc(uint32_t cls) {
+    tcache_bin_t* bin = &t_tcache.bins_[cls];
 
-            split_and_insert(arena, c, total, request);
+    if (unlikely(!bin->head_)) {
+        bin->count_ = central_fetch(cls, &bin->head_, g_class_batch[cls]);
 
-            return chunk_to_mem(c);
+        if (unlikely(!bin->head_)) {
+            return NULL;
         }
     }
 
-    return NULL;
+    void* obj = bin->head_;
+
+    bin->head_ = *(void**)obj;
+    bin->count_--;
+
+    return obj;
 }
 
-void* malloc(size_t size) {
-    if (unlikely(size == 0u)) {
-        return NULL;
+static void small_free(uint32_t cls, void* obj) {
+    tcache_bin_t* bin = &t_tcache.bins_[cls];
+
+    if (unlikely(bin->head_ == obj)) {
+        __builtin_trap();
     }
 
-    uint32_t request = (uint32_t)((size + 4u + 7u) & ~7u);
+    *(void**)obj = bin->head_;
+    bin->head_ = obj;
+    bin->count_++;
 
-    if (request < MALLOC_MIN_SIZE) {
-        request = MALLOC_MIN_SIZE;
-    }
+    /* Keep up to two batches; past that, the older one goes back to the class. */
+    const uint32_t batch = g_class_batch[cls];
+
+    if (unlikely(bin->count_ > 2u * batch)) {
+        void* keep = bin->head_;
 
-    if (unlikely(request >= MALLOC_MMAP_THRESHOLD)) {
-        return mmap_alloc(request);
+        for (uint32_t i = 1u; i < batch; i++) {
+            keep = *(void**)keep;
+        }
+
+        void* rest = *(void**)keep;
+        *(void**)keep = NULL;
+
+        central_release(cls, rest, bin->count_ - batch);
+
+        bin->count_ = batch;
     }
+}
+
+static void* large_alloc(uint32_t size) {
+    const uint32_t npages = (size + MALLOC_PAGE_SIZE - 1u) >> MALLOC_PAGE_SHIFT;
 
-    if (likely(request <= TCACHE_MAX_SIZE)) {
-        tcache_t* tcache = get_tcache();
+    if (size >= MALLOC_MMAP_THRESHOLD) {
+        void* p = sys_map(npages << MALLOC_PAGE_SHIFT);
+
+        if (unlikely(!p)) {
+            return NULL;
+        }
 
-        if (likely(tcache != NULL)) {
-            const uint32_t idx = (request - MALLOC_MIN_SIZE) >> 3u;
-            tcache_bin_t* bin = &tcache->bins_[idx];
+        (void)pthread_mutex_lock(&g_heap.lock_);
 
-            if (bin->count_ > 0u) {
-                malloc_chunk_t* c = bin->head_;
-                
-                bin->head_ = c->fd_;
-                bin->count_--;
+        span_t* s = span_record_new();
 
-                return chunk_to_mem(c);
+        if (unlikely(!s || !pagemap_ensure(addr_page(p), 1u))) {
+            if (s) {
+                span_record_free(s);
             }
+
+            (void)pthread_mutex_unlock(&g_heap.lock_);
+            (void)munmap(p, npages << MALLOC_PAGE_SHIFT);
+
+            return NULL;
         }
+
+        s->start_ = addr_page(p);
+        s->npages_ = npages;
+        s->state_ = SPAN_MAPPED;
+
+        pagemap_set(s->start_, s);
+
+        g_heap.mapped_bytes_ += span_bytes(s);
+
+        (void)pthread_mutex_unlock(&g_heap.lock_);
+
+        return p;
     }
 
-    malloc_state_t* arena = acquire_arena();
-    
-    ensure_inited(arena);
+    (void)pthread_mutex_lock(&g_heap.lock_);
+
+    span_t* s = heap_alloc(npages);
+
+    if (likely(s != NULL)) {
+        s->state_ = SPAN_LARGE;
 
-    void* res = malloc_internal(arena, request);
+        pagemap_set(s->start_, s);
+        pagemap_set(s->start_ + s->npages_ - 1u, s);
+
+        g_heap.large_bytes_ += span_bytes(s);
+    }
 
-    (void)pthread_mutex_unlock(&arena->lock_);
+    (void)pthread_mutex_unlock(&g_heap.lock_);
 
-    return res;
+    return s ? page_addr(s->start_) : NULL;
 }
 
-void free(void* ptr) {
-    if (unlikely(!ptr)) {
+static void large_free(span_t* s) {
+    (void)pthread_mutex_lock(&g_heap.lock_);
+
+    if (s->state_ == SPAN_MAPPED) {
+        void* p = page_addr(s->start_);
+        const uint32_t bytes = span_bytes(s);
+
+        pagemap_set(s->start_, NULL);
+
+        g_heap.mapped_bytes_ -= bytes;
+
+        span_record_free(s);
+
+        (void)pthread_mutex_unlock(&g_heap.lock_);
+        (void)munmap(p, bytes);
+
         return;
     }
 
-    malloc_chunk_t* c = mem_to_chunk(ptr);
+    g_heap.large_bytes_ -= span_bytes(s);
 
-    if (unlikely((c->size_ & CHUNK_IS_MMAPPED) != 0u)) {
-        mmap_free(c);
+    heap_free_span(s);
+    heap_scavenge();
 
-        return;
+    (void)pthread_mutex_unlock(&g_heap.lock_);
+}
+
+static inline span_t* span_of(const void* ptr) {
+    span_t* s = pagemap_get(addr_page(ptr));
+
+    if (unlikely(!s || s->state_ == SPAN_FREE || s->state_ == 0u)) {
+        __builtin_trap();
     }
 
-    const uint32_t size = chunk_size(c);
+    return s;
+}
 
-    if (likely(size <= TCACHE_MAX_SIZE)) {
-        tcache_t* tcache = get_tcache();
+static inline uint32_t usable_size(const span_t* s) {
+    return s->state_ == SPAN_SMALL ? g_class_size[s->cls_] : span_bytes(s);
+}
 
-        if (likely(tcache != NULL)) {
-            const uint32_t idx = (size - MALLOC_MIN_SIZE) >> 3u;
-            tcache_bin_t* bin = &tcache->bins_[idx];
+void* malloc(size_t size) {
+    if (unlikely(size == 0u)) {
+        return NULL;
+    }
 
-            if (bin->count_ < TCACHE_MAX_ENTRIES) {
-                if (unlikely(bin->head_ == c)) {
-                    __builtin_trap(); 
-                }
+    ensure_inited();
 
-                c->fd_ = bin->head_;
-                
-                bin->head_ = c;
-                bin->count_++;
+    if (likely(size <= MALLOC_MAX_SMALL)) {
+        return small_alloc(size_to_class((uint32_t)size));
+    }
 
-                return;
-            }
-        }
+    if (unlikely(size > 0xFFFFFFFFu - MALLOC_PAGE_SIZE)) {
+        return NULL;
+    }
+
+    return large_alloc((uint32_t)size);
+}
+
+void free(void* ptr) {
+    if (unlikely(!ptr)) {
+        return;
     }
 
-    const uint32_t page_idx = (uint32_t)(uintptr_t)ptr >> 12u;
-    const uint8_t arena_idx = g_page_to_arena[page_idx];
+    span_t* s = span_of(ptr);
 
-    malloc_state_t* arena = &g_arenas[arena_idx];
+    if (likely(s->state_ == SPAN_SMALL)) {
+        small_free(s->cls_, ptr);
 
-    (void)pthread_mutex_lock(&arena->lock_);
-    
-    free_internal(arena, c, size);
-    
-    (void)pthread_mutex_unlock(&arena->lock_);
+        return;
+    }
+
+    large_free(s);
 }
 
 void* calloc(size_t nelem, size_t elsize) {
     const size_t size = nelem * elsize;
 
-    if (unlikely(nelem != 0u 
+    if (unlikely(nelem != 0u
         && size / nelem != elsize)) {
-        
+
         return NULL;
     }
 
     void* ptr = malloc(size);
 
     if (likely(ptr != NULL)) {
-        memset(ptr, 0, size);
+        /* A mapping of its own is fresh from the kernel, zeroed already. */
+        if (size < MALLOC_MMAP_THRESHOLD) {
+            memset(ptr, 0, size);
+        }
     }
 
     return ptr;
@@ -635,56 +900,90 @@ void* realloc(void* ptr, size_t size) {
         return NULL;
     }
 
-    malloc_chunk_t* c = mem_to_chunk(ptr);
+    const span_t* s = span_of(ptr);
+    const uint32_t old_size = usable_size(s);
 
-    if (unlikely((c->size_ & CHUNK_IS_MMAPPED) != 0u)) {
-        const uint32_t old_size = chunk_size(c);
-        const uint32_t copy_size = (size < old_size) ? (uint32_t)size : old_size;
+    /* Stay put unless the block would be less than half used. */
+    if (size <= old_size && size >= old_size / 2u) {
+        return ptr;
+    }
 
-        void* new_ptr = malloc(size);
+    void* new_ptr = malloc(size);
 
-        if (likely(new_ptr != NULL)) {
-            memcpy(new_ptr, ptr, copy_size);
-            
-            free(ptr);
+    if (likely(new_ptr != NULL)) {
+        memcpy(new_ptr, ptr, size < old_size ? size : old_size);
+        free(ptr);
+    }
+
+    return new_ptr;
+}
+
+void malloc_thread_exit(void) {
+    for (uint32_t c = 1u; c < MALLOC_NUM_CLASSES; c++) {
+        tcache_bin_t* bin = &t_tcache.bins_[c];
+
+        if (bin->head_) {
+            central_release(c, bin->head_, bin->count_);
         }
 
-        return new_ptr;
+        bin->head_ = NULL;
+        bin->count_ = 0u;
     }
+}
 
-    uint32_t request = (uint32_t)((size + 4u + 7u) & ~7u);
-
-    if (request < MALLOC_MIN_SIZE) {
-        request = MALLOC_MIN_SIZE;
+int malloc_get_stats(malloc_stats_t* out) {
+    if (!out) {
+        return -1;
     }
 
-    const uint32_t old_size = chunk_size(c);
+    ensure_inited();
 
-    const uint32_t page_idx = (uint32_t)(uintptr_t)ptr >> 12u;
-    const uint8_t arena_idx = g_page_to_arena[page_idx];
+    memset(out, 0, sizeof(*out));
 
-    malloc_state_t* arena = &g_arenas[arena_idx];
+    for (uint32_t c = 1u; c < MALLOC_NUM_CLASSES; c++) {
+        (void)pthread_mutex_lock(&g_central[c].lock_);
+        out->small_used_bytes += g_central[c].objects_out_ * g_class_size[c];
+        (void)pthread_mutex_unlock(&g_central[c].lock_);
+    }
 
-    (void)pthread_mutex_lock(&arena->lock_);
-    
-    ensure_inited(arena);
+    (void)pthread_mutex_lock(&g_heap.lock_);
 
-    void* res = realloc_internal(arena, c, old_size, request);
+    out->heap_bytes = g_heap.heap_bytes_;
+    out->heap_free_bytes = g_heap.free_bytes_;
+    out->heap_released_bytes = g_heap.released_bytes_;
+    out->small_span_bytes = g_heap.small_bytes_;
+    out->large_bytes = g_heap.large_bytes_;
+    out->mapped_bytes = g_heap.mapped_bytes_;
 
-    (void)pthread_mutex_unlock(&arena->lock_);
+    (void)pthread_mutex_unlock(&g_heap.lock_);
 
-    if (res != NULL) {
-        return res;
-    }
+    return 0;
+}
 
-    void* new_ptr = malloc(size);
+void malloc_stats(void) {
+    malloc_stats_t st;
 
-    if (likely(new_ptr != NULL)) {
-        const uint32_t copy_size = (old_size - 4u < size) ? old_size - 4u : (uint32_t)size;
-        
-        memcpy(new_ptr, ptr, copy_size);
-        free(ptr);
+    if (malloc_get_stats(&st) != 0) {
+        return;
     }
 
-    return new_ptr;
-}
\ No newline at end of file
+    printf("malloc: heap %u KiB, free %u KiB, released %u KiB\n",
+           (unsigned)(st.heap_bytes >> 10), (unsigned)(st.heap_free_bytes >> 10),
+           (unsigned)(st.heap_released_bytes >> 10));
+    printf("malloc: small spans %u KiB (%u KiB handed out), large %u KiB, mapped %u KiB\n",
+           (unsigned)(st.small_span_bytes >> 10), (unsigned)(st.small_used_bytes >> 10),
+           (unsigned)(st.large_bytes >> 10), (unsigned)(st.mapped_bytes >> 10));
+
+    for (uint32_t c = 1u; c < MALLOC_NUM_CLASSES; c++) {
+        (void)pthread_mutex_lock(&g_central[c].lock_);
+
+        const uint32_t spans = g_central[c].spans_;
+        const uint32_t objects = g_central[c].objects_out_;
+
+        (void)pthread_mutex_unlock(&g_central[c].lock_);
+
+        if (spans) {
+            printf("malloc:   %5u bytes: %u spans, %u objects out\n", g_class_size[c], spans, objects);
+        }
+    }
+}
@@ -3,8 +3,11 @@
 
 #include "pthread.h"
 #include "stdlib.h"
+#include "string.h"
 #include "syscall.h"
 
+#include <yos/futex.h>
+#include <yos/mman.h>
 #include <yos/proc.h>
 
 #define PTHREAD_STATE_RUNNING 0u
@@ -17,7 +20,10 @@ typedef struct pthread_internal {
     void* retval;
     void* stack_base;
     uint32_t stack_size;
-    int owns_stack;
+    /* The mapping the stack came from; NULL for a caller-supplied stack. */
+    void* map_base;
+    uint32_t map_size;
+    struct pthread_tcb* tcb;
     int detached;
     int pid;
     volatile uint32_t state;
@@ -27,6 +33,9 @@ typedef struct pthread_internal {
 static pthread_internal_t* pthread_list_head = 0;
 static volatile uint32_t pthread_list_lock = 0;
 
+/* The first pthread_create() can only come from the initial thread. */
+static volatile int pthread_main_pid = 0;
+
 static void pthread_list_lock_acquire(void) {
     while (__sync_lock_test_and_set(&pthread_list_lock, 1u)) {
     }
@@ -59,21 +68,6 @@ static void pthread_list_remove(pthread_internal_t* t) {
     pthread_list_lock_release();
 }
 
-static pthread_internal_t* pthread_list_find_by_pid(int pid) {
-    pthread_internal_t* res = 0;
-    pthread_list_lock_acquire();
-    pthread_internal_t* cur = pthread_list_head;
-    while (cur) {
-        if (cur->pid == pid) {
-            res = cur;
-            break;
-        }
-        cur = cur->next;
-    }
-    pthread_list_lock_release();
-    return res;
-}
-
 static uint32_t pthread_stack_default_size(void) {
     return PTHREAD_DEFAULT_STACK_SIZE;
 }
@@ -91,10 +85,199 @@ static int pthread_futex_wake(volatile uint32_t* uaddr, uint32_t max_wake) {
     return syscall(42, (int)(uintptr_t)uaddr, (int)max_wake, 0);
 }
 
-static int pthread_prepare_stack(const pthread_attr_t* attr, void** out_base, uint32_t* out_size, int* out_owns) {
+static int pthread_futex_wait_until(volatile uint32_t* uaddr, uint32_t expected, uint32_t deadline_ms) {
+    return syscall4(58, (int)(uintptr_t)uaddr, (int)expected, (int)deadline_ms, (int)YOS_FUTEX_ABSTIME);
+}
+
+static int pthread_futex_wait_maybe_until(volatile uint32_t* uaddr, uint32_t expected, const uint32_t* deadline_ms) {
+    if (deadline_ms) {
+        return pthread_futex_wait_until(uaddr, expected, *deadline_ms);
+    }
+    return pthread_futex_wait(uaddr, expected);
+}
+
+static int pthread_futex_cmp_requeue(volatile uint32_t* uaddr, volatile uint32_t* uaddr2, uint32_t nr_wake, uint32_t nr_requeue, uint32_t cmpval) {
+    yos_futex_requeue_t req;
+    req.uaddr = uaddr;
+    req.uaddr2 = uaddr2;
+    req.nr_wake = nr_wake;
+    req.nr_requeue = nr_requeue;
+    req.cmpval = cmpval;
+    req.flags = YOS_FUTEX_REQUEUE_CMP;
+    return syscall(59, (int)(uintptr_t)&req, 0, 0);
+}
+
+/* Bump a sequence word and wake its sleepers in one call. */
+static int pthread_futex_bump_wake(volatile uint32_t* seq, uint32_t max_wake) {
+    yos_futex_wake_op_t req;
+    req.uaddr = seq;
+    req.uaddr2 = seq;
+    req.nr_wake = max_wake;
+    req.nr_wake2 = 0u;
+    req.op = YOS_FUTEX_OP_ADD;
+    req.oparg = 1u;
+    req.cmp = YOS_FUTEX_OP_CMP_EQ;
+    req.cmparg = 0u;
+    return syscall(60, (int)(uintptr_t)&req, 0, 0);
+}
+
+/*
+ * Static TLS. The linker lays every __thread variable out in one template
+ * (usr/linker.ld, uld): __tls_image_size bytes copied from .tdata, then
+ * zeroes up to __tls_size. Each thread gets a copy that ends right at its
+ * thread pointer, and the thread pointer addresses a control block whose
+ * first word points at itself, which is what %gs:0 loads.
+ */
+extern char __tls_image[];
+extern char __tls_image_size[];
+extern char __tls_size[];
+extern char __tls_align[];
+
+typedef struct pthread_tcb {
+    struct pthread_tcb* self;
+    pthread_internal_t* thread;
+} pthread_tcb_t;
+
+static inline pthread_tcb_t* pthread_tcb(void) {
+    pthread_tcb_t* tcb;
+    __asm__ volatile ("movl %%gs:0, %0" : "=r"(tcb));
+    return tcb;
+}
+
+/* The calling thread's pid, fetched once: the PI mutex fast paths must not make a syscall. */
+static __thread uint32_t pthread_cached_tid;
+
+static inline uint32_t pthread_tid(void) {
+    uint32_t tid = pthread_cached_tid;
+    if (!tid) {
+        tid = (uint32_t)syscall(1, 0, 0, 0);
+        pthread_cached_tid = tid;
+    }
+    return tid;
+}
+
+static uint32_t pthread_tls_align(void) {
+    const uint32_t align = (uint32_t)(uintptr_t)__tls_align;
+    return align < 16u ? 16u : align;
+}
+
+/* Bytes a thread needs for its TLS block and control block, alignment slack included. */
+uint32_t __libc_tls_area_size(void) {
+    return pthread_tls_align() - 1u + (uint32_t)(uintptr_t)__tls_size + (uint32_t)sizeof(pthread_tcb_t);
+}
+
+static pthread_tcb_t* pthread_tls_setup(void* area, pthread_internal_t* thread) {
+    const uint32_t align = pthread_tls_align();
+    const uint32_t size = (uint32_t)(uintptr_t)__tls_size;
+    const uint32_t image = (uint32_t)(uintptr_t)__tls_image_size;
+
+    uint8_t* block = (uint8_t*)(((uintptr_t)area + align - 1u) & ~(uintptr_t)(align - 1u));
+
+    memcpy(block, __tls_image, image);
+    memset(block + image, 0, size - image);
+
+    pthread_tcb_t* tcb = (pthread_tcb_t*)(block + size);
+    tcb->self = tcb;
+    tcb->thread = thread;
+    return tcb;
+}
+
+/* Called from _start with __libc_tls_area_size() bytes of the initial stack. */
+void __libc_tls_init(void* area) {
+    (void)syscall(56, (int)(uintptr_t)pthread_tls_setup(area, 0), 0, 0);
+}
+
+/*
+ * Thread stacks are mappings of their own with a guard page at the bottom.
+ * Joined threads park theirs here, still mapped and warm, for the next
+ * pthread_create() asking for the same size.
+ */
+#define PTHREAD_GUARD_SIZE        4096u
+#define PTHREAD_STACK_CACHE_MAX   8u
+#define PTHREAD_STACK_CACHE_BYTES (2u * 1024u * 1024u)
+
+/* Lives in the lowest stack page while the mapping sits in the cache, under the list lock. */
+typedef struct pthread_stack {
+    uint32_t map_size;
+    struct pthread_stack* next;
+} pthread_stack_t;
+
+static pthread_stack_t* pthread_stack_cache = 0;
+static uint32_t pthread_stack_cache_count = 0;
+static uint32_t pthread_stack_cache_bytes = 0;
+
+static int pthread_zero_fd = -1;
+
+static void* pthread_stack_map(uint32_t map_size) {
+    pthread_list_lock_acquire();
+    pthread_stack_t** link = &pthread_stack_cache;
+    while (*link && (*link)->map_size != map_size) {
+        link = &(*link)->next;
+    }
+    pthread_stack_t* hit = *link;
+    if (hit) {
+        *link = hit->next;
+        pthread_stack_cache_count--;
+        pthread_stack_cache_bytes -= map_size;
+    }
+    pthread_list_lock_release();
+
+    if (hit) {
+        return (uint8_t*)hit - PTHREAD_GUARD_SIZE;
+    }
+
+    int fd = __atomic_load_n(&pthread_zero_fd, __ATOMIC_ACQUIRE);
+    if (fd < 0) {
+        const int new_fd = syscall(2, (int)(uintptr_t)"/dev/zero", 0, 0);
+        if (new_fd < 0) return 0;
+
+        int expected = -1;
+        if (!__atomic_compare_exchange_n(&pthread_zero_fd, &expected, new_fd, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            (void)syscall(5, new_fd, 0, 0);
+        }
+        fd = __atomic_load_n(&pthread_zero_fd, __ATOMIC_ACQUIRE);
+    }
+
+    void* base = (void*)syscall(21, fd, (int)map_size, 2);
+    if (!base || base == (void*)-1) return 0;
+
+    if (syscall(57, (int)(uintptr_t)base, (int)PTHREAD_GUARD_SIZE, (int)YOS_MADV_GUARD_INSTALL) != 0) {
+        (void)syscall(22, (int)(uintptr_t)base, (int)map_size, 0);
+        return 0;
+    }
+
+    return base;
+}
+
+static void pthread_stack_unmap(void* base, uint32_t map_size) {
+    pthread_stack_t* entry = (pthread_stack_t*)((uint8_t*)base + PTHREAD_GUARD_SIZE);
+    int cached = 0;
+
+    pthread_list_lock_acquire();
+    if (pthread_stack_cache_count < PTHREAD_STACK_CACHE_MAX
+        && pthread_stack_cache_bytes + map_size <= PTHREAD_STACK_CACHE_BYTES) {
+        entry->map_size = map_size;
+        entry->next = pthread_stack_cache;
+        pthread_stack_cache = entry;
+        pthread_stack_cache_count++;
+        pthread_stack_cache_bytes += map_size;
+        cached = 1;
+    }
+    pthread_list_lock_release();
+
+    if (!cached) {
+        (void)syscall(22, (int)(uintptr_t)base, (int)map_size, 0);
+    }
+}
+
+/*
+ * Stack plus what lives at its top: the thread's pthread_internal_t and its
+ * TLS area. Caller-supplied stacks are carved the same way.
+ */
+static pthread_internal_t* pthread_prepare_stack(const pthread_attr_t* attr) {
     uint32_t size = pthread_stack_default_size();
     void* base = 0;
-    int owns = 0;
 
     if (attr) {
         if (attr->stack_size != 0) {
@@ -102,39 +285,60 @@ static int pthread_prepare_stack(const pthread_attr_t* attr, void** out_base, ui
         }
         base = attr->stack_base;
         if (base && attr->stack_size == 0) {
-            return -1;
+            return 0;
         }
         if (attr->detached != PTHREAD_CREATE_JOINABLE) {
-            return -1;
+            return 0;
         }
     }
 
     if (pthread_validate_stack_size(size) != 0) {
-        return -1;
+        return 0;
     }
 
+    const uint32_t extra = ((uint32_t)sizeof(pthread_internal_t) + __libc_tls_area_size() + 15u) & ~15u;
+    void* map_base = 0;
+    uint32_t map_size = 0;
+
     if (!base) {
-        base = malloc(size);
-        if (!base) return -1;
-        owns = 1;
+        map_size = (PTHREAD_GUARD_SIZE + size + extra + 4095u) & ~4095u;
+        map_base = pthread_stack_map(map_size);
+        if (!map_base) return 0;
+
+        base = (uint8_t*)map_base + PTHREAD_GUARD_SIZE;
+        size = map_size - PTHREAD_GUARD_SIZE;
+    } else if (size < extra + PTHREAD_STACK_MIN / 2u) {
+        return 0;
     }
 
-    *out_base = base;
-    *out_size = size;
-    *out_owns = owns;
-    return 0;
+    uintptr_t top = ((uintptr_t)base + size - extra) & ~(uintptr_t)15u;
+    if (top < (uintptr_t)base) {
+        if (map_base) pthread_stack_unmap(map_base, map_size);
+        return 0;
+    }
+
+    pthread_internal_t* t = (pthread_internal_t*)top;
+    memset(t, 0, sizeof(*t));
+
+    t->stack_base = base;
+    t->stack_size = (uint32_t)(top - (uintptr_t)base);
+    t->map_base = map_base;
+    t->map_size = map_size;
+    t->tcb = pthread_tls_setup((uint8_t*)top + sizeof(pthread_internal_t), t);
+    return t;
 }
 
 static void pthread_cleanup_internal(pthread_internal_t* t) {
     if (!t) return;
 
-    if (t->owns_stack && t->stack_base) {
-        free(t->stack_base);
+    if (t->map_base) {
+        pthread_stack_unmap(t->map_base, t->map_size);
     }
-    free(t);
 }
 
 static void pthread_finish_internal(pthread_internal_t* t, void* retval) {
+    malloc_thread_exit();
+
     if (!t) {
         syscall(0, 0, 0, 0);
         for (;;) { }
@@ -153,11 +357,14 @@ static void pthread_finish_internal(pthread_internal_t* t, void* retval) {
 static void pthread_trampoline(void* arg) {
     pthread_internal_t* t = (pthread_internal_t*)arg;
     void* res = 0;
-    if (t) {
-        t->pid = syscall(1, 0, 0, 0);
-        pthread_list_add(t);
-    }
-    if (t && t->start_routine) {
+
+    /* Before anything else: malloc and every __thread access go through it. */
+    (void)syscall(56, (int)(uintptr_t)t->tcb, 0, 0);
+
+    t->pid = (int)pthread_tid();
+    pthread_list_add(t);
+
+    if (t->start_routine) {
         res = t->start_routine(t->arg);
     }
     pthread_finish_internal(t, res);
@@ -204,39 +411,23 @@ int pthread_attr_setdetachstate(pthread_attr_t* attr, int detached) {
 int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*start_routine)(void*), void* arg) {
     if (!thread || !start_routine) return -1;
 
-    void* stack_base = 0;
-    uint32_t stack_size = 0;
-    int owns_stack = 0;
-    if (pthread_prepare_stack(attr, &stack_base, &stack_size, &owns_stack) != 0) {
-        return -1;
+    if (!pthread_main_pid) {
+        (void)__sync_bool_compare_and_swap(&pthread_main_pid, 0, syscall(1, 0, 0, 0));
     }
 
-    pthread_internal_t* t = (pthread_internal_t*)malloc(sizeof(pthread_internal_t));
+    pthread_internal_t* t = pthread_prepare_stack(attr);
     if (!t) {
-        if (owns_stack && stack_base) {
-            free(stack_base);
-        }
         return -1;
     }
 
     t->start_routine = start_routine;
     t->arg = arg;
-    t->retval = 0;
-    t->stack_base = stack_base;
-    t->stack_size = stack_size;
-    t->owns_stack = owns_stack;
     t->detached = PTHREAD_CREATE_JOINABLE;
     t->pid = -1;
     t->state = PTHREAD_STATE_RUNNING;
-    t->next = 0;
 
-    uintptr_t stack_top_addr = (uintptr_t)stack_base + (uintptr_t)stack_size;
-    if (stack_top_addr < (uintptr_t)stack_base) {
-        pthread_cleanup_internal(t);
-        return -1;
-    }
-    void* stack_top = (void*)stack_top_addr;
-    int pid = yos_clone(pthread_trampoline, t, stack_top, stack_size);
+    void* stack_top = (uint8_t*)t->stack_base + t->stack_size;
+    int pid = yos_clone(pthread_trampoline, t, stack_top, t->stack_size);
     if (pid < 0) {
         pthread_cleanup_internal(t);
         return -1;
@@ -279,31 +470,77 @@ int pthread_detach(pthread_t thread) {
 }
 
 void pthread_exit(void* retval) {
-    int pid = syscall(1, 0, 0, 0);
-    pthread_internal_t* t = pthread_list_find_by_pid(pid);
-    pthread_finish_internal(t, retval);
+    pthread_finish_internal(pthread_tcb()->thread, retval);
+}
+
+void pthread_kill_other_threads_np(void) {
+    const int self = syscall(1, 0, 0, 0);
+
+    pthread_list_lock_acquire();
+    for (pthread_internal_t* cur = pthread_list_head; cur; cur = cur->next) {
+        if (cur->pid > 0 && cur->pid != self && cur->state == PTHREAD_STATE_RUNNING) {
+            (void)syscall(8, cur->pid, 0, 0);
+        }
+    }
+    pthread_list_lock_release();
+
+    if (pthread_main_pid > 0 && pthread_main_pid != self) {
+        (void)syscall(8, pthread_main_pid, 0, 0);
+    }
 }
 
 pthread_t pthread_self(void) {
+    pthread_internal_t* self = pthread_tcb()->thread;
+
     pthread_t t;
-    t.pid = syscall(1, 0, 0, 0);
-    t.internal = 0;
+    t.pid = self ? self->pid : (int)pthread_tid();
+    t.internal = self;
     return t;
 }
 
-static int pthread_mutex_lock_slow(pthread_mutex_t* mutex) {
+static int pthread_mutex_lock_slow(pthread_mutex_t* mutex, const uint32_t* deadline_ms) {
     for (;;) {
         uint32_t prev = __sync_lock_test_and_set(&mutex->value, 2u);
         if (prev == 0u) {
             return 0;
         }
-        pthread_futex_wait(&mutex->value, 2u);
+        if (pthread_futex_wait_maybe_until(&mutex->value, 2u, deadline_ms) == YOS_FUTEX_ETIMEDOUT) {
+            return PTHREAD_ETIMEDOUT;
+        }
     }
 }
 
+int pthread_mutexattr_init(pthread_mutexattr_t* attr) {
+    if (!attr) return -1;
+    attr->protocol = PTHREAD_PRIO_NONE;
+    return 0;
+}
+
+int pthread_mutexattr_destroy(pthread_mutexattr_t* attr) {
+    return pthread_mutexattr_init(attr);
+}
+
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t* attr, int protocol) {
+    if (!attr) return -1;
+    if (protocol != PTHREAD_PRIO_NONE && protocol != PTHREAD_PRIO_INHERIT) return -1;
+    attr->protocol = protocol;
+    return 0;
+}
+
+int pthread_mutexattr_getprotocol(const pthread_mutexattr_t* attr, int* protocol) {
+    if (!attr || !protocol) return -1;
+    *protocol = attr->protocol;
+    return 0;
+}
+
 int pthread_mutex_init(pthread_mutex_t* mutex) {
+    return pthread_mutex_init_attr(mutex, 0);
+}
+
+int pthread_mutex_init_attr(pthread_mutex_t* mutex, const pthread_mutexattr_t* attr) {
     if (!mutex) return -1;
     mutex->value = 0u;
+    mutex->protocol = attr ? (uint32_t)attr->protocol : (uint32_t)PTHREAD_PRIO_NONE;
     return 0;
 }
 
@@ -313,24 +550,76 @@ int pthread_mutex_destroy(pthread_mutex_t* mutex) {
     return 0;
 }
 
+/*
+ * PI mutexes: the word is 0 or the owner's pid, taken and released with a
+ * compare-and-swap while uncontended. Once a waiter is queued the kernel
+ * sets YOS_FUTEX_WAITERS and the owner has to unlock through it.
+ */
+static int pthread_mutex_lock_pi(pthread_mutex_t* mutex, const uint32_t* deadline_ms) {
+    const uint32_t tid = pthread_tid();
+    if (__sync_bool_compare_and_swap(&mutex->value, 0u, tid)) {
+        return 0;
+    }
+    for (;;) {
+        int r = syscall(61, (int)(uintptr_t)&mutex->value,
+                        deadline_ms ? (int)*deadline_ms : (int)YOS_FUTEX_INFINITE,
+                        deadline_ms ? (int)YOS_FUTEX_ABSTIME : 0);
+        if (r == 0) {
+            return 0;
+        }
+        if (r != YOS_FUTEX_EINTR) {
+            return r == YOS_FUTEX_ETIMEDOUT ? PTHREAD_ETIMEDOUT : -1;
+        }
+    }
+}
+
+static int pthread_mutex_unlock_pi(pthread_mutex_t* mutex) {
+    const uint32_t tid = pthread_tid();
+    if (__sync_bool_compare_and_swap(&mutex->value, tid, 0u)) {
+        return 0;
+    }
+    if ((mutex->value & YOS_FUTEX_TID_MASK) != tid) {
+        return -1;
+    }
+    return syscall(62, (int)(uintptr_t)&mutex->value, 0, 0) == 0 ? 0 : -1;
+}
+
 int pthread_mutex_lock(pthread_mutex_t* mutex) {
     if (!mutex) return -1;
+    if (mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        return pthread_mutex_lock_pi(mutex, 0);
+    }
     if (__sync_bool_compare_and_swap(&mutex->value, 0u, 1u)) {
         return 0;
     }
-    return pthread_mutex_lock_slow(mutex);
+    return pthread_mutex_lock_slow(mutex, 0);
 }
 
 int pthread_mutex_trylock(pthread_mutex_t* mutex) {
     if (!mutex) return -1;
-    if (__sync_bool_compare_and_swap(&mutex->value, 0u, 1u)) {
+    const uint32_t locked = mutex->protocol == PTHREAD_PRIO_INHERIT ? pthread_tid() : 1u;
+    if (__sync_bool_compare_and_swap(&mutex->value, 0u, locked)) {
         return 0;
     }
     return -1;
 }
 
+int pthread_mutex_timedlock(pthread_mutex_t* mutex, uint32_t deadline_ms) {
+    if (!mutex) return -1;
+    if (mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        return pthread_mutex_lock_pi(mutex, &deadline_ms);
+    }
+    if (__sync_bool_compare_and_swap(&mutex->value, 0u, 1u)) {
+        return 0;
+    }
+    return pthread_mutex_lock_slow(mutex, &deadline_ms);
+}
+
 int pthread_mutex_unlock(pthread_mutex_t* mutex) {
     if (!mutex) return -1;
+    if (mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        return pthread_mutex_unlock_pi(mutex);
+    }
     uint32_t prev = __sync_lock_test_and_set(&mutex->value, 0u);
     if (prev == 0u) {
         return -1;
@@ -344,35 +633,75 @@ int pthread_mutex_unlock(pthread_mutex_t* mutex) {
 int pthread_cond_init(pthread_cond_t* cond) {
     if (!cond) return -1;
     cond->seq = 0u;
+    cond->waiters = 0u;
+    cond->mutex = 0;
     return 0;
 }
 
 int pthread_cond_destroy(pthread_cond_t* cond) {
     if (!cond) return -1;
     cond->seq = 0u;
+    cond->waiters = 0u;
+    cond->mutex = 0;
     return 0;
 }
 
-int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+static int pthread_cond_wait_impl(pthread_cond_t* cond, pthread_mutex_t* mutex, const uint32_t* deadline_ms) {
     if (!cond || !mutex) return -1;
+    cond->mutex = mutex;
+    __sync_fetch_and_add(&cond->waiters, 1u);
     uint32_t seq = cond->seq;
     if (pthread_mutex_unlock(mutex) != 0) {
+        __sync_fetch_and_sub(&cond->waiters, 1u);
         return -1;
     }
-    pthread_futex_wait(&cond->seq, seq);
-    return pthread_mutex_lock(mutex);
+    int r = pthread_futex_wait_maybe_until(&cond->seq, seq, deadline_ms);
+    __sync_fetch_and_sub(&cond->waiters, 1u);
+    if (mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        (void)pthread_mutex_lock_pi(mutex, 0);
+    } else {
+        /*
+         * A broadcast may have requeued the other waiters onto the mutex. Take
+         * it as contended so that our unlock passes the wakeup on to the next.
+         */
+        (void)pthread_mutex_lock_slow(mutex, 0);
+    }
+    return r == YOS_FUTEX_ETIMEDOUT ? PTHREAD_ETIMEDOUT : 0;
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    return pthread_cond_wait_impl(cond, mutex, 0);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, uint32_t deadline_ms) {
+    return pthread_cond_wait_impl(cond, mutex, &deadline_ms);
 }
 
 int pthread_cond_signal(pthread_cond_t* cond) {
     if (!cond) return -1;
-    __sync_fetch_and_add(&cond->seq, 1u);
-    pthread_futex_wake(&cond->seq, 1u);
+    if (cond->waiters == 0u) {
+        return 0;
+    }
+    pthread_futex_bump_wake(&cond->seq, 1u);
     return 0;
 }
 
 int pthread_cond_broadcast(pthread_cond_t* cond) {
     if (!cond) return -1;
-    __sync_fetch_and_add(&cond->seq, 1u);
+    if (cond->waiters == 0u) {
+        return 0;
+    }
+    uint32_t seq = __sync_add_and_fetch(&cond->seq, 1u);
+    pthread_mutex_t* mutex = cond->mutex;
+    /*
+     * Wake one waiter and move the rest onto the mutex word, where each
+     * unlock releases the next instead of all of them fighting for it.
+     * A PI mutex word holds an owner pid the requeue knows nothing about.
+     */
+    if (mutex && mutex->protocol != PTHREAD_PRIO_INHERIT
+        && pthread_futex_cmp_requeue(&cond->seq, &mutex->value, 1u, 0x7FFFFFFFu, seq) >= 0) {
+        return 0;
+    }
     pthread_futex_wake(&cond->seq, 0x7FFFFFFFu);
     return 0;
 }
@@ -381,17 +710,32 @@ int pthread_rwlock_init(pthread_rwlock_t* lock) {
     if (!lock) return -1;
     lock->state = 0;
     lock->writers_waiting = 0u;
+    lock->readers_waiting = 0u;
+    lock->reader_seq = 0u;
+    lock->writer_seq = 0u;
     return 0;
 }
 
 int pthread_rwlock_destroy(pthread_rwlock_t* lock) {
-    if (!lock) return -1;
-    lock->state = 0;
-    lock->writers_waiting = 0u;
-    return 0;
+    return pthread_rwlock_init(lock);
 }
 
-int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
+static void pthread_rwlock_wake_readers(pthread_rwlock_t* lock) {
+    if (lock->readers_waiting != 0u) {
+        pthread_futex_bump_wake(&lock->reader_seq, 0x7FFFFFFFu);
+    }
+}
+
+static void pthread_rwlock_wake_writer(pthread_rwlock_t* lock) {
+    pthread_futex_bump_wake(&lock->writer_seq, 1u);
+}
+
+/*
+ * Sleepers announce themselves before rechecking the lock, and unlockers
+ * publish the new state before looking for sleepers, so one of the two
+ * always sees the other.
+ */
+static int pthread_rwlock_rdlock_impl(pthread_rwlock_t* lock, const uint32_t* deadline_ms) {
     if (!lock) return -1;
     for (;;) {
         int32_t state = lock->state;
@@ -401,17 +745,27 @@ int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
             }
             continue;
         }
-        if (state < 0) {
-            pthread_futex_wait((volatile uint32_t*)&lock->state, (uint32_t)state);
-            continue;
+        uint32_t seq = lock->reader_seq;
+        __sync_fetch_and_add(&lock->readers_waiting, 1u);
+        int r = 0;
+        if (lock->state < 0 || lock->writers_waiting != 0u) {
+            r = pthread_futex_wait_maybe_until(&lock->reader_seq, seq, deadline_ms);
         }
-        uint32_t waiting = lock->writers_waiting;
-        if (waiting != 0u) {
-            pthread_futex_wait(&lock->writers_waiting, waiting);
+        __sync_fetch_and_sub(&lock->readers_waiting, 1u);
+        if (r == YOS_FUTEX_ETIMEDOUT) {
+            return PTHREAD_ETIMEDOUT;
         }
     }
 }
 
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
+    return pthread_rwlock_rdlock_impl(lock, 0);
+}
+
+int pthread_rwlock_timedrdlock(pthread_rwlock_t* lock, uint32_t deadline_ms) {
+    return pthread_rwlock_rdlock_impl(lock, &deadline_ms);
+}
+
 int pthread_rwlock_tryrdlock(pthread_rwlock_t* lock) {
     if (!lock) return -1;
     int32_t state = lock->state;
@@ -423,22 +777,36 @@ int pthread_rwlock_tryrdlock(pthread_rwlock_t* lock) {
     return -1;
 }
 
-int pthread_rwlock_wrlock(pthread_rwlock_t* lock) {
+static int pthread_rwlock_wrlock_impl(pthread_rwlock_t* lock, const uint32_t* deadline_ms) {
     if (!lock) return -1;
     __sync_fetch_and_add(&lock->writers_waiting, 1u);
     for (;;) {
         if (__sync_bool_compare_and_swap(&lock->state, 0, -1)) {
-            uint32_t remaining = __sync_fetch_and_sub(&lock->writers_waiting, 1u) - 1u;
-            if (remaining == 0u) {
-                pthread_futex_wake(&lock->writers_waiting, 0x7FFFFFFFu);
-            }
+            __sync_fetch_and_sub(&lock->writers_waiting, 1u);
             return 0;
         }
-        int32_t state = lock->state;
-        pthread_futex_wait((volatile uint32_t*)&lock->state, (uint32_t)state);
+        uint32_t seq = lock->writer_seq;
+        if (lock->state == 0) {
+            continue;
+        }
+        if (pthread_futex_wait_maybe_until(&lock->writer_seq, seq, deadline_ms) == YOS_FUTEX_ETIMEDOUT) {
+            /* Readers held back for us alone can go now. */
+            if (__sync_sub_and_fetch(&lock->writers_waiting, 1u) == 0u) {
+                pthread_rwlock_wake_readers(lock);
+            }
+            return PTHREAD_ETIMEDOUT;
+        }
     }
 }
 
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) {
+    return pthread_rwlock_wrlock_impl(lock, 0);
+}
+
+int pthread_rwlock_timedwrlock(pthread_rwlock_t* lock, uint32_t deadline_ms) {
+    return pthread_rwlock_wrlock_impl(lock, &deadline_ms);
+}
+
 int pthread_rwlock_trywrlock(pthread_rwlock_t* lock) {
     if (!lock) return -1;
     if (__sync_bool_compare_and_swap(&lock->state, 0, -1)) {
@@ -454,14 +822,18 @@ int pthread_rwlock_unlock(pthread_rwlock_t* lock) {
         if (!__sync_bool_compare_and_swap(&lock->state, -1, 0)) {
             return -1;
         }
-        pthread_futex_wake((volatile uint32_t*)&lock->state, 0x7FFFFFFFu);
+        /* Writers first: a reader batch woken now would only block them again. */
+        if (lock->writers_waiting != 0u) {
+            pthread_rwlock_wake_writer(lock);
+        } else {
+            pthread_rwlock_wake_readers(lock);
+        }
         return 0;
     }
     if (state > 0) {
         int32_t prev = __sync_fetch_and_sub(&lock->state, 1);
-        int32_t next = prev - 1;
-        if (next == 0) {
-            pthread_futex_wake((volatile uint32_t*)&lock->state, 0x7FFFFFFFu);
+        if (prev == 1 && lock->writers_waiting != 0u) {
+            pthread_rwlock_wake_writer(lock);
         }
         return 0;
     }
@@ -17,6 +17,16 @@ extern "C" {
 #define PTHREAD_STACK_MIN 16384u
 #define PTHREAD_DEFAULT_STACK_SIZE 65536u
 
+/* Returned by the timed waits once their uptime_ms() deadline has passed. */
+#define PTHREAD_ETIMEDOUT 110
+
+/*
+ * Mutex protocols. A PTHREAD_PRIO_INHERIT mutex holds its owner's pid and
+ * lends the owner the priority of whoever blocks on it until it unlocks.
+ */
+#define PTHREAD_PRIO_NONE    0
+#define PTHREAD_PRIO_INHERIT 1
+
 typedef struct pthread_internal pthread_internal_t;
 
 typedef struct {
@@ -32,15 +42,26 @@ typedef struct {
 
 typedef struct {
     volatile uint32_t value;
+    uint32_t protocol;
 } pthread_mutex_t;
 
+typedef struct {
+    int protocol;
+} pthread_mutexattr_t;
+
 typedef struct {
     volatile uint32_t seq;
+    volatile uint32_t waiters;
+    pthread_mutex_t* volatile mutex;
 } pthread_cond_t;
 
+/* Readers and writers sleep on separate words so that a wakeup only reaches the side that can run. */
 typedef struct {
     volatile int32_t state;
     volatile uint32_t writers_waiting;
+    volatile uint32_t readers_waiting;
+    volatile uint32_t reader_seq;
+    volatile uint32_t writer_seq;
 } pthread_rwlock_t;
 
 typedef struct {
@@ -53,9 +74,10 @@ typedef struct {
     volatile uint32_t seq;
 } pthread_barrier_t;
 
-#define PTHREAD_MUTEX_INITIALIZER { 0u }
-#define PTHREAD_COND_INITIALIZER { 0u }
-#define PTHREAD_RWLOCK_INITIALIZER { 0, 0u }
+#define PTHREAD_MUTEX_INITIALIZER { 0u, PTHREAD_PRIO_NONE }
+#define PTHREAD_PI_MUTEX_INITIALIZER { 0u, PTHREAD_PRIO_INHERIT }
+#define PTHREAD_COND_INITIALIZER { 0u, 0u, 0 }
+#define PTHREAD_RWLOCK_INITIALIZER { 0, 0u, 0u, 0u, 0u }
 #define PTHREAD_SPINLOCK_INITIALIZER { 0u }
 
 #define PTHREAD_BARRIER_SERIAL_THREAD 1
@@ -72,15 +94,26 @@ int pthread_detach(pthread_t thread);
 void pthread_exit(void* retval);
 pthread_t pthread_self(void);
 
+/* SIGTERM to every other thread of the process; exit() does this before leaving. */
+void pthread_kill_other_threads_np(void);
+
+int pthread_mutexattr_init(pthread_mutexattr_t* attr);
+int pthread_mutexattr_destroy(pthread_mutexattr_t* attr);
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t* attr, int protocol);
+int pthread_mutexattr_getprotocol(const pthread_mutexattr_t* attr, int* protocol);
+
 int pthread_mutex_init(pthread_mutex_t* mutex);
+int pthread_mutex_init_attr(pthread_mutex_t* mutex, const pthread_mutexattr_t* attr);
 int pthread_mutex_destroy(pthread_mutex_t* mutex);
 int pthread_mutex_lock(pthread_mutex_t* mutex);
 int pthread_mutex_trylock(pthread_mutex_t* mutex);
+int pthread_mutex_timedlock(pthread_mutex_t* mutex, uint32_t deadline_ms);
 int pthread_mutex_unlock(pthread_mutex_t* mutex);
 
 int pthread_cond_init(pthread_cond_t* cond);
 int pthread_cond_destroy(pthread_cond_t* cond);
 int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex);
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, uint32_t deadline_ms);
 int pthread_cond_signal(pthread_cond_t* cond);
 int pthread_cond_broadcast(pthread_cond_t* cond);
 
@@ -88,8 +121,10 @@ int pthread_rwlock_init(pthread_rwlock_t* lock);
 int pthread_rwlock_destroy(pthread_rwlock_t* lock);
 int pthread_rwlock_rdlock(pthread_rwlock_t* lock);
 int pthread_rwlock_tryrdlock(pthread_rwlock_t* lock);
+int pthread_rwlock_timedrdlock(pthread_rwlock_t* lock, uint32_t deadline_ms);
 int pthread_rwlock_wrlock(pthread_rwlock_t* lock);
 int pthread_rwlock_trywrlock(pthread_rwlock_t* lock);
+int pthread_rwlock_timedwrlock(pthread_rwlock_t* lock, uint32_t deadline_ms);
 int pthread_rwlock_unlock(pthread_rwlock_t* lock);
 
 int pthread_spin_init(pthread_spinlock_t* lock);
@@ -8,6 +8,7 @@
 
 void exit(int status) {
     fflush(NULL);
+    pthread_kill_other_threads_np();
     syscall(0, status, 0, 0); 
     while(1);
 }
@@ -15,6 +15,23 @@ void  free(void* ptr);
 void* calloc(size_t nelem, size_t elsize);
 void* realloc(void* ptr, size_t size);
 
+/* Where the allocator's memory is; every field in bytes. */
+typedef struct {
+    size_t heap_bytes;
+    size_t heap_free_bytes;
+    size_t heap_released_bytes;
+    size_t small_span_bytes;
+    size_t small_used_bytes;
+    size_t large_bytes;
+    size_t mapped_bytes;
+} malloc_stats_t;
+
+int  malloc_get_stats(malloc_stats_t* out);
+void malloc_stats(void);
+
+/* Hand the calling thread's cached blocks back before it exits. */
+void malloc_thread_exit(void);
+
 void exit(int status);
 void abort(void);
 
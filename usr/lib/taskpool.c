@@ -0,0 +1,535 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#include <yula.h>
+
+#define TP_DEQUE_SIZE 1024u
+#define TP_DEQUE_MASK (TP_DEQUE_SIZE - 1u)
+
+#define TP_CHUNK_TASKS 64u
+
+/* Rounds of looking for work before a thread goes to sleep. */
+#define TP_IDLE_SPINS 64u
+
+/* A range task keeps splitting while its thread has fewer tasks queued than this. */
+#define TP_SPLIT_QUEUED 2u
+
+#define TP_GROUP_WAITING 0x80000000u
+#define TP_GROUP_COUNT   0x7FFFFFFFu
+
+typedef struct tp_task tp_task_t;
+typedef struct tp_worker tp_worker_t;
+
+typedef void (*tp_run_fn_t)(taskpool_t* pool, tp_worker_t* self, const tp_task_t* t);
+
+struct tp_task {
+    tp_run_fn_t run;
+    task_fn_t fn;
+    void* arg;
+    uint32_t begin;
+    uint32_t end;
+    task_group_t* group;
+    tp_task_t* next;
+};
+
+/* Tasks are carved out of malloc'd chunks that stay with the pool until it is destroyed. */
+typedef struct tp_chunk {
+    struct tp_chunk* next;
+    tp_task_t tasks[TP_CHUNK_TASKS];
+} tp_chunk_t;
+
+/* top and bottom sit on their own cache lines: thieves write one, the owner the other. */
+typedef struct {
+    volatile uint32_t top;
+    uint8_t pad0[60];
+    volatile uint32_t bottom;
+    uint8_t pad1[60];
+    tp_task_t* volatile slots[TP_DEQUE_SIZE];
+} tp_deque_t;
+
+struct tp_worker {
+    tp_deque_t dq;
+
+    taskpool_t* pool;
+    uint32_t index;
+    uint32_t rng;
+
+    /* Owned by this thread only: a task goes back to whichever thread ran it. */
+    tp_task_t* free_tasks;
+    tp_chunk_t* chunks;
+
+    uint8_t* stack;
+    uint32_t stack_size;
+    pthread_t thread;
+    int started;
+};
+
+struct taskpool {
+    uint32_t nthreads;
+    volatile uint32_t stop;
+
+    /* Sleepers wait on wake_seq; idle counts the threads about to sleep or asleep. */
+    volatile uint32_t wake_seq;
+    volatile uint32_t idle;
+
+    tp_worker_t* workers;
+};
+
+static inline void tp_cpu_relax(void) {
+    __asm__ volatile("pause" ::: "memory");
+}
+
+static uint32_t tp_deque_size(const tp_deque_t* dq) {
+    const uint32_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+    const uint32_t t = __atomic_load_n(&dq->top, __ATOMIC_RELAXED);
+    const int32_t n = (int32_t)(b - t);
+
+    return n > 0 ? (uint32_t)n : 0u;
+}
+
+static int tp_deque_push(tp_deque_t* dq, tp_task_t* task) {
+    const uint32_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+    const uint32_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+
+    if ((int32_t)(b - t) >= (int32_t)TP_DEQUE_SIZE) return 0;
+
+    __atomic_store_n(&dq->slots[b & TP_DEQUE_MASK], task, __ATOMIC_RELAXED);
+    __atomic_store_n(&dq->bottom, b + 1u, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static tp_task_t* tp_deque_pop(tp_deque_t* dq) {
+    const uint32_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) - 1u;
+
+    /* Claim the bottom slot before looking at top, so a thief and the owner cannot both take it. */
+    __atomic_store_n(&dq->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint32_t t = __atomic_load_n(&dq->top, __ATOMIC_RELAXED);
+
+    if ((int32_t)(b - t) < 0) {
+        __atomic_store_n(&dq->bottom, b + 1u, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    tp_task_t* task = __atomic_load_n(&dq->slots[b & TP_DEQUE_MASK], __ATOMIC_RELAXED);
+    if (b != t) return task;
+
+    /* Last task: race the thieves for it through top. */
+    if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1u, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        task = 0;
+    }
+    __atomic_store_n(&dq->bottom, b + 1u, __ATOMIC_RELAXED);
+    return task;
+}
+
+/* A task, 0 if the deque looked empty, or the deque itself if another thread won the race. */
+static tp_task_t* tp_deque_steal(tp_deque_t* dq) {
+    uint32_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const uint32_t b = __atomic_load_n(&dq->bottom, __ATOMIC_ACQUIRE);
+
+    if ((int32_t)(b - t) <= 0) return 0;
+
+    tp_task_t* task = __atomic_load_n(&dq->slots[t & TP_DEQUE_MASK], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1u, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        return (tp_task_t*)(void*)dq;
+    }
+    return task;
+}
+
+static tp_task_t* tp_task_alloc(tp_worker_t* self) {
+    tp_task_t* t = self->free_tasks;
+    if (t) {
+        self->free_tasks = t->next;
+        return t;
+    }
+
+    tp_chunk_t* c = (tp_chunk_t*)malloc(sizeof(*c));
+    if (!c) return 0;
+
+    c->next = self->chunks;
+    self->chunks = c;
+
+    for (uint32_t i = 1u; i < TP_CHUNK_TASKS; i++) {
+        c->tasks[i].next = self->free_tasks;
+        self->free_tasks = &c->tasks[i];
+    }
+    return &c->tasks[0];
+}
+
+static void tp_task_free(tp_worker_t* self, tp_task_t* t) {
+    t->next = self->free_tasks;
+    self->free_tasks = t;
+}
+
+/* Worker threads are told apart by their stacks, which the pool allocates; anything else is the owner. */
+static tp_worker_t* tp_self(taskpool_t* pool) {
+    uint8_t probe;
+    const uintptr_t sp = (uintptr_t)&probe;
+
+    for (uint32_t i = 1u; i < pool->nthreads; i++) {
+        tp_worker_t* w = &pool->workers[i];
+        if (sp - (uintptr_t)w->stack < w->stack_size) return w;
+    }
+    return &pool->workers[0];
+}
+
+static uint32_t tp_next_rand(tp_worker_t* self) {
+    uint32_t x = self->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    self->rng = x;
+    return x;
+}
+
+static tp_task_t* tp_find_work(taskpool_t* pool, tp_worker_t* self) {
+    tp_task_t* t = tp_deque_pop(&self->dq);
+    if (t) return t;
+
+    const uint32_t n = pool->nthreads;
+    const uint32_t first = tp_next_rand(self) % n;
+
+    for (uint32_t i = 0; i < n; i++) {
+        tp_worker_t* victim = &pool->workers[(first + i) % n];
+        if (victim == self) continue;
+
+        for (;;) {
+            t = tp_deque_steal(&victim->dq);
+            if (t != (tp_task_t*)(void*)&victim->dq) break;
+            tp_cpu_relax();
+        }
+        if (t) return t;
+    }
+    return 0;
+}
+
+/* Pairs with the idle count bump in tp_park(): either the sleeper sees the task or we see the sleeper. */
+static void tp_notify(taskpool_t* pool) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&pool->idle, __ATOMIC_RELAXED) == 0u) return;
+
+    __atomic_add_fetch(&pool->wake_seq, 1u, __ATOMIC_SEQ_CST);
+    (void)futex_wake(&pool->wake_seq, 1u);
+}
+
+static void tp_group_add(task_group_t* g) {
+    __atomic_add_fetch(&g->state, 1u, __ATOMIC_RELAXED);
+}
+
+static void tp_group_done(task_group_t* g) {
+    const uint32_t prev = __atomic_fetch_sub(&g->state, 1u, __ATOMIC_ACQ_REL);
+
+    if ((prev & TP_GROUP_COUNT) == 1u && (prev & TP_GROUP_WAITING) != 0u) {
+        (void)futex_wake(&g->state, 0x7FFFFFFFu);
+    }
+}
+
+static void tp_execute(taskpool_t* pool, tp_worker_t* self, tp_task_t* t) {
+    /* The node is recycled before running, so that a task spawning more can reuse it. */
+    const tp_task_t task = *t;
+    tp_task_free(self, t);
+
+    task.run(pool, self, &task);
+    tp_group_done(task.group);
+}
+
+/* Queue a copy of `proto`, or run it right here when the deque is full or no node can be had. */
+static void tp_submit(taskpool_t* pool, tp_worker_t* self, const tp_task_t* proto) {
+    tp_group_add(proto->group);
+
+    tp_task_t* t = tp_task_alloc(self);
+    if (t) {
+        *t = *proto;
+        t->next = 0;
+
+        if (tp_deque_push(&self->dq, t)) {
+            tp_notify(pool);
+            return;
+        }
+        tp_task_free(self, t);
+    }
+
+    proto->run(pool, self, proto);
+    tp_group_done(proto->group);
+}
+
+static void tp_park(taskpool_t* pool, tp_worker_t* self) {
+    for (uint32_t i = 0; i < TP_IDLE_SPINS; i++) {
+        tp_task_t* t = tp_find_work(pool, self);
+        if (t) {
+            tp_execute(pool, self, t);
+            return;
+        }
+        if (__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)) return;
+        tp_cpu_relax();
+    }
+
+    const uint32_t seq = __atomic_load_n(&pool->wake_seq, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&pool->idle, 1u, __ATOMIC_SEQ_CST);
+
+    tp_task_t* t = tp_find_work(pool, self);
+    if (!t && !__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)) {
+        (void)futex_wait(&pool->wake_seq, seq);
+    }
+
+    __atomic_sub_fetch(&pool->idle, 1u, __ATOMIC_SEQ_CST);
+
+    if (t) {
+        tp_execute(pool, self, t);
+    }
+}
+
+static void* tp_worker_main(void* arg) {
+    tp_worker_t* self = (tp_worker_t*)arg;
+    taskpool_t* pool = self->pool;
+
+    while (!__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)) {
+        tp_task_t* t = tp_find_work(pool, self);
+        if (t) {
+            tp_execute(pool, self, t);
+            continue;
+        }
+        tp_park(pool, self);
+    }
+    return 0;
+}
+
+static void tp_run_user(taskpool_t* pool, tp_worker_t* self, const tp_task_t* t) {
+    (void)pool;
+    (void)self;
+
+    t->fn(t->arg);
+}
+
+typedef struct {
+    parallel_for_fn_t fn;
+    void* ctx;
+    uint32_t grain;
+    task_group_t group;
+} tp_pfor_t;
+
+static void tp_run_range(taskpool_t* pool, tp_worker_t* self, const tp_task_t* t);
+
+/*
+ * Lazy binary splitting: hand the upper half of the range to the deque
+ * while this thread has next to nothing queued, which is the case as long
+ * as other threads keep stealing. Otherwise work through it a grain at a
+ * time, looking again between grains.
+ */
+static void tp_pfor_range(taskpool_t* pool, tp_worker_t* self, tp_pfor_t* pf, uint32_t begin, uint32_t end) {
+    while (begin < end) {
+        const uint32_t len = end - begin;
+
+        if (len > pf->grain && tp_deque_size(&self->dq) < TP_SPLIT_QUEUED) {
+            const uint32_t mid = begin + len / 2u;
+
+            tp_task_t half;
+            memset(&half, 0, sizeof(half));
+            half.run = tp_run_range;
+            half.arg = pf;
+            half.begin = mid;
+            half.end = end;
+            half.group = &pf->group;
+
+            tp_submit(pool, self, &half);
+            end = mid;
+            continue;
+        }
+
+        const uint32_t stop = len > pf->grain ? begin + pf->grain : end;
+        pf->fn(pf->ctx, begin, stop);
+        begin = stop;
+    }
+}
+
+static void tp_run_range(taskpool_t* pool, tp_worker_t* self, const tp_task_t* t) {
+    tp_pfor_range(pool, self, (tp_pfor_t*)t->arg, t->begin, t->end);
+}
+
+taskpool_t* taskpool_create(uint32_t threads, uint32_t stack_size) {
+    if (threads == 0u) {
+        const int n = get_nprocs();
+        threads = n > 0 ? (uint32_t)n : 1u;
+    }
+    if (threads > TASKPOOL_MAX_THREADS) threads = TASKPOOL_MAX_THREADS;
+
+    if (stack_size == 0u) stack_size = TASKPOOL_DEFAULT_STACK_SIZE;
+    if (stack_size < PTHREAD_STACK_MIN) stack_size = PTHREAD_STACK_MIN;
+    stack_size = (stack_size + 15u) & ~15u;
+
+    taskpool_t* pool = (taskpool_t*)malloc(sizeof(*pool));
+    if (!pool) return 0;
+
+    tp_worker_t* workers = (tp_worker_t*)malloc(threads * (uint32_t)sizeof(*workers));
+    if (!workers) {
+        free(pool);
+        return 0;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    memset(workers, 0, threads * (uint32_t)sizeof(*workers));
+
+    pool->nthreads = threads;
+    pool->workers = workers;
+
+    for (uint32_t i = 0; i < threads; i++) {
+        workers[i].pool = pool;
+        workers[i].index = i;
+        workers[i].rng = 0x9E3779B9u * (i + 1u);
+    }
+
+    /* All stacks are known before any worker runs, so tp_self() never sees a half-built table. */
+    for (uint32_t i = 1u; i < threads; i++) {
+        workers[i].stack = (uint8_t*)malloc(stack_size);
+        if (!workers[i].stack) {
+            taskpool_destroy(pool);
+            return 0;
+        }
+        workers[i].stack_size = stack_size;
+    }
+
+    for (uint32_t i = 1u; i < threads; i++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstack(&attr, workers[i].stack, stack_size);
+
+        const int rc = pthread_create(&workers[i].thread, &attr, tp_worker_main, &workers[i]);
+        pthread_attr_destroy(&attr);
+
+        if (rc != 0) {
+            taskpool_destroy(pool);
+            return 0;
+        }
+        workers[i].started = 1;
+    }
+
+    return pool;
+}
+
+void taskpool_destroy(taskpool_t* pool) {
+    if (!pool) return;
+
+    __atomic_store_n(&pool->stop, 1u, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&pool->wake_seq, 1u, __ATOMIC_SEQ_CST);
+    (void)futex_wake(&pool->wake_seq, 0x7FFFFFFFu);
+
+    for (uint32_t i = 1u; i < pool->nthreads; i++) {
+        if (pool->workers[i].started) {
+            pthread_join(pool->workers[i].thread, 0);
+        }
+    }
+
+    for (uint32_t i = 0; i < pool->nthreads; i++) {
+        tp_worker_t* w = &pool->workers[i];
+
+        tp_chunk_t* c = w->chunks;
+        while (c) {
+            tp_chunk_t* next = c->next;
+            free(c);
+            c = next;
+        }
+        if (w->stack) free(w->stack);
+    }
+
+    free(pool->workers);
+    free(pool);
+}
+
+uint32_t taskpool_threads(const taskpool_t* pool) {
+    return pool ? pool->nthreads : 1u;
+}
+
+void task_group_init(task_group_t* g) {
+    if (g) g->state = 0u;
+}
+
+void task_group_spawn(taskpool_t* pool, task_group_t* g, task_fn_t fn, void* arg) {
+    if (!g || !fn) return;
+
+    if (!pool || pool->nthreads < 2u) {
+        fn(arg);
+        return;
+    }
+
+    tp_task_t proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.run = tp_run_user;
+    proto.fn = fn;
+    proto.arg = arg;
+    proto.group = g;
+
+    tp_submit(pool, tp_self(pool), &proto);
+}
+
+void task_group_wait(taskpool_t* pool, task_group_t* g) {
+    if (!g) return;
+    if (!pool || pool->nthreads < 2u) return;
+
+    tp_worker_t* self = tp_self(pool);
+    uint32_t spins = 0u;
+
+    for (;;) {
+        uint32_t state = __atomic_load_n(&g->state, __ATOMIC_ACQUIRE);
+        if ((state & TP_GROUP_COUNT) == 0u) break;
+
+        /* Help instead of blocking: what is queued may well be this group's own tasks. */
+        tp_task_t* t = tp_find_work(pool, self);
+        if (t) {
+            tp_execute(pool, self, t);
+            spins = 0u;
+            continue;
+        }
+
+        if (spins < TP_IDLE_SPINS) {
+            spins++;
+            tp_cpu_relax();
+            continue;
+        }
+
+        /* The rest is running elsewhere: sleep until the last of it is done. */
+        if ((state & TP_GROUP_WAITING) == 0u
+            && !__atomic_compare_exchange_n(&g->state, &state, state | TP_GROUP_WAITING,
+                                            0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        (void)futex_wait(&g->state, state | TP_GROUP_WAITING);
+        spins = 0u;
+    }
+
+    __atomic_store_n(&g->state, 0u, __ATOMIC_RELEASE);
+}
+
+void parallel_for(taskpool_t* pool, uint32_t begin, uint32_t end, uint32_t grain,
+                  parallel_for_fn_t fn, void* ctx) {
+    if (!fn || begin >= end) return;
+
+    const uint32_t threads = taskpool_threads(pool);
+    const uint32_t len = end - begin;
+
+    if (threads < 2u) {
+        fn(ctx, begin, end);
+        return;
+    }
+
+    /* About eight pieces per thread leaves room to even out uneven ones. */
+    if (grain == 0u) {
+        grain = len / (threads * 8u);
+        if (grain == 0u) grain = 1u;
+    }
+    if (len <= grain) {
+        fn(ctx, begin, end);
+        return;
+    }
+
+    tp_pfor_t pf;
+    pf.fn = fn;
+    pf.ctx = ctx;
+    pf.grain = grain;
+    task_group_init(&pf.group);
+
+    tp_pfor_range(pool, tp_self(pool), &pf, begin, end);
+    task_group_wait(pool, &pf.group);
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+#ifndef _TASKPOOL_H
+#define _TASKPOOL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Work-stealing thread pool.
+ *
+ * Every thread of the pool owns a Chase-Lev deque: it pushes and pops tasks
+ * at the bottom end, idle threads steal from the top end of the others.
+ * Threads that find nothing to run sleep on a futex until a spawn wakes them.
+ *
+ * The thread that creates the pool is its slot 0 and runs tasks while it
+ * waits on a group. Tasks are submitted from that thread or from inside
+ * tasks, never from other threads. A NULL pool, or one with a single thread,
+ * runs everything inline.
+ */
+#define TASKPOOL_MAX_THREADS 32u
+#define TASKPOOL_DEFAULT_STACK_SIZE (256u * 1024u)
+
+typedef struct taskpool taskpool_t;
+
+typedef void (*task_fn_t)(void* arg);
+typedef void (*parallel_for_fn_t)(void* ctx, uint32_t begin, uint32_t end);
+
+/* Tasks not yet finished, and a flag in the top bit while someone sleeps on it. */
+typedef struct {
+    volatile uint32_t state;
+} task_group_t;
+
+#define TASK_GROUP_INITIALIZER { 0u }
+
+/* threads: 0 for one per online CPU. stack_size: 0 for the default. */
+taskpool_t* taskpool_create(uint32_t threads, uint32_t stack_size);
+void taskpool_destroy(taskpool_t* pool);
+
+/* Threads running tasks, the owner included; 1 for a NULL pool. */
+uint32_t taskpool_threads(const taskpool_t* pool);
+
+void task_group_init(task_group_t* g);
+
+/* Queue fn(arg) in the group; it runs inline when it cannot be queued. */
+void task_group_spawn(taskpool_t* pool, task_group_t* g, task_fn_t fn, void* arg);
+
+/* Run queued tasks until every task of the group has finished. */
+void task_group_wait(taskpool_t* pool, task_group_t* g);
+
+/*
+ * fn(ctx, b, e) over disjoint subranges covering [begin, end), in no
+ * particular order, returning once all are done. A range is split in halves
+ * only while other threads are taking work, and never below `grain` indices;
+ * grain 0 picks one from the range length and the thread count.
+ */
+void parallel_for(taskpool_t* pool, uint32_t begin, uint32_t end, uint32_t grain,
+                  parallel_for_fn_t fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright (C) 2026 Yula1234
+
+// 64-bit unsigned division helpers that gcc calls on i386.
+// Programs are linked without libgcc, so the runtime carries its own.
+
+#include <stdint.h>
+
+uint64_t __udivmoddi4(uint64_t num, uint64_t den, uint64_t* rem_out) {
+    uint64_t quotient = 0;
+    uint64_t remainder = 0;
+
+    if (den == 0) {
+        if (rem_out) *rem_out = 0;
+        return 0;
+    }
+
+    if ((den >> 32) == 0) {
+        /* Divisor fits a register: two divl steps, high word then low word. */
+        const uint32_t d = (uint32_t)den;
+        const uint32_t hi = (uint32_t)(num >> 32);
+        const uint32_t lo = (uint32_t)num;
+
+        const uint32_t q_hi = hi / d;
+        uint32_t r = hi % d;
+        uint32_t q_lo;
+
+        __asm__("divl %4" : "=a"(q_lo), "=d"(r) : "a"(lo), "d"(r), "rm"(d));
+
+        quotient = ((uint64_t)q_hi << 32) | q_lo;
+        remainder = r;
+    } else {
+        for (int i = 63; i >= 0; i--) {
+            remainder = (remainder << 1) | ((num >> i) & 1);
+
+            if (remainder >= den) {
+                remainder -= den;
+                quotient |= (1ULL << i);
+            }
+        }
+    }
+
+    if (rem_out) *rem_out = remainder;
+    return quotient;
+}
+
+uint64_t __udivdi3(uint64_t num, uint64_t den) {
+    return __udivmoddi4(num, den, 0);
+}
+
+uint64_t __umoddi3(uint64_t num, uint64_t den) {
+    uint64_t rem;
+    (void)__udivmoddi4(num, den, &rem);
+    return rem;
+}
@@ -6,18 +6,32 @@ use32
 
 public _start
 extrn main
+extrn __libc_tls_area_size
+extrn __libc_tls_init
 
 section '.text'
 
 _start:
     
-    mov eax, [esp + 4]     ; argc
-    mov ecx, [esp + 8]     ; argv
+    mov esi, [esp + 4]     ; argc
+    mov edi, [esp + 8]     ; argv
+
+    ; The initial thread's TLS block and control block live just below the
+    ; arguments; nothing may touch a __thread variable before this.
+    call __libc_tls_area_size
+    sub esp, eax
+    and esp, 0xFFFFFFC0
+    mov eax, esp
+
+    sub esp, 12
+    push eax
+    call __libc_tls_init
+    add esp, 16
     
-    sub esp, 4
+    sub esp, 8
     
-    push ecx               ; argv
-    push eax               ; argc
+    push edi               ; argv
+    push esi               ; argc
     
     call main
     
@@ -27,4 +41,4 @@ _start:
     
     hlt
 
-section '.note.GNU-stack'
\ No newline at end of file
+section '.note.GNU-stack'
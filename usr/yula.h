@@ -13,7 +13,12 @@
 #include <lib/stdlib.h>
 #include <lib/stdio.h>
 #include <lib/pthread.h>
+#include <lib/chan.h>
+#include <lib/taskpool.h>
+#include <yos/eventfd.h>
+#include <yos/futex.h>
 #include <yos/ioctl.h>
+#include <yos/mman.h>
 #include <yos/proc.h>
 
 #define YULA_EVENT_NONE       0
@@ -167,6 +172,15 @@ static inline int pipe_try_write(int fd, const void* buf, uint32_t size) {
     return syscall(32, fd, (int)buf, (int)size);
 }
 
+/* Resize the pipe behind `fd`; returns the capacity actually set. */
+static inline int pipe_set_size(int fd, uint32_t size) {
+    return ioctl(fd, YOS_PIPE_SET_SIZE, &size);
+}
+
+static inline int pipe_set_flags(int fd, uint32_t flags) {
+    return ioctl(fd, YOS_PIPE_SET_FLAGS, &flags);
+}
+
 static inline int kbd_try_read(char* out) {
     return syscall(33, (int)out, 0, 0);
 }
@@ -183,6 +197,16 @@ static inline int ipc_connect(const char* name, int out_fds[2]) {
     return syscall(36, (int)name, (int)out_fds, 0);
 }
 
+/* flags: YOS_IPC_LISTEN_CHAN also accepts channel connections (ipc_accept() returns YOS_IPC_ACCEPTED_CHAN). */
+static inline int ipc_listen_flags(const char* name, uint32_t flags) {
+    return syscall(34, (int)name, 0, (int)flags);
+}
+
+/* Channel fd for chan_open(), or -1 if the endpoint does not take channels. */
+static inline int ipc_connect_chan(const char* name) {
+    return syscall(63, (int)name, 0, 0);
+}
+
 static inline int chdir(const char* path) {
     return syscall(45, (int)path, 0, 0);
 }
@@ -211,10 +235,27 @@ static inline uint32_t uptime_ms(void) {
     return (uint32_t)syscall(47, 0, 0, 0);
 }
 
+/* CPUs currently online, the caller's among them. */
+static inline int get_nprocs(void) {
+    return syscall(66, 0, 0, 0);
+}
+
+static inline int get_mem_stats(uint32_t* used_kib, uint32_t* free_kib) {
+    return syscall(10, (int)(uintptr_t)used_kib, (int)(uintptr_t)free_kib, 0);
+}
+
 static inline int proc_list(yos_proc_info_t* buf, uint32_t cap) {
     return syscall(48, (int)(uintptr_t)buf, (int)cap, 0);
 }
 
+#define RUSAGE_SELF     YOS_RUSAGE_SELF
+#define RUSAGE_CHILDREN YOS_RUSAGE_CHILDREN
+
+/* Usage of the calling thread, or of the children it has waited for. */
+static inline int getrusage(int who, yos_rusage_t* out) {
+    return syscall(67, who, (int)(uintptr_t)out, 0);
+}
+
 static inline int setsid(void) {
     return syscall(49, 0, 0, 0);
 }
@@ -234,6 +275,16 @@ static inline uint32_t getpgrp(void) {
 #define MAP_SHARED  1
 #define MAP_PRIVATE 2
 
+#define MAP_POPULATE YOS_MAP_POPULATE
+
+#define MADV_NORMAL     YOS_MADV_NORMAL
+#define MADV_RANDOM     YOS_MADV_RANDOM
+#define MADV_SEQUENTIAL YOS_MADV_SEQUENTIAL
+#define MADV_WILLNEED   YOS_MADV_WILLNEED
+#define MADV_DONTNEED   YOS_MADV_DONTNEED
+#define MADV_HUGEPAGE   YOS_MADV_HUGEPAGE
+#define MADV_GUARD_INSTALL YOS_MADV_GUARD_INSTALL
+
 static inline int shm_create(uint32_t size) {
     return syscall(30, (int)size, 0, 0);
 }
@@ -250,6 +301,49 @@ static inline int shm_unlink_named(const char* name) {
     return syscall(40, (int)name, 0, 0);
 }
 
+/* Grow or shrink shared memory in place; the pages it already has are kept. */
+static inline int shm_resize(int fd, uint32_t size) {
+    return ioctl(fd, YOS_SHM_SET_SIZE, &size);
+}
+
+static inline int shm_get_size(int fd, uint32_t* out_size) {
+    return ioctl(fd, YOS_SHM_GET_SIZE, out_size);
+}
+
+/* flags: YOS_EFD_SEMAPHORE, YOS_EFD_NONBLOCK. */
+static inline int eventfd(uint32_t initval, uint32_t flags) {
+    return syscall(64, (int)initval, (int)flags, 0);
+}
+
+/* 1 with the counter (or 1 in semaphore mode) in *out, 0 if non-blocking and empty, -1 on error. */
+static inline int eventfd_read(int fd, uint64_t* out) {
+    const int r = read(fd, out, (uint32_t)sizeof(*out));
+    return r == (int)sizeof(*out) ? 1 : (r == 0 ? 0 : -1);
+}
+
+/* 1 once added, 0 if non-blocking and the counter would overflow, -1 on error. */
+static inline int eventfd_write(int fd, uint64_t value) {
+    const int r = write(fd, &value, (uint32_t)sizeof(value));
+    return r == (int)sizeof(value) ? 1 : (r == 0 ? 0 : -1);
+}
+
+/* flags: YOS_TFD_NONBLOCK. Read with eventfd_read(), which returns the expirations. */
+static inline int timerfd_create(uint32_t flags) {
+    return syscall(65, (int)flags, 0, 0);
+}
+
+static inline int timerfd_settime(int fd, uint32_t value_ms, uint32_t interval_ms, uint32_t flags) {
+    yos_timerspec_t spec;
+    spec.value_ms = value_ms;
+    spec.interval_ms = interval_ms;
+    spec.flags = flags;
+    return ioctl(fd, YOS_TFD_SETTIME, &spec);
+}
+
+static inline int timerfd_gettime(int fd, yos_timerspec_t* out) {
+    return ioctl(fd, YOS_TFD_GETTIME, out);
+}
+
 static inline int futex_wait(volatile uint32_t* uaddr, uint32_t expected) {
     return syscall(41, (int)uaddr, (int)expected, 0);
 }
@@ -258,6 +352,28 @@ static inline int futex_wake(volatile uint32_t* uaddr, uint32_t max_wake) {
     return syscall(42, (int)uaddr, (int)max_wake, 0);
 }
 
+/* flags: YOS_FUTEX_ABSTIME makes timeout_ms an uptime_ms() deadline. */
+static inline int futex_wait_timeout(volatile uint32_t* uaddr, uint32_t expected, uint32_t timeout_ms, uint32_t flags) {
+    return syscall4(58, (int)uaddr, (int)expected, (int)timeout_ms, (int)flags);
+}
+
+static inline int futex_requeue(const yos_futex_requeue_t* req) {
+    return syscall(59, (int)(uintptr_t)req, 0, 0);
+}
+
+static inline int futex_wake_op(const yos_futex_wake_op_t* req) {
+    return syscall(60, (int)(uintptr_t)req, 0, 0);
+}
+
+/* timeout_ms: YOS_FUTEX_INFINITE, a duration or, with YOS_FUTEX_ABSTIME, an uptime_ms() deadline. */
+static inline int futex_lock_pi(volatile uint32_t* uaddr, uint32_t timeout_ms, uint32_t flags) {
+    return syscall(61, (int)uaddr, (int)timeout_ms, (int)flags);
+}
+
+static inline int futex_unlock_pi(volatile uint32_t* uaddr) {
+    return syscall(62, (int)uaddr, 0, 0);
+}
+
 static inline void* mmap(int fd, uint32_t size, int flags) {
     return (void*)syscall(21, fd, size, flags);
 }
@@ -266,6 +382,10 @@ static inline int munmap(void* addr, uint32_t length) {
     return syscall(22, (int)addr, length, 0);
 }
 
+static inline int madvise(void* addr, uint32_t len, uint32_t advice) {
+    return syscall(57, (int)(uintptr_t)addr, (int)len, (int)advice);
+}
+
 typedef struct {
     uint32_t type;
     uint32_t size;